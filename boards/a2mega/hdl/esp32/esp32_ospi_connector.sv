@@ -15,7 +15,19 @@
 // - Disk track / HDD block BSRAM buffers (XFER SPACE 4 / 5) exposed to the
 //   DiskII / HDD cards over mem_port_if
 // - OSD text page (XFER SPACE 1, write-only) with a clk_pixel read port for
-//   the osd_text_overlay renderer
+//   the osd_text_overlay renderer, plus a row offset for hardware scrolling
+//   (reg 0x7E, CAPABILITIES[4])
+// - Register window (XFER SPACE 6): N consecutive registers read or written
+//   in one framed transaction (CAPABILITIES[2])
+// - Attention line (esp_attn_n, the unused CS pin): low while a request the
+//   MCU enabled in ATTN_MASK is pending, plus per-class request age counters
+//   (CAPABILITIES[3])
+// - CRC-16 on XFER frames (SUB0[5], CAPABILITIES[1] with USE_CRC): read
+//   payloads carry a trailer, write trailers are checked and counted
+//   (regs 0x4F/0x5F)
+// - XFER read prefetch: payload reads are issued ahead of the master into a
+//   2^RD_PF_LOG2-byte FIFO, so the link clock is not bounded by the read
+//   latency (CAPABILITIES[7:5] = RD_PF_LOG2)
 // - F18A GPU interface (f18a_gpu_if)
 //
 // See boards/a2mega/docs/ESP32_OSPI_DESIGN.md and ESP32_ENHANCED_PORT.md for
@@ -25,7 +37,8 @@ module esp32_ospi_connector #(
     parameter USE_SYNC    = 1,
     parameter USE_CRC     = 0,
     parameter IDLE_TO_CYC = 5_400_000,
-    parameter CLOCK_SPEED_HZ = 54_000_000
+    parameter CLOCK_SPEED_HZ = 54_000_000,
+    parameter RD_PF_LOG2  = 3
 )(
     input  wire        clk,
     input  wire        rst_n,
@@ -61,9 +74,10 @@ module esp32_ospi_connector #(
     input  wire [7:0]  pad_btns1_i,      // {extra[3:0],2'b0,START,SELECT}
     input  wire [7:0]  key_mod_i,
 
-    // Video-pipeline debug readback (regs 0x70-0x77). Quasi-static bytes,
+    // Video-pipeline debug readback (regs 0x70-0x78). Quasi-static bytes,
     // sampled asynchronously — good enough for CLI inspection, not for
-    // control flow.
+    // control flow. Writing 1 to 0x70 swaps 0x71-0x78 to the 16-bit
+    // per-frame prefetch counters (page 1); writing 0 restores page 0.
     input  wire [7:0]  dbg_video_ss_i,      // soft-switch/mux snapshot
     input  wire [7:0]  dbg_c029_cnt_i,      // count of $C029 writes seen
     input  wire [7:0]  dbg_c029_last_i,     // last data written to $C029
@@ -73,6 +87,10 @@ module esp32_ospi_connector #(
     input  wire [7:0]  dbg_resp_ovfl_i,     // per-port CDC resp overflow (sticky)
     input  wire [7:0]  dbg_shadow_rd_i,     // apple_memory read FSM snapshot
     input  wire [7:0]  dbg_vgc_starved_i,   // vgc_gen stale-word swaps per frame
+    input  wire [15:0] dbg_shadow_late_i,   // page 1: words that missed the prefetch queue
+    input  wire [15:0] dbg_vgc_stalls_i,    // page 1: vgc_gen word stalls
+    input  wire [15:0] dbg_vid_late_i,      // page 1: apple_video_gen late chunks
+    input  wire [15:0] dbg_pf_depth_i,      // page 1: max groups queued ahead
     input  wire [7:0]  dbg_usb_line_i,      // {pll_lock,usb_reset,oe_sticky,dm,dp,pc[9:7]}
     input  wire [7:0]  dbg_usb_pc_i,        // UKP rom_addr[7:0] (async sample — fuzzy)
     input  wire [47:0] dbg_usb_desc_i,      // {class,subclass,pid[15:0],vid[15:0]} from enum
@@ -102,11 +120,13 @@ module esp32_ospi_connector #(
     // Misc
     output wire [39:0] scratch_o,          // {scratch4..scratch1, scratch0}
     output wire        mcu_ready_o,
+    output reg         esp_attn_n,         // attention line to the MCU, active low
 
     // OSD text page read port (osd_clk domain, quasi-static content)
     input  wire        osd_clk_i,
     input  wire [10:0] osd_addr_i,
-    output reg  [7:0]  osd_data_o
+    output reg  [7:0]  osd_data_o,
+    output wire [4:0]  osd_scroll_o        // text page row shown at the top (0-23)
 );
 
     // =========================================================================
@@ -117,7 +137,9 @@ module esp32_ospi_connector #(
     localparam [7:0] DEVICE_ID2 = "F";
     localparam [7:0] DEVICE_ID3 = "P";
     localparam [7:0] PROTO_VER  = 8'h01;
-    wire [7:0] CAP0 = {6'b0, USE_CRC[0], 1'b1};
+    // CAP0: [0] SYNC, [1] CRC, [2] register window (SPACE 6), [3] attention
+    // line, [4] OSD row offset, [7:5] XFER read prefetch depth (log2, 0 = none)
+    wire [7:0] CAP0 = {RD_PF_LOG2[2:0], 1'b1, 1'b1, 1'b1, USE_CRC[0], 1'b1};
 
     // =========================================================================
     // Register Address Map
@@ -161,12 +183,13 @@ module esp32_ospi_connector #(
     localparam REG_HDD0_REQ_CTL = 7'h26;   // R: {wr,rd}  W: {readonly,mounted,ready}
     localparam REG_HDD0_LBA_L   = 7'h27;   // R: lba[7:0]   W: size[7:0]
     localparam REG_HDD0_LBA_H   = 7'h28;   // R: lba[15:8]  W: size[15:8]
-    localparam REG_HDD0_ACK     = 7'h29;   // W: ack strobe (write-any)
+    localparam REG_HDD0_ACK     = 7'h29;   // R: blk_cnt (blocks-1)  W: ack strobe (b1 = failed)
     localparam REG_HDD1_REQ_CTL = 7'h2A;
     localparam REG_HDD1_LBA_L   = 7'h2B;
     localparam REG_HDD1_LBA_H   = 7'h2C;
     localparam REG_HDD1_ACK     = 7'h2D;
     localparam REG_A2_RST_RELEASE = 7'h2E;
+    localparam REG_ATTN_MASK    = 7'h2F;   // W/R: STATUS[5:3] bits that pull esp_attn_n
 
     // Slot configuration (0x30-0x3F)
     localparam REG_SLOT_SELECT  = 7'h30;
@@ -185,6 +208,12 @@ module esp32_ospi_connector #(
     localparam REG_DBG_MEM_D3   = 7'h3B;  // R data[31:24]; addr auto-incs
                                           // when each read completes
 
+    // Request age (us, saturating; 0 while nothing of the class is pending)
+    localparam REG_ATTN_AGE_DISK_L = 7'h3C;  // floppy or HDD request
+    localparam REG_ATTN_AGE_DISK_H = 7'h3D;
+    localparam REG_ATTN_AGE_NET_L  = 7'h3E;  // W5100 doorbell
+    localparam REG_ATTN_AGE_NET_H  = 7'h3F;
+
     // Drive 0 (0x40-0x4F)
     localparam REG_VOL0_READY   = 7'h40;
     localparam REG_VOL0_ACTIVE  = 7'h41;
@@ -201,6 +230,7 @@ module esp32_ospi_connector #(
     localparam REG_VOL0_BLK_CNT = 7'h4C;
     localparam REG_VOL0_CMD     = 7'h4D;
     localparam REG_VOL0_ACK     = 7'h4E;
+    localparam REG_XFER_CRC_OK  = 7'h4F;  // R: CRC'd XFER writes that checked (mod 256)
 
     // Drive 1 (0x50-0x5F)
     localparam REG_VOL1_READY   = 7'h50;
@@ -218,6 +248,7 @@ module esp32_ospi_connector #(
     localparam REG_VOL1_BLK_CNT = 7'h5C;
     localparam REG_VOL1_CMD     = 7'h5D;
     localparam REG_VOL1_ACK     = 7'h5E;
+    localparam REG_XFER_CRC_ERR = 7'h5F;  // R: CRC'd XFER writes that failed (mod 256)
 
     // F18A GPU (0x60-0x6F)
     localparam REG_GPU_CONTROL  = 7'h60;
@@ -238,7 +269,10 @@ module esp32_ospi_connector #(
     localparam REG_GPU_GSTATUS  = 7'h6F;
 
     // Uthernet2 (0x7A)
-    // Video-pipeline debug readback (read-only)
+    // Video-pipeline debug readback (read-only; a write to 0x70 selects the
+    // page shown at 0x71-0x78). Page 1, all per frame, little-endian pairs:
+    // 0x71/72 shadow late words, 0x73/74 VGC stalls, 0x75/76 video late
+    // chunks, 0x77/78 prefetch queue max depth.
     localparam REG_DBG_VIDEO_SS   = 7'h70;  // {use_vgc,SHRG,LINEAR,STORE80,PAGE2,MIXED,HIRES,TEXT}
     localparam REG_DBG_C029_CNT   = 7'h71;
     localparam REG_DBG_C029_LAST  = 7'h72;
@@ -258,6 +292,7 @@ module esp32_ospi_connector #(
     localparam REG_DBG_USB_PID_H = 7'h1F;
     localparam REG_DBG_USB_CLASS = 7'h7C;   // interface class
     localparam REG_DBG_USB_SUBCL = 7'h7D;   // interface subclass
+    localparam REG_OSD_SCROLL    = 7'h7E;   // OSD text page row shown at the top
     localparam REG_DBG_USB_FLAGS = 7'h20;   // {connerr,x_input,fs,connected,start,rdy,stb,busy}
     localparam REG_DBG_USB_TXNS  = 7'h21;   // transaction-start counter
     localparam REG_DBG_USB_DATA  = 7'h22;   // received-data-packet counter
@@ -271,7 +306,8 @@ module esp32_ospi_connector #(
     localparam SPACE_VRAM1 = 3'd2;
     localparam SPACE_W5100 = 3'd3;
     localparam SPACE_DISK  = 3'd4;   // Disk II track buffers, addr[13]=drive
-    localparam SPACE_HDD   = 3'd5;   // HDD block buffers, addr[9]=unit
+    localparam SPACE_HDD   = 3'd5;   // HDD block rings, addr[11]=unit, addr[10:9]=slot
+    localparam SPACE_REGS  = 3'd6;   // register window, addr[6:0]=reg index
 
     // =========================================================================
     // Protocol Processor Interface
@@ -293,6 +329,23 @@ module esp32_ospi_connector #(
     reg         mem_rd_valid;
     reg  [7:0]  mem_rd_data;
 
+    wire [7:0]  crc_ok_cnt;
+    wire [7:0]  crc_err_cnt;
+
+    // Register window (SPACE 6): an XFER payload byte at address A is a
+    // read/write of register A, so a burst of consecutive registers costs one
+    // header instead of one framed transaction per register. The register
+    // mux and write decode are shared with the single-register path — the
+    // protocol processor runs one command at a time, so the two never
+    // collide. Register 127 (the XFER portal itself) is not reachable.
+    wire        regs_xw_w = mem_wr_en && (mem_space == SPACE_REGS);
+    wire        regs_xr_w = mem_rd_req && (mem_rd_space == SPACE_REGS);
+    wire        reg_wr_w      = reg_wr_req | regs_xw_w;
+    wire [6:0]  reg_wr_idx_w  = regs_xw_w ? mem_wr_addr[6:0] : reg_idx;
+    wire [7:0]  reg_wr_data_w = regs_xw_w ? mem_wr_data : reg_wdata;
+    wire [6:0]  reg_rd_idx_w  = regs_xr_w ? mem_rd_addr[6:0] : reg_idx;
+    reg  [7:0]  regs_rd_q;   // window read, aligned with the BSRAM latency
+
     // =========================================================================
     // Internal Registers
     // =========================================================================
@@ -309,6 +362,8 @@ module esp32_ospi_connector #(
     reg [3:0]  bg_color_r;
     reg [3:0]  border_color_r;
     reg [7:0]  video_flags_r;     // MONO,MONO_DHIRES,SHRG
+    reg [4:0]  osd_scroll_r;      // OSD row offset (0-23)
+    reg        dbg_page_r;        // viddbg window page (0x71-0x78)
 
     // Slot configuration
     reg [2:0]  slot_select_r;
@@ -336,10 +391,15 @@ module esp32_ospi_connector #(
     reg        hdd_readonly_r[2];
     reg [15:0] hdd_size_r[2];
     reg        hdd_ack_r[2];      // one-shot strobe
+    reg        hdd_err_r[2];      // ACK value bit 1: request failed
 
     // Apple II reset release
     reg        a2_rst_release_r;
 
+    // Attention line
+    reg [2:0]  attn_mask_r;       // enables for STATUS[5:3]
+    reg [15:0] age_disk_r, age_net_r;
+
     // W5100 doorbell clear
     reg [3:0]  w5100_cmd_clr_r;
 
@@ -375,7 +435,7 @@ module esp32_ospi_connector #(
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n)
             mcu_ready_r <= 1'b0;
-        else if (reg_rd_req && reg_idx == REG_STATUS)
+        else if ((reg_rd_req || regs_xr_w) && reg_rd_idx_w == REG_STATUS)
             mcu_ready_r <= 1'b1;
     end
 
@@ -437,6 +497,7 @@ module esp32_ospi_connector #(
     assign video_control_if.MONOCHROME_MODE = video_flags_r[0];
     assign video_control_if.MONOCHROME_DHIRES_MODE = video_flags_r[1];
     assign video_control_if.SHRG_MODE = video_flags_r[2];
+    assign osd_scroll_o = osd_scroll_r;
 
     // =========================================================================
     // Slotmaker Interface Outputs
@@ -454,24 +515,28 @@ module esp32_ospi_connector #(
     assign volumes[0].readonly = vol_readonly_r[0];
     assign volumes[0].size = vol_size_r[0];
     assign volumes[0].ack = vol_ack_r[0];
+    assign volumes[0].err = 1'b0;
 
     assign volumes[1].ready = vol_ready_r[1];
     assign volumes[1].mounted = vol_mounted_r[1];
     assign volumes[1].readonly = vol_readonly_r[1];
     assign volumes[1].size = vol_size_r[1];
     assign volumes[1].ack = vol_ack_r[1];
+    assign volumes[1].err = 1'b0;
 
     assign hdd_volumes[0].ready = hdd_ready_r[0];
     assign hdd_volumes[0].mounted = hdd_mounted_r[0];
     assign hdd_volumes[0].readonly = hdd_readonly_r[0];
     assign hdd_volumes[0].size = {16'b0, hdd_size_r[0]};
     assign hdd_volumes[0].ack = hdd_ack_r[0];
+    assign hdd_volumes[0].err = hdd_err_r[0];
 
     assign hdd_volumes[1].ready = hdd_ready_r[1];
     assign hdd_volumes[1].mounted = hdd_mounted_r[1];
     assign hdd_volumes[1].readonly = hdd_readonly_r[1];
     assign hdd_volumes[1].size = {16'b0, hdd_size_r[1]};
     assign hdd_volumes[1].ack = hdd_ack_r[1];
+    assign hdd_volumes[1].err = hdd_err_r[1];
 
     // =========================================================================
     // F18A GPU Interface Outputs
@@ -505,11 +570,43 @@ module esp32_ospi_connector #(
         1'b1                        // [0] ready
     };
 
+    // =========================================================================
+    // Attention line and request age
+    // =========================================================================
+    // esp_attn_n is low while any STATUS pending bit enabled in ATTN_MASK is
+    // set (reset: mask 0, line high), so the MCU can sleep until a falling
+    // edge instead of polling. The age counters run while a request class is
+    // pending and clear when it is acked, giving the MCU request-to-ack
+    // latency however it noticed the request. With both drives (or a floppy
+    // and an HDD) pending at once the count is from the first of them.
+    localparam US_DIV = CLOCK_SPEED_HZ / 1_000_000;
+    reg [7:0]  us_div_r;
+    wire       us_tick_w = (us_div_r == US_DIV - 1);
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            us_div_r   <= 8'd0;
+            age_disk_r <= 16'd0;
+            age_net_r  <= 16'd0;
+            esp_attn_n <= 1'b1;
+        end else begin
+            us_div_r <= us_tick_w ? 8'd0 : us_div_r + 8'd1;
+            if (!(vol_pending_w | hdd_pending_w))
+                age_disk_r <= 16'd0;
+            else if (us_tick_w && age_disk_r != 16'hFFFF)
+                age_disk_r <= age_disk_r + 16'd1;
+            if (!(|w5100_cmd_pending))
+                age_net_r <= 16'd0;
+            else if (us_tick_w && age_net_r != 16'hFFFF)
+                age_net_r <= age_net_r + 16'd1;
+            esp_attn_n <= ~|(status_w[5:3] & attn_mask_r);
+        end
+    end
+
     // =========================================================================
     // Register Read Multiplexer
     // =========================================================================
     always @* begin
-        case (reg_idx)
+        case (reg_rd_idx_w)
             // System registers
             REG_DEVICE_ID0:   reg_rdata = DEVICE_ID0;
             REG_DEVICE_ID1:   reg_rdata = DEVICE_ID1;
@@ -556,14 +653,14 @@ module esp32_ospi_connector #(
 
             // Video-pipeline debug readback
             REG_DBG_VIDEO_SS:   reg_rdata = dbg_video_ss_i;
-            REG_DBG_C029_CNT:   reg_rdata = dbg_c029_cnt_i;
-            REG_DBG_C029_LAST:  reg_rdata = dbg_c029_last_i;
-            REG_DBG_VGC_HSYNC:  reg_rdata = dbg_vgc_hsync_i;
-            REG_DBG_SHADOW_DROP:reg_rdata = dbg_shadow_drop_i;
-            REG_DBG_FB_FLAGS:   reg_rdata = dbg_fb_flags_i;
-            REG_DBG_RESP_OVFL:  reg_rdata = dbg_resp_ovfl_i;
-            REG_DBG_SHADOW_RD:  reg_rdata = dbg_shadow_rd_i;
-            REG_DBG_VGC_STARVED: reg_rdata = dbg_vgc_starved_i;
+            REG_DBG_C029_CNT:   reg_rdata = dbg_page_r ? dbg_shadow_late_i[7:0]  : dbg_c029_cnt_i;
+            REG_DBG_C029_LAST:  reg_rdata = dbg_page_r ? dbg_shadow_late_i[15:8] : dbg_c029_last_i;
+            REG_DBG_VGC_HSYNC:  reg_rdata = dbg_page_r ? dbg_vgc_stalls_i[7:0]   : dbg_vgc_hsync_i;
+            REG_DBG_SHADOW_DROP:reg_rdata = dbg_page_r ? dbg_vgc_stalls_i[15:8]  : dbg_shadow_drop_i;
+            REG_DBG_FB_FLAGS:   reg_rdata = dbg_page_r ? dbg_vid_late_i[7:0]     : dbg_fb_flags_i;
+            REG_DBG_RESP_OVFL:  reg_rdata = dbg_page_r ? dbg_vid_late_i[15:8]    : dbg_resp_ovfl_i;
+            REG_DBG_SHADOW_RD:  reg_rdata = dbg_page_r ? dbg_pf_depth_i[7:0]     : dbg_shadow_rd_i;
+            REG_DBG_VGC_STARVED: reg_rdata = dbg_page_r ? dbg_pf_depth_i[15:8]   : dbg_vgc_starved_i;
             REG_DBG_USB_LINE:   reg_rdata = dbg_usb_line_i;
             REG_DBG_USB_PC:     reg_rdata = dbg_usb_pc_i;
             REG_DBG_USB_VID_L:  reg_rdata = dbg_usb_desc_i[7:0];
@@ -582,11 +679,18 @@ module esp32_ospi_connector #(
             REG_HDD0_REQ_CTL: reg_rdata = {6'b0, hdd_volumes[0].wr, hdd_volumes[0].rd};
             REG_HDD0_LBA_L:   reg_rdata = hdd_volumes[0].lba[7:0];
             REG_HDD0_LBA_H:   reg_rdata = hdd_volumes[0].lba[15:8];
+            REG_HDD0_ACK:     reg_rdata = {2'b0, hdd_volumes[0].blk_cnt};
             REG_HDD1_REQ_CTL: reg_rdata = {6'b0, hdd_volumes[1].wr, hdd_volumes[1].rd};
             REG_HDD1_LBA_L:   reg_rdata = hdd_volumes[1].lba[7:0];
             REG_HDD1_LBA_H:   reg_rdata = hdd_volumes[1].lba[15:8];
+            REG_HDD1_ACK:     reg_rdata = {2'b0, hdd_volumes[1].blk_cnt};
 
             REG_A2_RST_RELEASE: reg_rdata = {7'b0, a2_rst_release_r};
+            REG_ATTN_MASK:    reg_rdata = {2'b0, attn_mask_r, 3'b0};
+            REG_ATTN_AGE_DISK_L: reg_rdata = age_disk_r[7:0];
+            REG_ATTN_AGE_DISK_H: reg_rdata = age_disk_r[15:8];
+            REG_ATTN_AGE_NET_L:  reg_rdata = age_net_r[7:0];
+            REG_ATTN_AGE_NET_H:  reg_rdata = age_net_r[15:8];
 
             // Slot configuration
             REG_SLOT_SELECT:  reg_rdata = {5'b0, slot_select_r};
@@ -610,6 +714,7 @@ module esp32_ospi_connector #(
             REG_VOL0_BLK_CNT: reg_rdata = {2'b0, volumes[0].blk_cnt};
             REG_VOL0_CMD:     reg_rdata = {6'b0, volumes[0].wr, volumes[0].rd};
             REG_VOL0_ACK:     reg_rdata = 8'h00;
+            REG_XFER_CRC_OK:  reg_rdata = crc_ok_cnt;
 
             // Drive 1
             REG_VOL1_READY:   reg_rdata = {7'b0, vol_ready_r[1]};
@@ -627,6 +732,7 @@ module esp32_ospi_connector #(
             REG_VOL1_BLK_CNT: reg_rdata = {2'b0, volumes[1].blk_cnt};
             REG_VOL1_CMD:     reg_rdata = {6'b0, volumes[1].wr, volumes[1].rd};
             REG_VOL1_ACK:     reg_rdata = 8'h00;
+            REG_XFER_CRC_ERR: reg_rdata = crc_err_cnt;
 
             // F18A GPU
             REG_GPU_CONTROL:  reg_rdata = {6'b0, gpu_pause_r, gpu_trigger_r};
@@ -649,6 +755,8 @@ module esp32_ospi_connector #(
             // Uthernet2
             REG_U2_DOORBELL:  reg_rdata = {4'b0, w5100_cmd_pending};
 
+            REG_OSD_SCROLL:   reg_rdata = {3'b0, osd_scroll_r};
+
             default: reg_rdata = 8'hFF;
         endcase
     end
@@ -669,6 +777,8 @@ module esp32_ospi_connector #(
             bg_color_r <= 4'd2;
             border_color_r <= 4'd2;
             video_flags_r <= 8'h00;
+            osd_scroll_r <= 5'd0;
+            dbg_page_r <= 1'b0;
             slot_select_r <= 3'd0;
             slot_card_r <= 8'h00;
             slot_wr_r <= 1'b0;
@@ -693,7 +803,10 @@ module esp32_ospi_connector #(
             hdd_size_r[1] <= 16'h0;
             hdd_ack_r[0] <= 1'b0;
             hdd_ack_r[1] <= 1'b0;
+            hdd_err_r[0] <= 1'b0;
+            hdd_err_r[1] <= 1'b0;
             a2_rst_release_r <= 1'b0;
+            attn_mask_r <= 3'b0;
             w5100_cmd_clr_r <= 4'b0;
             gpu_trigger_r <= 1'b0;
             gpu_pause_r <= 1'b0;
@@ -731,95 +844,106 @@ module esp32_ospi_connector #(
             gpu_pwe_r <= 1'b0;
             gpu_rwe_r <= 1'b0;
 
-            if (reg_wr_req) begin
-                case (reg_idx)
-                    REG_SCRATCH:      scratch_r <= reg_wdata;
+            if (reg_wr_w) begin
+                case (reg_wr_idx_w)
+                    REG_SCRATCH:      scratch_r <= reg_wr_data_w;
                     REG_DDR3_REINIT:  ddr3_reinit_tgl_o <= ~ddr3_reinit_tgl_o;
-                    REG_SCRATCH1:     scratch1_r <= reg_wdata;
-                    REG_SCRATCH2:     scratch2_r <= reg_wdata;
-                    REG_SCRATCH3:     scratch3_r <= reg_wdata;
-                    REG_SCRATCH4:     scratch4_r <= reg_wdata;
-
-                    REG_VIDEO_ENABLE: video_enable_r <= reg_wdata[0];
-                    REG_VIDEO_MODE:   video_mode_r <= reg_wdata;
-                    REG_TEXT_COLOR:   text_color_r <= reg_wdata[3:0];
-                    REG_BG_COLOR:     bg_color_r <= reg_wdata[3:0];
-                    REG_BORDER_COLOR: border_color_r <= reg_wdata[3:0];
-                    REG_VIDEO_FLAGS:  video_flags_r <= reg_wdata;
+                    REG_SCRATCH1:     scratch1_r <= reg_wr_data_w;
+                    REG_SCRATCH2:     scratch2_r <= reg_wr_data_w;
+                    REG_SCRATCH3:     scratch3_r <= reg_wr_data_w;
+                    REG_SCRATCH4:     scratch4_r <= reg_wr_data_w;
+
+                    REG_VIDEO_ENABLE: video_enable_r <= reg_wr_data_w[0];
+                    REG_VIDEO_MODE:   video_mode_r <= reg_wr_data_w;
+                    REG_TEXT_COLOR:   text_color_r <= reg_wr_data_w[3:0];
+                    REG_BG_COLOR:     bg_color_r <= reg_wr_data_w[3:0];
+                    REG_BORDER_COLOR: border_color_r <= reg_wr_data_w[3:0];
+                    REG_VIDEO_FLAGS:  video_flags_r <= reg_wr_data_w;
 
                     REG_HDD0_REQ_CTL: begin
-                        hdd_ready_r[0]    <= reg_wdata[0];
-                        hdd_mounted_r[0]  <= reg_wdata[1];
-                        hdd_readonly_r[0] <= reg_wdata[2];
+                        hdd_ready_r[0]    <= reg_wr_data_w[0];
+                        hdd_mounted_r[0]  <= reg_wr_data_w[1];
+                        hdd_readonly_r[0] <= reg_wr_data_w[2];
+                    end
+                    REG_HDD0_LBA_L:   hdd_size_r[0][7:0]  <= reg_wr_data_w;
+                    REG_HDD0_LBA_H:   hdd_size_r[0][15:8] <= reg_wr_data_w;
+                    REG_HDD0_ACK: begin
+                        hdd_ack_r[0] <= 1'b1;
+                        hdd_err_r[0] <= reg_wr_data_w[1];
                     end
-                    REG_HDD0_LBA_L:   hdd_size_r[0][7:0]  <= reg_wdata;
-                    REG_HDD0_LBA_H:   hdd_size_r[0][15:8] <= reg_wdata;
-                    REG_HDD0_ACK:     hdd_ack_r[0] <= 1'b1;
                     REG_HDD1_REQ_CTL: begin
-                        hdd_ready_r[1]    <= reg_wdata[0];
-                        hdd_mounted_r[1]  <= reg_wdata[1];
-                        hdd_readonly_r[1] <= reg_wdata[2];
+                        hdd_ready_r[1]    <= reg_wr_data_w[0];
+                        hdd_mounted_r[1]  <= reg_wr_data_w[1];
+                        hdd_readonly_r[1] <= reg_wr_data_w[2];
+                    end
+                    REG_HDD1_LBA_L:   hdd_size_r[1][7:0]  <= reg_wr_data_w;
+                    REG_HDD1_LBA_H:   hdd_size_r[1][15:8] <= reg_wr_data_w;
+                    REG_HDD1_ACK: begin
+                        hdd_ack_r[1] <= 1'b1;
+                        hdd_err_r[1] <= reg_wr_data_w[1];
                     end
-                    REG_HDD1_LBA_L:   hdd_size_r[1][7:0]  <= reg_wdata;
-                    REG_HDD1_LBA_H:   hdd_size_r[1][15:8] <= reg_wdata;
-                    REG_HDD1_ACK:     hdd_ack_r[1] <= 1'b1;
 
-                    REG_A2_RST_RELEASE: a2_rst_release_r <= reg_wdata[0];
+                    REG_A2_RST_RELEASE: a2_rst_release_r <= reg_wr_data_w[0];
+                    REG_ATTN_MASK:    attn_mask_r <= reg_wr_data_w[5:3];
 
-                    REG_SLOT_SELECT:  slot_select_r <= reg_wdata[2:0];
+                    REG_SLOT_SELECT:  slot_select_r <= reg_wr_data_w[2:0];
                     REG_SLOT_CARD: begin
-                        slot_card_r <= reg_wdata;
+                        slot_card_r <= reg_wr_data_w;
                         slot_wr_r <= 1'b1;   // latch into the slot table now
                     end
-                    REG_SLOT_RECONFIG:slot_reconfig_r <= reg_wdata[0];
+                    REG_SLOT_RECONFIG:slot_reconfig_r <= reg_wr_data_w[0];
 
-                    REG_DBG_MEM_A0:   dbg_mem_addr_r[7:0]   <= reg_wdata;
-                    REG_DBG_MEM_A1:   dbg_mem_addr_r[15:8]  <= reg_wdata;
-                    REG_DBG_MEM_A2:   dbg_mem_addr_r[20:16] <= reg_wdata[4:0];
+                    REG_DBG_MEM_A0:   dbg_mem_addr_r[7:0]   <= reg_wr_data_w;
+                    REG_DBG_MEM_A1:   dbg_mem_addr_r[15:8]  <= reg_wr_data_w;
+                    REG_DBG_MEM_A2:   dbg_mem_addr_r[20:16] <= reg_wr_data_w[4:0];
                     REG_DBG_MEM_GO:   dbg_mem_go_r <= 1'b1;
-
-                    REG_VOL0_READY:   vol_ready_r[0] <= reg_wdata[0];
-                    REG_VOL0_MOUNTED: vol_mounted_r[0] <= reg_wdata[0];
-                    REG_VOL0_READONLY:vol_readonly_r[0] <= reg_wdata[0];
-                    REG_VOL0_SIZE_0:  vol_size_r[0][7:0] <= reg_wdata;
-                    REG_VOL0_SIZE_1:  vol_size_r[0][15:8] <= reg_wdata;
-                    REG_VOL0_SIZE_2:  vol_size_r[0][23:16] <= reg_wdata;
-                    REG_VOL0_SIZE_3:  vol_size_r[0][31:24] <= reg_wdata;
+                    REG_DBG_VIDEO_SS: dbg_page_r <= reg_wr_data_w[0];
+
+                    REG_VOL0_READY:   vol_ready_r[0] <= reg_wr_data_w[0];
+                    REG_VOL0_MOUNTED: vol_mounted_r[0] <= reg_wr_data_w[0];
+                    REG_VOL0_READONLY:vol_readonly_r[0] <= reg_wr_data_w[0];
+                    REG_VOL0_SIZE_0:  vol_size_r[0][7:0] <= reg_wr_data_w;
+                    REG_VOL0_SIZE_1:  vol_size_r[0][15:8] <= reg_wr_data_w;
+                    REG_VOL0_SIZE_2:  vol_size_r[0][23:16] <= reg_wr_data_w;
+                    REG_VOL0_SIZE_3:  vol_size_r[0][31:24] <= reg_wr_data_w;
                     REG_VOL0_ACK:     vol_ack_r[0] <= 1'b1;   // one-shot strobe
 
-                    REG_VOL1_READY:   vol_ready_r[1] <= reg_wdata[0];
-                    REG_VOL1_MOUNTED: vol_mounted_r[1] <= reg_wdata[0];
-                    REG_VOL1_READONLY:vol_readonly_r[1] <= reg_wdata[0];
-                    REG_VOL1_SIZE_0:  vol_size_r[1][7:0] <= reg_wdata;
-                    REG_VOL1_SIZE_1:  vol_size_r[1][15:8] <= reg_wdata;
-                    REG_VOL1_SIZE_2:  vol_size_r[1][23:16] <= reg_wdata;
-                    REG_VOL1_SIZE_3:  vol_size_r[1][31:24] <= reg_wdata;
+                    REG_VOL1_READY:   vol_ready_r[1] <= reg_wr_data_w[0];
+                    REG_VOL1_MOUNTED: vol_mounted_r[1] <= reg_wr_data_w[0];
+                    REG_VOL1_READONLY:vol_readonly_r[1] <= reg_wr_data_w[0];
+                    REG_VOL1_SIZE_0:  vol_size_r[1][7:0] <= reg_wr_data_w;
+                    REG_VOL1_SIZE_1:  vol_size_r[1][15:8] <= reg_wr_data_w;
+                    REG_VOL1_SIZE_2:  vol_size_r[1][23:16] <= reg_wr_data_w;
+                    REG_VOL1_SIZE_3:  vol_size_r[1][31:24] <= reg_wr_data_w;
                     REG_VOL1_ACK:     vol_ack_r[1] <= 1'b1;   // one-shot strobe
 
-                    REG_U2_DOORBELL:  w5100_cmd_clr_r <= reg_wdata[3:0];
+                    REG_U2_DOORBELL:  w5100_cmd_clr_r <= reg_wr_data_w[3:0];
+
+                    REG_OSD_SCROLL:   osd_scroll_r <= (reg_wr_data_w[4:0] < 5'd24) ?
+                                                      reg_wr_data_w[4:0] : 5'd0;
 
                     REG_GPU_CONTROL: begin
-                        gpu_trigger_r <= reg_wdata[0];
-                        gpu_pause_r <= reg_wdata[1];
+                        gpu_trigger_r <= reg_wr_data_w[0];
+                        gpu_pause_r <= reg_wr_data_w[1];
                     end
-                    REG_GPU_PC_L:     gpu_load_pc_r[7:0] <= reg_wdata;
-                    REG_GPU_PC_H:     gpu_load_pc_r[15:8] <= reg_wdata;
-                    REG_GPU_VADDR_L:  gpu_vaddr_r[7:0] <= reg_wdata;
-                    REG_GPU_VADDR_H:  gpu_vaddr_r[13:8] <= reg_wdata[5:0];
+                    REG_GPU_PC_L:     gpu_load_pc_r[7:0] <= reg_wr_data_w;
+                    REG_GPU_PC_H:     gpu_load_pc_r[15:8] <= reg_wr_data_w;
+                    REG_GPU_VADDR_L:  gpu_vaddr_r[7:0] <= reg_wr_data_w;
+                    REG_GPU_VADDR_H:  gpu_vaddr_r[13:8] <= reg_wr_data_w[5:0];
                     REG_GPU_VDATA: begin
-                        gpu_vdata_r <= reg_wdata;
+                        gpu_vdata_r <= reg_wr_data_w;
                         gpu_vwe_r <= 1'b1;
                     end
-                    REG_GPU_PADDR:    gpu_paddr_r <= reg_wdata[5:0];
-                    REG_GPU_PDATA_L:  gpu_pdata_r[7:0] <= reg_wdata;
+                    REG_GPU_PADDR:    gpu_paddr_r <= reg_wr_data_w[5:0];
+                    REG_GPU_PDATA_L:  gpu_pdata_r[7:0] <= reg_wr_data_w;
                     REG_GPU_PDATA_H: begin
-                        gpu_pdata_r[11:8] <= reg_wdata[3:0];
+                        gpu_pdata_r[11:8] <= reg_wr_data_w[3:0];
                         gpu_pwe_r <= 1'b1;
                     end
-                    REG_GPU_RADDR_L:  gpu_raddr_r[7:0] <= reg_wdata;
-                    REG_GPU_RADDR_H:  gpu_raddr_r[13:8] <= reg_wdata[5:0];
+                    REG_GPU_RADDR_L:  gpu_raddr_r[7:0] <= reg_wr_data_w;
+                    REG_GPU_RADDR_H:  gpu_raddr_r[13:8] <= reg_wr_data_w[5:0];
                     REG_GPU_RDATA: begin
-                        gpu_rdata_r <= reg_wdata;
+                        gpu_rdata_r <= reg_wr_data_w;
                         gpu_rwe_r <= 1'b1;
                     end
 
@@ -888,22 +1012,22 @@ module esp32_ospi_connector #(
     assign disk_ram_if.ready = disk_ram_ready_r;
 
     // =========================================================================
-    // HDD block buffers (SPACE 5) — 1KB as a single 32-bit BSRAM (512 words
-    // declared for a natural BSRAM shape; the low 256 = 2 units x 128 words
-    // are used). The HDD card is a pure 32-bit port (its byte_en is
-    // hardwired to 4'b1111), so no byte lanes are needed. The ESP32's byte
-    // writes are accumulated into words — SPACE 5 writes must be sequential
-    // and 4-byte aligned, which the 512-byte block streams are.
+    // HDD block rings (SPACE 5) — 4KB as a single 32-bit BSRAM: 2 units x 4
+    // slots x 128 words (the HDD card's RING_LOG2 = 2; a multi-block request
+    // streams up to 4 blocks in one XFER). The HDD card is a pure 32-bit port
+    // (its byte_en is hardwired to 4'b1111), so no byte lanes are needed. The
+    // ESP32's byte writes are accumulated into words — SPACE 5 writes must be
+    // sequential and 4-byte aligned, which the 512-byte block streams are.
     // =========================================================================
-    reg [31:0] hdd_mem [0:511] /* synthesis syn_ramstyle = "block_ram" */;
+    reg [31:0] hdd_mem [0:1023] /* synthesis syn_ramstyle = "block_ram" */;
     reg [23:0] hdd_acc_r;
     reg [31:0] hdd_esp_q32;
     reg [31:0] hdd_card_q32;
 
     wire hdd_esp_wr_w = mem_wr_en && (mem_space == SPACE_HDD);
     wire hdd_esp_word_wr_w = hdd_esp_wr_w && (mem_wr_addr[1:0] == 2'd3);
-    wire [8:0] hdd_esp_addr_w = hdd_esp_wr_w ? {1'b0, mem_wr_addr[9:2]}
-                                             : {1'b0, mem_rd_addr[9:2]};
+    wire [9:0] hdd_esp_addr_w = hdd_esp_wr_w ? mem_wr_addr[11:2]
+                                             : mem_rd_addr[11:2];
 
     always @(posedge clk) begin
         if (hdd_esp_wr_w && mem_wr_addr[1:0] != 2'd3)
@@ -919,9 +1043,9 @@ module esp32_ospi_connector #(
 
     always @(posedge clk) begin : hdd_port_card
         if (hdd_ram_if.wr)
-            hdd_mem[{1'b0, hdd_ram_if.addr[7:0]}] <= hdd_ram_if.data;
+            hdd_mem[hdd_ram_if.addr[9:0]] <= hdd_ram_if.data;
         else
-            hdd_card_q32 <= hdd_mem[{1'b0, hdd_ram_if.addr[7:0]}];
+            hdd_card_q32 <= hdd_mem[hdd_ram_if.addr[9:0]];
     end
 
     assign hdd_ram_if.q = hdd_card_q32;
@@ -967,6 +1091,11 @@ module esp32_ospi_connector #(
         mem0_rd_data <= mem0[mem_rd_addr[5:0]];
     end
 
+    always @(posedge clk) begin
+        if (regs_xr_w)
+            regs_rd_q <= reg_rdata;
+    end
+
     // Pipeline the request, space and byte lane to match BRAM latency
     reg mem_rd_req_r;
 
@@ -994,6 +1123,7 @@ module esp32_ospi_connector #(
                 SPACE_W5100: mem_rd_data <= w5100_host_rdata;
                 SPACE_DISK:  mem_rd_data <= disk_esp_q[mem_rd_lane_r];
                 SPACE_HDD:   mem_rd_data <= hdd_esp_q32[mem_rd_lane_r*8 +: 8];
+                SPACE_REGS:  mem_rd_data <= regs_rd_q;
                 default:     mem_rd_data <= 8'hFF;
             endcase
         end
@@ -1005,7 +1135,8 @@ module esp32_ospi_connector #(
     esp32_ospi_proto_proc #(
         .USE_SYNC(USE_SYNC),
         .USE_CRC(USE_CRC),
-        .IDLE_TO_CYC(IDLE_TO_CYC)
+        .IDLE_TO_CYC(IDLE_TO_CYC),
+        .RD_PF_LOG2(RD_PF_LOG2)
     ) proto (
         .clk(clk),
         .rst_n(rst_n),
@@ -1026,7 +1157,9 @@ module esp32_ospi_connector #(
         .mem_rd_space(mem_rd_space),
         .mem_rd_addr(mem_rd_addr),
         .mem_rd_valid(mem_rd_valid),
-        .mem_rd_data(mem_rd_data)
+        .mem_rd_data(mem_rd_data),
+        .crc_ok_cnt(crc_ok_cnt),
+        .crc_err_cnt(crc_err_cnt)
     );
 
 endmodule
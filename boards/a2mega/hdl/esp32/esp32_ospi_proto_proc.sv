@@ -9,7 +9,8 @@
 module esp32_ospi_proto_proc #(
     parameter USE_SYNC    = 1,
     parameter USE_CRC     = 0,
-    parameter IDLE_TO_CYC = 54_000
+    parameter IDLE_TO_CYC = 54_000,
+    parameter RD_PF_LOG2  = 3        // XFER read prefetch depth, log2 (1-7)
 )(
     input  wire        clk,
     input  wire        rst_n,
@@ -37,9 +38,32 @@ module esp32_ospi_proto_proc #(
     output reg  [2:0]  mem_rd_space,
     output reg  [23:0] mem_rd_addr,
     input  wire        mem_rd_valid,
-    input  wire [7:0]  mem_rd_data
+    input  wire [7:0]  mem_rd_data,
+
+    // CRC'd XFER writes whose trailer matched / did not (mod 256)
+    output reg  [7:0]  crc_ok_cnt,
+    output reg  [7:0]  crc_err_cnt
 );
 
+    // XFER CRC (SUB0[5], with USE_CRC): CRC-16/CCITT-FALSE (poly 0x1021,
+    // init 0xFFFF) over SUB0, ADDR0-2, LEN0-1 and the payload, sent MSB first
+    // after the payload — by the master on writes, by us on reads. Covering
+    // the header means a frame that landed at the wrong address or length
+    // fails too. Writes also carry the CRC of the header alone right after
+    // LEN1, checked before the first payload byte is committed: a write whose
+    // header fails is dropped whole instead of landing somewhere else (or
+    // firing a register-window side effect).
+    function [15:0] crc16_byte(input [15:0] c, input [7:0] d);
+        integer i;
+        reg [15:0] x;
+        begin
+            x = c ^ {d, 8'h00};
+            for (i = 0; i < 8; i = i + 1)
+                x = x[15] ? ({x[14:0], 1'b0} ^ 16'h1021) : {x[14:0], 1'b0};
+            crc16_byte = x;
+        end
+    endfunction
+
     // Synchronize SCLK and data to system clock
     reg sclk_q1, sclk_q2;
     reg [7:0] data_q1, data_q2;
@@ -132,17 +156,96 @@ module esp32_ospi_proto_proc #(
     reg [15:0] len, len_cnt;
     reg sub_dir, sub_crc, sub_inc;
     reg [2:0] sub_space;
-    reg [7:0] crc_hdr, crc_pl;
+    reg [15:0] xcrc;          // header + write payload, as received
+    reg [15:0] tx_crc;        // header + read payload, as driven
+    reg        crc_idx;       // trailer byte 0 (MSB) / 1
+    reg [7:0]  crc_rx_hi;
+    reg        hdr_bad;       // write header CRC failed: drop the payload
+    wire       crc_on = (USE_CRC != 0) && sub_crc;
 
-    // Read pipeline buffer
-    reg [7:0] rd_buf;
-    reg rd_buf_valid;
     reg [7:0] reg_read_value;
     reg load_reg_read_next;
 
     // TX data management - output on falling edge
     reg [7:0] tx_next;
 
+    // XFER read prefetch. The header's last byte starts a run of reads over
+    // the whole payload range, kept up to PF_DEPTH bytes ahead of the
+    // master. The connector's read path is a fixed 2-clk pipeline taking a
+    // request every clk, so the FIFO is full before the dummy slot ends and
+    // refills within 3 clks of each pop — no longer a race against the next
+    // SCLK fall, as the old one-byte buffer was. Every payload slot pops one
+    // entry whether or not its byte came back in time: an underrun drives FF
+    // (and fails the CRC) but the stream stays aligned with the master's
+    // byte count. Reads only ever cover the requested range, so the register
+    // window's read side effects are unchanged, just earlier.
+    localparam PF_DEPTH = 1 << RD_PF_LOG2;
+
+    reg  [7:0]              pf_mem [0:PF_DEPTH-1];
+    reg  [RD_PF_LOG2-1:0]   pf_wp, pf_rp;
+    reg  [RD_PF_LOG2:0]     pf_out;     // issued, not yet popped
+    reg  signed [RD_PF_LOG2+1:0] pf_level;   // arrived minus popped (<= 0: empty)
+    reg  [15:0]             pf_left;    // reads still to issue
+    reg  [23:0]             pf_addr;
+
+    wire       pf_start   = byte_rx_stb && (st == ST_XL1) && sub_dir;
+    wire       pf_pop     = byte_rx_stb && (st == ST_XPAY_RD) && (len_cnt != 16'd0);
+    wire       pf_issue   = (pf_left != 16'd0) && (pf_out < PF_DEPTH);
+    wire       pf_head_ok = (pf_level > 0);
+    wire [7:0] pf_head    = pf_head_ok ? pf_mem[pf_rp] : 8'hFF;
+
+    always @(posedge clk) begin
+        if (mem_rd_valid)
+            pf_mem[pf_wp] <= mem_rd_data;
+    end
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            pf_wp <= 0;
+            pf_rp <= 0;
+            pf_out <= 0;
+            pf_level <= 0;
+            pf_left <= 16'd0;
+            pf_addr <= 24'd0;
+            mem_rd_req <= 1'b0;
+            mem_rd_addr <= 24'd0;
+        end else begin
+            mem_rd_req <= 1'b0;
+            if (pf_start) begin
+                // addr is complete; LEN1 is the byte being strobed
+                pf_addr <= addr;
+                pf_left <= {rx_byte, len[7:0]};
+                pf_wp <= 0;
+                pf_rp <= 0;
+                pf_out <= 0;
+                pf_level <= 0;
+            end else begin
+                if (pf_issue) begin
+                    mem_rd_req <= 1'b1;
+                    mem_rd_addr <= pf_addr;
+                    if (sub_inc) pf_addr <= pf_addr + 24'd1;
+                    pf_left <= pf_left - 16'd1;
+                end
+                if (mem_rd_valid)
+                    pf_wp <= pf_wp + 1'b1;
+                if (pf_pop)
+                    pf_rp <= pf_rp + 1'b1;
+                case ({pf_issue, pf_pop})
+                    2'b10:   pf_out <= pf_out + 1'b1;
+                    2'b01:   pf_out <= pf_out - 1'b1;
+                    default: ;
+                endcase
+                case ({mem_rd_valid, pf_pop})
+                    2'b10:   pf_level <= pf_level + 1;
+                    2'b01:   pf_level <= pf_level - 1;
+                    default: ;
+                endcase
+                if (idle_expired)
+                    pf_left <= 16'd0;
+            end
+        end
+    end
+
     // The data bus is SHARED (8-bit bidirectional, no separate MISO): the
     // FPGA may only drive during genuine response slots, i.e. after a
     // register-read opcode (data byte, then status byte) and during the
@@ -168,12 +271,21 @@ module esp32_ospi_proto_proc #(
         if (!rst_n) begin
             data_out <= 8'hFF;
             data_oe <= 0;
+            tx_crc <= 16'hFFFF;
         end else if (sclk_fall) begin
             if (st == ST_XPAY_RD_DMY) begin
                 data_out <= status_byte;   // dummy slot returns real status
                 data_oe <= 1;
-            end else if (st == ST_XPAY_RD) begin
-                data_out <= rd_buf_valid ? rd_buf : 8'hFF;
+                tx_crc <= xcrc;
+            end else if (st == ST_XPAY_RD && len_cnt != 16'd0) begin
+                // The CRC follows what is actually driven: an FF fill (read
+                // data not back in time) fails the check instead of passing
+                // as data.
+                data_out <= pf_head;
+                data_oe <= 1;
+                tx_crc <= crc16_byte(tx_crc, pf_head);
+            end else if (st == ST_XPLCRC && sub_dir) begin
+                data_out <= crc_idx ? tx_crc[7:0] : tx_crc[15:8];
                 data_oe <= 1;
             end else if (reg_resp_cnt == 2'd2) begin
                 // Live mux, NOT a value latched at the opcode strobe:
@@ -214,10 +326,12 @@ module esp32_ospi_proto_proc #(
             sub_crc <= 0;
             sub_inc <= 0;
             sub_space <= 0;
-            crc_hdr <= 0;
-            crc_pl <= 0;
-            rd_buf <= 8'h00;
-            rd_buf_valid <= 0;
+            xcrc <= 16'hFFFF;
+            crc_idx <= 0;
+            crc_rx_hi <= 0;
+            hdr_bad <= 0;
+            crc_ok_cnt <= 0;
+            crc_err_cnt <= 0;
             load_reg_read_next <= 0;
             reg_wr_req <= 0;
             reg_rd_req <= 0;
@@ -227,27 +341,16 @@ module esp32_ospi_proto_proc #(
             mem_space <= 0;
             mem_wr_addr <= 0;
             mem_wr_data <= 0;
-            mem_rd_req <= 0;
             mem_rd_space <= 0;
-            mem_rd_addr <= 0;
         end else begin
             // One-shots
             reg_wr_req <= 0;
             reg_rd_req <= 0;
             mem_wr_en <= 0;
-            mem_rd_req <= 0;
             status_align <= 0;
 
-            if (idle_expired) begin
+            if (idle_expired)
                 st <= ST_IDLE;
-                rd_buf_valid <= 0;
-            end
-
-            // Latch memory read data
-            if (mem_rd_valid) begin
-                rd_buf <= mem_rd_data;
-                rd_buf_valid <= 1;
-            end
 
             if (byte_rx_stb) begin
                 load_reg_read_next <= 0;
@@ -257,8 +360,6 @@ module esp32_ospi_proto_proc #(
                         status_ok <= 1;
                         status_crcerr <= 0;
                         status_busy <= 0;
-                        crc_hdr <= 0;
-                        rd_buf_valid <= 0;
                         if (USE_SYNC) begin
                             st <= (rx_byte == 8'hA5) ? ST_SYNC1 : ST_IDLE;
                         end else begin
@@ -274,7 +375,6 @@ module esp32_ospi_proto_proc #(
                         if (rx_byte == 8'h5A) begin
                             status_align <= 1;
                             st <= ST_OPCODE;
-                            crc_hdr <= 0;
                         end else begin
                             st <= ST_IDLE;
                         end
@@ -283,7 +383,6 @@ module esp32_ospi_proto_proc #(
                     ST_OPCODE: begin
                         op_is_read <= rx_byte[7];
                         op_reg <= rx_byte[6:0];
-                        rd_buf_valid <= 0;
                         if (rx_byte[6:0] != 7'd127) begin
                             reg_idx <= rx_byte[6:0];
                             if (rx_byte[7]) begin  // READ
@@ -338,35 +437,60 @@ module esp32_ospi_proto_proc #(
                         sub_crc <= rx_byte[5];
                         addr <= 0;
                         len <= 0;
+                        hdr_bad <= 0;
+                        xcrc <= crc16_byte(16'hFFFF, rx_byte);
                         st <= ST_XA0;
                     end
 
                     ST_XA0: begin
                         addr[7:0] <= rx_byte;
+                        xcrc <= crc16_byte(xcrc, rx_byte);
                         st <= ST_XA1;
                     end
 
                     ST_XA1: begin
                         addr[15:8] <= rx_byte;
+                        xcrc <= crc16_byte(xcrc, rx_byte);
                         st <= ST_XA2;
                     end
 
                     ST_XA2: begin
                         addr[23:16] <= rx_byte;
+                        xcrc <= crc16_byte(xcrc, rx_byte);
                         st <= ST_XL0;
                     end
 
                     ST_XL0: begin
                         len[7:0] <= rx_byte;
+                        xcrc <= crc16_byte(xcrc, rx_byte);
                         st <= ST_XL1;
                     end
 
                     ST_XL1: begin
                         len[15:8] <= rx_byte;
                         len_cnt <= {rx_byte, len[7:0]};
+                        xcrc <= crc16_byte(xcrc, rx_byte);
                         mem_space <= sub_space;
                         mem_rd_space <= sub_space;
-                        st <= sub_dir ? ST_XPAY_RD_DMY : ST_XPAY_WR;
+                        crc_idx <= 0;
+                        st <= sub_dir ? ST_XPAY_RD_DMY :
+                              crc_on  ? ST_XHDRC : ST_XPAY_WR;
+                    end
+
+                    // Write header CRC, two bytes (not part of xcrc, which
+                    // goes on over the payload for the trailer)
+                    ST_XHDRC: begin
+                        crc_idx <= 1;
+                        if (!crc_idx) begin
+                            crc_rx_hi <= rx_byte;
+                        end else begin
+                            if ({crc_rx_hi, rx_byte} != xcrc) begin
+                                hdr_bad <= 1;
+                                crc_err_cnt <= crc_err_cnt + 8'd1;
+                                status_crcerr <= 1;
+                            end
+                            st <= ST_XPAY_WR;
+                        end
                     end
 
                     // WRITE payload
@@ -375,42 +499,67 @@ module esp32_ospi_proto_proc #(
                             st <= ST_DONE;
                         end else begin
                             // Write applies to every space; the connector routes
-                            // mem_space to the right backing store.
+                            // mem_space to the right backing store. A bad
+                            // header still consumes its LEN bytes, unwritten.
                             mem_wr_addr <= addr;
                             mem_wr_data <= rx_byte;
-                            mem_wr_en <= 1;
+                            mem_wr_en <= !hdr_bad;
+                            xcrc <= crc16_byte(xcrc, rx_byte);
                             len_cnt <= len_cnt - 16'd1;
                             if (sub_inc) addr <= addr + 24'd1;
-                            if (len_cnt == 16'd1) st <= ST_DONE;
+                            if (len_cnt == 16'd1) begin
+                                crc_idx <= 0;
+                                st <= crc_on ? ST_XPLCRC : ST_DONE;
+                            end
                         end
                     end
 
-                    // READ payload with dummy
+                    // READ payload with dummy; the prefetch engine has been
+                    // issuing the reads since LEN1
                     ST_XPAY_RD_DMY: begin
-                        mem_rd_addr <= addr;
-                        mem_rd_req <= 1;
-                        st <= ST_XPAY_RD;
+                        crc_idx <= 0;
+                        st <= (len_cnt != 0) ? ST_XPAY_RD :
+                              crc_on         ? ST_XPLCRC  : ST_DONE;
                     end
 
+                    // One byte per slot (pf_pop), filled or not. Leave on the
+                    // last one, as the write side does: the master starts
+                    // the next op right after it, without a wake byte.
                     ST_XPAY_RD: begin
                         if (len_cnt == 0) begin
                             st <= ST_DONE;
                         end else begin
-                            if (rd_buf_valid) begin
-                                len_cnt <= len_cnt - 16'd1;
-                                rd_buf_valid <= 0;
-                                if (len_cnt > 16'd1) begin
-                                    mem_rd_addr <= sub_inc ? (addr + 24'd1) : addr;
-                                    mem_rd_req <= 1;
-                                    if (sub_inc) addr <= addr + 24'd1;
-                                end
+                            len_cnt <= len_cnt - 16'd1;
+                            if (len_cnt == 16'd1) begin
+                                crc_idx <= 0;
+                                st <= crc_on ? ST_XPLCRC : ST_DONE;
+                            end
+                        end
+                    end
+
+                    // CRC trailer, two bytes: driven by us after a read
+                    // payload, checked against xcrc after a write payload.
+                    // The payload has landed by now, but only at the address
+                    // and length the master meant (ST_XHDRC); the counters
+                    // tell it whether to send the data again. A frame whose
+                    // header failed was counted there.
+                    ST_XPLCRC: begin
+                        crc_idx <= 1;
+                        if (!sub_dir && !hdr_bad) begin
+                            if (!crc_idx) begin
+                                crc_rx_hi <= rx_byte;
+                            end else if ({crc_rx_hi, rx_byte} == xcrc) begin
+                                crc_ok_cnt <= crc_ok_cnt + 8'd1;
+                            end else begin
+                                crc_err_cnt <= crc_err_cnt + 8'd1;
+                                status_crcerr <= 1;
                             end
                         end
+                        if (crc_idx) st <= ST_DONE;
                     end
 
                     default: begin
                         st <= ST_IDLE;
-                        rd_buf_valid <= 0;
                         status_ok <= 0;
                     end
                 endcase
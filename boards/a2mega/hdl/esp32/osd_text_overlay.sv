@@ -28,6 +28,10 @@
 // scaled 2x to 14x16 cells: 40*14 = 560 x 24*16 = 384, centered in 720x480.
 // Screen-code semantics (inverse $00-$3F, flash $40-$7F) match the Apple II.
 //
+// Hardware scrolling: row_offset_i names the text page row shown at the top,
+// so the ESP32 scrolls by bumping the offset and rewriting one row instead of
+// the whole page. It is sampled at the top of each frame.
+//
 // Each 14-pixel cell k prefetches the character for cell k+1: the text RAM
 // read (registered, external port) and the font ROM read each take a cycle,
 // and the assembled row byte is latched at the cell boundary. Cell 0 starts
@@ -41,6 +45,7 @@ module osd_text_overlay #(
     input  wire        reset_n,
 
     input  wire        enable_i,
+    input  wire [4:0]  row_offset_i,     // page row at screen row 0 (0-23)
 
     input  wire [10:0] screen_x_i,
     input  wire [9:0]  screen_y_i,
@@ -98,8 +103,20 @@ module osd_text_overlay #(
     wire [4:0] char_row = rel_y[8:4];     // 0-23
     wire [2:0] glyph_line = rel_y[3:1];   // 2x vertical scale
 
+    reg [4:0] row_offset_r;
+    always @(posedge clk_i or negedge reset_n) begin
+        if (!reset_n)
+            row_offset_r <= 5'd0;
+        else if (screen_y_i == 10'd0)
+            row_offset_r <= row_offset_i;
+    end
+
+    // Page row = (screen row + offset) mod 24
+    wire [5:0] row_sum  = {1'b0, char_row} + {1'b0, row_offset_r};
+    wire [4:0] page_row = (row_sum >= 6'd24) ? 5'(row_sum - 6'd24) : row_sum[4:0];
+
     // row * 40 = (row << 5) + (row << 3)
-    wire [10:0] row_base = ({6'b0, char_row} << 5) + ({6'b0, char_row} << 3);
+    wire [10:0] row_base = ({6'b0, page_row} << 5) + ({6'b0, page_row} << 3);
 
     // ------------------------------------------------------------------------
     // Horizontal cell walker with one-cell prefetch
@@ -19,11 +19,13 @@
 // Unified DDR3 shadow memory for Apple II text, hires, and VGC aux data.
 // Text ($0400-$0BFF) uses flat shadow format. Hires and VGC ($2000-$9FFF)
 // use a unified 128-bit layout: one DDR3 burst = main + aux_2000 + aux_6000
-// for 4 consecutive addresses. Single-entry burst cache for video reads.
+// for 4 consecutive addresses. Single-entry burst cache for video reads,
+// plus a 2^PF_GROUPS_LOG2-group prefetch queue kept ahead of the generators.
 //
 
 module apple_memory #(
-    parameter VGC_MEMORY = 0  // 1 = extend aux memory to 32KB for VGC, 0 = 16KB
+    parameter VGC_MEMORY = 0,     // 1 = extend aux memory to 32KB for VGC, 0 = 16KB
+    parameter PF_GROUPS_LOG2 = 1  // video prefetch queue depth in groups, log2 (1-3)
 ) (
     a2bus_if.slave a2bus_if,
     a2mem_if.master a2mem_if,
@@ -48,7 +50,14 @@ module apple_memory #(
     output [7:0] dbg_shadow_drop_o,
 
     // Debug: read FSM snapshot {vid_req, rd_is_vgc, cache_valid, vgc_req, 0, rd_state}
-    output [7:0] dbg_rd_state_o
+    output [7:0] dbg_rd_state_o,
+
+    // Debug, per frame (latched on frame_i, saturating): generator words
+    // that missed the prefetch queue and waited out a DDR3 burst, and the
+    // most groups the queue held ahead of the consumer
+    input             frame_i,
+    output reg [15:0] dbg_late_o,
+    output reg [15:0] dbg_pf_depth_o
 );
 
     wire write_strobe = !a2bus_if.rw_n && a2bus_if.data_in_strobe;
@@ -377,47 +386,75 @@ module apple_memory #(
     wire vgc_cache_hit_w = cache_valid_r && (cache_tag_r == vgc_group_w);
 
     // =========================================================================
-    // VGC next-group prefetch store
+    // Video prefetch queue
     // =========================================================================
     // The VGC's per-word fetch budget in SHR is ~16 pixel clocks; a cache-miss
     // burst round trip through the CDC + arbiter does not reliably fit, and a
     // single late word phase-slips the rest of the scanline (live-verified:
-    // moving horizontal smear on STATIC SHR screens; vgc_gen dbg_starved
-    // counts the events). VGC accesses are strictly sequential and SHR groups
-    // are contiguous across the whole frame, so after each VGC serve the FSM
-    // speculatively burst-loads group+1 into this second store during idle
-    // cycles — steady state renders entirely from prefetched data.
-    reg [31:0] vnext_r [0:3];
-    reg [11:0] vnext_tag_r;
-    reg        vnext_valid_r;
-    reg [11:0] pf_want_tag_r;   // next group worth prefetching
-    reg        pf_want_r;       // a prefetch is desired
+    // moving horizontal smear on STATIC SHR screens; vgc_gen dbg_stalls
+    // counts the events). Both generators read strictly sequentially within
+    // a line and SHR groups are contiguous across the whole frame, so the FSM
+    // speculatively burst-loads the groups after the one being served, in
+    // idle cycles, into PF_N direct-mapped slots (slot = tag mod PF_N).
+    //
+    // The single next-group store this replaces was only armed once the
+    // current group's odd word was served, so group+1 had one word time to
+    // land and any refresh or framebuffer burst in between made the next
+    // word late. The queue runs a full group ahead: while group g is being
+    // served, g+1 .. g+PF_N-1 are wanted, and g+PF_N joins once g's odd word
+    // is out — only then may it take g's slot. SCB/palette reads (VGC words
+    // >= 8000) neither arm nor disturb it, so a line's first groups, fetched
+    // at the end of the previous line, survive the SCB and palette fetches.
+    localparam PF_N = 1 << PF_GROUPS_LOG2;
+    localparam [12:0] VGC_PIX_END = 13'd8000;   // SCB_BASE in vgc_gen
+
+    reg [31:0] vq_r [0:4*PF_N-1];
+    reg [11:0] vq_tag_r [0:PF_N-1];
+    reg [PF_N-1:0] vq_valid_r;
+    reg [11:0] pf_want_tag_r;   // next group to prefetch
+    reg [11:0] pf_fill_tag_r;   // group the in-flight prefetch burst loads
+    reg [11:0] pf_hi_tag_r;     // last group allowed ahead of the consumer
+    reg [11:0] pf_cur_tag_r;    // group last served to a generator
+    reg        pf_armed_r;      // a generator has set a window
+    reg        pf_hold_r;       // window/queue just changed: pf_ok_r is stale
     reg        pf_stale_r;      // write raced the in-flight prefetch burst
 
-    wire vgc_vnext_hit_w = vnext_valid_r && (vnext_tag_r == vgc_group_w);
+    wire [PF_GROUPS_LOG2-1:0] vgc_slot_w  = vgc_group_w[PF_GROUPS_LOG2-1:0];
+    wire [PF_GROUPS_LOG2-1:0] vid_slot_w  = vid_group_w[PF_GROUPS_LOG2-1:0];
+    wire [PF_GROUPS_LOG2-1:0] want_slot_w = pf_want_tag_r[PF_GROUPS_LOG2-1:0];
+
+    wire vgc_vq_hit_w = vq_valid_r[vgc_slot_w] && (vq_tag_r[vgc_slot_w] == vgc_group_w);
+    wire vid_vq_hit_w = vq_valid_r[vid_slot_w] && (vq_tag_r[vid_slot_w] == vid_group_w);
 
-    // Invalidate on writes to the held tag (mirror of cache_inv_write)
-    wire vnext_inv_write = vnext_valid_r && write_en && is_unified_write &&
-                           (vnext_tag_r == wr_unified_group);
+    // (pf_hi - pf_want) wraps to >= PF_N once the window is exhausted
+    wire [11:0] pf_room_w = pf_hi_tag_r - pf_want_tag_r;
+    wire        pf_want_w = pf_armed_r && (pf_room_w < PF_N);
 
     // Cache invalidation: snoop writes to unified region
     wire [11:0] wr_unified_group = unified_group;
     wire cache_inv_write = cache_valid_r && write_en && is_unified_write &&
                            (cache_tag_r == wr_unified_group);
 
+    // Invalidate on writes to a held tag (mirror of cache_inv_write); only
+    // the tag's own slot can hold it
+    wire [PF_GROUPS_LOG2-1:0] wr_slot_w = wr_unified_group[PF_GROUPS_LOG2-1:0];
+    wire vq_inv_write = vq_valid_r[wr_slot_w] && write_en && is_unified_write &&
+                        (vq_tag_r[wr_slot_w] == wr_unified_group);
+
     // Read state machine
     localparam RD_IDLE       = 3'd0;
     localparam RD_TEXT_WAIT  = 3'd1;  // Non-burst text read in flight
     localparam RD_BURST_WAIT = 3'd2;  // Burst read filling cache
     localparam RD_HIT_RESP   = 3'd3;  // Cache hit, 1-cycle ready pulse
-    localparam RD_PF_WAIT    = 3'd4;  // Speculative burst filling vnext
+    localparam RD_PF_WAIT    = 3'd4;  // Speculative burst filling a queue slot
 
     reg [2:0]  rd_state_r;
     reg [1:0]  burst_cnt_r;
     reg        rd_is_vgc_r;         // Which requester gets the response
     reg [14:0] rd_hires_offset_r;   // Latched for format conversion
     reg [12:0] rd_vgc_addr_r;       // Latched for VGC extraction
-    reg        rd_from_vnext_r;     // Hit was in the prefetch store
+    reg        rd_from_vq_r;        // Hit was in the prefetch queue
+    reg [PF_GROUPS_LOG2-1:0] rd_vq_slot_r;
 
     // (Port-busy retry needs no extra state: an ungranted request simply
     // stays latched in vid_req_r/vgc_req_r and retries every cycle.)
@@ -497,10 +534,11 @@ module apple_memory #(
     // Issue DDR3 read (text non-burst or unified burst on cache miss);
     // cache/prefetch hits respond without touching the port
     wire issue_text_rd   = grant_vid_w && vid_is_text_w && video_mem_if.available;
-    wire issue_vid_burst = grant_vid_w && !vid_is_text_w && !vid_cache_hit_w && video_mem_if.available;
-    wire hit_vid_w       = grant_vid_w && !vid_is_text_w && vid_cache_hit_w;
-    wire issue_vgc_burst = grant_vgc_w && !vgc_cache_hit_w && !vgc_vnext_hit_w && video_mem_if.available;
-    wire hit_vgc_w       = grant_vgc_w && (vgc_cache_hit_w || vgc_vnext_hit_w);
+    wire issue_vid_burst = grant_vid_w && !vid_is_text_w && !vid_cache_hit_w &&
+                           !vid_vq_hit_w && video_mem_if.available;
+    wire hit_vid_w       = grant_vid_w && !vid_is_text_w && (vid_cache_hit_w || vid_vq_hit_w);
+    wire issue_vgc_burst = grant_vgc_w && !vgc_cache_hit_w && !vgc_vq_hit_w && video_mem_if.available;
+    wire hit_vgc_w       = grant_vgc_w && (vgc_cache_hit_w || vgc_vq_hit_w);
     wire issue_burst_rd  = issue_vid_burst || issue_vgc_burst;
 
     // Speculative prefetch: only when the FSM is otherwise idle and the
@@ -508,25 +546,29 @@ module apple_memory #(
     // Pre-registered: the tag-compare chain fed video_mem_if.rd
     // combinationally at issue time and broke clk_logic timing (8 setup
     // endpoints through this cone). All inputs are registers, so evaluating
-    // one cycle behind is safe; the live pf_want_r term prevents re-issue in
-    // the transitional cycle after a prefetch completes.
-    reg pf_ok_r;
+    // one cycle behind is safe; pf_hold_r blocks the cycle after the window
+    // or the queue changes, when pf_ok_r/pf_skip_r still describe the old
+    // state. A wanted group already held is skipped instead of fetched.
+    reg pf_ok_r, pf_skip_r;
+    wire pf_held_w = (vq_valid_r[want_slot_w] && vq_tag_r[want_slot_w] == pf_want_tag_r) ||
+                     (cache_valid_r && cache_tag_r == pf_want_tag_r);
     always @(posedge a2bus_if.clk_logic or negedge a2bus_if.system_reset_n) begin
-        if (!a2bus_if.system_reset_n)
-            pf_ok_r <= 1'b0;
-        else
-            pf_ok_r <= pf_want_r &&
-                       !(vnext_valid_r && vnext_tag_r == pf_want_tag_r) &&
-                       !(cache_valid_r && cache_tag_r == pf_want_tag_r);
+        if (!a2bus_if.system_reset_n) begin
+            pf_ok_r   <= 1'b0;
+            pf_skip_r <= 1'b0;
+        end else begin
+            pf_ok_r   <= pf_want_w && !pf_held_w;
+            pf_skip_r <= pf_want_w && pf_held_w;
+        end
     end
     // During SHR a pending vid request is a DUMMY (completes in parallel,
     // touches no port) — it must not block prefetch arbitration. Without
     // this, apple_video_gen's instant-dummy spin keeps vid_req_r pending
     // nearly always and the prefetch never issues (live-measured: starved
     // counter saturated at 255/frame with the prefetch nominally in place).
-    wire issue_pf_burst = (rd_state_r == RD_IDLE) && !vgc_req_r &&
-                          (!vid_req_r || vgc_active_i) &&
-                          pf_want_r && pf_ok_r && video_mem_if.available;
+    wire pf_idle_w = (rd_state_r == RD_IDLE) && !vgc_req_r &&
+                     (!vid_req_r || vgc_active_i) && !pf_hold_r;
+    wire issue_pf_burst = pf_idle_w && pf_ok_r && video_mem_if.available;
 
     wire [11:0] issue_group_w = issue_vgc_burst ? vgc_group_w : vid_group_w;
 
@@ -534,6 +576,7 @@ module apple_memory #(
     wire [20:0] text_rd_addr    = {5'b0, vid_req_bank_r, vid_req_addr_r[15:1]};
     wire [20:0] unified_rd_addr = UNIFIED_OFFSET + {7'b0, issue_group_w, 2'b00};
     wire [20:0] pf_rd_addr      = UNIFIED_OFFSET + {7'b0, pf_want_tag_r, 2'b00};
+    wire [PF_GROUPS_LOG2-1:0] fill_slot_w = pf_fill_tag_r[PF_GROUPS_LOG2-1:0];
 
     // Request latch update: set on the generator's strobe, clear when the
     // FSM accepts the request (issue or cache hit). A generator never
@@ -541,6 +584,61 @@ module apple_memory #(
     wire vid_grant_fire_w = issue_text_rd || issue_vid_burst || hit_vid_w;
     wire vgc_grant_fire_w = issue_vgc_burst || hit_vgc_w;
 
+    // Serves that move the prefetch window: VGC pixel words and hires video
+    // words. The window reaches PF_N-1 groups past the served one, PF_N once
+    // its odd (second) word is out. A serve outside the current window (next
+    // frame, next hires line) restarts it at group+1.
+    wire        arm_vgc_w   = vgc_grant_fire_w && (vgc_req_addr_r < VGC_PIX_END);
+    wire        arm_vid_w   = vid_grant_fire_w && !vid_is_text_w;
+    wire        arm_w       = arm_vgc_w || arm_vid_w;
+    wire [11:0] arm_group_w = arm_vgc_w ? vgc_group_w : vid_group_w;
+    wire        arm_odd_w   = arm_vgc_w ? vgc_req_addr_r[0] : vid_hires_offset_w[1];
+    wire [11:0] arm_lead_w  = pf_want_tag_r - arm_group_w;   // 1..PF_N: in window
+    wire        pf_skip_w   = pf_idle_w && pf_skip_r;
+
+    // Generator words that had to wait out a DDR3 burst
+    wire late_w = issue_vid_burst || (issue_vgc_burst && vgc_req_addr_r < VGC_PIX_END);
+
+    // Queue slots holding groups ahead of the consumer (for max depth)
+    reg [PF_GROUPS_LOG2+1:0] pf_ahead_w;
+    reg [11:0] pf_dist_w;
+    integer qi;
+    always @(*) begin
+        pf_ahead_w = 0;
+        for (qi = 0; qi < PF_N; qi = qi + 1) begin
+            pf_dist_w = vq_tag_r[qi] - pf_cur_tag_r;
+            if (vq_valid_r[qi] && pf_dist_w != 12'd0 && pf_dist_w <= PF_N)
+                pf_ahead_w = pf_ahead_w + 1'b1;
+        end
+    end
+
+    // Per-frame telemetry, latched on the frame_i rising edge
+    reg        frame_prev_r;
+    reg [15:0] late_cnt_r;
+    reg [15:0] depth_max_r;
+    always @(posedge a2bus_if.clk_logic or negedge a2bus_if.system_reset_n) begin
+        if (!a2bus_if.system_reset_n) begin
+            frame_prev_r   <= 1'b0;
+            late_cnt_r     <= 16'd0;
+            depth_max_r    <= 16'd0;
+            dbg_late_o     <= 16'd0;
+            dbg_pf_depth_o <= 16'd0;
+        end else begin
+            frame_prev_r <= frame_i;
+            if (frame_i && !frame_prev_r) begin
+                dbg_late_o     <= late_cnt_r;
+                dbg_pf_depth_o <= depth_max_r;
+                late_cnt_r     <= 16'd0;
+                depth_max_r    <= 16'd0;
+            end else begin
+                if (late_w && late_cnt_r != 16'hFFFF)
+                    late_cnt_r <= late_cnt_r + 16'd1;
+                if (pf_ahead_w > depth_max_r)
+                    depth_max_r <= pf_ahead_w;
+            end
+        end
+    end
+
     always @(posedge a2bus_if.clk_logic or negedge a2bus_if.system_reset_n) begin
         if (!a2bus_if.system_reset_n) begin
             vid_req_r      <= 1'b0;
@@ -597,11 +695,15 @@ module apple_memory #(
             rd_vgc_addr_r        <= 13'd0;
             burst_data_stale_r   <= 1'b0;
             stale_scan_todo_r    <= 1'b0;
-            rd_from_vnext_r      <= 1'b0;
-            vnext_tag_r          <= 12'd0;
-            vnext_valid_r        <= 1'b0;
+            rd_from_vq_r         <= 1'b0;
+            rd_vq_slot_r         <= 0;
+            vq_valid_r           <= 0;
             pf_want_tag_r        <= 12'd0;
-            pf_want_r            <= 1'b0;
+            pf_fill_tag_r        <= 12'd0;
+            pf_hi_tag_r          <= 12'd0;
+            pf_cur_tag_r         <= 12'd0;
+            pf_armed_r           <= 1'b0;
+            pf_hold_r            <= 1'b0;
             pf_stale_r           <= 1'b0;
         end else begin
             // Default: clear ready pulses each cycle
@@ -616,19 +718,24 @@ module apple_memory #(
             // Cache invalidation on writes to same unified group
             if (cache_inv_write)
                 cache_valid_r <= 1'b0;
-            if (vnext_inv_write)
-                vnext_valid_r <= 1'b0;
-
-            // Arm the prefetch only when the SECOND (odd) word of a group is
-            // served — the group is finished only then. Arming on every serve
-            // let the prefetch overwrite vnext with group+1 while the current
-            // group's second word still needed it, evicting live data: every
-            // other group missed and starvation stayed saturated
-            // (live-measured: RD_BURST_WAIT frequent alongside RD_PF_WAIT).
-            if (vgc_grant_fire_w && vgc_req_addr_r[0]) begin
-                pf_want_tag_r <= vgc_group_w + 12'd1;
-                pf_want_r     <= 1'b1;
+            if (vq_inv_write)
+                vq_valid_r[wr_slot_w] <= 1'b0;
+
+            // Window update. g+PF_N shares g's slot, so it only enters the
+            // window once g's SECOND (odd) word is served — evicting a group
+            // before its second word is out made every other group miss
+            // (live-measured with the single-store prefetch, whose window
+            // was g+1 and armed on odd words only for the same reason).
+            if (arm_w) begin
+                pf_armed_r   <= 1'b1;
+                pf_cur_tag_r <= arm_group_w;
+                pf_hi_tag_r  <= arm_group_w + (PF_N - 1) + arm_odd_w;
+                if (!pf_armed_r || arm_lead_w == 12'd0 || arm_lead_w > PF_N)
+                    pf_want_tag_r <= arm_group_w + 12'd1;
+            end else if (pf_skip_w) begin
+                pf_want_tag_r <= pf_want_tag_r + 12'd1;
             end
+            pf_hold_r <= arm_w || pf_skip_w || vq_inv_write || cache_inv_write;
 
             begin
                 case (rd_state_r)
@@ -656,12 +763,17 @@ module apple_memory #(
                             rd_is_vgc_r       <= hit_vgc_w;
                             rd_hires_offset_r <= vid_hires_offset_w;
                             rd_vgc_addr_r     <= vgc_req_addr_r;
-                            rd_from_vnext_r   <= hit_vgc_w && !vgc_cache_hit_w;
+                            rd_from_vq_r      <= hit_vgc_w ? !vgc_cache_hit_w :
+                                                             !vid_cache_hit_w;
+                            rd_vq_slot_r      <= hit_vgc_w ? vgc_slot_w : vid_slot_w;
                             rd_state_r        <= RD_HIT_RESP;
                         end else if (issue_pf_burst) begin
-                            // Speculative next-group burst into vnext
-                            burst_cnt_r <= 2'd0;
-                            rd_state_r  <= RD_PF_WAIT;
+                            // Speculative burst into the wanted group's slot;
+                            // the slot's old group is finished (see window)
+                            burst_cnt_r   <= 2'd0;
+                            rd_state_r    <= RD_PF_WAIT;
+                            pf_fill_tag_r <= pf_want_tag_r;
+                            vq_valid_r[want_slot_w] <= 1'b0;
                             pf_stale_r  <=
                                 (write_en && is_unified_write &&
                                  (pf_want_tag_r == wr_unified_group));
@@ -710,43 +822,51 @@ module apple_memory #(
                     RD_HIT_RESP: begin
                         // Provide formatted data and pulse ready
                         if (rd_is_vgc_r) begin
-                            vgc_data_r  <= rd_from_vnext_r ?
+                            vgc_data_r  <= rd_from_vq_r ?
                                            interleave_mux(rd_vgc_addr_r[0],
-                                                          vnext_r[2], vnext_r[3]) :
+                                                          vq_r[{rd_vq_slot_r, 2'd2}],
+                                                          vq_r[{rd_vq_slot_r, 2'd3}]) :
                                            interleave_mux(rd_vgc_addr_r[0],
                                                           cache_r[2], cache_r[3]);
                             vgc_ready_r <= 1'b1;
                         end else begin
-                            video_data_r  <= interleave_mux(rd_hires_offset_r[1],
+                            video_data_r  <= rd_from_vq_r ?
+                                             interleave_mux(rd_hires_offset_r[1],
+                                                            vq_r[{rd_vq_slot_r, 2'd0}],
+                                                            vq_r[{rd_vq_slot_r, 2'd2}]) :
+                                             interleave_mux(rd_hires_offset_r[1],
                                                             cache_r[0], cache_r[2]);
                             video_ready_r <= 1'b1;
                         end
-                        rd_from_vnext_r <= 1'b0;
+                        rd_from_vq_r <= 1'b0;
                         rd_state_r <= RD_IDLE;
                     end
 
-                    // Speculative prefetch burst filling vnext. Same stale
-                    // snooping discipline as RD_BURST_WAIT.
+                    // Speculative prefetch burst filling a queue slot. Same
+                    // stale snooping discipline as RD_BURST_WAIT.
                     RD_PF_WAIT: begin
                         // Deferred shadow-FIFO scan (see issue site)
                         if (stale_scan_todo_r) begin
-                            if (shadow_pending_matches(pf_want_tag_r))
+                            if (shadow_pending_matches(pf_fill_tag_r))
                                 pf_stale_r <= 1'b1;
                             stale_scan_todo_r <= 1'b0;
                         end
                         if (write_en && is_unified_write &&
-                            (pf_want_tag_r == wr_unified_group))
+                            (pf_fill_tag_r == wr_unified_group))
                             pf_stale_r <= 1'b1;
 
                         if (video_mem_if.ready) begin
-                            vnext_r[burst_cnt_r] <= video_mem_if.q;
+                            vq_r[{fill_slot_w, burst_cnt_r}] <= video_mem_if.q;
                             if (burst_cnt_r == 2'd3) begin
-                                vnext_tag_r   <= pf_want_tag_r;
-                                vnext_valid_r <= !(pf_stale_r ||
-                                                   (write_en && is_unified_write &&
-                                                    (pf_want_tag_r == wr_unified_group)));
+                                vq_tag_r[fill_slot_w]   <= pf_fill_tag_r;
+                                vq_valid_r[fill_slot_w] <= !(pf_stale_r ||
+                                                             (write_en && is_unified_write &&
+                                                              (pf_fill_tag_r == wr_unified_group)));
+                                // No serve can move the window mid-burst
+                                // (grants need RD_IDLE)
+                                pf_want_tag_r <= pf_fill_tag_r + 12'd1;
+                                pf_hold_r  <= 1'b1;
                                 pf_stale_r <= 1'b0;
-                                pf_want_r  <= 1'b0;
                                 rd_state_r <= RD_IDLE;
                             end
                             burst_cnt_r <= burst_cnt_r + 2'd1;
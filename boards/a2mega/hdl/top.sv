@@ -133,6 +133,7 @@ module top #(
     // ESP32 Octal SPI interface
     input         esp_sclk,
     inout  [7:0]  esp_data,
+    output        esp_attn_n,     // attention line (the unused OSPI CS pin)
 
     // USB-A host port (direct GPIO, BANK3)
     inout usb_dp,
@@ -352,7 +353,8 @@ module top #(
     //
     // Priority = latency criticality, NOT bandwidth. apple_video_gen and
     // vgc_gen are hard-real-time: they emit pixels at fixed cadence from a
-    // single-word prefetch, so a shadow read that misses its ~500ns slot
+    // single-word prefetch (backed by apple_memory's group prefetch queue,
+    // PF_GROUPS_LOG2), so a shadow read that misses its ~500ns slot
     // makes the shifter reuse the previous word — seen on hardware as
     // "sparkle" (occasional misses: moving misplaced pixels on static
     // screens, worst during disk loads) or wholesale shape garble (chronic
@@ -386,7 +388,8 @@ module top #(
         ddr3_mem_ports[0:NUM_DDR3_PORTS-1]();
 
     apple_memory #(
-        .VGC_MEMORY(1)
+        .VGC_MEMORY(1),
+        .PF_GROUPS_LOG2(1)
     ) apple_memory (
         .a2bus_if(a2bus_if),
         .a2mem_if(a2mem_if),
@@ -407,10 +410,16 @@ module top #(
         .vgc_ready_o(vgc_ready_w),
 
         .dbg_shadow_drop_o(shadow_dbg_drop_w),
-        .dbg_rd_state_o(shadow_dbg_rd_state_w)
+        .dbg_rd_state_o(shadow_dbg_rd_state_w),
+
+        .frame_i(vsync_w),
+        .dbg_late_o(shadow_dbg_late_w),
+        .dbg_pf_depth_o(shadow_dbg_pf_depth_w)
     );
 
     wire [7:0] shadow_dbg_rd_state_w;
+    wire [15:0] shadow_dbg_late_w;
+    wire [15:0] shadow_dbg_pf_depth_w;
 
     // Slots
 
@@ -480,6 +489,8 @@ module top #(
     wire        vgc_fb_vsync_w;
     wire [7:0]  vgc_dbg_missed_hsync_w;
     wire [7:0]  vgc_dbg_starved_w;
+    wire [15:0] vgc_dbg_stalls_w;
+    wire [15:0] vid_dbg_late_w;
     wire [7:0]  shadow_dbg_drop_w;
 
     wire [7:0] rgb_r_w;
@@ -506,7 +517,9 @@ module top #(
         .video_bank_o(video_bank_w),
         .video_rd_o(video_rd_w),
         .video_data_i(video_data_w),
-        .video_ready_i(video_ready_w)
+        .video_ready_i(video_ready_w),
+
+        .dbg_late_o(vid_dbg_late_w)
     );
 
     framebuffer_writer #(
@@ -555,7 +568,8 @@ module top #(
         .vgc_ready_i(vgc_ready_w),
 
         .dbg_missed_hsync_o(vgc_dbg_missed_hsync_w),
-        .dbg_starved_o(vgc_dbg_starved_w)
+        .dbg_starved_o(vgc_dbg_starved_w),
+        .dbg_stalls_o(vgc_dbg_stalls_w)
     );
 
     framebuffer_writer #(
@@ -861,11 +875,12 @@ module top #(
         .volumes(volumes)
     );
 
-    // ProDOS hard disk (block device). The card requests one 512-byte block
-    // at a time over hdd_volumes[] (compact regs 0x26-0x2D); the ESP32 serves
-    // it from a .hdv/.po image into the SPACE 5 BSRAM window via XFER, then
-    // pulses ack and the card streams it to the 6502 through its sector
-    // buffer.
+    // ProDOS hard disk (block device). The card requests a run of up to 4
+    // blocks over hdd_volumes[] (compact regs 0x26-0x2D, blk_cnt readable at
+    // the ACK address); the ESP32 serves it from a .hdv/.po image into the
+    // unit's SPACE 5 BSRAM ring via XFER, then pulses ack. The card streams
+    // blocks to the 6502 through its sector buffer, taking later blocks of
+    // the run straight from the ring.
 
     drive_volume_if hdd_volumes[2]();
 
@@ -881,7 +896,8 @@ module top #(
 
     HDD #(
         .ENABLE(HDD_ENABLE),
-        .ID(HDD_ID)
+        .ID(HDD_ID),
+        .RING_LOG2(2)           // 4 slots/unit, esp32_ospi_connector hdd_mem
     ) hdd (
         .a2bus_if(a2bus_if),
         .slot_if(slot_if),
@@ -1707,11 +1723,16 @@ module top #(
     // is consumed in this section; driven by esp32_ospi_connector below)
     video_control_if esp_video_control_if();
 
-    // OSD enable: quasi-static, CDC from clk_logic to clk_pixel
+    // OSD enable and row offset: quasi-static, CDC from clk_logic to
+    // clk_pixel (the overlay samples the offset once per frame)
+    wire [4:0] osd_scroll_w;
     reg osd_en_sync0, osd_en_sync1;
+    reg [4:0] osd_scroll_sync0, osd_scroll_sync1;
     always @(posedge clk_pixel_w) begin
         osd_en_sync0 <= esp_video_control_if.enable;
         osd_en_sync1 <= osd_en_sync0;
+        osd_scroll_sync0 <= osd_scroll_w;
+        osd_scroll_sync1 <= osd_scroll_sync0;
     end
 
     osd_text_overlay #(
@@ -1721,6 +1742,7 @@ module top #(
         .clk_i      (clk_pixel_w),
         .reset_n    (device_reset_n_w),
         .enable_i   (osd_en_sync1),
+        .row_offset_i(osd_scroll_sync1),
 
         .screen_x_i (hdmi_cx_w),
         .screen_y_i (hdmi_cy_w),
@@ -1854,7 +1876,7 @@ module top #(
     f18a_gpu_if esp_f18a_gpu_if();
 
     // =========================================================================
-    // Video-pipeline debug readback (OSPI regs 0x70-0x77)
+    // Video-pipeline debug readback (OSPI regs 0x70-0x78, two pages)
     // =========================================================================
     // $C029 (NEWVIDEO) write tap — counts every write the FPGA's bus decode
     // sees and keeps the last data byte. Distinguishes "the SHR-clear write
@@ -1886,7 +1908,7 @@ module top #(
     // Octal SPI connector instance
     esp32_ospi_connector #(
         .USE_SYNC(1),
-        .USE_CRC(0),
+        .USE_CRC(1),
         .IDLE_TO_CYC(5_400_000),  // ~100ms at 54MHz
         .CLOCK_SPEED_HZ(CLOCK_SPEED_HZ)
     ) esp32_ospi (
@@ -1928,6 +1950,10 @@ module top #(
         .dbg_resp_ovfl_i(dbg_resp_ovfl_sync1),
         .dbg_shadow_rd_i(shadow_dbg_rd_state_w),
         .dbg_vgc_starved_i(vgc_dbg_starved_w),
+        .dbg_shadow_late_i(shadow_dbg_late_w),
+        .dbg_vgc_stalls_i(vgc_dbg_stalls_w),
+        .dbg_vid_late_i(vid_dbg_late_w),
+        .dbg_pf_depth_i(shadow_dbg_pf_depth_w),
         .dbg_usb_line_i(dbg_usb_line_w),
         .dbg_usb_pc_i(dbg_usb_pc_w),
         .dbg_usb_desc_i(usb_dbg_desc_sync1),
@@ -1952,10 +1978,12 @@ module top #(
 
         .scratch_o(),
         .mcu_ready_o(),
+        .esp_attn_n(esp_attn_n),
 
         .osd_clk_i(clk_pixel_w),
         .osd_addr_i(osd_vram_addr_w),
-        .osd_data_o(osd_vram_data_w)
+        .osd_data_o(osd_vram_data_w),
+        .osd_scroll_o(osd_scroll_w)
     );
 
     /*
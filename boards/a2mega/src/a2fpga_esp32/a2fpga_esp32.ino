@@ -34,6 +34,7 @@
 #include "disk.h"
 #include "menu.h"
 #include "w5100.h"
+#include "w5100_sock.h"
 #include "wifi_bridge.h"
 #include "fpga_jtag.h"
 #include "fpgaupdate.h"
@@ -56,6 +57,11 @@
 // Configuration done signal from the FPGA
 #define PIN_FPGA_DONE  48
 
+// Attention line from the FPGA (esp_attn_n, FPGA A19 — the OSPI CS net the
+// sync-framed protocol leaves unused). -1 = poll only; set to the GPIO
+// (GPIO 10 on the schematic) once the net is verified at bring-up.
+#define PIN_FPGA_ATTN  -1
+
 // JTAG interface to the FPGA (shared: USB bridge and fpga_jtag.c self-update)
 const int PIN_TCK  = 40;
 const int PIN_TMS  = 41;
@@ -83,16 +89,15 @@ static const ospi_pins_t OSPI_PINS = {
     .d5   = 7,
     .d6   = 8,
     .d7   = 9,
-    .cs   = -1,     // no CS — the protocol uses sync-pattern framing
+    .cs   = -1,     // no CS — the protocol uses sync-pattern framing; the
+                    // pin is the FPGA attention line (PIN_FPGA_ATTN)
 };
 
-static const int SPI_HZ = 4 * 1000 * 1000;  // (reg path is clean at 8 MHz but
-                                             // XFER payload reads outrun the
-                                             // proto's 1-byte read pipeline
-                                             // above ~4 MHz (FF fill) — add a
-                                             // fabric-side prefetch to go higher  // 10 MHz for bring-up: the FPGA read
-                                             // pipeline (2 cycles @ 54 MHz) is marginal
-                                             // against back-to-back 20 MHz RX byte slots
+// Bring-up clock. The register path is clean at 8 MHz, but on a bitstream
+// without the XFER read prefetch (CAPABILITIES[7:5]) payload reads outrun the
+// proto's 1-byte read pipeline above ~4 MHz (FF fill), so start here and let
+// fpga_link_calibrate() step up to what the board actually passes.
+static const int SPI_HZ = 4 * 1000 * 1000;
 
 // ============================================================================
 // Global State
@@ -149,6 +154,13 @@ static void print_status(uint8_t s) {
                   s, ver, align, crcerr, busy, ok);
 }
 
+// fpgaflash: the updater's per-phase timing line, printed just before the
+// post-install restart.
+static void fpgaflash_report(const char *line) {
+    Serial.printf("fpgaflash: %s\n", line);
+    Serial.flush();
+}
+
 // ============================================================================
 // CLI Commands
 // ============================================================================
@@ -274,7 +286,8 @@ static void cmd_process(String cmd) {
         }
 
     } else if (cmd == "viddbg") {
-        // Dump the video-pipeline debug registers (FPGA regs 0x70-0x77)
+        // Dump the video-pipeline debug registers (FPGA regs 0x70-0x78),
+        // then page 1 of 0x71-0x78: 16-bit per-frame prefetch counters
         if (!a2spi_is_ready()) {
             esp_err_t err = a2spi_init_once(SPI2_HOST, &OSPI_PINS, SPI_HZ);
             if (err != ESP_OK) {
@@ -301,6 +314,21 @@ static void cmd_process(String cmd) {
                       v[7], !!(v[7] & 0x80), !!(v[7] & 0x40), !!(v[7] & 0x20), !!(v[7] & 0x10), v[7] & 0x07);
         Serial.printf("vgc stale-word swaps/frame=%u\n", v[8]);
 
+        uint8_t p[8];
+        esp_err_t perr = a2spi_reg_write(0x70, 1);
+        for (int i = 0; perr == ESP_OK && i < 8; i++) {
+            uint8_t st = 0;
+            perr = a2spi_reg_read_status((uint8_t)(0x71 + i), &p[i], &st);
+        }
+        a2spi_reg_write(0x70, 0);
+        if (perr != ESP_OK) {
+            Serial.printf("viddbg: page 1 error: %s\n", esp_err_to_name(perr));
+            return;
+        }
+        Serial.printf("last frame: shadow late words=%u  vgc stalls=%u  video late chunks=%u\n",
+                      p[0] | (p[1] << 8), p[2] | (p[3] << 8), p[4] | (p[5] << 8));
+        Serial.printf("prefetch queue max depth=%u groups\n", p[6] | (p[7] << 8));
+
     } else if (cmd.startsWith("wifitest")) {
         // A/B instrument for the latency investigation: suspend the board's
         // periodic workload (disk poll @2ms, menu @20ms — both OSPI traffic
@@ -374,6 +402,13 @@ static void cmd_process(String cmd) {
         Serial.printf("disconnects: %lu (last reason %lu)\n",
                       (unsigned long)wifi_dbg_disconnects,
                       (unsigned long)wifi_dbg_last_reason);
+        w5100_sock_stats_t ss;
+        w5100_sock_stats(&ss);
+        Serial.printf("W5100 sockets: opens=%lu connects=%lu accepts=%lu "
+                      "tx=%lu B rx=%lu B errors=%lu\n",
+                      (unsigned long)ss.opens, (unsigned long)ss.connects,
+                      (unsigned long)ss.accepts, (unsigned long)ss.tx_bytes,
+                      (unsigned long)ss.rx_bytes, (unsigned long)ss.errors);
 
     } else if (cmd == "fpgaerase") {
         // Erase the config-flash HEADER blocks only (128KB), via the
@@ -418,20 +453,34 @@ static void cmd_process(String cmd) {
         // SPI bus to the GW5A's config-retry loop whenever the flash already
         // holds a corrupt image (its own SRAM-erase step re-arms the retry
         // loop, then its hardcoded-10MHz flash-ID read fails). The bit-bang
-        // path runs at the slow clocks that demonstrably win, with per-page
-        // verify. We hold the recursive link mutex, so driving
+        // path runs at the slow clocks that demonstrably win, with a CRC-32
+        // verify per block. By default only the 64 KB blocks that differ from
+        // the flash are written; "full" writes them all and "sram" only
+        // JTAG-loads the FPGA (flash untouched). We hold the recursive link mutex, so driving
         // fpgaupdate_poll() synchronously here is safe: menu/disk tasks stay
         // blocked (the FPGA is dark during the write anyway) and osd_log's
         // lock re-enters.
-        String toks[4];
-        int nt = split_ws(cmd, toks, 4);
+        String toks[5];
+        int nt = split_ws(cmd, toks, 5);
         if (nt < 2) {
-            Serial.println("Usage: fpgaflash <file.bin on SD>");
+            Serial.println("Usage: fpgaflash <file.bin on SD> [full|sram] [keepsram]");
             return;
         }
-        bool keepsram = (nt >= 3 && toks[2] == "keepsram");
+        bool keepsram = false;
+        fpu_mode_t mode = FPU_MODE_DIFF;
+        for (int i = 2; i < nt; i++) {
+            if (toks[i] == "keepsram")  keepsram = true;
+            else if (toks[i] == "full") mode = FPU_MODE_FULL;
+            else if (toks[i] == "sram") mode = FPU_MODE_SRAM;
+            else if (toks[i] != "diff") {
+                Serial.printf("fpgaflash: unknown option '%s'\n", toks[i].c_str());
+                return;
+            }
+        }
         fpgaupdate_set_keepsram(keepsram);
-        if (keepsram)
+        fpgaupdate_set_mode(mode);
+        fpgaupdate_set_report(fpgaflash_report);
+        if (keepsram && mode != FPU_MODE_SRAM)
             Serial.println("fpgaflash: keepsram — fabric stays live; flash written under a quiet MSPI bus");
         if (!fpgaupdate_request(toks[1].c_str())) {
             Serial.println("fpgaflash: updater busy");
@@ -441,10 +490,21 @@ static void cmd_process(String cmd) {
         Serial.printf("fpgaflash: %s\n", fpgaupdate_message());
         if (fpgaupdate_state() != FPU_READY)
             return;
-        Serial.println("fpgaflash: INSTALLING — FPGA goes dark; can take 10+ min; DO NOT power off");
+        Serial.printf("fpgaflash: INSTALLING (%s) — FPGA goes dark; DO NOT power off\n",
+                      mode == FPU_MODE_SRAM ? "SRAM only" :
+                      mode == FPU_MODE_FULL ? "full" : "changed blocks");
         fpgaupdate_commit();
         fpgaupdate_poll();   // INSTALL phase, synchronous; esp_restart() on success
-        Serial.printf("fpgaflash: %s\n", fpgaupdate_message());  // reached only on error
+        // Reached only on error
+        Serial.printf("fpgaflash: %s\n", fpgaupdate_message());
+        fpu_timings_t t;
+        fpgaupdate_timings(&t);
+        Serial.printf("fpgaflash: check %lu, enter %lu, hash %lu, erase %lu, "
+                      "program %lu, verify %lu, load %lu ms\n",
+                      (unsigned long)t.check_ms, (unsigned long)t.enter_ms,
+                      (unsigned long)t.hash_ms, (unsigned long)t.erase_ms,
+                      (unsigned long)t.program_ms, (unsigned long)t.verify_ms,
+                      (unsigned long)t.load_ms);
 
     } else if (cmd.startsWith("ddrd ")) {
         // Dump DDR3 words via the debug read window (regs 0x34-0x3B).
@@ -579,6 +639,351 @@ static void cmd_process(String cmd) {
             free(buf);
         }
 
+    } else if (cmd == "diskstat" || cmd == "diskstat reset") {
+        if (cmd == "diskstat reset") {
+            disk_reset_track_stats();
+            Serial.println("diskstat: counters cleared");
+        } else {
+            for (int v = 0; v < 2; v++) {
+                disk_track_stats_t st;
+                disk_get_track_stats(v, &st);
+                uint32_t reqs = st.hits + st.misses;
+                Serial.printf("D%d: %lu hit / %lu miss (%lu%%)  prefetch=%lu wr=%lu  cached=%u/%u\n",
+                              v + 1, (unsigned long)st.hits, (unsigned long)st.misses,
+                              (unsigned long)(reqs ? 100u * st.hits / reqs : 0),
+                              (unsigned long)st.prefetches, (unsigned long)st.writes,
+                              (unsigned)st.cached, (unsigned)st.slots);
+                Serial.printf("    hit  %lu us avg / %lu max   miss %lu us avg / %lu max\n",
+                              (unsigned long)st.hit_us_avg, (unsigned long)st.hit_us_max,
+                              (unsigned long)st.miss_us_avg, (unsigned long)st.miss_us_max);
+                Serial.printf("    dirty=%u coalesced=%lu flush %lu x %lu us avg / %lu max\n",
+                              (unsigned)st.dirty, (unsigned long)st.coalesced,
+                              (unsigned long)st.flushes, (unsigned long)st.flush_us_avg,
+                              (unsigned long)st.flush_us_max);
+            }
+            Serial.printf("floppy writes: %s\n",
+                          settings()->disk_writeback ? "write-back" : "write-through");
+        }
+
+    } else if (cmd == "hddstat" || cmd == "hddstat reset") {
+        if (cmd == "hddstat reset") {
+            disk_reset_hdd_stats();
+            Serial.println("hddstat: counters cleared");
+        } else {
+            for (int u = 0; u < 2; u++) {
+                disk_hdd_stats_t st;
+                disk_get_hdd_stats(u, &st);
+                uint32_t blks = st.hits + st.misses;
+                Serial.printf("HDD%d: %lu rd (%lu blk) %lu wr  %lu us avg / %lu max\n",
+                              u + 1, (unsigned long)st.reads, (unsigned long)st.blocks,
+                              (unsigned long)st.writes,
+                              (unsigned long)st.us_avg, (unsigned long)st.us_max);
+                Serial.printf("    %lu hit / %lu miss (%lu%%) in %lu image reads  ahead=%lu used=%lu\n",
+                              (unsigned long)st.hits, (unsigned long)st.misses,
+                              (unsigned long)(blks ? 100u * st.hits / blks : 0),
+                              (unsigned long)st.fills, (unsigned long)st.ahead,
+                              (unsigned long)st.ahead_used);
+                Serial.printf("    cached=%u/%u dirty=%u stores=%lu (%lu blk) err=%lu\n",
+                              (unsigned)st.cached, (unsigned)st.lines, (unsigned)st.dirty,
+                              (unsigned long)st.stores, (unsigned long)st.stored,
+                              (unsigned long)st.errors);
+            }
+        }
+
+    } else if (cmd == "hddbench" || cmd.startsWith("hddbench ")) {
+        // Sequential 800 KB read of an HDD unit, run in the disk task:
+        // one image read per block vs the card's runs through the cache.
+        String arg = cmd.substring(8);
+        arg.trim();
+        int u = arg.length() ? arg.toInt() - 1 : 0;
+        if (u < 0 || u > 1) {
+            Serial.println("Usage: hddbench [1|2]");
+            return;
+        }
+        disk_hdd_bench_t b;
+        disk_hdd_bench_begin(u);
+        while (!disk_hdd_bench_poll(&b))
+            delay(20);
+        if (!b.ok) {
+            Serial.printf("hddbench: unit %d not mounted, no cache, or read failed\n", u + 1);
+            return;
+        }
+        uint32_t blks = b.hits + b.misses;
+        Serial.printf("per block: %lu blk in %lu ms = %lu blk/s (%lu image reads)\n",
+                      (unsigned long)b.blocks, (unsigned long)(b.base_us / 1000u),
+                      (unsigned long)(b.base_us ? (uint64_t)b.blocks * 1000000u / b.base_us : 0),
+                      (unsigned long)b.base_reads);
+        Serial.printf("cached:    %lu blk in %lu ms = %lu blk/s (%lu image reads, "
+                      "%lu hit / %lu miss = %lu%%)\n",
+                      (unsigned long)b.blocks, (unsigned long)(b.cache_us / 1000u),
+                      (unsigned long)(b.cache_us ? (uint64_t)b.blocks * 1000000u / b.cache_us : 0),
+                      (unsigned long)b.cache_reads,
+                      (unsigned long)b.hits, (unsigned long)b.misses,
+                      (unsigned long)(blks ? 100u * b.hits / blks : 0));
+
+    } else if (cmd == "brfilter" || cmd.startsWith("brfilter ")) {
+        String arg = cmd.substring(8);
+        arg.trim();
+        if (arg == "ip" || arg == "all") {
+            settings()->net_ip_only = (arg == "ip") ? 1 : 0;
+            Serial.printf("brfilter: %s (%s)\n", arg == "ip" ? "IPv4/ARP only" : "all frames",
+                          settings_save() ? "saved" : "NOT saved");
+        } else if (arg.length()) {
+            Serial.println("Usage: brfilter [ip|all]");
+        } else {
+            Serial.printf("brfilter: %s\n",
+                          settings()->net_ip_only ? "IPv4/ARP only" : "all frames");
+        }
+
+    } else if (cmd == "diskwb" || cmd.startsWith("diskwb ")) {
+        String arg = cmd.substring(6);
+        arg.trim();
+        if (arg == "on" || arg == "off") {
+            settings()->disk_writeback = (arg == "on") ? 1 : 0;
+            Serial.printf("diskwb: %s (%s)\n", arg == "on" ? "write-back" : "write-through",
+                          settings_save() ? "saved" : "NOT saved");
+        } else if (arg.length()) {
+            Serial.println("Usage: diskwb [on|off]");
+        } else {
+            Serial.printf("diskwb: %s\n",
+                          settings()->disk_writeback ? "write-back" : "write-through");
+        }
+
+    } else if (cmd == "attn" || cmd.startsWith("attn ")) {
+        String arg = cmd.substring(4);
+        arg.trim();
+        if (arg == "on" || arg == "off") {
+            fpga_attn_set_enabled(arg == "on");
+        } else if (arg == "reset") {
+            fpga_lat_reset();
+            Serial.println("attn: histograms cleared");
+            return;
+        } else if (arg.length()) {
+            Serial.println("Usage: attn [on|off|reset]");
+            return;
+        }
+        Serial.printf("attention line: %s\n",
+                      !fpga_attn_available() ? "not available (polling)" :
+                      fpga_attn_enabled() ? "on" : "off (polling)");
+        static const char *const cls_name[FPGA_ATTN_NCLASS] = { "disk", "net" };
+        for (int c = 0; c < FPGA_ATTN_NCLASS; c++) {
+            for (int m = 0; m < 2; m++) {
+                fpga_lat_hist_t h;
+                fpga_lat_get(c, m != 0, &h);
+                if (!h.count)
+                    continue;
+                Serial.printf("%-4s %-5s %lu req  %lu us avg / %lu max\n    ",
+                              cls_name[c], m ? "attn" : "poll", (unsigned long)h.count,
+                              (unsigned long)(h.sum_us / h.count), (unsigned long)h.max_us);
+                for (int b = 0; b < FPGA_LAT_BINS; b++) {
+                    if (b < FPGA_LAT_BINS - 1)
+                        Serial.printf("<%lu:%lu ", (unsigned long)(64u << b), (unsigned long)h.bin[b]);
+                    else
+                        Serial.printf(">=%lu:%lu\n", (unsigned long)(64u << (b - 1)),
+                                      (unsigned long)h.bin[b]);
+                }
+            }
+        }
+
+    } else if (cmd == "xferbench") {
+        // XFER throughput per transfer size into SPACE 2 (writes discarded,
+        // reads return 0xFF), so it is safe with disks mounted and serving.
+        static const uint16_t sizes[] = { 64, 256, 512, 1024, 2048, 4096, 6656, 8192 };
+        uint8_t *buf = (uint8_t *)heap_caps_malloc(FPGA_MEM_MAX, MALLOC_CAP_DMA);
+        if (!buf) {
+            Serial.println("xferbench: out of memory");
+            return;
+        }
+        for (int i = 0; i < FPGA_MEM_MAX; i++) buf[i] = (uint8_t)i;
+        Serial.println(" bytes   write MB/s  queued MB/s   read MB/s");
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            uint16_t len = sizes[s];
+            int reps = 262144 / len;
+            bool ok = true;
+
+            uint32_t t0 = micros();
+            for (int r = 0; r < reps; r++)
+                ok &= fpga_mem_write(A2SPACE_VRAM1, 0, buf, len);
+            uint32_t t_sync = micros() - t0;
+
+            t0 = micros();
+            for (int r = 0; r < reps; r++)
+                ok &= fpga_mem_write_async(A2SPACE_VRAM1, 0, buf, len, NULL, NULL);
+            ok &= fpga_mem_wait();
+            uint32_t t_queued = micros() - t0;
+
+            t0 = micros();
+            for (int r = 0; r < reps; r++)
+                ok &= fpga_mem_read(A2SPACE_VRAM1, 0, buf, len);
+            uint32_t t_read = micros() - t0;
+
+            float total = (float)len * reps;   // bytes per us == MB/s
+            Serial.printf("%6u  %10.2f  %11.2f  %10.2f%s\n", (unsigned)len,
+                          total / t_sync, total / t_queued, total / t_read,
+                          ok ? "" : "  (errors)");
+        }
+        free(buf);
+
+    } else if (cmd == "spistat" || cmd == "spistat reset") {
+        if (cmd == "spistat reset") {
+            fpga_xfer_stats_reset();
+            Serial.println("spistat: counters cleared");
+            return;
+        }
+        Serial.printf("link: %d Hz, XFER CRC %s, read prefetch %d\n", a2spi_clock_hz(),
+                      a2spi_crc_enabled() ? "on" : "off", fpga_link_rd_prefetch());
+        Serial.println("space    xfers  crc errs  retries  failed");
+        for (int i = 0; i < FPGA_XFER_NSTAT; i++) {
+            fpga_xfer_stats_t st;
+            fpga_xfer_stats(i, &st);
+            if (!st.xfers && !st.crc_errors && !st.failures)
+                continue;
+            if (i == FPGA_XFER_QUEUED)
+                Serial.print("queued");
+            else
+                Serial.printf("%-6d", i);
+            Serial.printf(" %8lu  %8lu  %7lu  %6lu\n", (unsigned long)st.xfers,
+                          (unsigned long)st.crc_errors, (unsigned long)st.retries,
+                          (unsigned long)st.failures);
+        }
+        if (a2spi_crc_enabled()) {
+            uint8_t c[2];
+            fpga_link_lock();
+            a2spi_reg_read(A2REG_XFER_CRC_OK, &c[0]);
+            a2spi_reg_read(A2REG_XFER_CRC_ERR, &c[1]);
+            fpga_link_unlock();
+            Serial.printf("FPGA write trailers (mod 256): %u ok, %u bad\n", c[0], c[1]);
+        }
+
+    } else if (cmd == "osdstat" || cmd.startsWith("osdstat ")) {
+        static uint32_t s_osd_t0;
+        String arg = cmd.substring(7);
+        arg.trim();
+        if (arg == "reset") {
+            fpga_screen_stats_reset();
+            s_osd_t0 = millis();
+            Serial.println("osdstat: counters cleared");
+        } else if (arg == "bench") {
+            // Scrolling workload: 10 pages of log lines, one frame per line
+            // as osd_console appends them, with and without the row offset.
+            // The page is overwritten, so only while the OSD is hidden; the
+            // next console/menu show repaints it.
+            if (fpga_reg_read(A2REG_VIDEO_ENABLE) & 1) {
+                Serial.println("osdstat: OSD is showing, hide it first");
+                return;
+            }
+            const int lines = 10 * FPGA_SCREEN_H;
+            for (int hw = 1; hw >= 0; hw--) {
+                fpga_screen_set_hw_scroll(hw != 0);
+                fpga_screen_begin();
+                fpga_screen_clear();
+                fpga_screen_end();
+                fpga_screen_stats_reset();
+                uint32_t t0 = micros();
+                for (int i = 0; i < lines; i++) {
+                    char line[FPGA_SCREEN_W];
+                    snprintf(line, sizeof(line), "OSD SCROLL TEST LINE %04d", i);
+                    fpga_screen_begin();
+                    fpga_screen_goto(0, FPGA_SCREEN_H - 1);
+                    fpga_screen_puts(line);
+                    fpga_screen_puts("\n");
+                    fpga_screen_end();
+                }
+                uint32_t us = micros() - t0;
+                fpga_screen_stats_t st;
+                fpga_screen_stats(&st);
+                Serial.printf("%-11s %d lines in %lu us: %lu B/line, %lu.%02lu XFERs/line, %lu B/s\n",
+                              hw ? "row offset:" : "rewrite:", lines, (unsigned long)us,
+                              (unsigned long)(st.bytes / lines),
+                              (unsigned long)(st.xfers / lines),
+                              (unsigned long)(st.xfers * 100 / lines % 100),
+                              (unsigned long)((uint64_t)st.bytes * 1000000 / (us ? us : 1)));
+            }
+            fpga_screen_set_hw_scroll(true);
+            fpga_screen_stats_reset();
+            s_osd_t0 = millis();
+        } else if (arg.length()) {
+            Serial.println("Usage: osdstat [reset|bench]");
+        } else {
+            fpga_screen_stats_t st;
+            fpga_screen_stats(&st);
+            uint32_t ms = millis() - s_osd_t0;
+            Serial.printf("OSD: %lu bytes in %lu XFERs, %lu scrolls over %lu ms (%lu B/s)\n",
+                          (unsigned long)st.bytes, (unsigned long)st.xfers,
+                          (unsigned long)st.scrolls, (unsigned long)ms,
+                          (unsigned long)((uint64_t)st.bytes * 1000 / (ms ? ms : 1)));
+        }
+
+    } else if (cmd == "w5100stat" || cmd == "w5100stat reset") {
+        // MACRAW frame rate and the SPACE 3 traffic spent per frame, for
+        // comparing ping / iperf-style runs, plus the WiFi ingress pool.
+        static uint32_t s_w5100_t0;
+        if (cmd.endsWith("reset")) {
+            w5100_stats_reset();
+            wifi_bridge_stats_reset();
+            s_w5100_t0 = millis();
+            Serial.println("w5100stat: counters cleared");
+            return;
+        }
+        w5100_stats_t st;
+        w5100_stats(&st);
+        uint32_t ms = millis() - s_w5100_t0;
+        uint32_t frames = st.rx_frames + st.tx_frames;
+        uint32_t fdiv = frames ? frames : 1;
+        Serial.printf("W5100: rx %lu tx %lu frames (%lu ring-full refusals), %lu cmds over %lu ms\n",
+                      (unsigned long)st.rx_frames, (unsigned long)st.tx_frames,
+                      (unsigned long)st.rx_full, (unsigned long)st.cmds,
+                      (unsigned long)ms);
+        Serial.printf("  %lu frames/s; link %lu B in %lu XFERs: %lu B/frame, %lu.%02lu XFERs/frame\n",
+                      (unsigned long)((uint64_t)frames * 1000 / (ms ? ms : 1)),
+                      (unsigned long)st.link_bytes, (unsigned long)st.link_xfers,
+                      (unsigned long)(st.link_bytes / fdiv),
+                      (unsigned long)(st.link_xfers / fdiv),
+                      (unsigned long)(st.link_xfers * 100ull / fdiv % 100));
+        wifi_bridge_stats_t bs;
+        wifi_bridge_stats(&bs);
+        Serial.printf("  ingress pool %lu frames: %lu held, high-water %lu; %lu queued, %lu delivered\n",
+                      (unsigned long)bs.pool, (unsigned long)bs.in_use,
+                      (unsigned long)bs.hwm, (unsigned long)bs.queued,
+                      (unsigned long)bs.delivered);
+        Serial.printf("  parked %lu (longest %lu us); dropped: filter %lu, oversize %lu, "
+                      "pool %lu, stale %lu, rejected %lu\n",
+                      (unsigned long)bs.parks, (unsigned long)bs.park_max_us,
+                      (unsigned long)bs.drop_filter, (unsigned long)bs.drop_len,
+                      (unsigned long)bs.drop_pool, (unsigned long)bs.drop_stale,
+                      (unsigned long)bs.drop_reject);
+
+    } else if (cmd == "spical") {
+        fpga_cal_step_t steps[16];
+        int n = 16;
+        int hz = fpga_link_calibrate(steps, &n);
+        for (int i = 0; i < n; i++)
+            Serial.printf("  %8d Hz  %s\n", steps[i].hz, steps[i].pass ? "pass" : "FAIL");
+        Serial.printf("link clock: %d Hz\n", hz);
+
+    } else if (cmd == "spisweep" || cmd.startsWith("spisweep ")) {
+        // Track- and block-sized reads at every calibration clock, no
+        // retries: where the payload path starts failing, and what it
+        // delivers below that. The link clock is restored afterwards.
+        int reps = cmd.length() > 9 ? cmd.substring(9).toInt() : 20;
+        if (reps <= 0) reps = 20;
+        fpga_sweep_step_t steps[24];
+        int n = fpga_link_sweep(steps, 24, reps);
+        if (n < 0) {
+            Serial.println("spisweep: no idle drive window (eject a disk first)");
+            return;
+        }
+        Serial.printf("read prefetch %d, %d reads per size\n", fpga_link_rd_prefetch(), reps);
+        Serial.println("      Hz  bytes   bad/reads   MB/s");
+        for (int i = 0; i < n; i++) {
+            const fpga_sweep_step_t *st = &steps[i];
+            float mbs = st->us ? (float)st->len * (st->reads - st->bad) / st->us : 0.0f;
+            Serial.printf("%8d  %5u  %4lu/%-5lu  %6.2f%s\n", st->hz, (unsigned)st->len,
+                          (unsigned long)st->bad, (unsigned long)st->reads, mbs,
+                          st->bad ? "  FAIL" : "");
+        }
+        Serial.printf("link clock: %d Hz\n", a2spi_clock_hz());
+
     } else if (cmd == "meminfo") {
         size_t psram_total = heap_caps_get_total_size(MALLOC_CAP_SPIRAM);
         size_t psram_free = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
@@ -620,6 +1025,7 @@ static void cmd_process(String cmd) {
         Serial.printf("  TXD:  %d\n", PIN_TXD);
         Serial.println("Other:");
         Serial.printf("  FPGA_DONE: %d\n", PIN_FPGA_DONE);
+        Serial.printf("  FPGA_ATTN: %d\n", PIN_FPGA_ATTN);
         Serial.printf("  SD:   CLK=%d CMD=%d D0=%d D1=%d D2=%d D3=%d DET=%d\n",
                       PIN_SD_CLK, PIN_SD_CMD, PIN_SD_D0, PIN_SD_D1, PIN_SD_D2, PIN_SD_D3, PIN_SD_DET);
 
@@ -634,9 +1040,21 @@ static void cmd_process(String cmd) {
         Serial.println("  spiinit   - Initialize Octal SPI");
         Serial.println("  spitest   - Run SPI loopback test");
         Serial.println("  spireg <reg> [val]  - Read/write SPI register (0..126)");
-        Serial.println("  viddbg              - Dump video-pipeline debug regs (0x70-0x77)");
+        Serial.println("  viddbg              - Video-pipeline debug regs + per-frame prefetch stats");
         Serial.println("  spir <space> <addr> <len> [inc=1]  - Read from FPGA");
         Serial.println("  spiw <space> <addr> <inc> <b0> [b1 ...]  - Write to FPGA");
+        Serial.println("  diskstat [reset]    - Disk II track cache hit/miss + serve latency");
+        Serial.println("  diskwb [on|off]     - Floppy/HDD write-back (on) / write-through (off)");
+        Serial.println("  brfilter [ip|all]   - WiFi bridge ingress: IPv4/ARP only, or all frames");
+        Serial.println("  hddstat [reset]     - HDD block cache hit/miss, read-ahead, serve latency");
+        Serial.println("  hddbench [1|2]      - HDD 800 KB sequential read: per block vs cached blk/s");
+        Serial.println("  attn [on|off|reset] - Attention line vs polling + request latency");
+        Serial.println("  xferbench           - XFER MB/s per size: sync, queued DMA, read");
+        Serial.println("  spistat [reset]     - XFER CRC errors/retries per space, link clock");
+        Serial.println("  spical              - Re-run link clock calibration");
+        Serial.println("  spisweep [reps]     - Track/block read errors and MB/s per link clock");
+        Serial.println("  osdstat [reset|bench] - OSD bytes/s; bench = scrolling workload");
+        Serial.println("  w5100stat [reset]   - MACRAW frames/s, link cost per frame, ingress pool");
         Serial.println("  meminfo   - Show memory usage");
         Serial.println("  pins      - Show pin assignments");
         Serial.println("  exit      - Return to serial forwarding mode");
@@ -788,9 +1206,10 @@ static void load_wifi_credentials() {
 static void disk_task(void *arg) {
     (void)arg;
     for (;;) {
-        disk_poll();
+        bool busy = disk_poll();
         fpgaupdate_poll();
-        vTaskDelay(pdMS_TO_TICKS(2));
+        if (!busy)
+            fpga_attn_wait(FPGA_ATTN_DISK, 2);   // attention edge or 2 ms
     }
 }
 
@@ -816,6 +1235,8 @@ static void start_subsystems() {
         Serial.println("[fpga] no A2FP device on the OSPI link; retrying later");
         return;
     }
+    fpga_attn_init(PIN_FPGA_ATTN);
+    int link_hz = fpga_link_calibrate(NULL, NULL);   // before disk serving starts
 
     settings_init();
     sd_mounted = mount_sd();
@@ -823,6 +1244,7 @@ static void start_subsystems() {
     osd_console_show();
     osd_log("A2MEGA ESP32 %s %s", __DATE__, __TIME__);
     osd_log(sd_mounted ? "SD CARD MOUNTED" : "NO SD CARD");
+    osd_log("FPGA LINK: %d KHZ%s", link_hz / 1000, a2spi_crc_enabled() ? " CRC" : "");
 
     disk_init();
     menu_init();
@@ -946,5 +1368,9 @@ void loop() {
         }
     }
 
-    vTaskDelay(1);
+    // Sleep one tick, or less if the FPGA raises attention (W5100 doorbell)
+    if (subsystems_up)
+        fpga_attn_wait(FPGA_ATTN_NET, 1);
+    else
+        vTaskDelay(1);
 }
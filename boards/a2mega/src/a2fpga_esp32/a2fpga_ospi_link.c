@@ -9,6 +9,7 @@
 #include "esp_log.h"
 #include "esp_check.h"
 #include "driver/gpio.h"
+#include "a2fpga_regs.h"   // A2SPACE_REGS
 
 static const char* TAG = "ospi_link";
 
@@ -21,6 +22,45 @@ static inline uint8_t sub0_byte(bool dir_read, uint8_t space, bool inc, bool wit
          | (with_crc ? (1<<5) : 0);
 }
 
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), as the connector computes it
+static uint16_t crc16(uint16_t crc, const uint8_t *p, size_t n) {
+    while (n--) {
+        crc ^= (uint16_t)(*p++) << 8;
+        for (int i = 0; i < 8; i++)
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+// XFER header [sync][7F][SUB0][addr24][len16]; returns its length. The CRC
+// covers its last six bytes.
+static size_t xfer_hdr(const ospi_link_t *l, uint8_t *hdr, bool rd, uint8_t space,
+                       uint32_t addr, uint16_t len, bool inc_addr) {
+    size_t o = 0;
+    if (l->use_sync) { hdr[o++] = 0xA5; hdr[o++] = 0x5A; }
+    hdr[o++] = 0x7F;                                 // reg 127
+    hdr[o++] = sub0_byte(rd, space, inc_addr, l->use_crc);
+    hdr[o++] = (uint8_t)(addr & 0xFF);
+    hdr[o++] = (uint8_t)((addr >> 8) & 0xFF);
+    hdr[o++] = (uint8_t)((addr >> 16) & 0xFF);
+    hdr[o++] = (uint8_t)(len & 0xFF);
+    hdr[o++] = (uint8_t)((len >> 8) & 0xFF);
+    return o;
+}
+
+static esp_err_t add_device(ospi_link_t *l, int clock_hz) {
+    spi_device_interface_config_t dev = {
+        .clock_speed_hz = clock_hz,
+        .mode = 0,
+        .spics_io_num = l->pins.cs,
+        .queue_size = 3 * OSPI_ASYNC_DEPTH,   // header + payload + CRC per job
+        .flags = l->octal_mode ? SPI_DEVICE_HALFDUPLEX : 0,
+    };
+    ESP_RETURN_ON_ERROR(spi_bus_add_device(l->host, &dev, &l->dev), TAG, "add dev");
+    l->clock_hz = clock_hz;
+    return ESP_OK;
+}
+
 esp_err_t ospi_link_init(ospi_link_t *l, spi_host_device_t host,
                          const ospi_pins_t *pins, int clock_hz)
 {
@@ -42,7 +82,7 @@ esp_err_t ospi_link_init(ospi_link_t *l, spi_host_device_t host,
         .data5_io_num = pins->d5,       // D5 for octal
         .data6_io_num = pins->d6,       // D6 for octal
         .data7_io_num = pins->d7,       // D7 for octal
-        .max_transfer_sz = 4096,
+        .max_transfer_sz = OSPI_XFER_MAX + 16,   // payload + header
         .flags = SPICOMMON_BUSFLAG_OCTAL,
     };
 
@@ -63,7 +103,7 @@ esp_err_t ospi_link_init(ospi_link_t *l, spi_host_device_t host,
             .sclk_io_num = pins->sclk,
             .quadwp_io_num = -1,
             .quadhd_io_num = -1,
-            .max_transfer_sz = 4096,
+            .max_transfer_sz = OSPI_XFER_MAX + 16,
         };
         err = spi_bus_initialize(host, &std_bus, SPI_DMA_CH_AUTO);
         if (err == ESP_ERR_INVALID_STATE) {
@@ -87,15 +127,7 @@ esp_err_t ospi_link_init(ospi_link_t *l, spi_host_device_t host,
     gpio_pulldown_en((gpio_num_t)pins->sclk);
 
     // Configure device
-    spi_device_interface_config_t dev = {
-        .clock_speed_hz = clock_hz,
-        .mode = 0,
-        .spics_io_num = pins->cs,
-        .queue_size = 4,
-        .flags = l->octal_mode ? SPI_DEVICE_HALFDUPLEX : 0,
-    };
-
-    ESP_RETURN_ON_ERROR(spi_bus_add_device(host, &dev, &l->dev), TAG, "add dev");
+    ESP_RETURN_ON_ERROR(add_device(l, clock_hz), TAG, "dev");
 
     ESP_LOGI(TAG, "OSPI link initialized: %s mode, %d Hz",
              l->octal_mode ? "octal" : "standard", clock_hz);
@@ -106,6 +138,7 @@ esp_err_t ospi_link_init(ospi_link_t *l, spi_host_device_t host,
 esp_err_t ospi_link_cleanup(ospi_link_t *l) {
     esp_err_t err = ESP_OK;
     if (l->dev) {
+        ospi_xfer_drain(l);
         err = spi_bus_remove_device(l->dev);
         l->dev = NULL;
     }
@@ -139,7 +172,10 @@ static esp_err_t xfer(spi_device_handle_t dev, const void *tx, void *rx, size_t
 // first SCLK pulse after the peripheral re-engages can be mangled, and the
 // FPGA misses it). Clock one 0x00 byte first — every parked FSM state
 // ignores a non-0xA5 byte, so the mangling lands on a byte nobody needs.
+static esp_err_t jobs_reap_all(ospi_link_t *l);
+
 static void bus_wake(ospi_link_t *l) {
+    jobs_reap_all(l);   // queued writes go first, in order
     uint8_t z = 0x00;
     xfer(l->dev, &z, NULL, 1, l->octal_mode);
 }
@@ -230,58 +266,53 @@ esp_err_t ospi_xfer_write(ospi_link_t *l,
                           uint8_t space, uint32_t addr,
                           const uint8_t *data, uint16_t len, bool inc_addr)
 {
-    if ((len == 0) || !data) return ESP_ERR_INVALID_ARG;
-    bus_wake(l);
-
-    uint8_t hdr[11]; // sync + opcode + sub0 + addr24 + len16
-    size_t o = 0;
-    if (l->use_sync) { hdr[o++] = 0xA5; hdr[o++] = 0x5A; }
-    hdr[o++] = 0x7F;                                 // reg 127
-    hdr[o++] = sub0_byte(false, space, inc_addr, false);
-    hdr[o++] = (uint8_t)(addr & 0xFF);
-    hdr[o++] = (uint8_t)((addr >> 8) & 0xFF);
-    hdr[o++] = (uint8_t)((addr >> 16) & 0xFF);
-    hdr[o++] = (uint8_t)(len & 0xFF);
-    hdr[o++] = (uint8_t)((len >> 8) & 0xFF);
-
-    // Header
-    ESP_RETURN_ON_ERROR(xfer(l->dev, hdr, NULL, o, l->octal_mode), TAG, "xfer-w hdr");
-    // Payload (write)
-    return xfer(l->dev, data, NULL, len, l->octal_mode);
+    // Header and payload queued back to back, then waited for (and, with
+    // CRC, checked)
+    ospi_xfer_drain(l);
+    ESP_RETURN_ON_ERROR(ospi_xfer_write_async(l, space, addr, data, len, inc_addr,
+                                              NULL, NULL), TAG, "xfer-w");
+    return ospi_xfer_drain(l);
 }
 
-esp_err_t ospi_xfer_read(ospi_link_t *l,
-                         uint8_t space, uint32_t addr,
-                         uint8_t *out, uint16_t len, bool inc_addr)
+// TX header, then bus turnaround: the dummy slot carries the status byte,
+// followed by the payload and (with CRC) the trailer — all driven by the
+// FPGA.
+static esp_err_t xfer_read(ospi_link_t *l, uint8_t space, uint32_t addr,
+                           uint8_t *out, uint16_t len, bool inc_addr,
+                           uint8_t *status_out, bool check_status)
 {
-    if ((len == 0) || !out) return ESP_ERR_INVALID_ARG;
+    if ((len == 0) || len > OSPI_XFER_MAX || !out) return ESP_ERR_INVALID_ARG;
     bus_wake(l);
 
     uint8_t hdr[11];
-    size_t o = 0;
-    if (l->use_sync) { hdr[o++] = 0xA5; hdr[o++] = 0x5A; }
-    hdr[o++] = 0x7F;
-    hdr[o++] = sub0_byte(true, space, inc_addr, false);
-    hdr[o++] = (uint8_t)(addr & 0xFF);
-    hdr[o++] = (uint8_t)((addr >> 8) & 0xFF);
-    hdr[o++] = (uint8_t)((addr >> 16) & 0xFF);
-    hdr[o++] = (uint8_t)(len & 0xFF);
-    hdr[o++] = (uint8_t)((len >> 8) & 0xFF);
-
-    // TX header, then bus turnaround: the dummy slot carries the status
-    // byte, followed by the payload — all driven by the FPGA.
+    size_t o = xfer_hdr(l, hdr, true, space, addr, len, inc_addr);
     ESP_RETURN_ON_ERROR(xfer(l->dev, hdr, NULL, o, l->octal_mode), TAG, "xfer-r hdr");
 
     uint8_t st = 0;
     ESP_RETURN_ON_ERROR(xfer_rx(l->dev, &st, 1, l->octal_mode), TAG, "xfer-r status");
-    if (l->use_sync) {
+    if (status_out) *status_out = st;
+    if (check_status && l->use_sync) {
         uint8_t ok = (st & 0x01);
         uint8_t ver = (st >> 4) & 0x0F;
         if (!ok || ver != 0x1)
             return ESP_ERR_INVALID_RESPONSE;   // caller retries the whole op
     }
 
-    return xfer_rx(l->dev, out, len, l->octal_mode);
+    ESP_RETURN_ON_ERROR(xfer_rx(l->dev, out, len, l->octal_mode), TAG, "xfer-r data");
+    if (!l->use_crc)
+        return ESP_OK;
+
+    uint8_t tail[2];
+    ESP_RETURN_ON_ERROR(xfer_rx(l->dev, tail, 2, l->octal_mode), TAG, "xfer-r crc");
+    uint16_t crc = crc16(crc16(0xFFFF, hdr + o - 6, 6), out, len);
+    return (((uint16_t)tail[0] << 8 | tail[1]) == crc) ? ESP_OK : ESP_ERR_INVALID_CRC;
+}
+
+esp_err_t ospi_xfer_read(ospi_link_t *l,
+                         uint8_t space, uint32_t addr,
+                         uint8_t *out, uint16_t len, bool inc_addr)
+{
+    return xfer_read(l, space, addr, out, len, inc_addr, NULL, true);
 }
 
 esp_err_t ospi_xfer_read_status(ospi_link_t *l,
@@ -289,26 +320,288 @@ esp_err_t ospi_xfer_read_status(ospi_link_t *l,
                                 uint8_t *out, uint16_t len, bool inc_addr,
                                 uint8_t *status_out)
 {
-    if ((len == 0) || !out) return ESP_ERR_INVALID_ARG;
-    bus_wake(l);
+    return xfer_read(l, space, addr, out, len, inc_addr, status_out, false);
+}
 
-    uint8_t hdr[11];
+// --- Burst register access ---------------------------------------------------
+// The connector maps XFER SPACE 6 onto the register file (byte at address A =
+// register A), so a run of registers costs one header instead of a wake +
+// header + turnaround per register. The program path also holds the bus for
+// the whole list and uses polled transactions: for these few-byte transfers
+// the interrupt-driven spi_device_transmit() setup dominates the wire time.
+
+#define REGS_MAX 127
+
+// One polled transaction; keep_cs leaves CS asserted for the next one (needs
+// the bus acquired).
+static esp_err_t pxfer(ospi_link_t *l, const void *tx, size_t ntx,
+                       void *rx, size_t nrx, bool keep_cs)
+{
+    spi_transaction_ext_t ext = {0};
+    ext.base.length    = ntx * 8;
+    ext.base.tx_buffer = ntx ? tx : NULL;
+    ext.base.rxlength  = nrx * 8;
+    ext.base.rx_buffer = rx;
+    if (l->octal_mode)
+        ext.base.flags |= SPI_TRANS_MODE_OCT;
+    if (keep_cs)
+        ext.base.flags |= SPI_TRANS_CS_KEEP_ACTIVE;
+    return spi_device_polling_transmit(l->dev, (spi_transaction_t *)&ext);
+}
+
+// XFER header for a SPACE 6 burst; returns its length.
+static size_t regs_hdr(ospi_link_t *l, uint8_t *hdr, bool rd, uint8_t reg, uint8_t n)
+{
     size_t o = 0;
     if (l->use_sync) { hdr[o++] = 0xA5; hdr[o++] = 0x5A; }
     hdr[o++] = 0x7F;
-    hdr[o++] = sub0_byte(true, space, inc_addr, false);
-    hdr[o++] = (uint8_t)(addr & 0xFF);
-    hdr[o++] = (uint8_t)((addr >> 8) & 0xFF);
-    hdr[o++] = (uint8_t)((addr >> 16) & 0xFF);
-    hdr[o++] = (uint8_t)(len & 0xFF);
-    hdr[o++] = (uint8_t)((len >> 8) & 0xFF);
+    hdr[o++] = sub0_byte(rd, A2SPACE_REGS, true, false);
+    hdr[o++] = reg;
+    hdr[o++] = 0;
+    hdr[o++] = 0;
+    hdr[o++] = n;
+    hdr[o++] = 0;
+    return o;
+}
 
-    // TX header, turnaround, status (dummy slot), payload
-    ESP_RETURN_ON_ERROR(xfer(l->dev, hdr, NULL, o, l->octal_mode), TAG, "xfer-r hdr");
+// Run one burst (no wake byte). Writes go out as a single TX of header +
+// payload; reads are TX header, then one RX of status + payload.
+static esp_err_t reg_op_run(ospi_link_t *l, const ospi_reg_op_t *op, bool keep_cs)
+{
+    uint8_t buf[11 + REGS_MAX];
+    size_t o = regs_hdr(l, buf, !op->write, op->reg, op->n);
 
-    uint8_t st = 0;
-    ESP_RETURN_ON_ERROR(xfer_rx(l->dev, &st, 1, l->octal_mode), TAG, "xfer-r status");
-    if (status_out) *status_out = st;
+    if (op->write) {
+        memcpy(buf + o, op->buf, op->n);
+        return pxfer(l, buf, o + op->n, NULL, 0, keep_cs);
+    }
+
+    if (!l->octal_mode) {
+        // Standard SPI fallback: full duplex, response follows the header
+        uint8_t rx[sizeof(buf)];
+        memset(buf + o, 0, 1 + op->n);
+        ESP_RETURN_ON_ERROR(pxfer(l, buf, o + 1 + op->n, rx, o + 1 + op->n, keep_cs),
+                            TAG, "burst fd");
+        memcpy(buf, rx + o, 1 + op->n);
+    } else {
+        ESP_RETURN_ON_ERROR(pxfer(l, buf, o, NULL, 0, true), TAG, "burst hdr");
+        ESP_RETURN_ON_ERROR(pxfer(l, NULL, 0, buf, 1 + op->n, keep_cs),
+                            TAG, "burst rd");
+    }
+    if (l->use_sync) {
+        uint8_t st = buf[0];
+        if (!(st & 0x01) || ((st >> 4) & 0x0F) != 0x1)
+            return ESP_ERR_INVALID_RESPONSE;
+    }
+    memcpy(op->buf, buf + 1, op->n);
+    return ESP_OK;
+}
+
+static bool reg_op_valid(const ospi_reg_op_t *op)
+{
+    return op->buf && op->n > 0 && (unsigned)op->reg + op->n <= REGS_MAX;
+}
+
+esp_err_t ospi_reg_program(ospi_link_t *l, const ospi_reg_op_t *ops, size_t nops)
+{
+    for (size_t i = 0; i < nops; i++)
+        if (!reg_op_valid(&ops[i])) return ESP_ERR_INVALID_ARG;
+    if (nops == 0) return ESP_OK;
+
+    jobs_reap_all(l);
+    ESP_RETURN_ON_ERROR(spi_device_acquire_bus(l->dev, portMAX_DELAY), TAG, "acquire");
+    uint8_t z = 0x00;   // bus wake, once for the whole program
+    esp_err_t err = pxfer(l, &z, 1, NULL, 0, true);
+    for (size_t i = 0; i < nops && err == ESP_OK; i++) {
+        bool last = (i + 1 == nops);
+        err = reg_op_run(l, &ops[i], !last);
+        if (err == ESP_ERR_INVALID_RESPONSE) {
+            // Reframe and retry the op once, as ospi_reg_read does
+            pxfer(l, &z, 1, NULL, 0, true);
+            err = reg_op_run(l, &ops[i], !last);
+        }
+    }
+    if (err != ESP_OK) {
+        // Deassert CS if an op failed with it held
+        pxfer(l, &z, 1, NULL, 0, false);
+    }
+    spi_device_release_bus(l->dev);
+    return err;
+}
+
+esp_err_t ospi_reg_read_burst(ospi_link_t *l, uint8_t reg, uint8_t *out, uint8_t n)
+{
+    ospi_reg_op_t op = { .write = false, .reg = reg, .n = n, .buf = out };
+    return ospi_reg_program(l, &op, 1);
+}
+
+esp_err_t ospi_reg_write_burst(ospi_link_t *l, uint8_t reg, const uint8_t *data, uint8_t n)
+{
+    ospi_reg_op_t op = { .write = true, .reg = reg, .n = n, .buf = (uint8_t *)data };
+    return ospi_reg_program(l, &op, 1);
+}
+
+// --- Queued XFER writes ------------------------------------------------------
+// Jobs complete in queue order. Each job is two or three transactions; only
+// the last one carries the job in .user, so the others' completions are just
+// skipped.
+
+static esp_err_t job_reap(ospi_link_t *l)
+{
+    spi_transaction_t *t = NULL;
+    esp_err_t err;
+    do {
+        err = spi_device_get_trans_result(l->dev, &t, portMAX_DELAY);
+    } while (err == ESP_OK && t->user == NULL);
+
+    ospi_job_t *j = &l->jobs[l->job_head];
+    l->job_head = (uint8_t)((l->job_head + 1) % OSPI_ASYNC_DEPTH);
+    l->job_count--;
+    if (j->done)
+        j->done(j->arg, err == ESP_OK);
+    return err;
+}
+
+static esp_err_t jobs_reap_all(ospi_link_t *l)
+{
+    esp_err_t first = ESP_OK;
+    while (l->job_count) {
+        esp_err_t err = job_reap(l);
+        if (first == ESP_OK)
+            first = err;
+    }
+    return first;
+}
+
+// Compare the FPGA's count of good CRC'd writes with the number sent since
+// the last check; the difference failed. Needs the queue empty.
+static esp_err_t crc_check(ospi_link_t *l)
+{
+    uint8_t n = l->crc_wr_pending, v;
+    if (!n)
+        return ESP_OK;
+    l->crc_wr_pending = 0;   // before the read, which drains again
+    ESP_RETURN_ON_ERROR(ospi_reg_read(l, OSPI_REG_XFER_CRC_OK, &v), TAG, "crc cnt");
+    uint8_t good = (uint8_t)(v - l->crc_ok_seen);
+    l->crc_ok_seen = v;
+    if (good < n)
+        l->crc_wr_lost += (uint16_t)(n - good);
+    return ESP_OK;
+}
+
+esp_err_t ospi_xfer_write_async(ospi_link_t *l,
+                                uint8_t space, uint32_t addr,
+                                const uint8_t *data, uint16_t len, bool inc_addr,
+                                ospi_xfer_done_t done, void *arg)
+{
+    if ((len == 0) || len > OSPI_XFER_MAX || !data) return ESP_ERR_INVALID_ARG;
+    if (l->job_count == OSPI_ASYNC_DEPTH)
+        job_reap(l);
+    if (l->crc_wr_pending >= 128) {
+        // Keep the unchecked run well inside the FPGA's 8-bit counter
+        jobs_reap_all(l);
+        crc_check(l);
+    }
+
+    ospi_job_t *j = &l->jobs[(l->job_head + l->job_count) % OSPI_ASYNC_DEPTH];
+    j->hdr[0] = 0x00;                                // bus wake
+    size_t o = 1 + xfer_hdr(l, j->hdr + 1, false, space, addr, len, inc_addr);
+    uint16_t crc = 0xFFFF;
+    if (l->use_crc) {
+        // Header CRC: the FPGA checks it before committing any payload byte
+        crc = crc16(crc, j->hdr + o - 6, 6);
+        j->hdr[o++] = (uint8_t)(crc >> 8);
+        j->hdr[o++] = (uint8_t)crc;
+    }
+    j->done = done;
+    j->arg  = arg;
+
+    uint32_t flags = l->octal_mode ? SPI_TRANS_MODE_OCT : 0;
+    memset(&j->hdr_t, 0, sizeof(j->hdr_t));
+    j->hdr_t.base.flags     = flags;
+    j->hdr_t.base.length    = o * 8;
+    j->hdr_t.base.tx_buffer = j->hdr;
+    memset(&j->data_t, 0, sizeof(j->data_t));
+    j->data_t.base.flags     = flags;
+    j->data_t.base.length    = (size_t)len * 8;
+    j->data_t.base.tx_buffer = data;
+    j->data_t.base.user      = l->use_crc ? NULL : j;
+    if (l->use_crc) {
+        crc = crc16(crc, data, len);          // header + payload
+        j->tail[0] = (uint8_t)(crc >> 8);
+        j->tail[1] = (uint8_t)crc;
+        memset(&j->tail_t, 0, sizeof(j->tail_t));
+        j->tail_t.base.flags     = flags;
+        j->tail_t.base.length    = 2 * 8;
+        j->tail_t.base.tx_buffer = j->tail;
+        j->tail_t.base.user      = j;
+    }
+
+    ESP_RETURN_ON_ERROR(spi_device_queue_trans(l->dev, (spi_transaction_t *)&j->hdr_t,
+                                               portMAX_DELAY), TAG, "q hdr");
+    l->job_count++;
+    esp_err_t err = spi_device_queue_trans(l->dev, (spi_transaction_t *)&j->data_t,
+                                           portMAX_DELAY);
+    if (err != ESP_OK) {
+        // Header queued without its payload (the FPGA reframes on the next
+        // sync): let the header's completion retire the job, silently, since
+        // the caller gets the error here.
+        j->hdr_t.base.user = j;
+        j->done = NULL;
+        ESP_LOGW(TAG, "q data: %s", esp_err_to_name(err));
+        return err;
+    }
+    if (l->use_crc) {
+        err = spi_device_queue_trans(l->dev, (spi_transaction_t *)&j->tail_t,
+                                     portMAX_DELAY);
+        if (err != ESP_OK) {
+            j->data_t.base.user = j;   // as above; the frame fails its check
+            j->done = NULL;
+            ESP_LOGW(TAG, "q crc: %s", esp_err_to_name(err));
+        }
+        l->crc_wr_pending++;
+    }
+    return err;
+}
+
+esp_err_t ospi_xfer_drain(ospi_link_t *l)
+{
+    esp_err_t first = jobs_reap_all(l);
+    esp_err_t err = crc_check(l);
+    if (first == ESP_OK)
+        first = err;
+    if (l->crc_wr_lost) {
+        ESP_LOGD(TAG, "%u XFER write(s) failed CRC", l->crc_wr_lost);
+        l->crc_wr_lost = 0;
+        if (first == ESP_OK)
+            first = ESP_ERR_INVALID_CRC;
+    }
+    return first;
+}
 
-    return xfer_rx(l->dev, out, len, l->octal_mode);
+int ospi_xfer_inflight(const ospi_link_t *l)
+{
+    return l->job_count;
+}
+
+esp_err_t ospi_link_set_clock(ospi_link_t *l, int clock_hz)
+{
+    if (!l->dev) return ESP_ERR_INVALID_STATE;
+    jobs_reap_all(l);
+    ESP_RETURN_ON_ERROR(spi_bus_remove_device(l->dev), TAG, "rm dev");
+    l->dev = NULL;
+    return add_device(l, clock_hz);
+}
+
+esp_err_t ospi_set_crc(ospi_link_t *l, bool on)
+{
+    ospi_xfer_drain(l);
+    l->use_crc = false;
+    if (on) {
+        // Baseline for the write check
+        ESP_RETURN_ON_ERROR(ospi_reg_read(l, OSPI_REG_XFER_CRC_OK, &l->crc_ok_seen),
+                            TAG, "crc cnt");
+        l->use_crc = true;
+    }
+    return ESP_OK;
 }
@@ -25,6 +25,33 @@ typedef struct {
     int cs;         // Chip select (-1 if not used)
 } ospi_pins_t;
 
+#define OSPI_XFER_MAX    8192   // largest XFER payload: a whole 6656-byte track
+#define OSPI_ASYNC_DEPTH 4      // queued XFER writes in flight
+
+// XFER CRC (SUB0[5]): CRC-16/CCITT-FALSE over SUB0..LEN1 and the payload,
+// trailing the payload MSB first. The FPGA sends it after read payloads and
+// counts the write trailers that matched in this register. Writes also send
+// the CRC of SUB0..LEN1 alone after LEN1; the FPGA drops a write whose
+// header fails it, so nothing lands at a corrupted address.
+#define OSPI_REG_XFER_CRC_OK 0x4F
+
+// Completion of a queued XFER write. Runs in whichever task drains the
+// queue (under the caller's link lock) — keep it short, no link access.
+typedef void (*ospi_xfer_done_t)(void *arg, bool ok);
+
+// One queued XFER write: [wake][sync][header][header CRC], the payload and
+// the trailer (both CRCs only with CRC on), queued back to back so the DMA
+// runs them without a task round trip in between.
+typedef struct {
+    spi_transaction_ext_t hdr_t;
+    spi_transaction_ext_t data_t;
+    spi_transaction_ext_t tail_t;
+    uint8_t hdr[12];
+    uint8_t tail[2];
+    ospi_xfer_done_t done;
+    void *arg;
+} ospi_job_t;
+
 typedef struct {
     spi_device_handle_t dev;
     spi_host_device_t host;
@@ -32,6 +59,14 @@ typedef struct {
     bool use_sync;      // Send A5 5A sync pattern
     bool bus_owner;     // true if we initialized the bus
     bool octal_mode;    // true for 8-bit mode, false for standard SPI fallback
+    ospi_job_t jobs[OSPI_ASYNC_DEPTH];   // ring, oldest at job_head
+    uint8_t job_head;
+    uint8_t job_count;
+    int clock_hz;
+    bool use_crc;           // CRC on XFER frames (ospi_set_crc)
+    uint8_t crc_ok_seen;    // FPGA's XFER_CRC_OK at the last check
+    uint8_t crc_wr_pending; // CRC'd writes sent since then
+    uint16_t crc_wr_lost;   // failed writes found by interim checks
 } ospi_link_t;
 
 // Initialize Octal SPI link
@@ -43,6 +78,15 @@ esp_err_t ospi_link_init(ospi_link_t *link,
 // Cleanup and release resources
 esp_err_t ospi_link_cleanup(ospi_link_t *link);
 
+// Re-add the device at a new SCLK rate (queued writes are drained first)
+esp_err_t ospi_link_set_clock(ospi_link_t *l, int clock_hz);
+
+// CRC-protect XFER frames; needs the connector's CAPABILITIES CRC bit.
+// A read whose trailer does not match fails with ESP_ERR_INVALID_CRC.
+// Writes are checked against the FPGA's XFER_CRC_OK count when they are
+// waited for (ospi_xfer_write, ospi_xfer_drain).
+esp_err_t ospi_set_crc(ospi_link_t *l, bool on);
+
 // --- Register access (1 byte registers 0..126) ---
 esp_err_t ospi_reg_write(ospi_link_t *l, uint8_t reg, uint8_t val);
 esp_err_t ospi_reg_read(ospi_link_t *l, uint8_t reg, uint8_t *val);
@@ -51,6 +95,9 @@ esp_err_t ospi_reg_read(ospi_link_t *l, uint8_t reg, uint8_t *val);
 esp_err_t ospi_reg_read_status(ospi_link_t *l, uint8_t reg, uint8_t *val, uint8_t *status);
 
 // --- Variable-length XFER via reg 127 ---
+// len up to OSPI_XFER_MAX. Writes are queued header + payload and waited for.
+// With CRC on, ESP_ERR_INVALID_CRC means the frame was damaged on the wire;
+// the caller may simply repeat it.
 esp_err_t ospi_xfer_write(ospi_link_t *l,
                           uint8_t space, uint32_t addr,
                           const uint8_t *data, uint16_t len, bool inc_addr);
@@ -65,6 +112,44 @@ esp_err_t ospi_xfer_read_status(ospi_link_t *l,
                                 uint8_t *out, uint16_t len, bool inc_addr,
                                 uint8_t *status);
 
+// --- Queued XFER writes ---
+// Queue a write and return; the payload is DMA'd from data, which must stay
+// untouched until done(arg, ok) runs. With OSPI_ASYNC_DEPTH jobs already in
+// flight this first waits for the oldest. Every synchronous call on the link
+// drains the queue first, so register accesses (an ACK, say) are ordered
+// after earlier queued writes.
+esp_err_t ospi_xfer_write_async(ospi_link_t *l,
+                                uint8_t space, uint32_t addr,
+                                const uint8_t *data, uint16_t len, bool inc_addr,
+                                ospi_xfer_done_t done, void *arg);
+
+// Wait for every queued write and run its completion. First error returned;
+// with CRC on, ESP_ERR_INVALID_CRC if any write since the last check failed
+// its trailer (done() reports the transfer itself, not the CRC).
+esp_err_t ospi_xfer_drain(ospi_link_t *l);
+
+// Queued writes not yet completed.
+int ospi_xfer_inflight(const ospi_link_t *l);
+
+// --- Burst register access (XFER SPACE 6 register window) ---
+// N consecutive registers in one framed transaction; needs the connector's
+// CAPABILITIES register-window bit. reg + n must not exceed 127.
+esp_err_t ospi_reg_read_burst(ospi_link_t *l, uint8_t reg, uint8_t *out, uint8_t n);
+esp_err_t ospi_reg_write_burst(ospi_link_t *l, uint8_t reg, const uint8_t *data, uint8_t n);
+
+// One step of a register program: n consecutive registers from reg, read
+// into / written from buf.
+typedef struct {
+    bool     write;
+    uint8_t  reg;
+    uint8_t  n;
+    uint8_t *buf;
+} ospi_reg_op_t;
+
+// Run a list of burst ops back to back with the bus held (one wake byte,
+// CS kept asserted, polled transactions). Stops at the first failing op.
+esp_err_t ospi_reg_program(ospi_link_t *l, const ospi_reg_op_t *ops, size_t nops);
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,6 +21,16 @@
 #define A2REG_SCRATCH3      0x0E
 #define A2REG_SCRATCH4      0x0F
 
+// CAPABILITIES bits
+#define A2CAP_SYNC          0x01
+#define A2CAP_CRC           0x02
+#define A2CAP_REG_WINDOW    0x04  // XFER SPACE 6 register window
+#define A2CAP_ATTN          0x08  // attention line + ATTN_* registers
+#define A2CAP_OSD_SCROLL    0x10  // OSD row offset register (A2REG_OSD_SCROLL)
+#define A2CAP_RD_PREFETCH   0xE0  // [7:5] XFER read prefetch depth, log2 (0 = none)
+#define A2CAP_RD_PREFETCH_BYTES(cap) \
+    (((cap) & A2CAP_RD_PREFETCH) ? 1 << (((cap) & A2CAP_RD_PREFETCH) >> 5) : 0)
+
 // STATUS bits
 #define A2STAT_READY        0x01
 #define A2STAT_DDR3_READY   0x02
@@ -69,9 +79,11 @@
 
 // ---------------------------------------------------------------------------
 // ProDOS HDD compact bank (0x26-0x2D) — same layout as a2n20v2-Enhanced
-// Reads:  REQ = {wr,rd}, LBA_L/H = requested ProDOS block
+// Reads:  REQ = {wr,rd}, LBA_L/H = requested ProDOS block, BLKCNT = blocks - 1
+//         of a read run (the card asks for LBA up to the end of its ring
+//         group; read together with LBA_L/H)
 // Writes: CTL = {readonly,mounted,ready}, SIZE_L/H = volume size in blocks,
-//         ACK = write-any strobe
+//         ACK = strobe; A2HDD_ACK_ERR fails the request (ProDOS I/O error)
 // ---------------------------------------------------------------------------
 #define A2REG_HDD_REQ(u)    ((u) ? 0x2A : 0x26)
 #define A2REG_HDD_CTL(u)    ((u) ? 0x2A : 0x26)
@@ -80,16 +92,26 @@
 #define A2REG_HDD_SIZE_L(u) ((u) ? 0x2B : 0x27)
 #define A2REG_HDD_SIZE_H(u) ((u) ? 0x2C : 0x28)
 #define A2REG_HDD_ACK(u)    ((u) ? 0x2D : 0x29)
+#define A2REG_HDD_BLKCNT(u) ((u) ? 0x2D : 0x29)
 
 #define A2HDD_CTL_READY     0x01
 #define A2HDD_CTL_MOUNTED   0x02
 #define A2HDD_CTL_READONLY  0x04
 #define A2HDD_REQ_RD        0x01
 #define A2HDD_REQ_WR        0x02
+#define A2HDD_ACK_OK        0x01
+#define A2HDD_ACK_ERR       0x02
 
 // Apple II reset release: write 1 after mounts are ready
 #define A2REG_A2_RST_RELEASE 0x2E
 
+// Attention line (FPGA -> MCU, the unused OSPI CS pin): low while a STATUS
+// pending bit enabled in ATTN_MASK is set. Ages count us (saturating at
+// 0xFFFF) since the oldest outstanding request of the class was raised.
+#define A2REG_ATTN_MASK     0x2F  // STATUS[5:3] bits that pull the line low
+#define A2REG_ATTN_AGE_DISK 0x3C  // 16-bit LE: floppy or HDD request
+#define A2REG_ATTN_AGE_NET  0x3E  // 16-bit LE: W5100 doorbell
+
 // ---------------------------------------------------------------------------
 // Slot configuration (0x30-0x33)
 // ---------------------------------------------------------------------------
@@ -121,6 +143,10 @@
 #define A2REG_VOL_CMD(d)      (A2REG_VOL_BASE(d) + 0xD)   // [0]=rd [1]=wr (read)
 #define A2REG_VOL_ACK(d)      (A2REG_VOL_BASE(d) + 0xE)   // write-any strobe
 
+// XFER CRC counters (free-running, wrap at 256) in the drive banks' spare slot
+#define A2REG_XFER_CRC_OK   0x4F  // CRC'd XFER writes whose trailer matched
+#define A2REG_XFER_CRC_ERR  0x5F  // ... and those whose trailer did not
+
 #define A2VOL_CMD_RD        0x01
 #define A2VOL_CMD_WR        0x02
 
@@ -129,6 +155,11 @@
 // ---------------------------------------------------------------------------
 #define A2REG_U2_DOORBELL   0x7A  // [3:0] per-socket Sn_CR pending; write-1-to-clear
 
+// ---------------------------------------------------------------------------
+// OSD hardware scroll
+// ---------------------------------------------------------------------------
+#define A2REG_OSD_SCROLL    0x7E  // text page row shown at the top (0-23)
+
 // ---------------------------------------------------------------------------
 // XFER memory spaces (reg 0x7F portal)
 // ---------------------------------------------------------------------------
@@ -138,12 +169,15 @@
 #define A2SPACE_VRAM1       2   // unimplemented (reads return 0xFF)
 #define A2SPACE_W5100       3   // 32KB W5100 address space (0x0000-0x7FFF)
 #define A2SPACE_DISK        4   // 16KB: 2 x 8KB Disk II track windows
-#define A2SPACE_HDD         5   // 1KB: 2 x 512B HDD block buffers. Writes must
+#define A2SPACE_HDD         5   // 4KB: 2 x 4 x 512B HDD block rings. Writes must
                                 // be sequential and 4-byte aligned (the FPGA
                                 // packs bytes into 32-bit words)
+#define A2SPACE_REGS        6   // register window: byte at addr A = register A
+                                // (0x00-0x7E), for burst register access
 
 // SPACE 4/5 window geometry
 #define A2DISK_WINDOW(d)    ((d) ? 0x2000u : 0x0000u)  // 8KB per drive
 #define A2DISK_TRACK_BYTES  6656u                       // GCR nibbles per track
-#define A2HDD_WINDOW(u)     ((u) ? 0x200u : 0x000u)     // 512B per unit
+#define A2HDD_WINDOW(u)     ((u) ? 0x800u : 0x000u)     // 2KB ring per unit
 #define A2HDD_BLOCK_BYTES   512u
+#define A2HDD_RING_BLOCKS   4u      // block b in slot b mod 4 (hdd.sv RING_LOG2)
@@ -76,3 +76,61 @@ esp_err_t a2spi_xfer_read_status(uint8_t space, uint32_t addr, uint8_t *out, uin
     if (!a2spi_is_ready()) return ESP_ERR_INVALID_STATE;
     return ospi_xfer_read_status(&s_link, space, addr, out, len, inc_addr, status);
 }
+
+esp_err_t a2spi_xfer_write_async(uint8_t space, uint32_t addr, const uint8_t *data, uint16_t len,
+                                 bool inc_addr, ospi_xfer_done_t done, void *arg)
+{
+    if (!a2spi_is_ready()) return ESP_ERR_INVALID_STATE;
+    return ospi_xfer_write_async(&s_link, space, addr, data, len, inc_addr, done, arg);
+}
+
+esp_err_t a2spi_xfer_drain(void)
+{
+    if (!a2spi_is_ready()) return ESP_OK;
+    return ospi_xfer_drain(&s_link);
+}
+
+int a2spi_xfer_inflight(void)
+{
+    return a2spi_is_ready() ? ospi_xfer_inflight(&s_link) : 0;
+}
+
+esp_err_t a2spi_reg_read_burst(uint8_t reg, uint8_t *out, uint8_t n)
+{
+    if (!a2spi_is_ready()) return ESP_ERR_INVALID_STATE;
+    return ospi_reg_read_burst(&s_link, reg, out, n);
+}
+
+esp_err_t a2spi_reg_write_burst(uint8_t reg, const uint8_t *data, uint8_t n)
+{
+    if (!a2spi_is_ready()) return ESP_ERR_INVALID_STATE;
+    return ospi_reg_write_burst(&s_link, reg, data, n);
+}
+
+esp_err_t a2spi_reg_program(const ospi_reg_op_t *ops, size_t nops)
+{
+    if (!a2spi_is_ready()) return ESP_ERR_INVALID_STATE;
+    return ospi_reg_program(&s_link, ops, nops);
+}
+
+esp_err_t a2spi_set_clock(int clock_hz)
+{
+    if (!a2spi_is_ready()) return ESP_ERR_INVALID_STATE;
+    return ospi_link_set_clock(&s_link, clock_hz);
+}
+
+int a2spi_clock_hz(void)
+{
+    return s_inited ? s_link.clock_hz : 0;
+}
+
+esp_err_t a2spi_set_crc(bool on)
+{
+    if (!a2spi_is_ready()) return ESP_ERR_INVALID_STATE;
+    return ospi_set_crc(&s_link, on);
+}
+
+bool a2spi_crc_enabled(void)
+{
+    return s_inited && s_link.use_crc;
+}
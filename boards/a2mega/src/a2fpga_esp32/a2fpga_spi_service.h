@@ -35,6 +35,23 @@ esp_err_t a2spi_xfer_write(uint8_t space, uint32_t addr, const uint8_t *data, ui
 esp_err_t a2spi_xfer_read(uint8_t space, uint32_t addr, uint8_t *out, uint16_t len, bool inc_addr);
 esp_err_t a2spi_xfer_read_status(uint8_t space, uint32_t addr, uint8_t *out, uint16_t len, bool inc_addr, uint8_t *status);
 
+// Queued XFER writes (see ospi_xfer_write_async)
+esp_err_t a2spi_xfer_write_async(uint8_t space, uint32_t addr, const uint8_t *data, uint16_t len,
+                                 bool inc_addr, ospi_xfer_done_t done, void *arg);
+esp_err_t a2spi_xfer_drain(void);
+int a2spi_xfer_inflight(void);
+
+// Burst register ops (XFER SPACE 6 register window) and register programs
+esp_err_t a2spi_reg_read_burst(uint8_t reg, uint8_t *out, uint8_t n);
+esp_err_t a2spi_reg_write_burst(uint8_t reg, const uint8_t *data, uint8_t n);
+esp_err_t a2spi_reg_program(const ospi_reg_op_t *ops, size_t nops);
+
+// Link clock (re-adds the SPI device) and XFER CRC (see ospi_set_crc)
+esp_err_t a2spi_set_clock(int clock_hz);
+int a2spi_clock_hz(void);
+esp_err_t a2spi_set_crc(bool on);
+bool a2spi_crc_enabled(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,25 @@
+/*
+ * crc32.c — see crc32.h.
+ */
+#include "crc32.h"
+
+/* A nibble at a time: a 64-byte table, ~4x the bitwise loop. Flash images
+ * and whole tracks are hashed with it, not just the settings blob. */
+uint32_t crc32_update(uint32_t crc, const void *p, size_t n)
+{
+    static const uint32_t tab[16] = {
+        0x00000000u, 0x1DB71064u, 0x3B6E20C8u, 0x26D930ACu,
+        0x76DC4190u, 0x6B6B51F4u, 0x4DB26158u, 0x5005713Cu,
+        0xEDB88320u, 0xF00F9344u, 0xD6D6A3E8u, 0xCB61B38Cu,
+        0x9B64C2B0u, 0x86D3D2D4u, 0xA00AE278u, 0xBDBDF21Cu,
+    };
+    const uint8_t *b = (const uint8_t *)p;
+
+    crc = ~crc;
+    while (n--) {
+        crc ^= *b++;
+        crc = (crc >> 4) ^ tab[crc & 15];
+        crc = (crc >> 4) ^ tab[crc & 15];
+    }
+    return ~crc;
+}
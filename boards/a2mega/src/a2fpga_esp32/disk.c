@@ -6,7 +6,8 @@
  * model): the FPGA requests one track at a time (lba = track*13, 13 * 512 =
  * 0x1A00 bytes), we read it from the image file on the SD card and stream it
  * into the FPGA track window (XFER SPACE 4), then pulse ack. HDD units serve
- * one 512-byte block per request through XFER SPACE 5.
+ * runs of 512-byte blocks into a per-unit block ring in XFER SPACE 5, through
+ * a block cache with read-ahead.
  *
  * Differences from the BL616 original:
  *   - Storage is the SD card at /sdcard (POSIX stdio/dirent via VFS); there
@@ -25,6 +26,7 @@
  */
 
 #include <stdbool.h>
+#include <stddef.h>       /* offsetof */
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
@@ -34,10 +36,14 @@
 
 #include "esp_log.h"
 #include "esp_timer.h"    /* esp_timer_get_time — us since boot */
+#include "esp_heap_caps.h"/* PSRAM-first track cache allocation */
 
 #include "a2fpga_regs.h"
+#include "crc32.h"        /* journal record CRCs */
 #include "fpga_link.h"
 #include "gcr_dsk.h"      /* on-the-fly .dsk/.do <-> 6-and-2 GCR nibble codec */
+#include "woz.h"          /* .woz bitstream index + latch framing */
+#include "hdd_cache.h"    /* ProDOS HDD block cache + read-ahead */
 #include "settings.h"     /* persisted image overrides + slot map */
 #include "disk.h"
 
@@ -70,23 +76,29 @@ void __attribute__((weak)) osd_console_hide(void) {}
 #define NDRV 2   /* Disk II floppy drives */
 #define NHDD 2   /* ProDOS HDD units      */
 
+#define DISK_TRACKS 35u   /* 5.25" tracks served per floppy image */
+
 /* Per-drive image format:
  *   FMT_NIB — raw nibble track, streamed as-is
  *   FMT_DSK — sector image (16*256 B/track) that gcr_dsk nibblizes on load /
  *             de-nibblizes on flush; g_order[] gives the file's sector order
  *             (.dsk/.do = DOS 3.3, .po = ProDOS)
+ *   FMT_WOZ — WOZ 1.0/2.0 bitstream image; TMAP/TRKS are indexed once at
+ *             mount (g_woz[]) and a track is one contiguous read, framed into
+ *             nibbles by the Disk II latch model — no sector decode, so
+ *             copy-protected layouts survive
  * A .2mg is a 64-byte header wrapping one of the above; g_base[] carries the
  * payload's byte offset within the file (0 for bare images). */
-typedef enum { FMT_NONE = 0, FMT_NIB, FMT_DSK } disk_fmt_t;
+typedef enum { FMT_NONE = 0, FMT_NIB, FMT_DSK, FMT_WOZ } disk_fmt_t;
 
 /* Candidate images per drive, tried in order (first that opens wins).
  * Sector formats take priority over .nib. Menu/config selection first. */
-#define NCAND 5
+#define NCAND 6
 static const char *const g_candidates[NDRV][NCAND] = {
     { SD_ROOT "/disk1.dsk", SD_ROOT "/disk1.do", SD_ROOT "/disk1.po",
-      SD_ROOT "/disk1.2mg", SD_ROOT "/disk1.nib" },
+      SD_ROOT "/disk1.2mg", SD_ROOT "/disk1.nib", SD_ROOT "/disk1.woz" },
     { SD_ROOT "/disk2.dsk", SD_ROOT "/disk2.do", SD_ROOT "/disk2.po",
-      SD_ROOT "/disk2.2mg", SD_ROOT "/disk2.nib" },
+      SD_ROOT "/disk2.2mg", SD_ROOT "/disk2.nib", SD_ROOT "/disk2.woz" },
 };
 
 #define PATH_MAX_LEN (SETTINGS_NAME_LEN + 16)   /* "/sdcard/" + override */
@@ -98,11 +110,16 @@ static disk_fmt_t  g_fmt[NDRV];
 static gcr_order_t g_order[NDRV];                /* sector order for FMT_DSK    */
 static uint32_t    g_base[NDRV];                 /* payload offset (.2mg header)*/
 static char        g_imgname[NDRV][PATH_MAX_LEN];/* resolved image path         */
+static uint32_t    g_ntracks[NDRV];              /* whole tracks in the image   */
 static uint8_t     g_trackbuf[MAX_TRACK_BYTES];  /* nibble track (FPGA window)  */
 static uint8_t     g_secbuf[DSK_TRACK_BYTES];    /* one sector track (16*256)   */
+static woz_image_t g_woz[NDRV];                  /* FMT_WOZ track index         */
+static bool        g_woz_crc_off[NDRV];          /* header CRC already zeroed   */
+static uint8_t     g_wozbits[MAX_TRACK_BYTES];   /* one WOZ track bitstream     */
 
-/* ProDOS HDD units: raw 512-byte block volumes (.hdv/.po/.2mg), served one
- * block at a time, LBA 1:1 into the image payload. */
+/* ProDOS HDD units: raw 512-byte block volumes (.hdv/.po/.2mg), LBA 1:1 into
+ * the image payload, served a run of blocks at a time through the unit's
+ * block ring and a block cache (see the HDD block cache section below). */
 static const char *const g_hdd_candidates[NHDD][3] = {
     { SD_ROOT "/hdd1.hdv", SD_ROOT "/hdd1.po", SD_ROOT "/hdd1.2mg" },
     { SD_ROOT "/hdd2.hdv", SD_ROOT "/hdd2.po", SD_ROOT "/hdd2.2mg" },
@@ -113,7 +130,7 @@ static bool     g_hdd_writable[NHDD];
 static uint32_t g_hdd_base[NHDD];       /* payload offset (.2mg header)  */
 static uint32_t g_hdd_blocks[NHDD];     /* size in 512-byte blocks       */
 static char     g_hdd_name[NHDD][PATH_MAX_LEN];
-static uint8_t  g_blockbuf[SECTOR_BYTES];
+static uint8_t  g_blockbuf[A2HDD_RING_BLOCKS * SECTOR_BYTES];   /* one run */
 
 /* Menu directory-listing request (see disk_list_begin/poll in disk.h). */
 static volatile bool          g_list_req;
@@ -150,6 +167,8 @@ static disk_fmt_t detect_format(const char *name, gcr_order_t *order)
     *order = GCR_ORDER_DOS;
     if (has_ext(name, "nib"))
         return FMT_NIB;
+    if (has_ext(name, "woz"))
+        return FMT_WOZ;
     if (has_ext(name, "dsk") || has_ext(name, "do"))
         return FMT_DSK;
     if (has_ext(name, "po")) {
@@ -234,6 +253,29 @@ static disk_fmt_t parse_2mg(FILE *f, gcr_order_t *order, uint32_t *base,
     return FMT_NONE;
 }
 
+/* woz_parse() file access: len bytes at byte offset off of FILE *ctx. */
+static bool woz_read(void *ctx, uint32_t off, void *buf, uint32_t len)
+{
+    FILE *f = (FILE *)ctx;
+    return fseek(f, (long)off, SEEK_SET) == 0 && fread(buf, 1, len, f) == len;
+}
+
+/* Bitstream of whole track `track` of WOZ drive v (quarter track 4*track),
+ * or NULL if the image leaves it unformatted. */
+static const woz_trk_t *woz_track(int v, uint32_t track)
+{
+    if (track >= WOZ_TRACKS || g_woz[v].qtrk[track * 4u].bits == 0)
+        return NULL;
+    return &g_woz[v].qtrk[track * 4u];
+}
+
+/* Bits of a WOZ track that fit the window (one nibble needs >= 8 bits, so a
+ * longer stream could not be shown whole anyway). */
+static uint32_t woz_nbits(const woz_trk_t *t)
+{
+    return t->bits < MAX_TRACK_BYTES * 8u ? t->bits : MAX_TRACK_BYTES * 8u;
+}
+
 /* Open name read-write, falling back to read-only. NULL if neither works. */
 static FILE *open_image(const char *name, bool *rw)
 {
@@ -255,13 +297,666 @@ static void image_sync(FILE *f)
     fsync(fileno(f));
 }
 
+/* Produce the nibble stream for nbyte bytes at floppy LBA lba of drive v into
+ * out: .dsk/.do/.po tracks are read as 16 file-order sectors and nibblized,
+ * .woz bitstreams are latch-framed, .nib is read as-is. A short .nib read is
+ * zero-filled (and logged when log_short is set — a prefetch stays quiet and
+ * simply is not cached). Returns false on a short read. */
+static bool load_track(int v, uint32_t lba, uint32_t nbyte, uint8_t *out,
+                       bool log_short)
+{
+    uint32_t track = lba / 13u;
+    if (g_fmt[v] == FMT_DSK) {
+        /* Read this track's 16*256 file-order sectors and nibblize them
+         * into the 6-and-2 GCR stream the window expects. */
+        size_t br = 0;
+        if (fseek(g_img[v], (long)g_base[v] +
+                            (long)track * (long)DSK_TRACK_BYTES,
+                  SEEK_SET) == 0)
+            br = fread(g_secbuf, 1, DSK_TRACK_BYTES, g_img[v]);
+        if (br < DSK_TRACK_BYTES)
+            memset(g_secbuf + br, 0, DSK_TRACK_BYTES - br);
+        gcr_encode_dos_track(g_secbuf, (uint8_t)track, DSK_DEFAULT_VOLUME,
+                             g_order[v], out, MAX_TRACK_BYTES);
+        return true;
+    }
+
+    if (g_fmt[v] == FMT_WOZ) {
+        /* One read of the track's bitstream (offset/length cached at
+         * mount), framed into nibbles; the rest of the window is sync. An
+         * unformatted track serves an all-zero window, like a blank disk. */
+        const woz_trk_t *t = woz_track(v, track);
+        size_t n  = 0;
+        bool   ok = true;
+        if (t) {
+            uint32_t nbits = woz_nbits(t);
+            ok = woz_read(g_img[v], t->off, g_wozbits, (nbits + 7u) / 8u);
+            if (ok)
+                n = woz_bits_to_nibbles(g_wozbits, nbits, out, MAX_TRACK_BYTES);
+            else if (log_short)
+                DLOGW("DISK II: D%d TRK%lu WOZ read failed", v + 1,
+                      (unsigned long)track);
+        }
+        memset(out + n, n ? 0xFF : 0x00, MAX_TRACK_BYTES - n);
+        return ok;
+    }
+
+    /* .nib: raw nibble stream, streamed as-is. */
+    size_t br = 0;
+    if (fseek(g_img[v], (long)g_base[v] + (long)lba * (long)SECTOR_BYTES,
+              SEEK_SET) == 0)
+        br = fread(out, 1, nbyte, g_img[v]);
+    if (br < nbyte) {
+        /* EOF: a zero-filled track has no sync/prologue nibbles, so RWTS
+         * finds nothing and DOS I/O-errors at this same track every boot
+         * — pinpoints a truncated/short .nib. */
+        if (log_short) {
+            osd_console_show();
+            DLOGW("DISK II: TRK%lu SHORT br=%lu/%lu (EOF) -> zero-fill",
+                  (unsigned long)track,
+                  (unsigned long)br, (unsigned long)nbyte);
+        }
+        memset(out + br, 0, nbyte - br);
+        return false;
+    }
+    return true;
+}
+
+/* ---- Write-back journal ---------------------------------------------------
+ * In write-back mode a dirty track reaches its image from a background step,
+ * long after the Apple II was acked. To keep that flush power-safe the exact
+ * bytes about to be written (and where) are first committed to a journal file
+ * on the card; the record is invalidated only once the image write is synced.
+ * A flush cut short by power loss or card removal leaves a valid record,
+ * which mount_drive() replays into the same image (matched by path) before
+ * serving it. A record whose payload CRC fails was torn while journaling, so
+ * the image was never touched and the record is simply dropped. One flush =
+ * one track = one record. The leading '_' keeps the file out of the menu's
+ * listings. */
+#define JNL_PATH   SD_ROOT "/_a2fpga.jnl"
+#define JNL_MAGIC  0x4E4A3241u   /* 'A2JN' */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t off;                 /* byte offset within the image file */
+    uint32_t len;                 /* payload bytes following the header */
+    uint32_t data_crc;            /* CRC-32 of the payload */
+    char     path[PATH_MAX_LEN];  /* image the record belongs to */
+    uint32_t crc;                 /* CRC-32 of everything above */
+} jnl_hdr_t;
+
+static FILE *g_jnl;
+
+static bool jnl_open(void)
+{
+    if (!g_jnl) {
+        g_jnl = fopen(JNL_PATH, "r+b");
+        if (!g_jnl)
+            g_jnl = fopen(JNL_PATH, "w+b");
+    }
+    return g_jnl != NULL;
+}
+
+static void jnl_close(void)
+{
+    if (g_jnl) {
+        fclose(g_jnl);
+        g_jnl = NULL;
+    }
+}
+
+/* Commit one record for drive v's image. True once it is on the card. */
+static bool jnl_write(int v, uint32_t off, const uint8_t *data, uint32_t len)
+{
+    if (!jnl_open())
+        return false;
+    jnl_hdr_t h;
+    memset(&h, 0, sizeof(h));
+    h.magic    = JNL_MAGIC;
+    h.off      = off;
+    h.len      = len;
+    h.data_crc = crc32_calc(data, len);
+    snprintf(h.path, sizeof(h.path), "%s", g_imgname[v]);
+    h.crc      = crc32_calc(&h, offsetof(jnl_hdr_t, crc));
+    if (fseek(g_jnl, 0, SEEK_SET) != 0 ||
+        fwrite(&h, 1, sizeof(h), g_jnl) != sizeof(h) ||
+        fwrite(data, 1, len, g_jnl) != len)
+        return false;
+    image_sync(g_jnl);
+    return true;
+}
+
+/* Invalidate the record (its image write has been synced). */
+static void jnl_clear(void)
+{
+    uint32_t zero = 0;
+    if (g_jnl && fseek(g_jnl, 0, SEEK_SET) == 0) {
+        fwrite(&zero, 1, sizeof(zero), g_jnl);
+        image_sync(g_jnl);
+    }
+}
+
+/* Replay a pending record that belongs to drive v's just-opened (read-write)
+ * image. Uses g_trackbuf as scratch: nothing is being served yet. */
+static void jnl_replay(int v)
+{
+    jnl_hdr_t h;
+    if (!jnl_open() || fseek(g_jnl, 0, SEEK_SET) != 0 ||
+        fread(&h, 1, sizeof(h), g_jnl) != sizeof(h))
+        return;
+    if (h.magic != JNL_MAGIC ||
+        h.crc != crc32_calc(&h, offsetof(jnl_hdr_t, crc)))
+        return;   /* no pending record */
+    h.path[sizeof(h.path) - 1] = '\0';
+    if (strcmp(h.path, g_imgname[v]) != 0)
+        return;   /* someone else's record: leave it for that image */
+    if (h.len > MAX_TRACK_BYTES ||
+        fread(g_trackbuf, 1, h.len, g_jnl) != h.len ||
+        crc32_calc(g_trackbuf, h.len) != h.data_crc) {
+        DLOGW("DISK II: D%d TORN JOURNAL RECORD DROPPED", v + 1);
+        jnl_clear();
+        return;
+    }
+    if (fseek(g_img[v], (long)h.off, SEEK_SET) == 0) {
+        fwrite(g_trackbuf, 1, h.len, g_img[v]);
+        image_sync(g_img[v]);
+    }
+    DLOGI("DISK II: D%d JOURNAL REPLAYED (%lu B @ %lu)", v + 1,
+          (unsigned long)h.len, (unsigned long)h.off);
+    jnl_clear();
+}
+
+/* Write len bytes at byte offset off of drive v's image and push them to the
+ * card; journaled first when asked (background write-back flushes). */
+static void image_write(int v, uint32_t off, const uint8_t *data, uint32_t len,
+                        bool journal)
+{
+    bool jnl = journal && jnl_write(v, off, data, len);
+    if (fseek(g_img[v], (long)off, SEEK_SET) == 0) {
+        fwrite(data, 1, len, g_img[v]);
+        image_sync(g_img[v]);
+    }
+    if (jnl)
+        jnl_clear();
+}
+
+/* Store a nibble track (nbyte bytes at floppy LBA lba) of drive v to its
+ * image: .dsk/.do/.po are de-nibblized back to file-order sectors, .woz is
+ * re-serialized into the track's TRKS bitstream, .nib is written as-is. */
+static void store_track(int v, uint32_t lba, uint32_t nbyte,
+                        const uint8_t *nib, bool journal)
+{
+    if (g_fmt[v] == FMT_DSK) {
+        /* Decode the (possibly partly rewritten) nibble track back to
+         * file-order sectors. Preload the current on-file track so any
+         * sector that fails to decode keeps its existing bytes; gate the
+         * write on the found-mask so a bad decode never corrupts the
+         * image. */
+        uint32_t track = lba / 13u;
+        uint32_t fpos  = g_base[v] + track * DSK_TRACK_BYTES;
+        size_t br = 0;
+        if (fseek(g_img[v], (long)fpos, SEEK_SET) == 0)
+            br = fread(g_secbuf, 1, DSK_TRACK_BYTES, g_img[v]);
+        if (br < DSK_TRACK_BYTES)
+            memset(g_secbuf + br, 0, DSK_TRACK_BYTES - br);
+        uint16_t mask = gcr_decode_dos_track(nib, MAX_TRACK_BYTES,
+                                             g_order[v], g_secbuf);
+        if (mask != 0)
+            image_write(v, fpos, g_secbuf, DSK_TRACK_BYTES, journal);
+        if (mask != 0xFFFF)
+            DLOGW("DISK II: D%d TRK%lu wr partial mask=%04X",
+                  v + 1, (unsigned long)track, (unsigned)mask);
+    } else if (g_fmt[v] == FMT_WOZ) {
+        /* Same bit count as on file, so the bitstream is rewritten in place
+         * (one journaled region). The header CRC no longer matches the
+         * file: zero it ("not computed") before the first track lands. */
+        uint32_t track = lba / 13u;
+        const woz_trk_t *t = woz_track(v, track);
+        if (!t) {
+            DLOGW("DISK II: D%d TRK%lu not in WOZ - wr dropped",
+                  v + 1, (unsigned long)track);
+            return;
+        }
+        uint32_t nbits = woz_nbits(t);
+        woz_nibbles_to_bits(nib, MAX_TRACK_BYTES, g_wozbits, nbits);
+        if (!g_woz_crc_off[v]) {
+            static const uint8_t zero[4] = { 0, 0, 0, 0 };
+            image_write(v, WOZ_CRC_OFFSET, zero, sizeof(zero), false);
+            g_woz_crc_off[v] = true;
+        }
+        image_write(v, t->off, g_wozbits, (nbits + 7u) / 8u, journal);
+    } else {
+        image_write(v, g_base[v] + lba * SECTOR_BYTES, nib, nbyte, journal);
+    }
+}
+
+/* ---- Nibblized track cache --------------------------------------------------
+ * Without it every seek costs an SD fseek/fread plus a full 6-and-2 encode
+ * while the Apple II waits on the ack. Whole tracks are kept pre-nibblized in
+ * RAM instead, so a hit is answered with nothing but the window XFER. Slots
+ * are filled
+ *   - on a miss (the requested track is loaded and kept),
+ *   - ahead of the head: after serving track t while stepping in direction d,
+ *     idle polls load t+d then t+2d (DOS 3.3 and ProDOS both step
+ *     track-to-track through a file),
+ *   - by a background warm-up after mount: idle polls walk the disk from
+ *     track 0, into FREE slots only (warming never evicts).
+ * An idle poll loads at most one track, so a request arriving meanwhile waits
+ * for one SD read at worst — what every seek used to cost.
+ *
+ * Sizing: with PSRAM the pool holds both whole disks (2 x 35 x 6656 B =
+ * 466 KB); the a2mega's ESP32-S3-MINI-1-N8 has none, so an LRU pool of
+ * TC_SLOTS_INTERNAL tracks shared by both drives comes from internal RAM.
+ * If even that allocation fails the cache is off and serving is unchanged.
+ *
+ * Write-back (settings()->disk_writeback): a whole-track write is acked as
+ * soon as the window has been copied into its slot, which is then DIRTY —
+ * never evicted, and rewrites of the same track coalesce into it. The
+ * background step stores it (through the journal) once the track has been
+ * quiet for WB_IDLE_US on an idle poll, or WB_MAX_US after it first went
+ * dirty even while busy. Anything the cache cannot hold, and every write in
+ * write-through mode, is stored synchronously before the ack as before. */
+#define TC_SLOTS_PSRAM    ((int)(NDRV * DISK_TRACKS))
+#define TC_SLOTS_INTERNAL 8
+#define TC_AHEAD          2     /* tracks prefetched ahead of the head */
+#define WB_IDLE_US        250000   /* quiet time before an idle flush  */
+#define WB_MAX_US         2000000  /* dirty age that forces a flush    */
+
+typedef struct {
+    int8_t   drive;     /* owning drive, -1 = free */
+    uint8_t  track;
+    bool     dirty;     /* newer than the image (write-back) */
+    uint32_t used;      /* LRU stamp (g_tc_clock at last fill/hit) */
+    int64_t  dirty_at;  /* first write since the last flush (us) */
+    int64_t  wr_at;     /* latest write (us) */
+    bool     busy;      /* source of a queued track DMA (see disk_poll) */
+} tc_slot_t;
+
+static uint8_t  *g_tc_data;                  /* nslots * MAX_TRACK_BYTES   */
+static int       g_tc_nslots;
+static tc_slot_t g_tc_slot[TC_SLOTS_PSRAM];
+static uint32_t  g_tc_clock;
+static int       g_tc_head[NDRV] = { -1, -1 };  /* last served track       */
+static int       g_tc_dir[NDRV]  = { 1, 1 };    /* head stepping direction */
+static uint32_t  g_tc_warm[NDRV];            /* next track of the warm walk */
+
+/* Serve statistics (see disk_get_track_stats). Latency sums are kept wide
+ * here and averaged on read-out. */
+typedef struct {
+    uint32_t hits, misses, prefetches, writes;
+    uint32_t coalesced, flushes;
+    uint64_t hit_us_sum, miss_us_sum, flush_us_sum;
+    uint32_t hit_us_max, miss_us_max, flush_us_max;
+} tc_stats_t;
+static tc_stats_t    g_tc_stats[NDRV];
+static volatile bool g_tc_stats_reset_req;
+
+static void tc_init(void)
+{
+    if (g_tc_data)
+        return;
+    g_tc_data = heap_caps_malloc((size_t)TC_SLOTS_PSRAM * MAX_TRACK_BYTES,
+                                 MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (g_tc_data) {
+        g_tc_nslots = TC_SLOTS_PSRAM;
+    } else {
+        g_tc_data = heap_caps_malloc((size_t)TC_SLOTS_INTERNAL * MAX_TRACK_BYTES,
+                                     MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        g_tc_nslots = g_tc_data ? TC_SLOTS_INTERNAL : 0;
+    }
+    for (int i = 0; i < TC_SLOTS_PSRAM; i++) {
+        g_tc_slot[i].drive = -1;
+        g_tc_slot[i].dirty = false;
+    }
+    ESP_LOGI(TAG, "track cache: %d slots (%s)", g_tc_nslots,
+             g_tc_nslots == TC_SLOTS_PSRAM ? "PSRAM, whole disks" :
+             g_tc_nslots ? "internal RAM, LRU" : "DISABLED");
+}
+
+static inline uint8_t *tc_buf(int i)
+{
+    return g_tc_data + (size_t)i * MAX_TRACK_BYTES;
+}
+
+/* Store dirty slot i to its image (journaled) and mark it clean. */
+static void tc_flush_slot(int i)
+{
+    tc_slot_t *sl = &g_tc_slot[i];
+    int        v  = sl->drive;
+    int64_t    t0 = esp_timer_get_time();
+
+    store_track(v, (uint32_t)sl->track * 13u, MAX_TRACK_BYTES, tc_buf(i), true);
+    sl->dirty = false;
+
+    tc_stats_t *st = &g_tc_stats[v];
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    st->flushes++;
+    st->flush_us_sum += us;
+    if (us > st->flush_us_max)
+        st->flush_us_max = us;
+}
+
+/* Forget every cached track of drive v (remount / eject / image change).
+ * Dirty tracks are stored first, so call this while the image is still
+ * open. */
+static void tc_drop_drive(int v)
+{
+    for (int i = 0; i < g_tc_nslots; i++) {
+        if (g_tc_slot[i].drive != v)
+            continue;
+        if (g_tc_slot[i].dirty && g_mounted[v])
+            tc_flush_slot(i);
+        g_tc_slot[i].dirty = false;
+        g_tc_slot[i].drive = -1;
+    }
+    g_tc_head[v] = -1;
+    g_tc_dir[v]  = 1;
+    g_tc_warm[v] = 0;
+}
+
+static int tc_find(int v, uint32_t track)
+{
+    for (int i = 0; i < g_tc_nslots; i++)
+        if (g_tc_slot[i].drive == v && g_tc_slot[i].track == track)
+            return i;
+    return -1;
+}
+
+/* Claim a slot for (v, track): a free one, else (if evict) the least recently
+ * used clean one. The slot is tagged but its data is the caller's to fill. */
+static int tc_alloc(int v, uint32_t track, bool evict)
+{
+    int pick = -1;
+    for (int i = 0; i < g_tc_nslots; i++) {
+        if (g_tc_slot[i].busy)
+            continue;
+        if (g_tc_slot[i].drive < 0) {
+            pick = i;
+            break;
+        }
+        if (evict && !g_tc_slot[i].dirty &&
+            (pick < 0 || g_tc_slot[i].used < g_tc_slot[pick].used))
+            pick = i;
+    }
+    if (pick >= 0) {
+        g_tc_slot[pick].drive = (int8_t)v;
+        g_tc_slot[pick].track = (uint8_t)track;
+        g_tc_slot[pick].used  = ++g_tc_clock;
+    }
+    return pick;
+}
+
+/* Load one whole track of drive v into a cache slot (prefetch / warm-up). */
+static bool tc_fill(int v, uint32_t track, bool evict)
+{
+    int i = tc_alloc(v, track, evict);
+    if (i < 0)
+        return false;
+    if (!load_track(v, track * 13u, MAX_TRACK_BYTES, tc_buf(i), false)) {
+        g_tc_slot[i].drive = -1;   /* short image: leave it to the demand path */
+        return false;
+    }
+    g_tc_stats[v].prefetches++;
+    return true;
+}
+
+/* Write-back step: store at most one due dirty track (the oldest). In
+ * write-through mode every dirty track is due, so switching modes drains
+ * them. Returns true if it flushed one. */
+static bool tc_flush_step(bool idle)
+{
+    int64_t now  = esp_timer_get_time();
+    bool    wb   = settings()->disk_writeback != 0;
+    int     pick = -1;
+    for (int i = 0; i < g_tc_nslots; i++) {
+        const tc_slot_t *sl = &g_tc_slot[i];
+        if (sl->drive < 0 || !sl->dirty)
+            continue;
+        bool due = !wb || now - sl->dirty_at >= WB_MAX_US ||
+                   (idle && now - sl->wr_at >= WB_IDLE_US);
+        if (due && (pick < 0 || sl->dirty_at < g_tc_slot[pick].dirty_at))
+            pick = i;
+    }
+    if (pick < 0)
+        return false;
+    tc_flush_slot(pick);
+    return true;
+}
+
+/* One bounded background step, run only on a poll that served nothing: the
+ * next track ahead of a head, else the next track of a warm-up walk. */
+static void tc_prefetch_step(void)
+{
+    if (!g_tc_nslots)
+        return;
+
+    for (int v = 0; v < NDRV; v++) {
+        if (!g_mounted[v] || g_tc_head[v] < 0)
+            continue;
+        for (int k = 1; k <= TC_AHEAD; k++) {
+            int t = g_tc_head[v] + k * g_tc_dir[v];
+            if (t < 0 || (uint32_t)t >= g_ntracks[v] || tc_find(v, (uint32_t)t) >= 0)
+                continue;
+            tc_fill(v, (uint32_t)t, true);
+            return;
+        }
+    }
+
+    for (int v = 0; v < NDRV; v++) {
+        if (!g_mounted[v])
+            continue;
+        while (g_tc_warm[v] < g_ntracks[v]) {
+            uint32_t t = g_tc_warm[v]++;
+            if (tc_find(v, t) >= 0)
+                continue;
+            if (!tc_fill(v, t, false))
+                g_tc_warm[v] = g_ntracks[v];   /* pool full: stop warming */
+            return;
+        }
+    }
+}
+
+/* ---- HDD block cache --------------------------------------------------------
+ * The card (hdl/disk/hdd.sv) keeps a 4-block ring per unit in SPACE 5. A READ
+ * that misses it asks for a run from the requested block to the end of its
+ * 4-aligned group (BLKCNT + 1 blocks), and the following READs of that group
+ * are answered on the card without a request. Runs are served from a per-unit
+ * hdd_cache: a miss reads every missing block of the run with one image read,
+ * and when runs arrive in order the same read loads blocks past it. With
+ * PSRAM the cache is 64 sets x 4 ways per unit (128 KB) reading up to 56
+ * blocks ahead; in internal RAM it is 8 x 4 (16 KB) with 16 ahead. Writes
+ * arrive one block at a time; in write-back mode (settings()->disk_writeback)
+ * they are acked once cached and stored by hdd_flush_step() on the floppy
+ * tracks' WB_IDLE_US / WB_MAX_US schedule, contiguous dirty blocks coalescing
+ * into one image write. The staging buffer is shared: both units are served
+ * from the disk task. */
+#define HC_SETS_PSRAM     64u
+#define HC_AHEAD_PSRAM    56u
+#define HC_SETS_INTERNAL  8u
+#define HC_AHEAD_INTERNAL 16u
+#define HC_WAYS           4u
+
+static hdd_cache_t g_hc[NHDD];
+static bool        g_hc_ok;                /* storage allocated          */
+static int64_t     g_hc_dirty_at[NHDD];   /* first write since the last flush */
+static int64_t     g_hc_wr_at[NHDD];      /* latest write                     */
+
+/* Serve statistics (see disk_get_hdd_stats); the cache keeps its own. */
+typedef struct {
+    uint32_t reads, writes, blocks;
+    uint64_t us_sum;
+    uint32_t us_max;
+} hdd_stats_t;
+static hdd_stats_t   g_hdd_stats[NHDD];
+static volatile bool g_hdd_stats_reset_req;
+
+/* Sequential-copy benchmark (disk_hdd_bench_begin), run by disk_poll. */
+static volatile int  g_hdd_bench_unit = -1;
+static volatile bool g_hdd_bench_done;
+static disk_hdd_bench_t g_hdd_bench;
+
+/* hc_io_fn over unit (int)ctx's image. Writes are synced before returning. */
+static bool hdd_io(void *ctx, uint32_t lba, uint32_t count, void *buf,
+                   bool write)
+{
+    int    u   = (int)(intptr_t)ctx;
+    FILE  *f   = g_hdd_img[u];
+    size_t len = (size_t)count * SECTOR_BYTES;
+    if (!f || fseek(f, (long)g_hdd_base[u] + (long)lba * (long)SECTOR_BYTES,
+                    SEEK_SET) != 0)
+        return false;
+    if (!write)
+        return fread(buf, 1, len, f) == len;
+    bool ok = fwrite(buf, 1, len, f) == len;
+    image_sync(f);
+    return ok;
+}
+
+/* Cache storage, PSRAM first, internal RAM as the fallback (as tc_init). */
+static uint8_t *hc_alloc(uint32_t sets, uint32_t stage, uint32_t caps)
+{
+    size_t lines = (size_t)NHDD * sets * HC_WAYS;
+    size_t bytes = lines * sizeof(hc_line_t) + (lines + stage) * SECTOR_BYTES;
+    return heap_caps_malloc(bytes, caps | MALLOC_CAP_8BIT);
+}
+
+static void hdd_cache_init(void)
+{
+    if (g_hc_ok)
+        return;
+    uint32_t sets  = HC_SETS_PSRAM, ahead = HC_AHEAD_PSRAM;
+    uint32_t stage = A2HDD_RING_BLOCKS + ahead;
+    uint8_t *mem   = hc_alloc(sets, stage, MALLOC_CAP_SPIRAM);
+    if (!mem) {
+        sets  = HC_SETS_INTERNAL;
+        ahead = HC_AHEAD_INTERNAL;
+        stage = A2HDD_RING_BLOCKS + ahead;
+        mem   = hc_alloc(sets, stage, MALLOC_CAP_INTERNAL);
+    }
+    if (!mem) {
+        printf("[disk] hdd cache: DISABLED\n");
+        return;
+    }
+    uint32_t  nl    = sets * HC_WAYS;
+    hc_line_t *line = (hc_line_t *)mem;
+    uint8_t   *data = mem + (size_t)NHDD * nl * sizeof(hc_line_t);
+    uint8_t   *stg  = data + (size_t)NHDD * nl * SECTOR_BYTES;
+    for (int u = 0; u < NHDD; u++)
+        hc_init(&g_hc[u], line + (size_t)u * nl,
+                data + (size_t)u * nl * SECTOR_BYTES, (uint16_t)sets, HC_WAYS,
+                stg, (uint16_t)stage, (uint16_t)ahead);
+    g_hc_ok = true;
+    printf("[disk] hdd cache: %lu blocks/unit, %lu ahead (%s)\n",
+           (unsigned long)nl, (unsigned long)ahead,
+           sets == HC_SETS_PSRAM ? "PSRAM" : "internal RAM");
+}
+
+/* Write-back step: store the dirty blocks of at most one due unit. In
+ * write-through mode every dirty block is due, so switching modes drains
+ * them. Returns true if it stored anything. */
+static bool hdd_flush_step(bool idle)
+{
+    if (!g_hc_ok)
+        return false;
+    int64_t now = esp_timer_get_time();
+    bool    wb  = settings()->disk_writeback != 0;
+    for (int u = 0; u < NHDD; u++) {
+        if (!g_hdd_mounted[u] || hc_dirty(&g_hc[u]) == 0)
+            continue;
+        bool due = !wb || now - g_hc_dirty_at[u] >= WB_MAX_US ||
+                   (idle && now - g_hc_wr_at[u] >= WB_IDLE_US);
+        if (!due)
+            continue;
+        if (hc_flush(&g_hc[u], g_hc[u].stage_blocks) < 0)
+            DLOGW("HDD: UNIT %d WRITE-BACK FAILED", u + 1);
+        if (hc_dirty(&g_hc[u]))
+            g_hc_dirty_at[u] = now;   /* more to go; don't starve the Apple */
+        return true;
+    }
+    return false;
+}
+
+/* Land unit u's dirty blocks and forget its cache (remount / eject). Call
+ * while the image is still open. */
+static void hdd_cache_drop(int u)
+{
+    if (!g_hc_ok)
+        return;
+    if (g_hdd_mounted[u] && hc_flush(&g_hc[u], g_hdd_blocks[u]) < 0)
+        DLOGW("HDD: UNIT %d WRITE-BACK FAILED", u + 1);
+    hc_detach(&g_hc[u]);
+}
+
+/* Read count blocks at lba of unit u: through the cache, or straight from
+ * the image when it could not be allocated. Blocks past the end read as
+ * zeros; returns false if the image read failed. */
+static bool hdd_read(int u, uint32_t lba, uint32_t count, uint8_t *buf)
+{
+    if (g_hc_ok)
+        return hc_read(&g_hc[u], lba, count, buf);
+    uint32_t n = lba < g_hdd_blocks[u] ? g_hdd_blocks[u] - lba : 0;
+    if (n > count)
+        n = count;
+    bool ok = !n || hdd_io((void *)(intptr_t)u, lba, n, buf, false);
+    if (!ok)
+        n = 0;
+    memset(buf + (size_t)n * SECTOR_BYTES, 0, (size_t)(count - n) * SECTOR_BYTES);
+    return ok;
+}
+
+/* The benchmark: read HDD_BENCH_BLOCKS blocks of unit u from block 0 twice,
+ * one image read per block (the pre-cache serve path) and then in the card's
+ * 4-block runs through an emptied cache. Read-only, FPGA untouched; blocks
+ * the disk task while it runs. The cache's live counters are left as they
+ * were. */
+#define HDD_BENCH_BLOCKS 1600u   /* 800 KB */
+static void hdd_bench_run(int u)
+{
+    disk_hdd_bench_t *b = &g_hdd_bench;
+    memset(b, 0, sizeof(*b));
+    if (u < 0 || u >= NHDD || !g_hdd_mounted[u] || !g_hc_ok)
+        return;
+    hdd_cache_t *c = &g_hc[u];
+    uint32_t n = g_hdd_blocks[u] < HDD_BENCH_BLOCKS ? g_hdd_blocks[u]
+                                                     : HDD_BENCH_BLOCKS;
+    if (hc_flush(c, g_hdd_blocks[u]) < 0)
+        return;
+
+    int64_t t0 = esp_timer_get_time();
+    for (uint32_t k = 0; k < n; k++) {
+        if (!hdd_io((void *)(intptr_t)u, k, 1, g_blockbuf, false))
+            return;
+    }
+    b->base_us    = (uint32_t)(esp_timer_get_time() - t0);
+    b->base_reads = n;
+
+    hc_stats_t live = c->st;
+    hc_attach(c, hdd_io, (void *)(intptr_t)u, g_hdd_blocks[u]);
+    memset(&c->st, 0, sizeof(c->st));
+    t0 = esp_timer_get_time();
+    for (uint32_t k = 0; k < n; k += A2HDD_RING_BLOCKS) {
+        uint32_t run = n - k < A2HDD_RING_BLOCKS ? n - k : A2HDD_RING_BLOCKS;
+        hc_read(c, k, run, g_blockbuf);
+    }
+    b->cache_us    = (uint32_t)(esp_timer_get_time() - t0);
+    b->cache_reads = c->st.fills;
+    b->hits        = c->st.hits;
+    b->misses      = c->st.misses;
+    b->ok          = c->st.errors == 0;
+    b->blocks      = n;
+    c->st = live;
+}
+
 static void mount_drive(int v)
 {
+    tc_drop_drive(v);   /* while g_mounted still lets it land dirty tracks */
     g_mounted[v]  = false;
     g_writable[v] = false;
     g_fmt[v]      = FMT_NONE;
     g_order[v]    = GCR_ORDER_DOS;
     g_base[v]     = 0;
+    g_ntracks[v]  = 0;
+    g_woz_crc_off[v] = false;
     fpga_reg_write(A2REG_VOL_READY(v), 0);
     fpga_reg_write(A2REG_VOL_MOUNTED(v), 0);
 
@@ -318,6 +1013,15 @@ static void mount_drive(int v)
              * .po stay explicit). */
             if (fmt == FMT_DSK && has_ext(name, "dsk"))
                 order = sniff_dsk_order(f);
+            if (fmt == FMT_WOZ) {
+                if (!woz_parse(woz_read, f, bytes, &g_woz[v])) {
+                    DLOGI("DISK II: D%d %s not a 5.25 WOZ - skip",
+                          v + 1, disp(name));
+                    fmt = FMT_NONE;
+                } else if (g_woz[v].write_protected) {
+                    rw = false;   /* INFO write-protect tab */
+                }
+            }
         }
 
         if (fmt == FMT_NONE) {
@@ -333,12 +1037,23 @@ static void mount_drive(int v)
         strncpy(g_imgname[v], name, sizeof(g_imgname[v]) - 1);
         g_imgname[v][sizeof(g_imgname[v]) - 1] = '\0';
         opened = 1;
+        if (rw)
+            jnl_replay(v);   /* finish a write-back flush cut short */
 
         uint32_t blocks = bytes / SECTOR_BYTES;
+        if (fmt == FMT_WOZ) {
+            g_ntracks[v] = WOZ_TRACKS;   /* unmapped tracks serve blank */
+        } else {
+            g_ntracks[v] = (fmt == FMT_DSK) ? DISK_TRACKS
+                                            : bytes / MAX_TRACK_BYTES;
+            if (g_ntracks[v] > DISK_TRACKS)
+                g_ntracks[v] = DISK_TRACKS;
+        }
         /* .dsk/.do/.po: 35 trk * 16 * 256 = 143360 B; .nib: 35 * 6656 =
          * 232960 B. VOL_SIZE is informational for a floppy. */
         DLOGI("DISK II: D%d %s = %lu B (%s%s)", v + 1, disp(g_imgname[v]),
               (unsigned long)bytes,
+              fmt == FMT_WOZ ? (g_woz[v].version == 1 ? "woz1" : "woz2") :
               fmt == FMT_NIB ? "nib" :
               (order == GCR_ORDER_PRODOS ? "po" : "dsk"),
               base ? " 2mg" : "");
@@ -421,6 +1136,8 @@ static void mount_hdd(int u)
 
         fpga_reg_write(A2REG_HDD_SIZE_L(u), (uint8_t)blocks);
         fpga_reg_write(A2REG_HDD_SIZE_H(u), (uint8_t)(blocks >> 8));
+        if (g_hc_ok)
+            hc_attach(&g_hc[u], hdd_io, (void *)(intptr_t)u, blocks);
         fpga_reg_write(A2REG_HDD_CTL(u), A2HDD_CTL_READY | A2HDD_CTL_MOUNTED |
                                          (rw ? 0 : A2HDD_CTL_READONLY));
         g_hdd_mounted[u] = true;
@@ -456,8 +1173,10 @@ static void disk_remount(void)
     osd_console_show();
     DLOGI("DISK II: SEARCHING FOR STORAGE...");
 
-    /* Tear down the previous mount. */
+    /* Tear down the previous mount (landing any write-back tracks and blocks
+     * first). */
     for (int v = 0; v < NDRV; v++) {
+        tc_drop_drive(v);
         if (g_img[v]) {
             fclose(g_img[v]);
             g_img[v] = NULL;
@@ -468,6 +1187,7 @@ static void disk_remount(void)
         fpga_reg_write(A2REG_VOL_MOUNTED(v), 0);
     }
     for (int u = 0; u < NHDD; u++) {
+        hdd_cache_drop(u);
         if (g_hdd_img[u]) {
             fclose(g_hdd_img[u]);
             g_hdd_img[u] = NULL;
@@ -475,6 +1195,7 @@ static void disk_remount(void)
         g_hdd_mounted[u] = false;
         fpga_reg_write(A2REG_HDD_CTL(u), 0);
     }
+    jnl_close();   /* the card may have been swapped */
 
     /* SD card present? The VFS mount is owned by the integrator; probe it. */
     DIR *root = opendir(SD_ROOT);
@@ -524,21 +1245,89 @@ void disk_init(void)
     /* Nothing to bring up here: settings_init() and the SD/VFS mount are the
      * integrator's job; the first disk_poll() performs the initial mount. */
     g_remount_req = true;
+    tc_init();
+    hdd_cache_init();
 }
 
-static void serve_drive(int v)
+/* Request-to-ack latency: when the oldest pending request was raised, on our
+ * clock (STATUS read time minus the FPGA's age of the request). */
+static int64_t g_req_raised_us;
+
+static void lat_record(void)
 {
-    if (!g_mounted[v])
+    fpga_lat_record(FPGA_ATTN_DISK,
+                    (uint32_t)(esp_timer_get_time() - g_req_raised_us));
+}
+
+/* A served floppy request whose ACK may still be queued behind the track
+ * DMA. vol_acked() stamps the ACK; disk_poll() settles the statistics once
+ * the queue has drained, and resends the track if the drain reports a CRC
+ * failure (src stays valid until then: the slot is busy). */
+typedef struct {
+    bool             open;
+    bool             wr, hit;
+    int64_t          seen, raised;
+    volatile int64_t acked;
+    const uint8_t   *src;       /* queued track, NULL once sent synchronously */
+    uint32_t         addr, nbyte;
+} vol_ack_t;
+static vol_ack_t g_vol_ack[NDRV];
+
+static void vol_acked(void *arg, bool ok)
+{
+    (void)ok;
+    g_vol_ack[(intptr_t)arg].acked = esp_timer_get_time();
+}
+
+static void vol_settle(int v)
+{
+    vol_ack_t *a = &g_vol_ack[v];
+    if (!a->open || !a->acked)
+        return;
+    a->open = false;
+    fpga_lat_record(FPGA_ATTN_DISK, (uint32_t)(a->acked - a->raised));
+    if (a->wr)
         return;
+    tc_stats_t *st = &g_tc_stats[v];
+    uint32_t us = (uint32_t)(a->acked - a->seen);
+    if (a->hit) {
+        st->hits++;
+        st->hit_us_sum += us;
+        if (us > st->hit_us_max)
+            st->hit_us_max = us;
+    } else {
+        st->misses++;
+        st->miss_us_sum += us;
+        if (us > st->miss_us_max)
+            st->miss_us_max = us;
+    }
+}
+
+/* Returns true if a request was pending (and has been serviced). */
+static bool serve_drive(int v)
+{
+    if (!g_mounted[v])
+        return false;
 
-    uint8_t cmd = fpga_reg_read(A2REG_VOL_CMD(v));
+    /* One register program: CMD first, then LBA0..3 + BLK_CNT, which hold
+     * still while CMD shows a request pending. */
+    uint8_t cmd, w[5];
+    const fpga_reg_op_t req[] = {
+        { .reg = A2REG_VOL_CMD(v),  .n = 1,         .buf = &cmd },
+        { .reg = A2REG_VOL_LBA0(v), .n = sizeof(w), .buf = w },
+    };
+    fpga_reg_program(req, 2);
     bool rd = (cmd & A2VOL_CMD_RD) != 0;
     bool wr = (cmd & A2VOL_CMD_WR) != 0;
     if (!rd && !wr)
-        return;   /* nothing pending */
+        return false;   /* nothing pending */
 
-    uint32_t lba   = fpga_reg_read32(A2REG_VOL_LBA0(v));
-    uint32_t nblk  = (uint32_t)fpga_reg_read(A2REG_VOL_BLK_CNT(v)) + 1u;
+    int64_t t0  = esp_timer_get_time();   /* request seen -> ack latency */
+    bool    hit = false;
+
+    uint32_t lba   = (uint32_t)w[0] | ((uint32_t)w[1] << 8) |
+                     ((uint32_t)w[2] << 16) | ((uint32_t)w[3] << 24);
+    uint32_t nblk  = (uint32_t)w[4] + 1u;   /* BLK_CNT */
     uint32_t nbyte = nblk * SECTOR_BYTES;
     if (nbyte > MAX_TRACK_BYTES)
         nbyte = MAX_TRACK_BYTES;
@@ -561,133 +1350,179 @@ static void serve_drive(int v)
     }
 
     if (wr) {
-        /* Flush a dirty track: FPGA track window -> image file. */
+        /* Flush a dirty track: FPGA track window -> image file (or, in
+         * write-back mode, -> its cache slot, stored later). */
         if (g_writable[v]) {
-            for (uint32_t off = 0; off < nbyte; off += SECTOR_BYTES) {
-                uint32_t chunk = nbyte - off;
-                if (chunk > SECTOR_BYTES)
-                    chunk = SECTOR_BYTES;
-                fpga_mem_read(A2SPACE_DISK, addr + off,
-                              g_trackbuf + off, (uint16_t)chunk);
-            }
-            if (g_fmt[v] == FMT_DSK) {
-                /* Decode the (possibly partly rewritten) nibble track back to
-                 * file-order sectors. Preload the current on-file track so any
-                 * sector that fails to decode keeps its existing bytes; gate the
-                 * write on the found-mask so a bad decode never corrupts the
-                 * image. */
-                uint32_t track = lba / 13u;
-                long     fpos  = (long)g_base[v] +
-                                 (long)track * (long)DSK_TRACK_BYTES;
-                size_t br = 0;
-                if (fseek(g_img[v], fpos, SEEK_SET) == 0)
-                    br = fread(g_secbuf, 1, DSK_TRACK_BYTES, g_img[v]);
-                if (br < DSK_TRACK_BYTES)
-                    memset(g_secbuf + br, 0, DSK_TRACK_BYTES - br);
-                uint16_t mask = gcr_decode_dos_track(g_trackbuf, MAX_TRACK_BYTES,
-                                                     g_order[v], g_secbuf);
-                if (mask != 0) {
-                    if (fseek(g_img[v], fpos, SEEK_SET) == 0) {
-                        fwrite(g_secbuf, 1, DSK_TRACK_BYTES, g_img[v]);
-                        image_sync(g_img[v]);
-                    }
+            fpga_mem_read(A2SPACE_DISK, addr, g_trackbuf, (uint16_t)nbyte);
+
+            uint32_t track = lba / 13u;
+            bool whole = (lba % 13u) == 0 && nbyte == MAX_TRACK_BYTES &&
+                         track < g_ntracks[v];
+            int i = tc_find(v, track);
+            if (i >= 0 && g_tc_slot[i].dirty && !whole)
+                tc_flush_slot(i);   /* land the pending track under a partial */
+            if (whole && i < 0)
+                i = tc_alloc(v, track, true);
+
+            if (whole && i >= 0 && settings()->disk_writeback) {
+                /* Write-back: ack now; rewrites before the flush coalesce. */
+                tc_slot_t *sl = &g_tc_slot[i];
+                memcpy(tc_buf(i), g_trackbuf, MAX_TRACK_BYTES);
+                sl->used  = ++g_tc_clock;
+                sl->wr_at = esp_timer_get_time();
+                if (sl->dirty) {
+                    g_tc_stats[v].coalesced++;
+                } else {
+                    sl->dirty    = true;
+                    sl->dirty_at = sl->wr_at;
                 }
-                if (mask != 0xFFFF)
-                    DLOGW("DISK II: D%d TRK%lu wr partial mask=%04X",
-                          v + 1, (unsigned long)track, (unsigned)mask);
             } else {
-                if (fseek(g_img[v], (long)g_base[v] +
-                                    (long)lba * (long)SECTOR_BYTES,
-                          SEEK_SET) == 0) {
-                    fwrite(g_trackbuf, 1, nbyte, g_img[v]);
-                    image_sync(g_img[v]);
+                store_track(v, lba, nbyte, g_trackbuf, false);
+
+                /* Keep the cache coherent with what the Apple II now sees:
+                 * a whole-track flush replaces the cached nibbles with the
+                 * window contents; anything narrower drops the stale copy. */
+                if (whole && i >= 0) {
+                    memcpy(tc_buf(i), g_trackbuf, MAX_TRACK_BYTES);
+                    g_tc_slot[i].used  = ++g_tc_clock;
+                    g_tc_slot[i].dirty = false;
+                } else if (i >= 0) {
+                    g_tc_slot[i].drive = -1;
                 }
             }
+            g_tc_stats[v].writes++;
         }
     } else {
-        /* Load the requested track: image file -> FPGA track window. */
+        /* Load the requested track: image file -> FPGA track window,
+         * answered from the track cache when it holds the track. */
         uint32_t track = lba / 13u;
-        if (g_fmt[v] == FMT_DSK) {
-            /* Read this track's 16*256 file-order sectors and nibblize them
-             * into the 6-and-2 GCR stream the window expects. */
-            size_t br = 0;
-            if (fseek(g_img[v], (long)g_base[v] +
-                                (long)track * (long)DSK_TRACK_BYTES,
-                      SEEK_SET) == 0)
-                br = fread(g_secbuf, 1, DSK_TRACK_BYTES, g_img[v]);
-            if (br < DSK_TRACK_BYTES)
-                memset(g_secbuf + br, 0, DSK_TRACK_BYTES - br);
-            gcr_encode_dos_track(g_secbuf, (uint8_t)track, DSK_DEFAULT_VOLUME,
-                                 g_order[v], g_trackbuf, MAX_TRACK_BYTES);
+        bool whole = (lba % 13u) == 0 && nbyte == MAX_TRACK_BYTES &&
+                     track < g_ntracks[v];
+        const uint8_t *src = g_trackbuf;
+        int i = tc_find(v, track);
+        if (!whole) {
+            if (i >= 0 && g_tc_slot[i].dirty)
+                tc_flush_slot(i);   /* partial read: the image must be current */
+            i = -1;
+        }
+        hit = (i >= 0);
+        if (hit) {
+            src = tc_buf(i);
+            g_tc_slot[i].used = ++g_tc_clock;
         } else {
-            /* .nib: raw nibble stream, streamed as-is. */
-            size_t br = 0;
-            if (fseek(g_img[v], (long)g_base[v] +
-                                (long)lba * (long)SECTOR_BYTES,
-                      SEEK_SET) == 0)
-                br = fread(g_trackbuf, 1, nbyte, g_img[v]);
-            if (br < nbyte) {
-                /* EOF: a zero-filled track has no sync/prologue nibbles, so RWTS
-                 * finds nothing and DOS I/O-errors at this same track every boot
-                 * — pinpoints a truncated/short .nib. */
-                osd_console_show();
-                DLOGW("DISK II: TRK%lu SHORT br=%lu/%lu (EOF) -> zero-fill",
-                      (unsigned long)track,
-                      (unsigned long)br, (unsigned long)nbyte);
-                memset(g_trackbuf + br, 0, nbyte - br);
-            }
+            if (whole)
+                i = tc_alloc(v, track, true);
+            uint8_t *dst = (i >= 0) ? tc_buf(i) : g_trackbuf;
+            if (!load_track(v, lba, nbyte, dst, true) && i >= 0)
+                g_tc_slot[i].drive = -1;   /* serve it, but don't keep it */
+            src = dst;
         }
 
-        for (uint32_t off = 0; off < nbyte; off += SECTOR_BYTES) {
-            uint32_t chunk = nbyte - off;
-            if (chunk > SECTOR_BYTES)
-                chunk = SECTOR_BYTES;
-            fpga_mem_write(A2SPACE_DISK, addr + off,
-                           g_trackbuf + off, (uint16_t)chunk);
+        /* Head direction for the read-ahead. */
+        if (g_tc_head[v] >= 0 && (int)track != g_tc_head[v])
+            g_tc_dir[v] = ((int)track > g_tc_head[v]) ? 1 : -1;
+        g_tc_head[v] = (int)track;
+
+        /* A cached track goes out as one queued DMA with the ACK queued
+         * behind it, so the Apple II is released the moment the data lands
+         * while disk_poll() goes on to read ahead. The slot stays busy (no
+         * tc_alloc() reuse) until disk_poll() has drained the queue. With
+         * CRC on, a queued track is only checked in that drain, after the
+         * ACK would have released the head onto it: send it synchronously
+         * (checked, resent on a mismatch) and ACK after. */
+        if (i >= 0 && !fpga_link_crc()) {
+            static const uint8_t k_ack = 1;
+            g_tc_slot[i].busy = true;
+            g_vol_ack[v] = (vol_ack_t){ .open = true, .hit = hit, .seen = t0,
+                                        .raised = g_req_raised_us,
+                                        .src = src, .addr = addr, .nbyte = nbyte };
+            if (fpga_mem_write_async(A2SPACE_DISK, addr, src, (uint16_t)nbyte,
+                                     NULL, NULL) &&
+                fpga_reg_write_async(A2REG_VOL_ACK(v), &k_ack, vol_acked,
+                                     (void *)(intptr_t)v))
+                return true;
         }
+        fpga_mem_write(A2SPACE_DISK, addr, src, (uint16_t)nbyte);
     }
 
     fpga_reg_write(A2REG_VOL_ACK(v), 1);   /* request serviced — release the head */
+    g_vol_ack[v] = (vol_ack_t){ .open = true, .wr = wr, .hit = hit, .seen = t0,
+                                .raised = g_req_raised_us,
+                                .acked = esp_timer_get_time() };
+    return true;
 }
 
 /* Serve one ProDOS HDD unit: raw 512-byte blocks, LBA 1:1 into the image
- * payload, one block per request through the unit's XFER SPACE 5 window. */
-static void serve_hdd(int u)
+ * payload, through the block cache and the unit's XFER SPACE 5 ring. A READ
+ * loads the requested run (BLKCNT + 1 blocks, never past the ring group) into
+ * its ring slots with one XFER; a WRITE carries one block. */
+/* Returns true if a request was pending (and has been serviced). */
+static bool serve_hdd(int u)
 {
     if (!g_hdd_mounted[u])
-        return;
+        return false;
 
-    uint8_t req = fpga_reg_read(A2REG_HDD_REQ(u)) &
-                  (A2HDD_REQ_RD | A2HDD_REQ_WR);
+    /* REQ, then LBA_L/LBA_H/BLKCNT (stable while REQ is pending), in one
+     * program */
+    uint8_t req, w[3];
+    const fpga_reg_op_t ops[] = {
+        { .reg = A2REG_HDD_REQ(u),   .n = 1,         .buf = &req },
+        { .reg = A2REG_HDD_LBA_L(u), .n = sizeof(w), .buf = w },
+    };
+    fpga_reg_program(ops, 2);
+    req &= A2HDD_REQ_RD | A2HDD_REQ_WR;
     if (!req)
-        return;   /* nothing pending */
+        return false;   /* nothing pending */
 
-    uint32_t lba = (uint32_t)fpga_reg_read(A2REG_HDD_LBA_L(u)) |
-                   ((uint32_t)fpga_reg_read(A2REG_HDD_LBA_H(u)) << 8);
-    uint32_t addr = A2HDD_WINDOW(u);
-    long     fpos = (long)g_hdd_base[u] + (long)lba * (long)SECTOR_BYTES;
+    int64_t  t0   = esp_timer_get_time();   /* request seen -> ack latency */
+    uint32_t lba  = (uint32_t)w[0] | ((uint32_t)w[1] << 8);
+    uint32_t slot = lba % A2HDD_RING_BLOCKS;
+    uint32_t addr = A2HDD_WINDOW(u) + slot * SECTOR_BYTES;
+    hdd_stats_t *st = &g_hdd_stats[u];
+    uint32_t nblk = 1;
+    bool ok = true;
 
     if (req & A2HDD_REQ_WR) {
-        /* write: block window -> image file */
+        /* write: ring slot -> cache (write-back) or image file */
         if (g_hdd_writable[u] && lba < g_hdd_blocks[u]) {
+            bool wb = settings()->disk_writeback != 0 && g_hc_ok;
             fpga_mem_read(A2SPACE_HDD, addr, g_blockbuf, SECTOR_BYTES);
-            if (fseek(g_hdd_img[u], fpos, SEEK_SET) == 0) {
-                fwrite(g_blockbuf, 1, SECTOR_BYTES, g_hdd_img[u]);
-                image_sync(g_hdd_img[u]);
+            if (!g_hc_ok) {
+                ok = hdd_io((void *)(intptr_t)u, lba, 1, g_blockbuf, true);
+            } else {
+                if (wb && hc_dirty(&g_hc[u]) == 0)
+                    g_hc_dirty_at[u] = t0;
+                g_hc_wr_at[u] = t0;
+                ok = hc_write(&g_hc[u], lba, 1, g_blockbuf, wb);
             }
         }
+        st->writes++;
     } else {
-        /* read: image file -> block window */
-        size_t br = 0;
-        if (lba < g_hdd_blocks[u] &&
-            fseek(g_hdd_img[u], fpos, SEEK_SET) == 0)
-            br = fread(g_blockbuf, 1, SECTOR_BYTES, g_hdd_img[u]);
-        if (br < SECTOR_BYTES)
-            memset(g_blockbuf + br, 0, SECTOR_BYTES - br);
-        fpga_mem_write(A2SPACE_HDD, addr, g_blockbuf, SECTOR_BYTES);
+        /* read: cache / image file -> ring slots */
+        nblk = (uint32_t)w[2] + 1u;
+        if (nblk > A2HDD_RING_BLOCKS - slot)
+            nblk = A2HDD_RING_BLOCKS - slot;
+        ok = hdd_read(u, lba, nblk, g_blockbuf);
+        if (ok)
+            fpga_mem_write(A2SPACE_HDD, addr, g_blockbuf,
+                           (uint16_t)(nblk * SECTOR_BYTES));
+        st->reads++;
     }
 
-    fpga_reg_write(A2REG_HDD_ACK(u), 1);   /* request serviced */
+    /* request serviced; a failed one ends in a ProDOS I/O error */
+    if (!ok)
+        DLOGW("HDD: UNIT %d %s BLOCK %u FAILED", u + 1,
+              (req & A2HDD_REQ_WR) ? "WRITE" : "READ", (unsigned)lba);
+    fpga_reg_write(A2REG_HDD_ACK(u),
+                   ok ? A2HDD_ACK_OK : A2HDD_ACK_OK | A2HDD_ACK_ERR);
+    lat_record();
+
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    st->blocks += nblk;
+    st->us_sum += us;
+    if (us > st->us_max)
+        st->us_max = us;
+    return true;
 }
 
 /* Program the persisted slot map into the slotmaker and strobe a reconfig.
@@ -716,7 +1551,7 @@ static void apply_slot_map(void)
           eff[0], eff[1], eff[2], eff[3], eff[4], eff[5], eff[6], eff[7]);
 }
 
-void disk_poll(void)
+bool disk_poll(void)
 {
     if (g_remount_req) {
         g_remount_req = false;
@@ -805,10 +1640,66 @@ void disk_poll(void)
         g_list_done = true;
     }
 
+    if (g_tc_stats_reset_req) {
+        g_tc_stats_reset_req = false;
+        memset(g_tc_stats, 0, sizeof(g_tc_stats));
+    }
+    if (g_hdd_stats_reset_req) {
+        g_hdd_stats_reset_req = false;
+        memset(g_hdd_stats, 0, sizeof(g_hdd_stats));
+        for (int u = 0; u < NHDD; u++)
+            memset(&g_hc[u].st, 0, sizeof(g_hc[u].st));
+    }
+    if (g_hdd_bench_unit >= 0) {
+        hdd_bench_run(g_hdd_bench_unit);
+        g_hdd_bench_unit = -1;
+        g_hdd_bench_done = true;
+    }
+
+    /* STATUS carries a pending summary for both request types: one register
+     * read instead of one per drive and unit, and none at all while the
+     * attention line is high. */
+    uint8_t st = 0;
+    if (fpga_attn_pending()) {
+        uint32_t age_us;
+        st = fpga_attn_status(FPGA_ATTN_DISK, &age_us);
+        g_req_raised_us = esp_timer_get_time() - age_us;
+    }
+    bool busy = false;
+    if (st & A2STAT_VOL_PENDING)
+        for (int v = 0; v < NDRV; v++)
+            busy |= serve_drive(v);
+    if (st & A2STAT_HDD_PENDING)
+        for (int u = 0; u < NHDD; u++)
+            busy |= serve_hdd(u);
+
+    /* Background work, one track (or one HDD flush) at most: a due
+     * write-back flush, else (on an idle poll) read-ahead. */
+    if (!tc_flush_step(!busy) && !hdd_flush_step(!busy) &&
+        (!busy || fpga_mem_inflight()))
+        tc_prefetch_step();   /* also while a served track is still in DMA */
+
+    /* Nothing queued outlives the poll: the buffers are ours again and every
+     * ACK is out. */
+    if (!fpga_mem_wait()) {
+        /* A queued track failed its CRC (or the queue broke): resend the
+         * served ones synchronously, which retries, before the buffers go. */
+        for (int v = 0; v < NDRV; v++) {
+            vol_ack_t *a = &g_vol_ack[v];
+            if (!a->open || !a->src)
+                continue;
+            fpga_mem_write(A2SPACE_DISK, a->addr, a->src, (uint16_t)a->nbyte);
+            if (!a->acked) {
+                fpga_reg_write(A2REG_VOL_ACK(v), 1);
+                a->acked = esp_timer_get_time();
+            }
+        }
+    }
+    for (int i = 0; i < g_tc_nslots; i++)
+        g_tc_slot[i].busy = false;
     for (int v = 0; v < NDRV; v++)
-        serve_drive(v);
-    for (int u = 0; u < NHDD; u++)
-        serve_hdd(u);
+        vol_settle(v);
+    return busy;
 }
 
 /* ---- menu accessors (see disk.h) ----------------------------------------- */
@@ -827,6 +1718,7 @@ void disk_get_floppy_info(int v, disk_info_t *out)
     if (g_mounted[v])
         snprintf(out->detail, sizeof(out->detail), "%s %s",
                  g_fmt[v] == FMT_NIB ? "NIB" :
+                 g_fmt[v] == FMT_WOZ ? "WOZ" :
                  (g_order[v] == GCR_ORDER_PRODOS ? "PO" : "DSK"),
                  g_writable[v] ? "RW" : "RO");
 }
@@ -849,6 +1741,91 @@ void disk_get_hdd_info(int u, disk_info_t *out)
                  g_hdd_writable[u] ? "RW" : "RO");
 }
 
+void disk_get_track_stats(int v, disk_track_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (v < 0 || v >= NDRV)
+        return;
+    const tc_stats_t *st = &g_tc_stats[v];
+    out->hits        = st->hits;
+    out->misses      = st->misses;
+    out->prefetches  = st->prefetches;
+    out->writes      = st->writes;
+    out->hit_us_avg  = st->hits ? (uint32_t)(st->hit_us_sum / st->hits) : 0;
+    out->hit_us_max  = st->hit_us_max;
+    out->miss_us_avg = st->misses ? (uint32_t)(st->miss_us_sum / st->misses) : 0;
+    out->miss_us_max = st->miss_us_max;
+    out->coalesced    = st->coalesced;
+    out->flushes      = st->flushes;
+    out->flush_us_avg = st->flushes ? (uint32_t)(st->flush_us_sum / st->flushes) : 0;
+    out->flush_us_max = st->flush_us_max;
+    for (int i = 0; i < g_tc_nslots; i++) {
+        if (g_tc_slot[i].drive != v)
+            continue;
+        out->cached++;
+        if (g_tc_slot[i].dirty)
+            out->dirty++;
+    }
+    out->slots       = (uint16_t)g_tc_nslots;
+}
+
+void disk_reset_track_stats(void)
+{
+    g_tc_stats_reset_req = true;   /* cleared by the next disk_poll */
+}
+
+void disk_get_hdd_stats(int u, disk_hdd_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (u < 0 || u >= NHDD)
+        return;
+    const hdd_stats_t *st = &g_hdd_stats[u];
+    const hc_stats_t  *cs = &g_hc[u].st;
+    uint32_t reqs = st->reads + st->writes;
+    out->reads      = st->reads;
+    out->writes     = st->writes;
+    out->blocks     = st->blocks;
+    out->us_avg     = reqs ? (uint32_t)(st->us_sum / reqs) : 0;
+    out->us_max     = st->us_max;
+    out->hits       = cs->hits;
+    out->misses     = cs->misses;
+    out->fills      = cs->fills;
+    out->ahead      = cs->ahead;
+    out->ahead_used = cs->ahead_used;
+    out->stores     = cs->stores;
+    out->stored     = cs->stored;
+    out->errors     = cs->errors;
+    if (g_hc_ok) {
+        out->cached = (uint16_t)hc_cached(&g_hc[u]);
+        out->dirty  = (uint16_t)hc_dirty(&g_hc[u]);
+        out->lines  = (uint16_t)(g_hc[u].sets * g_hc[u].ways);
+    }
+}
+
+void disk_reset_hdd_stats(void)
+{
+    g_hdd_stats_reset_req = true;   /* cleared by the next disk_poll */
+}
+
+void disk_hdd_bench_begin(int u)
+{
+    g_hdd_bench_done = false;
+    if (u < 0 || u >= NHDD) {
+        memset(&g_hdd_bench, 0, sizeof(g_hdd_bench));
+        g_hdd_bench_done = true;
+        return;
+    }
+    g_hdd_bench_unit = u;
+}
+
+bool disk_hdd_bench_poll(disk_hdd_bench_t *out)
+{
+    if (!g_hdd_bench_done)
+        return false;
+    *out = g_hdd_bench;
+    return true;
+}
+
 bool disk_backend_is_usb(void)
 {
     return false;   /* SD card is the only storage backend on the a2mega */
@@ -10,7 +10,8 @@
  * (mounted at /sdcard via VFS) and services those requests: it reads the
  * requested track from the file and streams it into the FPGA track window,
  * then acknowledges. ProDOS HDD units (hdl/disk/hdd.sv) are served the same
- * way, one 512-byte block at a time through XFER SPACE 5.
+ * way, a run of 512-byte blocks at a time into a block ring in XFER SPACE 5,
+ * through a block cache with read-ahead.
  *
  * Supports read (track load) and write (dirty-track flush) when the image
  * opens read-write; falls back to read-only for write-protected images.
@@ -23,6 +24,7 @@
 #define _DISK_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -33,8 +35,10 @@ extern "C" {
 void disk_init(void);
 
 /* Service any pending track/block requests for all drives/units. Call
- * repeatedly from a dedicated task (~2 ms cadence). Never blocks. */
-void disk_poll(void);
+ * repeatedly from a dedicated task, sleeping in fpga_attn_wait() (~2 ms
+ * timeout) between calls. Never blocks. Returns true if a request was
+ * served — call again straight away, another may have arrived meanwhile. */
+bool disk_poll(void);
 
 /* Request a re-mount on the next poll (e.g. after the menu changes an image
  * selection or the SD card is re-inserted). Safe to call from other tasks. */
@@ -60,6 +64,63 @@ bool disk_backend_is_usb(void);
 /* True while a requested remount has not finished yet. */
 bool disk_remount_pending(void);
 
+/* Floppy track-serve statistics for drive v (0/1), for the "diskstat" CLI.
+ * A hit is a track request answered from the nibblized track cache, a miss
+ * one that had to read (and nibblize) the image; latencies are request seen
+ * -> ack, in microseconds. prefetches counts tracks loaded ahead of demand.
+ * cached/slots give the cache occupancy for this drive / the pool size
+ * (slots == 0: cache disabled). In write-back mode (settings disk_writeback)
+ * dirty counts tracks acked but not yet stored, coalesced the rewrites that
+ * landed on an already-dirty track, and flushes/flush_us_* the background
+ * stores (journal + image write + syncs). */
+typedef struct {
+    uint32_t hits, misses, prefetches, writes;
+    uint32_t hit_us_avg, hit_us_max;
+    uint32_t miss_us_avg, miss_us_max;
+    uint32_t coalesced, flushes;
+    uint32_t flush_us_avg, flush_us_max;
+    uint16_t cached, slots, dirty;
+} disk_track_stats_t;
+void disk_get_track_stats(int v, disk_track_stats_t *out);
+
+/* Zero the counters above (applied by the next disk_poll). */
+void disk_reset_track_stats(void);
+
+/* ProDOS HDD serve statistics for unit u (0/1), for the `hddstat` command.
+ * reads/writes count card requests (a read carries a run of up to 4 blocks,
+ * blocks totals them) and us_* their request seen -> ack latency. The rest
+ * is the unit's block cache: hits/misses in blocks, fills the image reads
+ * behind the misses, ahead/ahead_used the read-ahead blocks loaded / later
+ * hit, stores/stored the image writes and the blocks they carried, and
+ * cached/dirty/lines its occupancy (lines = 0: no cache, served direct). */
+typedef struct {
+    uint32_t reads, writes, blocks;
+    uint32_t us_avg, us_max;
+    uint32_t hits, misses, fills, ahead, ahead_used;
+    uint32_t stores, stored, errors;
+    uint16_t cached, dirty, lines;
+} disk_hdd_stats_t;
+void disk_get_hdd_stats(int u, disk_hdd_stats_t *out);
+
+/* Zero the counters above (applied by the next disk_poll). */
+void disk_reset_hdd_stats(void);
+
+/* HDD sequential-read benchmark (`hddbench`): the disk task reads the first
+ * 800 KB of unit u twice, one image read per block and then in the card's
+ * 4-block runs through an emptied block cache, and reports both rates. Poll
+ * returns false until it has run; ok is false if the unit is not mounted,
+ * there is no cache or an image read failed. Read-only; image serving pauses
+ * while it runs. */
+typedef struct {
+    bool     ok;
+    uint32_t blocks;
+    uint32_t base_us, base_reads;     /* one image read per block */
+    uint32_t cache_us, cache_reads;   /* through the cache        */
+    uint32_t hits, misses;
+} disk_hdd_bench_t;
+void disk_hdd_bench_begin(int u);
+bool disk_hdd_bench_poll(disk_hdd_bench_t *out);
+
 /* Async directory listing (all filesystem access runs in the disk task so
  * stdio/VFS state stays single-threaded). Begin posts a request for one
  * directory (path relative to the SD root, "" = root); poll returns -1 while
@@ -6,7 +6,8 @@
  * (a2fpga_jtag.cpp) drives the same pins from openFPGALoader over USB;
  * here we drive them from an internal sequencer so the FPGA's external
  * SPI config flash can be programmed with no PC attached (menu
- * "FPGA UPDATE" from the SD card).
+ * "FPGA UPDATE" from the SD card), or the SRAM loaded directly for a
+ * quick try of a new bitstream.
  *
  * The GW5A family does NOT use the GW2A per-transaction IR-0x16 SPI mode.
  * Mirrored from openFPGALoader's gowin.cpp GW5A path instead:
@@ -59,8 +60,10 @@ static inline uint32_t gpio_in_bits(void)         { return GPIO.in1.val; }
 #define GWIR_ERASE_SRAM  0x05
 #define GWIR_XFER_DONE   0x09
 #define GWIR_IDCODE      0x11
+#define GWIR_INIT_ADDR   0x12
 #define GWIR_CFG_ENABLE  0x15
 #define GWIR_SPI_MODE    0x16
+#define GWIR_XFER_WRITE  0x17
 #define GWIR_CFG_DISABLE 0x3A
 #define GWIR_RELOAD      0x3C
 #define GWIR_GW5A_PRE    0x3F   /* GW5A pre/recovery instruction */
@@ -299,13 +302,16 @@ void fpga_jtag_spi_xfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx,
         spi_clk(1, last_tdi);
 }
 
-/* Read n bytes of the config flash at addr (SPI 0x03). */
+/* Read n bytes of the config flash at addr (SPI 0x03). Each chunk pays a
+ * command, an address and CS framing, so whole-block hashing wants it big. */
+#define FLASH_RD_CHUNK 256u
+
 void fpga_jtag_flash_read(uint32_t addr, uint8_t *dst, uint32_t n)
 {
     while (n) {
-        uint32_t chunk = n > 64 ? 64 : n;
-        uint8_t tx[3 + 64];
-        uint8_t rxb[3 + 64];
+        uint32_t chunk = n > FLASH_RD_CHUNK ? FLASH_RD_CHUNK : n;
+        uint8_t tx[3 + FLASH_RD_CHUNK];
+        uint8_t rxb[3 + FLASH_RD_CHUNK];
         memset(tx, 0, sizeof(tx));
         tx[0] = (addr >> 16) & 0xFF;
         tx[1] = (addr >> 8) & 0xFF;
@@ -318,9 +324,9 @@ void fpga_jtag_flash_read(uint32_t addr, uint8_t *dst, uint32_t n)
     }
 }
 
-/* openFPGALoader GW5A prepare_flash_access: reset + long idle, erase the
- * SRAM (fabric dies), then switch to SPI mode. */
-bool fpga_jtag_flash_enter(void)
+/* openFPGALoader GW5A eraseSRAM, after a reset + long idle. The fabric
+ * dies here. */
+static bool erase_sram(void)
 {
     fpga_jtag_reset();
     jtag_idle_clocks(1000000);           /* GW5A settle (openFPGALoader) */
@@ -353,6 +359,15 @@ bool fpga_jtag_flash_enter(void)
     jtag_ir(GWIR_NOOP);
     if (fpga_jtag_status() & GWSTAT_DONE_FINAL)
         return false;                    /* fabric still configured */
+    return true;
+}
+
+/* openFPGALoader GW5A prepare_flash_access: erase the SRAM, then switch to
+ * SPI mode. */
+bool fpga_jtag_flash_enter(void)
+{
+    if (!erase_sram())
+        return false;
 
     vTaskDelay(pdMS_TO_TICKS(100));
     gw5a_enable_spi();
@@ -378,6 +393,49 @@ bool fpga_jtag_flash_enter_keepsram(void)
     return true;
 }
 
+/* ---- SRAM configuration ------------------------------------------------- */
+
+/* openFPGALoader GW5A writeSRAM: erase the SRAM, then CfgEnable, INIT_ADDR
+ * and XFER_WRITE, and the whole bitstream as one long DR shift. The shift
+ * stays in Shift-DR across fpga_jtag_sram_write() calls; the last one
+ * leaves through Exit1-DR. Bitstream bytes go MSB first (the .bin is in
+ * flash byte order, which openFPGALoader bit-reverses for its LSB-first
+ * shiftDR). */
+bool fpga_jtag_sram_begin(void)
+{
+    if (s_spi_mode)
+        gw5a_disable_spi();
+    if (!erase_sram())
+        return false;
+
+    jtag_ir(GWIR_CFG_ENABLE);
+    jtag_ir(GWIR_INIT_ADDR);
+    jtag_ir(GWIR_XFER_WRITE);
+    jtag_clk(1, 0);                      /* RTI -> Select-DR  */
+    jtag_clk(0, 0);                      /* -> Capture-DR     */
+    jtag_clk(0, 0);                      /* -> Shift-DR       */
+    return true;
+}
+
+void fpga_jtag_sram_write(const uint8_t *data, uint32_t n, bool last)
+{
+    for (uint32_t i = 0; i < n; i++) {
+        uint8_t b = data[i];
+        for (int k = 7; k >= 0; k--)
+            jtag_clk(last && i == n - 1 && k == 0, (b >> k) & 1);
+    }
+}
+
+bool fpga_jtag_sram_end(void)
+{
+    jtag_clk(1, 0);                      /* Exit1-DR -> Update-DR */
+    jtag_clk(0, 0);                      /* -> RTI                */
+    jtag_ir(GWIR_CFG_DISABLE);
+    jtag_ir(GWIR_NOOP);
+    /* DONE_FINAL rises once the device has woken up on the new image. */
+    return wait_status(GWSTAT_DONE_FINAL, GWSTAT_DONE_FINAL, 200);
+}
+
 /* Leave SPI mode and reconfigure from external flash. */
 void fpga_jtag_reload(void)
 {
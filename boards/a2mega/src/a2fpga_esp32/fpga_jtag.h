@@ -33,6 +33,15 @@ void fpga_jtag_spi_xfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx,
 // Read n bytes of the config flash at addr (SPI 0x03), SPI mode only.
 void fpga_jtag_flash_read(uint32_t addr, uint8_t *dst, uint32_t n);
 
+// Configure the FPGA SRAM directly with a .bin bitstream; the flash is not
+// touched, so the next power cycle boots the old image. begin() erases the
+// SRAM (the running bitstream dies) and opens the data shift; write() may be
+// called any number of times with last=true on the final call; end()
+// returns whether the FPGA reports DONE.
+bool fpga_jtag_sram_begin(void);
+void fpga_jtag_sram_write(const uint8_t *data, uint32_t n, bool last);
+bool fpga_jtag_sram_end(void);
+
 // Leave SPI mode and reconfigure the FPGA from the external flash.
 void fpga_jtag_reload(void);
 
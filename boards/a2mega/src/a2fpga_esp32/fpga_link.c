@@ -6,12 +6,21 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
+#include "driver/gpio.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include <string.h>
 
 static const char *TAG = "fpga_link";
 
 static SemaphoreHandle_t s_lock;
 static bool s_ok;
+static bool s_burst;   // connector exposes the SPACE 6 register window
+static uint8_t s_cap;  // CAPABILITIES, read at init
+static int s_rd_pf;    // XFER read prefetch depth in bytes, 0 = none
+static fpga_xfer_stats_t s_xstat[FPGA_XFER_NSTAT];
 
 void fpga_link_lock(void)   { if (s_lock) xSemaphoreTakeRecursive(s_lock, portMAX_DELAY); }
 void fpga_link_unlock(void) { if (s_lock) xSemaphoreGiveRecursive(s_lock); }
@@ -26,18 +35,29 @@ bool fpga_link_init(void)
     for (int i = 0; i < 4; i++)
         a2spi_reg_read(A2REG_DEVICE_ID0 + i, &id[i]);
     // First STATUS read latches "MCU alive" in the FPGA (reset-hold policy)
-    uint8_t status = 0;
+    uint8_t status = 0, cap = 0;
     a2spi_reg_read(A2REG_STATUS, &status);
+    a2spi_reg_read(A2REG_CAPABILITIES, &cap);
     fpga_link_unlock();
 
     s_ok = (id[0] == 'A' && id[1] == '2' && id[2] == 'F' && id[3] == 'P');
-    ESP_LOGI(TAG, "FPGA id %c%c%c%c status %02x -> %s",
-             id[0], id[1], id[2], id[3], status, s_ok ? "OK" : "NOT FOUND");
+    s_cap   = s_ok ? cap : 0;
+    s_burst = (s_cap & A2CAP_REG_WINDOW) != 0;
+    s_rd_pf = A2CAP_RD_PREFETCH_BYTES(s_cap);
+    bool crc = (s_cap & A2CAP_CRC) && a2spi_set_crc(true) == ESP_OK;
+    ESP_LOGI(TAG, "FPGA id %c%c%c%c status %02x cap %02x -> %s%s%s, read prefetch %d",
+             id[0], id[1], id[2], id[3], status, cap,
+             s_ok ? "OK" : "NOT FOUND", s_burst ? " (reg bursts)" : "",
+             crc ? " (XFER CRC)" : "", s_rd_pf);
     return s_ok;
 }
 
 bool fpga_link_ok(void) { return s_ok; }
 
+int fpga_link_rd_prefetch(void) { return s_rd_pf; }
+
+bool fpga_link_crc(void) { return a2spi_crc_enabled(); }
+
 uint8_t fpga_reg_read(uint8_t reg)
 {
     uint8_t v = 0;
@@ -56,60 +76,498 @@ void fpga_reg_write(uint8_t reg, uint8_t val)
 
 uint32_t fpga_reg_read32(uint8_t reg_base)
 {
-    uint32_t v = 0;
-    fpga_link_lock();
-    for (int i = 0; i < 4; i++) {
-        uint8_t b = 0;
-        a2spi_reg_read(reg_base + i, &b);
-        v |= ((uint32_t)b) << (8 * i);
-    }
-    fpga_link_unlock();
-    return v;
+    uint8_t b[4];
+    fpga_reg_read_burst(reg_base, b, sizeof(b));
+    return (uint32_t)b[0] | ((uint32_t)b[1] << 8) |
+           ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
 }
 
 void fpga_reg_write16(uint8_t reg_base, uint16_t val)
 {
+    uint8_t b[2] = { (uint8_t)val, (uint8_t)(val >> 8) };
+    fpga_reg_write_burst(reg_base, b, sizeof(b));
+}
+
+void fpga_reg_write32(uint8_t reg_base, uint32_t val)
+{
+    uint8_t b[4] = { (uint8_t)val, (uint8_t)(val >> 8),
+                     (uint8_t)(val >> 16), (uint8_t)(val >> 24) };
+    fpga_reg_write_burst(reg_base, b, sizeof(b));
+}
+
+// Per-register fallback for bitstreams without the register window.
+static bool reg_op_slow(const fpga_reg_op_t *op)
+{
+    bool ok = true;
+    for (int i = 0; i < op->n; i++) {
+        esp_err_t err = op->write ? a2spi_reg_write(op->reg + i, op->buf[i])
+                                  : a2spi_reg_read(op->reg + i, &op->buf[i]);
+        ok = ok && err == ESP_OK;
+    }
+    return ok;
+}
+
+bool fpga_reg_program(const fpga_reg_op_t *ops, int nops)
+{
+    if (nops <= 0 || nops > FPGA_REG_PROGRAM_MAX)
+        return false;
+
+    bool ok = true;
     fpga_link_lock();
-    a2spi_reg_write(reg_base, val & 0xFF);
-    a2spi_reg_write(reg_base + 1, (val >> 8) & 0xFF);
+    if (s_burst) {
+        ospi_reg_op_t o[FPGA_REG_PROGRAM_MAX];
+        for (int i = 0; i < nops; i++) {
+            o[i].write = ops[i].write;
+            o[i].reg   = ops[i].reg;
+            o[i].n     = ops[i].n;
+            o[i].buf   = ops[i].buf;
+        }
+        ok = a2spi_reg_program(o, (size_t)nops) == ESP_OK;
+    } else {
+        for (int i = 0; i < nops; i++)
+            ok = reg_op_slow(&ops[i]) && ok;
+    }
     fpga_link_unlock();
+
+    if (!ok) {
+        // 0-safe defaults, as fpga_reg_read()
+        for (int i = 0; i < nops; i++)
+            if (!ops[i].write)
+                memset(ops[i].buf, 0, ops[i].n);
+    }
+    return ok;
 }
 
-void fpga_reg_write32(uint8_t reg_base, uint32_t val)
+bool fpga_reg_read_burst(uint8_t reg, uint8_t *out, uint8_t n)
 {
+    fpga_reg_op_t op = { .write = false, .reg = reg, .n = n, .buf = out };
+    return fpga_reg_program(&op, 1);
+}
+
+bool fpga_reg_write_burst(uint8_t reg, const uint8_t *data, uint8_t n)
+{
+    fpga_reg_op_t op = { .write = true, .reg = reg, .n = n, .buf = (uint8_t *)data };
+    return fpga_reg_program(&op, 1);
+}
+
+// A CRC mismatch is the link, not the request: resend a few times before
+// giving up. That is only safe where a write is idempotent — a memory
+// window, which the resend overwrites. A register-window (SPACE 6) write
+// whose payload failed has still been applied, strobes (ACKs, FIFO pushes)
+// included, so it goes out once and a failure is the caller's to handle.
+static bool mem_xfer(bool wr, uint8_t space, uint32_t addr, uint8_t *buf, uint16_t len)
+{
+    fpga_xfer_stats_t *st = &s_xstat[space & 7];
+    int tries = (wr && space == A2SPACE_REGS) ? 1 : FPGA_MEM_RETRIES;
+    esp_err_t err = ESP_OK;
     fpga_link_lock();
-    for (int i = 0; i < 4; i++)
-        a2spi_reg_write(reg_base + i, (val >> (8 * i)) & 0xFF);
+    st->xfers++;
+    for (int attempt = 0; attempt < tries; attempt++) {
+        if (attempt)
+            st->retries++;
+        err = wr ? a2spi_xfer_write(space, addr, buf, len, true)
+                 : a2spi_xfer_read(space, addr, buf, len, true);
+        if (err != ESP_ERR_INVALID_CRC)
+            break;
+        st->crc_errors++;
+    }
+    if (err != ESP_OK)
+        st->failures++;
     fpga_link_unlock();
+    return err == ESP_OK;
 }
 
 bool fpga_mem_write(uint8_t space, uint32_t addr, const uint8_t *data, uint16_t len)
+{
+    return mem_xfer(true, space, addr, (uint8_t *)data, len);
+}
+
+bool fpga_mem_read(uint8_t space, uint32_t addr, uint8_t *out, uint16_t len)
+{
+    return mem_xfer(false, space, addr, out, len);
+}
+
+bool fpga_mem_write_async(uint8_t space, uint32_t addr, const uint8_t *data,
+                          uint16_t len, fpga_mem_done_t done, void *arg)
 {
     fpga_link_lock();
-    esp_err_t err = a2spi_xfer_write(space, addr, data, len, true);
+    s_xstat[FPGA_XFER_QUEUED].xfers++;
+    esp_err_t err = a2spi_xfer_write_async(space, addr, data, len, true, done, arg);
     fpga_link_unlock();
     return err == ESP_OK;
 }
 
-bool fpga_mem_read(uint8_t space, uint32_t addr, uint8_t *out, uint16_t len)
+bool fpga_reg_write_async(uint8_t reg, const uint8_t *val,
+                          fpga_mem_done_t done, void *arg)
 {
+    if (s_burst)
+        return fpga_mem_write_async(A2SPACE_REGS, reg, val, 1, done, arg);
     fpga_link_lock();
-    esp_err_t err = a2spi_xfer_read(space, addr, out, len, true);
+    bool ok = a2spi_reg_write(reg, *val) == ESP_OK;   // drains the queue first
+    fpga_link_unlock();
+    if (done)
+        done(arg, ok);
+    return ok;
+}
+
+bool fpga_mem_wait(void)
+{
+    fpga_link_lock();
+    esp_err_t err = a2spi_xfer_drain();
+    if (err == ESP_ERR_INVALID_CRC)
+        s_xstat[FPGA_XFER_QUEUED].crc_errors++;
+    else if (err != ESP_OK)
+        s_xstat[FPGA_XFER_QUEUED].failures++;
     fpga_link_unlock();
     return err == ESP_OK;
 }
 
-void fpga_pad_poll(fpga_pad_state_t *out)
+int fpga_mem_inflight(void)
+{
+    return a2spi_xfer_inflight();
+}
+
+void fpga_xfer_stats(int idx, fpga_xfer_stats_t *out)
+{
+    *out = s_xstat[idx];
+}
+
+void fpga_xfer_stats_reset(void)
+{
+    memset(s_xstat, 0, sizeof(s_xstat));
+}
+
+// ---------------------------------------------------------------------------
+// Link clock calibration
+// ---------------------------------------------------------------------------
+
+// Without the read prefetch, payload reads lose the race with SCLK long
+// before 20 MHz; the last two candidates are only worth trying with it.
+static const int k_cal_hz[] = {
+    2000000, 4000000, 5000000, 8000000, 10000000, 13333333, 16000000, 20000000,
+    26666666, 40000000,
+};
+#define CAL_NOPF_MAX_HZ 20000000
+
+static int cal_nclocks(void)
+{
+    int n = (int)(sizeof(k_cal_hz) / sizeof(k_cal_hz[0]));
+    while (!s_rd_pf && n > 1 && k_cal_hz[n - 1] > CAL_NOPF_MAX_HZ)
+        n--;
+    return n;
+}
+
+static const uint8_t k_scratch[] = {
+    A2REG_SCRATCH0, A2REG_SCRATCH1, A2REG_SCRATCH2, A2REG_SCRATCH3, A2REG_SCRATCH4,
+};
+
+#define CAL_ROUNDS 4
+#define CAL_BULK   4096
+
+static uint32_t cal_rand(uint32_t *x)
+{
+    *x ^= *x << 13; *x ^= *x >> 17; *x ^= *x << 5;
+    return *x;
+}
+
+// One clock step: the ID, a scratch-register pattern and, with a window to
+// spare (drive >= 0), a pseudo-random write/readback through it. Reads go
+// through the XFER CRC where it is on.
+static bool cal_verify(int drive, uint8_t *pat, uint8_t *back, uint32_t seed)
+{
+    uint8_t v;
+    bool ok = true;
+
+    for (int i = 0; i < 4 && ok; i++)
+        ok = a2spi_reg_read(A2REG_DEVICE_ID0 + i, &v) == ESP_OK && v == (uint8_t)"A2FP"[i];
+    for (int r = 0; r < CAL_ROUNDS && ok; r++) {
+        for (size_t i = 0; i < sizeof(k_scratch) && ok; i++) {
+            uint8_t p = (uint8_t)cal_rand(&seed);
+            ok = a2spi_reg_write(k_scratch[i], p) == ESP_OK &&
+                 a2spi_reg_read(k_scratch[i], &v) == ESP_OK && v == p;
+        }
+    }
+    if (drive < 0)
+        return ok;
+
+    uint32_t base = A2DISK_WINDOW(drive);
+    for (int r = 0; r < CAL_ROUNDS && ok; r++) {
+        for (int i = 0; i < CAL_BULK; i += 4) {
+            uint32_t x = cal_rand(&seed);
+            memcpy(pat + i, &x, 4);
+        }
+        ok = a2spi_xfer_write(A2SPACE_DISK, base, pat, CAL_BULK, true) == ESP_OK &&
+             a2spi_xfer_read(A2SPACE_DISK, base, back, CAL_BULK, true) == ESP_OK &&
+             memcmp(pat, back, CAL_BULK) == 0;
+    }
+    return ok;
+}
+
+// An idle drive's window (the Apple II writes into an active one itself),
+// saved at the current clock; -1 if neither drive is idle.
+static int cal_idle_window(uint8_t *save, uint16_t len)
+{
+    uint8_t v;
+    for (int d = 1; d >= 0; d--) {
+        if (a2spi_reg_read(A2REG_VOL_ACTIVE(d), &v) == ESP_OK && !(v & 1) &&
+            a2spi_xfer_read(A2SPACE_DISK, A2DISK_WINDOW(d), save, len, true) == ESP_OK)
+            return d;
+    }
+    return -1;
+}
+
+int fpga_link_calibrate(fpga_cal_step_t *steps, int *nsteps)
+{
+    int max = nsteps ? *nsteps : 0, n = 0;
+    int start = a2spi_clock_hz(), best = 0;
+    if (nsteps)
+        *nsteps = 0;
+    if (!s_ok)
+        return start;
+
+    uint8_t *buf = heap_caps_malloc(3 * CAL_BULK, MALLOC_CAP_DMA);
+    if (!buf) {
+        ESP_LOGW(TAG, "calibrate: no buffer");
+        return start;
+    }
+    uint8_t *save = buf, *pat = buf + CAL_BULK, *back = buf + 2 * CAL_BULK;
+
+    fpga_link_lock();
+    // Scratch registers and an idle drive's window, saved at the known-good
+    // clock
+    uint8_t keep[sizeof(k_scratch)];
+    for (size_t i = 0; i < sizeof(k_scratch); i++)
+        a2spi_reg_read(k_scratch[i], &keep[i]);
+    int drive = cal_idle_window(save, CAL_BULK);
+
+    uint32_t seed = (uint32_t)esp_timer_get_time() | 1;
+    for (int i = 0; i < cal_nclocks(); i++) {
+        bool pass = a2spi_set_clock(k_cal_hz[i]) == ESP_OK &&
+                    cal_verify(drive, pat, back, seed + (uint32_t)i);
+        if (n < max) {
+            steps[n].hz   = k_cal_hz[i];
+            steps[n].pass = pass;
+            n++;
+        }
+        if (!pass)
+            break;   // faster clocks only get worse
+        best = k_cal_hz[i];
+    }
+    if (!best || a2spi_set_clock(best) != ESP_OK || !cal_verify(drive, pat, back, seed)) {
+        ESP_LOGW(TAG, "calibrate: no verified clock, back to %d Hz", start);
+        best = start;
+        a2spi_set_clock(best);
+    }
+
+    for (size_t i = 0; i < sizeof(k_scratch); i++)
+        a2spi_reg_write(k_scratch[i], keep[i]);
+    if (drive >= 0)
+        a2spi_xfer_write(A2SPACE_DISK, A2DISK_WINDOW(drive), save, CAL_BULK, true);
+    fpga_link_unlock();
+
+    heap_caps_free(buf);
+    if (nsteps)
+        *nsteps = n;
+    ESP_LOGI(TAG, "link clock %d Hz", best);
+    return best;
+}
+
+int fpga_link_sweep(fpga_sweep_step_t *steps, int max, int reps)
 {
+    static const uint16_t k_len[2] = { A2DISK_TRACK_BYTES, 512 };
+    const uint16_t track = A2DISK_TRACK_BYTES;
+    if (!s_ok || reps <= 0)
+        return 0;
+
+    uint8_t *buf = heap_caps_malloc(3 * track, MALLOC_CAP_DMA);
+    if (!buf) {
+        ESP_LOGW(TAG, "sweep: no buffer");
+        return 0;
+    }
+    uint8_t *save = buf, *pat = buf + track, *back = buf + 2 * track;
+
     fpga_link_lock();
-    uint8_t st = 0, b0 = 0, b1 = 0;
-    a2spi_reg_read(A2REG_PAD_STATUS, &st);
-    a2spi_reg_read(A2REG_PAD_BTNS0, &b0);
-    a2spi_reg_read(A2REG_PAD_BTNS1, &b1);
+    int start = a2spi_clock_hz(), n = 0;
+    int drive = cal_idle_window(save, track);
+    if (drive < 0) {
+        fpga_link_unlock();
+        heap_caps_free(buf);
+        return -1;
+    }
+    uint32_t base = A2DISK_WINDOW(drive), seed = 0x2A5F00D1;
+    for (int i = 0; i < track; i++)
+        pat[i] = (uint8_t)cal_rand(&seed);
+    bool written = a2spi_xfer_write(A2SPACE_DISK, base, pat, track, true) == ESP_OK;
+
+    for (int i = 0; i < cal_nclocks() && written; i++) {
+        bool clk_ok = a2spi_set_clock(k_cal_hz[i]) == ESP_OK;
+        for (int s = 0; s < 2 && n < max; s++) {
+            fpga_sweep_step_t *st = &steps[n++];
+            memset(st, 0, sizeof(*st));
+            st->hz  = k_cal_hz[i];
+            st->len = k_len[s];
+            for (int r = 0; r < reps && clk_ok; r++) {
+                // block reads walk the track so every lane and offset is hit
+                uint32_t off = (k_len[s] == track) ? 0 : (uint32_t)(r * 512) % (track - 511);
+                int64_t t0 = esp_timer_get_time();
+                esp_err_t err = a2spi_xfer_read(A2SPACE_DISK, base + off, back, k_len[s], true);
+                st->us += (uint32_t)(esp_timer_get_time() - t0);
+                st->reads++;
+                if (err != ESP_OK || memcmp(back, pat + off, k_len[s]) != 0)
+                    st->bad++;
+            }
+        }
+    }
+
+    a2spi_set_clock(start);
+    a2spi_xfer_write(A2SPACE_DISK, base, save, track, true);
     fpga_link_unlock();
 
+    heap_caps_free(buf);
+    return n;
+}
+
+void fpga_pad_poll(fpga_pad_state_t *out)
+{
+    uint8_t r[3];   // PAD_STATUS, PAD_BTNS0, PAD_BTNS1 are consecutive
+    fpga_reg_read_burst(A2REG_PAD_STATUS, r, sizeof(r));
+    uint8_t st = r[0], b0 = r[1], b1 = r[2];
+
     out->present    = (st & 0x03) != A2PAD_TYPE_NONE;
     out->is_pad     = (st & 0x03) == A2PAD_TYPE_PAD;
     out->report_cnt = (st >> 4) & 0x0F;
     out->buttons    = (uint16_t)b0 | ((uint16_t)(b1 & 0x03) << 8);
 }
+
+// ---------------------------------------------------------------------------
+// Attention line
+// ---------------------------------------------------------------------------
+
+static int               s_attn_gpio = -1;
+static volatile bool     s_attn_on;
+static SemaphoreHandle_t s_attn_sem[FPGA_ATTN_NCLASS];
+static fpga_lat_hist_t   s_lat[FPGA_ATTN_NCLASS][2];   // [cls][attn]
+
+static const uint8_t k_attn_age_reg[FPGA_ATTN_NCLASS] = {
+    A2REG_ATTN_AGE_DISK, A2REG_ATTN_AGE_NET,
+};
+
+static void IRAM_ATTR attn_isr(void *arg)
+{
+    (void)arg;
+    BaseType_t woken = pdFALSE;
+    for (int c = 0; c < FPGA_ATTN_NCLASS; c++)
+        xSemaphoreGiveFromISR(s_attn_sem[c], &woken);
+    if (woken)
+        portYIELD_FROM_ISR();
+}
+
+bool fpga_attn_init(int gpio)
+{
+    if (gpio < 0 || !(s_cap & A2CAP_ATTN)) {
+        ESP_LOGI(TAG, "attention line %s: polling",
+                 gpio < 0 ? "not wired" : "not in bitstream");
+        return false;
+    }
+    if (s_attn_gpio < 0) {
+        for (int c = 0; c < FPGA_ATTN_NCLASS; c++)
+            s_attn_sem[c] = xSemaphoreCreateBinary();
+        gpio_config_t io = {
+            .pin_bit_mask = 1ULL << gpio,
+            .mode         = GPIO_MODE_INPUT,
+            .pull_up_en   = GPIO_PULLUP_ENABLE,
+            .pull_down_en = GPIO_PULLDOWN_DISABLE,
+            .intr_type    = GPIO_INTR_NEGEDGE,
+        };
+        gpio_config(&io);
+        esp_err_t err = gpio_install_isr_service(0);
+        if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {   // already installed is fine
+            ESP_LOGW(TAG, "gpio isr service: %s", esp_err_to_name(err));
+            return false;
+        }
+        gpio_isr_handler_add((gpio_num_t)gpio, attn_isr, NULL);
+        s_attn_gpio = gpio;
+    }
+    fpga_attn_set_enabled(true);
+    ESP_LOGI(TAG, "attention line on GPIO %d", gpio);
+    return true;
+}
+
+bool fpga_attn_available(void) { return s_attn_gpio >= 0; }
+bool fpga_attn_enabled(void)   { return s_attn_on; }
+
+void fpga_attn_set_enabled(bool on)
+{
+    if (s_attn_gpio < 0)
+        return;
+    // Mask 0 parks the line high, so a polling MCU sees no edges at all
+    fpga_reg_write(A2REG_ATTN_MASK, on ? (A2STAT_VOL_PENDING | A2STAT_HDD_PENDING |
+                                          A2STAT_U2_PENDING) : 0);
+    s_attn_on = on;
+}
+
+bool fpga_attn_pending(void)
+{
+    return !s_attn_on || gpio_get_level((gpio_num_t)s_attn_gpio) == 0;
+}
+
+static const uint8_t k_attn_cls_bits[FPGA_ATTN_NCLASS] = {
+    A2STAT_VOL_PENDING | A2STAT_HDD_PENDING, A2STAT_U2_PENDING,
+};
+
+void fpga_attn_wait(int cls, uint32_t timeout_ms)
+{
+    TickType_t t = pdMS_TO_TICKS(timeout_ms);
+    if (t == 0)
+        t = 1;
+    if (!s_attn_on) {
+        vTaskDelay(t);
+        return;
+    }
+    // The ISR only sees the high->low edge: a class raised while another
+    // still holds the line low produces none. So when the line is already
+    // low on the way to sleep, read STATUS and wake each class that has a
+    // request pending (ours included) instead of leaving it to its timeout.
+    if (gpio_get_level((gpio_num_t)s_attn_gpio) == 0) {
+        uint8_t st = fpga_reg_read(A2REG_STATUS);
+        for (int c = 0; c < FPGA_ATTN_NCLASS; c++)
+            if (st & k_attn_cls_bits[c])
+                xSemaphoreGive(s_attn_sem[c]);
+    }
+    xSemaphoreTake(s_attn_sem[cls], t);
+}
+
+uint8_t fpga_attn_status(int cls, uint32_t *age_us)
+{
+    // STATUS alone on an idle poll (every poll, when polling): the age is
+    // only worth a second read once the class has a request to time.
+    uint8_t age[2] = {0, 0};
+    uint8_t st = fpga_reg_read(A2REG_STATUS);
+    if ((s_cap & A2CAP_ATTN) && (st & k_attn_cls_bits[cls]))
+        fpga_reg_read_burst(k_attn_age_reg[cls], age, sizeof(age));
+    *age_us = (uint32_t)age[0] | ((uint32_t)age[1] << 8);
+    return st;
+}
+
+void fpga_lat_record(int cls, uint32_t us)
+{
+    fpga_lat_hist_t *h = &s_lat[cls][s_attn_on ? 1 : 0];
+    int b = 0;
+    while (b < FPGA_LAT_BINS - 1 && us >= (64u << b))
+        b++;
+    h->bin[b]++;
+    h->count++;
+    h->sum_us += us;
+    if (us > h->max_us)
+        h->max_us = us;
+}
+
+void fpga_lat_get(int cls, bool attn, fpga_lat_hist_t *out)
+{
+    *out = s_lat[cls][attn ? 1 : 0];
+}
+
+void fpga_lat_reset(void)
+{
+    memset(s_lat, 0, sizeof(s_lat));
+}
@@ -18,6 +18,14 @@ extern "C" {
 bool fpga_link_init(void);
 bool fpga_link_ok(void);
 
+// XFER read prefetch depth in bytes (CAPABILITIES[7:5]; 0 on a bitstream
+// without it, where payload reads fail well below the register path's clock)
+int fpga_link_rd_prefetch(void);
+
+// XFER CRC in use: writes are only known good once checked (synchronously,
+// or in fpga_mem_wait() for queued ones)
+bool fpga_link_crc(void);
+
 // Locked register access (returns 0 / 0xFF-safe defaults on link errors)
 uint8_t fpga_reg_read(uint8_t reg);
 void    fpga_reg_write(uint8_t reg, uint8_t val);
@@ -25,14 +33,133 @@ uint32_t fpga_reg_read32(uint8_t reg_base);   // 4 consecutive regs, LE
 void    fpga_reg_write16(uint8_t reg_base, uint16_t val);
 void    fpga_reg_write32(uint8_t reg_base, uint32_t val);
 
-// Locked XFER access (auto-increment)
+// Burst register access: n consecutive registers from reg in one framed
+// transaction (XFER SPACE 6 register window), or per register on a bitstream
+// without it. Reads are zero-filled on link errors. reg + n <= 127.
+bool fpga_reg_read_burst(uint8_t reg, uint8_t *out, uint8_t n);
+bool fpga_reg_write_burst(uint8_t reg, const uint8_t *data, uint8_t n);
+
+// Register program: a short list of bursts run under one lock with the bus
+// held throughout (one wake byte, no per-op setup). Use it for a poll that
+// needs several register runs at once.
+#define FPGA_REG_PROGRAM_MAX 8
+typedef struct {
+    bool     write;   // false: registers -> buf, true: buf -> registers
+    uint8_t  reg;     // first register
+    uint8_t  n;       // consecutive registers
+    uint8_t *buf;
+} fpga_reg_op_t;
+bool fpga_reg_program(const fpga_reg_op_t *ops, int nops);
+
+// Locked XFER access (auto-increment). len up to FPGA_MEM_MAX: a whole
+// Disk II track is one transfer.
+#define FPGA_MEM_MAX 8192
 bool fpga_mem_write(uint8_t space, uint32_t addr, const uint8_t *data, uint16_t len);
 bool fpga_mem_read(uint8_t space, uint32_t addr, uint8_t *out, uint16_t len);
 
+// Queued write: returns once header and payload are queued for DMA, so the
+// caller can prepare the next buffer meanwhile. data must stay untouched
+// until done(arg, ok) runs (done may be NULL). Completions run in whichever
+// task next touches the link, so done must not use the link itself. Any
+// later link access, fpga_mem_wait() included, is ordered after the write.
+typedef void (*fpga_mem_done_t)(void *arg, bool ok);
+bool fpga_mem_write_async(uint8_t space, uint32_t addr, const uint8_t *data,
+                          uint16_t len, fpga_mem_done_t done, void *arg);
+bool fpga_mem_wait(void);        // all queued writes done; false on any error
+int  fpga_mem_inflight(void);
+
+// Link error accounting. Synchronous XFERs whose CRC fails are resent up to
+// FPGA_MEM_RETRIES times in all, except SPACE 6 (register window) writes,
+// which may have fired side effects and are sent once; stats are kept per
+// space, plus one bucket for queued writes (a CRC failure there shows up in
+// fpga_mem_wait(), and the caller resends its memory-window data — never a
+// queued register write).
+#define FPGA_MEM_RETRIES 3
+#define FPGA_XFER_QUEUED 8
+#define FPGA_XFER_NSTAT  9
+typedef struct {
+    uint32_t xfers;
+    uint32_t crc_errors;
+    uint32_t retries;
+    uint32_t failures;    // gave up (or a non-CRC link error)
+} fpga_xfer_stats_t;
+void fpga_xfer_stats(int idx, fpga_xfer_stats_t *out);   // space 0-7 or FPGA_XFER_QUEUED
+void fpga_xfer_stats_reset(void);
+
+// Step the link clock up through the candidates until a pattern test fails
+// and keep the fastest clock that passed (the starting clock if none did).
+// The candidates above 20 MHz are only tried with the read prefetch. The
+// test uses the ID and scratch registers and the window of an idle drive,
+// all restored afterwards. steps (up to *nsteps entries, may be NULL)
+// receives each clock tried; returns the clock in use.
+typedef struct {
+    int  hz;
+    bool pass;
+} fpga_cal_step_t;
+int fpga_link_calibrate(fpga_cal_step_t *steps, int *nsteps);
+
+// Read sweep: at every calibration clock (none skipped, failures included),
+// reps track-sized (6656-byte) and block-sized (512-byte) XFER reads of a
+// pattern in an idle drive's window, without retries. The window and the
+// link clock are restored afterwards. Returns the steps filled (two per
+// clock, up to max), or -1 with no idle drive window to test in.
+typedef struct {
+    int      hz;
+    uint16_t len;
+    uint32_t reads;
+    uint32_t bad;       // CRC failures, link errors or data mismatches
+    uint32_t us;        // total time of the reads
+} fpga_sweep_step_t;
+int fpga_link_sweep(fpga_sweep_step_t *steps, int max, int reps);
+
+// Register write queued behind earlier fpga_mem_write_async() calls (through
+// the SPACE 6 register window; synchronous on a bitstream without it). *val
+// must stay valid until done runs.
+bool fpga_reg_write_async(uint8_t reg, const uint8_t *val,
+                          fpga_mem_done_t done, void *arg);
+
 // Hold the lock across a compound sequence (recursive)
 void fpga_link_lock(void);
 void fpga_link_unlock(void);
 
+// ---------------------------------------------------------------------------
+// Attention line (FPGA -> MCU on the unused OSPI CS pin)
+// ---------------------------------------------------------------------------
+// The FPGA holds the line low while a floppy/HDD request or W5100 doorbell is
+// pending. Service tasks sleep in fpga_attn_wait() (woken by the falling
+// edge, or at once if the line is already low and STATUS shows a request
+// of their class) and touch the link only when fpga_attn_pending() says so.
+// Polling stays as the fallback: an old bitstream, no GPIO (PIN_FPGA_ATTN
+// -1, the default until the net is verified), or attention switched off
+// makes fpga_attn_pending() always true and fpga_attn_wait() a plain delay,
+// i.e. the previous fixed-cadence loop.
+enum { FPGA_ATTN_DISK, FPGA_ATTN_NET, FPGA_ATTN_NCLASS };
+
+bool fpga_attn_init(int gpio);     // after fpga_link_init(); false -> polling
+bool fpga_attn_available(void);
+void fpga_attn_set_enabled(bool on);
+bool fpga_attn_enabled(void);
+bool fpga_attn_pending(void);      // link worth polling now
+void fpga_attn_wait(int cls, uint32_t timeout_ms);
+
+// STATUS, and the class's request age in us (FPGA-side) when STATUS shows
+// one pending; 0 otherwise or without the attention registers.
+uint8_t fpga_attn_status(int cls, uint32_t *age_us);
+
+// Request-to-ack latency, one histogram per class and mode. Bin i counts
+// latencies below 64 << i us; the last bin is open-ended.
+#define FPGA_LAT_BINS 10
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t bin[FPGA_LAT_BINS];
+} fpga_lat_hist_t;
+
+void fpga_lat_record(int cls, uint32_t us);   // into the current mode
+void fpga_lat_get(int cls, bool attn, fpga_lat_hist_t *out);
+void fpga_lat_reset(void);
+
 // ---------------------------------------------------------------------------
 // Gamepad state (polled from the FPGA usb_hid_host readback regs)
 // ---------------------------------------------------------------------------
@@ -14,11 +14,32 @@
  *     unlike the BL616 v1 (cursor wrapped to the top), a newline past the
  *     bottom row scrolls the page up one line.
  *
+ * Rendering is damage-tracked. Drawing only touches the shadow (the back
+ * buffer, in screen rows) and widens a per-row dirty column span. A flush
+ * compares each dirty span against s_front — a mirror of what the FPGA page
+ * holds, in page rows — trims it to the bytes that really changed, and sends
+ * the survivors as span XFERs, merging spans separated by a few unchanged
+ * bytes. So a menu repaint (clear + reprint of mostly the same text) costs
+ * only the characters that differ.
+ *
+ * Scrolling uses the overlay's row offset (A2REG_OSD_SCROLL) when the core
+ * has it (A2CAP_OSD_SCROLL): the page stays put, screen row r shows page row
+ * (r + offset) % 24, and a scroll costs one register write plus the new
+ * bottom row. Older cores fall back to the diff, which resends every row.
+ *
+ * Outside a frame every drawing call flushes before returning. Between
+ * fpga_screen_begin() and fpga_screen_end() nothing is sent until the end.
+ * The screen state has its own (recursive) lock, held for a frame; the link
+ * lock is only taken by the flush, to send, so painting a frame never holds
+ * up the disk or network tasks.
+ *
  * Characters are stored as Apple II screen codes: ASCII + 128 for normal
  * text, $00-$3F for inverse (uppercase + symbols only).
  */
 
 #include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "fpga_screen.h"
 #include "fpga_link.h"
 
@@ -26,7 +47,22 @@
 #define SCREEN_H  FPGA_SCREEN_H
 #define OSD_SIZE  (SCREEN_W * SCREEN_H)          /* 960 bytes */
 
-static uint8_t s_shadow[OSD_SIZE];               /* local copy (space is WO) */
+/* Unchanged bytes worth resending to save a second XFER header */
+#define SPAN_MERGE_GAP 8
+
+static uint8_t s_shadow[OSD_SIZE];               /* back buffer, screen rows */
+static uint8_t s_front[OSD_SIZE];                /* FPGA page, page rows */
+static uint8_t s_dirty_lo[SCREEN_H];             /* dirty columns [lo, hi) */
+static uint8_t s_dirty_hi[SCREEN_H];
+static bool    s_front_valid;                    /* s_front matches the FPGA */
+static bool    s_hw_scroll;                      /* core has A2REG_OSD_SCROLL */
+static bool    s_hw_scroll_allow = true;
+static int     s_scroll;                         /* page row at screen row 0 */
+static int     s_front_scroll;
+static int     s_frame;                          /* begin/end nesting */
+static SemaphoreHandle_t s_lock;                 /* screen state (recursive) */
+static fpga_screen_stats_t s_stats;
+
 static int cursor_h = 0;
 static int cursor_v = 0;
 /* VT100-style deferred wrap: filling the last column arms this flag instead
@@ -58,21 +94,206 @@ static uint32_t screen_addr(int x, int y)
     return (uint32_t)(y * SCREEN_W + x);
 }
 
+static uint32_t page_addr(int x, int y)
+{
+    return screen_addr(x, (y + s_scroll) % SCREEN_H);
+}
+
+/* The first screen call runs single-threaded at boot (the startup banner),
+ * so creating the mutex lazily is race-free in practice. */
+static void screen_lock(void)
+{
+    if (!s_lock)
+        s_lock = xSemaphoreCreateRecursiveMutex();
+    xSemaphoreTakeRecursive(s_lock, portMAX_DELAY);
+}
+
+static void screen_unlock(void)
+{
+    xSemaphoreGiveRecursive(s_lock);
+}
+
+static void mark(int y, int x0, int x1)
+{
+    if (s_dirty_lo[y] >= s_dirty_hi[y]) {
+        s_dirty_lo[y] = (uint8_t)x0;
+        s_dirty_hi[y] = (uint8_t)x1;
+        return;
+    }
+    if (x0 < s_dirty_lo[y]) s_dirty_lo[y] = (uint8_t)x0;
+    if (x1 > s_dirty_hi[y]) s_dirty_hi[y] = (uint8_t)x1;
+}
+
+static void mark_all(void)
+{
+    memset(s_dirty_lo, 0, sizeof(s_dirty_lo));
+    memset(s_dirty_hi, SCREEN_W, sizeof(s_dirty_hi));
+}
+
+static bool send_span(uint32_t addr, uint32_t len)
+{
+    s_stats.xfers++;
+    s_stats.bytes += len;
+    return fpga_mem_write(A2SPACE_OSD, addr, &s_front[addr], (uint16_t)len);
+}
+
+/* Two phases, never both locks at once (the CLI draws with the link lock
+ * held, the menu reads the link inside a frame): under the screen lock, trim
+ * the damage against the front copy, update it and list the page runs to
+ * send; then, under the link lock, send them from the front copy. A flush
+ * that overtakes another on the link sends whatever the front holds by then,
+ * so the page always ends up at the newest state. */
+void fpga_screen_flush(void)
+{
+    struct { uint16_t addr, len; } run[SCREEN_H];   /* <= one per row */
+    int  nrun = 0;
+    bool scroll, ok = true;
+
+    if (!fpga_link_ok())                    /* keep the damage for later */
+        return;
+    uint8_t caps = s_front_valid ? 0 : fpga_reg_read(A2REG_CAPABILITIES);
+
+    screen_lock();
+    if (!s_front_valid) {
+        /* First flush (or after an error): the page and the offset are
+         * unknown, so send both whole. */
+        s_hw_scroll = s_hw_scroll_allow && (caps & A2CAP_OSD_SCROLL) != 0;
+        if (!s_hw_scroll)
+            s_scroll = 0;                   /* no offset: page row = screen row */
+        s_front_scroll = -1;
+        memset(s_front, 0, sizeof(s_front));
+        mark_all();
+    }
+
+    /* Trim each row's span against the front copy, update the front, and
+     * list runs of the front that cover the changed bytes. */
+    uint32_t run_lo = 0, run_hi = 0;        /* pending page range [lo, hi) */
+    for (int y = 0; y < SCREEN_H; y++) {
+        int lo = s_dirty_lo[y], hi = s_dirty_hi[y];
+        s_dirty_lo[y] = s_dirty_hi[y] = 0;
+        if (lo >= hi)
+            continue;
+
+        const uint8_t *src = &s_shadow[screen_addr(0, y)];
+        uint8_t *dst = &s_front[page_addr(0, y)];
+        if (s_front_valid) {
+            while (lo < hi && src[lo] == dst[lo]) lo++;
+            while (hi > lo && src[hi - 1] == dst[hi - 1]) hi--;
+            if (lo >= hi)
+                continue;
+        }
+        memcpy(dst + lo, src + lo, (size_t)(hi - lo));
+
+        uint32_t a0 = page_addr(lo, y), a1 = a0 + (uint32_t)(hi - lo);
+        if (run_hi > run_lo && a0 >= run_hi && a0 - run_hi <= SPAN_MERGE_GAP) {
+            run_hi = a1;
+            continue;
+        }
+        if (run_hi > run_lo) {
+            run[nrun].addr = (uint16_t)run_lo;
+            run[nrun++].len = (uint16_t)(run_hi - run_lo);
+        }
+        run_lo = a0;
+        run_hi = a1;
+    }
+    if (run_hi > run_lo) {
+        run[nrun].addr = (uint16_t)run_lo;
+        run[nrun++].len = (uint16_t)(run_hi - run_lo);
+    }
+    scroll = s_hw_scroll && s_scroll != s_front_scroll;
+    s_front_scroll = s_scroll;
+    s_front_valid = true;
+    screen_unlock();
+
+    fpga_link_lock();
+    for (int i = 0; i < nrun; i++)
+        ok &= send_span(run[i].addr, run[i].len);
+    /* The offset goes last, once the rows it brings into view hold their
+     * new text: moving it first would show the stale rows for the length of
+     * the span XFERs. The value is read now, for the same reason as above. */
+    if (ok && scroll) {
+        fpga_reg_write(A2REG_OSD_SCROLL, (uint8_t)s_front_scroll);
+        s_stats.scrolls++;
+    }
+    fpga_link_unlock();
+
+    /* A lost write leaves the FPGA page unknown: resend it all next time. */
+    if (!ok) {
+        screen_lock();
+        s_front_valid = false;
+        screen_unlock();
+    }
+}
+
+/* Drawing calls take the screen lock for their update and flush after
+ * releasing it, unless a frame is open. */
+static void drawn(bool framed)
+{
+    if (!framed)
+        fpga_screen_flush();
+}
+
+void fpga_screen_begin(void)
+{
+    screen_lock();
+    s_frame++;
+}
+
+void fpga_screen_end(void)
+{
+    bool last = s_frame > 0 && --s_frame == 0;
+    screen_unlock();
+    if (last)
+        fpga_screen_flush();
+}
+
+void fpga_screen_set_hw_scroll(bool on)
+{
+    screen_lock();
+    s_hw_scroll_allow = on;
+    s_front_valid = false;            /* re-detect and resend on next flush */
+    screen_unlock();
+}
+
+void fpga_screen_stats(fpga_screen_stats_t *out)
+{
+    *out = s_stats;
+}
+
+void fpga_screen_stats_reset(void)
+{
+    memset(&s_stats, 0, sizeof(s_stats));
+}
+
 void fpga_screen_clear(void)
 {
+    screen_lock();
     memset(s_shadow, 0xA0, OSD_SIZE);
-    fpga_mem_write(A2SPACE_OSD, 0, s_shadow, OSD_SIZE);
+    mark_all();
     wrap_pending = false;
     cursor_h = 0;
     cursor_v = 0;
+    bool framed = s_frame > 0;
+    screen_unlock();
+    drawn(framed);
 }
 
-/* Scroll the page up one line (shadow + full-page repaint). */
+/* Scroll the screen up one line. With the row offset the page rows stay
+ * where they are and only the new bottom row differs; without it every row
+ * is dirty and the flush resends whatever changed. */
 static void scroll_up(void)
 {
     memmove(s_shadow, s_shadow + SCREEN_W, OSD_SIZE - SCREEN_W);
     memset(s_shadow + OSD_SIZE - SCREEN_W, 0xA0, SCREEN_W);
-    fpga_mem_write(A2SPACE_OSD, 0, s_shadow, OSD_SIZE);
+    if (s_hw_scroll && s_front_valid) {
+        memmove(s_dirty_lo, s_dirty_lo + 1, SCREEN_H - 1);
+        memmove(s_dirty_hi, s_dirty_hi + 1, SCREEN_H - 1);
+        s_scroll = (s_scroll + 1) % SCREEN_H;
+        s_dirty_lo[SCREEN_H - 1] = 0;
+        s_dirty_hi[SCREEN_H - 1] = SCREEN_W;
+    } else {
+        mark_all();
+    }
 }
 
 static void newline(void)
@@ -86,29 +307,13 @@ static void newline(void)
     }
 }
 
-/* Flush a run of characters (already placed in the shadow) as one
- * contiguous XFER write. */
-static void flush_line(int start_h, int start_v, int nchars)
-{
-    if (nchars > 0) {
-        uint32_t addr = screen_addr(start_h, start_v);
-        fpga_mem_write(A2SPACE_OSD, addr, &s_shadow[addr], (uint16_t)nchars);
-    }
-}
-
-void fpga_screen_putchar(uint8_t c)
+/* Place one printable character at the cursor (shadow + damage only). */
+static void place(uint8_t c)
 {
-    if (c == '\n') {
-        newline();
-        return;
-    }
-    if (c < 32) return;
-
     if (wrap_pending) newline();
 
-    uint32_t addr = screen_addr(cursor_h, cursor_v);
-    s_shadow[addr] = screen_code(c);
-    fpga_mem_write(A2SPACE_OSD, addr, &s_shadow[addr], 1);
+    s_shadow[screen_addr(cursor_h, cursor_v)] = screen_code(c);
+    mark(cursor_v, cursor_h, cursor_h + 1);
 
     cursor_h++;
     if (cursor_h >= SCREEN_W) {
@@ -117,49 +322,31 @@ void fpga_screen_putchar(uint8_t c)
     }
 }
 
-void fpga_screen_puts(const char *str)
+void fpga_screen_putchar(uint8_t c)
 {
-    /* Place characters into the shadow, flushing one contiguous XFER write
-     * per screen-line segment. */
-    int count = 0;
-    int start_h = cursor_h;
-    int start_v = cursor_v;
+    screen_lock();
+    if (c == '\n')
+        newline();
+    else if (c >= 32)
+        place(c);
+    bool framed = s_frame > 0;
+    screen_unlock();
+    drawn(framed);
+}
 
+void fpga_screen_puts(const char *str)
+{
+    screen_lock();
     while (*str) {
         uint8_t c = (uint8_t)*str++;
-
-        if (c == '\n' || c < 32) {
-            flush_line(start_h, start_v, count);
-            count = 0;
-            if (c == '\n') newline();
-            start_h = cursor_h;
-            start_v = cursor_v;
-            continue;
-        }
-
-        if (wrap_pending) {
-            flush_line(start_h, start_v, count);
-            count = 0;
+        if (c == '\n')
             newline();
-            start_h = cursor_h;
-            start_v = cursor_v;
-        }
-
-        s_shadow[screen_addr(cursor_h, cursor_v)] = screen_code(c);
-        count++;
-
-        cursor_h++;
-        if (cursor_h >= SCREEN_W) {
-            flush_line(start_h, start_v, count);
-            count = 0;
-            cursor_h = SCREEN_W - 1;
-            wrap_pending = true;
-            start_h = cursor_h;
-            start_v = cursor_v;
-        }
+        else if (c >= 32)
+            place(c);
     }
-
-    flush_line(start_h, start_v, count);
+    bool framed = s_frame > 0;
+    screen_unlock();
+    drawn(framed);
 }
 
 void fpga_screen_home(void)
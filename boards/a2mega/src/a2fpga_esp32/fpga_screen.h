@@ -3,7 +3,8 @@
  *
  * a2mega version: the OSD text page is a LINEAR 40x24 array of Apple II
  * screen codes at offset y*40+x in XFER space A2SPACE_OSD (rendered by
- * osd_text_overlay.sv). Same public API as the a2n20v2-Enhanced version.
+ * osd_text_overlay.sv). Same public API as the a2n20v2-Enhanced version,
+ * plus frames and traffic counters (see fpga_screen.c for the renderer).
  */
 
 #ifndef _FPGA_SCREEN_H
@@ -38,6 +39,33 @@ void fpga_screen_goto(int x, int y);
  * $00-$3F). Lowercase is uppercased; only uppercase/digits/symbols render. */
 void fpga_screen_set_inverse(bool inverse);
 
+/* Frames: drawing between begin() and end() only updates the local back
+ * buffer; end() sends the changed spans in one go. Outside a frame every
+ * clear/putchar/puts flushes on return. begin() takes the screen lock and
+ * end() releases it, so a frame is atomic against other screen users; the
+ * link lock is held only while the flush sends. Frames nest. Keep link
+ * access out of a frame: a task that holds the link lock may be waiting to
+ * draw. */
+void fpga_screen_begin(void);
+void fpga_screen_end(void);
+
+/* Send pending changes now (called by end() and by unframed drawing). */
+void fpga_screen_flush(void);
+
+/* OSD link traffic since boot or the last reset */
+typedef struct {
+    uint32_t bytes;     /* text page bytes written */
+    uint32_t xfers;     /* span XFERs */
+    uint32_t scrolls;   /* row offset register writes */
+} fpga_screen_stats_t;
+
+void fpga_screen_stats(fpga_screen_stats_t *out);
+void fpga_screen_stats_reset(void);
+
+/* Use the row offset register for scrolling when the core has it (default
+ * on). Off forces the rewrite fallback, for comparing the two. */
+void fpga_screen_set_hw_scroll(bool on);
+
 #ifdef __cplusplus
 }
 #endif
@@ -9,12 +9,24 @@
  * the screen and Apple II are down for the whole write. The menu paints a
  * full-screen warning first.
  *
+ * Modes (fpgaupdate_set_mode):
+ *  - DIFF (default): CRC-32 every 64 KB block of the image and of the
+ *    flash, then erase and program only the blocks that differ. A rebuild
+ *    usually touches a handful of blocks, so the dark time is mostly the
+ *    hash pass instead of a full erase + program.
+ *  - FULL: write every block regardless.
+ *  - SRAM: configure the FPGA over JTAG straight from the file and leave
+ *    the flash alone; the next power cycle boots the old image. For
+ *    iterating on a bitstream.
+ * Each phase is timed (fpgaupdate_timings) and reported before restart.
+ *
  * Safety properties (ported from the a2n20v2-Enhanced BL616 updater):
  *  - CHECK phase validates the file BEFORE anything is touched: Gowin A5C3
  *    sync word near the start, embedded IDCODE == GW5AT-60 (0x0001481B),
  *    and a live JTAG IDCODE probe of the FPGA itself.
- *  - Every page is read back and compared immediately after programming,
- *    with one retry (a persistent mismatch aborts).
+ *  - Every written 64 KB block is read back once and its CRC-32 compared
+ *    with the image's, with one erase + program retry (a persistent
+ *    mismatch aborts).
  *  - On success: JTAG RELOAD boots the new bitstream, then the ESP32
  *    restarts itself for a clean bring-up.
  *  - An interrupted/failed write leaves the FPGA unconfigured but the ESP32
@@ -29,8 +41,10 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 #include "esp_log.h"
 
+#include "crc32.h"          /* per-block image/flash verify */
 #include "osd_console.h"
 #include "fpga_jtag.h"
 #include "fpgaupdate.h"
@@ -42,6 +56,8 @@ static const char *TAG = "fpgaupd";
 #define FPU_PAGE       256u
 #define FPU_BLOCK      65536u
 #define FPU_HDR_SCAN   4096u   /* window searched for sync word + IDCODE */
+#define FPU_CHUNK      4096u   /* file/flash streaming unit */
+#define FPU_MAX_BLOCKS (FPU_MAX_SIZE / FPU_BLOCK)
 
 static volatile fpu_state_t s_state = FPU_IDLE;
 static bool     s_keepsram = false;
@@ -49,8 +65,13 @@ static char     s_path[160];
 static char     s_msg[41];
 static uint32_t s_size;
 static bool     s_dirty = true;
-static uint8_t  s_page[FPU_PAGE];
-static uint8_t  s_back[FPU_PAGE];
+static fpu_mode_t s_mode = FPU_MODE_DIFF;
+static fpu_timings_t s_times;
+static void   (*s_report)(const char *line);
+static uint8_t  s_buf[FPU_CHUNK];
+static uint8_t  s_back[FPU_CHUNK];
+static uint32_t s_crc[FPU_MAX_BLOCKS];   /* image CRC-32 per 64 KB block */
+static bool     s_todo[FPU_MAX_BLOCKS];  /* block differs from the flash */
 
 static void set_msg(const char *fmt, ...)
 {
@@ -107,6 +128,91 @@ static bool flash_program_page(uint32_t addr, const uint8_t *data, uint32_t n)
     return flash_wait_busy(4000);        /* page program: ~0.7 ms typ */
 }
 
+/* Image bytes in block b (the last block is usually partial). */
+static uint32_t block_len(uint32_t b)
+{
+    uint32_t left = s_size - b * FPU_BLOCK;
+    return left < FPU_BLOCK ? left : FPU_BLOCK;
+}
+
+static uint32_t flash_block_crc(uint32_t addr, uint32_t n)
+{
+    uint32_t crc = 0;
+    while (n) {
+        uint32_t c = n < FPU_CHUNK ? n : FPU_CHUNK;
+        fpga_jtag_flash_read(addr, s_back, c);
+        crc = crc32_update(crc, s_back, c);
+        addr += c;
+        n -= c;
+    }
+    return crc;
+}
+
+static bool file_block_crc(FILE *f, uint32_t b, uint32_t *out)
+{
+    uint32_t n = block_len(b), crc = 0;
+    if (fseek(f, (long)(b * FPU_BLOCK), SEEK_SET) != 0)
+        return false;
+    while (n) {
+        uint32_t c = n < FPU_CHUNK ? n : FPU_CHUNK;
+        if (fread(s_buf, 1, c, f) != c)
+            return false;
+        crc = crc32_update(crc, s_buf, c);
+        n -= c;
+    }
+    *out = crc;
+    return true;
+}
+
+/* Program block b (already erased) from the file, page by page. */
+static bool program_block(FILE *f, uint32_t b)
+{
+    uint32_t addr = b * FPU_BLOCK, n = block_len(b);
+    if (fseek(f, (long)addr, SEEK_SET) != 0)
+        return false;
+    while (n) {
+        uint32_t c = n < FPU_CHUNK ? n : FPU_CHUNK;
+        if (fread(s_buf, 1, c, f) != c)
+            return false;
+        for (uint32_t o = 0; o < c; o += FPU_PAGE) {
+            uint32_t pn = c - o < FPU_PAGE ? c - o : FPU_PAGE;
+            if (!flash_program_page(addr + o, s_buf + o, pn))
+                return false;
+        }
+        addr += c;
+        n -= c;
+    }
+    vTaskDelay(1);                       /* feed the watchdog */
+    return true;
+}
+
+static uint32_t ms_since(int64_t t0)
+{
+    return (uint32_t)((esp_timer_get_time() - t0) / 1000);
+}
+
+static void report_timings(void)
+{
+    const fpu_timings_t *t = &s_times;
+    char line[120];
+    if (s_mode == FPU_MODE_SRAM)
+        snprintf(line, sizeof(line),
+                 "check %lu ms, enter %lu ms, load %lu ms (SRAM only)",
+                 (unsigned long)t->check_ms, (unsigned long)t->enter_ms,
+                 (unsigned long)t->load_ms);
+    else
+        snprintf(line, sizeof(line),
+                 "check %lu, enter %lu, hash %lu, erase %lu, program %lu, "
+                 "verify %lu, reload %lu ms; %u/%u blocks written, %u retried",
+                 (unsigned long)t->check_ms, (unsigned long)t->enter_ms,
+                 (unsigned long)t->hash_ms, (unsigned long)t->erase_ms,
+                 (unsigned long)t->program_ms, (unsigned long)t->verify_ms,
+                 (unsigned long)t->load_ms, t->changed, t->blocks, t->retried);
+    ESP_LOGI(TAG, "%s", line);
+    if (s_report)
+        s_report(line);
+}
+
 /* ---- public API ---------------------------------------------------------- */
 bool fpgaupdate_request(const char *path)
 {
@@ -136,6 +242,21 @@ void fpgaupdate_set_keepsram(bool on)
     s_keepsram = on;
 }
 
+void fpgaupdate_set_mode(fpu_mode_t mode)
+{
+    s_mode = mode;
+}
+
+void fpgaupdate_set_report(void (*fn)(const char *line))
+{
+    s_report = fn;
+}
+
+void fpgaupdate_timings(fpu_timings_t *out)
+{
+    *out = s_times;
+}
+
 void fpgaupdate_cancel(void)
 {
     if (s_state == FPU_READY || s_state == FPU_ERROR) {
@@ -159,6 +280,8 @@ bool fpgaupdate_dirty(void)
 /* ---- state machine ------------------------------------------------------- */
 static bool check_file(void)
 {
+    memset(&s_times, 0, sizeof(s_times));
+    int64_t t0 = esp_timer_get_time();
     FILE *f = fopen(s_path, "rb");
     if (!f) {
         fail("CANNOT OPEN FILE");
@@ -209,12 +332,132 @@ static bool check_file(void)
         fail("BITSTREAM IS FOR ANOTHER FPGA");
         return false;
     }
+    s_times.check_ms = ms_since(t0);
     s_state = FPU_READY;
     set_msg("READY: %lu BYTES", (unsigned long)s_size);
     osd_log("FPGA: VERIFIED %lu BYTES", (unsigned long)s_size);
     return true;
 }
 
+/* ---- install ------------------------------------------------------------ */
+
+/* Load the file into the FPGA SRAM only. The flash keeps the old image, so
+ * a power cycle (or a failed load) goes back to it. */
+static bool install_sram(FILE *f)
+{
+    int64_t t0 = esp_timer_get_time();
+    if (!fpga_jtag_sram_begin()) {
+        fpga_jtag_reload();
+        fail("SRAM ERASE FAILED");
+        return false;
+    }
+    s_times.enter_ms = ms_since(t0);
+
+    t0 = esp_timer_get_time();
+    uint32_t pos = 0;
+    size_t br;
+    while (pos < s_size && (br = fread(s_buf, 1, sizeof(s_buf), f)) > 0) {
+        pos += (uint32_t)br;
+        fpga_jtag_sram_write(s_buf, (uint32_t)br, pos >= s_size);
+        if ((pos & (FPU_BLOCK - 1)) == 0)
+            vTaskDelay(1);               /* feed the watchdog */
+    }
+    bool ok = fpga_jtag_sram_end() && pos >= s_size;
+    s_times.load_ms = ms_since(t0);
+    if (!ok) {
+        fpga_jtag_reload();              /* back to the flash image */
+        fail("SRAM LOAD FAILED");
+        return false;
+    }
+    osd_log("FPGA: SRAM LOADED");
+    return true;
+}
+
+/* Write the changed blocks (all of them in FPU_MODE_FULL) to the flash. */
+static bool install_flash(FILE *f)
+{
+    int64_t t0 = esp_timer_get_time();
+    bool entered = s_keepsram ? fpga_jtag_flash_enter_keepsram()
+                              : fpga_jtag_flash_enter();
+    s_times.enter_ms = ms_since(t0);
+    if (!entered) {                       /* fabric dies here (non-keepsram) */
+        fpga_jtag_reload();              /* try to come back up */
+        fail("COULD NOT ENTER FLASH MODE");
+        return false;
+    }
+
+    /* Hash: the image CRC of every block (needed for the verify either
+     * way), and in diff mode the flash CRC to pick the blocks to write. */
+    t0 = esp_timer_get_time();
+    uint32_t nblk = (s_size + FPU_BLOCK - 1) / FPU_BLOCK;
+    s_times.blocks = nblk;
+    s_times.changed = 0;
+    for (uint32_t b = 0; b < nblk; b++) {
+        uint32_t n = block_len(b);
+        if (!file_block_crc(f, b, &s_crc[b])) {
+            fpga_jtag_reload();          /* nothing erased yet: old image */
+            fail("READ ERROR");
+            return false;
+        }
+        s_todo[b] = s_mode == FPU_MODE_FULL ||
+                    flash_block_crc(b * FPU_BLOCK, n) != s_crc[b];
+        if (s_todo[b])
+            s_times.changed++;
+        vTaskDelay(1);
+    }
+    s_times.hash_ms = ms_since(t0);
+    osd_log("FPGA: %lu OF %lu BLOCKS CHANGED", (unsigned long)s_times.changed,
+            (unsigned long)nblk);
+
+    /* From here, in the default (non-keepsram) flow the screen is dark and
+     * there is no way back to the old bitstream except finishing. */
+    t0 = esp_timer_get_time();
+    for (uint32_t b = 0; b < nblk; b++) {
+        if (s_todo[b] && !flash_erase_block(b * FPU_BLOCK)) {
+            fail("ERASE TIMEOUT");
+            return false;
+        }
+    }
+    s_times.erase_ms = ms_since(t0);
+
+    t0 = esp_timer_get_time();
+    for (uint32_t b = 0; b < nblk; b++) {
+        if (s_todo[b] && !program_block(f, b)) {
+            fail("PROGRAM FAILED - USB FLASH NEEDED");
+            return false;
+        }
+    }
+    s_times.program_ms = ms_since(t0);
+
+    /* One CRC per written block; a mismatch gets one more erase + program. */
+    t0 = esp_timer_get_time();
+    for (uint32_t b = 0; b < nblk; b++) {
+        if (!s_todo[b])
+            continue;
+        uint32_t addr = b * FPU_BLOCK;
+        if (flash_block_crc(addr, block_len(b)) == s_crc[b])
+            continue;
+        s_times.retried++;
+        ESP_LOGW(TAG, "block %05lx verify mismatch, rewriting",
+                 (unsigned long)addr);
+        if (!flash_erase_block(addr) || !program_block(f, b) ||
+            flash_block_crc(addr, block_len(b)) != s_crc[b]) {
+            /* Old bitstream already erased: FPGA will come up
+             * unconfigured. The ESP32 stays alive; openFPGALoader over
+             * USB-C is the recovery path. */
+            fail("VERIFY FAILED - USB FLASH NEEDED");
+            return false;
+        }
+    }
+    s_times.verify_ms = ms_since(t0);
+
+    osd_log("FPGA: DONE, RELOADING");
+    t0 = esp_timer_get_time();
+    fpga_jtag_reload();                  /* boot the new bitstream */
+    s_times.load_ms = ms_since(t0);
+    return true;
+}
+
 static void install(void)
 {
     FILE *f = fopen(s_path, "rb");
@@ -237,61 +480,12 @@ static void install(void)
         return;
     }
 
-    bool entered = s_keepsram ? fpga_jtag_flash_enter_keepsram()
-                              : fpga_jtag_flash_enter();
-    if (!entered) {                       /* fabric dies here (non-keepsram) */
-        fclose(f);
-        fpga_jtag_reload();              /* try to come back up */
-        fail("COULD NOT ENTER FLASH MODE");
-        return;
-    }
-
-    /* From here the screen is dark and there is no way back to the old
-     * bitstream except finishing (flash is erased block by block). */
-    bool ok = true;
-    for (uint32_t a = 0; ok && a < s_size; a += FPU_BLOCK)
-        ok = flash_erase_block(a);
-    if (!ok) {
-        fclose(f);
-        fail("ERASE TIMEOUT");
-        return;
-    }
-
-    uint32_t addr = 0;
-    while (ok && addr < s_size) {
-        memset(s_page, 0xFF, sizeof(s_page));
-        size_t br = fread(s_page, 1, FPU_PAGE, f);
-        if (br == 0) {
-            ok = false;
-            break;
-        }
-        for (int attempt = 0; attempt < 2; attempt++) {
-            if (!flash_program_page(addr, s_page, br)) {
-                ok = false;
-                break;
-            }
-            fpga_jtag_flash_read(addr, s_back, br);
-            if (memcmp(s_page, s_back, br) == 0)
-                break;
-            if (attempt == 1)
-                ok = false;
-        }
-        addr += br;
-        if ((addr & 0xFFFF) == 0)
-            vTaskDelay(1);               /* feed the watchdog */
-    }
+    bool ok = s_mode == FPU_MODE_SRAM ? install_sram(f) : install_flash(f);
     fclose(f);
-
-    if (!ok) {
-        /* Old bitstream already erased: FPGA will come up unconfigured.
-         * The ESP32 stays alive; openFPGALoader over USB-C is the
-         * recovery path. */
-        fail("PROGRAM/VERIFY FAILED - USB FLASH NEEDED");
+    if (!ok)
         return;
-    }
 
-    osd_log("FPGA: DONE, RELOADING");
-    fpga_jtag_reload();                  /* boot the new bitstream */
+    report_timings();
     vTaskDelay(pdMS_TO_TICKS(2000));
     s_state = FPU_IDLE;
     esp_restart();                       /* clean full-system bring-up */
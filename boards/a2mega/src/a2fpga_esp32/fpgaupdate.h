@@ -17,6 +17,28 @@ typedef enum {
     FPU_ERROR
 } fpu_state_t;
 
+typedef enum {
+    FPU_MODE_DIFF = 0, // write only the 64 KB blocks that differ (default)
+    FPU_MODE_FULL,     // erase and write every block
+    FPU_MODE_SRAM      // JTAG-load the FPGA SRAM; flash untouched
+} fpu_mode_t;
+
+// Per-phase wall time of the last check/install, in ms. Flash modes fill
+// enter..verify and put the JTAG reload in load_ms; SRAM mode fills
+// enter (SRAM erase) and load.
+typedef struct {
+    uint32_t check_ms;
+    uint32_t enter_ms;
+    uint32_t hash_ms;
+    uint32_t erase_ms;
+    uint32_t program_ms;
+    uint32_t verify_ms;
+    uint32_t load_ms;
+    uint16_t blocks;   // 64 KB blocks in the image
+    uint16_t changed;  // blocks erased + written
+    uint16_t retried;  // blocks rewritten after a verify mismatch
+} fpu_timings_t;
+
 // Start a check of /sdcard/<path>. Returns false if a check/install is
 // already in flight.
 bool fpgaupdate_request(const char *path);
@@ -24,6 +46,12 @@ bool fpgaupdate_request(const char *path);
 // Confirm installation of the verified file (FPU_READY -> FPU_INSTALL_REQ).
 void fpgaupdate_commit(void);
 void fpgaupdate_set_keepsram(bool on);
+void fpgaupdate_set_mode(fpu_mode_t mode);
+
+// Called with the timing summary just before the post-install restart
+// (a successful install never returns to the caller).
+void fpgaupdate_set_report(void (*fn)(const char *line));
+void fpgaupdate_timings(fpu_timings_t *out);
 
 // Cancel from FPU_READY / FPU_ERROR back to idle.
 void fpgaupdate_cancel(void);
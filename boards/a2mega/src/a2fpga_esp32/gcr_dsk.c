@@ -2,6 +2,15 @@
  * gcr_dsk.c — Apple II 6-and-2 GCR codec for DOS 3.3 order .dsk/.do images.
  * See gcr_dsk.h. Algorithm/tables/gap sizes ported from AppleWin
  * CImageBase::Code62 / Decode62 / NibblizeTrack (source/DiskImageHelper.cpp).
+ *
+ * The 6-and-2 stages are table-driven rather than the byte-at-a-time AppleWin
+ * form: the aux 2-bit groups come from precomputed split tables, and the
+ * running-XOR and the (de)translate are fused into one pass over the field,
+ * so no intermediate nib[]/xbuf[] arrays are built. The track decoder scans
+ * linearly (memchr for $D5) instead of taking a modulo per nibble; only the
+ * few hundred positions whose fields may wrap the window end are read from a
+ * small wrap-padded copy. Bit-exact with the AppleWin port — see
+ * boards/a2mega/tests/test_gcr_dsk.c, which keeps that port as a reference.
  */
 
 #include "gcr_dsk.h"
@@ -20,19 +29,41 @@ static const uint8_t kDiskByte[0x40] = {
     0xF7,0xF9,0xFA,0xFB,0xFC,0xFD,0xFE,0xFF
 };
 
-/* Inverse of kDiskByte: disk byte -> 6-bit value (0..63), or 0xFF if illegal.
- * Lazily built; the disk-serve task is single-threaded so no lock is needed. */
+/* Derived tables, lazily built; the disk-serve task is single-threaded so no
+ * lock is needed.
+ *   kReadByte  disk byte -> 6-bit value (0..63), or 0xFF if illegal
+ *   kDiskHi    byte b -> kDiskByte[b >> 2] (translate an 8-bit XOR directly)
+ *   kAuxEnc[g] byte b -> its low two bits, bit-swapped, at 6-bit group g
+ *              (g = 0: bits 1..0, 1: bits 3..2, 2: bits 5..4)
+ *   kAuxDec[g] 6-bit aux value -> the two low data bits of group g */
 static uint8_t kReadByte[256];
-static int     kReadByteReady = 0;
+static uint8_t kDiskHi[256];
+static uint8_t kAuxEnc[3][256];
+static uint8_t kAuxDec[3][64];
+static int     kTablesReady = 0;
 
-static void ensure_read_table(void)
+/* The 6-and-2 aux groups store each byte's low two bits swapped. */
+static inline uint8_t swap2(uint8_t a)
 {
-    if (kReadByteReady)
+    return (uint8_t)(((a & 0x01) << 1) | ((a & 0x02) >> 1));
+}
+
+static void ensure_tables(void)
+{
+    if (kTablesReady)
         return;
     memset(kReadByte, 0xFF, sizeof(kReadByte));
     for (int i = 0; i < 0x40; i++)
         kReadByte[kDiskByte[i]] = (uint8_t)i;
-    kReadByteReady = 1;
+    for (int b = 0; b < 256; b++) {
+        kDiskHi[b] = kDiskByte[b >> 2];
+        for (int g = 0; g < 3; g++)
+            kAuxEnc[g][b] = (uint8_t)(swap2((uint8_t)b) << (2 * g));
+    }
+    for (int v = 0; v < 64; v++)
+        for (int g = 0; g < 3; g++)
+            kAuxDec[g][v] = swap2((uint8_t)(v >> (2 * g)));
+    kTablesReady = 1;
 }
 
 /* Sector order tables (AppleWin ms_SectorNumber): map a physical sector 0..15
@@ -71,88 +102,87 @@ static const uint8_t kAddrProlog[3] = { 0xD5, 0xAA, 0x96 };
 static const uint8_t kDataProlog[3] = { 0xD5, 0xAA, 0xAD };
 static const uint8_t kEpilog[3]     = { 0xDE, 0xAA, 0xEB };
 
+/* 6-and-2 field layout: 86 aux values, then the 256 data bytes' high six bits,
+ * then the checksum. Aux value k packs the low bits of bytes k, k+$56 and
+ * k+$AC (groups 0/1/2); the last two aux values have no third byte. */
+#define AUX_N    0x56
+#define FIELD_N  343
+
 /* ---- 6-and-2 encode: 256 raw bytes -> 343 disk bytes (342 data + checksum).
- * Verbatim port of AppleWin Code62. -------------------------------------- */
-static void code62(const uint8_t sec[256], uint8_t out[343])
+ * Each on-disk value is the XOR of consecutive pre-translate values; in 8-bit
+ * (<<2) form that is a plain byte XOR, translated by kDiskHi in one step. --- */
+static void code62(const uint8_t sec[256], uint8_t out[FIELD_N])
 {
-    uint8_t nib[342];
-    uint8_t offset = 0xAC;
-    int idx = 0;
-
-#define ADDVALUE(a) value = (uint8_t)((value << 2) | (((a) & 0x01) << 1) | (((a) & 0x02) >> 1))
-    while (offset != 0x02) {
-        uint8_t value = 0;
-        ADDVALUE(sec[offset]); offset -= 0x56;
-        ADDVALUE(sec[offset]); offset -= 0x56;
-        ADDVALUE(sec[offset]); offset -= 0x53;
-        nib[idx++] = (uint8_t)(value << 2);
+    uint8_t prev = 0;   /* previous value in <<2 form (running XOR) */
+    int k;
+
+    for (k = 0; k < AUX_N - 2; k++) {
+        uint8_t v = (uint8_t)((kAuxEnc[0][sec[k]] |
+                               kAuxEnc[1][sec[k + AUX_N]] |
+                               kAuxEnc[2][sec[k + 2 * AUX_N]]) << 2);
+        out[k] = kDiskHi[prev ^ v];
+        prev = v;
     }
-#undef ADDVALUE
-    nib[idx - 2] &= 0x3F;   /* last two aux groups are partial */
-    nib[idx - 1] &= 0x3F;
-    for (int i = 0; i < 256; i++)
-        nib[idx++] = sec[i];
-    /* idx == 342 */
-
-    /* running-XOR checksum -> 343 six-bit values */
-    uint8_t xbuf[343];
-    uint8_t saved = 0;
-    for (int i = 0; i < 342; i++) {
-        xbuf[i] = (uint8_t)(saved ^ nib[i]);
-        saved = nib[i];
+    for (; k < AUX_N; k++) {   /* last two aux groups are partial */
+        uint8_t v = (uint8_t)((kAuxEnc[0][sec[k]] |
+                               kAuxEnc[1][sec[k + AUX_N]]) << 2);
+        out[k] = kDiskHi[prev ^ v];
+        prev = v;
     }
-    xbuf[342] = saved;
 
-    /* translate to disk bytes (high 6 bits of each value) */
-    for (int i = 0; i < 343; i++)
-        out[i] = kDiskByte[xbuf[i] >> 2];
+    /* data section, a word at a time: out[i] translates sec[i-1] ^ sec[i]
+     * (sec[-1] = the last aux value). */
+    uint8_t *o = out + AUX_N;
+    for (int i = 0; i < 256; i += 4) {
+        uint32_t w;
+        memcpy(&w, &sec[i], 4);   /* little-endian: byte i in bits 7..0 */
+        uint32_t x = w ^ ((w << 8) | prev);
+        o[i + 0] = kDiskHi[(uint8_t)(x)];
+        o[i + 1] = kDiskHi[(uint8_t)(x >> 8)];
+        o[i + 2] = kDiskHi[(uint8_t)(x >> 16)];
+        o[i + 3] = kDiskHi[(uint8_t)(x >> 24)];
+        prev = (uint8_t)(w >> 24);
+    }
+    out[FIELD_N - 1] = kDiskHi[prev];   /* checksum = last value */
 }
 
 /* ---- 6-and-2 decode: 343 disk bytes -> 256 raw bytes. Returns 1 if the disk
  * bytes are all legal and the checksum matches, else 0 (out untouched on fail).
- * Verbatim port of AppleWin Decode62 + explicit checksum/legality checks. -- */
-static int decode62(const uint8_t in[343], uint8_t out[256])
+ * Translate and running-XOR are one pass over the field; legality is one OR
+ * (illegal bytes read as 0xFF, legal ones are <= 0x3F). --------------------- */
+static int decode62(const uint8_t in[FIELD_N], uint8_t out[256])
 {
-    ensure_read_table();
-
-    uint8_t sb[343];   /* six-bit values in AppleWin's <<2 form */
-    for (int i = 0; i < 343; i++) {
-        uint8_t v = kReadByte[in[i]];
-        if (v == 0xFF)
-            return 0;             /* illegal disk byte */
-        sb[i] = (uint8_t)(v << 2);
+    uint8_t aux[AUX_N];
+    uint8_t hi[256];
+    uint8_t saved = 0, bad = 0;
+
+    for (int k = 0; k < AUX_N; k++) {
+        uint8_t v = kReadByte[in[k]];
+        bad |= v;
+        saved ^= v;
+        aux[k] = saved;
     }
-
-    /* undo running-XOR into nib[0..341]; sb[342] is the checksum */
-    uint8_t nib[342];
-    uint8_t saved = 0;
-    for (int i = 0; i < 342; i++) {
-        nib[i] = (uint8_t)(saved ^ sb[i]);
-        saved = nib[i];
+    for (int i = 0; i < 256; i++) {
+        uint8_t v = kReadByte[in[AUX_N + i]];
+        bad |= v;
+        saved ^= v;
+        hi[i] = saved;
     }
-    if (sb[342] != saved)
+    uint8_t chk = kReadByte[in[FIELD_N - 1]];
+    if ((bad | chk) & 0xC0)
+        return 0;                 /* illegal disk byte */
+    if (chk != saved)
         return 0;                 /* checksum mismatch */
 
-    /* reassemble 256 bytes: high 6 bits from the 256-section (nib+0x56),
-     * low 2 bits from the aux section (nib[0..85]). */
-    const uint8_t *lowbits = nib;
-    const uint8_t *base    = nib + 0x56;
-    uint8_t offset = 0xAC;
-    while (offset != 0x02) {
-        if (offset >= 0xAC)
-            out[offset] = (uint8_t)((base[offset] & 0xFC)
-                                    | ((lowbits[0] & 0x80) >> 7)
-                                    | ((lowbits[0] & 0x40) >> 5));
-        offset -= 0x56;
-        out[offset] = (uint8_t)((base[offset] & 0xFC)
-                                | ((lowbits[0] & 0x20) >> 5)
-                                | ((lowbits[0] & 0x10) >> 3));
-        offset -= 0x56;
-        out[offset] = (uint8_t)((base[offset] & 0xFC)
-                                | ((lowbits[0] & 0x08) >> 3)
-                                | ((lowbits[0] & 0x04) >> 1));
-        offset -= 0x53;
-        lowbits++;
+    int k;
+    for (k = 0; k < AUX_N - 2; k++) {
+        out[k]             = (uint8_t)((hi[k] << 2)             | kAuxDec[0][aux[k]]);
+        out[k + AUX_N]     = (uint8_t)((hi[k + AUX_N] << 2)     | kAuxDec[1][aux[k]]);
+        out[k + 2 * AUX_N] = (uint8_t)((hi[k + 2 * AUX_N] << 2) | kAuxDec[2][aux[k]]);
+    }
+    for (; k < AUX_N; k++) {
+        out[k]         = (uint8_t)((hi[k] << 2)         | kAuxDec[0][aux[k]]);
+        out[k + AUX_N] = (uint8_t)((hi[k + AUX_N] << 2) | kAuxDec[1][aux[k]]);
     }
     return 1;
 }
@@ -166,13 +196,13 @@ size_t gcr_encode_dos_track(const uint8_t dsk_track[DSK_TRACK_BYTES],
 
     if (out_cap < GCR_TRACK_BYTES)
         return 0;
+    ensure_tables();
 
     uint8_t *p = out;
-    int i;
 
     /* GAP 1: 48 self-sync bytes */
-    for (i = 0; i < 48; i++)
-        *p++ = 0xFF;
+    memset(p, 0xFF, 48);
+    p += 48;
 
     for (int s = 0; s < 16; s++) {
         /* address field */
@@ -185,86 +215,99 @@ size_t gcr_encode_dos_track(const uint8_t dsk_track[DSK_TRACK_BYTES],
         *p++ = kEpilog[0]; *p++ = kEpilog[1]; *p++ = kEpilog[2];
 
         /* GAP 2: 6 self-sync bytes */
-        for (i = 0; i < 6; i++)
-            *p++ = 0xFF;
+        memset(p, 0xFF, 6);
+        p += 6;
 
         /* data field: prologue + 343 six-and-two + epilogue */
         *p++ = kDataProlog[0]; *p++ = kDataProlog[1]; *p++ = kDataProlog[2];
         code62(&dsk_track[ord[s] * 256], p);
-        p += 343;
+        p += FIELD_N;
         *p++ = kEpilog[0]; *p++ = kEpilog[1]; *p++ = kEpilog[2];
 
         /* GAP 3: 27 self-sync bytes (the RWTS write splice lands here) */
-        for (i = 0; i < 27; i++)
-            *p++ = 0xFF;
+        memset(p, 0xFF, 27);
+        p += 27;
     }
 
     /* pad the remainder with self-sync so the track is exactly 6656 bytes; the
      * window wrap then falls inside a long $FF run and RWTS resyncs cleanly. */
-    while ((size_t)(p - out) < GCR_TRACK_BYTES)
-        *p++ = 0xFF;
+    memset(p, 0xFF, GCR_TRACK_BYTES - (size_t)(p - out));
 
     return GCR_TRACK_BYTES;
 }
 
-/* ---- public: decode a (possibly partially rewritten) nibble window -------- */
-uint16_t gcr_decode_dos_track(const uint8_t *nibbles, size_t len,
-                              gcr_order_t order,
-                              uint8_t dsk_track[DSK_TRACK_BYTES])
-{
-    const uint8_t *ord = kSectorOrder[order == GCR_ORDER_PRODOS ? 1 : 0];
-
-    if (len < 16)
-        return 0;
-
-    uint16_t mask = 0;
+/* Furthest nibble a field starting at position i can touch: address prologue
+ * + 8 address bytes, a data prologue up to 63 nibbles later, then the 343-byte
+ * field — i + 419. */
+#define SCAN_SPAN 420u
 
-    for (size_t i = 0; i < len; i++) {
-        /* address prologue? (circular) */
-        if (nibbles[i] != 0xD5 ||
-            nibbles[(i + 1) % len] != 0xAA ||
-            nibbles[(i + 2) % len] != 0x96)
+/* Decode every field whose address prologue starts in p[0..npos). The caller
+ * guarantees p[0 .. npos + SCAN_SPAN) is readable. Positions are visited in
+ * order and a sector is taken from its first valid field only. */
+static uint16_t scan_fields(const uint8_t *p, size_t npos, const uint8_t *ord,
+                            uint8_t dsk_track[DSK_TRACK_BYTES], uint16_t mask)
+{
+    const uint8_t *q   = p;
+    const uint8_t *end = p + npos;
+
+    while (q < end && mask != 0xFFFF) {
+        const uint8_t *i = memchr(q, 0xD5, (size_t)(end - q));
+        if (!i)
+            break;
+        q = i + 1;
+        if (i[1] != 0xAA || i[2] != 0x96)
             continue;
 
-        size_t a = i + 3;
-        uint8_t vol = decode44(nibbles[a % len],       nibbles[(a + 1) % len]);
-        uint8_t trk = decode44(nibbles[(a + 2) % len], nibbles[(a + 3) % len]);
-        uint8_t sec = decode44(nibbles[(a + 4) % len], nibbles[(a + 5) % len]);
-        uint8_t chk = decode44(nibbles[(a + 6) % len], nibbles[(a + 7) % len]);
-        (void)trk;
+        const uint8_t *a = i + 3;
+        uint8_t vol = decode44(a[0], a[1]);
+        uint8_t trk = decode44(a[2], a[3]);
+        uint8_t sec = decode44(a[4], a[5]);
+        uint8_t chk = decode44(a[6], a[7]);
         if (sec >= 16 || chk != (uint8_t)(vol ^ trk ^ sec))
             continue;
         if (mask & (1u << sec))
             continue;   /* already have this sector */
 
         /* find the data prologue shortly after the address epilogue */
-        size_t j = a + 8;
-        size_t limit = j + 64;
-        int found = 0;
-        for (; j < limit; j++) {
-            if (nibbles[j % len] == 0xD5 &&
-                nibbles[(j + 1) % len] == 0xAA &&
-                nibbles[(j + 2) % len] == 0xAD) {
-                found = 1;
+        const uint8_t *j = a + 8, *limit = j + 64;
+        for (; j < limit; j++)
+            if (j[0] == 0xD5 && j[1] == 0xAA && j[2] == 0xAD)
                 break;
-            }
-        }
-        if (!found)
+        if (j == limit)
             continue;
 
-        uint8_t d343[343];
-        size_t d = j + 3;
-        for (int k = 0; k < 343; k++)
-            d343[k] = nibbles[(d + k) % len];
-
         uint8_t out256[256];
-        if (decode62(d343, out256)) {
+        if (decode62(j + 3, out256)) {
             memcpy(&dsk_track[ord[sec] * 256], out256, 256);
             mask |= (uint16_t)(1u << sec);
-            if (mask == 0xFFFF)
-                break;
         }
     }
+    return mask;
+}
+
+/* ---- public: decode a (possibly partially rewritten) nibble window -------- */
+uint16_t gcr_decode_dos_track(const uint8_t *nibbles, size_t len,
+                              gcr_order_t order,
+                              uint8_t dsk_track[DSK_TRACK_BYTES])
+{
+    /* Wrap-padded copy of the positions whose fields may run past the end.
+     * Static: single-threaded (see ensure_tables), and kept off the stack. */
+    static uint8_t pad[2 * SCAN_SPAN];
+    const uint8_t *ord = kSectorOrder[order == GCR_ORDER_PRODOS ? 1 : 0];
 
+    if (len < 16)
+        return 0;
+    ensure_tables();
+
+    /* Positions [0, lin) are read in place; [lin, len) from pad. */
+    size_t lin  = len > SCAN_SPAN ? len - SCAN_SPAN : 0;
+    size_t ntail = len - lin;
+    uint16_t mask = scan_fields(nibbles, lin, ord, dsk_track, 0);
+
+    if (mask != 0xFFFF) {
+        for (size_t k = 0; k < ntail + SCAN_SPAN; k++)
+            pad[k] = nibbles[(lin + k) % len];
+        mask = scan_fields(pad, ntail, ord, dsk_track, mask);
+    }
     return mask;
 }
@@ -151,7 +151,7 @@ static void paint(void)
     int cur = s_cursor[s_depth];
     int top = s_scroll[s_depth];
 
-    fpga_link_lock();                  /* keep the frame update atomic */
+    fpga_screen_begin();               /* atomic; send only what changed, once */
     fpga_screen_clear();
 
     char bar[41];
@@ -185,9 +185,9 @@ static void paint(void)
     }
 
     put_row(23, " A:OK B:BACK Y:CONSOLE SELECT:APPLE II ", true);
+    fpga_screen_end();
 
     fpga_reg_write(A2REG_VIDEO_ENABLE, 1);
-    fpga_link_unlock();
 }
 
 /* ---- navigation ---------------------------------------------------------- */
@@ -551,7 +551,7 @@ static void picker_open(char *target, const char *const *exts,
 }
 
 /* ======================= SCREEN: DISK IMAGES ============================== */
-static const char *const k_floppy_exts[] = { "dsk", "do", "po", "2mg", "nib", NULL };
+static const char *const k_floppy_exts[] = { "dsk", "do", "po", "2mg", "nib", "woz", NULL };
 static const char *const k_hdd_exts[]    = { "hdv", "po", "2mg", NULL };
 
 static void disks_pick(int id)
@@ -572,6 +572,14 @@ static void disks_rescan(int id)
     set_status(" RESCANNING...");
 }
 
+static void disks_wb_change(int id, int dir)
+{
+    (void)id; (void)dir;
+    settings()->disk_writeback = !settings()->disk_writeback;
+    save_settings_status();
+    screen_refresh();
+}
+
 static void disks_build(void)
 {
     disk_info_t di;
@@ -598,7 +606,10 @@ static void disks_build(void)
         m->id = 2 + u;
     }
     mi_add(MI_INFO, "", "");
-    menu_item_t *m = mi_add(MI_ACTION, "RESCAN / REMOUNT ALL", "");
+    menu_item_t *m = mi_add(MI_TOGGLE, "FLOPPY WRITES",
+                            settings()->disk_writeback ? "BACK" : "THROUGH");
+    m->on_change = disks_wb_change;
+    m = mi_add(MI_ACTION, "RESCAN / REMOUNT ALL", "");
     m->action = disks_rescan;
     mi_add(MI_INFO, "SELECT A DRIVE TO CHANGE ITS IMAGE", "");
 }
@@ -805,7 +816,7 @@ static void fpga_install(int id)
      * flash becomes writable), so this page is the last thing visible. */
     s_fw_installing = true;
     ESP_LOGW(TAG, "FPGA core install committed");
-    fpga_link_lock();
+    fpga_screen_begin();
     fpga_screen_clear();
     put_row(0,  "           UPDATING FPGA CORE           ", true);
     put_row(4,  "  THE SCREEN WILL GO COMPLETELY DARK    ", false);
@@ -818,8 +829,8 @@ static void fpga_install(int id)
     put_row(15, "  DARK, RE-FLASH THE FPGA FROM A PC     ", false);
     put_row(16, "  (SEE THE BOARD README).               ", false);
     put_row(23, "            DO NOT POWER OFF            ", true);
+    fpga_screen_end();
     fpga_reg_write(A2REG_VIDEO_ENABLE, 1);
-    fpga_link_unlock();
     fpgaupdate_commit();   /* the disk task takes it from here */
 }
 
@@ -930,12 +941,12 @@ static void root_restart_mcu(int id)
 {
     (void)id;
     ESP_LOGW(TAG, "user-requested ESP32 restart");
-    fpga_link_lock();
+    fpga_screen_begin();
     fpga_screen_clear();
     put_row(0,  "             RESTART ESP32              ", true);
     put_row(8,  "            RESTARTING...               ", false);
+    fpga_screen_end();
     fpga_reg_write(A2REG_VIDEO_ENABLE, 1);
-    fpga_link_unlock();
     vTaskDelay(pdMS_TO_TICKS(100));   /* let the frame land */
     esp_restart();
 }
@@ -41,17 +41,31 @@ static void ensure_lock(void)
         s_lock = xSemaphoreCreateMutex();
 }
 
-/* Repaint the whole buffer to the OSD text page. Caller holds s_lock. */
+/* Repaint the whole buffer to the OSD text page. Caller holds s_lock. One
+ * frame, so only rows that differ from what is on screen go over the link. */
 static void repaint(void)
 {
-    fpga_link_lock();                 /* keep the frame update atomic */
+    fpga_screen_begin();              /* atomic, flushed once at the end */
     fpga_screen_clear();
     fpga_screen_home();
     for (int i = 0; i < s_count; i++) {
         fpga_screen_puts(s_lines[i]);
         fpga_screen_puts("\n");
     }
-    fpga_link_unlock();
+    fpga_screen_end();
+}
+
+/* Paint one appended line on a console already on screen. Caller holds
+ * s_lock. Row `row` is the first free row (repaint() leaves the cursor
+ * there); with the buffer full it is row 23, and the trailing newline
+ * scrolls the page so the line lands on row 22, matching the ring. */
+static void paint_append(int row, const char *line)
+{
+    fpga_screen_begin();
+    fpga_screen_goto(0, row);
+    fpga_screen_puts(line);
+    fpga_screen_puts("\n");
+    fpga_screen_end();
 }
 
 void osd_log(const char *fmt, ...)
@@ -72,6 +86,7 @@ void osd_log(const char *fmt, ...)
         if (*p >= 'a' && *p <= 'z')
             *p = (char)(*p - 32);
 
+    int row = s_count;                /* first free screen row */
     if (s_count < CON_ROWS) {
         strcpy(s_lines[s_count++], line);
     } else {
@@ -80,10 +95,12 @@ void osd_log(const char *fmt, ...)
         strcpy(s_lines[CON_ROWS - 1], line);
     }
 
-    /* Only repaint / assert the takeover when the console is the active view.
-     * When hidden, we just buffer the line — the Apple II keeps the screen. */
+    /* Only paint / assert the takeover when the console is the active view.
+     * When hidden, we just buffer the line — the Apple II keeps the screen.
+     * While shown, the screen already holds the earlier lines (show() and
+     * lockout are the only ways in), so just the new line is drawn. */
     if (s_visible) {
-        repaint();
+        paint_append(row, line);
         fpga_reg_write(A2REG_VIDEO_ENABLE, 1);
     }
 
@@ -8,6 +8,7 @@
 #include "nvs.h"
 #include "esp_log.h"
 
+#include "crc32.h"
 #include "settings.h"
 
 #define SETTINGS_NVS_NAMESPACE "a2fpga"
@@ -26,22 +27,9 @@ static bool          s_nvs_ready;     /* nvs_flash_init succeeded */
 static const char *s_load_why = "?";      /* OK/NVS/RD/SZ/MAG/VER/CRC */
 static char        s_save_why[16] = "-";  /* OK / E<err>@OP|SET|COM */
 
-/* CRC-32 (IEEE, reflected), bitwise — tiny and fast enough for the blob. */
-static uint32_t crc32_calc(const uint8_t *p, uint32_t n)
-{
-    uint32_t crc = 0xFFFFFFFFu;
-    while (n--) {
-        crc ^= *p++;
-        for (int i = 0; i < 8; i++)
-            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
-    }
-    return ~crc;
-}
-
 static uint32_t blob_crc(const a2_settings_t *c)
 {
-    return crc32_calc((const uint8_t *)c,
-                      (uint32_t)((const uint8_t *)&c->crc - (const uint8_t *)c));
+    return crc32_calc(c, (size_t)((const uint8_t *)&c->crc - (const uint8_t *)c));
 }
 
 void settings_reset_defaults(void)
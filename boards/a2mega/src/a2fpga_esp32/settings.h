@@ -74,7 +74,18 @@ typedef struct {
     char     wifi_ssid[33];              /* max 32-char SSID + NUL */
     char     wifi_psk[65];               /* max 64-char WPA passphrase + NUL */
 
-    uint8_t  reserved[15];               /* future fields (shrink as used) */
+    /* Floppy write mode: 0 = write-through (store before the ack), 1 =
+     * write-back (ack from RAM, journaled background flush — disk.c).
+     * Taken from reserved, so older blobs load as write-through. */
+    uint8_t  disk_writeback;
+
+    /* MACRAW bridge ingress: 0 = every frame addressed to the station
+     * (unicast, multicast, broadcast), 1 = only IPv4 and ARP of those (less
+     * link traffic on a busy LAN, but no IPv6 or other protocols). Taken
+     * from reserved, so older blobs load as 0. */
+    uint8_t  net_ip_only;
+
+    uint8_t  reserved[13];               /* future fields (shrink as used) */
 
     uint32_t crc;                        /* CRC-32 of everything above */
 } a2_settings_t;
@@ -17,27 +17,34 @@
  *   - MACRAW SEND  -> drain the TX ring and transmit the raw frame
  *   - MACRAW RECV  -> recompute Sn_RX_RSR from the Apple II's read pointer
  *   - CLOSE        -> stop bridging
+ *   - TCP/UDP/IPRAW -> the lwIP socket engine (w5100_sock.c)
  * Wire frames arrive via w5100_macraw_rx() (called from wifi_bridge_poll), are
- * MAC-filtered, framed with the 2-byte length header, and pushed into the RX ring.
+ * MAC-filtered, framed with the 2-byte length header, and pushed into the RX ring;
+ * a frame that does not fit is handed back for the bridge to retry.
  *
  * The actual TX/MAC-NAT plumbing lives in wifi_bridge.c behind the weak hooks
  * below.
  */
 
 #include "w5100.h"
+#include "w5100_sock.h"
 #include "fpga_link.h"
 #include <string.h>
 #include "esp_log.h"
+#include "esp_timer.h"
 
 static const char *TAG = "w5100";
 
 /* ---- weak bridge hooks (overridden in wifi_bridge.c) ---- */
-__attribute__((weak)) void w5100_bridge_tx(const uint8_t *frame, uint32_t len) { (void)frame; (void)len; }
+__attribute__((weak)) void w5100_bridge_tx(uint8_t *frame, uint32_t len) { (void)frame; (void)len; }
 __attribute__((weak)) bool w5100_bridge_uplink_mac(uint8_t mac[6]) { (void)mac; return false; }
 __attribute__((weak)) void w5100_bridge_set_uplink_mac(const uint8_t mac[6]) { (void)mac; }
 __attribute__((weak)) void w5100_bridge_set_promiscuous(void) {}
 
 /* ---- emulation state ---- */
+
+/* Socket register block bytes mirrored per socket: Sn_MR .. Sn_RX_RD. */
+#define SN_BLOCK (W5100_Sn_RX_RD + 2)
 typedef struct {
     uint8_t  mode;        /* Sn_MR protocol field */
     uint8_t  status;      /* Sn_SR */
@@ -48,6 +55,8 @@ typedef struct {
     uint16_t tx_base;
     uint16_t tx_size;
     uint16_t tx_mask;
+    uint8_t  reg[SN_BLOCK];  /* mirror of the socket register block */
+    uint64_t dirty;          /* reg[] bytes changed since the last commit */
 } sock_t;
 
 static sock_t g_sock[W5100_NUM_SOCKETS];
@@ -62,7 +71,9 @@ static bool    g_shar_seeded;     /* SHAR preloaded with the uplink MAC */
 static volatile uint32_t g_cmds;       /* socket commands serviced (doorbell) */
 static volatile uint32_t g_rx_frames;  /* frames bridged wire -> Apple II */
 static volatile uint32_t g_tx_frames;  /* frames bridged Apple II -> wire */
-static volatile uint32_t g_drop_full;  /* RX frames dropped: MACRAW ring full */
+static volatile uint32_t g_rx_full;    /* RX frames refused: MACRAW ring full */
+static volatile uint32_t g_link_xfers; /* SPACE 3 transactions */
+static volatile uint32_t g_link_bytes; /* SPACE 3 payload bytes */
 
 /* W5100 power-on register defaults. The emulated register backing store comes up
  * zeroed, but software probes the chip by reading reset defaults -- notably IP65,
@@ -76,37 +87,95 @@ static const struct { uint16_t addr; uint8_t val; } W5100_DEFAULTS[] = {
     { 0x0028, 0x28 },                    /* PTIMER */
 };
 
-/* Scratch for moving a frame between SPACE 3 and the wire */
-static uint8_t g_frame[W5100_MAX_FRAME + 4];
+/* TX frames are read out of the ring into this buffer and handed to the
+ * bridge, which rewrites and transmits it in place. */
+static uint8_t g_frame[W5100_MAX_FRAME];
+
+/* ---- SPACE 3 access (every transaction is counted for w5100_stats) ---- */
+static void link_rd(uint16_t addr, uint8_t *buf, uint16_t len)
+{
+    fpga_mem_read(A2SPACE_W5100, addr, buf, len);
+    g_link_xfers++;
+    g_link_bytes += len;
+}
+static void link_wr(uint16_t addr, const uint8_t *buf, uint16_t len)
+{
+    fpga_mem_write(A2SPACE_W5100, addr, buf, len);
+    g_link_xfers++;
+    g_link_bytes += len;
+}
 
-/* ---- SPACE 3 register helpers (W5100 16-bit regs are big-endian) ---- */
+/* Single-register helpers */
 static inline uint8_t w_rd8(uint16_t addr)
 {
     uint8_t v = 0;
-    fpga_mem_read(A2SPACE_W5100, addr, &v, 1);
+    link_rd(addr, &v, 1);
     return v;
 }
 static inline void w_wr8(uint16_t addr, uint8_t v)
 {
-    fpga_mem_write(A2SPACE_W5100, addr, &v, 1);
+    link_wr(addr, &v, 1);
+}
+
+/* Socket register block mirror: one read fetches Sn_MR .. Sn_RX_RD, the
+ * handlers work on the copy, and commit writes back only the bytes they
+ * changed -- one transaction per contiguous run, so fields the Apple II owns
+ * (Sn_TX_WR, Sn_RX_RD, ...) are never written back stale. */
+static void sn_fetch(int n)
+{
+    link_rd(W5100_S_BASE(n), g_sock[n].reg, SN_BLOCK);
+    g_sock[n].dirty = 0;
+}
+static inline uint16_t sn_get16(int n, uint8_t r)
+{
+    return ((uint16_t)g_sock[n].reg[r] << 8) | g_sock[n].reg[r + 1];
 }
-static inline uint16_t w_rd16(uint16_t addr)
+static inline void sn_put8(int n, uint8_t r, uint8_t v)
 {
-    uint8_t b[2] = { 0, 0 };
-    fpga_mem_read(A2SPACE_W5100, addr, b, 2);
-    return ((uint16_t)b[0] << 8) | b[1];
+    g_sock[n].reg[r] = v;
+    g_sock[n].dirty |= 1ull << r;
 }
-static inline void w_wr16(uint16_t addr, uint16_t v)
+static inline void sn_put16(int n, uint8_t r, uint16_t v)
 {
-    uint8_t b[2] = { (uint8_t)(v >> 8), (uint8_t)v };
-    fpga_mem_write(A2SPACE_W5100, addr, b, 2);
+    sn_put8(n, r, (uint8_t)(v >> 8));
+    sn_put8(n, (uint8_t)(r + 1), (uint8_t)v);
+}
+static void sn_commit(int n)
+{
+    sock_t *s = &g_sock[n];
+    int r = 0;
+    while (s->dirty >> r) {
+        if (!((s->dirty >> r) & 1)) { r++; continue; }
+        int e = r;
+        while (e < SN_BLOCK && ((s->dirty >> e) & 1))
+            e++;
+        link_wr((uint16_t)(W5100_S_BASE(n) + r), &s->reg[r], (uint16_t)(e - r));
+        r = e;
+    }
+    s->dirty = 0;
 }
 
-/* Decode a 2-bit RMSR/TMSR field to a byte count (1/2/4/8 KB). */
-static uint16_t mem_size_field(uint8_t reg, int socket)
+/* Move len bytes between a ring (at offset off) and buf: one span, or two
+ * when the record wraps. */
+static void ring_rd(uint16_t base, uint16_t size, uint16_t off, uint8_t *buf, uint16_t len)
 {
-    uint8_t f = (reg >> (socket * 2)) & 0x03;
-    return (uint16_t)(1024u << f);
+    uint16_t first = size - off;
+    if (first >= len) {
+        link_rd(base + off, buf, len);
+    } else {
+        link_rd(base + off, buf, first);
+        link_rd(base, buf + first, len - first);
+    }
+}
+static void ring_wr(uint16_t base, uint16_t size, uint16_t off, const uint8_t *buf, uint16_t len)
+{
+    uint16_t first = size - off;
+    if (first >= len) {
+        link_wr(base + off, buf, len);
+    } else {
+        link_wr(base + off, buf, first);
+        link_wr(base, buf + first, len - first);
+    }
 }
 
 /* ---- command handlers (callers hold the FPGA link lock) ---- */
@@ -117,32 +186,28 @@ static void macraw_open(int n)
     uint8_t rmsr = w_rd8(W5100_RMSR);
     uint8_t tmsr = w_rd8(W5100_TMSR);
 
-    /* Socket 0 buffers start at the bases; (later sockets would be offset, but
-     * MACRAW is socket 0 only.) */
-    s->rx_base = W5100_RX_BASE;
-    s->rx_size = mem_size_field(rmsr, n);
+    w5100_sock_layout(n, rmsr, tmsr, &s->rx_base, &s->rx_size,
+                      &s->tx_base, &s->tx_size);
     s->rx_mask = s->rx_size - 1;
-    s->tx_base = W5100_TX_BASE;
-    s->tx_size = mem_size_field(tmsr, n);
     s->tx_mask = s->tx_size - 1;
     s->rx_wr   = 0;
 
-    /* Reset ring pointers in the backing store */
-    w_wr16(W5100_S_BASE(n) + W5100_Sn_TX_RD, 0);
-    w_wr16(W5100_S_BASE(n) + W5100_Sn_TX_WR, 0);
-    w_wr16(W5100_S_BASE(n) + W5100_Sn_RX_RD, 0);
-    w_wr16(W5100_S_BASE(n) + W5100_Sn_RX_RSR, 0);
-    w_wr16(W5100_S_BASE(n) + W5100_Sn_TX_FSR, s->tx_size);
+    /* Reset ring pointers (Sn_TX_FSR..Sn_RX_RD, one run) and the status in
+     * the mirror; the doorbell loop commits them. */
+    sn_put16(n, W5100_Sn_TX_FSR, s->tx_size);
+    sn_put16(n, W5100_Sn_TX_RD, 0);
+    sn_put16(n, W5100_Sn_TX_WR, 0);
+    sn_put16(n, W5100_Sn_RX_RSR, 0);
+    sn_put16(n, W5100_Sn_RX_RD, 0);
 
     s->status = W5100_SOCK_MACRAW;
-    w_wr8(W5100_S_BASE(n) + W5100_Sn_SR, s->status);
+    sn_put8(n, W5100_Sn_SR, s->status);
 
     /* Capture the Apple II MAC (SHAR) for filtering */
-    fpga_mem_read(A2SPACE_W5100, W5100_SHAR, g_mac, 6);
+    link_rd(W5100_SHAR, g_mac, 6);
     g_mac_valid = (g_mac[0] | g_mac[1] | g_mac[2] | g_mac[3] | g_mac[4] | g_mac[5]) != 0;
 
-    uint8_t sn_mr = w_rd8(W5100_S_BASE(n) + W5100_Sn_MR);
-    g_macraw_mf = (sn_mr & W5100_MR_MF) != 0;
+    g_macraw_mf = (s->reg[W5100_Sn_MR] & W5100_MR_MF) != 0;
     g_macraw_active = true;
     g_uplink_mirrored = false;   /* w5100_sync_mac() will push SHAR -> uplink */
     ESP_LOGI(TAG, "MACRAW open: rx %u tx %u mf %d mac %02x:%02x:%02x:%02x:%02x:%02x",
@@ -150,9 +215,12 @@ static void macraw_open(int n)
              g_mac[0], g_mac[1], g_mac[2], g_mac[3], g_mac[4], g_mac[5]);
 }
 
+/* Written through rather than via the mirror: an OPEN that closes MACRAW
+ * first hands the socket to w5100_sock.c, which sets Sn_SR itself. */
 static void sock_close(int n)
 {
     g_sock[n].status = W5100_SOCK_CLOSED;
+    g_sock[n].reg[W5100_Sn_SR] = W5100_SOCK_CLOSED;
     w_wr8(W5100_S_BASE(n) + W5100_Sn_SR, W5100_SOCK_CLOSED);
     if (n == 0 && g_macraw_active) {
         g_macraw_active = false;
@@ -188,80 +256,76 @@ static void w5100_sync_mac(void)
         /* Preload SHAR with the uplink MAC so stacks that read their MAC from
          * the card adopt it (stacks that write their own SHAR are handled
          * above). */
-        fpga_mem_write(A2SPACE_W5100, W5100_SHAR, umac, 6);
+        link_wr(W5100_SHAR, umac, 6);
         g_shar_seeded = true;
     }
 #endif
 }
 
+/* SEND: the register block was fetched with the doorbell (sn_fetch); the
+ * frame goes from the ring straight into the bridge's TX buffer. */
 static void macraw_send(int n)
 {
     sock_t *s = &g_sock[n];
-    uint16_t rd = w_rd16(W5100_S_BASE(n) + W5100_Sn_TX_RD);
-    uint16_t wr = w_rd16(W5100_S_BASE(n) + W5100_Sn_TX_WR);
+    uint16_t rd = sn_get16(n, W5100_Sn_TX_RD);
+    uint16_t wr = sn_get16(n, W5100_Sn_TX_WR);
     uint16_t len = (uint16_t)(wr - rd);          /* bytes queued (mod 2^16) */
 
-    if (len == 0 || len > W5100_MAX_FRAME) {
-        /* nothing to do / bogus length: just resync the read pointer */
-        w_wr16(W5100_S_BASE(n) + W5100_Sn_TX_RD, wr);
-        w_wr16(W5100_S_BASE(n) + W5100_Sn_TX_FSR, s->tx_size);
-        return;
-    }
-
-    /* Read the frame out of the TX ring (handle wrap) */
-    uint16_t off = rd & s->tx_mask;
-    uint16_t first = s->tx_size - off;
-    if (first >= len) {
-        fpga_mem_read(A2SPACE_W5100, s->tx_base + off, g_frame, len);
-    } else {
-        fpga_mem_read(A2SPACE_W5100, s->tx_base + off, g_frame, first);
-        fpga_mem_read(A2SPACE_W5100, s->tx_base, g_frame + first, len - first);
+    /* len 0 / bogus length: nothing to send, just resync the read pointer */
+    if (len != 0 && len <= W5100_MAX_FRAME) {
+        ring_rd(s->tx_base, s->tx_size, rd & s->tx_mask, g_frame, len);
+        w5100_bridge_tx(g_frame, len);
+        g_tx_frames++;
     }
 
-    w5100_bridge_tx(g_frame, len);
-    g_tx_frames++;
-
     /* Advance read pointer, refresh free size */
-    w_wr16(W5100_S_BASE(n) + W5100_Sn_TX_RD, wr);
-    w_wr16(W5100_S_BASE(n) + W5100_Sn_TX_FSR, s->tx_size);
+    sn_put16(n, W5100_Sn_TX_RD, wr);
+    sn_put16(n, W5100_Sn_TX_FSR, s->tx_size);
 }
 
 /* RECV: the Apple II advanced Sn_RX_RD; recompute Sn_RX_RSR. */
 static void macraw_recv(int n)
 {
     sock_t *s = &g_sock[n];
-    uint16_t rd = w_rd16(W5100_S_BASE(n) + W5100_Sn_RX_RD);
-    uint16_t rsr = (uint16_t)(s->rx_wr - rd);
-    w_wr16(W5100_S_BASE(n) + W5100_Sn_RX_RSR, rsr);
+    uint16_t rd = sn_get16(n, W5100_Sn_RX_RD);
+    sn_put16(n, W5100_Sn_RX_RSR, (uint16_t)(s->rx_wr - rd));
 }
 
 static void dispatch(int n, uint8_t cmd)
 {
+    bool macraw = g_sock[n].status == W5100_SOCK_MACRAW;
+
     switch (cmd) {
     case W5100_CR_OPEN: {
-        uint8_t mr = w_rd8(W5100_S_BASE(n) + W5100_Sn_MR) & 0x0F;
+        uint8_t mr = g_sock[n].reg[W5100_Sn_MR] & 0x0F;
+        if (macraw)
+            sock_close(n);
         g_sock[n].mode = mr;
         if (mr == W5100_MR_MACRAW && n == 0) {
+            w5100_sock_command(n, W5100_CR_CLOSE);   /* drop an offloaded one */
             macraw_open(n);
         } else {
-            /* TCP/UDP/IPRAW hardware sockets: not in this phase. Park as CLOSED
-             * so software sees a defined (if unhelpful) state. */
-            g_sock[n].status = W5100_SOCK_CLOSED;
-            w_wr8(W5100_S_BASE(n) + W5100_Sn_SR, W5100_SOCK_CLOSED);
+            /* TCP/UDP/IPRAW go to the lwIP socket engine, which parks
+             * anything else (MACRAW on sockets 1-3) as CLOSED. */
+            w5100_sock_open(n, mr);
         }
         break;
     }
     case W5100_CR_SEND:
-        if (g_sock[n].status == W5100_SOCK_MACRAW) macraw_send(n);
+        if (macraw) macraw_send(n);
+        else        w5100_sock_command(n, cmd);
         break;
     case W5100_CR_RECV:
-        if (g_sock[n].status == W5100_SOCK_MACRAW) macraw_recv(n);
+        if (macraw) macraw_recv(n);
+        else        w5100_sock_command(n, cmd);
         break;
     case W5100_CR_CLOSE:
     case W5100_CR_DISCON:
-        sock_close(n);
+        if (macraw) sock_close(n);
+        else        w5100_sock_command(n, cmd);
         break;
     default:
+        w5100_sock_command(n, cmd);         /* LISTEN, CONNECT */
         break;
     }
 }
@@ -305,9 +369,11 @@ void w5100_init(void)
     g_mac_valid = false;
     g_uplink_mirrored = false;
     g_shar_seeded = false;
-    g_cmds = g_rx_frames = g_tx_frames = 0;
+    g_cmds = g_rx_frames = g_tx_frames = g_rx_full = 0;
+    g_link_xfers = g_link_bytes = 0;
     memset(g_mac, 0, sizeof(g_mac));
     g_defaults_seeded = false;   /* actual seeding happens in w5100_poll */
+    w5100_sock_init();
 }
 
 /* Surface bridge state on the DebugOverlay (scratch regs 0x0C-0x0F, shown as hex
@@ -317,7 +383,7 @@ void w5100_init(void)
  *                  b3 macraw_mf, b4 heartbeat, b7 defaults_seeded
  *   byte2 (0x0D) = g_rx_frames low byte (frames wire -> Apple II ring)
  *   byte3 (0x0E) = g_tx_frames low byte (frames Apple II -> wire)
- *   byte4 (0x0F) = g_drop_full low byte (RX frames dropped: MACRAW ring full) */
+ *   byte4 (0x0F) = g_rx_full low byte (RX frames refused: MACRAW ring full) */
 static void w5100_report(void)
 {
     static uint8_t hb;
@@ -327,10 +393,9 @@ static void w5100_report(void)
                  (g_mac_valid ? 0x04 : 0) | (g_macraw_mf ? 0x08 : 0) |
                  (hb ? 0x10 : 0) | (g_defaults_seeded ? 0x80 : 0);
 
-    fpga_reg_write(A2REG_SCRATCH1, st);
-    fpga_reg_write(A2REG_SCRATCH2, (uint8_t)g_rx_frames);
-    fpga_reg_write(A2REG_SCRATCH3, (uint8_t)g_tx_frames);
-    fpga_reg_write(A2REG_SCRATCH4, (uint8_t)g_drop_full);
+    uint8_t r[4] = { st, (uint8_t)g_rx_frames, (uint8_t)g_tx_frames,
+                     (uint8_t)g_rx_full };
+    fpga_reg_write_burst(A2REG_SCRATCH1, r, sizeof(r));   /* SCRATCH1..4 */
 }
 
 void w5100_poll(void)
@@ -348,21 +413,34 @@ void w5100_poll(void)
     static uint16_t rpt;
     if (++rpt >= 500) { rpt = 0; w5100_report(); }
 
+    /* Offloaded sockets progress without a doorbell (connects, accepts,
+     * received data, unfinished sends). */
+    w5100_sock_poll();
+
+    /* STATUS (and the request age) first: the doorbell is only read while
+     * the attention line is low, or every poll without one. */
+    if (!fpga_attn_pending()) return;
+    uint32_t age_us;
+    if (!(fpga_attn_status(FPGA_ATTN_NET, &age_us) & A2STAT_U2_PENDING)) return;
+    int64_t t0 = esp_timer_get_time();
+
     uint8_t pending = fpga_reg_read(A2REG_U2_DOORBELL) & 0x0F;
     if (!pending) return;
 
     fpga_link_lock();
     for (int n = 0; n < W5100_NUM_SOCKETS; n++) {
         if (!(pending & (1 << n))) continue;
-        uint8_t cmd = w_rd8(W5100_S_BASE(n) + W5100_Sn_CR);
-        dispatch(n, cmd);
+        sn_fetch(n);                     /* Sn_CR and the pointers, one read */
+        dispatch(n, g_sock[n].reg[W5100_Sn_CR]);
         g_cmds++;
         /* W5100 auto-clears Sn_CR once accepted */
-        w_wr8(W5100_S_BASE(n) + W5100_Sn_CR, 0);
+        sn_put8(n, W5100_Sn_CR, 0);
+        sn_commit(n);
     }
     /* Clear the serviced doorbell bits (write-1-to-clear) */
     fpga_reg_write(A2REG_U2_DOORBELL, pending);
     fpga_link_unlock();
+    fpga_lat_record(FPGA_ATTN_NET, age_us + (uint32_t)(esp_timer_get_time() - t0));
 }
 
 bool w5100_macraw_active(void)
@@ -377,53 +455,66 @@ bool w5100_get_mac(uint8_t mac[6])
     return true;
 }
 
-void w5100_macraw_rx(const uint8_t *frame, uint32_t len)
+w5100_rx_result_t w5100_macraw_rx(uint8_t *frame, uint32_t len)
 {
-    if (!g_macraw_active || len < 14 || len > W5100_MAX_FRAME) return;
+    if (!g_macraw_active || len < 14 || len > W5100_MAX_FRAME)
+        return W5100_RX_REJECT;
     sock_t *s = &g_sock[0];
 
     /* MAC filter: accept broadcast/multicast (bit0 of first octet) or our MAC */
     if (g_macraw_mf && g_mac_valid) {
         bool mcast = (frame[0] & 0x01) != 0;             /* covers broadcast too */
         bool ours  = (memcmp(frame, g_mac, 6) == 0);
-        if (!mcast && !ours) return;
+        if (!mcast && !ours)
+            return W5100_RX_REJECT;
     }
 
-    /* W5100 MACRAW record = 2-byte length (frame + 2), big-endian, then frame */
-    uint16_t rec = (uint16_t)(len + 2);
+    /* W5100 MACRAW record = 2-byte length (frame + 2), big-endian, then the
+     * frame. The header goes in the caller's headroom so the record leaves
+     * from the driver buffer as one span (two if it wraps the ring). */
+    uint16_t total = (uint16_t)(len + 2);
+    uint8_t *rec = frame - W5100_RX_HEADROOM;
 
     fpga_link_lock();
+    sn_fetch(0);
 
-    /* Drop if it would not fit (leave room; never fill completely) */
-    uint16_t used = (uint16_t)(s->rx_wr - w_rd16(W5100_S_BASE(0) + W5100_Sn_RX_RD));
-    if ((uint32_t)used + rec >= s->rx_size) {
-        g_drop_full++;
+    /* Refuse if it would not fit (leave room; never fill completely) */
+    uint16_t rd = sn_get16(0, W5100_Sn_RX_RD);
+    uint16_t used = (uint16_t)(s->rx_wr - rd);
+    if ((uint32_t)used + total >= s->rx_size) {
+        g_rx_full++;
         fpga_link_unlock();
-        return;
+        return W5100_RX_FULL;
     }
 
-    /* Build header + frame in scratch and write into the RX ring (handle wrap) */
-    g_frame[0] = (uint8_t)(rec >> 8);
-    g_frame[1] = (uint8_t)rec;
-    memcpy(g_frame + 2, frame, len);
-    uint16_t total = (uint16_t)(len + 2);
-
-    uint16_t off = s->rx_wr & s->rx_mask;
-    uint16_t first = s->rx_size - off;
-    if (first >= total) {
-        fpga_mem_write(A2SPACE_W5100, s->rx_base + off, g_frame, total);
-    } else {
-        fpga_mem_write(A2SPACE_W5100, s->rx_base + off, g_frame, first);
-        fpga_mem_write(A2SPACE_W5100, s->rx_base, g_frame + first, total - first);
-    }
+    rec[0] = (uint8_t)(total >> 8);
+    rec[1] = (uint8_t)total;
+    ring_wr(s->rx_base, s->rx_size, s->rx_wr & s->rx_mask, rec, total);
 
     s->rx_wr = (uint16_t)(s->rx_wr + total);
     g_rx_frames++;
 
     /* Publish received size for the Apple II (the W5100 has no host-visible
      * Sn_RX_WR; software polls Sn_RX_RSR and advances Sn_RX_RD). */
-    uint16_t rd = w_rd16(W5100_S_BASE(0) + W5100_Sn_RX_RD);
-    w_wr16(W5100_S_BASE(0) + W5100_Sn_RX_RSR, (uint16_t)(s->rx_wr - rd));
+    sn_put16(0, W5100_Sn_RX_RSR, (uint16_t)(s->rx_wr - rd));
+    sn_commit(0);
 
     fpga_link_unlock();
+    return W5100_RX_OK;
+}
+
+void w5100_stats(w5100_stats_t *out)
+{
+    out->cmds       = g_cmds;
+    out->rx_frames  = g_rx_frames;
+    out->tx_frames  = g_tx_frames;
+    out->rx_full    = g_rx_full;
+    out->link_xfers = g_link_xfers;
+    out->link_bytes = g_link_bytes;
+}
+
+void w5100_stats_reset(void)
+{
+    g_cmds = g_rx_frames = g_tx_frames = g_rx_full = 0;
+    g_link_xfers = g_link_bytes = 0;
 }
@@ -10,8 +10,8 @@
  *
  * Scope: MACRAW on socket 0, bridged to the WiFi STA uplink (wifi_bridge.c).
  * The Apple II runs its own stack (IP65, etc.) and appears on the LAN behind
- * the ESP32's station MAC via MAC NAT -- see wifi_bridge.h. TCP/UDP hardware
- * socket modes are a later phase.
+ * the ESP32's station MAC via MAC NAT -- see wifi_bridge.h. TCP, UDP and IPRAW
+ * sockets (all four) are offloaded to the ESP32's lwIP stack by w5100_sock.c.
  */
 
 #ifndef _W5100_H
@@ -78,10 +78,21 @@ extern "C" {
 #define W5100_CR_SEND   0x20
 #define W5100_CR_RECV   0x40
 
+/* Socket interrupt (Sn_IR) */
+#define W5100_IR_CON        0x01
+#define W5100_IR_DISCON     0x02
+#define W5100_IR_RECV       0x04
+#define W5100_IR_TIMEOUT    0x08
+#define W5100_IR_SEND_OK    0x10
+
 /* Socket status (Sn_SR) */
 #define W5100_SOCK_CLOSED   0x00
 #define W5100_SOCK_INIT     0x13
+#define W5100_SOCK_LISTEN   0x14
+#define W5100_SOCK_SYNSENT  0x15
 #define W5100_SOCK_ESTABLISHED 0x17
+#define W5100_SOCK_FIN_WAIT 0x18
+#define W5100_SOCK_CLOSE_WAIT 0x1C
 #define W5100_SOCK_UDP      0x22
 #define W5100_SOCK_IPRAW    0x32
 #define W5100_SOCK_MACRAW   0x42
@@ -104,8 +115,34 @@ bool w5100_macraw_active(void);
 
 /* Deliver one received Ethernet frame (from the WiFi bridge ingress path) to
  * the open MACRAW socket's RX ring. Applies the W5100 MAC filter when enabled.
- * No-op if MACRAW is not active. Call from the same task as w5100_poll(). */
-void w5100_macraw_rx(const uint8_t *frame, uint32_t len);
+ * Call from the same task as w5100_poll().
+ * The W5100_RX_HEADROOM bytes before frame must be writable: the record
+ * header is built there so the record is written from the caller's buffer
+ * without a copy.
+ * Returns W5100_RX_FULL, without touching the ring, when the frame does not
+ * fit yet: the caller keeps it and retries once the Apple II has advanced
+ * Sn_RX_RD. W5100_RX_REJECT means it will never be taken (MACRAW not open,
+ * MAC filter, bad length). */
+#define W5100_RX_HEADROOM 2
+typedef enum {
+    W5100_RX_OK = 0,
+    W5100_RX_FULL,
+    W5100_RX_REJECT,
+} w5100_rx_result_t;
+w5100_rx_result_t w5100_macraw_rx(uint8_t *frame, uint32_t len);
+
+/* MACRAW traffic and the SPACE 3 link cost behind it. Frames/s and link
+ * bytes (or transactions) per frame come from deltas of these. */
+typedef struct {
+    uint32_t cmds;         /* socket commands serviced (doorbell) */
+    uint32_t rx_frames;    /* wire -> Apple II ring */
+    uint32_t tx_frames;    /* Apple II -> wire */
+    uint32_t rx_full;      /* RX frames refused: MACRAW ring full */
+    uint32_t link_xfers;   /* SPACE 3 transactions issued by w5100.c */
+    uint32_t link_bytes;   /* SPACE 3 payload bytes, registers + frames */
+} w5100_stats_t;
+void w5100_stats(w5100_stats_t *out);
+void w5100_stats_reset(void);
 
 /* Copy the Apple II's configured MAC (SHAR) into mac[6]. Returns false if not
  * yet set (all zero). */
@@ -120,8 +157,9 @@ bool w5100_get_mac(uint8_t mac[6]);
  * seeds into SHAR when no stack has claimed its own -- making NAT a no-op for
  * stacks that read their MAC from the card). */
 
-/* Transmit one Ethernet frame on the uplink (after any egress rewriting). */
-void w5100_bridge_tx(const uint8_t *frame, uint32_t len);
+/* Transmit one Ethernet frame on the uplink. frame is the emulation's TX
+ * buffer, free to rewrite in place (egress NAT) until the call returns. */
+void w5100_bridge_tx(uint8_t *frame, uint32_t len);
 
 /* Get the uplink's hardware MAC into mac[6]. Returns false if the uplink is
  * not up yet (MAC not known). */
@@ -0,0 +1,596 @@
+/*
+ * w5100_sock.c -- W5100 TCP/UDP/IPRAW socket engine on the ESP32's lwIP stack.
+ * See w5100_sock.h for the overview.
+ *
+ * Per socket the engine keeps the ring geometry and its own copies of the
+ * pointers the W5100 owns (Sn_TX_RD, the hidden RX write pointer) and only
+ * reads the Apple II's pointers when a command says they moved:
+ *   - SEND reads Sn_TX_WR, then the ring bytes from Sn_TX_RD up to it are
+ *     sent (TCP: as much as the socket takes, the rest on later polls; UDP /
+ *     IPRAW: one datagram to Sn_DIPR:Sn_DPORT). Sn_TX_RD and Sn_TX_FSR follow
+ *     and SEND_OK is raised once all of it is gone.
+ *   - RECV reads Sn_RX_RD; the poll fills free ring space from the socket and
+ *     publishes Sn_RX_RSR. UDP records carry the W5100 8-byte header (peer IP,
+ *     port, length), IPRAW records the 6-byte one (peer IP, length).
+ * Connection progress (CONNECT, LISTEN -> accept, peer FIN/RST) is picked up
+ * by w5100_sock_poll() and shows in Sn_SR / Sn_IR like on the chip.
+ *
+ * Sn_IR is write-1-to-clear for the Apple II like on the chip. The card
+ * keeps it in flops: an engine write raises the bits it carries, or clears
+ * them with SN_IR_HOST_CLR, and a raise wins over an Apple clear in the same
+ * cycle. The engine never rewrites bits it did not mean to touch, so a bit
+ * the Apple II cleared stays clear. SEND clears SEND_OK and RECV clears RECV
+ * before re-arming them; CON/DISCON/TIMEOUT clear on the next OPEN.
+ *
+ * Everything that touches SPACE 3 runs under the FPGA link lock: commands
+ * arrive with it held (w5100_poll), and w5100_sock_poll takes it itself.
+ */
+
+#include "w5100.h"
+#include "w5100_sock.h"
+#include "fpga_link.h"
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define W5100_BUF_TOTAL 0x2000u   /* RX and TX regions, 8 KB each */
+#define UDP_HDR  8                /* peer IP, port, length */
+#define RAW_HDR  6                /* peer IP, length */
+#define SN_IR_HOST_CLR 0x80       /* card: Sn_IR write clears, not raises */
+#define IO_MAX   W5100_BUF_TOTAL  /* largest ring, so one datagram fits */
+
+typedef struct {
+    bool     open;        /* fd valid */
+    int      fd;
+    uint8_t  mode;        /* Sn_MR protocol field */
+    uint8_t  status;      /* Sn_SR as last written */
+    bool     sending;     /* SEND accepted, bytes still to go */
+    bool     eof;         /* peer FIN seen */
+    uint16_t rx_base, rx_size;
+    uint16_t tx_base, tx_size;
+    uint16_t rx_wr;       /* hidden W5100 RX write pointer */
+    uint16_t rx_rd;       /* Sn_RX_RD at the last RECV */
+    uint16_t tx_rd;       /* Sn_TX_RD (engine owned) */
+    uint16_t tx_wr;       /* Sn_TX_WR at the last SEND */
+} wsock_t;
+
+static wsock_t g_ws[W5100_NUM_SOCKETS];
+static w5100_sock_stats_t g_stats;
+static uint8_t g_io[IO_MAX];
+
+/* ---- SPACE 3 helpers (W5100 16-bit regs are big-endian) ---- */
+static uint16_t sn_reg(int n, uint8_t reg)
+{
+    return (uint16_t)(W5100_S_BASE(n) + reg);
+}
+static uint8_t sn_rd8(int n, uint8_t reg)
+{
+    uint8_t v = 0;
+    fpga_mem_read(A2SPACE_W5100, sn_reg(n, reg), &v, 1);
+    return v;
+}
+static void sn_wr8(int n, uint8_t reg, uint8_t v)
+{
+    fpga_mem_write(A2SPACE_W5100, sn_reg(n, reg), &v, 1);
+}
+static uint16_t sn_rd16(int n, uint8_t reg)
+{
+    uint8_t b[2] = { 0, 0 };
+    fpga_mem_read(A2SPACE_W5100, sn_reg(n, reg), b, 2);
+    return (uint16_t)((b[0] << 8) | b[1]);
+}
+static void sn_wr16(int n, uint8_t reg, uint16_t v)
+{
+    uint8_t b[2] = { (uint8_t)(v >> 8), (uint8_t)v };
+    fpga_mem_write(A2SPACE_W5100, sn_reg(n, reg), b, 2);
+}
+
+/* Copy len bytes at free-running ring pointer ptr out of / into a ring. */
+static void ring_read(uint16_t base, uint16_t size, uint16_t ptr,
+                      uint8_t *dst, uint16_t len)
+{
+    uint16_t off = ptr & (size - 1);
+    uint16_t first = size - off;
+    if (first >= len) {
+        fpga_mem_read(A2SPACE_W5100, base + off, dst, len);
+    } else {
+        fpga_mem_read(A2SPACE_W5100, base + off, dst, first);
+        fpga_mem_read(A2SPACE_W5100, base, dst + first, len - first);
+    }
+}
+static void ring_write(uint16_t base, uint16_t size, uint16_t ptr,
+                       const uint8_t *src, uint16_t len)
+{
+    uint16_t off = ptr & (size - 1);
+    uint16_t first = size - off;
+    if (first >= len) {
+        fpga_mem_write(A2SPACE_W5100, base + off, src, len);
+    } else {
+        fpga_mem_write(A2SPACE_W5100, base + off, src, first);
+        fpga_mem_write(A2SPACE_W5100, base, src + first, len - first);
+    }
+}
+
+static bool would_block(void)
+{
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+/* ---- socket state ---- */
+static void set_status(int n, uint8_t st)
+{
+    g_ws[n].status = st;
+    sn_wr8(n, W5100_Sn_SR, st);
+}
+
+static void raise_ir(int n, uint8_t bits)
+{
+    sn_wr8(n, W5100_Sn_IR, bits);
+}
+
+static void clear_ir(int n, uint8_t bits)
+{
+    sn_wr8(n, W5100_Sn_IR, SN_IR_HOST_CLR | bits);
+}
+
+static void release(wsock_t *s)
+{
+    if (s->open)
+        close(s->fd);
+    s->open = false;
+    s->sending = false;
+    s->eof = false;
+}
+
+/* Close the BSD socket and show CLOSED, optionally with an interrupt. */
+static void drop(int n, uint8_t ir)
+{
+    release(&g_ws[n]);
+    set_status(n, W5100_SOCK_CLOSED);
+    if (ir)
+        raise_ir(n, ir);
+}
+
+static void set_nonblock(int fd)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+static void publish_rsr(int n)
+{
+    wsock_t *s = &g_ws[n];
+    sn_wr16(n, W5100_Sn_RX_RSR, (uint16_t)(s->rx_wr - s->rx_rd));
+}
+
+static void publish_tx(int n)
+{
+    wsock_t *s = &g_ws[n];
+    sn_wr16(n, W5100_Sn_TX_RD, s->tx_rd);
+    sn_wr16(n, W5100_Sn_TX_FSR, (uint16_t)(s->tx_size - (uint16_t)(s->tx_wr - s->tx_rd)));
+}
+
+static void established(int n)
+{
+    set_status(n, W5100_SOCK_ESTABLISHED);
+    raise_ir(n, W5100_IR_CON);
+}
+
+static void dest_addr(int n, struct sockaddr_in *sa)
+{
+    uint8_t ip[4];
+    fpga_mem_read(A2SPACE_W5100, sn_reg(n, W5100_Sn_DIPR), ip, 4);
+    memset(sa, 0, sizeof(*sa));
+    sa->sin_family = AF_INET;
+    sa->sin_port = htons(sn_rd16(n, W5100_Sn_DPORT));
+    memcpy(&sa->sin_addr.s_addr, ip, 4);
+}
+
+/* ---- layout ---- */
+void w5100_sock_layout(int n, uint8_t rmsr, uint8_t tmsr,
+                       uint16_t *rx_base, uint16_t *rx_size,
+                       uint16_t *tx_base, uint16_t *tx_size)
+{
+    uint16_t roff = 0, toff = 0;
+    for (int i = 0; i <= n; i++) {
+        uint16_t r = (uint16_t)(1024u << ((rmsr >> (i * 2)) & 0x03));
+        uint16_t t = (uint16_t)(1024u << ((tmsr >> (i * 2)) & 0x03));
+        if (roff + r > W5100_BUF_TOTAL) r = 0;
+        if (toff + t > W5100_BUF_TOTAL) t = 0;
+        if (i == n) {
+            *rx_base = (uint16_t)(W5100_RX_BASE + roff);
+            *rx_size = r;
+            *tx_base = (uint16_t)(W5100_TX_BASE + toff);
+            *tx_size = t;
+        }
+        roff = (uint16_t)(roff + r);
+        toff = (uint16_t)(toff + t);
+    }
+}
+
+/* ---- data movement ---- */
+
+/* TCP: push the pending TX bytes into the socket as far as it takes them. */
+static void send_stream(int n)
+{
+    wsock_t *s = &g_ws[n];
+    while (s->tx_rd != s->tx_wr) {
+        uint16_t pend = (uint16_t)(s->tx_wr - s->tx_rd);
+        uint16_t off = s->tx_rd & (s->tx_size - 1);
+        uint16_t len = pend;
+        if (len > s->tx_size - off) len = s->tx_size - off;   /* up to the wrap */
+        fpga_mem_read(A2SPACE_W5100, s->tx_base + off, g_io, len);
+        ssize_t r = send(s->fd, g_io, len, 0);
+        if (r < 0) {
+            if (would_block())
+                break;
+            g_stats.errors++;
+            drop(n, W5100_IR_DISCON);
+            return;
+        }
+        s->tx_rd = (uint16_t)(s->tx_rd + r);
+        g_stats.tx_bytes += (uint32_t)r;
+        if (r < len)
+            break;
+    }
+    publish_tx(n);
+    if (s->tx_rd == s->tx_wr) {
+        s->sending = false;
+        raise_ir(n, W5100_IR_SEND_OK);
+    }
+}
+
+/* UDP/IPRAW: everything between Sn_TX_RD and Sn_TX_WR is one datagram. */
+static void send_datagram(int n)
+{
+    wsock_t *s = &g_ws[n];
+    uint16_t len = (uint16_t)(s->tx_wr - s->tx_rd);
+    if (len > s->tx_size)
+        len = 0;                               /* bogus pointers: resync */
+    if (len) {
+        struct sockaddr_in to;
+        dest_addr(n, &to);
+        ring_read(s->tx_base, s->tx_size, s->tx_rd, g_io, len);
+        if (sendto(s->fd, g_io, len, 0, (struct sockaddr *)&to, sizeof(to)) < 0) {
+            if (errno == EAGAIN || errno == ENOMEM)
+                return;                        /* out of buffers: retry next poll */
+            g_stats.errors++;
+            raise_ir(n, W5100_IR_TIMEOUT);     /* unreachable, like an ARP timeout */
+        } else {
+            g_stats.tx_bytes += len;
+        }
+    }
+    s->tx_rd = s->tx_wr;
+    s->sending = false;
+    publish_tx(n);
+    raise_ir(n, W5100_IR_SEND_OK);
+}
+
+/* TCP: fill free RX ring space from the socket. */
+static void recv_stream(int n)
+{
+    wsock_t *s = &g_ws[n];
+    for (int pass = 0; pass < 2 && !s->eof; pass++) {   /* 2: across the wrap */
+        uint16_t space = (uint16_t)(s->rx_size - (uint16_t)(s->rx_wr - s->rx_rd));
+        if (space == 0)
+            return;
+        uint16_t off = s->rx_wr & (s->rx_size - 1);
+        uint16_t len = space;
+        if (len > s->rx_size - off) len = s->rx_size - off;
+        ssize_t r = recv(s->fd, g_io, len, 0);
+        if (r > 0) {
+            fpga_mem_write(A2SPACE_W5100, s->rx_base + off, g_io, (uint16_t)r);
+            s->rx_wr = (uint16_t)(s->rx_wr + r);
+            g_stats.rx_bytes += (uint32_t)r;
+            publish_rsr(n);
+            raise_ir(n, W5100_IR_RECV);
+            if (r < len)
+                return;
+        } else if (r == 0) {
+            /* Peer FIN: our own FIN already went out on DISCON, so that
+             * finishes the close; otherwise wait for the Apple II's. */
+            s->eof = true;
+            if (s->status == W5100_SOCK_FIN_WAIT) {
+                drop(n, W5100_IR_DISCON);
+            } else {
+                set_status(n, W5100_SOCK_CLOSE_WAIT);
+                raise_ir(n, W5100_IR_DISCON);
+            }
+            return;
+        } else {
+            if (!would_block()) {
+                g_stats.errors++;
+                drop(n, W5100_IR_DISCON);         /* reset by peer */
+            }
+            return;
+        }
+    }
+}
+
+/* UDP/IPRAW: move whole datagrams into the RX ring while they fit. */
+static void recv_datagram(int n)
+{
+    wsock_t *s = &g_ws[n];
+    uint16_t hdr = s->mode == W5100_MR_UDP ? UDP_HDR : RAW_HDR;
+    for (int k = 0; k < 4; k++) {
+        struct sockaddr_in from;
+        socklen_t fl = sizeof(from);
+        ssize_t r = recvfrom(s->fd, g_io, sizeof(g_io), MSG_PEEK,
+                             (struct sockaddr *)&from, &fl);
+        if (r < 0)
+            return;
+        uint16_t skip = 0;
+        if (s->mode == W5100_MR_IPRAW && r >= 20)
+            skip = (uint16_t)((g_io[0] & 0x0F) * 4);   /* raw reads carry the IP header */
+        uint16_t plen = (uint16_t)(r - skip);
+        uint16_t rec = (uint16_t)(hdr + plen);
+        uint16_t space = (uint16_t)(s->rx_size - (uint16_t)(s->rx_wr - s->rx_rd));
+        if (rec > s->rx_size) {
+            recv(s->fd, g_io, sizeof(g_io), 0);   /* can never fit: drop it */
+            g_stats.errors++;
+            continue;
+        }
+        if (rec > space)
+            return;                               /* wait for the Apple II */
+        recv(s->fd, g_io, sizeof(g_io), 0);       /* consume the peeked one */
+
+        uint8_t h[UDP_HDR];
+        memcpy(h, &from.sin_addr.s_addr, 4);
+        if (hdr == UDP_HDR) {
+            uint16_t port = ntohs(from.sin_port);
+            h[4] = (uint8_t)(port >> 8);
+            h[5] = (uint8_t)port;
+        }
+        h[hdr - 2] = (uint8_t)(plen >> 8);
+        h[hdr - 1] = (uint8_t)plen;
+        ring_write(s->rx_base, s->rx_size, s->rx_wr, h, hdr);
+        ring_write(s->rx_base, s->rx_size, (uint16_t)(s->rx_wr + hdr), g_io + skip, plen);
+        s->rx_wr = (uint16_t)(s->rx_wr + rec);
+        g_stats.rx_bytes += plen;
+        publish_rsr(n);
+        raise_ir(n, W5100_IR_RECV);
+    }
+}
+
+/* ---- commands ---- */
+void w5100_sock_open(int n, uint8_t mode)
+{
+    wsock_t *s = &g_ws[n];
+    release(s);
+    s->mode = mode;
+    clear_ir(n, 0x1F);
+
+    uint8_t rmsr = 0, tmsr = 0;
+    fpga_mem_read(A2SPACE_W5100, W5100_RMSR, &rmsr, 1);
+    fpga_mem_read(A2SPACE_W5100, W5100_TMSR, &tmsr, 1);
+    w5100_sock_layout(n, rmsr, tmsr, &s->rx_base, &s->rx_size,
+                      &s->tx_base, &s->tx_size);
+    s->rx_wr = s->rx_rd = s->tx_rd = s->tx_wr = 0;
+    sn_wr16(n, W5100_Sn_TX_RD, 0);
+    sn_wr16(n, W5100_Sn_TX_WR, 0);
+    sn_wr16(n, W5100_Sn_RX_RD, 0);
+    sn_wr16(n, W5100_Sn_RX_RSR, 0);
+    sn_wr16(n, W5100_Sn_TX_FSR, s->tx_size);
+
+    int type, proto = 0;
+    uint8_t st;
+    switch (mode) {
+    case W5100_MR_TCP:   type = SOCK_STREAM; st = W5100_SOCK_INIT;  break;
+    case W5100_MR_UDP:   type = SOCK_DGRAM;  st = W5100_SOCK_UDP;   break;
+    case W5100_MR_IPRAW:
+        type = SOCK_RAW;
+        st = W5100_SOCK_IPRAW;
+        proto = sn_rd8(n, W5100_Sn_PROTO);
+        break;
+    default:
+        set_status(n, W5100_SOCK_CLOSED);
+        return;
+    }
+    if (s->rx_size == 0 || s->tx_size == 0) {      /* no buffer left for it */
+        set_status(n, W5100_SOCK_CLOSED);
+        return;
+    }
+
+    s->fd = socket(AF_INET, type, proto);
+    if (s->fd < 0) {
+        g_stats.errors++;
+        set_status(n, W5100_SOCK_CLOSED);
+        return;
+    }
+    s->open = true;
+    set_nonblock(s->fd);
+
+    uint16_t port = sn_rd16(n, W5100_Sn_PORT);
+    if (mode != W5100_MR_IPRAW && port) {
+        int one = 1;
+        setsockopt(s->fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        struct sockaddr_in sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sin_family = AF_INET;
+        sa.sin_port = htons(port);
+        sa.sin_addr.s_addr = htonl(INADDR_ANY);
+        if (bind(s->fd, (struct sockaddr *)&sa, sizeof(sa)) < 0) {
+            g_stats.errors++;
+            drop(n, 0);
+            return;
+        }
+    }
+    g_stats.opens++;
+    set_status(n, st);
+}
+
+void w5100_sock_command(int n, uint8_t cmd)
+{
+    wsock_t *s = &g_ws[n];
+    bool tcp = s->mode == W5100_MR_TCP;
+
+    switch (cmd) {
+    case W5100_CR_LISTEN:
+        if (!s->open || !tcp || s->status != W5100_SOCK_INIT)
+            break;
+        if (listen(s->fd, 1) < 0) {
+            g_stats.errors++;
+            drop(n, 0);
+        } else {
+            set_status(n, W5100_SOCK_LISTEN);
+        }
+        break;
+
+    case W5100_CR_CONNECT: {
+        if (!s->open || !tcp || s->status != W5100_SOCK_INIT)
+            break;
+        struct sockaddr_in to;
+        dest_addr(n, &to);
+        if (connect(s->fd, (struct sockaddr *)&to, sizeof(to)) == 0) {
+            g_stats.connects++;
+            established(n);
+        } else if (errno == EINPROGRESS) {
+            set_status(n, W5100_SOCK_SYNSENT);
+        } else {
+            g_stats.errors++;
+            drop(n, W5100_IR_TIMEOUT);
+        }
+        break;
+    }
+
+    case W5100_CR_SEND:
+        if (!s->open)
+            break;
+        if (tcp && s->status != W5100_SOCK_ESTABLISHED &&
+            s->status != W5100_SOCK_CLOSE_WAIT)
+            break;
+        s->tx_wr = sn_rd16(n, W5100_Sn_TX_WR);
+        clear_ir(n, W5100_IR_SEND_OK);
+        s->sending = true;
+        if (tcp)
+            send_stream(n);
+        else
+            send_datagram(n);
+        break;
+
+    case W5100_CR_RECV:
+        if (!s->open)
+            break;
+        s->rx_rd = sn_rd16(n, W5100_Sn_RX_RD);
+        clear_ir(n, W5100_IR_RECV);
+        publish_rsr(n);
+        break;
+
+    case W5100_CR_DISCON:
+        if (s->open && tcp && s->status == W5100_SOCK_ESTABLISHED) {
+            shutdown(s->fd, SHUT_WR);              /* FIN; wait for the peer's */
+            set_status(n, W5100_SOCK_FIN_WAIT);
+        } else if (s->open && tcp && s->status == W5100_SOCK_CLOSE_WAIT) {
+            drop(n, W5100_IR_DISCON);
+        } else {
+            drop(n, 0);
+        }
+        break;
+
+    case W5100_CR_CLOSE:
+        drop(n, 0);
+        break;
+
+    default:
+        break;
+    }
+}
+
+/* ---- poll ---- */
+static void service(int n)
+{
+    wsock_t *s = &g_ws[n];
+
+    switch (s->status) {
+    case W5100_SOCK_LISTEN: {
+        struct sockaddr_in peer;
+        socklen_t pl = sizeof(peer);
+        int fd = accept(s->fd, (struct sockaddr *)&peer, &pl);
+        if (fd < 0) {
+            if (!would_block())
+                g_stats.errors++;
+            return;
+        }
+        /* The W5100 turns the listening socket itself into the connection. */
+        close(s->fd);
+        s->fd = fd;
+        set_nonblock(fd);
+        fpga_mem_write(A2SPACE_W5100, sn_reg(n, W5100_Sn_DIPR),
+                       (const uint8_t *)&peer.sin_addr.s_addr, 4);
+        sn_wr16(n, W5100_Sn_DPORT, ntohs(peer.sin_port));
+        g_stats.accepts++;
+        established(n);
+        return;
+    }
+
+    case W5100_SOCK_SYNSENT: {
+        /* A repeated connect reports how the first one went. */
+        struct sockaddr_in to;
+        dest_addr(n, &to);
+        if (connect(s->fd, (struct sockaddr *)&to, sizeof(to)) == 0 ||
+            errno == EISCONN) {
+            g_stats.connects++;
+            established(n);
+        } else if (errno != EALREADY && errno != EINPROGRESS) {
+            g_stats.errors++;
+            drop(n, W5100_IR_TIMEOUT);
+        }
+        return;
+    }
+
+    case W5100_SOCK_ESTABLISHED:
+    case W5100_SOCK_CLOSE_WAIT:
+    case W5100_SOCK_FIN_WAIT:
+        if (s->sending)
+            send_stream(n);
+        if (s->open)
+            recv_stream(n);
+        return;
+
+    case W5100_SOCK_UDP:
+    case W5100_SOCK_IPRAW:
+        if (s->sending)
+            send_datagram(n);
+        recv_datagram(n);
+        return;
+
+    default:
+        return;
+    }
+}
+
+void w5100_sock_poll(void)
+{
+    if (!w5100_sock_active())
+        return;
+    fpga_link_lock();
+    for (int n = 0; n < W5100_NUM_SOCKETS; n++)
+        if (g_ws[n].open)
+            service(n);
+    fpga_link_unlock();
+}
+
+void w5100_sock_init(void)
+{
+    for (int n = 0; n < W5100_NUM_SOCKETS; n++)
+        release(&g_ws[n]);
+    memset(g_ws, 0, sizeof(g_ws));
+    memset(&g_stats, 0, sizeof(g_stats));
+}
+
+bool w5100_sock_active(void)
+{
+    for (int n = 0; n < W5100_NUM_SOCKETS; n++)
+        if (g_ws[n].open)
+            return true;
+    return false;
+}
+
+void w5100_sock_stats(w5100_sock_stats_t *out)
+{
+    *out = g_stats;
+}
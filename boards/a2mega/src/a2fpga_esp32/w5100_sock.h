@@ -0,0 +1,70 @@
+/*
+ * w5100_sock.h -- W5100 hardware socket engine (TCP / UDP / IPRAW) for the
+ * A2FPGA Uthernet II card, offloaded to the ESP32's lwIP stack.
+ *
+ * w5100.c owns the doorbell and MACRAW; every other socket mode lands here.
+ * Each W5100 socket opened in TCP, UDP or IPRAW mode is backed by a
+ * non-blocking BSD socket, and the engine moves data between that socket and
+ * the socket's TX/RX rings in the card's backing store (XFER SPACE 3),
+ * honouring Sn_TX_RD/WR, Sn_RX_RD/RSR and the RMSR/TMSR buffer split the
+ * same way a real W5100 does. Checksums, retransmission and reassembly are
+ * lwIP's job, so the Apple II drives sockets at register level instead of
+ * running a TCP stack of its own.
+ *
+ * Connections use the ESP32's own address (DHCP or the static config):
+ * SIPR/GAR/SUBR written by the Apple II are not used by offloaded sockets.
+ *
+ * Only plain BSD socket calls and fpga_mem_read/write are used, so the host
+ * tests build this file unchanged against a RAM-backed SPACE 3.
+ */
+
+#ifndef _W5100_SOCK_H
+#define _W5100_SOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Buffer placement for socket n under RMSR/TMSR: sockets take their 1/2/4/8
+ * KB in order from the 8 KB region; a socket that does not fit gets size 0. */
+void w5100_sock_layout(int n, uint8_t rmsr, uint8_t tmsr,
+                       uint16_t *rx_base, uint16_t *rx_size,
+                       uint16_t *tx_base, uint16_t *tx_size);
+
+/* Close every offloaded socket and forget its state. */
+void w5100_sock_init(void);
+
+/* Sn_CR = OPEN for a non-MACRAW mode (Sn_MR protocol field). TCP goes to
+ * SOCK_INIT, UDP to SOCK_UDP, IPRAW to SOCK_IPRAW; anything else is parked
+ * CLOSED. Caller holds the FPGA link lock. */
+void w5100_sock_open(int n, uint8_t mode);
+
+/* Any other Sn_CR on a socket opened with w5100_sock_open (LISTEN, CONNECT,
+ * DISCON, CLOSE, SEND, RECV). Caller holds the FPGA link lock. */
+void w5100_sock_command(int n, uint8_t cmd);
+
+/* Progress connects/accepts, finish pending sends and pull received data into
+ * the RX rings. Cheap when nothing is open; call every w5100_poll. */
+void w5100_sock_poll(void);
+
+/* True while any socket is open in the engine. */
+bool w5100_sock_active(void);
+
+typedef struct {
+    uint32_t opens;
+    uint32_t connects;      /* outgoing connections established */
+    uint32_t accepts;       /* incoming connections accepted on LISTEN */
+    uint32_t tx_bytes;      /* Apple II -> network payload */
+    uint32_t rx_bytes;      /* network -> Apple II payload (ring headers excl.) */
+    uint32_t errors;        /* failed socket calls, refused/reset connections */
+} w5100_sock_stats_t;
+void w5100_sock_stats(w5100_sock_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _W5100_SOCK_H */
@@ -3,22 +3,30 @@
  * See wifi_bridge.h for the MAC-NAT architecture and the exact rewrite rules.
  *
  * Task model:
- *   - The WiFi driver task delivers frames to bridge_rxcb(); it only copies the
- *     ones the bridge wants into a lock-free SPSC ring and forwards every frame
- *     to esp_netif_receive() so the ESP32's own lwIP keeps working.
+ *   - The WiFi driver task delivers frames to bridge_rxcb(); it filters on
+ *     destination MAC (and, if net_ip_only is set, EtherType) before copying, copies the ones the bridge
+ *     wants into a pooled frame buffer queued on a lock-free SPSC ring, and
+ *     forwards every frame to esp_netif_receive() so the ESP32's own lwIP
+ *     keeps working.
  *   - wifi_bridge_poll() (main loop, same task as w5100_poll) drains the ring,
  *     applies ingress MAC NAT, and hands frames to w5100_macraw_rx(), which
- *     does the (slow) FPGA-link writes outside the WiFi task.
+ *     does the (slow) FPGA-link writes outside the WiFi task. A frame the
+ *     MACRAW RX ring has no room for is parked at the head of the queue and
+ *     retried on the next poll, so bursts wait for the 6502 instead of being
+ *     dropped.
  *   - w5100_bridge_tx() runs in the main loop (called from w5100_poll's SEND
  *     handler): egress MAC NAT + esp_wifi_internal_tx().
  */
 
 #include "wifi_bridge.h"
 #include "w5100.h"
+#include "settings.h"           /* net_ip_only ingress filter */
 
 #include <string.h>
 
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_netif.h"
@@ -45,22 +53,109 @@ static bool         s_static_applied;   /* status flag for net_connected() */
 static uint8_t      s_cfg_ip[4], s_cfg_mask[4], s_cfg_gw[4];
 
 /* Diagnostics */
-static volatile uint32_t s_rx_drop_ring;   /* ingress dropped: SPSC ring full */
 static volatile uint32_t s_tx_err;         /* esp_wifi_internal_tx failures */
+static wifi_bridge_stats_t s_st;           /* ingress counters (wifi_bridge_stats) */
+
+/* ---- ingress frame pool ----
+ * Received frames are copied into fixed-size buffers from a pool allocated
+ * at init: BR_POOL_PSRAM of them when the module has PSRAM, else
+ * BR_POOL_INTERNAL from internal RAM (the a2mega's N8 module has none). Each
+ * buffer has a reference-counted descriptor; descriptor indices move through
+ * two SPSC rings:
+ *   s_rxq    WiFi task -> main loop   frames waiting for the Apple II
+ *   s_freeq  main loop -> WiFi task   buffers whose last reference is gone
+ * The queue owns the reference taken by br_alloc(); the main loop drops it
+ * once the frame is delivered or discarded, and any other holder adds its
+ * own before that. br_unref() pushes to s_freeq, so it must only run in the
+ * main loop (the ring's one producer).
+ * A frame is lost at ingress only when the whole pool is held. */
+#ifndef BR_POOL_PSRAM
+#define BR_POOL_PSRAM     192       /* ~290 KB: several TCP windows */
+#endif
+#ifndef BR_POOL_INTERNAL
+#define BR_POOL_INTERNAL  24        /* ~36 KB */
+#endif
+#define BR_Q_SLOTS        256       /* power of two, >= either pool size */
+#define BR_Q_MASK         (BR_Q_SLOTS - 1)
+_Static_assert((BR_Q_SLOTS & BR_Q_MASK) == 0, "BR_Q_SLOTS must be a power of two");
+_Static_assert(BR_Q_SLOTS >= BR_POOL_PSRAM && BR_Q_SLOTS >= BR_POOL_INTERNAL,
+               "every pooled frame needs a slot in s_frame[] and both rings");
+#define BR_BUF_SIZE       ((W5100_RX_HEADROOM + W5100_MAX_FRAME + 3) & ~3)
+#define BR_PARK_MAX_US    500000    /* parked longer than this: stale, dropped */
 
-/* ---- ingress SPSC ring (producer: WiFi task, consumer: main loop) ---- */
-#define BR_RX_SLOTS 8               /* power of two */
-#define BR_RX_MASK  (BR_RX_SLOTS - 1)
 typedef struct {
+    uint8_t *buf;           /* BR_BUF_SIZE bytes; the frame starts at
+                             * buf + W5100_RX_HEADROOM (record header room) */
     uint16_t len;
-    uint8_t  buf[W5100_MAX_FRAME];
-} rx_slot_t;
-static rx_slot_t s_rx[BR_RX_SLOTS];
-static uint32_t  s_rx_head;         /* written by producer only */
-static uint32_t  s_rx_tail;         /* written by consumer only */
+    uint8_t  refs;
+    bool     parked;        /* refused once for lack of RX ring space */
+    int64_t  t_rx;          /* arrival (esp_timer_get_time) */
+} br_frame_t;
+
+static uint8_t   *s_pool;
+static uint32_t   s_pool_n;
+static br_frame_t s_frame[BR_Q_SLOTS];
+static uint16_t   s_rxq[BR_Q_SLOTS];
+static uint32_t   s_rxq_head;       /* written by the WiFi task only */
+static uint32_t   s_rxq_tail;       /* written by the main loop only */
+static uint16_t   s_freeq[BR_Q_SLOTS];
+static uint32_t   s_freeq_head;     /* written by the main loop only */
+static uint32_t   s_freeq_tail;     /* written by the WiFi task only */
+
+static void br_pool_init(void)
+{
+    if (s_pool)
+        return;
+    s_pool = heap_caps_malloc((size_t)BR_POOL_PSRAM * BR_BUF_SIZE,
+                              MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (s_pool) {
+        s_pool_n = BR_POOL_PSRAM;
+    } else {
+        s_pool = heap_caps_malloc((size_t)BR_POOL_INTERNAL * BR_BUF_SIZE,
+                                  MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        s_pool_n = s_pool ? BR_POOL_INTERNAL : 0;
+    }
+    for (uint32_t i = 0; i < s_pool_n; i++) {
+        s_frame[i].buf = s_pool + (size_t)i * BR_BUF_SIZE;
+        s_frame[i].refs = 0;
+        s_freeq[i] = (uint16_t)i;
+    }
+    s_freeq_tail = 0;
+    __atomic_store_n(&s_freeq_head, s_pool_n, __ATOMIC_RELEASE);
+    s_st.pool = s_pool_n;
+    ESP_LOGI(TAG, "ingress pool: %lu frames (%s)", (unsigned long)s_pool_n,
+             s_pool_n == BR_POOL_PSRAM ? "PSRAM" :
+             s_pool_n ? "internal RAM" : "DISABLED");
+}
 
-/* Egress scratch (main-loop task only; w5100_bridge_tx gets a const frame) */
-static uint8_t s_tx_buf[W5100_MAX_FRAME];
+/* WiFi task: take a free buffer (refs = 1), or -1 when the pool is dry. */
+static int br_alloc(void)
+{
+    uint32_t tail = __atomic_load_n(&s_freeq_tail, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&s_freeq_head, __ATOMIC_ACQUIRE);
+    if (tail == head)
+        return -1;
+    int i = s_freeq[tail & BR_Q_MASK];
+    __atomic_store_n(&s_freeq_tail, tail + 1, __ATOMIC_RELEASE);
+    s_frame[i].refs = 1;
+
+    uint32_t held = s_pool_n - (head - (tail + 1));
+    s_st.in_use = held;
+    if (held > s_st.hwm)
+        s_st.hwm = held;
+    return i;
+}
+
+/* Main loop only: drop a reference, recycling the buffer on the last one. */
+static void br_unref(int i)
+{
+    if (__atomic_sub_fetch(&s_frame[i].refs, 1, __ATOMIC_ACQ_REL) != 0)
+        return;
+    uint32_t head = __atomic_load_n(&s_freeq_head, __ATOMIC_RELAXED);
+    s_freeq[head & BR_Q_MASK] = (uint16_t)i;
+    __atomic_store_n(&s_freeq_head, head + 1, __ATOMIC_RELEASE);
+    s_st.in_use = s_pool_n - (head + 1 - __atomic_load_n(&s_freeq_tail, __ATOMIC_ACQUIRE));
+}
 
 /* =========================================================================
  * Pure frame-fixup helpers (no ESP dependencies; unit-testable)
@@ -171,6 +266,21 @@ volatile uint32_t wifi_dbg_disconnects = 0;
 volatile uint32_t wifi_dbg_last_reason = 0;
 volatile uint32_t wifi_dbg_rx_ucast = 0;
 
+/* Early ingress filter, applied before anything is copied: the Apple II only
+ * sees frames addressed to the station (rewritten to SHAR later) or to a
+ * broadcast/multicast group -- whatever their EtherType, as a MACRAW socket
+ * would. settings()->net_ip_only narrows that to IPv4 and ARP. */
+static bool br_wanted(const uint8_t *f)
+{
+    bool mcast = (f[0] & 0x01) != 0;                    /* covers broadcast */
+    if (!mcast && memcmp(f, s_sta_mac, 6) != 0)
+        return false;
+    if (!settings()->net_ip_only)
+        return true;
+    uint16_t type = rd_be16(f + 12);
+    return type == 0x0800 || type == 0x0806;            /* IPv4, ARP */
+}
+
 static esp_err_t bridge_rxcb(void *buffer, uint16_t len, void *eb)
 {
     const uint8_t *f = (const uint8_t *)buffer;
@@ -179,20 +289,24 @@ static esp_err_t bridge_rxcb(void *buffer, uint16_t len, void *eb)
     if (len >= 14 && memcmp(f, s_sta_mac, 6) == 0)
         wifi_dbg_rx_ucast++;
 
-    if (len >= 14 && len <= W5100_MAX_FRAME && w5100_macraw_active()) {
-        bool mcast = (f[0] & 0x01) != 0;                    /* covers broadcast */
-        bool tous  = (memcmp(f, s_sta_mac, 6) == 0);
-        if (mcast || tous) {
-            uint32_t head = __atomic_load_n(&s_rx_head, __ATOMIC_RELAXED);
-            uint32_t tail = __atomic_load_n(&s_rx_tail, __ATOMIC_ACQUIRE);
-            if (head - tail < BR_RX_SLOTS) {
-                rx_slot_t *slot = &s_rx[head & BR_RX_MASK];
-                memcpy(slot->buf, f, len);
-                slot->len = len;
-                __atomic_store_n(&s_rx_head, head + 1, __ATOMIC_RELEASE);
-            } else {
-                s_rx_drop_ring++;
-            }
+    if (len >= 14 && w5100_macraw_active()) {
+        int i;
+        if (!br_wanted(f)) {
+            s_st.drop_filter++;
+        } else if (len > W5100_MAX_FRAME) {
+            s_st.drop_len++;
+        } else if ((i = br_alloc()) < 0) {
+            s_st.drop_pool++;
+        } else {
+            br_frame_t *fr = &s_frame[i];
+            memcpy(fr->buf + W5100_RX_HEADROOM, f, len);
+            fr->len = len;
+            fr->parked = false;
+            fr->t_rx = esp_timer_get_time();
+            uint32_t head = __atomic_load_n(&s_rxq_head, __ATOMIC_RELAXED);
+            s_rxq[head & BR_Q_MASK] = (uint16_t)i;
+            __atomic_store_n(&s_rxq_head, head + 1, __ATOMIC_RELEASE);
+            s_st.queued++;
         }
     }
 
@@ -205,37 +319,71 @@ static esp_err_t bridge_rxcb(void *buffer, uint16_t len, void *eb)
 
 void wifi_bridge_poll(void)
 {
-    uint32_t tail = __atomic_load_n(&s_rx_tail, __ATOMIC_RELAXED);
-    uint32_t head = __atomic_load_n(&s_rx_head, __ATOMIC_ACQUIRE);
+    uint32_t tail = __atomic_load_n(&s_rxq_tail, __ATOMIC_RELAXED);
+    uint32_t head = __atomic_load_n(&s_rxq_head, __ATOMIC_ACQUIRE);
 
     while (tail != head) {
-        rx_slot_t *slot = &s_rx[tail & BR_RX_MASK];
+        int i = s_rxq[tail & BR_Q_MASK];
+        br_frame_t *fr = &s_frame[i];
+        uint8_t *frame = fr->buf + W5100_RX_HEADROOM;
 
         uint8_t apple[6];
         bool have_apple = s_apple_valid ? (memcpy(apple, s_apple_mac, 6), true)
                                         : w5100_get_mac(apple);
-        if (have_apple)
-            wifi_bridge_fixup_ingress(slot->buf, slot->len, apple, s_sta_mac);
-
-        w5100_macraw_rx(slot->buf, slot->len);
+        if (have_apple)   /* idempotent: a parked frame is simply redone */
+            wifi_bridge_fixup_ingress(frame, fr->len, apple, s_sta_mac);
+
+        w5100_rx_result_t r = w5100_macraw_rx(frame, fr->len);
+        uint32_t age = (uint32_t)(esp_timer_get_time() - fr->t_rx);
+        if (r == W5100_RX_FULL) {
+            /* Back-pressure: leave it at the head (keeps frame order) until
+             * the Apple II frees ring space, unless it has gone stale. */
+            if (age < BR_PARK_MAX_US) {
+                if (!fr->parked) {
+                    fr->parked = true;
+                    s_st.parks++;
+                }
+                break;
+            }
+            s_st.drop_stale++;
+        } else if (r == W5100_RX_OK) {
+            s_st.delivered++;
+            if (fr->parked && age > s_st.park_max_us)
+                s_st.park_max_us = age;
+        } else {
+            s_st.drop_reject++;
+        }
 
         tail++;
-        __atomic_store_n(&s_rx_tail, tail, __ATOMIC_RELEASE);
-        head = __atomic_load_n(&s_rx_head, __ATOMIC_ACQUIRE);
+        __atomic_store_n(&s_rxq_tail, tail, __ATOMIC_RELEASE);
+        br_unref(i);
+        head = __atomic_load_n(&s_rxq_head, __ATOMIC_ACQUIRE);
     }
 }
 
+void wifi_bridge_stats(wifi_bridge_stats_t *out)
+{
+    *out = s_st;
+}
+
+void wifi_bridge_stats_reset(void)
+{
+    uint32_t pool = s_st.pool, in_use = s_st.in_use;
+    memset(&s_st, 0, sizeof(s_st));
+    s_st.pool = pool;
+    s_st.in_use = in_use;
+    s_st.hwm = in_use;
+}
+
 /* =========================================================================
  * w5100.h bridge hooks (override the weak stubs in w5100.c)
  * ========================================================================= */
 
-void w5100_bridge_tx(const uint8_t *frame, uint32_t len)
+void w5100_bridge_tx(uint8_t *frame, uint32_t len)
 {
     if (!s_started || !s_link_up || len < 14 || len > W5100_MAX_FRAME)
         return;
 
-    memcpy(s_tx_buf, frame, len);
-
     uint8_t apple[6];
     const uint8_t *inner = s_sta_mac;   /* unknown SHAR: ARP compare is a no-op */
     if (s_apple_valid)
@@ -243,9 +391,9 @@ void w5100_bridge_tx(const uint8_t *frame, uint32_t len)
     else if (w5100_get_mac(apple))
         inner = apple;
 
-    wifi_bridge_fixup_egress(s_tx_buf, (uint16_t)len, inner, s_sta_mac);
+    wifi_bridge_fixup_egress(frame, (uint16_t)len, inner, s_sta_mac);
 
-    int r = esp_wifi_internal_tx(WIFI_IF_STA, s_tx_buf, (uint16_t)len);
+    int r = esp_wifi_internal_tx(WIFI_IF_STA, frame, (uint16_t)len);
     if (r != 0) {
         if ((++s_tx_err & 0x3F) == 1)   /* rate-limited */
             ESP_LOGW(TAG, "raw tx failed (%d), %lu total", r, (unsigned long)s_tx_err);
@@ -401,6 +549,7 @@ bool wifi_bridge_init(const char *ssid, const char *psk)
     if (!s_netif) return false;
 
     apply_ip_config();   /* honor a static config set before init */
+    br_pool_init();
 
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     err = esp_wifi_init(&cfg);
@@ -55,6 +55,26 @@ void wifi_bridge_config_ip(bool dhcp, const uint8_t ip[4],
  * loop (same task) as w5100_poll(); ~1 kHz cadence recommended. */
 void wifi_bridge_poll(void);
 
+/* Ingress pool and back-pressure counters. Frames that find the MACRAW RX
+ * ring full are parked (kept, in order) and retried each poll; drops are
+ * split by cause. */
+typedef struct {
+    uint32_t pool;          /* frame buffers in the ingress pool */
+    uint32_t in_use;        /* buffers held now (queued or parked) */
+    uint32_t hwm;           /* most buffers held at once since reset */
+    uint32_t queued;        /* frames copied into the pool */
+    uint32_t delivered;     /* frames written to the MACRAW RX ring */
+    uint32_t parks;         /* frames that had to wait for RX ring space */
+    uint32_t park_max_us;   /* longest arrival-to-delivery time of a parked frame */
+    uint32_t drop_filter;   /* not for the bridge: dst MAC (/ EtherType) */
+    uint32_t drop_len;      /* longer than W5100_MAX_FRAME */
+    uint32_t drop_pool;     /* every pool buffer held */
+    uint32_t drop_stale;    /* parked longer than the park limit (500 ms) */
+    uint32_t drop_reject;   /* refused by w5100_macraw_rx (closed, MAC filter) */
+} wifi_bridge_stats_t;
+void wifi_bridge_stats(wifi_bridge_stats_t *out);
+void wifi_bridge_stats_reset(void);
+
 /* ---- net status helpers (also declared in net_status.h) ---- */
 const char *net_ssid(void);      /* configured SSID ("" before init) */
 bool        net_connected(void); /* associated AND got a DHCP lease */
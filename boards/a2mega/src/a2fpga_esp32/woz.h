@@ -0,0 +1,78 @@
+/*
+ * woz.h — Applesauce WOZ 1.0 / 2.0 floppy images for the Disk II server.
+ *
+ * A WOZ image stores every (quarter-)track as the raw bitstream the drive head
+ * sees, so copy-protected titles with non-standard fields, odd track lengths
+ * or self-sync tricks survive intact. Layout: a 12-byte header ("WOZ1"/"WOZ2",
+ * FF 0A 0D 0A, CRC-32), then chunks (4-byte id, 4-byte LE size):
+ *   INFO  disk type, write-protect flag, ...
+ *   TMAP  160 quarter-track entries (track*4 + q), each a TRKS index or $FF
+ *   TRKS  WOZ1: 6656-byte records, bitstream first (6646 B), bit count at +6648
+ *         WOZ2: 160 x {start block, block count, bit count}; bitstreams live
+ *               at 512-byte blocks elsewhere in the file
+ *
+ * woz_parse() walks the chunks once at mount and caches every quarter-track's
+ * bitstream offset and bit count, so serving a track is one contiguous read.
+ * The FPGA Disk II (hdl/disk/drive_ii.sv) plays a byte-wide nibble window per
+ * whole track, so woz_bits_to_nibbles() frames the bitstream the way the
+ * Disk II data latch does (shift in, emit on MSB) — no sector decode — and
+ * woz_nibbles_to_bits() turns a rewritten window back into a bitstream of the
+ * track's original length for write-back into TRKS.
+ *
+ * Pure C, no MCU / FPGA / filesystem dependencies — unit-testable off-target.
+ */
+#ifndef _WOZ_H
+#define _WOZ_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WOZ_HDR_BYTES     12u
+#define WOZ_CRC_OFFSET    8u      /* header CRC-32; 0 = "not computed"   */
+#define WOZ_QTRACKS       160u    /* TMAP entries (quarter tracks)       */
+#define WOZ_TRACKS        40u     /* whole tracks addressable via TMAP   */
+#define WOZ_TMAP_EMPTY    0xFFu
+
+/* Per-quarter-track bitstream location, cached at mount. bits == 0: no data
+ * (unformatted / TMAP $FF). */
+typedef struct {
+    uint32_t off;    /* byte offset of the bitstream within the file */
+    uint32_t bits;   /* bitstream length in bits                     */
+} woz_trk_t;
+
+typedef struct {
+    uint8_t   version;          /* 1 or 2                            */
+    bool      write_protected;  /* INFO flag: serve read-only        */
+    woz_trk_t qtrk[WOZ_QTRACKS];
+} woz_image_t;
+
+/* File access for woz_parse(): read len bytes at byte offset off; true on a
+ * full read. */
+typedef bool (*woz_read_fn)(void *ctx, uint32_t off, void *buf, uint32_t len);
+
+/* Parse a WOZ1/WOZ2 image of file_size bytes. Returns false (and leaves *img
+ * unspecified) if it is not a 5.25" WOZ image this code can serve. */
+bool woz_parse(woz_read_fn rd, void *ctx, uint32_t file_size, woz_image_t *img);
+
+/* Frame a circular bitstream (MSB-first) into disk nibbles as the Disk II
+ * latch would, starting at bit 0 once the latch has synced over one full
+ * revolution. Stores at most cap nibbles; returns the number stored. */
+size_t woz_bits_to_nibbles(const uint8_t *bits, uint32_t nbits,
+                           uint8_t *out, size_t cap);
+
+/* Serialize n nibbles into exactly nbits bits (MSB-first): an $FF that
+ * follows an $FF is written as a 10-bit self-sync byte; a stream shorter
+ * than nbits is padded with sync bytes, a longer one is cut at nbits. */
+void woz_nibbles_to_bits(const uint8_t *nib, size_t n,
+                         uint8_t *bits, uint32_t nbits);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _WOZ_H */
@@ -0,0 +1,24 @@
+/*
+ * check.h — the CHECK() macro shared by the host-side firmware tests.
+ *
+ * CHECK(cond, fmt, ...) counts a failed condition in s_fail and prints the
+ * first CHECK_MAX_REPORTS of them with file:line and the formatted message;
+ * a test ends with "=== FAILED: <s_fail> checks ===" or "=== PASSED ===".
+ * Each test is a single translation unit, so s_fail lives here.
+ *
+ * Tests outside boards/a2mega/tests reach it with -I<path to this dir>.
+ */
+#ifndef _CHECK_H
+#define _CHECK_H
+
+#include <stdio.h>
+
+#define CHECK_MAX_REPORTS 10
+
+static int s_fail;
+
+#define CHECK(c, ...) do { if (!(c) && s_fail++ < CHECK_MAX_REPORTS) {      \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__);    \
+        printf("\n"); } } while (0)
+
+#endif /* _CHECK_H */
@@ -0,0 +1,460 @@
+// Testbench for the apple_memory video prefetch queue and its readout
+//
+// Drives the VGC and hires video read clients against a DDR3 port model
+// (fixed latency, 4-beat bursts) and checks every word served, hit or miss.
+// Sequential reads must wait out only the first burst of a run; the queue
+// keeps the next groups ahead of the reader. Scattered reads miss every
+// time. The per-frame counters (late words, max queue depth) are read the
+// way the ESP32 CLI reads them: through the OSPI connector with page 1
+// selected at register 0x70, then page 0 restored.
+//
+// apple_memory and the connector take SystemVerilog interface ports, so
+// this bench runs under Verilator (--binary --timing), not Icarus.
+`timescale 1ns/1ps
+
+module test_apple_memory_prefetch;
+  // 54 MHz core clock (~18.518 ns period)
+  localparam real CLK_PERIOD_NS = 18.518;
+  localparam real SCLK_HALF_NS  = 8.0 * CLK_PERIOD_NS;
+  localparam      DDR_LAT       = 12;     // clks from rd to the first beat
+  localparam      GAP           = 64;     // idle clks between generator words
+  localparam [20:0] UNIFIED_OFFSET = 21'h010000;
+
+  reg clk = 0;
+  reg rst_n = 0;
+
+  always #(CLK_PERIOD_NS/2.0) clk = ~clk;
+
+  // ---------------------------------------------------------------------
+  // Interfaces
+  // ---------------------------------------------------------------------
+  a2bus_if a2bus();
+  a2mem_if a2mem();
+  mem_port_if #(.PORT_ADDR_WIDTH(21), .DATA_WIDTH(32), .DQM_WIDTH(4), .PORT_OUTPUT_WIDTH(32))
+      main_mem();
+  mem_port_if #(.PORT_ADDR_WIDTH(21), .DATA_WIDTH(32), .DQM_WIDTH(4), .PORT_OUTPUT_WIDTH(32))
+      video_mem();
+  mem_port_if #(.PORT_ADDR_WIDTH(21), .DATA_WIDTH(32), .DQM_WIDTH(4), .PORT_OUTPUT_WIDTH(32))
+      disk_ram();
+  mem_port_if #(.PORT_ADDR_WIDTH(21), .DATA_WIDTH(32), .DQM_WIDTH(4), .PORT_OUTPUT_WIDTH(32))
+      hdd_ram();
+  slotmaker_config_if slotmaker();
+  f18a_gpu_if         gpu();
+  video_control_if    vctl();
+  drive_volume_if     volumes[2]();
+  drive_volume_if     hdd_volumes[2]();
+  a2bus_control_if    a2ctl();
+
+  // Apple II bus idle: no CPU cycles, so no shadow writes
+  assign a2bus.clk_logic = clk;
+  initial begin
+    a2bus.system_reset_n = 1'b0;
+    a2bus.device_reset_n = 1'b0;
+    a2bus.phi1_posedge   = 1'b0;
+    a2bus.rw_n           = 1'b1;
+    a2bus.addr           = 16'h0000;
+    a2bus.data           = 8'h00;
+    a2bus.data_in_strobe = 1'b0;
+    a2bus.m2sel_n        = 1'b1;
+    a2bus.m2b0           = 1'b0;
+  end
+
+  assign main_mem.available = 1'b1;
+  assign main_mem.ready     = 1'b0;
+  assign main_mem.q         = 32'h0;
+
+  // ---------------------------------------------------------------------
+  // DDR3 read port model: one request at a time, DDR_LAT clks, then one
+  // beat (text) or four (burst) on consecutive clks
+  // ---------------------------------------------------------------------
+  function [31:0] ddr_word(input [20:0] a);
+    ddr_word = {~a[15:0], a[15:0]};
+  endfunction
+
+  reg        ddr_busy = 1'b0;
+  reg [20:0] ddr_base;
+  reg [2:0]  ddr_beats, ddr_beat;
+  integer    ddr_wait;
+  integer    ddr_reads = 0;
+
+  assign video_mem.available = !ddr_busy;
+
+  always @(posedge clk) begin
+    video_mem.ready <= 1'b0;
+    if (!ddr_busy) begin
+      if (video_mem.rd) begin
+        ddr_busy  <= 1'b1;
+        ddr_base  <= video_mem.addr;
+        ddr_beats <= video_mem.burst ? 3'd4 : 3'd1;
+        ddr_beat  <= 3'd0;
+        ddr_wait  <= DDR_LAT;
+        ddr_reads <= ddr_reads + 1;
+      end
+    end else if (ddr_wait != 0) begin
+      ddr_wait <= ddr_wait - 1;
+    end else begin
+      video_mem.ready <= 1'b1;
+      video_mem.q     <= ddr_word(ddr_base + {18'd0, ddr_beat});
+      ddr_beat        <= ddr_beat + 3'd1;
+      if (ddr_beat == ddr_beats - 3'd1)
+        ddr_busy <= 1'b0;
+    end
+  end
+
+  // ---------------------------------------------------------------------
+  // DUT: apple_memory, with its counters wired to the connector as in top
+  // ---------------------------------------------------------------------
+  reg  [15:0] video_addr = 16'h0;
+  reg         video_rd = 1'b0;
+  wire [31:0] video_data;
+  wire        video_ready;
+  reg         vgc_active = 1'b1;
+  reg  [12:0] vgc_addr = 13'h0;
+  reg         vgc_rd = 1'b0;
+  wire [31:0] vgc_data;
+  wire        vgc_ready;
+  reg         frame = 1'b0;
+  wire [7:0]  shadow_drop, shadow_rd_state;
+  wire [15:0] late, pf_depth;
+
+  apple_memory #(
+    .VGC_MEMORY(1),
+    .PF_GROUPS_LOG2(1)
+  ) dut (
+    .a2bus_if(a2bus),
+    .a2mem_if(a2mem),
+    .main_mem_if(main_mem),
+    .video_mem_if(video_mem),
+    .video_address_i(video_addr),
+    .video_bank_i(1'b0),
+    .video_rd_i(video_rd),
+    .video_data_o(video_data),
+    .video_ready_o(video_ready),
+    .vgc_active_i(vgc_active),
+    .vgc_address_i(vgc_addr),
+    .vgc_rd_i(vgc_rd),
+    .vgc_data_o(vgc_data),
+    .vgc_ready_o(vgc_ready),
+    .dbg_shadow_drop_o(shadow_drop),
+    .dbg_rd_state_o(shadow_rd_state),
+    .frame_i(frame),
+    .dbg_late_o(late),
+    .dbg_pf_depth_o(pf_depth)
+  );
+
+  // Octal bus: the connector drives only its response slots
+  reg        sclk = 0;
+  reg  [7:0] m_data = 8'hFF;
+  reg        m_oe = 0;
+  wire [7:0] esp_data_o;
+  wire       esp_data_oe;
+  wire [7:0] bus = esp_data_oe ? esp_data_o : (m_oe ? m_data : 8'hFF);
+
+  localparam [7:0] C029_CNT = 8'h3C;    // page-0 value at 0x71
+  localparam [7:0] VIDEO_SS = 8'h81;    // 0x70 reads the soft-switch snapshot
+
+  esp32_ospi_connector #(
+    .USE_SYNC(1),
+    .USE_CRC(0),
+    .IDLE_TO_CYC(54_000)
+  ) esp32_ospi (
+    .clk(clk),
+    .rst_n(rst_n),
+    .sclk(sclk),
+    .data_i(bus),
+    .data_o(esp_data_o),
+    .data_oe(esp_data_oe),
+    .slotmaker_config_if(slotmaker),
+    .f18a_gpu_if(gpu),
+    .video_control_if(vctl),
+    .volumes(volumes),
+    .hdd_volumes(hdd_volumes),
+    .a2bus_control_if(a2ctl),
+    .disk_ram_if(disk_ram),
+    .hdd_ram_if(hdd_ram),
+    .ddr3_ready_i(1'b1),
+    .a2_reset_n_i(1'b1),
+    .pad_typ_i(2'd0),
+    .pad_connerr_i(1'b0),
+    .pad_report_cnt_i(4'd0),
+    .pad_btns0_i(8'h00),
+    .pad_btns1_i(8'h00),
+    .key_mod_i(8'h00),
+    .key0_i(8'h00),
+    .key1_i(8'h00),
+    .dbg_video_ss_i(VIDEO_SS),
+    .dbg_c029_cnt_i(C029_CNT),
+    .dbg_c029_last_i(8'h00),
+    .dbg_vgc_hsync_i(8'h00),
+    .dbg_shadow_drop_i(shadow_drop),
+    .dbg_fb_flags_i(8'h00),
+    .dbg_resp_ovfl_i(8'h00),
+    .dbg_shadow_rd_i(shadow_rd_state),
+    .dbg_vgc_starved_i(8'h00),
+    .dbg_shadow_late_i(late),
+    .dbg_vgc_stalls_i(16'h0000),
+    .dbg_vid_late_i(16'h0000),
+    .dbg_pf_depth_i(pf_depth),
+    .dbg_usb_line_i(8'h00),
+    .dbg_usb_pc_i(8'h00),
+    .dbg_usb_desc_i(48'h0),
+    .dbg_usb_flags_i(8'h00),
+    .dbg_usb_cnt_start_i(8'h00),
+    .dbg_usb_cnt_rdy_i(8'h00),
+    .dbg_ddr3_retry_i(8'h00),
+    .dbg_ddr3_seq_i(8'h00),
+    .ddr3_reinit_tgl_o(),
+    .dbg_mem_addr_o(),
+    .dbg_mem_go_o(),
+    .dbg_mem_busy_i(1'b0),
+    .dbg_mem_data_i(32'h0),
+    .w5100_host_wr(),
+    .w5100_host_addr(),
+    .w5100_host_wdata(),
+    .w5100_host_rdata(8'h00),
+    .w5100_cmd_pending(4'h0),
+    .w5100_cmd_clr(),
+    .scratch_o(),
+    .mcu_ready_o(),
+    .esp_attn_n(),
+    .osd_clk_i(clk),
+    .osd_addr_i(11'h0),
+    .osd_data_o(),
+    .osd_scroll_o()
+  );
+
+  // ---------------------------------------------------------------------
+  // Checks
+  // ---------------------------------------------------------------------
+  integer fails = 0;
+
+  task automatic check_eq(input [31:0] got, input [31:0] exp, input [255:0] what);
+    if (got !== exp) begin
+      $display("[FAIL] %0s: got=0x%0X exp=0x%0X @%0t", what, got, exp, $time);
+      fails = fails + 1;
+    end else begin
+      $display("[PASS] %0s: 0x%0X", what, got);
+    end
+  endtask
+
+  // Same contract as apple_memory's interleave_mux
+  function [31:0] ilv(input hi, input [31:0] a, input [31:0] b);
+    ilv = hi ? {b[31:24], a[31:24], b[23:16], a[23:16]}
+             : {b[15:8],  a[15:8],  b[7:0],   a[7:0]};
+  endfunction
+
+  function [20:0] group_base(input [11:0] g);
+    group_base = UNIFIED_OFFSET + {7'b0, g, 2'b00};
+  endfunction
+
+  function [31:0] exp_vgc(input [12:0] a);
+    exp_vgc = ilv(a[0], ddr_word(group_base(a[12:1]) + 21'd2),
+                        ddr_word(group_base(a[12:1]) + 21'd3));
+  endfunction
+
+  function [31:0] exp_vid(input [15:0] a);
+    reg [14:0] off;
+    begin
+      off = {a[15:13] - 3'd1, a[12:0]};
+      exp_vid = ilv(off[1], ddr_word(group_base(off[13:2])),
+                            ddr_word(group_base(off[13:2]) + 21'd2));
+    end
+  endfunction
+
+  integer word_bad = 0;
+
+  // One generator word: strobe for a clk, wait for ready, check the data
+  task automatic vgc_word(input [12:0] a);
+    integer n;
+    begin
+      @(posedge clk); #1;
+      vgc_addr = a;
+      vgc_rd   = 1'b1;
+      @(posedge clk); #1;
+      vgc_rd   = 1'b0;
+      n = 0;
+      while (!vgc_ready && n < 1000) begin
+        @(posedge clk); #1;
+        n = n + 1;
+      end
+      if (!vgc_ready || vgc_data !== exp_vgc(a)) begin
+        $display("[FAIL] vgc word %0d: ready=%0d data=0x%08X exp=0x%08X @%0t",
+                 a, vgc_ready, vgc_data, exp_vgc(a), $time);
+        word_bad = word_bad + 1;
+      end
+      repeat (GAP) @(posedge clk);
+    end
+  endtask
+
+  task automatic vid_word(input [15:0] a);
+    integer n;
+    begin
+      @(posedge clk); #1;
+      video_addr = a;
+      video_rd   = 1'b1;
+      @(posedge clk); #1;
+      video_rd   = 1'b0;
+      n = 0;
+      while (!video_ready && n < 1000) begin
+        @(posedge clk); #1;
+        n = n + 1;
+      end
+      if (!video_ready || video_data !== exp_vid(a)) begin
+        $display("[FAIL] video word %04X: ready=%0d data=0x%08X exp=0x%08X @%0t",
+                 a, video_ready, video_data, exp_vid(a), $time);
+        word_bad = word_bad + 1;
+      end
+      repeat (GAP) @(posedge clk);
+    end
+  endtask
+
+  // Vsync: latch this frame's counters and start the next
+  task automatic end_frame;
+    begin
+      @(posedge clk); #1;
+      frame = 1'b1;
+      repeat (2) @(posedge clk);
+      #1;
+      frame = 1'b0;
+      repeat (2) @(posedge clk);
+    end
+  endtask
+
+  // ---------------------------------------------------------------------
+  // OSPI master (as in test_esp32_ospi_proto_proc)
+  // ---------------------------------------------------------------------
+  task automatic clk_byte(input [7:0] tx, input drive, output [7:0] rx);
+    begin
+      m_oe   = drive;
+      m_data = tx;
+      #(SCLK_HALF_NS);
+      if (drive && esp_data_oe) begin
+        $display("[FAIL] bus contention @%0t", $time);
+        fails = fails + 1;
+      end
+      sclk = 1'b1;
+      rx   = bus;
+      #(SCLK_HALF_NS);
+      sclk = 1'b0;
+    end
+  endtask
+
+  task automatic gap;
+    #(4*SCLK_HALF_NS);
+  endtask
+
+  // [A5 5A] opcode data
+  task automatic reg_write(input [6:0] r_idx, input [7:0] val);
+    reg [7:0] r;
+    begin
+      clk_byte(8'hA5, 1, r);
+      clk_byte(8'h5A, 1, r);
+      clk_byte({1'b0, r_idx}, 1, r);
+      clk_byte(val, 1, r);
+      gap();
+    end
+  endtask
+
+  // [A5 5A] opcode, turnaround, [data][status]
+  task automatic reg_read(input [6:0] r_idx, output [7:0] val);
+    reg [7:0] r;
+    begin
+      clk_byte(8'hA5, 1, r);
+      clk_byte(8'h5A, 1, r);
+      clk_byte({1'b1, r_idx}, 1, r);
+      gap();
+      clk_byte(8'hFF, 0, val);
+      clk_byte(8'hFF, 0, r);
+      if (!r[0] || r[7:4] != 4'h1) begin
+        $display("[FAIL] reg 0x%02X read: status=0x%02X @%0t", r_idx, r, $time);
+        fails = fails + 1;
+      end
+      gap();
+    end
+  endtask
+
+  // Page 1 of the viddbg window: late words at 0x71/72, depth at 0x77/78
+  task automatic read_counters(input [15:0] exp_late, input [15:0] exp_depth,
+                               input [255:0] what);
+    reg [7:0] lo, hi;
+    begin
+      reg_read(7'h71, lo);
+      reg_read(7'h72, hi);
+      check_eq({hi, lo}, exp_late, what);
+      reg_read(7'h77, lo);
+      reg_read(7'h78, hi);
+      check_eq({hi, lo}, exp_depth, "  0x77/78 prefetch depth");
+    end
+  endtask
+
+  integer   k;
+  integer   bursts;
+  reg [7:0] rb;
+
+  initial begin
+    $dumpfile("apple_memory_prefetch.vcd");
+    $dumpvars(0, test_apple_memory_prefetch);
+
+    $display("=== apple_memory: video prefetch queue + 0x70 page readout ===");
+    #(20*CLK_PERIOD_NS);
+    a2bus.system_reset_n = 1'b1;
+    a2bus.device_reset_n = 1'b1;
+    rst_n = 1'b1;
+    #(10*CLK_PERIOD_NS);
+
+    // 1) VGC pixel words 0..31 in order: only word 0 waits on DDR3, and
+    //    the queue holds both groups ahead of the one being served
+    end_frame();
+    bursts = ddr_reads;
+    for (k = 0; k < 32; k = k + 1)
+      vgc_word(k[12:0]);
+    check_eq(word_bad, 0, "sequential VGC: words served correctly");
+    // groups 0..15 plus at most the two queued past the last one
+    check_eq(ddr_reads - bursts >= 16 && ddr_reads - bursts <= 18, 1,
+             "sequential VGC: each group fetched once");
+    end_frame();
+    check_eq(late, 1, "sequential VGC: late words");
+    check_eq(pf_depth, 2, "sequential VGC: max queue depth");
+
+    reg_write(7'h70, 8'h01);
+    read_counters(16'd1, 16'd2, "page 1: 0x71/72 late words (sequential)");
+
+    // 2) Scattered pixel words: each lands outside the window and misses
+    for (k = 0; k < 3; k = k + 1)
+      vgc_word(13'd1000 + k[12:0] * 13'd2000);
+    check_eq(word_bad, 0, "scattered VGC: words served correctly");
+    end_frame();
+    check_eq(late, 3, "scattered VGC: late words");
+    read_counters(16'd3, pf_depth, "page 1: 0x71/72 late words (scattered)");
+
+    // 3) Hires video words 0x2000.. in order, VGC off: same as case 1
+    vgc_active = 1'b0;
+    for (k = 0; k < 32; k = k + 1)
+      vid_word(16'h2000 + k[15:0] * 16'd2);
+    check_eq(word_bad, 0, "sequential hires: words served correctly");
+    end_frame();
+    check_eq(late, 1, "sequential hires: late words");
+    check_eq(pf_depth, 2, "sequential hires: max queue depth");
+    read_counters(16'd1, 16'd2, "page 1: 0x71/72 late words (hires)");
+
+    // 4) Page 0 again: 0x70/0x71 show the soft switches and $C029 count
+    reg_write(7'h70, 8'h00);
+    reg_read(7'h70, rb);
+    check_eq(rb, VIDEO_SS, "page 0: 0x70 soft switches");
+    reg_read(7'h71, rb);
+    check_eq(rb, C029_CNT, "page 0: 0x71 $C029 count");
+
+    if (fails != 0) begin
+      $display("=== FAILED: %0d checks ===", fails);
+      $fatal(1);
+    end
+    $display("=== PASSED ===");
+    $finish;
+  end
+
+  initial begin
+    #(20_000_000);
+    $display("[FAIL] timeout");
+    $fatal(1);
+  end
+endmodule
@@ -0,0 +1,237 @@
+// Testbench for esp32_ospi_proto_proc (octal bus, CRC off)
+//
+// Runs register programs the way ospi_reg_program() does: one wake byte,
+// then SPACE 6 bursts back to back with no wake in between. Every op must
+// come back with a good status byte; a read that leaves the FSM waiting for
+// one more payload slot eats the next op's sync and fails it.
+`timescale 1ns/1ps
+
+module test_esp32_ospi_proto_proc;
+  // 54 MHz core clock (~18.518 ns period)
+  localparam real CLK_PERIOD_NS = 18.518;
+  localparam real SCLK_HALF_NS  = 8.0 * CLK_PERIOD_NS;
+
+  reg clk = 0;
+  reg rst_n = 0;
+  reg sclk = 0;
+
+  // Shared data bus: the DUT drives only its response slots
+  reg  [7:0] m_data = 8'hFF;
+  reg        m_oe = 0;
+  wire [7:0] data_out;
+  wire       data_oe;
+  wire [7:0] bus = data_oe ? data_out : (m_oe ? m_data : 8'hFF);
+
+  wire        reg_wr_req, reg_rd_req;
+  wire [6:0]  reg_idx;
+  wire [7:0]  reg_wdata;
+  wire        mem_wr_en;
+  wire [2:0]  mem_space;
+  wire [23:0] mem_wr_addr;
+  wire [7:0]  mem_wr_data;
+  wire        mem_rd_req;
+  wire [2:0]  mem_rd_space;
+  wire [23:0] mem_rd_addr;
+  wire [7:0]  crc_ok_cnt, crc_err_cnt;
+
+  // Register file behind the single-register path and the SPACE 6 window,
+  // with the connector's 2-clk window read pipeline
+  reg  [7:0] regs [0:127];
+  reg        mem_rd_req_r = 0;
+  reg        mem_rd_valid = 0;
+  reg  [7:0] regs_rd_q = 8'hFF;
+  reg  [7:0] mem_rd_data = 8'hFF;
+  wire       regs_xr = mem_rd_req && (mem_rd_space == 3'd6);
+  wire [7:0] reg_rdata = regs[regs_xr ? mem_rd_addr[6:0] : reg_idx];
+
+  always @(posedge clk) begin
+    if (reg_wr_req)
+      regs[reg_idx] <= reg_wdata;
+    if (mem_wr_en && mem_space == 3'd6)
+      regs[mem_wr_addr[6:0]] <= mem_wr_data;
+    if (regs_xr)
+      regs_rd_q <= reg_rdata;
+    mem_rd_req_r <= mem_rd_req;
+    mem_rd_valid <= mem_rd_req_r;
+    mem_rd_data  <= regs_rd_q;
+  end
+
+  esp32_ospi_proto_proc #(
+    .USE_SYNC(1),
+    .USE_CRC(0),
+    .IDLE_TO_CYC(54_000)
+  ) dut (
+    .clk(clk),
+    .rst_n(rst_n),
+    .sclk(sclk),
+    .data_in(bus),
+    .data_out(data_out),
+    .data_oe(data_oe),
+    .reg_wr_req(reg_wr_req),
+    .reg_rd_req(reg_rd_req),
+    .reg_idx(reg_idx),
+    .reg_wdata(reg_wdata),
+    .reg_rdata(reg_rdata),
+    .mem_wr_en(mem_wr_en),
+    .mem_space(mem_space),
+    .mem_wr_addr(mem_wr_addr),
+    .mem_wr_data(mem_wr_data),
+    .mem_rd_req(mem_rd_req),
+    .mem_rd_space(mem_rd_space),
+    .mem_rd_addr(mem_rd_addr),
+    .mem_rd_valid(mem_rd_valid),
+    .mem_rd_data(mem_rd_data),
+    .crc_ok_cnt(crc_ok_cnt),
+    .crc_err_cnt(crc_err_cnt)
+  );
+
+  always #(CLK_PERIOD_NS/2.0) clk = ~clk;
+
+  integer fails = 0;
+
+  task automatic check_eq(input [7:0] got, input [7:0] exp, input [255:0] what);
+    if (got !== exp) begin
+      $display("[FAIL] %0s: got=0x%02X exp=0x%02X @%0t", what, got, exp, $time);
+      fails = fails + 1;
+    end else begin
+      $display("[PASS] %0s: 0x%02X", what, got);
+    end
+  endtask
+
+  // One byte slot: master drives tx (drive=1) or releases the bus and
+  // samples what the DUT put there. Data changes after SCLK falls and is
+  // sampled on the rise, as the ESP32 octal host does.
+  task automatic clk_byte(input [7:0] tx, input drive, output [7:0] rx);
+    begin
+      m_oe   = drive;
+      m_data = tx;
+      #(SCLK_HALF_NS);
+      if (drive && data_oe) begin
+        $display("[FAIL] bus contention @%0t", $time);
+        fails = fails + 1;
+      end
+      sclk = 1'b1;
+      rx   = bus;
+      #(SCLK_HALF_NS);
+      sclk = 1'b0;
+    end
+  endtask
+
+  // Polled transactions inside a program leave a short CS-held gap
+  task automatic gap;
+    #(4*SCLK_HALF_NS);
+  endtask
+
+  // [A5 5A] 7F SUB0 ADDR0-2 LEN0-1 for a SPACE 6 burst, INC, no CRC
+  task automatic regs_hdr(input rd, input [6:0] reg0, input [7:0] n);
+    reg [7:0] r;
+    begin
+      clk_byte(8'hA5, 1, r);
+      clk_byte(8'h5A, 1, r);
+      clk_byte(8'h7F, 1, r);
+      clk_byte({2'b00, 1'b0, 1'b1, 3'd6, rd}, 1, r);
+      clk_byte({1'b0, reg0}, 1, r);
+      clk_byte(8'h00, 1, r);
+      clk_byte(8'h00, 1, r);
+      clk_byte(n, 1, r);
+      clk_byte(8'h00, 1, r);
+    end
+  endtask
+
+  // Status byte as the firmware checks it: ok bit set, version 1
+  task automatic check_status(input [7:0] st, input [255:0] what);
+    if (!st[0] || st[7:4] != 4'h1) begin
+      $display("[FAIL] %0s: status=0x%02X @%0t", what, st, $time);
+      fails = fails + 1;
+    end else begin
+      $display("[PASS] %0s: status 0x%02X", what, st);
+    end
+  endtask
+
+  task automatic burst_read(input [6:0] reg0, input [7:0] n);
+    reg [7:0] r;
+    integer i;
+    begin
+      regs_hdr(1'b1, reg0, n);
+      gap();                                // turnaround: TX -> RX phase
+      clk_byte(8'hFF, 0, r);
+      check_status(r, "burst read");
+      for (i = 0; i < n; i = i + 1) begin
+        clk_byte(8'hFF, 0, r);
+        check_eq(r, regs[reg0 + i], "burst read data");
+      end
+      gap();
+    end
+  endtask
+
+  task automatic burst_write(input [6:0] reg0, input [7:0] d0, input [7:0] d1);
+    reg [7:0] r;
+    begin
+      regs_hdr(1'b0, reg0, 8'd2);
+      clk_byte(d0, 1, r);
+      clk_byte(d1, 1, r);
+      gap();
+    end
+  endtask
+
+  // Single-register read: [A5 5A] opcode, turnaround, [data][status]
+  task automatic reg_read(input [6:0] r_idx, input [7:0] exp);
+    reg [7:0] r;
+    begin
+      clk_byte(8'hA5, 1, r);
+      clk_byte(8'h5A, 1, r);
+      clk_byte({1'b1, r_idx}, 1, r);
+      gap();
+      clk_byte(8'hFF, 0, r);
+      check_eq(r, exp, "register read");
+      clk_byte(8'hFF, 0, r);
+      check_status(r, "register read");
+      gap();
+    end
+  endtask
+
+  integer k;
+  reg [7:0] rx;
+
+  initial begin
+    $dumpfile("esp32_ospi_proto_proc.vcd");
+    $dumpvars(0, test_esp32_ospi_proto_proc);
+
+    $display("=== esp32_ospi_proto_proc: multi-op register programs, CRC off ===");
+    for (k = 0; k < 128; k = k + 1)
+      regs[k] = k[7:0] ^ 8'h5A;
+
+    #(20*CLK_PERIOD_NS);
+    rst_n = 1;
+    #(10*CLK_PERIOD_NS);
+
+    // Program 1: read + read (serve_drive / serve_hdd / attention status)
+    clk_byte(8'h00, 1, rx);                 // bus wake, once per program
+    burst_read(7'h10, 8'd2);
+    burst_read(7'h20, 8'd3);
+
+    // Program 2: read, write, read back, then a single-register read
+    #(40*SCLK_HALF_NS);
+    clk_byte(8'h00, 1, rx);
+    burst_read(7'h40, 8'd1);
+    burst_write(7'h30, 8'hC3, 8'h3C);
+    check_eq(regs[7'h30], 8'hC3, "burst write [0]");
+    check_eq(regs[7'h31], 8'h3C, "burst write [1]");
+    burst_read(7'h30, 8'd2);
+    reg_read(7'h31, 8'h3C);
+    burst_read(7'h7E, 8'd1);
+
+    if (fails != 0) begin
+      $display("=== FAILED: %0d checks ===", fails);
+      $fatal(1);
+    end
+    $display("=== PASSED ===");
+    $finish;
+  end
+
+  initial begin
+    #(2_000_000);
+    $display("[FAIL] timeout");
+    $fatal(1);
+  end
+endmodule
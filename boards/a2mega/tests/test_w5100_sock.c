@@ -0,0 +1,414 @@
+/*
+ * test_w5100_sock.c — host-side loopback test for the W5100 socket engine.
+ *
+ * Runs the firmware engine (src/a2fpga_esp32/w5100_sock.c) on the host's BSD
+ * sockets against a RAM copy of the card's W5100 space (XFER SPACE 3), and
+ * drives it the way an Apple II driver does: registers, Sn_CR commands and
+ * the TX/RX rings only. It requires that:
+ *   - RMSR/TMSR place each socket's buffers like a W5100
+ *   - TCP CONNECT reaches a local echo server and a stream larger than the
+ *     rings comes back intact through wrapped TX/RX pointers
+ *   - DISCON finishes the close once the peer answers the FIN
+ *   - a refused CONNECT ends CLOSED with Sn_IR TIMEOUT
+ *   - UDP datagrams come back as records with the 8-byte W5100 header
+ *   - Sn_IR bits the Apple II clears (write-1-to-clear) stay clear until the
+ *     engine raises them again: SEND raises SEND_OK afresh, RECV does not
+ *     bring it back
+ *   - LISTEN accepts a connection, fills Sn_DIPR/DPORT, and a peer close
+ *     shows as CLOSE_WAIT + DISCON
+ * then reports TCP echo throughput through 2 KB rings.
+ *
+ *   make w5100_sock         (from boards/a2mega/tests)
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "check.h"
+#include "fpga_link.h"
+#include "w5100.h"
+#include "w5100_sock.h"
+
+#define STREAM_BYTES  (256u * 1024u)
+#define TIMEOUT_MS    5000
+
+/* ---- RAM-backed SPACE 3 in place of the FPGA link ---- */
+static uint8_t s_w5100[W5100_MEM_END];
+
+/* Sn_IR as the card keeps it: host writes raise bits, or clear them with
+ * bit 7 set; Apple II writes clear the bits written as 1. */
+static bool is_sn_ir(uint32_t a)
+{
+    return a >= W5100_S_BASE(0) && a < W5100_S_BASE(W5100_NUM_SOCKETS) &&
+           (a & 0xFF) == W5100_Sn_IR;
+}
+
+bool fpga_mem_read(uint8_t space, uint32_t addr, uint8_t *out, uint16_t len)
+{
+    if (space != A2SPACE_W5100 || addr + len > sizeof(s_w5100)) {
+        printf("FAIL: read space %u addr %04x len %u\n", space, (unsigned)addr, len);
+        exit(1);
+    }
+    memcpy(out, s_w5100 + addr, len);
+    return true;
+}
+
+bool fpga_mem_write(uint8_t space, uint32_t addr, const uint8_t *data, uint16_t len)
+{
+    if (space != A2SPACE_W5100 || addr + len > sizeof(s_w5100)) {
+        printf("FAIL: write space %u addr %04x len %u\n", space, (unsigned)addr, len);
+        exit(1);
+    }
+    for (uint16_t i = 0; i < len; i++) {
+        uint32_t a = addr + i;
+        if (!is_sn_ir(a))
+            s_w5100[a] = data[i];
+        else if (data[i] & 0x80)
+            s_w5100[a] &= (uint8_t)~(data[i] & 0x1F);
+        else
+            s_w5100[a] |= (uint8_t)(data[i] & 0x1F);
+    }
+    return true;
+}
+
+void fpga_link_lock(void) {}
+void fpga_link_unlock(void) {}
+
+/* ---- Apple II side: registers and rings ---- */
+static uint8_t sn8(int n, uint8_t reg) { return s_w5100[W5100_S_BASE(n) + reg]; }
+static uint16_t sn16(int n, uint8_t reg)
+{
+    return (uint16_t)((sn8(n, reg) << 8) | sn8(n, reg + 1));
+}
+static void sn_set8(int n, uint8_t reg, uint8_t v) { s_w5100[W5100_S_BASE(n) + reg] = v; }
+static void sn_set16(int n, uint8_t reg, uint16_t v)
+{
+    sn_set8(n, reg, (uint8_t)(v >> 8));
+    sn_set8(n, reg + 1, (uint8_t)v);
+}
+
+/* Sn_IR write-1-to-clear from the Apple II. */
+static void a2_ir_clear(int n, uint8_t bits)
+{
+    s_w5100[W5100_S_BASE(n) + W5100_Sn_IR] &= (uint8_t)~bits;
+}
+
+/* Sn_CR write + doorbell service, as w5100.c dispatches it. */
+static void cmd(int n, uint8_t c)
+{
+    sn_set8(n, W5100_Sn_CR, c);
+    if (c == W5100_CR_OPEN)
+        w5100_sock_open(n, sn8(n, W5100_Sn_MR) & 0x0F);
+    else
+        w5100_sock_command(n, c);
+    sn_set8(n, W5100_Sn_CR, 0);
+}
+
+static void layout(int n, uint16_t *rxb, uint16_t *rxs, uint16_t *txb, uint16_t *txs)
+{
+    w5100_sock_layout(n, s_w5100[W5100_RMSR], s_w5100[W5100_TMSR], rxb, rxs, txb, txs);
+}
+
+/* Queue len bytes at Sn_TX_WR and SEND, if Sn_TX_FSR has room. */
+static bool a2_send(int n, const uint8_t *p, uint16_t len)
+{
+    uint16_t rxb, rxs, txb, txs;
+    layout(n, &rxb, &rxs, &txb, &txs);
+    if (sn16(n, W5100_Sn_TX_FSR) < len)
+        return false;
+    uint16_t wr = sn16(n, W5100_Sn_TX_WR);
+    for (uint16_t i = 0; i < len; i++)
+        s_w5100[txb + ((wr + i) & (txs - 1))] = p[i];
+    sn_set16(n, W5100_Sn_TX_WR, (uint16_t)(wr + len));
+    cmd(n, W5100_CR_SEND);
+    return true;
+}
+
+/* Take up to max received bytes from the RX ring and RECV. */
+static uint16_t a2_recv(int n, uint8_t *p, uint16_t max)
+{
+    uint16_t rxb, rxs, txb, txs;
+    layout(n, &rxb, &rxs, &txb, &txs);
+    uint16_t len = sn16(n, W5100_Sn_RX_RSR);
+    if (len > max) len = max;
+    if (!len)
+        return 0;
+    uint16_t rd = sn16(n, W5100_Sn_RX_RD);
+    for (uint16_t i = 0; i < len; i++)
+        p[i] = s_w5100[rxb + ((rd + i) & (rxs - 1))];
+    sn_set16(n, W5100_Sn_RX_RD, (uint16_t)(rd + len));
+    cmd(n, W5100_CR_RECV);
+    return len;
+}
+
+/* ---- local echo servers ---- */
+static int s_tcp_listen = -1, s_tcp_conn = -1, s_udp = -1;
+static uint8_t s_echo[STREAM_BYTES];
+static size_t s_echo_len;
+
+static void nonblock(int fd)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+static uint16_t bound_port(int fd)
+{
+    struct sockaddr_in sa;
+    socklen_t l = sizeof(sa);
+    getsockname(fd, (struct sockaddr *)&sa, &l);
+    return ntohs(sa.sin_port);
+}
+
+static int loopback_socket(int type, uint16_t port)
+{
+    int fd = socket(AF_INET, type, 0);
+    struct sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0) {
+        printf("FAIL: cannot bind a loopback socket (%s)\n", strerror(errno));
+        exit(1);
+    }
+    return fd;
+}
+
+static void echo_service(void)
+{
+    uint8_t buf[4096];
+    if (s_tcp_listen >= 0 && s_tcp_conn < 0) {
+        s_tcp_conn = accept(s_tcp_listen, NULL, NULL);
+        if (s_tcp_conn >= 0)
+            nonblock(s_tcp_conn);
+    }
+    if (s_tcp_conn >= 0) {
+        ssize_t r = recv(s_tcp_conn, buf, sizeof(buf), 0);
+        if (r > 0 && s_echo_len + (size_t)r <= sizeof(s_echo)) {
+            memcpy(s_echo + s_echo_len, buf, (size_t)r);
+            s_echo_len += (size_t)r;
+        } else if (r == 0 && s_echo_len == 0) {
+            close(s_tcp_conn);               /* peer FIN, nothing left to echo */
+            s_tcp_conn = -1;
+        }
+        if (s_echo_len) {
+            ssize_t w = send(s_tcp_conn, s_echo, s_echo_len, 0);
+            if (w > 0) {
+                memmove(s_echo, s_echo + w, s_echo_len - (size_t)w);
+                s_echo_len -= (size_t)w;
+            }
+        }
+    }
+    if (s_udp >= 0) {
+        struct sockaddr_in from;
+        socklen_t fl = sizeof(from);
+        ssize_t r = recvfrom(s_udp, buf, sizeof(buf), 0, (struct sockaddr *)&from, &fl);
+        if (r > 0)
+            sendto(s_udp, buf, (size_t)r, 0, (struct sockaddr *)&from, fl);
+    }
+}
+
+static double now_s(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+}
+
+static void pump(void)
+{
+    w5100_sock_poll();
+    echo_service();
+}
+
+/* Poll until Sn_SR == sr (or the timeout). */
+static bool wait_sr(int n, uint8_t sr)
+{
+    double end = now_s() + TIMEOUT_MS / 1000.0;
+    while (sn8(n, W5100_Sn_SR) != sr && now_s() < end) {
+        pump();
+        usleep(100);
+    }
+    return sn8(n, W5100_Sn_SR) == sr;
+}
+
+static void set_dest(int n, uint16_t port)
+{
+    static const uint8_t lo[4] = { 127, 0, 0, 1 };
+    memcpy(&s_w5100[W5100_S_BASE(n) + W5100_Sn_DIPR], lo, 4);
+    sn_set16(n, W5100_Sn_DPORT, port);
+}
+
+static uint8_t s_tx[STREAM_BYTES], s_rx[STREAM_BYTES];
+
+int main(void)
+{
+    printf("=== W5100 socket engine: register-level loopback ===\n");
+    w5100_sock_init();
+
+    /* ---- buffer layout ---- */
+    uint16_t rxb, rxs, txb, txs;
+    w5100_sock_layout(1, 0x55, 0x55, &rxb, &rxs, &txb, &txs);
+    CHECK(rxb == 0x6800 && rxs == 2048 && txb == 0x4800 && txs == 2048,
+          "0x55 s1: rx %04x/%u tx %04x/%u", rxb, rxs, txb, txs);
+    w5100_sock_layout(2, 0x06, 0x06, &rxb, &rxs, &txb, &txs);   /* 4K 2K 1K 1K */
+    CHECK(rxb == 0x7800 && rxs == 1024 && txb == 0x5800 && txs == 1024,
+          "0x06 s2: rx %04x/%u tx %04x/%u", rxb, rxs, txb, txs);
+    w5100_sock_layout(1, 0xFF, 0xFF, &rxb, &rxs, &txb, &txs);   /* 8K to s0 */
+    CHECK(rxs == 0 && txs == 0, "0xFF s1: rx %u tx %u", rxs, txs);
+
+    s_w5100[W5100_RMSR] = 0x55;
+    s_w5100[W5100_TMSR] = 0x55;
+
+    /* ---- TCP CONNECT + echo stream through socket 1 ---- */
+    s_tcp_listen = loopback_socket(SOCK_STREAM, 0);
+    listen(s_tcp_listen, 1);
+    nonblock(s_tcp_listen);
+
+    sn_set8(1, W5100_Sn_MR, W5100_MR_TCP);
+    sn_set16(1, W5100_Sn_PORT, 0);
+    cmd(1, W5100_CR_OPEN);
+    CHECK(sn8(1, W5100_Sn_SR) == W5100_SOCK_INIT, "TCP OPEN: SR %02x", sn8(1, W5100_Sn_SR));
+    CHECK(sn16(1, W5100_Sn_TX_FSR) == 2048, "TCP OPEN: FSR %u", sn16(1, W5100_Sn_TX_FSR));
+    set_dest(1, bound_port(s_tcp_listen));
+    cmd(1, W5100_CR_CONNECT);
+    CHECK(wait_sr(1, W5100_SOCK_ESTABLISHED), "CONNECT: SR %02x", sn8(1, W5100_Sn_SR));
+    CHECK(sn8(1, W5100_Sn_IR) & W5100_IR_CON, "CONNECT: IR %02x", sn8(1, W5100_Sn_IR));
+
+    for (uint32_t i = 0; i < STREAM_BYTES; i++)
+        s_tx[i] = (uint8_t)(i * 7 + (i >> 9));
+    uint32_t sent = 0, got = 0, step = 0;
+    double t0 = now_s(), end = t0 + TIMEOUT_MS / 1000.0;
+    while (got < STREAM_BYTES && now_s() < end) {
+        if (sent < STREAM_BYTES) {
+            uint16_t len = (uint16_t)(300 + (step * 277) % 1500);   /* odd sizes: wrap */
+            if (len > STREAM_BYTES - sent) len = (uint16_t)(STREAM_BYTES - sent);
+            if (a2_send(1, s_tx + sent, len)) {
+                sent += len;
+                step++;
+            }
+        }
+        got += a2_recv(1, s_rx + got, (uint16_t)(STREAM_BYTES - got > 4096 ? 4096 : STREAM_BYTES - got));
+        pump();
+    }
+    double dt = now_s() - t0;
+    CHECK(got == STREAM_BYTES, "echo: got %u of %u", got, STREAM_BYTES);
+    CHECK(memcmp(s_tx, s_rx, got) == 0, "echo: data mismatch");
+
+    cmd(1, W5100_CR_DISCON);
+    CHECK(wait_sr(1, W5100_SOCK_CLOSED), "DISCON: SR %02x", sn8(1, W5100_Sn_SR));
+    CHECK(sn8(1, W5100_Sn_IR) & W5100_IR_DISCON, "DISCON: IR %02x", sn8(1, W5100_Sn_IR));
+
+    /* ---- refused CONNECT (nothing listens on a port just closed) ---- */
+    int tmp = loopback_socket(SOCK_STREAM, 0);
+    uint16_t dead = bound_port(tmp);
+    close(tmp);
+    sn_set8(0, W5100_Sn_MR, W5100_MR_TCP);
+    cmd(0, W5100_CR_OPEN);
+    set_dest(0, dead);
+    cmd(0, W5100_CR_CONNECT);
+    CHECK(wait_sr(0, W5100_SOCK_CLOSED), "refused: SR %02x", sn8(0, W5100_Sn_SR));
+    CHECK(sn8(0, W5100_Sn_IR) & W5100_IR_TIMEOUT, "refused: IR %02x", sn8(0, W5100_Sn_IR));
+
+    /* ---- UDP through socket 2 ---- */
+    s_udp = loopback_socket(SOCK_DGRAM, 0);
+    nonblock(s_udp);
+    uint16_t uport = bound_port(s_udp);
+    sn_set8(2, W5100_Sn_MR, W5100_MR_UDP);
+    sn_set16(2, W5100_Sn_PORT, 0);
+    cmd(2, W5100_CR_OPEN);
+    CHECK(sn8(2, W5100_Sn_SR) == W5100_SOCK_UDP, "UDP OPEN: SR %02x", sn8(2, W5100_Sn_SR));
+    set_dest(2, uport);
+    static const char *dgrams[2] = { "hello from the apple", "II" };
+    for (int d = 0; d < 2; d++) {
+        a2_ir_clear(2, W5100_IR_SEND_OK);   /* as a driver acks the last one */
+        CHECK(!(sn8(2, W5100_Sn_IR) & W5100_IR_SEND_OK), "UDP SEND_OK cleared %d", d);
+        CHECK(a2_send(2, (const uint8_t *)dgrams[d], (uint16_t)strlen(dgrams[d])),
+              "UDP send %d", d);
+        CHECK(sn8(2, W5100_Sn_IR) & W5100_IR_SEND_OK, "UDP SEND_OK %d", d);
+    }
+    a2_ir_clear(2, W5100_IR_SEND_OK);
+    end = now_s() + TIMEOUT_MS / 1000.0;
+    while (!(sn8(2, W5100_Sn_IR) & W5100_IR_RECV) && now_s() < end)
+        pump();
+    CHECK(sn8(2, W5100_Sn_IR) & W5100_IR_RECV, "UDP RECV: IR %02x", sn8(2, W5100_Sn_IR));
+    CHECK(!(sn8(2, W5100_Sn_IR) & W5100_IR_SEND_OK), "UDP: cleared SEND_OK came back");
+    uint8_t rec[64];
+    uint16_t rl = 0;
+    while (rl < 16 + 20 + 2 && now_s() < end) {
+        pump();
+        rl = (uint16_t)(rl + a2_recv(2, rec + rl, (uint16_t)(sizeof(rec) - rl)));
+    }
+    uint16_t o = 0;
+    for (int d = 0; d < 2; d++) {
+        uint16_t plen = (uint16_t)strlen(dgrams[d]);
+        CHECK(rec[o] == 127 && rec[o + 1] == 0 && rec[o + 2] == 0 && rec[o + 3] == 1,
+              "UDP rec %d: ip %u.%u.%u.%u", d, rec[o], rec[o + 1], rec[o + 2], rec[o + 3]);
+        CHECK(((rec[o + 4] << 8) | rec[o + 5]) == uport, "UDP rec %d: port", d);
+        CHECK(((rec[o + 6] << 8) | rec[o + 7]) == plen, "UDP rec %d: len", d);
+        CHECK(memcmp(rec + o + 8, dgrams[d], plen) == 0, "UDP rec %d: data", d);
+        o = (uint16_t)(o + 8 + plen);
+    }
+    cmd(2, W5100_CR_CLOSE);
+    CHECK(sn8(2, W5100_Sn_SR) == W5100_SOCK_CLOSED, "UDP CLOSE");
+
+    /* ---- LISTEN on socket 3, host client connects ---- */
+    tmp = loopback_socket(SOCK_STREAM, 0);
+    uint16_t lport = bound_port(tmp);
+    close(tmp);
+    sn_set8(3, W5100_Sn_MR, W5100_MR_TCP);
+    sn_set16(3, W5100_Sn_PORT, lport);
+    cmd(3, W5100_CR_OPEN);
+    cmd(3, W5100_CR_LISTEN);
+    CHECK(sn8(3, W5100_Sn_SR) == W5100_SOCK_LISTEN, "LISTEN: SR %02x", sn8(3, W5100_Sn_SR));
+    int cl = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(lport);
+    sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK(connect(cl, (struct sockaddr *)&sa, sizeof(sa)) == 0, "client connect");
+    CHECK(wait_sr(3, W5100_SOCK_ESTABLISHED), "accept: SR %02x", sn8(3, W5100_Sn_SR));
+    CHECK(sn16(3, W5100_Sn_DPORT) == bound_port(cl), "accept: DPORT %u", sn16(3, W5100_Sn_DPORT));
+    CHECK(s_w5100[W5100_S_BASE(3) + W5100_Sn_DIPR] == 127, "accept: DIPR");
+    send(cl, "ping", 4, 0);
+    uint8_t pb[8];
+    uint16_t pl = 0;
+    end = now_s() + TIMEOUT_MS / 1000.0;
+    while (pl < 4 && now_s() < end) {
+        pump();
+        pl = (uint16_t)(pl + a2_recv(3, pb + pl, (uint16_t)(4 - pl)));
+    }
+    CHECK(pl == 4 && memcmp(pb, "ping", 4) == 0, "LISTEN: recv");
+    CHECK(a2_send(3, (const uint8_t *)"pong", 4), "LISTEN: send");
+    pump();
+    CHECK(recv(cl, pb, sizeof(pb), 0) == 4 && memcmp(pb, "pong", 4) == 0, "client recv");
+    close(cl);
+    CHECK(wait_sr(3, W5100_SOCK_CLOSE_WAIT), "peer close: SR %02x", sn8(3, W5100_Sn_SR));
+    CHECK(sn8(3, W5100_Sn_IR) & W5100_IR_DISCON, "peer close: IR %02x", sn8(3, W5100_Sn_IR));
+    cmd(3, W5100_CR_CLOSE);
+    CHECK(sn8(3, W5100_Sn_SR) == W5100_SOCK_CLOSED, "CLOSE");
+    CHECK(!w5100_sock_active(), "sockets left open");
+
+    w5100_sock_stats_t st;
+    w5100_sock_stats(&st);
+    if (s_fail) {
+        printf("=== FAILED: %d checks ===\n", s_fail);
+        return 1;
+    }
+    printf("opens %u connects %u accepts %u errors %u (1 expected: refused)\n",
+           st.opens, st.connects, st.accepts, st.errors);
+    printf("TCP echo through 2 KB rings: %u bytes each way, %.0f KB/s\n",
+           STREAM_BYTES, STREAM_BYTES / 1024.0 / dt);
+    printf("=== PASSED ===\n");
+    return 0;
+}
@@ -0,0 +1,229 @@
+/*
+ * test_woz.c — host-side check for the WOZ image helpers.
+ *
+ * Builds WOZ1 and WOZ2 images in memory around 6-and-2 tracks from the
+ * firmware codec (src/a2fpga_esp32/gcr_dsk.c) and requires that:
+ *   - woz_parse() finds every mapped quarter track at the right offset and
+ *     bit count, honours the INFO write-protect flag and rejects 3.5" images
+ *   - bits -> nibbles -> bits at the track's own bit count is lossless,
+ *     including 10-bit self-sync runs and padded (longer) tracks
+ *   - the nibbles framed from a track decode back to the original sectors
+ * then reports framing throughput in tracks per second.
+ *
+ *   make woz                (from boards/a2mega/tests)
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "check.h"
+#include "gcr_dsk.h"
+#include "woz.h"
+
+#define ROUNDS      200
+#define BENCH_ITERS 5000
+#define IMG_MAX     (64u * 1024u * 8u)
+
+static uint32_t s_rng = 0x2F0A2F0Au;
+static uint32_t rnd(void)   /* xorshift32 */
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static uint8_t  s_img[IMG_MAX];
+static uint32_t s_img_len;
+
+static bool mem_read(void *ctx, uint32_t off, void *buf, uint32_t len)
+{
+    (void)ctx;
+    if (off > s_img_len || len > s_img_len - off)
+        return false;
+    memcpy(buf, s_img + off, len);
+    return true;
+}
+
+static void put16(uint8_t *p, uint32_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void put32(uint8_t *p, uint32_t v) { put16(p, v); put16(p + 2, v >> 16); }
+
+/* Bits needed to hold n nibbles with woz_nibbles_to_bits()' sync rule. */
+static uint32_t nibble_bits(const uint8_t *nib, size_t n)
+{
+    uint32_t bits = 0;
+    for (size_t k = 0; k < n; k++)
+        bits += (nib[k] == 0xFF && k > 0 && nib[k - 1] == 0xFF) ? 10u : 8u;
+    return bits;
+}
+
+static uint32_t chunk(uint32_t off, const char *id, uint32_t len)
+{
+    memcpy(s_img + off, id, 4);
+    put32(s_img + off + 4, len);
+    return off + 8;
+}
+
+/* Image header + INFO (disk_type, wp) + TMAP mapping track t to TRKS[t] for
+ * t < ntrk (quarter tracks 4t-1..4t+1). Returns the offset after TMAP. */
+static uint32_t build_head(int version, uint8_t disk_type, uint8_t wp,
+                           unsigned ntrk)
+{
+    memset(s_img, 0, sizeof(s_img));
+    memcpy(s_img, version == 1 ? "WOZ1" : "WOZ2", 4);
+    s_img[4] = 0xFF; s_img[5] = 0x0A; s_img[6] = 0x0D; s_img[7] = 0x0A;
+    uint32_t off = chunk(12, "INFO", 60);
+    s_img[off] = (uint8_t)version;
+    s_img[off + 1] = disk_type;
+    s_img[off + 2] = wp;
+    off = chunk(off + 60, "TMAP", WOZ_QTRACKS);
+    memset(s_img + off, WOZ_TMAP_EMPTY, WOZ_QTRACKS);
+    for (unsigned t = 0; t < ntrk; t++)
+        for (int q = -1; q <= 1; q++)
+            if ((int)(t * 4) + q >= 0)
+                s_img[off + t * 4 + q] = (uint8_t)t;
+    return off + WOZ_QTRACKS;
+}
+
+int main(void)
+{
+    static uint8_t dsk[DSK_TRACK_BYTES], back[DSK_TRACK_BYTES];
+    static uint8_t nib[GCR_TRACK_BYTES], nib2[GCR_TRACK_BYTES];
+    static uint8_t bits[8192], bits2[8192];
+    static uint32_t tbits[WOZ_TRACKS];
+    const unsigned ntrk = 35;
+    woz_image_t img;
+
+    printf("=== WOZ helpers: parse + latch framing round trip ===\n");
+
+    for (int r = 0; r < ROUNDS; r++) {
+        for (size_t i = 0; i < sizeof(dsk); i++)
+            dsk[i] = (uint8_t)rnd();
+        uint8_t track = (uint8_t)(rnd() % 35u);
+        gcr_encode_dos_track(dsk, track, DSK_DEFAULT_VOLUME, GCR_ORDER_DOS,
+                             nib, sizeof(nib));
+
+        /* exact length: lossless both ways */
+        uint32_t nb = nibble_bits(nib, sizeof(nib));
+        if ((nb + 7u) / 8u > sizeof(bits))
+            nb = (uint32_t)sizeof(bits) * 8u;
+        woz_nibbles_to_bits(nib, sizeof(nib), bits, nb);
+        size_t n = woz_bits_to_nibbles(bits, nb, nib2, sizeof(nib2));
+        CHECK(n <= sizeof(nib), "round %d: %zu nibbles", r, n);
+        memset(back, 0, sizeof(back));
+        CHECK(gcr_decode_dos_track(nib2, n, GCR_ORDER_DOS, back) == 0xFFFF &&
+              memcmp(back, dsk, sizeof(dsk)) == 0,
+              "round %d: framed track does not decode", r);
+        woz_nibbles_to_bits(nib2, n, bits2, nb);
+        CHECK(memcmp(bits, bits2, (nb + 7u) / 8u) == 0,
+              "round %d: bits -> nibbles -> bits differs", r);
+
+        /* padded track: extra sync (and an odd remainder) reads back as
+         * $FF, and the data still frames from bit 0 after the wrap */
+        uint32_t pad = nb + 8u + rnd() % 100u;
+        if ((pad + 7u) / 8u > sizeof(bits))
+            continue;
+        woz_nibbles_to_bits(nib, sizeof(nib) - 400, bits, pad);
+        n = woz_bits_to_nibbles(bits, pad, nib2, sizeof(nib2));
+        CHECK(n >= sizeof(nib) - 400 &&
+              memcmp(nib2, nib, sizeof(nib) - 400) == 0,
+              "round %d: padded track misframed", r);
+        for (size_t k = sizeof(nib) - 400; k < n; k++)
+            CHECK(nib2[k] == 0xFF, "round %d: pad nibble %02X", r, nib2[k]);
+    }
+
+    /* ---- images ---- */
+    for (int version = 1; version <= 2; version++) {
+        uint32_t off = build_head(version, 1, (uint8_t)(version == 2), ntrk);
+        uint32_t trks = chunk(off, "TRKS", 0), end;
+        if (version == 1) {
+            for (unsigned t = 0; t < ntrk; t++) {
+                uint8_t *rec = s_img + trks + t * 6656u;
+                tbits[t] = 50000u + t * 13u;
+                memset(rec, (int)t, 6646);
+                put16(rec + 6646, (tbits[t] + 7u) / 8u);
+                put16(rec + 6648, tbits[t]);
+            }
+            end = trks + ntrk * 6656u;
+        } else {
+            uint32_t blk = 3;   /* first bitstream block after the 1280-B table */
+            for (unsigned t = 0; t < ntrk; t++) {
+                tbits[t] = 51000u + t * 7u;
+                uint32_t nblk = (tbits[t] + 4095u) / 4096u;
+                put16(s_img + trks + t * 8u, blk);
+                put16(s_img + trks + t * 8u + 2, nblk);
+                put32(s_img + trks + t * 8u + 4, tbits[t]);
+                memset(s_img + blk * 512u, (int)t, nblk * 512u);
+                blk += nblk;
+            }
+            end = blk * 512u;
+        }
+        put32(s_img + trks - 4, end - trks);
+        s_img_len = end;
+
+        CHECK(woz_parse(mem_read, NULL, s_img_len, &img),
+              "WOZ%d: parse failed", version);
+        CHECK(img.version == version, "WOZ%d: version %u", version, img.version);
+        CHECK(img.write_protected == (version == 2), "WOZ%d: wp flag", version);
+        for (unsigned q = 0; q < WOZ_QTRACKS; q++) {
+            unsigned t = (q + 1) / 4;
+            bool mapped = (q % 4 != 2) && t < ntrk;
+            if (!mapped) {
+                CHECK(img.qtrk[q].bits == 0, "WOZ%d: qtrk %u mapped", version, q);
+                continue;
+            }
+            CHECK(img.qtrk[q].bits == tbits[t] &&
+                  s_img[img.qtrk[q].off] == (uint8_t)t &&
+                  img.qtrk[q].off + (tbits[t] + 7u) / 8u <= s_img_len,
+                  "WOZ%d: qtrk %u -> off %u bits %u", version, q,
+                  (unsigned)img.qtrk[q].off, (unsigned)img.qtrk[q].bits);
+        }
+
+        /* a 3.5" image, a bad signature and a truncated file are refused */
+        s_img[21] = 2;                 /* INFO disk_type */
+        CHECK(!woz_parse(mem_read, NULL, s_img_len, &img),
+              "WOZ%d: 3.5 accepted", version);
+        s_img[21] = 1;
+        s_img[5] = 0;
+        CHECK(!woz_parse(mem_read, NULL, s_img_len, &img),
+              "WOZ%d: bad signature accepted", version);
+        CHECK(!woz_parse(mem_read, NULL, 10, &img),
+              "WOZ%d: short file accepted", version);
+    }
+
+    if (s_fail) {
+        printf("=== FAILED: %d checks ===\n", s_fail);
+        return 1;
+    }
+    printf("round trip: %d random tracks (exact + padded); WOZ1/WOZ2 parse\n",
+           ROUNDS);
+
+    /* ---- benchmark ---- */
+    uint32_t nb = nibble_bits(nib, sizeof(nib));
+    if ((nb + 7u) / 8u > sizeof(bits))
+        nb = (uint32_t)sizeof(bits) * 8u;
+    woz_nibbles_to_bits(nib, sizeof(nib), bits, nb);
+    volatile uint32_t sink = 0;
+    struct timespec a, b;
+    clock_gettime(CLOCK_MONOTONIC, &a);
+    for (int i = 0; i < BENCH_ITERS; i++)
+        sink += (uint32_t)woz_bits_to_nibbles(bits, nb, nib2, sizeof(nib2));
+    clock_gettime(CLOCK_MONOTONIC, &b);
+    double load = BENCH_ITERS / ((double)(b.tv_sec - a.tv_sec) +
+                                 (double)(b.tv_nsec - a.tv_nsec) * 1e-9);
+    clock_gettime(CLOCK_MONOTONIC, &a);
+    for (int i = 0; i < BENCH_ITERS; i++) {
+        woz_nibbles_to_bits(nib, sizeof(nib), bits2, nb);
+        sink += bits2[100];
+    }
+    clock_gettime(CLOCK_MONOTONIC, &b);
+    double store = BENCH_ITERS / ((double)(b.tv_sec - a.tv_sec) +
+                                  (double)(b.tv_nsec - a.tv_nsec) * 1e-9);
+    (void)sink;
+    printf("bits->nibbles %9.0f tracks/s   nibbles->bits %9.0f tracks/s\n",
+           load, store);
+    printf("=== PASSED ===\n");
+    return 0;
+}
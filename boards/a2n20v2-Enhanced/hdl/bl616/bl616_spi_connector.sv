@@ -90,7 +90,18 @@ module bl616_spi_connector #(
     // DEBUG: port-B (SPACE 3) write instrumentation from the card (regs 0x7B-0x7E)
     input  wire [15:0] w5100_dbg_wr_count,
     input  wire [15:0] w5100_dbg_last_addr,
-    input  wire [7:0]  w5100_dbg_last_wdata
+    input  wire [7:0]  w5100_dbg_last_wdata,
+
+    // Storage arbiter statistics -- SPI memory SPACE 5 (read-only bytes;
+    // a write of bit0 snapshots, bit1 clears). 3 clients x 12 bytes:
+    // {16'b0, max_latency[15:0], wait_cycles[31:0], requests[31:0]}
+    input  wire [287:0] arb_stats_i,
+    output wire        arb_snap_o,
+    output wire        arb_clear_o,
+
+    // Framebuffer statistics -- SPI memory SPACE 6 (read-only, 16 bytes).
+    // Burst/skip/high-water counts are the previous frame's totals.
+    input  wire [127:0] fb_stats_i
 );
 
     // -------------------------------------------------------
@@ -114,6 +125,9 @@ module bl616_spi_connector #(
     reg         mem_rd_valid;
     reg  [7:0]  mem_rd_data;
 
+    wire [7:0]  crc_ok_cnt;     // CRC'd XFER writes checked OK / failed
+    wire [7:0]  crc_err_cnt;
+
     // -------------------------------------------------------
     // Instantiate proto processor
     // -------------------------------------------------------
@@ -139,7 +153,9 @@ module bl616_spi_connector #(
         .mem_rd_space(mem_rd_space),
         .mem_rd_addr(mem_rd_addr),
         .mem_rd_valid(mem_rd_valid),
-        .mem_rd_data(mem_rd_data)
+        .mem_rd_data(mem_rd_data),
+        .crc_ok_cnt(crc_ok_cnt),
+        .crc_err_cnt(crc_err_cnt)
     );
 
     // -------------------------------------------------------
@@ -240,7 +256,7 @@ module bl616_spi_connector #(
     localparam [7:0] DEVICE_ID2 = "F";
     localparam [7:0] DEVICE_ID3 = "P";
     localparam [7:0] PROTO_VER  = 8'h01;
-    wire [7:0] CAP0 = {6'b0, USE_CRC[0], 1'b1};
+    wire [7:0] CAP0 = {5'b0, 1'b1, USE_CRC[0], 1'b1};  // [2] SD block engine
 
     // -------------------------------------------------------
     // System timer
@@ -302,6 +318,7 @@ module bl616_spi_connector #(
     reg        hdd_readonly_r [0:1];
     reg [15:0] hdd_size_r     [0:1];
     reg        hdd_ack_r      [0:1];
+    reg        hdd_err_r      [0:1];   // ACK value bit 1: request failed
 
     // Slot config
     reg [7:0] slot_card_r [0:7];
@@ -350,24 +367,28 @@ module bl616_spi_connector #(
     assign volumes[0].readonly = volume_readonly_r[0];
     assign volumes[0].size     = volume_size_r[0];
     assign volumes[0].ack      = volume_ack_r[0];
+    assign volumes[0].err      = 1'b0;
 
     assign volumes[1].ready    = volume_ready_r[1];
     assign volumes[1].mounted  = volume_mounted_r[1];
     assign volumes[1].readonly = volume_readonly_r[1];
     assign volumes[1].size     = volume_size_r[1];
     assign volumes[1].ack      = volume_ack_r[1];
+    assign volumes[1].err      = 1'b0;
 
     assign hdd_volumes[0].ready    = hdd_ready_r[0];
     assign hdd_volumes[0].mounted  = hdd_mounted_r[0];
     assign hdd_volumes[0].readonly = hdd_readonly_r[0];
     assign hdd_volumes[0].size     = {16'b0, hdd_size_r[0]};
     assign hdd_volumes[0].ack      = hdd_ack_r[0];
+    assign hdd_volumes[0].err      = hdd_err_r[0];
 
     assign hdd_volumes[1].ready    = hdd_ready_r[1];
     assign hdd_volumes[1].mounted  = hdd_mounted_r[1];
     assign hdd_volumes[1].readonly = hdd_readonly_r[1];
     assign hdd_volumes[1].size     = {16'b0, hdd_size_r[1]};
     assign hdd_volumes[1].ack      = hdd_ack_r[1];
+    assign hdd_volumes[1].err      = hdd_err_r[1];
 
     // -------------------------------------------------------
     // Interface assignments -- Slotmaker
@@ -463,8 +484,14 @@ module bl616_spi_connector #(
     reg        sdram_rd_resp_valid_r;
     reg [7:0]  sdram_rd_resp_data_r;
 
+    // Posted writes not yet acknowledged. The storage arbiter queues
+    // requests, so a write's ready can arrive after a later read was issued;
+    // reads wait for this to drain so every ready seen with rd_inflight_r
+    // belongs to the read.
+    reg [2:0]  wr_out_r;
+
     // Status bits consumed by register 0x06 (kept under their original names)
-    wire sdram_wr_pending_r = acc_valid_r | ~wf_empty;
+    wire sdram_wr_pending_r = acc_valid_r | ~wf_empty | (wr_out_r != 3'd0);
     wire sdram_rd_pending_r = rd_pending_r | rd_inflight_r;
 
     // SDRAM port driving
@@ -513,6 +540,7 @@ module bl616_spi_connector #(
             mem_if_addr_r <= 21'd0;
             mem_if_data_r <= 32'd0;
             mem_if_be_r   <= 4'b0000;
+            wr_out_r      <= 3'd0;
         end else begin
             // One-shot strobes
             mem_if_wr_r <= 1'b0;
@@ -520,6 +548,9 @@ module bl616_spi_connector #(
             sdram_rd_resp_valid_r <= 1'b0;
 
             // ---- 1) Capture SDRAM read completion (demand or prefetch) ----
+            //         or retire a posted write ----
+            if (mem_if.ready && !rd_inflight_r && wr_out_r != 3'd0)
+                wr_out_r <= wr_out_r - 3'd1;
             if (mem_if.ready && rd_inflight_r) begin
                 rdc_word_r[rd_inflight_slot_r]  <= mem_if.q[31:0];
                 rdc_waddr_r[rd_inflight_slot_r] <= mem_if_addr_r;
@@ -643,14 +674,16 @@ module bl616_spi_connector #(
             // ---- 4) SDRAM arbiter: writes drain before reads (preserves
             //         ordering); demand reads before prefetches ----
             if (mem_if.available && !mem_if_wr_r && !mem_if_rd_r && !rd_inflight_r) begin
-                if (!wf_empty) begin
+                if (!wf_empty && wr_out_r != 3'd7) begin
                     // Pop one queued word -> SDRAM write
                     mem_if_addr_r <= wf_addr_m[wf_rptr_r[WF_AW-1:0]];
                     mem_if_data_r <= wf_data_m[wf_rptr_r[WF_AW-1:0]];
                     mem_if_be_r   <= wf_be_m  [wf_rptr_r[WF_AW-1:0]];
                     mem_if_wr_r   <= 1'b1;
                     wf_rptr_r     <= wf_rptr_r + 1'b1;
-                end else if (rd_pending_r && !acc_valid_r) begin
+                    wr_out_r      <= wr_out_r + 3'd1 -
+                                     ((mem_if.ready && wr_out_r != 3'd0) ? 3'd1 : 3'd0);
+                end else if (rd_pending_r && !acc_valid_r && wr_out_r == 3'd0) begin
                     // All writes drained -> issue the pending SDRAM read
                     mem_if_addr_r <= rd_waddr_r;
                     mem_if_rd_r   <= 1'b1;
@@ -659,7 +692,7 @@ module bl616_spi_connector #(
                     rd_inflight_pf_r   <= 1'b0;
                     rd_inflight_slot_r <= 1'b0;
                     rd_pending_r  <= 1'b0;
-                end else if (pf_pending_r && !acc_valid_r) begin
+                end else if (pf_pending_r && !acc_valid_r && wr_out_r == 3'd0) begin
                     // Idle -> speculative prefetch of the next stream word
                     mem_if_addr_r <= pf_waddr_r;
                     mem_if_rd_r   <= 1'b1;
@@ -761,9 +794,54 @@ module bl616_spi_connector #(
     reg [3:0] w5100_cmd_clr_r;
     assign w5100_cmd_clr = w5100_cmd_clr_r;
 
+    // -------------------------------------------------------
+    // SPACE 5: storage arbiter statistics (read-only snapshot)
+    // -------------------------------------------------------
+    reg       arb_rd_valid_q;
+    reg [7:0] arb_rd_data_q;
+
+    assign arb_snap_o  = mem_wr_en && (mem_space == 3'd5) && mem_wr_data[0];
+    assign arb_clear_o = mem_wr_en && (mem_space == 3'd5) && mem_wr_data[1];
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            arb_rd_valid_q <= 1'b0;
+            arb_rd_data_q  <= 8'h00;
+        end else begin
+            arb_rd_valid_q <= 1'b0;
+            if (mem_rd_req && (mem_rd_space == 3'd5)) begin
+                arb_rd_data_q  <= (mem_rd_addr[5:0] < 6'd36) ?
+                                  arb_stats_i[mem_rd_addr[5:0]*8 +: 8] : 8'h00;
+                arb_rd_valid_q <= 1'b1;
+            end
+        end
+    end
+
+    // -------------------------------------------------------
+    // SPACE 6: framebuffer statistics (read-only)
+    // -------------------------------------------------------
+    reg       fbst_rd_valid_q;
+    reg [7:0] fbst_rd_data_q;
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            fbst_rd_valid_q <= 1'b0;
+            fbst_rd_data_q  <= 8'h00;
+        end else begin
+            fbst_rd_valid_q <= 1'b0;
+            if (mem_rd_req && (mem_rd_space == 3'd6)) begin
+                fbst_rd_data_q  <= fb_stats_i[mem_rd_addr[3:0]*8 +: 8];
+                fbst_rd_valid_q <= 1'b1;
+            end
+        end
+    end
+
     // -------------------------------------------------------
     // Memory read mux (combines all spaces)
     // -------------------------------------------------------
+    wire [7:0] sdblk_rd_data_w;    // SPACE 4: SD block buffer (fpga_sd_blk below)
+    wire       sdblk_rd_valid_w;
+
     always @(*) begin
         mem_rd_valid = 1'b0;
         mem_rd_data  = 8'hFF;
@@ -779,11 +857,20 @@ module bl616_spi_connector #(
         end else if (w5100_rd_valid_q) begin
             mem_rd_valid = 1'b1;
             mem_rd_data  = w5100_rd_data_q;
+        end else if (sdblk_rd_valid_w) begin
+            mem_rd_valid = 1'b1;
+            mem_rd_data  = sdblk_rd_data_w;
+        end else if (arb_rd_valid_q) begin
+            mem_rd_valid = 1'b1;
+            mem_rd_data  = arb_rd_data_q;
+        end else if (fbst_rd_valid_q) begin
+            mem_rd_valid = 1'b1;
+            mem_rd_data  = fbst_rd_data_q;
         end
     end
 
     // -------------------------------------------------------
-    // SD card SPI master (regs 0x6C-0x6E)
+    // SD card SPI master (regs 0x6C-0x6F, block buffer SPACE 4)
     // -------------------------------------------------------
     reg        sd_cs_n_r;
     reg        sd_slow_clk_r;
@@ -792,6 +879,34 @@ module bl616_spi_connector #(
     wire [7:0] sd_rx_data_w;
     wire       sd_busy_w;
 
+    // Block engine: owns the byte engine while a block command runs
+    reg  [7:0] sdblk_cmd_r;
+    reg        sdblk_stb_r;
+    wire       sdblk_busy_w;
+    wire       sdblk_err_w;
+    wire       sdblk_start_w;
+    wire [7:0] sdblk_data_w;
+
+    fpga_sd_blk fpga_sd_blk_inst (
+        .clk(clk),
+        .rst_n(rst_n),
+        .cmd_i(sdblk_cmd_r),
+        .cmd_stb_i(sdblk_stb_r),
+        .busy_o(sdblk_busy_w),
+        .err_o(sdblk_err_w),
+        .spi_start_o(sdblk_start_w),
+        .spi_data_o(sdblk_data_w),
+        .spi_rx_i(sd_rx_data_w),
+        .spi_busy_i(sd_busy_w),
+        .buf_wr_i(mem_wr_en && (mem_space == 3'd4)),
+        .buf_wr_addr_i(mem_wr_addr[8:0]),
+        .buf_wr_data_i(mem_wr_data),
+        .buf_rd_i(mem_rd_req && (mem_rd_space == 3'd4)),
+        .buf_rd_addr_i(mem_rd_addr[8:0]),
+        .buf_rd_data_o(sdblk_rd_data_w),
+        .buf_rd_valid_o(sdblk_rd_valid_w)
+    );
+
     fpga_sd_spi #(
         .CLOCK_SPEED_HZ(CLOCK_SPEED_HZ)
     ) fpga_sd_spi_inst (
@@ -799,8 +914,8 @@ module bl616_spi_connector #(
         .rst_n(rst_n),
         .cs_n_i(sd_cs_n_r),
         .slow_clk_i(sd_slow_clk_r),
-        .tx_start_i(sd_tx_start_r),
-        .tx_data_i(sd_tx_data_r),
+        .tx_start_i(sdblk_busy_w ? sdblk_start_w : sd_tx_start_r),
+        .tx_data_i(sdblk_busy_w ? sdblk_data_w : sd_tx_data_r),
         .rx_data_o(sd_rx_data_w),
         .busy_o(sd_busy_w),
         .sd_clk_o(sd_clk_o),
@@ -885,9 +1000,11 @@ module bl616_spi_connector #(
             7'h26: reg_rdata = {6'b0, hdd_volumes[0].wr, hdd_volumes[0].rd};
             7'h27: reg_rdata = hdd_volumes[0].lba[7:0];
             7'h28: reg_rdata = hdd_volumes[0].lba[15:8];
+            7'h29: reg_rdata = {2'b0, hdd_volumes[0].blk_cnt};   // blocks - 1
             7'h2A: reg_rdata = {6'b0, hdd_volumes[1].wr, hdd_volumes[1].rd};
             7'h2B: reg_rdata = hdd_volumes[1].lba[7:0];
             7'h2C: reg_rdata = hdd_volumes[1].lba[15:8];
+            7'h2D: reg_rdata = {2'b0, hdd_volumes[1].blk_cnt};
             7'h2E: reg_rdata = {7'b0, a2_rst_release_r};
             7'h2F: reg_rdata = ssc_ctl_i;   // SSC 6551 CTL (baud in [3:0])
 
@@ -925,6 +1042,7 @@ module bl616_spi_connector #(
             7'h4C: reg_rdata = {2'b0, volumes[0].blk_cnt};
             7'h4D: reg_rdata = {7'b0, volumes[0].rd};
             7'h4E: reg_rdata = {7'b0, volumes[0].wr};
+            7'h4F: reg_rdata = crc_ok_cnt;    // XFER_CRC_OK
 
             // Page 5: Volume 1
             7'h50: reg_rdata = {7'b0, volume_ready_r[1]};
@@ -942,6 +1060,7 @@ module bl616_spi_connector #(
             7'h5C: reg_rdata = {2'b0, volumes[1].blk_cnt};
             7'h5D: reg_rdata = {7'b0, volumes[1].rd};
             7'h5E: reg_rdata = {7'b0, volumes[1].wr};
+            7'h5F: reg_rdata = crc_err_cnt;   // XFER_CRC_ERR
 
             // Page 6: Slot config & GPIO
             7'h60: reg_rdata = slot_card_r[0];
@@ -960,6 +1079,7 @@ module bl616_spi_connector #(
             7'h6C: reg_rdata = {6'b0, sd_slow_clk_r, sd_cs_n_r};
             7'h6D: reg_rdata = sd_rx_data_w;
             7'h6E: reg_rdata = {7'b0, sd_busy_w};
+            7'h6F: reg_rdata = {6'b0, sdblk_err_w, sdblk_busy_w};
 
             // Page 7: Bus event FIFO
             7'h70: reg_rdata = {fifo_empty, fifo_full, 6'b0};
@@ -1025,6 +1145,7 @@ module bl616_spi_connector #(
                 hdd_readonly_r[i]    <= 1'b0;
                 hdd_size_r[i]        <= 16'd0;
                 hdd_ack_r[i]         <= 1'b0;
+                hdd_err_r[i]         <= 1'b0;
             end
             for (i = 0; i < 8; i = i + 1)
                 slot_card_r[i] <= 8'd0;
@@ -1052,6 +1173,8 @@ module bl616_spi_connector #(
             sd_slow_clk_r    <= 1'b1;
             sd_tx_data_r     <= 8'hFF;
             sd_tx_start_r    <= 1'b0;
+            sdblk_cmd_r      <= 8'h00;
+            sdblk_stb_r      <= 1'b0;
             w5100_cmd_clr_r  <= 4'd0;
         end else begin
             // One-shot clears
@@ -1064,6 +1187,7 @@ module bl616_spi_connector #(
             slot_reconfig_r   <= 1'b0;
             fifo_reg_pop_r    <= 1'b0;
             sd_tx_start_r     <= 1'b0;
+            sdblk_stb_r       <= 1'b0;
             w5100_cmd_clr_r   <= 4'd0;
 
             // A2 reset edge detection
@@ -1145,7 +1269,10 @@ module bl616_spi_connector #(
                     end
                     7'h27: hdd_size_r[0][7:0]  <= reg_wdata;
                     7'h28: hdd_size_r[0][15:8] <= reg_wdata;
-                    7'h29: hdd_ack_r[0]        <= 1'b1;
+                    7'h29: begin   // ACK: b1 = request failed
+                        hdd_ack_r[0] <= 1'b1;
+                        hdd_err_r[0] <= reg_wdata[1];
+                    end
                     7'h2A: begin
                         hdd_readonly_r[1] <= reg_wdata[2];
                         hdd_mounted_r[1]  <= reg_wdata[1];
@@ -1153,7 +1280,10 @@ module bl616_spi_connector #(
                     end
                     7'h2B: hdd_size_r[1][7:0]  <= reg_wdata;
                     7'h2C: hdd_size_r[1][15:8] <= reg_wdata;
-                    7'h2D: hdd_ack_r[1]        <= 1'b1;
+                    7'h2D: begin
+                        hdd_ack_r[1] <= 1'b1;
+                        hdd_err_r[1] <= reg_wdata[1];
+                    end
                     7'h3F: ver_idx_r           <= reg_wdata[3:0];
                     7'h2E: a2_rst_release_r    <= reg_wdata[0];
 
@@ -1181,6 +1311,10 @@ module bl616_spi_connector #(
                         sd_tx_data_r  <= reg_wdata;
                         sd_tx_start_r <= 1'b1;
                     end
+                    7'h6F: begin
+                        sdblk_cmd_r <= reg_wdata;
+                        sdblk_stb_r <= 1'b1;
+                    end
 
                     // Page 7: Bus event FIFO control
                     7'h77: fifo_reg_pop_r  <= 1'b1;  // FIFO_POP
@@ -31,9 +31,30 @@ module bl616_spi_proto_proc #(
     output reg  [2:0]  mem_rd_space,
     output reg  [23:0] mem_rd_addr,
     input  wire        mem_rd_valid,
-    input  wire [7:0]  mem_rd_data
+    input  wire [7:0]  mem_rd_data,
+
+    // CRC'd XFER writes whose trailer matched / did not (mod 256)
+    output reg  [7:0]  crc_ok_cnt,
+    output reg  [7:0]  crc_err_cnt
 );
 
+    // XFER CRC (SUB0[5], with USE_CRC): CRC-16/CCITT-FALSE (poly 0x1021,
+    // init 0xFFFF) over SUB0, ADDR0-2, LEN0-1 and the payload, sent MSB first
+    // after the payload — by the MCU on writes, by us on reads. Writes also
+    // carry the CRC of the header alone right after LEN1, checked before the
+    // first payload byte is committed: a write whose header fails is dropped
+    // whole instead of landing at the wrong address or length.
+    function [15:0] crc16_byte(input [15:0] c, input [7:0] d);
+        integer i;
+        reg [15:0] x;
+        begin
+            x = c ^ {d, 8'h00};
+            for (i = 0; i < 8; i = i + 1)
+                x = x[15] ? ({x[14:0], 1'b0} ^ 16'h1021) : {x[14:0], 1'b0};
+            crc16_byte = x;
+        end
+    endfunction
+
     // =========================================================
     // SPI CLOCK DOMAIN — RX shift register
     // Mode 1: sample MOSI on falling SCLK edge (negedge)
@@ -132,7 +153,9 @@ module bl616_spi_proto_proc #(
         ST_XPAY_WR     = 4'd9,
         ST_XPAY_RD_DMY = 4'd10,
         ST_XPAY_RD     = 4'd11,
-        ST_DONE        = 4'd12;
+        ST_DONE        = 4'd12,
+        ST_XCRC        = 4'd13,
+        ST_XHDRC       = 4'd14;
     reg [3:0] st;
 
     // Header fields
@@ -143,6 +166,11 @@ module bl616_spi_proto_proc #(
     reg [15:0] len, len_cnt;
     reg        sub_dir, sub_crc, sub_inc;
     reg [2:0]  sub_space;
+    reg [15:0] xcrc;       // header + payload (written or loaded for TX)
+    reg        crc_idx;    // trailer byte 0 (MSB) / 1
+    reg [7:0]  crc_rx_hi;
+    reg        hdr_bad;    // write header CRC failed: drop the payload
+    wire       crc_on = (USE_CRC != 0) && sub_crc;
 
     // Read pipeline
     reg [7:0] rd_buf;
@@ -175,6 +203,12 @@ module bl616_spi_proto_proc #(
             sub_crc       <= 1'b0;
             sub_inc       <= 1'b0;
             sub_space     <= 3'd0;
+            xcrc          <= 16'hFFFF;
+            crc_idx       <= 1'b0;
+            crc_rx_hi     <= 8'h00;
+            hdr_bad       <= 1'b0;
+            crc_ok_cnt    <= 8'h00;
+            crc_err_cnt   <= 8'h00;
             rd_buf        <= 8'h00;
             rd_buf_valid  <= 1'b0;
             reg_rd_pending <= 1'b0;
@@ -215,8 +249,10 @@ module bl616_spi_proto_proc #(
                 if (mem_rd_valid) begin
                     rd_buf       <= mem_rd_data;
                     rd_buf_valid <= 1'b1;
-                    if (st == ST_XPAY_RD || st == ST_XPAY_RD_DMY)
+                    if (st == ST_XPAY_RD || st == ST_XPAY_RD_DMY) begin
                         tx_byte <= mem_rd_data;
+                        xcrc    <= crc16_byte(xcrc, mem_rd_data);
+                    end
                 end
 
                 if (byte_rx_stb) begin
@@ -287,21 +323,41 @@ module bl616_spi_proto_proc #(
                             sub_crc   <= spi_rx_byte[5];
                             addr      <= 24'd0;
                             len       <= 16'd0;
+                            hdr_bad   <= 1'b0;
+                            xcrc      <= crc16_byte(16'hFFFF, spi_rx_byte);
                             st <= ST_XA0;
                         end
-                        ST_XA0: begin addr[7:0]   <= spi_rx_byte; st <= ST_XA1; end
-                        ST_XA1: begin addr[15:8]  <= spi_rx_byte; st <= ST_XA2; end
-                        ST_XA2: begin addr[23:16] <= spi_rx_byte; st <= ST_XL0; end
-                        ST_XL0: begin len[7:0]    <= spi_rx_byte; st <= ST_XL1; end
+                        ST_XA0: begin addr[7:0]   <= spi_rx_byte; xcrc <= crc16_byte(xcrc, spi_rx_byte); st <= ST_XA1; end
+                        ST_XA1: begin addr[15:8]  <= spi_rx_byte; xcrc <= crc16_byte(xcrc, spi_rx_byte); st <= ST_XA2; end
+                        ST_XA2: begin addr[23:16] <= spi_rx_byte; xcrc <= crc16_byte(xcrc, spi_rx_byte); st <= ST_XL0; end
+                        ST_XL0: begin len[7:0]    <= spi_rx_byte; xcrc <= crc16_byte(xcrc, spi_rx_byte); st <= ST_XL1; end
                         ST_XL1: begin
                             len[15:8]    <= spi_rx_byte;
+                            xcrc         <= crc16_byte(xcrc, spi_rx_byte);
                             len_cnt      <= {spi_rx_byte, len[7:0]};
                             mem_space    <= sub_space;
                             mem_rd_space <= sub_space;
+                            crc_idx      <= 1'b0;
                             if (sub_dir) begin
                                 tx_byte <= 8'hFF; // dummy byte for read
                                 st <= ST_XPAY_RD_DMY;
                             end else begin
+                                st <= crc_on ? ST_XHDRC : ST_XPAY_WR;
+                            end
+                        end
+
+                        // Write header CRC, two bytes (not part of xcrc,
+                        // which goes on over the payload for the trailer)
+                        ST_XHDRC: begin
+                            crc_idx <= 1'b1;
+                            if (!crc_idx) begin
+                                crc_rx_hi <= spi_rx_byte;
+                            end else begin
+                                if ({crc_rx_hi, spi_rx_byte} != xcrc) begin
+                                    hdr_bad       <= 1'b1;
+                                    crc_err_cnt   <= crc_err_cnt + 8'd1;
+                                    status_crcerr <= 1'b1;
+                                end
                                 st <= ST_XPAY_WR;
                             end
                         end
@@ -311,12 +367,18 @@ module bl616_spi_proto_proc #(
                             if (len_cnt == 16'd0) begin
                                 st <= ST_DONE;
                             end else begin
+                                // a bad header still consumes its LEN
+                                // bytes, unwritten
                                 mem_wr_addr <= addr;
                                 mem_wr_data <= spi_rx_byte;
-                                mem_wr_en   <= 1'b1;
+                                mem_wr_en   <= !hdr_bad;
+                                xcrc        <= crc16_byte(xcrc, spi_rx_byte);
                                 len_cnt <= len_cnt - 16'd1;
                                 if (sub_inc) addr <= addr + 24'd1;
-                                if (len_cnt == 16'd1) st <= ST_DONE;
+                                if (len_cnt == 16'd1) begin
+                                    crc_idx <= 1'b0;
+                                    st <= crc_on ? ST_XCRC : ST_DONE;
+                                end
                             end
                         end
 
@@ -339,6 +401,10 @@ module bl616_spi_proto_proc #(
                                     mem_rd_addr <= sub_inc ? (addr + 24'd1) : addr;
                                     mem_rd_req  <= 1'b1;
                                     if (sub_inc) addr <= addr + 24'd1;
+                                end else if (crc_on) begin
+                                    tx_byte <= xcrc[15:8];
+                                    crc_idx <= 1'b0;
+                                    st <= ST_XCRC;
                                 end else begin
                                     tx_byte <= status_byte;
                                 end
@@ -346,6 +412,29 @@ module bl616_spi_proto_proc #(
                             end
                         end
 
+                        // CRC trailer, two bytes: sent by us after a read
+                        // payload, checked after a write payload. The payload
+                        // has landed by now, but only at the address and
+                        // length the MCU meant (ST_XHDRC); the counters tell
+                        // it whether to send the data again. A frame whose
+                        // header failed was counted there.
+                        ST_XCRC: begin
+                            crc_idx <= 1'b1;
+                            if (sub_dir) begin
+                                tx_byte <= crc_idx ? status_byte : xcrc[7:0];
+                            end else if (hdr_bad) begin
+                                // counted in ST_XHDRC
+                            end else if (!crc_idx) begin
+                                crc_rx_hi <= spi_rx_byte;
+                            end else if ({crc_rx_hi, spi_rx_byte} == xcrc) begin
+                                crc_ok_cnt <= crc_ok_cnt + 8'd1;
+                            end else begin
+                                crc_err_cnt   <= crc_err_cnt + 8'd1;
+                                status_crcerr <= 1'b1;
+                            end
+                            if (crc_idx) st <= ST_DONE;
+                        end
+
                         default: st <= ST_IDLE;
                     endcase
                 end
@@ -0,0 +1,214 @@
+// Block engine for the FPGA-side SD SPI master.
+//
+// Moves a whole 512-byte SD data block between the card and a local buffer
+// without the MCU touching each byte: the MCU fills or drains the buffer with
+// one XFER (SPACE 4) and starts the block with one register write (0x6F),
+// instead of three register transactions per byte through 0x6D/0x6E.
+//
+// Commands (cmd_i, strobed by cmd_stb_i):
+//   0x01       receive a data block: clock 0xFF until the 0xFE start token
+//              (timeout -> err), then 512 bytes into the buffer and the two
+//              CRC bytes (discarded)
+//   0x02       wait ready: clock 0xFF until the card returns 0xFF
+//              (write-busy over; timeout -> err)
+//   0xFE/0xFC  send a data block with this start token: token, 512 bytes from
+//              the buffer, dummy CRC, then the data response (not accepted
+//              -> err)
+//
+// The engine drives fpga_sd_spi's start/data inputs while busy_o is high;
+// CS# and the clock select stay with the register interface.
+
+module fpga_sd_blk (
+    input  wire       clk,
+    input  wire       rst_n,
+
+    input  wire [7:0] cmd_i,
+    input  wire       cmd_stb_i,
+    output wire       busy_o,
+    output reg        err_o,
+
+    // To/from fpga_sd_spi
+    output reg        spi_start_o,
+    output reg  [7:0] spi_data_o,
+    input  wire [7:0] spi_rx_i,
+    input  wire       spi_busy_i,
+
+    // Buffer, MCU side (XFER SPACE 4); one-cycle read latency
+    input  wire       buf_wr_i,
+    input  wire [8:0] buf_wr_addr_i,
+    input  wire [7:0] buf_wr_data_i,
+    input  wire       buf_rd_i,
+    input  wire [8:0] buf_rd_addr_i,
+    output reg  [7:0] buf_rd_data_o,
+    output reg        buf_rd_valid_o
+);
+
+    localparam [2:0]
+        S_IDLE  = 3'd0,
+        S_LOAD  = 3'd1,   // buffer read for the next TX byte
+        S_START = 3'd2,   // pulse spi_start_o
+        S_ISSUE = 3'd3,   // fpga_sd_spi raises busy the cycle after start
+        S_XFER  = 3'd4;   // wait for the byte, then act on it (phase)
+
+    localparam [2:0]
+        P_RTOK  = 3'd0,
+        P_RDATA = 3'd1,
+        P_RCRC  = 3'd2,
+        P_WAIT  = 3'd3,
+        P_TTOK  = 3'd4,
+        P_TDATA = 3'd5,
+        P_TCRC  = 3'd6,
+        P_TRESP = 3'd7;
+
+    reg [2:0]  st;
+    reg [2:0]  phase;
+    reg [9:0]  cnt;
+    reg [19:0] tmo;       // bytes clocked while waiting (~1.2 s at 6.75 MHz)
+
+    assign busy_o = (st != S_IDLE);
+
+    // 512-byte buffer: one write and one read port, each shared between the
+    // MCU (idle) and the engine (busy).
+    reg  [7:0] buffer [0:511];
+    reg  [7:0] eng_rd_q;
+    wire       eng_wr = (st == S_XFER) && !spi_busy_i && (phase == P_RDATA);
+
+    always @(posedge clk) begin
+        if (eng_wr)
+            buffer[cnt[8:0]] <= spi_rx_i;
+        else if (buf_wr_i && !busy_o)
+            buffer[buf_wr_addr_i] <= buf_wr_data_i;
+    end
+
+    always @(posedge clk) begin
+        eng_rd_q <= buffer[busy_o ? cnt[8:0] : buf_rd_addr_i];
+    end
+
+    // MCU reads see the shared port one cycle after the request (0xFF while
+    // the engine owns it).
+    reg mcu_rd_q;
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            buf_rd_valid_o <= 1'b0;
+            mcu_rd_q       <= 1'b0;
+        end else begin
+            buf_rd_valid_o <= buf_rd_i;
+            mcu_rd_q       <= buf_rd_i && !busy_o;
+        end
+    end
+
+    always @(*) begin
+        buf_rd_data_o = mcu_rd_q ? eng_rd_q : 8'hFF;
+    end
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            st          <= S_IDLE;
+            phase       <= P_RTOK;
+            cnt         <= 10'd0;
+            tmo         <= 20'd0;
+            err_o       <= 1'b0;
+            spi_start_o <= 1'b0;
+            spi_data_o  <= 8'hFF;
+        end else begin
+            spi_start_o <= 1'b0;
+
+            case (st)
+                S_IDLE: begin
+                    if (cmd_stb_i) begin
+                        err_o <= 1'b0;
+                        cnt   <= 10'd0;
+                        tmo   <= 20'd0;
+                        st    <= S_START;
+                        spi_data_o <= 8'hFF;
+                        case (cmd_i)
+                            8'h01:        phase <= P_RTOK;
+                            8'h02:        phase <= P_WAIT;
+                            8'hFE, 8'hFC: begin
+                                phase      <= P_TTOK;
+                                spi_data_o <= cmd_i;
+                            end
+                            default:      st <= S_IDLE;
+                        endcase
+                    end
+                end
+
+                S_LOAD: begin
+                    st <= S_START;   // eng_rd_q holds buffer[cnt] next cycle
+                end
+
+                S_START: begin
+                    if (phase == P_TDATA)
+                        spi_data_o <= eng_rd_q;
+                    spi_start_o <= 1'b1;
+                    st <= S_ISSUE;
+                end
+
+                S_ISSUE: st <= S_XFER;
+
+                S_XFER: if (!spi_busy_i) begin
+                    st <= S_START;          // default: clock another 0xFF
+                    spi_data_o <= 8'hFF;
+                    case (phase)
+                        P_RTOK: begin
+                            tmo <= tmo + 20'd1;
+                            if (spi_rx_i == 8'hFE) begin
+                                phase <= P_RDATA;
+                            end else if (spi_rx_i != 8'hFF || &tmo[16:0]) begin
+                                err_o <= 1'b1;   // error token or ~150 ms
+                                st    <= S_IDLE;
+                            end
+                        end
+                        P_RDATA: begin
+                            cnt <= cnt + 10'd1;
+                            if (cnt == 10'd511) begin
+                                cnt   <= 10'd0;
+                                phase <= P_RCRC;
+                            end
+                        end
+                        P_RCRC: begin
+                            cnt <= cnt + 10'd1;
+                            if (cnt == 10'd1)
+                                st <= S_IDLE;
+                        end
+                        P_WAIT: begin
+                            tmo <= tmo + 20'd1;
+                            if (spi_rx_i == 8'hFF) begin
+                                st <= S_IDLE;
+                            end else if (&tmo) begin
+                                err_o <= 1'b1;
+                                st    <= S_IDLE;
+                            end
+                        end
+                        P_TTOK: begin
+                            phase <= P_TDATA;
+                            st    <= S_LOAD;
+                        end
+                        P_TDATA: begin
+                            cnt <= cnt + 10'd1;
+                            st  <= S_LOAD;
+                            if (cnt == 10'd511) begin
+                                cnt   <= 10'd0;
+                                phase <= P_TCRC;
+                                st    <= S_START;
+                            end
+                        end
+                        P_TCRC: begin
+                            cnt <= cnt + 10'd1;
+                            if (cnt == 10'd1)
+                                phase <= P_TRESP;
+                        end
+                        P_TRESP: begin
+                            if (spi_rx_i[4:0] != 5'b00101)
+                                err_o <= 1'b1;
+                            st <= S_IDLE;
+                        end
+                    endcase
+                end
+
+                default: st <= S_IDLE;
+            endcase
+        end
+    end
+
+endmodule
@@ -266,7 +266,7 @@ module top #(
     // Framebuffer config (requires ENSONIQ + BL616_SPI). sdram_ports'
     // arbitration cone fails 108 MHz above 7 ports, so the three storage
     // clients (MCU XFER, Disk II window, HDD window) share one port through
-    // mem_port_arb.
+    // mem_port_arb_pipe.
     // The DOC has the hardest real-time deadline in the system (missed
     // oscillator fetches are audible pops), so it sits directly behind the
     // framebuffer ports. Video reads and CPU writes are latency-tolerant
@@ -278,7 +278,7 @@ module top #(
     localparam GLU_MEM_PORT      = 3;
     localparam VIDEO_MEM_PORT    = 4;   // shadow reads (apple_video_gen + VGC via arbiter)
     localparam MAIN_MEM_PORT     = 5;   // CPU shadow/aux writes
-    localparam STORAGE_MEM_PORT  = 6;   // MCU + Disk II + HDD via mem_port_arb
+    localparam STORAGE_MEM_PORT  = 6;   // MCU + Disk II + HDD via mem_port_arb_pipe
     localparam NUM_PORTS         = 7;
 `else
     localparam VIDEO_MEM_PORT = 0;
@@ -324,9 +324,9 @@ module top #(
     // free SDRAM at byte 0x200000 (word 0x080000). The MCU streams a track here
     // via XFER SPACE 1; drive d's window is byte 0x200000 + d*0x2000.
     localparam [PORT_ADDR_WIDTH-1:0] DISK_WORD_BASE    = 21'h080000;  // byte 0x200000
-    // ProDOS HDD block windows: 2 units x 512 bytes, one block each, right
-    // after the Disk II track windows. The MCU streams a block here via XFER
-    // SPACE 1; unit u's window is byte 0x204000 + u*0x200.
+    // ProDOS HDD block rings: 2 units x 8 blocks x 512 bytes, right after the
+    // Disk II track windows. The MCU streams a run of blocks here via XFER
+    // SPACE 1; block b of unit u is at byte 0x204000 + u*0x1000 + (b%8)*0x200.
     localparam [PORT_ADDR_WIDTH-1:0] HDD_WORD_BASE     = 21'h081000;  // byte 0x204000
     // Framebuffer pixel storage (VIDEO_FRAMEBUFFER config): 1.5MB in, well
     // above every other region.
@@ -352,6 +352,20 @@ module top #(
     wire sdram_init_complete_raw;  // from sdram_ports (108 MHz domain)
 `endif
 
+`ifdef VIDEO_FRAMEBUFFER
+    // FB_WRITE_PORT write-back sideband (words 1-7 + per-word enables).
+    // Registered on the 108 MHz clock exactly like mem_port_cdc's request
+    // path, so sdram_ports samples it on the same edge as the port's wr.
+    wire [223:0] fb_wide_data_hi_w;
+    wire [7:0]   fb_wide_word_en_w;
+    reg  [223:0] fb_wide_data_hi_sdram_r;
+    reg  [7:0]   fb_wide_word_en_sdram_r;
+    always @(posedge clk_sdram_w) begin
+        fb_wide_data_hi_sdram_r <= fb_wide_data_hi_w;
+        fb_wide_word_en_sdram_r <= fb_wide_word_en_w;
+    end
+`endif
+
     sdram_ports #(
         .CLOCK_SPEED_MHZ(MEM_CLOCK_MHZ),
         .NUM_PORTS(NUM_PORTS),
@@ -362,6 +376,10 @@ module top #(
                           ENSONIQ_WORD_BASE, ENSONIQ_WORD_BASE,
                           SHADOW_WORD_BASE, SHADOW_WORD_BASE,
                           SHADOW_WORD_BASE}),
+        // Scanline fetches as 8-word chained bursts, pixel writes as 8-word
+        // write-backs (FB_WORD_BASE and every line base are 8-word aligned)
+        .READ_BURST8_PORT(FB_READ_PORT),
+        .WIDE_WR_PORT(FB_WRITE_PORT),
 `elsif ENSONIQ
     `ifdef BL616_SPI
         .PORT_BASE_ADDR('{SHADOW_WORD_BASE, SHADOW_WORD_BASE,
@@ -409,6 +427,13 @@ module top #(
 
         .ports(mem_ports),
 `endif
+`ifdef VIDEO_FRAMEBUFFER
+        .wide_wr_data_hi(fb_wide_data_hi_sdram_r),
+        .wide_wr_word_en(fb_wide_word_en_sdram_r),
+`else
+        .wide_wr_data_hi('0),
+        .wide_wr_word_en('0),
+`endif
 
         .SDRAM_DQ(IO_sdram_dq),
         .SDRAM_A(O_sdram_addr),
@@ -622,10 +647,17 @@ module top #(
     assign f18a_gpu_if.raddr = 13'b0;
     assign f18a_gpu_if.gstatus = 7'b0;
 
+    // Arbiter stats snapshot/clear strobes (driven by the SPI connector)
+    wire arb_snap_w;
+    wire arb_clear_w;
+
 `ifdef VIDEO_FRAMEBUFFER
     // Storage clients (MCU XFER, Disk II window, HDD window) share one
-    // controller port — see the port map note. MCU first (it streams whole
-    // tracks/blocks and the others wait on its acks anyway).
+    // controller port — see the port map note. The pipelined arbiter queues
+    // two requests per client and overlaps issue with data return. Disk II
+    // is latency-critical (drive_ii must have its track word within one
+    // nibble time) and pre-empts; otherwise the MCU gets 4 grants per turn
+    // for bulk XFER streams, HDD 2.
     mem_port_if #(
         .PORT_ADDR_WIDTH(PORT_ADDR_WIDTH),
         .DATA_WIDTH(DATA_WIDTH),
@@ -633,21 +665,46 @@ module top #(
         .PORT_OUTPUT_WIDTH(PORT_OUTPUT_WIDTH)
     ) storage_ports[2:0] ();
 
-    mem_port_arb #(
+    wire [31:0] storage_dbg_req_w    [2:0];
+    wire [31:0] storage_dbg_wait_w   [2:0];
+    wire [15:0] storage_dbg_max_lat_w[2:0];
+    wire [15:0] storage_dbg_drop_w   [2:0];
+
+    mem_port_arb_pipe #(
         .NUM_CLIENTS(3),
         .PORT_ADDR_WIDTH(PORT_ADDR_WIDTH),
         .DATA_WIDTH(DATA_WIDTH),
         .DQM_WIDTH(DQM_WIDTH),
         .PORT_OUTPUT_WIDTH(PORT_OUTPUT_WIDTH),
         // Replaces the PORT_BASE_ADDR each client's dedicated port had
-        .CLIENT_BASE_ADDR('{SHADOW_WORD_BASE, DISK_WORD_BASE, HDD_WORD_BASE})
+        .CLIENT_BASE_ADDR('{SHADOW_WORD_BASE, DISK_WORD_BASE, HDD_WORD_BASE}),
+        .QUEUE_LOG2(1),
+        .BURST_BEATS(2),                // sdram_ports READ_BURST_LENGTH 8 / 4 bytes
+        .CLIENT_WEIGHT('{4'd4, 4'd1, 4'd2}),
+        .CLIENT_CRITICAL(3'b010)
     ) storage_arb (
         .clk_i(clk_logic_w),
         .rst_n_i(device_reset_n_w),
         .clients(storage_ports),
-        .controller(mem_ports[STORAGE_MEM_PORT])
+        .controller(mem_ports[STORAGE_MEM_PORT]),
+        .dbg_snap_i(arb_snap_w),
+        .dbg_clear_i(arb_clear_w),
+        .dbg_req_o(storage_dbg_req_w),
+        .dbg_wait_o(storage_dbg_wait_w),
+        .dbg_max_lat_o(storage_dbg_max_lat_w),
+        .dbg_drop_o(storage_dbg_drop_w)
     );
+
+    // XFER SPACE 5 layout: client c at byte c*12
+    wire [287:0] arb_stats_w = {
+        storage_dbg_drop_w[2], storage_dbg_max_lat_w[2], storage_dbg_wait_w[2], storage_dbg_req_w[2],
+        storage_dbg_drop_w[1], storage_dbg_max_lat_w[1], storage_dbg_wait_w[1], storage_dbg_req_w[1],
+        storage_dbg_drop_w[0], storage_dbg_max_lat_w[0], storage_dbg_wait_w[0], storage_dbg_req_w[0]};
+`else
+    wire [287:0] arb_stats_w = 288'h0;
 `endif
+    // XFER SPACE 6: framebuffer previous-frame counters (driven below)
+    wire [127:0] fb_stats_w;
 
     drive_volume_if volumes[2]();
 
@@ -679,14 +736,16 @@ module top #(
     wire [7:0] hdd_d_w;
     wire hdd_rd;
 
-    // ProDOS hard disk (block device). The card requests one 512-byte block
-    // at a time over hdd_volumes[] (compact BL616 regs 0x26-0x2D); the BL616
-    // serves it from a .hdv/.po image into the HDD_MEM_PORT SDRAM window via
-    // XFER SPACE 1, then pulses ack and the card streams it to the 6502
-    // through its sector buffer.
+    // ProDOS hard disk (block device). The card requests a run of up to 8
+    // blocks over hdd_volumes[] (compact BL616 regs 0x26-0x2D, blk_cnt
+    // readable at the ACK address); the BL616 serves it from a .hdv/.po image
+    // into the unit's HDD_MEM_PORT SDRAM ring via one XFER SPACE 1 write,
+    // then pulses ack. The card streams blocks to the 6502 through its sector
+    // buffer, taking later blocks of the run straight from the ring.
     HDD #(
         .ENABLE(HDD_ENABLE),
-        .ID(HDD_ID)
+        .ID(HDD_ID),
+        .RING_LOG2(3)           // 8 x 512 B per unit, see HDD_WORD_BASE
     ) hdd (
         .a2bus_if(a2bus_if),
         .slot_if(slot_if),
@@ -751,7 +810,7 @@ module top #(
     wire [7:0]  u2_dbg_last_wdata_w;
 
     bl616_spi_connector #(
-        .USE_CRC(0),
+        .USE_CRC(1),
         .CLOCK_SPEED_HZ(CLOCK_SPEED_HZ),
         .VERSION_STR(`BUILD_DATETIME)
     ) bl616_spi (
@@ -808,7 +867,11 @@ module top #(
         .w5100_cmd_clr(u2_cmd_clr_w),
         .w5100_dbg_wr_count(u2_dbg_wr_count_w),
         .w5100_dbg_last_addr(u2_dbg_last_addr_w),
-        .w5100_dbg_last_wdata(u2_dbg_last_wdata_w)
+        .w5100_dbg_last_wdata(u2_dbg_last_wdata_w),
+        .arb_stats_i(arb_stats_w),
+        .arb_snap_o(arb_snap_w),
+        .arb_clear_o(arb_clear_w),
+        .fb_stats_i(fb_stats_w)
     );
 
     // WS2812 status LED: FPGA-side MCU liveness watchdog + boot-progression
@@ -1134,6 +1197,10 @@ module top #(
     wire [7:0] fb_dbg_late_line_w;
     wire [7:0] fb_dbg_line_not_ready_w;
     wire [7:0] fb_dbg_line_lag_max_w;
+    wire [15:0] fb_dbg_rd_bursts_w;
+    wire [15:0] fb_dbg_wr_bursts_w;
+    wire [7:0] fb_dbg_skip_lines_w;
+    wire [7:0] fb_dbg_fifo_hwm_w;
 
     // Blank the display until there is meaningful content. The first frame
     // is rendered immediately from power-up SDRAM noise, so gating on the
@@ -1166,7 +1233,9 @@ module top #(
 
     sdram_framebuffer #(
         .TEST_PATTERN(0),
-        .THRESHOLD_DIAG(0)
+        .THRESHOLD_DIAG(0),
+        .FB_READ_BURST_WORDS(8),        // READ_BURST8_PORT
+        .FB_WRITE_BURST_WORDS(8)        // WIDE_WR_PORT
     ) sdram_framebuffer (
         .clk(clk_logic_w),
         .clk_pixel(clk_pixel_w),
@@ -1180,6 +1249,8 @@ module top #(
 
         .fb_write_port(mem_ports[FB_WRITE_PORT]),
         .fb_read_port(mem_ports[FB_READ_PORT]),
+        .fb_wr_wide_data_hi_o(fb_wide_data_hi_w),
+        .fb_wr_wide_word_en_o(fb_wide_word_en_w),
 
         .hdmi_cx({1'b0, hdmi_x}),
         .hdmi_cy(hdmi_y),
@@ -1195,11 +1266,28 @@ module top #(
         .dbg_fifo_overflow_o(fb_dbg_fifo_overflow_w),
         .dbg_late_line_o(fb_dbg_late_line_w),
         .dbg_line_not_ready_o(fb_dbg_line_not_ready_w),
-        .dbg_line_lag_max_o(fb_dbg_line_lag_max_w)
+        .dbg_line_lag_max_o(fb_dbg_line_lag_max_w),
+        .dbg_rd_bursts_o(fb_dbg_rd_bursts_w),
+        .dbg_wr_bursts_o(fb_dbg_wr_bursts_w),
+        .dbg_skip_lines_o(fb_dbg_skip_lines_w),
+        .dbg_fifo_hwm_o(fb_dbg_fifo_hwm_w)
     );
 
+    // XFER SPACE 6 layout (little-endian bytes): read bursts, write-backs,
+    // skipped lines (u16 each), FIFO high-water, FIFO depth (entries), then
+    // the live overflow / late-line / not-ready / max-lag counters.
+    assign fb_stats_w = {
+        32'h0,
+        fb_dbg_line_lag_max_w, fb_dbg_line_not_ready_w,
+        fb_dbg_late_line_w, fb_dbg_fifo_overflow_w,
+        8'd32, fb_dbg_fifo_hwm_w,
+        8'h0, fb_dbg_skip_lines_w,
+        fb_dbg_wr_bursts_w, fb_dbg_rd_bursts_w};
+
 `else
 
+    assign fb_stats_w = 128'h0;
+
     generate if (!USE_PIXEL_STREAM) begin : gen_legacy_video
 
         // -----------------------------------------------------------------
@@ -13,6 +13,7 @@
 #include "cli.h"
 #include "fpga_spi.h"
 #include "fpga_screen.h"
+#include "fpga_sd.h"
 #include "ff.h"
 #include "diskio.h"
 
@@ -59,8 +60,13 @@ static const char *help_text =
     "  hello   - display 'Hello from the MCU!' on Apple II screen\r\n"
     "  regs    - dump video control registers\r\n"
     "  dir     - list SD card root directory\r\n"
-    "  spitest - stress test MCU<->FPGA SPI (10000 cycles)\r\n"
-    "  sdtest  - read SD sector 0 ten times, compare checksums\r\n"
+    "  spitest - stress test MCU<->FPGA SPI (10000 cycles) + XFER bytes/s\r\n"
+    "  spistat - XFER CRC errors/retries per space ('spistat reset' clears)\r\n"
+    "  arbstat - storage arbiter requests/waits/max latency/drops per client\r\n"
+    "            ('arbstat reset' clears; framebuffer build only)\r\n"
+    "  fbstat  - framebuffer bursts/skipped lines/FIFO depth last frame\r\n"
+    "  sdtest  - read SD sector 0 ten times, compare checksums, then\r\n"
+    "            sequential/random read KB/s, byte tunnel vs block engine\r\n"
     "  quit    - exit CLI, resume UART passthrough\r\n";
 
 void cli_write(const char *str)
@@ -184,6 +190,52 @@ static void cli_cmd_regs(void)
     }
 }
 
+/* SDRAM scratch for the bulk test: above the Apple II memory, the OSD page
+ * and the disk/HDD windows. */
+#define SPITEST_SDRAM_ADDR  0x300000u
+#define SPITEST_BYTES       6656u      /* one Disk II track */
+#define SPITEST_ROUNDS      16
+
+/* XFER throughput, polled vs DMA, track-sized write + read-back. */
+static void cli_cmd_spitest_bulk(void)
+{
+    static uint8_t wr[SPITEST_BYTES], rd[SPITEST_BYTES];
+    bool dma = fpga_spi_dma_enabled();
+    char buf[120];
+
+    for (uint32_t i = 0; i < SPITEST_BYTES; i++)
+        wr[i] = (uint8_t)(i * 7 + (i >> 8));
+    cli_write("XFER bytes/s (6656-byte track, SPACE 1):\r\n");
+    for (int mode = 0; mode < 2; mode++) {
+        fpga_spi_set_dma(mode != 0);
+        if (mode && !fpga_spi_dma_enabled()) {
+            cli_write("  dma    : not available\r\n");
+            break;
+        }
+        int bad = 0;
+        uint64_t t_wr = 0, t_rd = 0;
+        for (int r = 0; r < SPITEST_ROUNDS; r++) {
+            wr[0] = (uint8_t)r;
+            uint64_t t0 = bflb_mtimer_get_time_us();
+            fpga_spi_xfer_write(FPGA_SPACE_SDRAM, SPITEST_SDRAM_ADDR, wr, SPITEST_BYTES);
+            uint64_t t1 = bflb_mtimer_get_time_us();
+            fpga_spi_xfer_read(FPGA_SPACE_SDRAM, SPITEST_SDRAM_ADDR, rd, SPITEST_BYTES);
+            uint64_t t2 = bflb_mtimer_get_time_us();
+            t_wr += t1 - t0;
+            t_rd += t2 - t1;
+            if (memcmp(wr, rd, SPITEST_BYTES) != 0)
+                bad++;
+        }
+        uint64_t total = (uint64_t)SPITEST_BYTES * SPITEST_ROUNDS * 1000000u;
+        snprintf(buf, sizeof(buf), "  %-7s: write %lu B/s, read %lu B/s, %d/%d mismatched\r\n",
+                 mode ? "dma" : "polled",
+                 (unsigned long)(total / (t_wr ? t_wr : 1)),
+                 (unsigned long)(total / (t_rd ? t_rd : 1)), bad, SPITEST_ROUNDS);
+        cli_write(buf);
+    }
+    fpga_spi_set_dma(dma);
+}
+
 static void cli_cmd_spitest(void)
 {
     static const uint8_t patterns[] = {0xA5, 0x5A, 0xFF, 0x00, 0x0F, 0xF0};
@@ -231,6 +283,135 @@ static void cli_cmd_spitest(void)
         snprintf(buf, sizeof(buf), " OK\r\n");
     }
     cli_write(buf);
+
+    cli_cmd_spitest_bulk();
+}
+
+static void cli_cmd_spistat(bool reset)
+{
+    char buf[100];
+
+    if (reset) {
+        fpga_spi_xfer_stats_reset();
+        cli_write("spistat: counters cleared\r\n");
+        return;
+    }
+    snprintf(buf, sizeof(buf), "XFER CRC %s; FPGA write trailers %u ok, %u bad (mod 256)\r\n",
+             fpga_spi_crc_enabled() ? "on" : "off",
+             fpga_spi_reg_read(FPGA_REG_XFER_CRC_OK), fpga_spi_reg_read(FPGA_REG_XFER_CRC_ERR));
+    cli_write(buf);
+    cli_write("space    xfers  crc errs  retries  failed\r\n");
+    for (uint8_t sp = 0; sp < 8; sp++) {
+        fpga_xfer_stats_t st;
+        fpga_spi_xfer_stats(sp, &st);
+        if (!st.xfers)
+            continue;
+        snprintf(buf, sizeof(buf), "%-5u %8lu  %8lu  %7lu  %6lu\r\n", sp,
+                 (unsigned long)st.xfers, (unsigned long)st.crc_errors,
+                 (unsigned long)st.retries, (unsigned long)st.failures);
+        cli_write(buf);
+    }
+}
+
+static void cli_cmd_arbstat(bool reset)
+{
+    static const char *const names[FPGA_ARBSTAT_CLIENTS] = { "mcu", "disk2", "hdd" };
+    uint8_t raw[FPGA_ARBSTAT_CLIENTS * FPGA_ARBSTAT_STRIDE];
+    uint8_t op = reset ? FPGA_ARBSTAT_CLEAR : FPGA_ARBSTAT_SNAP;
+    char buf[100];
+
+    fpga_spi_xfer_write(FPGA_SPACE_ARBSTAT, 0, &op, 1);
+    if (reset) {
+        cli_write("arbstat: counters cleared\r\n");
+        return;
+    }
+    fpga_spi_xfer_read(FPGA_SPACE_ARBSTAT, 0, raw, sizeof(raw));
+    cli_write("client   requests   wait cyc  avg wait  max lat            dropped\r\n");
+    for (int c = 0; c < FPGA_ARBSTAT_CLIENTS; c++) {
+        const uint8_t *p = &raw[c * FPGA_ARBSTAT_STRIDE];
+        uint32_t req  = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+        uint32_t wait = p[4] | (p[5] << 8) | (p[6] << 16) | ((uint32_t)p[7] << 24);
+        uint16_t lat  = p[8] | (p[9] << 8);
+        uint16_t drop = p[10] | (p[11] << 8);
+        /* 54 MHz: cycles * 37 / 2 = ns */
+        snprintf(buf, sizeof(buf), "%-6s %10lu %10lu %9lu %5u (%lu ns) %7u\r\n", names[c],
+                 (unsigned long)req, (unsigned long)wait,
+                 (unsigned long)(req ? wait / req : 0), lat,
+                 (unsigned long)lat * 37 / 2, drop);
+        cli_write(buf);
+    }
+}
+
+static void cli_cmd_fbstat(void)
+{
+    uint8_t raw[FPGA_FBSTAT_SIZE];
+    char buf[100];
+
+    fpga_spi_xfer_read(FPGA_SPACE_FBSTAT, 0, raw, sizeof(raw));
+    snprintf(buf, sizeof(buf), "read bursts %u  write-backs %u  solid lines %u\r\n",
+             raw[0] | (raw[1] << 8), raw[2] | (raw[3] << 8), raw[4] | (raw[5] << 8));
+    cli_write(buf);
+    snprintf(buf, sizeof(buf), "wr fifo hwm %u/%u  overflow %u  late %u  not ready %u  max lag %u\r\n",
+             raw[6], raw[7], raw[8], raw[9], raw[10], raw[11]);
+    cli_write(buf);
+}
+
+#define SDBENCH_SEQ_SECTORS 16    /* per disk_read (CMD18) */
+#define SDBENCH_SEQ_ROUNDS  16    /* 128 KB sequential */
+#define SDBENCH_RND_READS   64    /* single-sector (CMD17) reads */
+
+/* Read-only throughput of both SD paths; the card is never written. Sums
+ * of the sequential data are compared so a path that reads wrong data
+ * shows up here rather than as a fast number. */
+static void cli_cmd_sdtest_bench(void)
+{
+    static BYTE data[SDBENCH_SEQ_SECTORS * 512];
+    char buf[128];
+    LBA_t nsect = 0;
+    uint32_t seq_sum[2] = {0, 0};
+
+    if (disk_ioctl(0, GET_SECTOR_COUNT, &nsect) != RES_OK || nsect < 1024) {
+        cli_write("Throughput: no sector count, skipped\r\n");
+        return;
+    }
+    cli_write("Read throughput (KB/s):\r\n");
+    for (int mode = 0; mode < 2; mode++) {
+        mmc_set_block_mode(mode != 0);
+        if (mode && !mmc_block_mode()) {
+            cli_write("  block  : not available (FPGA CAP0[2] clear)\r\n");
+            break;
+        }
+
+        int err = 0;
+        uint64_t t0 = bflb_mtimer_get_time_us();
+        for (int r = 0; r < SDBENCH_SEQ_ROUNDS; r++) {
+            if (disk_read(0, data, (LBA_t)r * SDBENCH_SEQ_SECTORS, SDBENCH_SEQ_SECTORS) != RES_OK) {
+                err++;
+                continue;
+            }
+            for (uint32_t j = 0; j < sizeof(data); j++) seq_sum[mode] += data[j];
+        }
+        uint64_t t1 = bflb_mtimer_get_time_us();
+
+        uint32_t lba = 0x2545F491u;
+        for (int r = 0; r < SDBENCH_RND_READS; r++) {
+            lba = lba * 1664525u + 1013904223u;
+            if (disk_read(0, data, (LBA_t)(lba % (uint32_t)nsect), 1) != RES_OK)
+                err++;
+        }
+        uint64_t t2 = bflb_mtimer_get_time_us();
+
+        uint64_t seq_b = (uint64_t)SDBENCH_SEQ_ROUNDS * sizeof(data) * 1000000u / 1024u;
+        uint64_t rnd_b = (uint64_t)SDBENCH_RND_READS * 512u * 1000000u / 1024u;
+        snprintf(buf, sizeof(buf), "  %-7s: sequential %lu, random %lu, %d errors\r\n",
+                 mode ? "block" : "byte",
+                 (unsigned long)(seq_b / ((t1 - t0) ? (t1 - t0) : 1)),
+                 (unsigned long)(rnd_b / ((t2 - t1) ? (t2 - t1) : 1)), err);
+        cli_write(buf);
+        if (mode && seq_sum[0] != seq_sum[1])
+            cli_write("  block  : DATA MISMATCH vs byte path\r\n");
+    }
+    mmc_set_block_mode(true);
 }
 
 static void cli_cmd_sdtest(void)
@@ -279,6 +460,9 @@ static void cli_cmd_sdtest(void)
     snprintf(buf, sizeof(buf), "Init: %d/10 pass. Reads matching round 0: %d/9\r\n",
              init_pass, match);
     cli_write(buf);
+
+    if (init_pass)
+        cli_cmd_sdtest_bench();
 }
 
 static void cli_cmd_dir(void)
@@ -355,6 +539,12 @@ static void cli_execute(void)
         cli_cmd_dir();
     } else if (strcmp(cmd, "spitest") == 0) {
         cli_cmd_spitest();
+    } else if (strcmp(cmd, "spistat") == 0 || strcmp(cmd, "spistat reset") == 0) {
+        cli_cmd_spistat(cmd[7] != '\0');
+    } else if (strcmp(cmd, "arbstat") == 0 || strcmp(cmd, "arbstat reset") == 0) {
+        cli_cmd_arbstat(cmd[7] != '\0');
+    } else if (strcmp(cmd, "fbstat") == 0) {
+        cli_cmd_fbstat();
     } else if (strcmp(cmd, "sdtest") == 0) {
         cli_cmd_sdtest();
     } else if (strcmp(cmd, "quit") == 0 || strcmp(cmd, "exit") == 0) {
@@ -0,0 +1,31 @@
+/*
+ * crc32.h — CRC-32 (IEEE 802.3, reflected, poly 0xEDB88320): the one copy
+ * behind every blob and record check in the firmware (settings, write-back
+ * journal, flash images).
+ *
+ * crc32_update() continues a running CRC (start from 0), so data can be
+ * hashed in chunks: crc32_calc(p, n) == crc32_update(crc32_update(0, p, k),
+ * p + k, n - k). Pure C, no MCU dependencies.
+ */
+#ifndef _CRC32_H
+#define _CRC32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t crc32_update(uint32_t crc, const void *p, size_t n);
+
+static inline uint32_t crc32_calc(const void *p, size_t n)
+{
+    return crc32_update(0, p, n);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _CRC32_H */
@@ -5,7 +5,15 @@
 #ifndef _FPGA_SD_H
 #define _FPGA_SD_H
 
+#include <stdbool.h>
+
 /* Initialize FPGA SD registers to safe defaults (CS# high, slow clock) */
 void fpga_sd_init(void);
 
+/* sdmm.c: move 512-byte data blocks through the FPGA block engine
+ * (CAP0[2], reg 0x6F + SPACE 4) instead of the per-byte tunnel. On by
+ * default; the engine itself is detected at card init. */
+void mmc_set_block_mode(bool on);
+bool mmc_block_mode(void);   /* true if blocks currently use the engine */
+
 #endif
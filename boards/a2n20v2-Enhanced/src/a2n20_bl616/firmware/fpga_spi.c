@@ -10,6 +10,12 @@
  * CS# is driven via GPIO (not the SPI peripheral) so that multi-byte
  * transactions stay framed while each byte is a separate SPI frame.
  * This matches FPGA Companion's approach (mcu_hw.c).
+ *
+ * Bulk XFER chunks go by DMA instead (dma0 channels 0/1 on SPI0 TX/RX): the
+ * whole CS-framed chunk — header, payload and CRC trailer — is one
+ * descriptor out of a non-cacheable bounce buffer, up to a full Disk II
+ * track, and the caller sleeps on the completion interrupt. Register access,
+ * short chunks and fpga_spi_reg_write_raw() stay polled.
  */
 
 #include <string.h>
@@ -17,6 +23,7 @@
 #include "bflb_gpio.h"
 #include "bflb_spi.h"
 #include "bflb_mtimer.h"
+#include "bflb_dma.h"
 #include "fpga_spi.h"
 #include "fpga_screen.h"
 
@@ -45,7 +52,9 @@ static inline void spi_lock_give(void)
     if (spi_lock && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
         xSemaphoreGive(spi_lock);
 }
-#define SPI_LOCK_INIT() do { spi_lock = xSemaphoreCreateMutex(); } while (0)
+static SemaphoreHandle_t dma_sem;
+#define SPI_LOCK_INIT() do { spi_lock = xSemaphoreCreateMutex(); \
+                             dma_sem = xSemaphoreCreateBinary(); } while (0)
 #else
 static inline void spi_lock_take(void) {}
 static inline void spi_lock_give(void) {}
@@ -57,20 +66,48 @@ static inline void spi_lock_give(void) {}
 #define SPI_MISO_PIN GPIO_PIN_2
 #define SPI_MOSI_PIN GPIO_PIN_3
 
-/* Max payload per XFER chunk. Sized for one FAT sector (512B) plus the 8-byte
- * header+dummy prefix used by reads. Each chunk is one poll_exchange call. */
-#define XFER_CHUNK_MAX 512
-#define XFER_HDR_LEN   7   /* opcode + sub0 + addr[3] + len[2] */
-#define XFER_DUMMY_LEN 1
+/* Max payload per XFER chunk: one FAT sector when polled, a whole Disk II
+ * track (and then some) by DMA. Shorter chunks than XFER_DMA_MIN are not
+ * worth the DMA setup. */
+#define XFER_CHUNK_POLL 512
+#define XFER_CHUNK_MAX  8192
+#define XFER_DMA_MIN    32
+#define XFER_HDR_LEN    7   /* opcode + sub0 + addr[3] + len[2] */
+#define XFER_DUMMY_LEN  1
+#define XFER_CRC_LEN    2   /* CRC-16 trailer, with CRC_EN */
+#define XFER_HCRC_LEN   2   /* write header CRC after LEN1, with CRC_EN */
+#define XFER_FRAME_MAX  (XFER_HDR_LEN + XFER_HCRC_LEN + XFER_CHUNK_MAX + XFER_CRC_LEN)
+#define XFER_TRIES      3   /* sends per chunk before a CRC failure sticks */
+#define DMA_TIMEOUT_US  20000   /* 8 KB at 20 MHz is ~3.3 ms */
 
 static struct bflb_device_s *spi0;
 static struct bflb_device_s *gpio_dev;
 
-/* TX scratch holds [header || (data | dummy+filler)] for one chunk. */
-static uint8_t spi_tx_scratch[XFER_HDR_LEN + XFER_DUMMY_LEN + XFER_CHUNK_MAX];
+/* TX scratch holds [header || ([header CRC] data | dummy+filler)] for one
+ * chunk. */
+static ATTR_NOCACHE_NOINIT_RAM_SECTION __attribute__((aligned(32)))
+uint8_t spi_tx_scratch[XFER_FRAME_MAX];
 /* RX scratch is only used for reads; the header bytes return status, the
- * dummy byte is discarded, then chunk_len data bytes follow. */
-static uint8_t spi_rx_scratch[XFER_HDR_LEN + XFER_DUMMY_LEN + XFER_CHUNK_MAX];
+ * dummy byte is discarded, then chunk_len data bytes follow. Both are DMA
+ * bounce buffers, hence non-cacheable. */
+static ATTR_NOCACHE_NOINIT_RAM_SECTION __attribute__((aligned(32)))
+uint8_t spi_rx_scratch[XFER_FRAME_MAX];
+
+static struct bflb_device_s *dma_tx;
+static struct bflb_device_s *dma_rx;
+static struct bflb_dma_channel_lli_pool_s dma_tx_lli[4];   /* 4064 B per LLI */
+static struct bflb_dma_channel_lli_pool_s dma_rx_lli[4];
+static bool s_dma;                   /* bulk chunks by DMA (fpga_spi_set_dma) */
+static volatile bool dma_done;
+static volatile bool dma_sleeping;   /* waiter blocked on dma_sem */
+
+/* XFER CRC (CAPABILITIES CRC bit, see fpga_spi_crc_init): each chunk carries
+ * a CRC-16 over SUB0..LEN1 and the payload. Reads check the FPGA's trailer;
+ * writes check that XFER_CRC_OK counted the chunk. Either way a bad chunk is
+ * sent again, up to XFER_TRIES times. */
+static bool s_crc;
+static uint8_t s_crc_ok;   /* XFER_CRC_OK as last seen */
+static fpga_xfer_stats_t s_xstat[8];
 
 static inline void cs_assert(void)   { bflb_gpio_reset(gpio_dev, SPI_CS_PIN); }
 static inline void cs_deassert(void)  { bflb_gpio_set(gpio_dev, SPI_CS_PIN); }
@@ -83,6 +120,130 @@ static inline uint8_t spi_xchg_byte(uint8_t tx)
     return rx;
 }
 
+/* RX completion: the last byte of the frame is in, so the bus is idle. */
+static void dma_rx_isr(void *arg)
+{
+    (void)arg;
+    dma_done = true;
+#ifdef FPGA_SPI_THREADSAFE
+    if (dma_sleeping) {
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(dma_sem, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+#endif
+}
+
+static void dma_init(void)
+{
+    struct bflb_dma_channel_config_s tx_cfg = {
+        .direction       = DMA_MEMORY_TO_PERIPH,
+        .src_req         = DMA_REQUEST_NONE,
+        .dst_req         = DMA_REQUEST_SPI0_TX,
+        .src_addr_inc    = DMA_ADDR_INCREMENT_ENABLE,
+        .dst_addr_inc    = DMA_ADDR_INCREMENT_DISABLE,
+        .src_burst_count = DMA_BURST_INCR1,
+        .dst_burst_count = DMA_BURST_INCR1,
+        .src_width       = DMA_DATA_WIDTH_8BIT,
+        .dst_width       = DMA_DATA_WIDTH_8BIT,
+    };
+    struct bflb_dma_channel_config_s rx_cfg = {
+        .direction       = DMA_PERIPH_TO_MEMORY,
+        .src_req         = DMA_REQUEST_SPI0_RX,
+        .dst_req         = DMA_REQUEST_NONE,
+        .src_addr_inc    = DMA_ADDR_INCREMENT_DISABLE,
+        .dst_addr_inc    = DMA_ADDR_INCREMENT_ENABLE,
+        .src_burst_count = DMA_BURST_INCR1,
+        .dst_burst_count = DMA_BURST_INCR1,
+        .src_width       = DMA_DATA_WIDTH_8BIT,
+        .dst_width       = DMA_DATA_WIDTH_8BIT,
+    };
+
+    dma_tx = bflb_device_get_by_name("dma0_ch0");
+    dma_rx = bflb_device_get_by_name("dma0_ch1");
+    if (!dma_tx || !dma_rx)
+        return;   /* polled only */
+    bflb_dma_channel_init(dma_tx, &tx_cfg);
+    bflb_dma_channel_init(dma_rx, &rx_cfg);
+    bflb_dma_channel_irq_attach(dma_rx, dma_rx_isr, NULL);
+    s_dma = true;
+}
+
+/* Clock the first n bytes of spi_tx_scratch out while spi_rx_scratch fills,
+ * inside the caller's CS frame. Sleeps on the completion interrupt once the
+ * scheduler runs, spins before that (and in the device build). False on a
+ * timeout, which the caller treats like a failed CRC. */
+static bool dma_xchg(uint32_t n)
+{
+    struct bflb_dma_channel_lli_transfer_s tx = {
+        .src_addr = (uint32_t)(uintptr_t)spi_tx_scratch,
+        .dst_addr = DMA_ADDR_SPI0_TDR,
+        .nbytes   = n,
+    };
+    struct bflb_dma_channel_lli_transfer_s rx = {
+        .src_addr = DMA_ADDR_SPI0_RDR,
+        .dst_addr = (uint32_t)(uintptr_t)spi_rx_scratch,
+        .nbytes   = n,
+    };
+    bflb_dma_channel_lli_reload(dma_rx, dma_rx_lli, 4, &rx, 1);
+    bflb_dma_channel_lli_reload(dma_tx, dma_tx_lli, 4, &tx, 1);
+
+    dma_done = false;
+#ifdef FPGA_SPI_THREADSAFE
+    dma_sleeping = xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+#endif
+    bflb_spi_link_rxdma(spi0, true);
+    bflb_spi_link_txdma(spi0, true);
+    bflb_dma_channel_start(dma_rx);
+    bflb_dma_channel_start(dma_tx);
+
+#ifdef FPGA_SPI_THREADSAFE
+    if (dma_sleeping) {
+        /* Loop: a give left over from a timed-out frame must not end this one */
+        while (!dma_done &&
+               xSemaphoreTake(dma_sem, pdMS_TO_TICKS(DMA_TIMEOUT_US / 1000)) == pdTRUE) {
+        }
+    }
+#endif
+    uint64_t deadline = bflb_mtimer_get_time_us() + DMA_TIMEOUT_US;
+    while (!dma_done && bflb_mtimer_get_time_us() < deadline) {
+    }
+    dma_sleeping = false;
+
+    bool ok = dma_done;
+    if (!ok) {
+        bflb_dma_channel_stop(dma_tx);
+        bflb_dma_channel_stop(dma_rx);
+    }
+    bflb_spi_link_txdma(spi0, false);
+    bflb_spi_link_rxdma(spi0, false);
+    return ok;
+}
+
+/* Clock out one CS-framed frame of n bytes from spi_tx_scratch, by DMA for
+ * a bulk chunk; with capture, what comes back lands in spi_rx_scratch. */
+static bool frame_xchg(uint32_t n, uint16_t chunk, bool capture)
+{
+    bool ok = true;
+    cs_assert();
+    if (s_dma && chunk >= XFER_DMA_MIN) {
+        ok = dma_xchg(n);
+    } else {
+        for (uint32_t i = 0; i < n; i++) {
+            uint8_t rx = spi_xchg_byte(spi_tx_scratch[i]);
+            if (capture)
+                spi_rx_scratch[i] = rx;
+        }
+    }
+    cs_deassert();
+    return ok;
+}
+
+static inline uint16_t chunk_max(void)
+{
+    return s_dma ? XFER_CHUNK_MAX : XFER_CHUNK_POLL;
+}
+
 void fpga_spi_init(void)
 {
     gpio_dev = bflb_device_get_by_name("gpio");
@@ -111,6 +272,19 @@ void fpga_spi_init(void)
     bflb_spi_init(spi0, &spi_cfg);
 
     SPI_LOCK_INIT();
+    dma_init();
+}
+
+void fpga_spi_set_dma(bool on)
+{
+    spi_lock_take();
+    s_dma = on && dma_tx && dma_rx;
+    spi_lock_give();
+}
+
+bool fpga_spi_dma_enabled(void)
+{
+    return s_dma;
 }
 
 uint8_t fpga_spi_reg_read(uint8_t reg)
@@ -146,12 +320,34 @@ void fpga_spi_reg_write_raw(uint8_t reg, uint8_t val)
     cs_deassert();
 }
 
+/* Register read without the lock, for use inside a locked XFER. */
+static uint8_t reg_read_nolock(uint8_t reg)
+{
+    cs_assert();
+    spi_xchg_byte(0x80 | (reg & 0x7F));
+    uint8_t val = spi_xchg_byte(0xFF);
+    cs_deassert();
+    return val;
+}
+
+/* CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), as the FPGA computes it */
+static uint16_t crc16(uint16_t crc, const uint8_t *p, uint16_t n)
+{
+    while (n--) {
+        crc ^= (uint16_t)(*p++) << 8;
+        for (int i = 0; i < 8; i++)
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
 /* Build the 7-byte XFER header at the start of spi_tx_scratch.
- * SUB0 format: { 0, RES=0, CRC_EN=0, INC=1, SPACE[2:0], DIR } */
+ * SUB0 format: { 0, RES=0, CRC_EN, INC=1, SPACE[2:0], DIR } */
 static inline void build_xfer_header(uint8_t space, uint32_t addr, uint16_t chunk, uint8_t dir)
 {
     spi_tx_scratch[0] = 0x7F;                                          /* XFER opcode */
-    spi_tx_scratch[1] = (1 << 4) | ((space & 0x07) << 1) | (dir & 1); /* SUB0: INC=1 */
+    spi_tx_scratch[1] = (s_crc ? (1 << 5) : 0) | (1 << 4) |
+                        ((space & 0x07) << 1) | (dir & 1);             /* SUB0: INC=1 */
     spi_tx_scratch[2] = (uint8_t)(addr & 0xFF);
     spi_tx_scratch[3] = (uint8_t)((addr >> 8) & 0xFF);
     spi_tx_scratch[4] = (uint8_t)((addr >> 16) & 0xFF);
@@ -159,6 +355,49 @@ static inline void build_xfer_header(uint8_t space, uint32_t addr, uint16_t chun
     spi_tx_scratch[6] = (uint8_t)((chunk >> 8) & 0xFF);
 }
 
+/* Where a write chunk's payload goes: after the header, and with CRC on
+ * after the header CRC, which the FPGA checks before committing any of it. */
+static inline uint8_t *xfer_wr_payload(void)
+{
+    return &spi_tx_scratch[XFER_HDR_LEN + (s_crc ? XFER_HCRC_LEN : 0)];
+}
+
+/* Send the chunk built in spi_tx_scratch (header + payload at
+ * xfer_wr_payload()), with its header CRC and trailer when on, until
+ * XFER_CRC_OK counts it. Lock held. */
+static void xfer_send_chunk(uint8_t space, uint16_t chunk)
+{
+    uint16_t n = XFER_HDR_LEN + chunk;
+    if (s_crc) {
+        uint16_t hcrc = crc16(0xFFFF, &spi_tx_scratch[1], XFER_HDR_LEN - 1);
+        uint16_t crc  = crc16(hcrc, xfer_wr_payload(), chunk);
+        spi_tx_scratch[XFER_HDR_LEN]     = (uint8_t)(hcrc >> 8);
+        spi_tx_scratch[XFER_HDR_LEN + 1] = (uint8_t)hcrc;
+        n += XFER_HCRC_LEN;
+        spi_tx_scratch[n++] = (uint8_t)(crc >> 8);
+        spi_tx_scratch[n++] = (uint8_t)crc;
+    }
+    fpga_xfer_stats_t *st = &s_xstat[space & 7];
+    st->xfers++;
+    for (int attempt = 0; ; attempt++) {
+        bool good = frame_xchg(n, chunk, false);
+        if (s_crc) {
+            uint8_t ok = reg_read_nolock(FPGA_REG_XFER_CRC_OK);
+            if (good && ok == s_crc_ok)
+                st->crc_errors++;
+            good = good && ok != s_crc_ok;
+            s_crc_ok = ok;
+        }
+        if (good)
+            return;
+        if (attempt + 1 == XFER_TRIES) {
+            st->failures++;
+            return;
+        }
+        st->retries++;
+    }
+}
+
 void fpga_spi_xfer_write(uint8_t space, uint32_t addr, const uint8_t *data, uint16_t len)
 {
     uint16_t remaining = len;
@@ -167,13 +406,10 @@ void fpga_spi_xfer_write(uint8_t space, uint32_t addr, const uint8_t *data, uint
 
     spi_lock_take();
     while (remaining > 0) {
-        uint16_t chunk = (remaining > XFER_CHUNK_MAX) ? XFER_CHUNK_MAX : remaining;
+        uint16_t chunk = (remaining > chunk_max()) ? chunk_max() : remaining;
         build_xfer_header(space, cur_addr, chunk, 0);  /* DIR=0 (write) */
-        memcpy(&spi_tx_scratch[XFER_HDR_LEN], src, chunk);
-        cs_assert();
-        for (uint16_t i = 0; i < XFER_HDR_LEN + chunk; i++)
-            spi_xchg_byte(spi_tx_scratch[i]);
-        cs_deassert();
+        memcpy(xfer_wr_payload(), src, chunk);
+        xfer_send_chunk(space, chunk);
         cur_addr += chunk;
         src      += chunk;
         remaining -= chunk;
@@ -186,21 +422,34 @@ void fpga_spi_xfer_read(uint8_t space, uint32_t addr, uint8_t *data, uint16_t le
     uint16_t remaining = len;
     uint32_t cur_addr = addr;
     uint8_t *dst = data;
+    fpga_xfer_stats_t *st = &s_xstat[space & 7];
 
     spi_lock_take();
     while (remaining > 0) {
-        uint16_t chunk = (remaining > XFER_CHUNK_MAX) ? XFER_CHUNK_MAX : remaining;
+        uint16_t chunk = (remaining > chunk_max()) ? chunk_max() : remaining;
+        uint32_t n = XFER_HDR_LEN + XFER_DUMMY_LEN + chunk + (s_crc ? XFER_CRC_LEN : 0);
         build_xfer_header(space, cur_addr, chunk, 1);  /* DIR=1 (read) */
-        cs_assert();
-        /* Send header */
-        for (uint16_t i = 0; i < XFER_HDR_LEN; i++)
-            spi_xchg_byte(spi_tx_scratch[i]);
-        /* Dummy byte */
-        spi_xchg_byte(0xFF);
-        /* Read payload */
-        for (uint16_t i = 0; i < chunk; i++)
-            dst[i] = spi_xchg_byte(0xFF);
-        cs_deassert();
+        memset(&spi_tx_scratch[XFER_HDR_LEN], 0xFF, n - XFER_HDR_LEN);   /* dummy + filler */
+        const uint8_t *in = &spi_rx_scratch[XFER_HDR_LEN + XFER_DUMMY_LEN];
+        st->xfers++;
+        for (int attempt = 0; ; attempt++) {
+            bool good = frame_xchg(n, chunk, true);
+            if (good && s_crc) {
+                uint16_t rx = (uint16_t)in[chunk] << 8 | in[chunk + 1];
+                good = rx == crc16(crc16(0xFFFF, &spi_tx_scratch[1], XFER_HDR_LEN - 1),
+                                   in, chunk);
+                if (!good)
+                    st->crc_errors++;
+            }
+            if (good)
+                break;
+            if (attempt + 1 == XFER_TRIES) {
+                st->failures++;
+                break;
+            }
+            st->retries++;
+        }
+        memcpy(dst, in, chunk);
         cur_addr += chunk;
         dst      += chunk;
         remaining -= chunk;
@@ -218,20 +467,47 @@ void fpga_spi_xfer_fill(uint8_t space, uint32_t addr, uint8_t val, uint16_t len)
                         * this caused intermittent bus wedges (e.g. fpga_screen
                         * clear racing the W5100 bridge from another thread). */
     while (remaining > 0) {
-        uint16_t chunk = (remaining > XFER_CHUNK_MAX) ? XFER_CHUNK_MAX : remaining;
+        uint16_t chunk = (remaining > chunk_max()) ? chunk_max() : remaining;
         build_xfer_header(space, cur_addr, chunk, 0);  /* DIR=0 (write) */
-        cs_assert();
-        for (uint16_t i = 0; i < XFER_HDR_LEN; i++)
-            spi_xchg_byte(spi_tx_scratch[i]);
-        for (uint16_t i = 0; i < chunk; i++)
-            spi_xchg_byte(val);
-        cs_deassert();
+        memset(xfer_wr_payload(), val, chunk);
+        xfer_send_chunk(space, chunk);
         cur_addr  += chunk;
         remaining -= chunk;
     }
     spi_lock_give();
 }
 
+bool fpga_spi_crc_init(void)
+{
+    spi_lock_take();
+    s_crc = false;
+    if (reg_read_nolock(FPGA_REG_CAP0) & FPGA_CAP_CRC) {
+        s_crc_ok = reg_read_nolock(FPGA_REG_XFER_CRC_OK);
+        s_crc = true;
+    }
+    spi_lock_give();
+    return s_crc;
+}
+
+bool fpga_spi_crc_enabled(void)
+{
+    return s_crc;
+}
+
+void fpga_spi_xfer_stats(uint8_t space, fpga_xfer_stats_t *out)
+{
+    spi_lock_take();
+    *out = s_xstat[space & 7];
+    spi_lock_give();
+}
+
+void fpga_spi_xfer_stats_reset(void)
+{
+    spi_lock_take();
+    memset(s_xstat, 0, sizeof(s_xstat));
+    spi_lock_give();
+}
+
 uint8_t fpga_spi_read_status(void)
 {
     return fpga_spi_reg_read(0x06);
@@ -275,6 +551,7 @@ void fpga_service_init(void)
 
     uint8_t status = fpga_spi_read_status();
     printf("FPGA SPI: STATUS = 0x%02X\r\n", status);
+    printf("FPGA SPI: XFER CRC %s\r\n", fpga_spi_crc_init() ? "on" : "off");
 
     /* Enable video, text mode, bus ready */
     fpga_spi_reg_write(0x10, 1);  /* VIDEO_ENABLE */
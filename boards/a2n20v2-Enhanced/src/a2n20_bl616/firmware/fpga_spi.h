@@ -20,6 +20,23 @@
 #define FPGA_SPACE_SDRAM  1  /* SDRAM (byte addressed) */
 #define FPGA_SPACE_FIFO   2  /* Bus event FIFO */
 #define FPGA_SPACE_W5100  3  /* Uthernet2 (W5100) backing store, W5100 addresses */
+#define FPGA_SPACE_SDBLK  4  /* SD block engine 512B buffer */
+#define FPGA_SPACE_ARBSTAT 5 /* storage arbiter counters (FB build), read-only */
+
+/* SPACE 5 layout: 3 clients (MCU XFER, Disk II, HDD) x 12 bytes, little
+ * endian: requests u32, wait cycles u32, max latency u16 (54 MHz cycles),
+ * dropped requests u16. Write 0x01 to snapshot the live counters, 0x02 to clear. */
+#define FPGA_ARBSTAT_CLIENTS  3
+#define FPGA_ARBSTAT_STRIDE   12
+#define FPGA_ARBSTAT_SNAP     0x01
+#define FPGA_ARBSTAT_CLEAR    0x02
+
+/* SPACE 6 layout (FB build, read-only, 16 bytes little endian): read
+ * bursts u16, write-backs u16, solid lines skipped u16, write FIFO
+ * high-water u8, FIFO depth u8 (all previous-frame totals), then the
+ * overflow, late-line, line-not-ready and max-lag u8 counters. */
+#define FPGA_SPACE_FBSTAT  6
+#define FPGA_FBSTAT_SIZE   16
 
 /* Uthernet2 command-pending doorbell register (bits[3:0] = sockets 0-3).
  * Read to see which sockets have a pending Sn_CR; write 1s to clear. */
@@ -32,6 +49,16 @@
 #define FPGA_REG_U2_DBG_ADDR_HI  0x7D  /* last port-B write address, high */
 #define FPGA_REG_U2_DBG_WDATA    0x7E  /* last port-B write data */
 
+/* CAPABILITIES (0x05): [0]=SYNC [1]=XFER CRC [2]=SD block engine */
+#define FPGA_REG_CAP0            0x05
+#define FPGA_CAP_CRC             (1 << 1)
+#define FPGA_CAP_SD_BLK          (1 << 2)
+
+/* XFER CRC counters (read side of 0x4F/0x5F; writes there are the VOL ACKs):
+ * CRC'd XFER writes whose trailer matched / did not, mod 256. */
+#define FPGA_REG_XFER_CRC_OK     0x4F
+#define FPGA_REG_XFER_CRC_ERR    0x5F
+
 /* STATUS register (0x06) bit fields */
 #define FPGA_STATUS_RD_PENDING     (1 << 0)
 #define FPGA_STATUS_WR_PENDING     (1 << 1)
@@ -60,6 +87,27 @@ void fpga_spi_xfer_read(uint8_t space, uint32_t addr, uint8_t *data, uint16_t le
 /* XFER fill: write repeating byte to FPGA memory space */
 void fpga_spi_xfer_fill(uint8_t space, uint32_t addr, uint8_t val, uint16_t len);
 
+/* Bulk XFER chunks by DMA (on after fpga_spi_init if the channels exist);
+ * off falls back to the polled byte-at-a-time path, e.g. to compare. */
+void fpga_spi_set_dma(bool on);
+bool fpga_spi_dma_enabled(void);
+
+/* Turn on XFER CRC if the bitstream has it (after the FPGA is ready).
+ * Returns whether it is on. */
+bool fpga_spi_crc_init(void);
+bool fpga_spi_crc_enabled(void);
+
+/* Per-space XFER link errors, counted per chunk. A CRC failure is resent;
+ * failures counts chunks that still failed after the last try. */
+typedef struct {
+    uint32_t xfers;
+    uint32_t crc_errors;
+    uint32_t retries;
+    uint32_t failures;
+} fpga_xfer_stats_t;
+void fpga_spi_xfer_stats(uint8_t space, fpga_xfer_stats_t *out);
+void fpga_spi_xfer_stats_reset(void);
+
 /* Read STATUS register (0x06) */
 uint8_t fpga_spi_read_status(void);
 
@@ -0,0 +1,316 @@
+/*
+ * hdd_cache.c — set-associative block cache for the ProDOS HDD server. See
+ * hdd_cache.h.
+ */
+#include "hdd_cache.h"
+
+#include <string.h>
+
+static inline uint8_t *line_data(const hdd_cache_t *c, uint32_t i)
+{
+    return c->data + (size_t)i * HC_BLOCK_BYTES;
+}
+
+static inline uint32_t set_base(const hdd_cache_t *c, uint32_t lba)
+{
+    return (lba & (uint32_t)(c->sets - 1u)) * c->ways;
+}
+
+/* Line index holding lba, or -1. */
+static int find(const hdd_cache_t *c, uint32_t lba)
+{
+    uint32_t b = set_base(c, lba);
+    for (uint32_t w = 0; w < c->ways; w++) {
+        const hc_line_t *l = &c->line[b + w];
+        if (l->valid && l->lba == lba)
+            return (int)(b + w);
+    }
+    return -1;
+}
+
+/* Store one dirty line to the image and mark it clean. */
+static bool store_line(hdd_cache_t *c, uint32_t i)
+{
+    hc_line_t *l = &c->line[i];
+    if (!c->io(c->ctx, l->lba, 1, line_data(c, i), true)) {
+        c->st.errors++;
+        return false;
+    }
+    l->dirty = false;
+    c->st.stores++;
+    c->st.stored++;
+    return true;
+}
+
+/* Claim a line for lba in its set: a free one, else the least recently used
+ * clean one, else (if evict_dirty) the least recently used dirty one, stored
+ * first. The line is tagged and touched; its data is the caller's to fill.
+ * -1 if nothing could be claimed. */
+static int claim(hdd_cache_t *c, uint32_t lba, bool evict_dirty)
+{
+    uint32_t b = set_base(c, lba);
+    int clean = -1, dirty = -1;
+    for (uint32_t w = 0; w < c->ways; w++) {
+        uint32_t   i = b + w;
+        hc_line_t *l = &c->line[i];
+        if (!l->valid) {
+            clean = (int)i;
+            break;
+        }
+        if (!l->dirty) {
+            if (clean < 0 || l->used < c->line[clean].used)
+                clean = (int)i;
+        } else if (dirty < 0 || l->used < c->line[dirty].used) {
+            dirty = (int)i;
+        }
+    }
+    int pick = clean;
+    if (pick < 0 && evict_dirty && dirty >= 0 && store_line(c, (uint32_t)dirty))
+        pick = dirty;
+    if (pick < 0)
+        return -1;
+
+    hc_line_t *l = &c->line[pick];
+    l->lba   = lba;
+    l->valid = true;
+    l->dirty = false;
+    l->ahead = false;
+    l->used  = ++c->clock;
+    return pick;
+}
+
+void hc_init(hdd_cache_t *c, hc_line_t *line, uint8_t *data, uint16_t sets,
+             uint16_t ways, uint8_t *stage, uint16_t stage_blocks,
+             uint16_t ahead)
+{
+    memset(c, 0, sizeof(*c));
+    c->line         = line;
+    c->data         = data;
+    c->sets         = sets;
+    c->ways         = ways;
+    c->stage        = stage;
+    c->stage_blocks = stage_blocks;
+    c->ahead        = (ahead < stage_blocks) ? ahead
+                      : (uint16_t)(stage_blocks ? stage_blocks - 1u : 0u);
+    memset(line, 0, (size_t)sets * ways * sizeof(*line));
+}
+
+void hc_attach(hdd_cache_t *c, hc_io_fn io, void *ctx, uint32_t nblocks)
+{
+    hc_detach(c);
+    c->io      = io;
+    c->ctx     = ctx;
+    c->nblocks = nblocks;
+}
+
+void hc_detach(hdd_cache_t *c)
+{
+    memset(c->line, 0, (size_t)c->sets * c->ways * sizeof(*c->line));
+    c->io       = NULL;
+    c->ctx      = NULL;
+    c->nblocks  = 0;
+    c->next_lba = 0;
+}
+
+bool hc_read(hdd_cache_t *c, uint32_t lba, uint32_t count, void *buf)
+{
+    uint8_t *out = (uint8_t *)buf;
+    bool     seq = (lba == c->next_lba);
+    bool     ok  = true;
+
+    c->next_lba = lba + count;
+
+    for (uint32_t i = 0; i < count;) {
+        uint32_t b = lba + i;
+        uint8_t *dst = out + (size_t)i * HC_BLOCK_BYTES;
+
+        if (!c->io || b >= c->nblocks) {
+            memset(dst, 0, HC_BLOCK_BYTES);
+            i++;
+            continue;
+        }
+
+        int hit = find(c, b);
+        if (hit >= 0) {
+            hc_line_t *l = &c->line[hit];
+            memcpy(dst, line_data(c, (uint32_t)hit), HC_BLOCK_BYTES);
+            l->used = ++c->clock;
+            if (l->ahead) {
+                l->ahead = false;
+                c->st.ahead_used++;
+            }
+            c->st.hits++;
+            i++;
+            continue;
+        }
+
+        /* Miss: every consecutive missing block of the request, then (on a
+         * sequential stream that this run finishes) read-ahead past it. */
+        uint32_t n = 1;
+        while (i + n < count && n < c->stage_blocks && b + n < c->nblocks &&
+               find(c, b + n) < 0)
+            n++;
+        uint32_t extra = 0;
+        if (seq && i + n == count) {
+            while (extra < c->ahead && n + extra < c->stage_blocks &&
+                   b + n + extra < c->nblocks && find(c, b + n + extra) < 0)
+                extra++;
+        }
+
+        /* With no staging buffer both loops above stop at one block: read
+         * it straight into the caller's buffer and keep a copy from there. */
+        uint8_t *fill = c->stage_blocks ? c->stage : dst;
+        if (!c->io(c->ctx, b, n + extra, fill, false)) {
+            c->st.errors++;
+            memset(dst, 0, (size_t)n * HC_BLOCK_BYTES);
+            ok = false;
+            i += n;
+            continue;
+        }
+        c->st.fills++;
+        c->st.misses += n;
+        c->st.ahead  += extra;
+
+        if (fill != dst)
+            memcpy(dst, fill, (size_t)n * HC_BLOCK_BYTES);
+        for (uint32_t k = 0; k < n + extra; k++) {
+            int li = claim(c, b + k, k < n);
+            if (li < 0)
+                continue;   /* set full of dirty lines: serve, don't keep */
+            memcpy(line_data(c, (uint32_t)li), fill + (size_t)k * HC_BLOCK_BYTES,
+                   HC_BLOCK_BYTES);
+            c->line[li].ahead = (k >= n);
+        }
+        i += n;
+    }
+    return ok;
+}
+
+bool hc_write(hdd_cache_t *c, uint32_t lba, uint32_t count, const void *buf,
+              bool write_back)
+{
+    const uint8_t *in = (const uint8_t *)buf;
+
+    if (!c->io || lba >= c->nblocks)
+        return true;
+    if (count > c->nblocks - lba)
+        count = c->nblocks - lba;
+    c->st.writes += count;
+
+    if (!write_back) {
+        /* Store first; a cached copy is only refreshed once the image has
+         * the data, and dropped if the store failed. */
+        bool ok = c->io(c->ctx, lba, count, (void *)in, true);
+        if (ok) {
+            c->st.stores++;
+            c->st.stored += count;
+        } else {
+            c->st.errors++;
+        }
+        for (uint32_t k = 0; k < count; k++) {
+            int li = find(c, lba + k);
+            if (li < 0)
+                continue;
+            if (ok) {
+                memcpy(line_data(c, (uint32_t)li), in + (size_t)k * HC_BLOCK_BYTES,
+                       HC_BLOCK_BYTES);
+                c->line[li].used  = ++c->clock;
+                c->line[li].dirty = false;
+                c->line[li].ahead = false;
+            } else {
+                c->line[li].valid = false;
+            }
+        }
+        return ok;
+    }
+
+    bool ok = true;
+    for (uint32_t k = 0; k < count; k++) {
+        const uint8_t *src = in + (size_t)k * HC_BLOCK_BYTES;
+        int li = find(c, lba + k);
+        if (li < 0)
+            li = claim(c, lba + k, true);
+        if (li < 0) {
+            /* No line (victim store failed): write this block through. */
+            if (c->io(c->ctx, lba + k, 1, (void *)src, true)) {
+                c->st.stores++;
+                c->st.stored++;
+            } else {
+                c->st.errors++;
+                ok = false;
+            }
+            continue;
+        }
+        hc_line_t *l = &c->line[li];
+        memcpy(line_data(c, (uint32_t)li), src, HC_BLOCK_BYTES);
+        l->used  = ++c->clock;
+        l->dirty = true;
+        l->ahead = false;
+    }
+    return ok;
+}
+
+int hc_flush(hdd_cache_t *c, uint32_t max_blocks)
+{
+    uint32_t nlines = (uint32_t)c->sets * c->ways;
+    uint32_t done   = 0;
+
+    if (!c->io)
+        return 0;
+
+    while (done < max_blocks) {
+        int first = -1;
+        for (uint32_t i = 0; i < nlines; i++) {
+            const hc_line_t *l = &c->line[i];
+            if (l->valid && l->dirty &&
+                (first < 0 || l->lba < c->line[first].lba))
+                first = (int)i;
+        }
+        if (first < 0)
+            break;
+
+        /* Gather the contiguous dirty run starting there. */
+        uint32_t start = c->line[first].lba;
+        uint32_t n = 0;
+        while (n < c->stage_blocks && done + n < max_blocks) {
+            int li = find(c, start + n);
+            if (li < 0 || !c->line[li].dirty)
+                break;
+            memcpy(c->stage + (size_t)n * HC_BLOCK_BYTES,
+                   line_data(c, (uint32_t)li), HC_BLOCK_BYTES);
+            n++;
+        }
+        if (n == 0)
+            n = 1;   /* stage_blocks == 0: store the line in place */
+
+        bool ok = (c->stage_blocks == 0)
+                      ? c->io(c->ctx, start, 1, line_data(c, (uint32_t)first), true)
+                      : c->io(c->ctx, start, n, c->stage, true);
+        if (!ok) {
+            c->st.errors++;
+            return -1;
+        }
+        for (uint32_t k = 0; k < n; k++)
+            c->line[find(c, start + k)].dirty = false;
+        c->st.stores++;
+        c->st.stored += n;
+        done += n;
+    }
+    return (int)done;
+}
+
+uint32_t hc_dirty(const hdd_cache_t *c)
+{
+    uint32_t n = 0, nlines = (uint32_t)c->sets * c->ways;
+    for (uint32_t i = 0; i < nlines; i++)
+        n += c->line[i].valid && c->line[i].dirty;
+    return n;
+}
+
+uint32_t hc_cached(const hdd_cache_t *c)
+{
+    uint32_t n = 0, nlines = (uint32_t)c->sets * c->ways;
+    for (uint32_t i = 0; i < nlines; i++)
+        n += c->line[i].valid;
+    return n;
+}
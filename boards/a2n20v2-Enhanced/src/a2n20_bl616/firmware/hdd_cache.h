@@ -0,0 +1,113 @@
+/*
+ * hdd_cache.h — set-associative block cache for the ProDOS HDD server.
+ *
+ * The HDD card (hdl/disk/hdd.sv) asks for a run of blocks at a time (from the
+ * requested block to the end of its ring group), but every run still costs an
+ * image seek + read on the MCU while the Apple II polls STATUS. This cache
+ * sits between serve_hdd() and the image file:
+ *   - lines are 512-byte blocks in a sets x ways array; block b maps to set
+ *     b mod sets (sets is a power of two), LRU within the set
+ *   - a miss reads every consecutive missing block of the request with one
+ *     image read; when the request continues the previous one (a sequential
+ *     stream) the same read also loads up to `ahead` blocks past its end
+ *   - write-back: written blocks are kept dirty and stored later by
+ *     hc_flush(), which coalesces contiguous dirty blocks into one image
+ *     write; a dirty line picked as a victim is stored first. Write-through
+ *     stores the request before returning and updates cached copies.
+ * Read-ahead never evicts a dirty line.
+ *
+ * Storage (lines, data, staging buffer) is the caller's, so the pool can come
+ * from PSRAM or static RAM; the staging buffer bounds one image access and
+ * may be shared by several caches that are used from one thread.
+ *
+ * Pure C, no MCU / FPGA / filesystem dependencies — unit-testable off-target.
+ */
+#ifndef _HDD_CACHE_H
+#define _HDD_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HC_BLOCK_BYTES 512u
+
+/* Image access: count blocks starting at block lba, to (write) or from buf.
+ * True on a full transfer. */
+typedef bool (*hc_io_fn)(void *ctx, uint32_t lba, uint32_t count, void *buf,
+                         bool write);
+
+typedef struct {
+    uint32_t lba;
+    uint32_t used;     /* LRU stamp */
+    bool     valid;
+    bool     dirty;    /* newer than the image */
+    bool     ahead;    /* loaded by read-ahead, not hit yet */
+} hc_line_t;
+
+/* Counters in blocks unless noted. hits + misses = blocks read by the host. */
+typedef struct {
+    uint32_t hits, misses;
+    uint32_t fills;                /* image reads                         */
+    uint32_t ahead, ahead_used;    /* read-ahead blocks loaded / later hit */
+    uint32_t writes;               /* blocks written by the host          */
+    uint32_t stores, stored;       /* image writes / blocks they carried   */
+    uint32_t errors;               /* failed image accesses               */
+} hc_stats_t;
+
+typedef struct {
+    hc_line_t *line;           /* sets * ways                             */
+    uint8_t   *data;           /* sets * ways * HC_BLOCK_BYTES            */
+    uint8_t   *stage;          /* stage_blocks * HC_BLOCK_BYTES           */
+    uint16_t   sets, ways;
+    uint16_t   stage_blocks;
+    uint16_t   ahead;          /* read-ahead blocks on a sequential miss  */
+    uint32_t   clock;
+    uint32_t   next_lba;       /* block after the last read               */
+    uint32_t   nblocks;        /* volume size; nothing is cached past it  */
+    hc_io_fn   io;
+    void      *ctx;
+    hc_stats_t st;
+} hdd_cache_t;
+
+/* Set up an empty cache over caller storage. sets must be a power of two;
+ * ahead is clamped to stage_blocks - 1. stage may be NULL with stage_blocks
+ * 0: misses then load one block at a time, with no read-ahead, and a flush
+ * stores one line per image write. */
+void hc_init(hdd_cache_t *c, hc_line_t *line, uint8_t *data, uint16_t sets,
+             uint16_t ways, uint8_t *stage, uint16_t stage_blocks,
+             uint16_t ahead);
+
+/* Bind to an opened volume of nblocks blocks and forget every line. Flush
+ * the previous volume first (hc_flush) or its dirty blocks are lost. */
+void hc_attach(hdd_cache_t *c, hc_io_fn io, void *ctx, uint32_t nblocks);
+
+/* Forget every line (dirty ones too) and unbind from the volume. */
+void hc_detach(hdd_cache_t *c);
+
+/* Read count blocks from lba into buf. Blocks past the volume end read as
+ * zeros. False if an image read failed (those blocks are zero-filled). */
+bool hc_read(hdd_cache_t *c, uint32_t lba, uint32_t count, void *buf);
+
+/* Write count blocks from buf at lba, kept dirty (write_back) or stored
+ * before returning. Blocks past the volume end are dropped. False if an
+ * image write failed. */
+bool hc_write(hdd_cache_t *c, uint32_t lba, uint32_t count, const void *buf,
+              bool write_back);
+
+/* Store up to max_blocks dirty blocks, lowest LBA first, contiguous runs in
+ * one image write each. Returns the number stored, or -1 if a write failed
+ * (the blocks stay dirty). */
+int hc_flush(hdd_cache_t *c, uint32_t max_blocks);
+
+/* Dirty / valid line counts. */
+uint32_t hc_dirty(const hdd_cache_t *c);
+uint32_t hc_cached(const hdd_cache_t *c);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -13,11 +13,15 @@
   Platform layer rewritten for A2N20 FPGA SPI tunnel.
   SD card is physically connected to FPGA pins; the BL616 MCU accesses it
   by writing/reading FPGA registers 0x6C-0x6E via the existing SPI link.
+  When the FPGA has the SD block engine (CAP0[2]), 512-byte data blocks and
+  the ready wait run in the FPGA (register 0x6F) and the block is moved with
+  a single XFER to/from SPACE 4 instead of three register cycles per byte.
 /------------------------------------------------------------------------*/
 
 #include "ff.h"		/* Obtains integer types for FatFs */
 #include "diskio.h"	/* Common include file for FatFs and disk I/O layer */
 #include "fpga_spi.h"
+#include "fpga_sd.h"
 #include "bflb_mtimer.h"
 
 /*-------------------------------------------------------------------------*/
@@ -37,6 +41,10 @@
 #define SD_REG_CTRL   0x6C  /* [1]=slow_clk, [0]=CS# */
 #define SD_REG_XFER   0x6D  /* W=start xfer with TX byte, R=last RX byte */
 #define SD_REG_STATUS 0x6E  /* [0]=busy */
+#define SD_REG_BLK    0x6F  /* W=block command, R=[1]=err [0]=busy */
+
+#define SD_BLK_RX     0x01  /* Wait for 0xFE token, receive 512 bytes + CRC */
+#define SD_BLK_READY  0x02  /* Clock 0xFF until the card is not busy */
 
 /*-------------------------------------------------------------------------*/
 /* Platform-dependent functions for FPGA SPI tunnel                        */
@@ -47,6 +55,9 @@
 
 static BYTE sd_ctrl_r = 0x03;  /* Current SD_CTRL value: CS# high + slow clock */
 
+static bool blk_avail;         /* FPGA has the block engine (CAP0[2]) */
+static bool blk_enable = true; /* Use it when available (sdtest compares both) */
+
 static
 void dly_us(UINT n)
 {
@@ -66,6 +77,30 @@ BYTE xchg_spi(BYTE dat)
 	return 0xFF;  /* Timeout — return bus-idle value */
 }
 
+/* Run one block-engine command and wait for it (1:OK, 0:Failed/Timeout).
+   The engine has its own token/ready timeouts; this one only guards a
+   wedged FPGA. */
+static
+int blk_cmd(BYTE cmd)
+{
+	uint64_t t0 = bflb_mtimer_get_time_us();
+	BYTE st;
+
+	fpga_spi_reg_write(SD_REG_BLK, cmd);
+	do {
+		st = fpga_spi_reg_read(SD_REG_BLK);
+		if (!(st & 0x01))
+			return (st & 0x02) ? 0 : 1;
+	} while (bflb_mtimer_get_time_us() - t0 < 2000000);
+	return 0;
+}
+
+static
+bool blk_mode(void)
+{
+	return blk_avail && blk_enable;
+}
+
 /*-----------------------------------------------------------------------*/
 /* Transmit bytes to the card                                            */
 /*-----------------------------------------------------------------------*/
@@ -146,6 +181,8 @@ int wait_ready (void)	/* 1:OK, 0:Timeout */
 	UINT tmr;
 
 
+	if (blk_mode()) return blk_cmd(SD_BLK_READY);
+
 	for (tmr = 5000; tmr; tmr--) {	/* Wait for ready in timeout of 500ms */
 		rcvr_mmc(&d, 1);
 		if (d == 0xFF) break;
@@ -205,6 +242,12 @@ int rcvr_datablock (	/* 1:OK, 0:Failed */
 	UINT tmr;
 
 
+	if (btr == 512 && blk_mode()) {	/* Whole block in the FPGA, one XFER out */
+		if (!blk_cmd(SD_BLK_RX)) return 0;
+		fpga_spi_xfer_read(FPGA_SPACE_SDBLK, 0, buff, 512);
+		return 1;
+	}
+
 	for (tmr = 1000; tmr; tmr--) {	/* Wait for data packet in timeout of 100ms */
 		rcvr_mmc(d, 1);
 		if (d[0] != 0xFF) break;
@@ -235,6 +278,11 @@ int xmit_datablock (	/* 1:OK, 0:Failed */
 
 	if (!wait_ready()) return 0;
 
+	if (token != 0xFD && blk_mode()) {	/* One XFER in, token starts the block */
+		fpga_spi_xfer_write(FPGA_SPACE_SDBLK, 0, buff, 512);
+		return blk_cmd(token);
+	}
+
 	d[0] = token;
 	xmit_mmc(d, 1);				/* Xmit a token */
 	if (token != 0xFD) {		/* Is it data token? */
@@ -338,6 +386,9 @@ DSTATUS mmc_disk_initialize (
 
 	dly_us(10000);			/* 10ms */
 
+	/* The block engine only runs at the fast clock; byte path until then */
+	blk_avail = false;
+
 	/* Set CS# high + slow clock for init sequence */
 	sd_ctrl_r = 0x03;		/* [1]=slow_clk, [0]=CS# high */
 	fpga_spi_reg_write(SD_REG_CTRL, sd_ctrl_r);
@@ -382,6 +433,7 @@ DSTATUS mmc_disk_initialize (
 	if (s == 0) {
 		sd_ctrl_r = 0x01;	/* CS# high, fast clock */
 		fpga_spi_reg_write(SD_REG_CTRL, sd_ctrl_r);
+		blk_avail = (fpga_spi_reg_read(FPGA_REG_CAP0) & FPGA_CAP_SD_BLK) != 0;
 	}
 
 	return s;
@@ -461,6 +513,21 @@ DRESULT mmc_disk_write (
 }
 
 
+/*-----------------------------------------------------------------------*/
+/* Block engine control                                                  */
+/*-----------------------------------------------------------------------*/
+
+void mmc_set_block_mode(bool on)
+{
+	blk_enable = on;
+}
+
+bool mmc_block_mode(void)
+{
+	return blk_mode();
+}
+
+
 /*-----------------------------------------------------------------------*/
 /* Miscellaneous Functions                                               */
 /*-----------------------------------------------------------------------*/
@@ -0,0 +1,162 @@
+/*
+ * woz.c — Applesauce WOZ 1.0 / 2.0 image parsing and bitstream <-> nibble
+ * framing for the Disk II server. See woz.h.
+ */
+#include "woz.h"
+
+#include <string.h>
+
+#define WOZ_CHUNK_HDR     8u
+#define WOZ1_TRK_BYTES    6656u   /* TRK record: bits + used u16 + count u16 */
+#define WOZ1_BITS_BYTES   6646u
+#define WOZ1_COUNT_OFF    6648u
+#define WOZ2_TRK_ENTRY    8u      /* start block u16, blocks u16, bits u32   */
+#define WOZ2_BLOCK        512u
+#define WOZ_DISK_525      1u
+
+static uint16_t rd16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t rd32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* Resolve TRKS entry idx to a bitstream location; zero bits if out of range. */
+static bool trk_locate(woz_read_fn rd, void *ctx, uint32_t file_size,
+                       uint8_t version, uint32_t trks_off, uint32_t trks_len,
+                       uint8_t idx, woz_trk_t *t)
+{
+    uint8_t b[WOZ2_TRK_ENTRY];
+    t->off  = 0;
+    t->bits = 0;
+    if (version == 1) {
+        uint32_t rec = (uint32_t)idx * WOZ1_TRK_BYTES;
+        if (rec + WOZ1_TRK_BYTES > trks_len)
+            return true;
+        if (!rd(ctx, trks_off + rec + WOZ1_COUNT_OFF, b, 2))
+            return false;
+        t->off  = trks_off + rec;
+        t->bits = rd16(b);
+        if (t->bits > WOZ1_BITS_BYTES * 8u)
+            t->bits = WOZ1_BITS_BYTES * 8u;
+    } else {
+        if ((uint32_t)idx * WOZ2_TRK_ENTRY + WOZ2_TRK_ENTRY > trks_len)
+            return true;
+        if (!rd(ctx, trks_off + (uint32_t)idx * WOZ2_TRK_ENTRY, b, sizeof(b)))
+            return false;
+        uint32_t blk = rd16(b), nblk = rd16(b + 2), bits = rd32(b + 4);
+        if (blk == 0 || bits == 0 || (bits + 7u) / 8u > nblk * WOZ2_BLOCK)
+            return true;
+        t->off  = blk * WOZ2_BLOCK;
+        t->bits = bits;
+    }
+    if (t->off + (t->bits + 7u) / 8u > file_size)
+        t->off = t->bits = 0;      /* truncated image: treat as unformatted */
+    return true;
+}
+
+bool woz_parse(woz_read_fn rd, void *ctx, uint32_t file_size, woz_image_t *img)
+{
+    static const uint8_t k_sig[4] = { 0xFF, 0x0A, 0x0D, 0x0A };
+    uint8_t hdr[WOZ_HDR_BYTES], tmap[WOZ_QTRACKS];
+    uint32_t trks_off = 0, trks_len = 0;
+    bool have_info = false, have_tmap = false;
+
+    memset(img, 0, sizeof(*img));
+    if (file_size < WOZ_HDR_BYTES || !rd(ctx, 0, hdr, sizeof(hdr)))
+        return false;
+    if (memcmp(hdr, "WOZ", 3) != 0 || memcmp(hdr + 4, k_sig, 4) != 0)
+        return false;
+    if (hdr[3] == '1')
+        img->version = 1;
+    else if (hdr[3] == '2')
+        img->version = 2;
+    else
+        return false;
+
+    uint32_t off = WOZ_HDR_BYTES;
+    while (off + WOZ_CHUNK_HDR <= file_size) {
+        uint8_t ch[WOZ_CHUNK_HDR];
+        if (!rd(ctx, off, ch, sizeof(ch)))
+            return false;
+        uint32_t len  = rd32(ch + 4);
+        uint32_t data = off + WOZ_CHUNK_HDR;
+        if (len > file_size - data)
+            break;                     /* truncated chunk: stop walking */
+        if (memcmp(ch, "INFO", 4) == 0 && len >= 3) {
+            uint8_t info[3];
+            if (!rd(ctx, data, info, sizeof(info)))
+                return false;
+            if (info[1] != WOZ_DISK_525)
+                return false;          /* 3.5" image: not a Disk II disk */
+            img->write_protected = info[2] != 0;
+            have_info = true;
+        } else if (memcmp(ch, "TMAP", 4) == 0 && len >= WOZ_QTRACKS) {
+            if (!rd(ctx, data, tmap, sizeof(tmap)))
+                return false;
+            have_tmap = true;
+        } else if (memcmp(ch, "TRKS", 4) == 0) {
+            trks_off = data;
+            trks_len = len;
+        }
+        off = data + len;
+    }
+    if (!have_info || !have_tmap || trks_len == 0)
+        return false;
+
+    for (unsigned q = 0; q < WOZ_QTRACKS; q++) {
+        if (tmap[q] == WOZ_TMAP_EMPTY)
+            continue;
+        if (q > 0 && tmap[q] == tmap[q - 1]) {   /* adjacent quarters share */
+            img->qtrk[q] = img->qtrk[q - 1];
+            continue;
+        }
+        if (!trk_locate(rd, ctx, file_size, img->version, trks_off, trks_len,
+                        tmap[q], &img->qtrk[q]))
+            return false;
+    }
+    return true;
+}
+
+size_t woz_bits_to_nibbles(const uint8_t *bits, uint32_t nbits,
+                           uint8_t *out, size_t cap)
+{
+    size_t n = 0;
+    uint8_t latch = 0;
+
+    /* First revolution only syncs the latch (zeros before a 1 are absorbed,
+     * as on the real card); the second one is captured. */
+    for (int pass = 0; pass < 2; pass++) {
+        for (uint32_t i = 0; i < nbits; i++) {
+            latch = (uint8_t)((latch << 1) | ((bits[i >> 3] >> (7 - (i & 7))) & 1u));
+            if (latch & 0x80) {
+                if (pass && n < cap)
+                    out[n++] = latch;
+                latch = 0;
+            }
+        }
+    }
+    return n;
+}
+
+void woz_nibbles_to_bits(const uint8_t *nib, size_t n,
+                         uint8_t *bits, uint32_t nbits)
+{
+    uint32_t pos = 0;
+
+    memset(bits, 0, (nbits + 7u) / 8u);
+    for (size_t k = 0; k < n && pos < nbits; k++) {
+        uint8_t b = nib[k];
+        for (int s = 7; s >= 0 && pos < nbits; s--, pos++)
+            if ((b >> s) & 1u)
+                bits[pos >> 3] |= (uint8_t)(0x80u >> (pos & 7));
+        if (b == 0xFF && k > 0 && nib[k - 1] == 0xFF)
+            pos += 2;                  /* self-sync: two trailing zero bits */
+    }
+    /* Pad with sync bytes; a remainder under 8 bits stays zero, which the
+     * latch skips, so the stream still frames from bit 0 after the wrap. */
+    for (; pos + 8u <= nbits; pos += 2) {
+        for (int s = 0; s < 8; s++, pos++)
+            bits[pos >> 3] |= (uint8_t)(0x80u >> (pos & 7));
+    }
+}
@@ -41,7 +41,7 @@ static const char *bt_name(bt_stage_t s)
  * together, so a carry can propagate between byte reads. Re-read the LSB: if
  * it did not wrap during the read, no carry propagated and the sample is
  * consistent. Retry a couple of times, then accept the last read. */
-static uint32_t bt_read_fpga_ticks(void)
+uint32_t bt_read_fpga_ticks(void)
 {
     for (int i = 0; i < 3; i++) {
         uint8_t b0 = fpga_spi_reg_read(REG_SYS_TIME0);
@@ -32,4 +32,8 @@ int  bt_reset_released(void);
 /* Format the timeline table into buf; returns bytes written (< buflen). */
 int  bt_format(char *buf, int buflen);
 
+/* FPGA sys_time now (54 MHz ticks since config-done, wraps every ~79.5 s);
+ * also the bus-trace stream's timebase (bustrace.c). */
+uint32_t bt_read_fpga_ticks(void);
+
 #endif /* BOOT_TIMELINE_H */
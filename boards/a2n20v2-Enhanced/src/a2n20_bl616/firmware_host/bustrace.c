@@ -0,0 +1,297 @@
+/*
+ * bustrace — raw bus-event capture stream on TCP port 6502.
+ *
+ * One client at a time. On connect the event FIFO is switched to rolling
+ * capture and the server sends the stream header (format in bustrace.h),
+ * then loops: sample the FIFO count, pull every waiting entry in one XFER
+ * burst from SPACE 2, and send them as a single timestamped DATA record.
+ * Nothing is formatted on the board; records go out as the FIFO delivers
+ * them, so the only limits are the SPI link and TCP.
+ *
+ * Small batches are held up to BT_FLUSH_MS so a quiet bus does not cost a
+ * TCP segment per millisecond. A full FIFO at drain time means cycles were
+ * lost and is reported in-band as an OVERFLOW record, as are link retries
+ * and a fired freeze trigger.
+ *
+ * The client may send a digit '0'..'7' to select the gateware capture filter
+ * (reg 0x78: 0 everything, 1 I/O, 2 ZP+stack, 3 graphics, 4 ROM, 5 writes,
+ * 6 reads, 7 ES5503); at 20 MHz SPI the whole bus (~4 MB/s) does not fit, a
+ * filtered one does. End of the client's input is ignored (nc closes its
+ * sending side at EOF); the session ends when the connection does.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bflb_mtimer.h"
+
+#include "lwip/sockets.h"
+#include "lwip/netif.h"
+#include "usb_osal.h"
+#include "usb_config.h"
+
+#include "fpga_spi.h"
+#include "osd_console.h"
+#include "boot_timeline.h"
+#include "bustrace.h"
+
+#define BT_POLL_MS      1       /* idle poll; the FIFO fills in ~0.5 ms flat out */
+#define BT_FLUSH_MS     20      /* small batches wait at most this long */
+#define BT_BATCH_MIN    128     /* ...unless this many entries are waiting */
+
+_Static_assert(sizeof(bt_stream_hdr_t) == 32, "bt_stream_hdr_t layout");
+_Static_assert(sizeof(bt_rec_hdr_t) == 16, "bt_rec_hdr_t layout");
+
+static volatile bool s_active;
+
+bool bustrace_active(void)
+{
+    return s_active;
+}
+
+/* Per-session counters, logged at disconnect. */
+static struct {
+    uint32_t records;
+    uint32_t entries;
+    uint32_t wraps;
+    uint32_t link;
+} s_st;
+
+/* One OVERFLOW record + one full DATA record: a drain is a single send. */
+static uint8_t s_buf[2 * sizeof(bt_rec_hdr_t) + BT_FIFO_DEPTH * BT_ENTRY_LEN];
+
+static bool bt_send(int fd, const void *buf, int len)
+{
+    const uint8_t *p = buf;
+    while (len > 0) {
+        int n = lwip_send(fd, p, len, 0);
+        if (n <= 0)
+            return false;          /* closed, reset, or SO_SNDTIMEO expired */
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static uint8_t *put_rec(uint8_t *p, uint8_t type, uint8_t flags, uint16_t count,
+                        uint8_t mode, uint64_t ts)
+{
+    bt_rec_hdr_t h;
+    memset(&h, 0, sizeof(h));
+    h.type = type;
+    h.flags = flags;
+    h.count = count;
+    h.capture_mode = mode;
+    h.ts = ts;
+    memcpy(p, &h, sizeof(h));
+    return p + sizeof(h);
+}
+
+/* Record timestamps: FPGA sys_time extended to 64 bits. The counter wraps
+ * every ~79.5 s and an idle session may not sample it that often, so the
+ * wrap count is not tracked by comparison with the previous sample alone:
+ * the MCU timer says roughly how many ticks have passed, and of the values
+ * congruent to the 32-bit reading the one nearest that estimate is taken.
+ * The MCU clock only has to be right to within ~39 s over the gap. */
+static uint64_t s_ts, s_ts_us;          /* last extended sample, MCU time of it */
+
+static uint64_t ts_start(void)
+{
+    s_ts = bt_read_fpga_ticks();
+    s_ts_us = bflb_mtimer_get_time_us();
+    return s_ts;
+}
+
+static uint64_t ts_now(void)
+{
+    uint32_t raw = bt_read_fpga_ticks();
+    uint64_t us = bflb_mtimer_get_time_us();
+    uint64_t guess = s_ts + (us - s_ts_us) * (BT_TS_HZ / 1000000u);
+    uint64_t t = (guess & ~(uint64_t)0xFFFFFFFFu) | raw;
+    if (t + 0x80000000u < guess)
+        t += (uint64_t)1 << 32;
+    else if (t > guess + 0x80000000u && t >= ((uint64_t)1 << 32))
+        t -= (uint64_t)1 << 32;
+    if (t < s_ts)
+        t = s_ts;                       /* never step backwards */
+    s_ts = t;
+    s_ts_us = us;
+    return t;
+}
+
+/* FIFO status as the telnet snapshot reads it (reg 0x70 [6]=full; the 9-bit
+ * count wraps to 0 when full, so full is checked first). */
+static uint16_t fifo_count(bool *full)
+{
+    uint8_t stat = fpga_spi_reg_read(0x70);
+    *full = (stat & 0x40) != 0;
+    if (*full)
+        return BT_FIFO_DEPTH;
+    return (uint16_t)fpga_spi_reg_read(0x71) |
+           ((uint16_t)(fpga_spi_reg_read(0x72) & 1) << 8);
+}
+
+static void session(int fd)
+{
+    uint8_t mode = fpga_spi_reg_read(0x78) & 0x07;
+    uint8_t oneshot = fpga_spi_reg_read(0x1F) & 0x01;
+    uint8_t trg = fpga_spi_reg_read(0x1A);
+
+    /* Rolling capture: a stream wants the newest cycles, and oneshot would
+     * pause capture at every full FIFO. Restored on disconnect. */
+    fpga_spi_reg_write(0x1F, 0);
+    fpga_spi_reg_write(0x79, 1);
+
+    memset(&s_st, 0, sizeof(s_st));
+    bt_stream_hdr_t sh;
+    memset(&sh, 0, sizeof(sh));
+    memcpy(sh.magic, BT_MAGIC, 4);
+    sh.version = BT_VERSION;
+    sh.hdr_len = sizeof(bt_stream_hdr_t);
+    sh.rec_hdr_len = sizeof(bt_rec_hdr_t);
+    sh.entry_len = BT_ENTRY_LEN;
+    sh.fifo_depth = BT_FIFO_DEPTH;
+    sh.capture_mode = mode;
+    sh.flags = (oneshot ? BT_F_HELD : 0) | ((trg & 0x02) ? BT_F_FROZEN : 0);
+    sh.ts_hz = BT_TS_HZ;
+    sh.t0 = ts_start();
+    if (!bt_send(fd, &sh, sizeof(sh)))
+        goto out;
+
+    fpga_xfer_stats_t xs;
+    fpga_spi_xfer_stats(FPGA_SPACE_FIFO, &xs);
+    uint32_t link_seen = xs.retries + xs.failures;
+    bool frozen = (trg & 0x02) != 0;
+    uint64_t last_send = bflb_mtimer_get_time_us();
+
+    for (;;) {
+        /* client input: capture filter digits (non-blocking) */
+        uint8_t in[16];
+        int r = lwip_recv(fd, in, sizeof(in), MSG_DONTWAIT);
+        if (r < 0 && errno != EWOULDBLOCK && errno != EAGAIN)
+            break;                             /* reset / keepalive-reaped */
+        for (int i = 0; i < r; i++) {
+            if (in[i] >= '0' && in[i] <= '7') {
+                mode = in[i] - '0';
+                fpga_spi_reg_write(0x78, mode);
+            }
+        }
+
+        bool full;
+        uint16_t cnt = fifo_count(&full);
+        uint64_t now = bflb_mtimer_get_time_us();
+
+        if (cnt == 0) {
+            /* Idle: a stopped capture looks the same, so check the trigger. */
+            bool fz = (fpga_spi_reg_read(0x1A) & 0x02) != 0;
+            if (fz && !frozen) {
+                uint8_t *p = put_rec(s_buf, BT_REC_OVERFLOW, BT_F_FROZEN, 0,
+                                     mode, ts_now());
+                if (!bt_send(fd, s_buf, (int)(p - s_buf)))
+                    break;
+                s_st.records++;
+            }
+            frozen = fz;
+            usb_osal_msleep(BT_POLL_MS);
+            continue;
+        }
+        if (cnt < BT_BATCH_MIN && now - last_send < BT_FLUSH_MS * 1000u) {
+            usb_osal_msleep(BT_POLL_MS);
+            continue;
+        }
+
+        uint8_t flags = 0;
+        if (full) {
+            /* Read per drain, not cached: telnet 'o' may toggle it. */
+            flags |= (fpga_spi_reg_read(0x1F) & 0x01) ? BT_F_HELD : BT_F_WRAP;
+            s_st.wraps++;
+        }
+
+        uint64_t ts = ts_now();
+        uint8_t *p = s_buf + sizeof(bt_rec_hdr_t);
+        fpga_spi_xfer_read(FPGA_SPACE_FIFO, 0, p + sizeof(bt_rec_hdr_t),
+                           cnt * BT_ENTRY_LEN);
+
+        fpga_spi_xfer_stats(FPGA_SPACE_FIFO, &xs);
+        if (xs.retries + xs.failures != link_seen) {
+            link_seen = xs.retries + xs.failures;
+            flags |= BT_F_LINK;
+            s_st.link++;
+        }
+
+        /* DATA header sits right after the optional OVERFLOW header, so the
+         * pair and the entries go out contiguously in one send. */
+        uint8_t *start = s_buf + sizeof(bt_rec_hdr_t);
+        if (flags) {
+            start = s_buf;
+            put_rec(s_buf, BT_REC_OVERFLOW, flags, 0, mode, ts);
+            s_st.records++;
+        }
+        p = put_rec(p, BT_REC_DATA, 0, cnt, mode, ts);
+        p += cnt * BT_ENTRY_LEN;
+        if (!bt_send(fd, start, (int)(p - start)))
+            break;
+        s_st.records++;
+        s_st.entries += cnt;
+        last_send = now;
+    }
+
+out:
+    fpga_spi_reg_write(0x1F, oneshot);
+    osd_log("BUSTRACE: %lu CYC %lu GAPS",
+            (unsigned long)s_st.entries, (unsigned long)(s_st.wraps + s_st.link));
+}
+
+static void bustrace_thread(void *arg)
+{
+    (void)arg;
+    /* Same lwIP init race as telnetd: wait for the stack to be up. */
+    while (netif_default == NULL)
+        usb_osal_msleep(200);
+
+    int lfd = lwip_socket(AF_INET, SOCK_STREAM, 0);
+    if (lfd < 0)
+        return;
+    struct sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port = PP_HTONS(BT_PORT);
+    sa.sin_addr.s_addr = PP_HTONL(INADDR_ANY);
+    int one = 1;
+    lwip_setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (lwip_bind(lfd, (struct sockaddr *)&sa, sizeof(sa)) < 0)
+        return;
+    lwip_listen(lfd, 1);
+    osd_log("BUSTRACE: LISTENING ON PORT %d", BT_PORT);
+
+    for (;;) {
+        int fd = lwip_accept(lfd, NULL, NULL);
+        if (fd < 0) {
+            usb_osal_msleep(500);
+            continue;
+        }
+        /* A stalled reader fills the window; give up rather than wedge the
+         * single-session server (the FIFO just wraps meanwhile). */
+        struct timeval stv = { .tv_sec = 3, .tv_usec = 0 };
+        lwip_setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &stv, sizeof(stv));
+        lwip_setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        /* A quiet bus sends nothing; keepalive reaps a vanished peer. */
+        int idle = 10, intvl = 5, cnt = 3;
+        lwip_setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+        lwip_setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle));
+        lwip_setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &intvl, sizeof(intvl));
+        lwip_setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &cnt, sizeof(cnt));
+        s_active = true;
+        osd_log("BUSTRACE: CLIENT CONNECTED");
+        session(fd);
+        s_active = false;
+        lwip_close(fd);
+    }
+}
+
+void bustrace_init(void)
+{
+    usb_osal_thread_create("bustrace", 3072, CONFIG_USBHOST_PSC_PRIO + 1,
+                           bustrace_thread, NULL);
+}
@@ -0,0 +1,99 @@
+/*
+ * bustrace — raw bus-event capture stream on TCP port 6502 (see bustrace.c).
+ *
+ * The telnet scope ('s') formats every FIFO entry as a text line, which
+ * cannot keep up with a busy bus. This server instead ships the event FIFO's
+ * 4-byte entries exactly as the gateware wrote them, in whole-FIFO XFER
+ * bursts, so a host can record long captures and decode them offline
+ * (tools/bustrace_decode.c).
+ *
+ * Stream format (version 1, all fields little-endian):
+ *
+ *   bt_stream_hdr_t            once, at connect
+ *   { bt_rec_hdr_t [entries] } repeated until the client disconnects
+ *
+ * A DATA record is followed by `count` entries of BT_ENTRY_LEN bytes, oldest
+ * first, each laid out as the FIFO delivers it:
+ *
+ *   byte 0  ctrl     [7]rw_n(1=rd) [6]/INH [5]/RESET [4]/IRQ [3]/NMI
+ *                    [2]/DMA [1]/RDY [0]m2sel_n   (control lines active-low)
+ *   byte 1  data
+ *   byte 2  addr low
+ *   byte 3  addr high
+ *
+ * Entries carry no time of their own. A record's `ts` is the FPGA sys_time
+ * counter (SPI regs 0x08-0x0B, one tick per 54 MHz logic clock, extended to
+ * 64 bits by the server) read just after the FIFO count was sampled, so every
+ * entry in the record was captured at or before it. This is the clock the
+ * capture itself runs on, so record spacing can be compared with bus cycles
+ * (~53 ticks each) directly; with capture mode 0 (everything) consecutive
+ * entries are consecutive bus cycles unless an OVERFLOW record sits between
+ * them. Decoders scale by the header's ts_hz rather than assuming a rate.
+ *
+ * An OVERFLOW record (count 0) marks where cycles are missing or capture has
+ * stopped; its flags say why:
+ *
+ *   BT_F_WRAP    the FIFO was full when drained in rolling mode: the gateware
+ *                overwrote the oldest cycles since the previous record. Sent
+ *                just before the DATA record that follows the gap.
+ *   BT_F_HELD    the FIFO was full in oneshot mode: capture paused until the
+ *                drain, so the newest cycles were not recorded.
+ *   BT_F_LINK    an XFER CRC retry or failure hit this drain; FIFO reads pop,
+ *                so entries may be missing or repeated in the next record.
+ *   BT_F_FROZEN  the freeze trigger (telnet 't') fired: capture has stopped
+ *                after the preceding record until the trigger is re-armed.
+ */
+#ifndef _BUSTRACE_H
+#define _BUSTRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BT_PORT          6502
+#define BT_MAGIC         "A2BT"
+#define BT_VERSION       1
+#define BT_ENTRY_LEN     4
+#define BT_FIFO_DEPTH    512
+#define BT_TS_HZ         54000000u   /* FPGA sys_time (logic clock) */
+
+/* Record types */
+#define BT_REC_DATA      1
+#define BT_REC_OVERFLOW  2
+
+/* OVERFLOW flags (and bt_stream_hdr_t.flags: BT_F_HELD = oneshot was on) */
+#define BT_F_WRAP        0x01
+#define BT_F_HELD        0x02
+#define BT_F_LINK        0x04
+#define BT_F_FROZEN      0x08
+
+typedef struct {
+    char     magic[4];          /* BT_MAGIC                                  */
+    uint16_t version;           /* BT_VERSION                                */
+    uint16_t hdr_len;           /* sizeof(bt_stream_hdr_t)                   */
+    uint16_t rec_hdr_len;       /* sizeof(bt_rec_hdr_t)                      */
+    uint16_t entry_len;         /* BT_ENTRY_LEN                              */
+    uint16_t fifo_depth;        /* BT_FIFO_DEPTH                             */
+    uint8_t  capture_mode;      /* reg 0x78 at connect (0 = everything)      */
+    uint8_t  flags;             /* capture state at connect (BT_F_*)         */
+    uint32_t ts_hz;             /* timestamp ticks per second (BT_TS_HZ)     */
+    uint32_t reserved;
+    uint64_t t0;                /* timestamp at connect                      */
+} bt_stream_hdr_t;              /* 32 bytes */
+
+typedef struct {
+    uint8_t  type;              /* BT_REC_*                                  */
+    uint8_t  flags;             /* BT_F_* (OVERFLOW records)                 */
+    uint16_t count;             /* entries that follow (DATA records)        */
+    uint8_t  capture_mode;      /* reg 0x78 for these entries                */
+    uint8_t  reserved[3];
+    uint64_t ts;                /* timestamp, ts_hz units                    */
+} bt_rec_hdr_t;                 /* 16 bytes */
+
+/* Spawn the server task. Call after tcpip_init(), like telnetd_init(). */
+void bustrace_init(void);
+
+/* A capture client is connected. The FIFO has one reader: the telnet
+ * snapshot/scope commands stand aside while this is true. */
+bool bustrace_active(void);
+
+#endif
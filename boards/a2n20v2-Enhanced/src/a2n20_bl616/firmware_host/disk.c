@@ -8,7 +8,9 @@
  */
 
 #include <stdbool.h>
+#include <stddef.h>        /* offsetof */
 #include <stdint.h>
+#include <stdio.h>         /* snprintf */
 #include <string.h>
 
 #include "ff.h"
@@ -21,6 +23,9 @@
 #include "osd_console.h"   /* shared boot/status console */
 #include "bflb_mtimer.h"   /* bflb_mtimer_get_time_us — load-latency timing */
 #include "gcr_dsk.h"       /* on-the-fly .dsk/.do <-> 6-and-2 GCR nibble codec */
+#include "woz.h"           /* .woz bitstream index + latch framing */
+#include "hdd_cache.h"     /* ProDOS HDD block cache + read-ahead */
+#include "crc32.h"         /* journal record CRCs */
 #include "settings.h"      /* persisted image overrides + boot preference */
 #include "fwupdate.h"
 #include "fpgaupdate.h"      /* firmware self-update (staged from this thread) */
@@ -49,7 +54,8 @@ extern bool g_slots_applied_early;  /* main.c: early slot map confirmed+strobed
  *   base+0  R: {wr, rd} request pending    W: CTL {readonly, mounted, ready}
  *   base+1  R: LBA low  (ProDOS block #)   W: SIZE low  (blocks)
  *   base+2  R: LBA high                    W: SIZE high
- *   base+3  R: -                           W: ACK (strobe)
+ *   base+3  R: BLKCNT (blocks - 1 of a     W: ACK (strobe; HDD_ACK_ERR
+ *              read run)                      = failed, ProDOS I/O error)
  * Unit 0 at 0x26, unit 1 at 0x2A. */
 #define HDD_BASE(u)       (0x26u + (u) * 4u)
 #define HDD_REQ(u)        (HDD_BASE(u) + 0u)   /* R */
@@ -59,40 +65,53 @@ extern bool g_slots_applied_early;  /* main.c: early slot map confirmed+strobed
 #define HDD_SIZE_L(u)     (HDD_BASE(u) + 1u)   /* W */
 #define HDD_SIZE_H(u)     (HDD_BASE(u) + 2u)   /* W */
 #define HDD_ACK(u)        (HDD_BASE(u) + 3u)   /* W */
+#define HDD_BLKCNT(u)     (HDD_BASE(u) + 3u)   /* R */
 #define HDD_CTL_READY     0x01u
 #define HDD_CTL_MOUNTED   0x02u
 #define HDD_CTL_READONLY  0x04u
+#define HDD_ACK_OK        0x01u
+#define HDD_ACK_ERR       0x02u
 
 #define REG_CARDROM_REL   0x31u   /* W: release the CardROM INH overlay */
 
 /* ---- SDRAM track windows (must match top.sv DISK_WORD_BASE + d*0x2000) ----
  * DISK_WORD_BASE = word 0x080000 = byte 0x200000; per-drive stride = 8KB.
- * HDD block windows follow at byte 0x204000, 512 bytes per unit. */
+ * HDD block rings follow at byte 0x204000, 4KB per unit: block b of a unit
+ * lives in slot b mod HDD_RING_BLOCKS (hdd.sv RING_LOG2 = 3). */
 #define DISK_WINDOW_BASE    0x200000u
 #define DISK_WINDOW_STRIDE  0x2000u
 #define HDD_WINDOW_BASE     0x204000u
-#define HDD_WINDOW_STRIDE   0x200u
+#define HDD_WINDOW_STRIDE   0x1000u
+#define HDD_RING_BLOCKS     8u
 #define SECTOR_BYTES        512u
 #define MAX_TRACK_BYTES     0x1A00u   /* 6656 = 13 sectors */
 
 #define NDRV 2   /* Disk II floppy drives */
 #define NHDD 2   /* ProDOS HDD units      */
 
+#define DISK_TRACKS 35u   /* 5.25" tracks per .dsk/.nib image (enforced at mount) */
+
 /* Per-drive image format:
  *   FMT_NIB — raw nibble track, streamed as-is
  *   FMT_DSK — sector image (16*256 B/track) that gcr_dsk nibblizes on load /
  *             de-nibblizes on flush; g_order[] gives the file's sector order
  *             (.dsk/.do = DOS 3.3, .po = ProDOS)
+ *   FMT_WOZ — WOZ 1.0/2.0 bitstream image; TMAP/TRKS are indexed once at
+ *             mount (g_woz[]) and a track is one contiguous read, framed into
+ *             nibbles by the Disk II latch model — no sector decode, so
+ *             copy-protected layouts survive
  * A .2mg is a 64-byte header wrapping one of the above; g_base[] carries the
  * payload's byte offset within the file (0 for bare images). */
-typedef enum { FMT_NONE = 0, FMT_NIB, FMT_DSK } disk_fmt_t;
+typedef enum { FMT_NONE = 0, FMT_NIB, FMT_DSK, FMT_WOZ } disk_fmt_t;
 
 /* Candidate images per drive, tried in order (first that opens wins).
  * Sector formats take priority over .nib. OSD/config selection later. */
-#define NCAND 5
+#define NCAND 6
 static const char *const g_candidates[NDRV][NCAND] = {
-    { "0:/disk1.dsk", "0:/disk1.do", "0:/disk1.po", "0:/disk1.2mg", "0:/disk1.nib" },
-    { "0:/disk2.dsk", "0:/disk2.do", "0:/disk2.po", "0:/disk2.2mg", "0:/disk2.nib" },
+    { "0:/disk1.dsk", "0:/disk1.do", "0:/disk1.po", "0:/disk1.2mg", "0:/disk1.nib",
+      "0:/disk1.woz" },
+    { "0:/disk2.dsk", "0:/disk2.do", "0:/disk2.po", "0:/disk2.2mg", "0:/disk2.nib",
+      "0:/disk2.woz" },
 };
 
 static FATFS       g_fs;
@@ -103,11 +122,16 @@ static disk_fmt_t  g_fmt[NDRV];
 static gcr_order_t g_order[NDRV];                /* sector order for FMT_DSK    */
 static uint32_t    g_base[NDRV];                 /* payload offset (.2mg header)*/
 static char        g_imgname[NDRV][SETTINGS_NAME_LEN + 4]; /* resolved image path */
+static uint32_t    g_ntracks[NDRV];              /* whole tracks served         */
 static uint8_t     g_trackbuf[MAX_TRACK_BYTES];  /* nibble track (SDRAM window) */
 static uint8_t     g_secbuf[DSK_TRACK_BYTES];    /* one sector track (16*256)   */
+static woz_image_t g_woz[NDRV];                  /* FMT_WOZ track index         */
+static bool        g_woz_crc_off[NDRV];          /* header CRC already zeroed   */
+static uint8_t     g_wozbits[MAX_TRACK_BYTES];   /* one WOZ track bitstream     */
 
-/* ProDOS HDD units: raw 512-byte block volumes (.hdv/.po/.2mg), served one
- * block at a time, LBA 1:1 into the image payload. */
+/* ProDOS HDD units: raw 512-byte block volumes (.hdv/.po/.2mg), LBA 1:1 into
+ * the image payload, served a run of blocks at a time through the unit's
+ * SDRAM ring and a block cache (see the HDD block cache section below). */
 static const char *const g_hdd_candidates[NHDD][3] = {
     { "0:/hdd1.hdv", "0:/hdd1.po", "0:/hdd1.2mg" },
     { "0:/hdd2.hdv", "0:/hdd2.po", "0:/hdd2.2mg" },
@@ -118,7 +142,7 @@ static bool     g_hdd_writable[NHDD];
 static uint32_t g_hdd_base[NHDD];       /* payload offset (.2mg header)  */
 static uint32_t g_hdd_blocks[NHDD];     /* size in 512-byte blocks       */
 static char     g_hdd_name[NHDD][SETTINGS_NAME_LEN + 4];
-static uint8_t  g_blockbuf[SECTOR_BYTES];
+static uint8_t  g_blockbuf[HDD_RING_BLOCKS * SECTOR_BYTES];   /* one run */
 
 static void fs_service(void);   /* async FS proxy step (defined below) */
 
@@ -161,6 +185,8 @@ static disk_fmt_t detect_format(const char *name, gcr_order_t *order)
     *order = GCR_ORDER_DOS;
     if (has_ext(name, "nib"))
         return FMT_NIB;
+    if (has_ext(name, "woz"))
+        return FMT_WOZ;
     if (has_ext(name, "dsk") || has_ext(name, "do"))
         return FMT_DSK;
     if (has_ext(name, "po")) {
@@ -254,6 +280,591 @@ static void reg_write32(uint8_t reg, uint32_t val)
     fpga_spi_reg_write(reg + 3, (uint8_t)(val >> 24));
 }
 
+/* woz_parse() file access: len bytes at byte offset off of FIL *ctx. */
+static bool woz_read(void *ctx, uint32_t off, void *buf, uint32_t len)
+{
+    FIL *f = (FIL *)ctx;
+    UINT br = 0;
+    return f_lseek(f, (FSIZE_t)off) == FR_OK &&
+           f_read(f, buf, len, &br) == FR_OK && br == len;
+}
+
+/* Bitstream of whole track `track` of WOZ drive v (quarter track 4*track),
+ * or NULL if the image leaves it unformatted. */
+static const woz_trk_t *woz_track(int v, uint32_t track)
+{
+    if (track >= WOZ_TRACKS || g_woz[v].qtrk[track * 4u].bits == 0)
+        return NULL;
+    return &g_woz[v].qtrk[track * 4u];
+}
+
+/* Bits of a WOZ track that fit the window (one nibble needs >= 8 bits, so a
+ * longer stream could not be shown whole anyway). */
+static uint32_t woz_nbits(const woz_trk_t *t)
+{
+    return t->bits < MAX_TRACK_BYTES * 8u ? t->bits : MAX_TRACK_BYTES * 8u;
+}
+
+/* Produce the nibble stream for nbyte bytes at floppy LBA lba of drive v into
+ * out: .dsk/.do/.po tracks are read as 16 file-order sectors and nibblized,
+ * .woz bitstreams are latch-framed, .nib is read as-is. A short .nib read is zero-filled (and logged when
+ * log_short is set — a prefetch stays quiet and simply is not cached).
+ * Returns false on a short read. */
+static bool load_track(int v, uint32_t lba, uint32_t nbyte, uint8_t *out,
+                       bool log_short)
+{
+    uint32_t track = lba / 13u;
+    if (g_fmt[v] == FMT_DSK) {
+        /* Read this track's 16*256 file-order sectors and nibblize them
+         * into the 6-and-2 GCR stream the window expects. */
+        UINT br = 0;
+        if (f_lseek(&g_img[v], (FSIZE_t)g_base[v] +
+                               (FSIZE_t)track * DSK_TRACK_BYTES) == FR_OK)
+            f_read(&g_img[v], g_secbuf, DSK_TRACK_BYTES, &br);
+        if (br < DSK_TRACK_BYTES)
+            memset(g_secbuf + br, 0, DSK_TRACK_BYTES - br);
+        gcr_encode_dos_track(g_secbuf, (uint8_t)track, DSK_DEFAULT_VOLUME,
+                             g_order[v], out, MAX_TRACK_BYTES);
+        return true;
+    }
+
+    if (g_fmt[v] == FMT_WOZ) {
+        /* One read of the track's bitstream (offset/length cached at
+         * mount), framed into nibbles; the rest of the window is sync. An
+         * unformatted track serves an all-zero window, like a blank disk. */
+        const woz_trk_t *t = woz_track(v, track);
+        size_t n  = 0;
+        bool   ok = true;
+        if (t) {
+            uint32_t nbits = woz_nbits(t);
+            ok = woz_read(&g_img[v], t->off, g_wozbits, (nbits + 7u) / 8u);
+            if (ok)
+                n = woz_bits_to_nibbles(g_wozbits, nbits, out, MAX_TRACK_BYTES);
+            else if (log_short)
+                osd_log("DISK II: D%d TRK%lu WOZ read failed", v + 1,
+                        (unsigned long)track);
+        }
+        memset(out + n, n ? 0xFF : 0x00, MAX_TRACK_BYTES - n);
+        return ok;
+    }
+
+    /* .nib: raw nibble stream, streamed as-is. */
+    UINT br = 0;
+    if (f_lseek(&g_img[v], (FSIZE_t)g_base[v] +
+                           (FSIZE_t)lba * SECTOR_BYTES) == FR_OK)
+        f_read(&g_img[v], out, nbyte, &br);
+    if (br < nbyte) {
+        /* EOF: a zero-filled track has no sync/prologue nibbles, so RWTS
+         * finds nothing and DOS I/O-errors at this same track every boot
+         * — pinpoints a truncated/short .nib. */
+        if (log_short) {
+            osd_console_show();
+            osd_log("DISK II: TRK%lu SHORT br=%lu/%lu (EOF) -> zero-fill",
+                    (unsigned long)track,
+                    (unsigned long)br, (unsigned long)nbyte);
+        }
+        memset(out + br, 0, nbyte - br);
+        return false;
+    }
+    return true;
+}
+
+/* ---- Write-back journal ---------------------------------------------------
+ * In write-back mode a dirty track reaches its image from a background step,
+ * long after the Apple II was acked. To keep that flush power-safe the exact
+ * bytes about to be written (and where) are first committed to a journal file
+ * on the volume; the record is invalidated only once the image write is
+ * synced. A flush cut short by power loss or media removal leaves a valid
+ * record, which mount_drive() replays into the same image (matched by path)
+ * before serving it. A record whose payload CRC fails was torn while
+ * journaling, so the image was never touched and the record is simply
+ * dropped. One flush = one track = one record. The leading '_' keeps the file
+ * out of the menu's listings. */
+#define JNL_PATH   "0:/_a2fpga.jnl"
+#define JNL_MAGIC  0x4E4A3241u   /* 'A2JN' */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t off;                          /* byte offset within the image */
+    uint32_t len;                          /* payload bytes after the header */
+    uint32_t data_crc;                     /* CRC-32 of the payload */
+    char     path[SETTINGS_NAME_LEN + 4];  /* image the record belongs to */
+    uint32_t crc;                          /* CRC-32 of everything above */
+} jnl_hdr_t;
+
+static FIL  g_jnl;
+static bool g_jnl_open;
+
+static bool jnl_open(void)
+{
+    if (!g_jnl_open)
+        g_jnl_open = f_open(&g_jnl, JNL_PATH,
+                            FA_READ | FA_WRITE | FA_OPEN_ALWAYS) == FR_OK;
+    return g_jnl_open;
+}
+
+static void jnl_close(void)
+{
+    if (g_jnl_open) {
+        f_close(&g_jnl);
+        g_jnl_open = false;
+    }
+}
+
+/* Commit one record for drive v's image. True once it is on the volume. */
+static bool jnl_write(int v, uint32_t off, const uint8_t *data, uint32_t len)
+{
+    if (!jnl_open())
+        return false;
+    jnl_hdr_t h;
+    memset(&h, 0, sizeof(h));
+    h.magic    = JNL_MAGIC;
+    h.off      = off;
+    h.len      = len;
+    h.data_crc = crc32_calc(data, len);
+    snprintf(h.path, sizeof(h.path), "%s", g_imgname[v]);
+    h.crc      = crc32_calc(&h, offsetof(jnl_hdr_t, crc));
+    UINT bw1 = 0, bw2 = 0;
+    if (f_lseek(&g_jnl, 0) != FR_OK ||
+        f_write(&g_jnl, &h, sizeof(h), &bw1) != FR_OK || bw1 != sizeof(h) ||
+        f_write(&g_jnl, data, len, &bw2) != FR_OK || bw2 != len)
+        return false;
+    return f_sync(&g_jnl) == FR_OK;
+}
+
+/* Invalidate the record (its image write has been synced). */
+static void jnl_clear(void)
+{
+    uint32_t zero = 0;
+    UINT bw = 0;
+    if (g_jnl_open && f_lseek(&g_jnl, 0) == FR_OK) {
+        f_write(&g_jnl, &zero, sizeof(zero), &bw);
+        f_sync(&g_jnl);
+    }
+}
+
+/* Replay a pending record that belongs to drive v's just-opened (read-write)
+ * image. Uses g_trackbuf as scratch: nothing is being served yet. */
+static void jnl_replay(int v)
+{
+    jnl_hdr_t h;
+    UINT br = 0;
+    if (!jnl_open() || f_lseek(&g_jnl, 0) != FR_OK ||
+        f_read(&g_jnl, &h, sizeof(h), &br) != FR_OK || br != sizeof(h))
+        return;
+    if (h.magic != JNL_MAGIC ||
+        h.crc != crc32_calc(&h, offsetof(jnl_hdr_t, crc)))
+        return;   /* no pending record */
+    h.path[sizeof(h.path) - 1] = '\0';
+    if (strcmp(h.path, g_imgname[v]) != 0)
+        return;   /* someone else's record: leave it for that image */
+    br = 0;
+    if (h.len > MAX_TRACK_BYTES ||
+        f_read(&g_jnl, g_trackbuf, h.len, &br) != FR_OK || br != h.len ||
+        crc32_calc(g_trackbuf, h.len) != h.data_crc) {
+        osd_log("DISK II: D%d TORN JOURNAL RECORD DROPPED", v + 1);
+        jnl_clear();
+        return;
+    }
+    UINT bw = 0;
+    if (f_lseek(&g_img[v], h.off) == FR_OK) {
+        f_write(&g_img[v], g_trackbuf, h.len, &bw);
+        f_sync(&g_img[v]);
+    }
+    osd_log("DISK II: D%d JOURNAL REPLAYED (%lu B @ %lu)", v + 1,
+            (unsigned long)h.len, (unsigned long)h.off);
+    jnl_clear();
+}
+
+/* Write len bytes at byte offset off of drive v's image and sync them;
+ * journaled first when asked (background write-back flushes). */
+static void image_write(int v, uint32_t off, const uint8_t *data, uint32_t len,
+                        bool journal)
+{
+    bool jnl = journal && jnl_write(v, off, data, len);
+    UINT bw = 0;
+    if (f_lseek(&g_img[v], (FSIZE_t)off) == FR_OK) {
+        f_write(&g_img[v], data, len, &bw);
+        f_sync(&g_img[v]);
+    }
+    if (jnl)
+        jnl_clear();
+}
+
+/* Store a nibble track (nbyte bytes at floppy LBA lba) of drive v to its
+ * image: .dsk/.do/.po are de-nibblized back to file-order sectors, .woz is
+ * re-serialized into the track's TRKS bitstream, .nib is written as-is. */
+static void store_track(int v, uint32_t lba, uint32_t nbyte,
+                        const uint8_t *nib, bool journal)
+{
+    if (g_fmt[v] == FMT_DSK) {
+        /* Decode the (possibly partly rewritten) nibble track back to
+         * file-order sectors. Preload the current on-file track so any
+         * sector that fails to decode keeps its existing bytes; gate the
+         * write on the found-mask so a bad decode never corrupts the
+         * image. */
+        uint32_t track = lba / 13u;
+        uint32_t fpos  = g_base[v] + track * DSK_TRACK_BYTES;
+        UINT br = 0;
+        if (f_lseek(&g_img[v], (FSIZE_t)fpos) == FR_OK)
+            f_read(&g_img[v], g_secbuf, DSK_TRACK_BYTES, &br);
+        if (br < DSK_TRACK_BYTES)
+            memset(g_secbuf + br, 0, DSK_TRACK_BYTES - br);
+        uint16_t mask = gcr_decode_dos_track(nib, MAX_TRACK_BYTES,
+                                             g_order[v], g_secbuf);
+        if (mask != 0)
+            image_write(v, fpos, g_secbuf, DSK_TRACK_BYTES, journal);
+        if (mask != 0xFFFF)
+            osd_log("DISK II: D%d TRK%lu wr partial mask=%04X",
+                    v + 1, (unsigned long)track, (unsigned)mask);
+    } else if (g_fmt[v] == FMT_WOZ) {
+        /* Same bit count as on file, so the bitstream is rewritten in place
+         * (one journaled region). The header CRC no longer matches the
+         * file: zero it ("not computed") before the first track lands. */
+        uint32_t track = lba / 13u;
+        const woz_trk_t *t = woz_track(v, track);
+        if (!t) {
+            osd_log("DISK II: D%d TRK%lu not in WOZ - wr dropped",
+                    v + 1, (unsigned long)track);
+            return;
+        }
+        uint32_t nbits = woz_nbits(t);
+        woz_nibbles_to_bits(nib, MAX_TRACK_BYTES, g_wozbits, nbits);
+        if (!g_woz_crc_off[v]) {
+            static const uint8_t zero[4] = { 0, 0, 0, 0 };
+            image_write(v, WOZ_CRC_OFFSET, zero, sizeof(zero), false);
+            g_woz_crc_off[v] = true;
+        }
+        image_write(v, t->off, g_wozbits, (nbits + 7u) / 8u, journal);
+    } else {
+        image_write(v, g_base[v] + lba * SECTOR_BYTES, nib, nbyte, journal);
+    }
+}
+
+/* ---- Nibblized track cache --------------------------------------------------
+ * Without it every seek costs an f_lseek/f_read plus a full 6-and-2 encode
+ * while the Apple II waits on the ack. Whole tracks are kept pre-nibblized in
+ * RAM instead, so a hit is answered with nothing but the SDRAM window XFER.
+ * Slots are filled
+ *   - on a miss (the requested track is loaded and kept),
+ *   - ahead of the head: after serving track t while stepping in direction d,
+ *     idle polls load t+d then t+2d (DOS 3.3 and ProDOS both step
+ *     track-to-track through a file),
+ *   - by a background warm-up after mount: idle polls walk the disk from
+ *     track 0, into FREE slots only (warming never evicts).
+ * An idle poll loads at most one track, so a request arriving meanwhile waits
+ * for one image read at worst — what every seek used to cost. The pool is a
+ * static LRU of TC_SLOTS tracks shared by both drives (6 x 6656 B = 39 KB of
+ * the BL616's SRAM).
+ *
+ * Write-back (settings()->disk_writeback): a whole-track write is acked as
+ * soon as the window has been copied into its slot, which is then DIRTY —
+ * never evicted, and rewrites of the same track coalesce into it. The
+ * background step stores it (through the journal) once the track has been
+ * quiet for WB_IDLE_US on an idle poll, or WB_MAX_US after it first went
+ * dirty even while busy. Anything the cache cannot hold, and every write in
+ * write-through mode, is stored synchronously before the ack as before. */
+#define TC_SLOTS    6
+#define TC_AHEAD    2         /* tracks prefetched ahead of the head */
+#define WB_IDLE_US  250000u   /* quiet time before an idle flush     */
+#define WB_MAX_US   2000000u  /* dirty age that forces a flush       */
+
+typedef struct {
+    int8_t   drive;     /* owning drive, -1 = free */
+    uint8_t  track;
+    bool     dirty;     /* newer than the image (write-back) */
+    uint32_t used;      /* LRU stamp (g_tc_clock at last fill/hit) */
+    uint64_t dirty_at;  /* first write since the last flush (us) */
+    uint64_t wr_at;     /* latest write (us) */
+} tc_slot_t;
+
+static uint8_t   g_tc_data[TC_SLOTS][MAX_TRACK_BYTES];
+static tc_slot_t g_tc_slot[TC_SLOTS] = {
+    [0 ... TC_SLOTS - 1] = { .drive = -1 }
+};
+static uint32_t  g_tc_clock;
+static int       g_tc_head[NDRV] = { -1, -1 };  /* last served track       */
+static int       g_tc_dir[NDRV]  = { 1, 1 };    /* head stepping direction */
+static uint32_t  g_tc_warm[NDRV];            /* next track of the warm walk */
+
+/* Serve statistics (see disk_get_track_stats). Latency sums are kept wide
+ * here and averaged on read-out. */
+typedef struct {
+    uint32_t hits, misses, prefetches, writes;
+    uint32_t coalesced, flushes;
+    uint64_t hit_us_sum, miss_us_sum, flush_us_sum;
+    uint32_t hit_us_max, miss_us_max, flush_us_max;
+} tc_stats_t;
+static tc_stats_t    g_tc_stats[NDRV];
+static volatile bool g_tc_stats_reset_req;
+
+/* Store dirty slot i to its image (journaled) and mark it clean. */
+static void tc_flush_slot(int i)
+{
+    tc_slot_t *sl = &g_tc_slot[i];
+    int        v  = sl->drive;
+    uint64_t   t0 = bflb_mtimer_get_time_us();
+
+    store_track(v, (uint32_t)sl->track * 13u, MAX_TRACK_BYTES, g_tc_data[i], true);
+    sl->dirty = false;
+
+    tc_stats_t *st = &g_tc_stats[v];
+    uint32_t us = (uint32_t)(bflb_mtimer_get_time_us() - t0);
+    st->flushes++;
+    st->flush_us_sum += us;
+    if (us > st->flush_us_max)
+        st->flush_us_max = us;
+}
+
+/* Forget every cached track of drive v (remount / eject / image change).
+ * Dirty tracks are stored first, so call this while the image is still
+ * open. */
+static void tc_drop_drive(int v)
+{
+    for (int i = 0; i < TC_SLOTS; i++) {
+        if (g_tc_slot[i].drive != v)
+            continue;
+        if (g_tc_slot[i].dirty && g_mounted[v])
+            tc_flush_slot(i);
+        g_tc_slot[i].dirty = false;
+        g_tc_slot[i].drive = -1;
+    }
+    g_tc_head[v] = -1;
+    g_tc_dir[v]  = 1;
+    g_tc_warm[v] = 0;
+}
+
+static int tc_find(int v, uint32_t track)
+{
+    for (int i = 0; i < TC_SLOTS; i++)
+        if (g_tc_slot[i].drive == v && g_tc_slot[i].track == track)
+            return i;
+    return -1;
+}
+
+/* Claim a slot for (v, track): a free one, else (if evict) the least recently
+ * used clean one. The slot is tagged but its data is the caller's to fill. */
+static int tc_alloc(int v, uint32_t track, bool evict)
+{
+    int pick = -1;
+    for (int i = 0; i < TC_SLOTS; i++) {
+        if (g_tc_slot[i].drive < 0) {
+            pick = i;
+            break;
+        }
+        if (evict && !g_tc_slot[i].dirty &&
+            (pick < 0 || g_tc_slot[i].used < g_tc_slot[pick].used))
+            pick = i;
+    }
+    if (pick >= 0) {
+        g_tc_slot[pick].drive = (int8_t)v;
+        g_tc_slot[pick].track = (uint8_t)track;
+        g_tc_slot[pick].used  = ++g_tc_clock;
+    }
+    return pick;
+}
+
+/* Load one whole track of drive v into a cache slot (prefetch / warm-up). */
+static bool tc_fill(int v, uint32_t track, bool evict)
+{
+    int i = tc_alloc(v, track, evict);
+    if (i < 0)
+        return false;
+    if (!load_track(v, track * 13u, MAX_TRACK_BYTES, g_tc_data[i], false)) {
+        g_tc_slot[i].drive = -1;   /* short image: leave it to the demand path */
+        return false;
+    }
+    g_tc_stats[v].prefetches++;
+    return true;
+}
+
+/* Write-back step: store at most one due dirty track (the oldest). In
+ * write-through mode every dirty track is due, so switching modes drains
+ * them. Returns true if it flushed one. */
+static bool tc_flush_step(bool idle)
+{
+    uint64_t now  = bflb_mtimer_get_time_us();
+    bool     wb   = settings()->disk_writeback != 0;
+    int      pick = -1;
+    for (int i = 0; i < TC_SLOTS; i++) {
+        const tc_slot_t *sl = &g_tc_slot[i];
+        if (sl->drive < 0 || !sl->dirty)
+            continue;
+        bool due = !wb || now - sl->dirty_at >= WB_MAX_US ||
+                   (idle && now - sl->wr_at >= WB_IDLE_US);
+        if (due && (pick < 0 || sl->dirty_at < g_tc_slot[pick].dirty_at))
+            pick = i;
+    }
+    if (pick < 0)
+        return false;
+    tc_flush_slot(pick);
+    return true;
+}
+
+/* One bounded background step, run only on a poll that served nothing: the
+ * next track ahead of a head, else the next track of a warm-up walk. */
+static void tc_prefetch_step(void)
+{
+    for (int v = 0; v < NDRV; v++) {
+        if (!g_mounted[v] || g_tc_head[v] < 0)
+            continue;
+        for (int k = 1; k <= TC_AHEAD; k++) {
+            int t = g_tc_head[v] + k * g_tc_dir[v];
+            if (t < 0 || (uint32_t)t >= g_ntracks[v] || tc_find(v, (uint32_t)t) >= 0)
+                continue;
+            tc_fill(v, (uint32_t)t, true);
+            return;
+        }
+    }
+
+    for (int v = 0; v < NDRV; v++) {
+        if (!g_mounted[v])
+            continue;
+        while (g_tc_warm[v] < g_ntracks[v]) {
+            uint32_t t = g_tc_warm[v]++;
+            if (tc_find(v, t) >= 0)
+                continue;
+            if (!tc_fill(v, t, false))
+                g_tc_warm[v] = g_ntracks[v];   /* pool full: stop warming */
+            return;
+        }
+    }
+}
+
+/* ---- HDD block cache --------------------------------------------------------
+ * The card (hdl/disk/hdd.sv) keeps an 8-block ring per unit in SDRAM. A READ
+ * that misses it asks for a run from the requested block to the end of its
+ * 8-aligned group (HDD_BLKCNT + 1 blocks), and the following READs of that
+ * group are answered on the card without a request. Runs are served from a
+ * per-unit hdd_cache (8 sets x 4 ways of 512-byte blocks): a miss reads every
+ * missing block of the run with one image read, and when runs arrive in order
+ * the same read loads HC_AHEAD blocks past it, so a sequential copy costs one
+ * image read per three runs. Writes arrive one block at a time; in write-back
+ * mode (settings()->disk_writeback) they are acked once cached and stored by
+ * hdd_flush_step() on the same WB_IDLE_US / WB_MAX_US schedule as floppy
+ * tracks, contiguous dirty blocks coalescing into one image write. The
+ * staging buffer is shared: both units are served from this thread. */
+#define HC_SETS   8u
+#define HC_WAYS   4u
+#define HC_AHEAD  16u
+#define HC_STAGE  (HDD_RING_BLOCKS + HC_AHEAD)
+
+static hc_line_t   g_hc_line[NHDD][HC_SETS * HC_WAYS];
+static uint8_t     g_hc_data[NHDD][HC_SETS * HC_WAYS * SECTOR_BYTES];
+static uint8_t     g_hc_stage[HC_STAGE * SECTOR_BYTES];
+static hdd_cache_t g_hc[NHDD];
+static uint64_t    g_hc_dirty_at[NHDD];   /* first write since the last flush */
+static uint64_t    g_hc_wr_at[NHDD];      /* latest write                     */
+
+/* Serve statistics (see disk_get_hdd_stats); the cache keeps its own. */
+typedef struct {
+    uint32_t reads, writes, blocks;
+    uint64_t us_sum;
+    uint32_t us_max;
+} hdd_stats_t;
+static hdd_stats_t   g_hdd_stats[NHDD];
+static volatile bool g_hdd_stats_reset_req;
+
+/* Sequential-copy benchmark (disk_hdd_bench_begin), run by disk_poll. */
+static volatile int        g_hdd_bench_unit = -1;
+static volatile bool       g_hdd_bench_done;
+static disk_hdd_bench_t    g_hdd_bench;
+
+/* hc_io_fn over unit (int)ctx's image. Writes are synced before returning. */
+static bool hdd_io(void *ctx, uint32_t lba, uint32_t count, void *buf,
+                   bool write)
+{
+    int  u   = (int)(intptr_t)ctx;
+    FIL *f   = &g_hdd_img[u];
+    UINT len = (UINT)(count * SECTOR_BYTES), n = 0;
+    if (f_lseek(f, (FSIZE_t)g_hdd_base[u] + (FSIZE_t)lba * SECTOR_BYTES) != FR_OK)
+        return false;
+    if (!write)
+        return f_read(f, buf, len, &n) == FR_OK && n == len;
+    return f_write(f, buf, len, &n) == FR_OK && n == len && f_sync(f) == FR_OK;
+}
+
+static void hdd_cache_init(void)
+{
+    for (int u = 0; u < NHDD; u++)
+        hc_init(&g_hc[u], g_hc_line[u], g_hc_data[u], HC_SETS, HC_WAYS,
+                g_hc_stage, HC_STAGE, HC_AHEAD);
+}
+
+/* Write-back step: store the dirty blocks of at most one due unit. In
+ * write-through mode every dirty block is due, so switching modes drains
+ * them. Returns true if it stored anything. */
+static bool hdd_flush_step(bool idle)
+{
+    uint64_t now = bflb_mtimer_get_time_us();
+    bool     wb  = settings()->disk_writeback != 0;
+    for (int u = 0; u < NHDD; u++) {
+        if (!g_hdd_mounted[u] || hc_dirty(&g_hc[u]) == 0)
+            continue;
+        bool due = !wb || now - g_hc_dirty_at[u] >= WB_MAX_US ||
+                   (idle && now - g_hc_wr_at[u] >= WB_IDLE_US);
+        if (!due)
+            continue;
+        if (hc_flush(&g_hc[u], HC_STAGE) < 0)
+            osd_log("HDD: UNIT %d WRITE-BACK FAILED", u + 1);
+        if (hc_dirty(&g_hc[u]))
+            g_hc_dirty_at[u] = now;   /* more to go; don't starve the Apple */
+        return true;
+    }
+    return false;
+}
+
+/* Land unit u's dirty blocks and forget its cache (remount / eject). Call
+ * while the image is still open. */
+static void hdd_cache_drop(int u)
+{
+    if (g_hdd_mounted[u] && hc_flush(&g_hc[u], g_hdd_blocks[u]) < 0)
+        osd_log("HDD: UNIT %d WRITE-BACK FAILED", u + 1);
+    hc_detach(&g_hc[u]);
+}
+
+/* The benchmark: read HDD_BENCH_BLOCKS blocks of unit u from block 0 twice, one image
+ * read per block (the pre-cache serve path) and then in the card's 8-block
+ * runs through an emptied cache. Read-only, FPGA untouched; blocks the disk
+ * thread while it runs. The cache's live counters are left as they were. */
+#define HDD_BENCH_BLOCKS 1600u   /* 800 KB */
+static void hdd_bench_run(int u)
+{
+    disk_hdd_bench_t *b = &g_hdd_bench;
+    memset(b, 0, sizeof(*b));
+    if (u < 0 || u >= NHDD || !g_hdd_mounted[u])
+        return;
+    hdd_cache_t *c = &g_hc[u];
+    uint32_t n = g_hdd_blocks[u] < HDD_BENCH_BLOCKS ? g_hdd_blocks[u]
+                                                     : HDD_BENCH_BLOCKS;
+    if (hc_flush(c, g_hdd_blocks[u]) < 0)
+        return;
+
+    uint64_t t0 = bflb_mtimer_get_time_us();
+    for (uint32_t k = 0; k < n; k++) {
+        if (!hdd_io((void *)(intptr_t)u, k, 1, g_blockbuf, false))
+            return;
+    }
+    b->base_us    = (uint32_t)(bflb_mtimer_get_time_us() - t0);
+    b->base_reads = n;
+
+    hc_stats_t live = c->st;
+    hc_attach(c, hdd_io, (void *)(intptr_t)u, g_hdd_blocks[u]);
+    memset(&c->st, 0, sizeof(c->st));
+    t0 = bflb_mtimer_get_time_us();
+    for (uint32_t k = 0; k < n; k += HDD_RING_BLOCKS) {
+        uint32_t run = n - k < HDD_RING_BLOCKS ? n - k : HDD_RING_BLOCKS;
+        hc_read(c, k, run, g_blockbuf);
+    }
+    b->cache_us    = (uint32_t)(bflb_mtimer_get_time_us() - t0);
+    b->cache_reads = c->st.fills;
+    b->hits        = c->st.hits;
+    b->misses      = c->st.misses;
+    b->ok          = c->st.errors == 0;
+    b->blocks      = n;
+    c->st = live;
+}
+
 static void mount_drive(int v)
 {
     g_mounted[v]  = false;
@@ -261,6 +872,9 @@ static void mount_drive(int v)
     g_fmt[v]      = FMT_NONE;
     g_order[v]    = GCR_ORDER_DOS;
     g_base[v]     = 0;
+    g_ntracks[v]  = 0;
+    g_woz_crc_off[v] = false;
+    tc_drop_drive(v);
     fpga_spi_reg_write(VOL_READY(v), 0);
     fpga_spi_reg_write(VOL_MOUNTED(v), 0);
 
@@ -313,14 +927,23 @@ static void mount_drive(int v)
              * .po stay explicit). */
             if (fmt == FMT_DSK && has_ext(name, "dsk"))
                 order = sniff_dsk_order(&g_img[v]);
+            if (fmt == FMT_WOZ) {
+                if (!woz_parse(woz_read, &g_img[v], bytes, &g_woz[v])) {
+                    osd_log("DISK II: D%d %s not a 5.25 WOZ - skip",
+                            v + 1, name + 3);
+                    fmt = FMT_NONE;
+                } else if (g_woz[v].write_protected) {
+                    rw = false;   /* INFO write-protect tab */
+                }
+            }
         }
 
         /* Only floppy-size payloads are Disk II volumes. Anything larger
          * (e.g. an 800K ProDOS .po) is a block device and belongs to the
          * hard-disk path — serving it here would nibblize garbage geometry
          * and hang the Apple's boot. */
-        if ((fmt == FMT_DSK && bytes != DSK_TRACK_BYTES * 35u) ||
-            (fmt == FMT_NIB && bytes != MAX_TRACK_BYTES * 35u)) {
+        if ((fmt == FMT_DSK && bytes != DSK_TRACK_BYTES * DISK_TRACKS) ||
+            (fmt == FMT_NIB && bytes != MAX_TRACK_BYTES * DISK_TRACKS)) {
             osd_log("DISK II: D%d %s not a 5.25 floppy (%lu B) - use HDD slot",
                     v + 1, name + 3, (unsigned long)bytes);
             fmt = FMT_NONE;
@@ -338,12 +961,17 @@ static void mount_drive(int v)
         strncpy(g_imgname[v], name, sizeof(g_imgname[v]) - 1);
         g_imgname[v][sizeof(g_imgname[v]) - 1] = '\0';
         opened = 1;
+        if (rw)
+            jnl_replay(v);   /* finish a write-back flush cut short */
 
         uint32_t blocks = bytes / SECTOR_BYTES;
+        /* Unmapped WOZ tracks serve blank. */
+        g_ntracks[v] = (fmt == FMT_WOZ) ? WOZ_TRACKS : DISK_TRACKS;
         /* .dsk/.do/.po: 35 trk * 16 * 256 = 143360 B; .nib: 35 * 6656 =
          * 232960 B. VOL_SIZE is informational for a floppy. */
         osd_log("DISK II: D%d %s = %lu B (%s%s)", v + 1, g_imgname[v] + 3,
                 (unsigned long)bytes,
+                fmt == FMT_WOZ ? (g_woz[v].version == 1 ? "woz1" : "woz2") :
                 fmt == FMT_NIB ? "nib" :
                 (order == GCR_ORDER_PRODOS ? "po" : "dsk"),
                 base ? " 2mg" : "");
@@ -438,6 +1066,7 @@ static void mount_hdd(int u)
 
         fpga_spi_reg_write(HDD_SIZE_L(u), (uint8_t)blocks);
         fpga_spi_reg_write(HDD_SIZE_H(u), (uint8_t)(blocks >> 8));
+        hc_attach(&g_hc[u], hdd_io, (void *)(intptr_t)u, blocks);
         fpga_spi_reg_write(HDD_CTL(u), HDD_CTL_READY | HDD_CTL_MOUNTED |
                                        (rw ? 0 : HDD_CTL_READONLY));
         g_hdd_mounted[u] = true;
@@ -474,8 +1103,10 @@ static void disk_remount(void)
     osd_console_show();
     osd_log("DISK II: SEARCHING FOR STORAGE...");
 
-    /* Tear down the previous mount. */
+    /* Tear down the previous mount (landing any write-back tracks and blocks
+     * first). */
     for (int v = 0; v < NDRV; v++) {
+        tc_drop_drive(v);
         if (g_mounted[v])
             f_close(&g_img[v]);
         g_mounted[v]  = false;
@@ -484,11 +1115,13 @@ static void disk_remount(void)
         fpga_spi_reg_write(VOL_MOUNTED(v), 0);
     }
     for (int u = 0; u < NHDD; u++) {
+        hdd_cache_drop(u);
         if (g_hdd_mounted[u])
             f_close(&g_hdd_img[u]);
         g_hdd_mounted[u] = false;
         fpga_spi_reg_write(HDD_CTL(u), 0);
     }
+    jnl_close();
     f_mount(NULL, "0:", 0);
 
     bool usb_present = (g_msc_class != NULL);
@@ -557,17 +1190,22 @@ static void disk_remount(void)
 void disk_init(void)
 {
     fpga_sd_init();   /* SD tunnel defaults; mount happens on the first poll */
+    hdd_cache_init();
 }
 
-static void serve_drive(int v)
+/* Returns true if a request was pending (and has been serviced). */
+static bool serve_drive(int v)
 {
     if (!g_mounted[v])
-        return;
+        return false;
 
     uint8_t rd = fpga_spi_reg_read(VOL_RD(v)) & 0x01;
     uint8_t wr = fpga_spi_reg_read(VOL_WR(v)) & 0x01;
     if (!rd && !wr)
-        return;   /* nothing pending */
+        return false;   /* nothing pending */
+
+    uint64_t t0  = bflb_mtimer_get_time_us();   /* request seen -> ack latency */
+    bool     hit = false;
 
     uint32_t lba   = reg_read32(VOL_LBA(v));
     uint32_t nblk  = (uint32_t)fpga_spi_reg_read(VOL_BLKCNT(v)) + 1u;
@@ -592,132 +1230,162 @@ static void serve_drive(int v)
     }
 
     if (wr) {
-        /* Flush a dirty track: SDRAM window -> image file. */
+        /* Flush a dirty track: SDRAM window -> image file (or, in write-back
+         * mode, -> its cache slot, stored later). */
         if (g_writable[v]) {
-            for (uint32_t off = 0; off < nbyte; off += SECTOR_BYTES) {
-                uint32_t chunk = nbyte - off;
-                if (chunk > SECTOR_BYTES)
-                    chunk = SECTOR_BYTES;
-                fpga_spi_xfer_read(FPGA_SPACE_SDRAM, addr + off,
-                                   g_trackbuf + off, (uint16_t)chunk);
-            }
-            if (g_fmt[v] == FMT_DSK) {
-                /* Decode the (possibly partly rewritten) nibble track back to
-                 * file-order sectors. Preload the current on-file track so any
-                 * sector that fails to decode keeps its existing bytes; gate the
-                 * write on the found-mask so a bad decode never corrupts the
-                 * image. */
-                uint32_t track = lba / 13u;
-                FSIZE_t  fpos  = (FSIZE_t)g_base[v] +
-                                 (FSIZE_t)track * DSK_TRACK_BYTES;
-                UINT br = 0;
-                if (f_lseek(&g_img[v], fpos) == FR_OK)
-                    f_read(&g_img[v], g_secbuf, DSK_TRACK_BYTES, &br);
-                if (br < DSK_TRACK_BYTES)
-                    memset(g_secbuf + br, 0, DSK_TRACK_BYTES - br);
-                uint16_t mask = gcr_decode_dos_track(g_trackbuf, MAX_TRACK_BYTES,
-                                                     g_order[v], g_secbuf);
-                if (mask != 0) {
-                    UINT bw = 0;
-                    if (f_lseek(&g_img[v], fpos) == FR_OK) {
-                        f_write(&g_img[v], g_secbuf, DSK_TRACK_BYTES, &bw);
-                        f_sync(&g_img[v]);
-                    }
+            /* One call for the track: fpga_spi chunks it (one DMA frame) */
+            fpga_spi_xfer_read(FPGA_SPACE_SDRAM, addr, g_trackbuf, (uint16_t)nbyte);
+
+            uint32_t track = lba / 13u;
+            bool whole = (lba % 13u) == 0 && nbyte == MAX_TRACK_BYTES &&
+                         track < g_ntracks[v];
+            int i = tc_find(v, track);
+            if (i >= 0 && g_tc_slot[i].dirty && !whole)
+                tc_flush_slot(i);   /* land the pending track under a partial */
+            if (whole && i < 0)
+                i = tc_alloc(v, track, true);
+
+            if (whole && i >= 0 && settings()->disk_writeback) {
+                /* Write-back: ack now; rewrites before the flush coalesce. */
+                tc_slot_t *sl = &g_tc_slot[i];
+                memcpy(g_tc_data[i], g_trackbuf, MAX_TRACK_BYTES);
+                sl->used  = ++g_tc_clock;
+                sl->wr_at = bflb_mtimer_get_time_us();
+                if (sl->dirty) {
+                    g_tc_stats[v].coalesced++;
+                } else {
+                    sl->dirty    = true;
+                    sl->dirty_at = sl->wr_at;
                 }
-                if (mask != 0xFFFF)
-                    osd_log("DISK II: D%d TRK%lu wr partial mask=%04X",
-                            v + 1, (unsigned long)track, (unsigned)mask);
             } else {
-                UINT bw = 0;
-                if (f_lseek(&g_img[v], (FSIZE_t)g_base[v] +
-                                       (FSIZE_t)lba * SECTOR_BYTES) == FR_OK) {
-                    f_write(&g_img[v], g_trackbuf, nbyte, &bw);
-                    f_sync(&g_img[v]);
+                store_track(v, lba, nbyte, g_trackbuf, false);
+
+                /* Keep the cache coherent with what the Apple II now sees:
+                 * a whole-track flush replaces the cached nibbles with the
+                 * window contents; anything narrower drops the stale copy. */
+                if (whole && i >= 0) {
+                    memcpy(g_tc_data[i], g_trackbuf, MAX_TRACK_BYTES);
+                    g_tc_slot[i].used  = ++g_tc_clock;
+                    g_tc_slot[i].dirty = false;
+                } else if (i >= 0) {
+                    g_tc_slot[i].drive = -1;
                 }
             }
+            g_tc_stats[v].writes++;
         }
     } else {
-        /* Load the requested track: image file -> SDRAM window. */
+        /* Load the requested track: image file -> SDRAM window, answered
+         * from the track cache when it holds the track. */
         uint32_t track = lba / 13u;
-        if (g_fmt[v] == FMT_DSK) {
-            /* Read this track's 16*256 file-order sectors and nibblize them
-             * into the 6-and-2 GCR stream the window expects. */
-            UINT br = 0;
-            if (f_lseek(&g_img[v], (FSIZE_t)g_base[v] +
-                                   (FSIZE_t)track * DSK_TRACK_BYTES) == FR_OK)
-                f_read(&g_img[v], g_secbuf, DSK_TRACK_BYTES, &br);
-            if (br < DSK_TRACK_BYTES)
-                memset(g_secbuf + br, 0, DSK_TRACK_BYTES - br);
-            gcr_encode_dos_track(g_secbuf, (uint8_t)track, DSK_DEFAULT_VOLUME,
-                                 g_order[v], g_trackbuf, MAX_TRACK_BYTES);
+        bool whole = (lba % 13u) == 0 && nbyte == MAX_TRACK_BYTES &&
+                     track < g_ntracks[v];
+        const uint8_t *src = g_trackbuf;
+        int i = tc_find(v, track);
+        if (!whole) {
+            if (i >= 0 && g_tc_slot[i].dirty)
+                tc_flush_slot(i);   /* partial read: the image must be current */
+            i = -1;
+        }
+        hit = (i >= 0);
+        if (hit) {
+            src = g_tc_data[i];
+            g_tc_slot[i].used = ++g_tc_clock;
         } else {
-            /* .nib: raw nibble stream, streamed as-is. */
-            UINT br = 0;
-            if (f_lseek(&g_img[v], (FSIZE_t)g_base[v] +
-                                   (FSIZE_t)lba * SECTOR_BYTES) == FR_OK)
-                f_read(&g_img[v], g_trackbuf, nbyte, &br);
-            if (br < nbyte) {
-                /* EOF: a zero-filled track has no sync/prologue nibbles, so RWTS
-                 * finds nothing and DOS I/O-errors at this same track every boot
-                 * — pinpoints a truncated/short .nib. */
-                osd_console_show();
-                osd_log("DISK II: TRK%lu SHORT br=%lu/%lu (EOF) -> zero-fill",
-                        (unsigned long)track,
-                        (unsigned long)br, (unsigned long)nbyte);
-                memset(g_trackbuf + br, 0, nbyte - br);
-            }
+            if (whole)
+                i = tc_alloc(v, track, true);
+            uint8_t *dst = (i >= 0) ? g_tc_data[i] : g_trackbuf;
+            if (!load_track(v, lba, nbyte, dst, true) && i >= 0)
+                g_tc_slot[i].drive = -1;   /* serve it, but don't keep it */
+            src = dst;
         }
 
-        for (uint32_t off = 0; off < nbyte; off += SECTOR_BYTES) {
-            uint32_t chunk = nbyte - off;
-            if (chunk > SECTOR_BYTES)
-                chunk = SECTOR_BYTES;
-            fpga_spi_xfer_write(FPGA_SPACE_SDRAM, addr + off,
-                                g_trackbuf + off, (uint16_t)chunk);
-        }
+        /* Head direction for the read-ahead. */
+        if (g_tc_head[v] >= 0 && (int)track != g_tc_head[v])
+            g_tc_dir[v] = ((int)track > g_tc_head[v]) ? 1 : -1;
+        g_tc_head[v] = (int)track;
+
+        fpga_spi_xfer_write(FPGA_SPACE_SDRAM, addr, src, (uint16_t)nbyte);
     }
 
     fpga_spi_reg_write(VOL_ACK(v), 1);   /* request serviced — release the head */
+
+    if (!wr) {
+        tc_stats_t *st = &g_tc_stats[v];
+        uint32_t us = (uint32_t)(bflb_mtimer_get_time_us() - t0);
+        if (hit) {
+            st->hits++;
+            st->hit_us_sum += us;
+            if (us > st->hit_us_max)
+                st->hit_us_max = us;
+        } else {
+            st->misses++;
+            st->miss_us_sum += us;
+            if (us > st->miss_us_max)
+                st->miss_us_max = us;
+        }
+    }
+    return true;
 }
 
 /* Serve one ProDOS HDD unit: raw 512-byte blocks, LBA 1:1 into the image
- * payload, one block per request through the unit's SDRAM window. */
-static void serve_hdd(int u)
+ * payload, through the block cache and the unit's SDRAM ring. A READ loads the
+ * requested run (HDD_BLKCNT + 1 blocks, never past the ring group) into its
+ * ring slots with one XFER; a WRITE carries one block. Returns true if a
+ * request was pending. */
+static bool serve_hdd(int u)
 {
     if (!g_hdd_mounted[u])
-        return;
+        return false;
 
     uint8_t req = fpga_spi_reg_read(HDD_REQ(u)) & 0x03;
     if (!req)
-        return;   /* nothing pending */
+        return false;   /* nothing pending */
 
+    uint64_t t0  = bflb_mtimer_get_time_us();   /* request seen -> ack latency */
     uint32_t lba = (uint32_t)fpga_spi_reg_read(HDD_LBA_L(u)) |
                    ((uint32_t)fpga_spi_reg_read(HDD_LBA_H(u)) << 8);
-    uint32_t addr = HDD_WINDOW_BASE + (uint32_t)u * HDD_WINDOW_STRIDE;
-    FSIZE_t  fpos = (FSIZE_t)g_hdd_base[u] + (FSIZE_t)lba * SECTOR_BYTES;
+    uint32_t slot = lba % HDD_RING_BLOCKS;
+    uint32_t addr = HDD_WINDOW_BASE + (uint32_t)u * HDD_WINDOW_STRIDE +
+                    slot * SECTOR_BYTES;
+    hdd_stats_t *st = &g_hdd_stats[u];
+    uint32_t nblk = 1;
+    bool ok = true;
 
     if (req & 0x02) {
-        /* write: SDRAM window -> image file */
+        /* write: ring slot -> cache (write-back) or image file */
         if (g_hdd_writable[u] && lba < g_hdd_blocks[u]) {
-            UINT bw = 0;
+            bool wb = settings()->disk_writeback != 0;
             fpga_spi_xfer_read(FPGA_SPACE_SDRAM, addr, g_blockbuf, SECTOR_BYTES);
-            if (f_lseek(&g_hdd_img[u], fpos) == FR_OK) {
-                f_write(&g_hdd_img[u], g_blockbuf, SECTOR_BYTES, &bw);
-                f_sync(&g_hdd_img[u]);
-            }
+            if (wb && hc_dirty(&g_hc[u]) == 0)
+                g_hc_dirty_at[u] = t0;
+            g_hc_wr_at[u] = t0;
+            ok = hc_write(&g_hc[u], lba, 1, g_blockbuf, wb);
         }
+        st->writes++;
     } else {
-        /* read: image file -> SDRAM window */
-        UINT br = 0;
-        if (lba < g_hdd_blocks[u] &&
-            f_lseek(&g_hdd_img[u], fpos) == FR_OK)
-            f_read(&g_hdd_img[u], g_blockbuf, SECTOR_BYTES, &br);
-        if (br < SECTOR_BYTES)
-            memset(g_blockbuf + br, 0, SECTOR_BYTES - br);
-        fpga_spi_xfer_write(FPGA_SPACE_SDRAM, addr, g_blockbuf, SECTOR_BYTES);
+        /* read: cache / image file -> ring slots */
+        nblk = (uint32_t)fpga_spi_reg_read(HDD_BLKCNT(u)) + 1u;
+        if (nblk > HDD_RING_BLOCKS - slot)
+            nblk = HDD_RING_BLOCKS - slot;
+        ok = hc_read(&g_hc[u], lba, nblk, g_blockbuf);
+        if (ok)
+            fpga_spi_xfer_write(FPGA_SPACE_SDRAM, addr, g_blockbuf,
+                                (uint16_t)(nblk * SECTOR_BYTES));
+        st->reads++;
     }
 
-    fpga_spi_reg_write(HDD_ACK(u), 1);   /* request serviced */
+    /* request serviced; a failed one ends in a ProDOS I/O error */
+    if (!ok)
+        osd_log("HDD: UNIT %d %s BLOCK %u FAILED", u + 1,
+                (req & 0x02) ? "WRITE" : "READ", (unsigned)lba);
+    fpga_spi_reg_write(HDD_ACK(u), ok ? HDD_ACK_OK : HDD_ACK_OK | HDD_ACK_ERR);
+
+    uint32_t us = (uint32_t)(bflb_mtimer_get_time_us() - t0);
+    st->blocks += nblk;
+    st->us_sum += us;
+    if (us > st->us_max)
+        st->us_max = us;
+    return true;
 }
 
 
@@ -999,10 +1667,32 @@ void disk_poll(void)
         g_list_done = true;
     }
 
+    if (g_tc_stats_reset_req) {
+        g_tc_stats_reset_req = false;
+        memset(g_tc_stats, 0, sizeof(g_tc_stats));
+    }
+    if (g_hdd_stats_reset_req) {
+        g_hdd_stats_reset_req = false;
+        memset(g_hdd_stats, 0, sizeof(g_hdd_stats));
+        for (int u = 0; u < NHDD; u++)
+            memset(&g_hc[u].st, 0, sizeof(g_hc[u].st));
+    }
+    if (g_hdd_bench_unit >= 0) {
+        hdd_bench_run(g_hdd_bench_unit);
+        g_hdd_bench_unit = -1;
+        g_hdd_bench_done = true;
+    }
+
+    bool busy = false;
     for (int v = 0; v < NDRV; v++)
-        serve_drive(v);
+        busy |= serve_drive(v);
     for (int u = 0; u < NHDD; u++)
-        serve_hdd(u);
+        busy |= serve_hdd(u);
+
+    /* Background work, one track (or one HDD flush) at most: a due
+     * write-back flush, else (on an idle poll) read-ahead. */
+    if (!tc_flush_step(!busy) && !hdd_flush_step(!busy) && !busy)
+        tc_prefetch_step();
 
     /* Firmware self-update: staged one chunk per poll (FatFS + flash both
      * belong to this thread); the commit phase never returns. */
@@ -1089,6 +1779,7 @@ void disk_get_floppy_info(int v, disk_info_t *out)
     if (g_mounted[v])
         snprintf(out->detail, sizeof(out->detail), "%s %s",
                  g_fmt[v] == FMT_NIB ? "NIB" :
+                 g_fmt[v] == FMT_WOZ ? "WOZ" :
                  (g_order[v] == GCR_ORDER_PRODOS ? "PO" : "DSK"),
                  g_writable[v] ? "RW" : "RO");
 }
@@ -1111,6 +1802,89 @@ void disk_get_hdd_info(int u, disk_info_t *out)
                  g_hdd_writable[u] ? "RW" : "RO");
 }
 
+void disk_get_track_stats(int v, disk_track_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (v < 0 || v >= NDRV)
+        return;
+    const tc_stats_t *st = &g_tc_stats[v];
+    out->hits        = st->hits;
+    out->misses      = st->misses;
+    out->prefetches  = st->prefetches;
+    out->writes      = st->writes;
+    out->hit_us_avg  = st->hits ? (uint32_t)(st->hit_us_sum / st->hits) : 0;
+    out->hit_us_max  = st->hit_us_max;
+    out->miss_us_avg = st->misses ? (uint32_t)(st->miss_us_sum / st->misses) : 0;
+    out->miss_us_max = st->miss_us_max;
+    out->coalesced    = st->coalesced;
+    out->flushes      = st->flushes;
+    out->flush_us_avg = st->flushes ? (uint32_t)(st->flush_us_sum / st->flushes) : 0;
+    out->flush_us_max = st->flush_us_max;
+    for (int i = 0; i < TC_SLOTS; i++) {
+        if (g_tc_slot[i].drive != v)
+            continue;
+        out->cached++;
+        if (g_tc_slot[i].dirty)
+            out->dirty++;
+    }
+    out->slots       = TC_SLOTS;
+}
+
+void disk_reset_track_stats(void)
+{
+    g_tc_stats_reset_req = true;   /* cleared by the next disk_poll */
+}
+
+void disk_get_hdd_stats(int u, disk_hdd_stats_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (u < 0 || u >= NHDD)
+        return;
+    const hdd_stats_t *st = &g_hdd_stats[u];
+    const hc_stats_t  *cs = &g_hc[u].st;
+    uint32_t reqs = st->reads + st->writes;
+    out->reads      = st->reads;
+    out->writes     = st->writes;
+    out->blocks     = st->blocks;
+    out->us_avg     = reqs ? (uint32_t)(st->us_sum / reqs) : 0;
+    out->us_max     = st->us_max;
+    out->hits       = cs->hits;
+    out->misses     = cs->misses;
+    out->fills      = cs->fills;
+    out->ahead      = cs->ahead;
+    out->ahead_used = cs->ahead_used;
+    out->stores     = cs->stores;
+    out->stored     = cs->stored;
+    out->errors     = cs->errors;
+    out->cached     = (uint16_t)hc_cached(&g_hc[u]);
+    out->dirty      = (uint16_t)hc_dirty(&g_hc[u]);
+    out->lines      = HC_SETS * HC_WAYS;
+}
+
+void disk_reset_hdd_stats(void)
+{
+    g_hdd_stats_reset_req = true;   /* cleared by the next disk_poll */
+}
+
+void disk_hdd_bench_begin(int u)
+{
+    g_hdd_bench_done = false;
+    if (u < 0 || u >= NHDD) {
+        memset(&g_hdd_bench, 0, sizeof(g_hdd_bench));
+        g_hdd_bench_done = true;
+        return;
+    }
+    g_hdd_bench_unit = u;
+}
+
+bool disk_hdd_bench_poll(disk_hdd_bench_t *out)
+{
+    if (!g_hdd_bench_done)
+        return false;
+    *out = g_hdd_bench;
+    return true;
+}
+
 bool disk_backend_is_usb(void)
 {
     return g_msc_class != NULL;   /* mirrors the active-backend choice */
@@ -50,6 +50,7 @@ bool g_slots_applied_early = false;
 #include "menu.h"
 #include "telnetd.h"
 #include "sscbridge.h"
+#include "bustrace.h"
 #include "ftpd.h"           /* gamepad menu system */
 
 struct netif;
@@ -1191,6 +1192,7 @@ int main(void)
     bool ready = fpga_spi_wait_ready(2000);
     dbg_stage(STG_FPGA_READY);
     if (ready) dbg_set(F_FPGA_READY);
+    if (ready) fpga_spi_crc_init();   /* XFER CRC + retry, if the bitstream has it */
     bt_mark(BT_FPGA_READY);   /* config + SDRAM ready: FPGA-facing work can begin */
 
     /* Assert bus-ready NOW, as early as possible: this lets apple_bus run
@@ -1272,6 +1274,9 @@ int main(void)
     /* FTP server for the storage volume (port 21). */
     ftpd_init();
 
+    /* Raw bus-event capture stream (port 6502). */
+    bustrace_init();
+
     dbg_stage(STG_SCHED);
     dbg_set(F_THREAD_UP);
 
@@ -499,7 +499,7 @@ static void picker_open(char *target, const char *const *exts,
 }
 
 /* ======================= SCREEN: DISK IMAGES ============================== */
-static const char *const k_floppy_exts[] = { "dsk", "do", "po", "2mg", "nib", NULL };
+static const char *const k_floppy_exts[] = { "dsk", "do", "po", "2mg", "nib", "woz", NULL };
 static const char *const k_hdd_exts[]    = { "hdv", "po", "2mg", NULL };
 
 static void disks_pick(int id)
@@ -574,6 +574,14 @@ static const char *boot_pref_name(uint8_t p)
     }
 }
 
+static void storage_wb_change(int id, int dir)
+{
+    (void)id; (void)dir;
+    settings()->disk_writeback = !settings()->disk_writeback;
+    save_settings_status();
+    screen_refresh();
+}
+
 static void storage_build(void)
 {
     menu_item_t *m = mi_add(MI_CHOICE, "STORAGE SOURCE",
@@ -581,6 +589,9 @@ static void storage_build(void)
     m->on_change = storage_change;
     mi_add(MI_INFO, "ACTIVE BACKEND",
            disk_backend_is_usb() ? "USB" : "SD CARD");
+    m = mi_add(MI_TOGGLE, "FLOPPY WRITES",
+               settings()->disk_writeback ? "BACK" : "THROUGH");
+    m->on_change = storage_wb_change;
     mi_add(MI_INFO, "", "");
     m = mi_add(MI_ACTION, "RESCAN / REMOUNT ALL", "");
     m->action = disks_rescan;
@@ -5,6 +5,7 @@
 #include <string.h>
 
 #include "bflb_flash.h"
+#include "crc32.h"
 #include "settings.h"
 
 #define SETTINGS_SECTOR_BYTES 4096u
@@ -21,22 +22,9 @@ static uint32_t      s_flash_size;
 static const char *s_load_why = "?";     /* OK/RD/MAG/SZ/VER/CRC */
 static char        s_save_why[12] = "-"; /* OK / E<rc>@ER|WR|RB|VF */
 
-/* CRC-32 (IEEE, reflected), bitwise — tiny and fast enough for 128 bytes. */
-static uint32_t crc32_calc(const uint8_t *p, uint32_t n)
-{
-    uint32_t crc = 0xFFFFFFFFu;
-    while (n--) {
-        crc ^= *p++;
-        for (int i = 0; i < 8; i++)
-            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
-    }
-    return ~crc;
-}
-
 static uint32_t blob_crc(const a2_settings_t *c)
 {
-    return crc32_calc((const uint8_t *)c,
-                      (uint32_t)((const uint8_t *)&c->crc - (const uint8_t *)c));
+    return crc32_calc(c, (size_t)((const uint8_t *)&c->crc - (const uint8_t *)c));
 }
 
 void settings_reset_defaults(void)
@@ -65,7 +65,12 @@ typedef struct {
      * D1/D2, bits 4-5 = HDD unit 1/2. (Old blobs load as 0 = all mounted.) */
     uint8_t  eject_mask;
 
-    uint8_t  reserved[13];               /* future fields (shrink as used) */
+    /* Floppy write mode: 0 = write-through (store before the ack), 1 =
+     * write-back (ack from RAM, journaled background flush — disk.c).
+     * (Old blobs load as 0 = write-through.) */
+    uint8_t  disk_writeback;
+
+    uint8_t  reserved[12];               /* future fields (shrink as used) */
 
     uint32_t crc;                        /* CRC-32 of everything above */
 } a2_settings_t;
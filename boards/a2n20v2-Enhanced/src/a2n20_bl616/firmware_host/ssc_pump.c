@@ -0,0 +1,267 @@
+/*
+ * ssc_pump — data-mode engine of the SSC modem bridge. See ssc_pump.h.
+ */
+#include <string.h>
+
+#include "lwip/sockets.h"
+
+#include "ssc_pump.h"
+
+/* ---- byte rings ---------------------------------------------------------- */
+
+uint32_t ssc_ring_write(ssc_ring_t *r, const uint8_t *p, uint32_t n)
+{
+    uint32_t wr = r->wr;
+    uint32_t room = r->mask + 1 - (wr - __atomic_load_n(&r->rd, __ATOMIC_ACQUIRE));
+    if (n > room)
+        n = room;
+    uint32_t o = wr & r->mask;
+    uint32_t first = r->mask + 1 - o;           /* bytes before the wrap */
+    if (first > n)
+        first = n;
+    memcpy(r->buf + o, p, first);
+    memcpy(r->buf, p + first, n - first);
+    __atomic_store_n(&r->wr, wr + n, __ATOMIC_RELEASE);
+    return n;
+}
+
+uint32_t ssc_ring_read(ssc_ring_t *r, uint8_t *p, uint32_t n)
+{
+    uint32_t rd = r->rd;
+    uint32_t used = __atomic_load_n(&r->wr, __ATOMIC_ACQUIRE) - rd;
+    if (n > used)
+        n = used;
+    uint32_t o = rd & r->mask;
+    uint32_t first = r->mask + 1 - o;
+    if (first > n)
+        first = n;
+    memcpy(p, r->buf + o, first);
+    memcpy(p + first, r->buf, n - first);
+    __atomic_store_n(&r->rd, rd + n, __ATOMIC_RELEASE);
+    return n;
+}
+
+/* ---- pacing -------------------------------------------------------------- */
+
+/* Idle time that ends a burst: SSC_IDLE_CHARS character times (10 bits per
+ * character on an 8N1 wire), not below the task's timer resolution. */
+static uint32_t idle_us(const ssc_pump_t *p)
+{
+    uint32_t us = SSC_IDLE_CHARS * (10000000u / p->baud);
+    if (us < SSC_HOLD_MIN_US)
+        us = SSC_HOLD_MIN_US;
+    if (us > SSC_HOLD_MAX_US)
+        us = SSC_HOLD_MAX_US;
+    return us;
+}
+
+/* Bytes the wire drains in SSC_IN_AHEAD_US: the most inbound data allowed
+ * to sit in the TX ring. */
+static uint32_t in_limit(const ssc_pump_t *p)
+{
+    uint32_t n = (uint32_t)((uint64_t)p->baud / 10 * SSC_IN_AHEAD_US / 1000000u);
+    if (n < 16)
+        n = 16;
+    if (n > p->tx->mask + 1)
+        n = p->tx->mask + 1;
+    return n;
+}
+
+void ssc_pump_init(ssc_pump_t *p, ssc_ring_t *tx, uint32_t baud, uint64_t now_us)
+{
+    memset(p, 0, sizeof(*p));
+    p->fd = -1;
+    p->tx = tx;
+    p->baud = baud ? baud : 115200;
+    p->t_reset = now_us;
+}
+
+void ssc_pump_set_baud(ssc_pump_t *p, uint32_t baud)
+{
+    if (baud)
+        p->baud = baud;
+}
+
+void ssc_pump_attach(ssc_pump_t *p, int fd, bool telnet)
+{
+    p->fd = fd;
+    p->telnet = telnet;
+    p->out_n = 0;
+    p->iac_st = 0;
+    p->mark_set = false;
+}
+
+void ssc_pump_detach(ssc_pump_t *p)
+{
+    p->fd = -1;
+    p->out_n = 0;
+}
+
+/* ---- Apple II -> TCP ----------------------------------------------------- */
+
+bool ssc_pump_flush(ssc_pump_t *p, uint64_t now_us)
+{
+    if (!p->out_n)
+        return true;
+    uint32_t n = p->out_n;
+    p->out_n = 0;
+    if (p->fd < 0)
+        return false;
+    if (lwip_send(p->fd, p->out, (int)n, 0) != (int)n)
+        return false;
+
+    uint32_t lat = (uint32_t)(now_us - p->out_first);
+    p->st.out_bytes += n;
+    p->st.out_sends++;
+    p->out_lat_sum += lat;
+    if (lat > p->st.out_lat_us_max)
+        p->st.out_lat_us_max = lat;
+    return true;
+}
+
+static bool out_byte(ssc_pump_t *p, uint8_t c, uint64_t now_us)
+{
+    if (p->out_n == SSC_OUT_MAX && !ssc_pump_flush(p, now_us))
+        return false;
+    if (!p->out_n)
+        p->out_first = now_us;
+    p->out[p->out_n++] = c;
+    return true;
+}
+
+bool ssc_pump_out(ssc_pump_t *p, const uint8_t *data, uint32_t n, uint64_t now_us)
+{
+    if (p->fd < 0)
+        return false;
+    for (uint32_t i = 0; i < n; i++) {
+        if (!out_byte(p, data[i], now_us))
+            return false;
+        if (p->telnet && data[i] == 0xFF && !out_byte(p, 0xFF, now_us))
+            return false;
+    }
+    if (n)
+        p->out_last = now_us;
+    return true;
+}
+
+uint32_t ssc_pump_wait_us(const ssc_pump_t *p, uint64_t now_us)
+{
+    if (!p->out_n)
+        return UINT32_MAX;
+    uint64_t due = p->out_last + idle_us(p);
+    if (due > p->out_first + SSC_HOLD_MAX_US)
+        due = p->out_first + SSC_HOLD_MAX_US;
+    return due > now_us ? (uint32_t)(due - now_us) : 0;
+}
+
+uint32_t ssc_pump_in_wait_us(const ssc_pump_t *p, bool online)
+{
+    if (!online)
+        return 0;
+    uint32_t used = ssc_ring_used(p->tx), lim = in_limit(p);
+    if (used < lim)
+        return 0;
+    return (used - lim + 1) * (10000000u / p->baud);
+}
+
+/* ---- TCP -> Apple II ----------------------------------------------------- */
+
+/* Minimal telnet: refuse negotiations (DO->WONT, WILL->DONT), unescape
+ * IAC IAC, drop other commands. Output never exceeds the input. */
+static uint32_t telnet_in(ssc_pump_t *p, uint8_t *buf, uint32_t n)
+{
+    uint32_t o = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        uint8_t c = buf[i];
+        if (p->iac_st == 0) {
+            if (c == 0xFF)
+                p->iac_st = 1;
+            else
+                buf[o++] = c;
+        } else if (p->iac_st == 1) {
+            if (c == 0xFF) {
+                buf[o++] = c;                   /* escaped 0xFF */
+                p->iac_st = 0;
+            } else if (c >= 251 && c <= 254) {
+                p->iac_st = (int)c;             /* verb, await option */
+            } else {
+                p->iac_st = 0;                  /* other command: drop */
+            }
+        } else {
+            uint8_t verb = (p->iac_st == 253) ? 252 :
+                           (p->iac_st == 251) ? 254 : 0;
+            if (verb) {
+                uint8_t rsp[3] = { 0xFF, verb, c };
+                lwip_send(p->fd, rsp, 3, 0);
+            }
+            p->iac_st = 0;
+        }
+    }
+    return o;
+}
+
+bool ssc_pump_poll(ssc_pump_t *p, bool online, uint64_t now_us)
+{
+    if (p->fd < 0)
+        return false;
+
+    if (p->out_n && ssc_pump_wait_us(p, now_us) == 0 && !ssc_pump_flush(p, now_us))
+        return false;
+
+    /* Inbound latency sample: the marked byte has left the TX ring. */
+    if (p->mark_set &&
+        (int32_t)(__atomic_load_n(&p->tx->rd, __ATOMIC_ACQUIRE) - p->mark_pos) >= 0) {
+        uint32_t lat = (uint32_t)(now_us - p->mark_t);
+        p->mark_set = false;
+        p->in_lat_sum += lat;
+        p->in_lat_n++;
+        if (lat > p->st.in_lat_us_max)
+            p->st.in_lat_us_max = lat;
+    }
+
+    uint8_t buf[SSC_OUT_MAX];
+    uint32_t want = sizeof(buf);
+    if (online) {
+        uint32_t used = ssc_ring_used(p->tx), lim = in_limit(p);
+        if (used >= lim)
+            return true;                        /* wire busy: let TCP hold it */
+        if (want > lim - used)
+            want = lim - used;
+    }
+
+    int r = lwip_recv(p->fd, buf, (int)want, MSG_DONTWAIT);
+    if (r == 0 || (r < 0 && errno != EWOULDBLOCK && errno != EAGAIN))
+        return false;
+    if (r < 0 || !online)
+        return true;
+
+    uint32_t n = p->telnet ? telnet_in(p, buf, (uint32_t)r) : (uint32_t)r;
+    n = ssc_ring_write(p->tx, buf, n);
+    p->st.in_bytes += n;
+    p->st.in_recvs++;
+    if (n && !p->mark_set) {
+        p->mark_set = true;
+        p->mark_pos = p->tx->wr;
+        p->mark_t = now_us;
+    }
+    return true;
+}
+
+/* ---- counters ------------------------------------------------------------ */
+
+void ssc_pump_stats(const ssc_pump_t *p, uint64_t now_us, ssc_stats_t *out)
+{
+    *out = p->st;
+    out->out_lat_us_avg = p->st.out_sends ?
+        (uint32_t)(p->out_lat_sum / p->st.out_sends) : 0;
+    out->in_lat_us_avg = p->in_lat_n ? (uint32_t)(p->in_lat_sum / p->in_lat_n) : 0;
+    out->elapsed_ms = (uint32_t)((now_us - p->t_reset) / 1000u);
+}
+
+void ssc_pump_stats_reset(ssc_pump_t *p, uint64_t now_us)
+{
+    memset(&p->st, 0, sizeof(p->st));
+    p->out_lat_sum = p->in_lat_sum = 0;
+    p->in_lat_n = 0;
+    p->t_reset = now_us;
+}
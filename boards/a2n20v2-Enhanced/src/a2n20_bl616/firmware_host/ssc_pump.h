@@ -0,0 +1,151 @@
+/*
+ * ssc_pump — data-mode engine of the SSC modem bridge (sscbridge.c).
+ *
+ * Moves bytes between the 6551's serial wire and the dialled TCP socket:
+ *
+ *   - UART side: two lock-free SPSC byte rings shared with the UART ISR
+ *     (RX: ISR -> task, TX: task -> ISR), so neither direction ever waits
+ *     on the FIFO a byte at a time.
+ *   - Apple II -> TCP: bytes are coalesced and handed to lwIP as one send
+ *     once the line has been idle for SSC_IDLE_CHARS character times at the
+ *     current baud rate, the oldest byte has waited SSC_HOLD_MAX_US, or
+ *     SSC_OUT_MAX bytes are held. Typing still goes out per keystroke; a
+ *     paste or upload becomes a few segments instead of one per byte.
+ *   - TCP -> Apple II: data is received in bulk, but only as much as the
+ *     wire drains in SSC_IN_AHEAD_US at the current baud rate is let into
+ *     the TX ring. TCP flow control then paces the peer at the emulated
+ *     rate, and ATH/+++ replies never queue behind seconds of text.
+ *   - Telnet (peer port 23): negotiations are refused, IAC IAC unescapes,
+ *     outgoing 0xFF is doubled.
+ *
+ * No BL616 or FreeRTOS dependencies: time is passed in and only lwip_send/
+ * lwip_recv are called, so the host test builds this file against BSD
+ * sockets.
+ */
+#ifndef _SSC_PUMP_H
+#define _SSC_PUMP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SSC_OUT_MAX      512        /* coalesced bytes per send (< TCP MSS) */
+#define SSC_IDLE_CHARS   2          /* line idle this long -> flush          */
+#define SSC_HOLD_MIN_US  1000       /* floor on the idle wait (timer tick)   */
+#define SSC_HOLD_MAX_US  20000      /* oldest held byte never waits longer   */
+#define SSC_IN_AHEAD_US  100000     /* inbound data queued ahead of the wire */
+
+/* ---- SPSC byte ring (size a power of two; indices free-running) ---- */
+typedef struct {
+    uint8_t  *buf;
+    uint32_t  mask;                 /* size - 1 */
+    uint32_t  wr;                   /* written by the producer only */
+    uint32_t  rd;                   /* written by the consumer only */
+} ssc_ring_t;
+
+static inline uint32_t ssc_ring_used(const ssc_ring_t *r)
+{
+    return __atomic_load_n(&r->wr, __ATOMIC_ACQUIRE) -
+           __atomic_load_n(&r->rd, __ATOMIC_ACQUIRE);
+}
+
+static inline uint32_t ssc_ring_room(const ssc_ring_t *r)
+{
+    return r->mask + 1 - ssc_ring_used(r);
+}
+
+/* Single-byte forms for the ISR. */
+static inline bool ssc_ring_put1(ssc_ring_t *r, uint8_t c)
+{
+    uint32_t wr = r->wr;
+    if (wr - __atomic_load_n(&r->rd, __ATOMIC_ACQUIRE) > r->mask)
+        return false;
+    r->buf[wr & r->mask] = c;
+    __atomic_store_n(&r->wr, wr + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+static inline int ssc_ring_get1(ssc_ring_t *r)
+{
+    uint32_t rd = r->rd;
+    if (rd == __atomic_load_n(&r->wr, __ATOMIC_ACQUIRE))
+        return -1;
+    uint8_t c = r->buf[rd & r->mask];
+    __atomic_store_n(&r->rd, rd + 1, __ATOMIC_RELEASE);
+    return c;
+}
+
+/* Bulk forms: copy as much as fits / is there, return the count. */
+uint32_t ssc_ring_write(ssc_ring_t *r, const uint8_t *p, uint32_t n);
+uint32_t ssc_ring_read(ssc_ring_t *r, uint8_t *p, uint32_t n);
+
+/* ---- counters ---- */
+typedef struct {
+    uint32_t out_bytes;             /* Apple II -> TCP payload            */
+    uint32_t out_sends;             /* lwip_send calls (segments)         */
+    uint32_t in_bytes;              /* TCP -> Apple II, after telnet      */
+    uint32_t in_recvs;              /* lwip_recv calls that returned data */
+    uint32_t out_lat_us_avg;        /* first held byte -> sent            */
+    uint32_t out_lat_us_max;
+    uint32_t in_lat_us_avg;         /* received -> drained onto the wire  */
+    uint32_t in_lat_us_max;         /*   (sampled, one mark in flight)    */
+    uint32_t rx_overruns;           /* UART RX ring full (filled in by
+                                     * sscbridge; bytes lost in the ISR) */
+    uint32_t elapsed_ms;            /* since the last reset               */
+} ssc_stats_t;
+
+typedef struct {
+    int         fd;                 /* connected socket, -1 = none */
+    bool        telnet;
+    uint32_t    baud;
+    ssc_ring_t *tx;                 /* UART TX ring (towards the Apple II) */
+
+    uint8_t     out[SSC_OUT_MAX];   /* held Apple II -> TCP bytes */
+    uint32_t    out_n;
+    uint64_t    out_first, out_last;
+
+    int         iac_st;             /* inbound telnet parser */
+
+    bool        mark_set;           /* inbound latency sample in flight */
+    uint32_t    mark_pos;
+    uint64_t    mark_t;
+
+    ssc_stats_t st;
+    uint64_t    out_lat_sum, in_lat_sum;
+    uint32_t    in_lat_n;
+    uint64_t    t_reset;
+} ssc_pump_t;
+
+void ssc_pump_init(ssc_pump_t *p, ssc_ring_t *tx, uint32_t baud, uint64_t now_us);
+void ssc_pump_set_baud(ssc_pump_t *p, uint32_t baud);
+
+/* Start a session on a connected socket (telnet handling when port 23). */
+void ssc_pump_attach(ssc_pump_t *p, int fd, bool telnet);
+void ssc_pump_detach(ssc_pump_t *p);
+
+/* Queue Apple II bytes for the peer; sends at once when the buffer fills.
+ * Returns false if the socket failed. */
+bool ssc_pump_out(ssc_pump_t *p, const uint8_t *data, uint32_t n, uint64_t now_us);
+
+/* Send whatever is held now (before +++ drops to command mode). */
+bool ssc_pump_flush(ssc_pump_t *p, uint64_t now_us);
+
+/* Flush held bytes that are due, then move received data into the TX ring
+ * up to the pacing limit (discarding it when !online, as a modem in command
+ * mode does). Returns false once the peer has closed or the socket failed. */
+bool ssc_pump_poll(ssc_pump_t *p, bool online, uint64_t now_us);
+
+/* Microseconds until held bytes are due (UINT32_MAX if none): the task
+ * sleeps no longer than this. */
+uint32_t ssc_pump_wait_us(const ssc_pump_t *p, uint64_t now_us);
+
+/* Microseconds until ssc_pump_poll() will take received data again: 0 when
+ * it would now (always in command mode, where it is discarded), else the
+ * wire time for the TX ring to drain below the pacing limit. While this is
+ * non-zero the socket stays readable, so the task waits on the clock rather
+ * than on the socket. */
+uint32_t ssc_pump_in_wait_us(const ssc_pump_t *p, bool online);
+
+void ssc_pump_stats(const ssc_pump_t *p, uint64_t now_us, ssc_stats_t *out);
+void ssc_pump_stats_reset(ssc_pump_t *p, uint64_t now_us);
+
+#endif
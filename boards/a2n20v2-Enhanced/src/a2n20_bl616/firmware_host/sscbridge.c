@@ -19,10 +19,19 @@
  * unescapes, and outgoing 0xFF bytes are doubled.
  *
  * Baud tracking: the 6551's control register (baud select in [3:0]) is
- * exported by the gateware at SPI reg 0x2F; the bridge polls it and
- * reprograms UART1 whenever Apple II software changes the rate. Cores
- * without the register read 0x00, which maps to the 6551's 115200 code —
- * also the bridge default.
+ * exported by the gateware at SPI reg 0x2F; in command mode the bridge polls
+ * it and reprograms UART1 whenever Apple II software changes the rate. Like
+ * a real modem's DTE rate, it is then held for the call: data mode does not
+ * poll. Cores without the register read 0x00, which maps to the 6551's
+ * 115200 code — also the bridge default.
+ *
+ * Data path: UART1 RX and TX are both interrupt driven through SPSC rings,
+ * and the task sleeps on a semaphore the RX interrupt gives. While a call
+ * is up a small watcher task blocks in lwip_select() on the socket and
+ * gives the same semaphore when data arrives, so the bridge otherwise wakes
+ * only for a coalescing deadline or, when inbound pacing holds the peer
+ * off, for the TX ring to drain. Coalescing, inbound pacing and telnet
+ * handling live in ssc_pump.c.
  */
 #include <stdbool.h>
 #include <stdint.h>
@@ -33,6 +42,10 @@
 #include "bflb_gpio.h"
 #include "bflb_uart.h"
 #include "bflb_irq.h"
+#include "bflb_mtimer.h"
+
+#include "FreeRTOS.h"
+#include "semphr.h"
 
 #include "lwip/sockets.h"
 #include "lwip/netdb.h"
@@ -42,16 +55,24 @@
 
 #include "fpga_spi.h"
 #include "osd_console.h"
+#include "ssc_pump.h"
 #include "sscbridge.h"
 
 #define REG_SSC_CTL   0x2Fu
+#define CTL_POLL_US   250000u     /* baud register poll, command mode only */
+#define NET_WATCH_US  100000u     /* watcher select timeout (hangup check) */
 
 /* ---- UART1 (SSC wire) ---------------------------------------------------- */
 static struct bflb_device_s *s_uart;
 
-#define RXBUF_SZ 1024
-static volatile uint8_t  s_rx[RXBUF_SZ];
-static volatile uint32_t s_rx_wr, s_rx_rd;
+#define RXBUF_SZ 1024              /* powers of two */
+#define TXBUF_SZ 2048
+static uint8_t    s_rxbuf[RXBUF_SZ], s_txbuf[TXBUF_SZ];
+static ssc_ring_t s_rx = { s_rxbuf, RXBUF_SZ - 1, 0, 0 };   /* ISR -> task */
+static ssc_ring_t s_tx = { s_txbuf, TXBUF_SZ - 1, 0, 0 };   /* task -> ISR */
+static volatile uint32_t s_rx_overruns;
+static SemaphoreHandle_t s_wake;        /* given by the RX interrupt and
+                                         * the socket watcher */
 
 static void uart_isr(int irq, void *arg)
 {
@@ -60,25 +81,50 @@ static void uart_isr(int irq, void *arg)
     if (st & (UART_INTSTS_RX_FIFO | UART_INTSTS_RTO)) {
         while (bflb_uart_rxavailable(s_uart)) {
             uint8_t c = (uint8_t)bflb_uart_getchar(s_uart);
-            if (s_rx_wr - s_rx_rd < RXBUF_SZ)
-                s_rx[s_rx_wr++ % RXBUF_SZ] = c;
+            if (!ssc_ring_put1(&s_rx, c))
+                s_rx_overruns++;
         }
         if (st & UART_INTSTS_RTO)
             bflb_uart_int_clear(s_uart, UART_INTCLR_RTO);
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(s_wake, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+    if (st & UART_INTSTS_TX_FIFO) {
+        /* Refill the FIFO from the TX ring; mask the interrupt once the ring
+         * is empty (uart_tx_kick unmasks it again). */
+        int c = 0;
+        while (bflb_uart_txready(s_uart) && (c = ssc_ring_get1(&s_tx)) >= 0)
+            bflb_uart_putchar(s_uart, c);
+        if (c < 0)
+            bflb_uart_txint_mask(s_uart, true);
     }
 }
 
+/* The ISR only masks TX after finding the ring empty, and it cannot be
+ * preempted by the task, so a write followed by a kick is never stranded. */
+static void uart_tx_kick(void)
+{
+    bflb_uart_txint_mask(s_uart, false);
+}
+
 static int uart_getc(void)
 {
-    if (s_rx_rd == s_rx_wr)
-        return -1;
-    return s_rx[s_rx_rd++ % RXBUF_SZ];
+    return ssc_ring_get1(&s_rx);
 }
 
+/* Queue bytes for the wire. Command-mode output is small; if the ring is
+ * full (data still draining) wait for the interrupt to make room. */
 static void uart_put(const uint8_t *p, int n)
 {
-    for (int i = 0; i < n; i++)
-        bflb_uart_putchar(s_uart, p[i]);
+    while (n > 0) {
+        uint32_t w = ssc_ring_write(&s_tx, p, (uint32_t)n);
+        uart_tx_kick();
+        p += w;
+        n -= (int)w;
+        if (n > 0)
+            usb_osal_msleep(1);
+    }
 }
 
 static void uart_puts(const char *s)
@@ -112,14 +158,77 @@ static void uart_setup(uint32_t baud)
     s_uart = bflb_device_get_by_name("uart1");
     bflb_uart_init(s_uart, &cfg);
     bflb_uart_rxint_mask(s_uart, false);
+    bflb_uart_txint_mask(s_uart, true);     /* until there is something to send */
     bflb_irq_attach(s_uart->irq_num, uart_isr, NULL);
     bflb_irq_enable(s_uart->irq_num);
 }
 
+/* ---- stats (telnet 'u') ---------------------------------------------------- */
+static ssc_pump_t    s_pump;
+static volatile bool s_stats_reset_req;
+
+void sscbridge_get_stats(ssc_stats_t *out)
+{
+    ssc_pump_stats(&s_pump, bflb_mtimer_get_time_us(), out);
+    out->rx_overruns = s_rx_overruns;
+}
+
+void sscbridge_reset_stats(void)
+{
+    s_stats_reset_req = true;   /* applied by the bridge task */
+}
+
+/* ---- socket watcher --------------------------------------------------------
+ * lwip_select() cannot also wait on the RX semaphore, so a separate task
+ * does the select and turns "readable" into a give of s_wake. The bridge
+ * arms it once per wait when the pump would take data; it selects until
+ * something arrives (or the call ends) and then waits to be armed again, so
+ * data the pump is still holding off never spins it. */
+static SemaphoreHandle_t s_watch_arm;
+static volatile int      s_watch_fd = -1;
+static volatile bool     s_watching;     /* in (or entering) select */
+
+static void watch_thread(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        xSemaphoreTake(s_watch_arm, portMAX_DELAY);
+        s_watching = true;
+        int fd = s_watch_fd;
+        while (fd >= 0 && fd == s_watch_fd) {
+            fd_set rfds;
+            FD_ZERO(&rfds);
+            FD_SET(fd, &rfds);
+            struct timeval tv = { .tv_sec = 0, .tv_usec = NET_WATCH_US };
+            if (lwip_select(fd + 1, &rfds, NULL, NULL, &tv) != 0) {
+                xSemaphoreGive(s_wake);     /* data, EOF or error: the pump
+                                             * tells which */
+                break;
+            }
+        }
+        s_watching = false;
+    }
+}
+
+static void watch_arm(int fd)
+{
+    s_watch_fd = fd;
+    xSemaphoreGive(s_watch_arm);
+}
+
+/* Retire the watcher from fd before it is closed: s_watching is raised
+ * before the fd is read, so once it drops the watcher is out of select on
+ * it and will not enter again. */
+static void watch_stop(void)
+{
+    s_watch_fd = -1;
+    while (s_watching)
+        usb_osal_msleep(1);
+}
+
 /* ---- modem state ---------------------------------------------------------- */
 static int  s_sock = -1;
 static bool s_echo = true;
-static bool s_telnet;                 /* peer is port 23: IAC handling on */
 static char s_line[96];
 static int  s_linelen;
 
@@ -133,6 +242,9 @@ static void resp(const char *r)
 static void hangup(void)
 {
     if (s_sock >= 0) {
+        ssc_pump_detach(&s_pump);
+        lwip_shutdown(s_sock, SHUT_RDWR);   /* ends a select in progress */
+        watch_stop();
         lwip_close(s_sock);
         s_sock = -1;
     }
@@ -183,8 +295,11 @@ static void dial(const char *target)
     lwip_freeaddrinfo(ai);
     struct timeval tv2 = { .tv_sec = 0, .tv_usec = 10 * 1000 };
     lwip_setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv2, sizeof(tv2));
+    /* ssc_pump does the coalescing; lwIP's Nagle would only add delay */
+    int one = 1;
+    lwip_setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
     s_sock = fd;
-    s_telnet = (port == 23);
+    ssc_pump_attach(&s_pump, fd, port == 23);   /* telnet: IAC handling */
     osd_log("SSC: CONNECTED %s:%d", host, port);
     resp("CONNECT");
 }
@@ -252,55 +367,84 @@ static bool do_command(char *cmd)
 void sscbridge_thread(void *arg)
 {
     (void)arg;
+    s_wake = xSemaphoreCreateBinary();
+    s_watch_arm = xSemaphoreCreateBinary();
+    usb_osal_thread_create("sscwatch", 1536, CONFIG_USBHOST_PSC_PRIO + 1,
+                           watch_thread, NULL);
     uart_setup(115200);
+    ssc_pump_init(&s_pump, &s_tx, 115200, bflb_mtimer_get_time_us());
     osd_log("SSC: BRIDGE READY (AT COMMANDS)");
 
     bool online = false;              /* transparent data mode */
     int  plus_run = 0;
-    uint32_t last_rx_ms = 0, ctl_poll = 0, now_ms = 0;
+    uint64_t last_rx_us = 0, ctl_poll_us = 0;
     uint8_t last_ctl = 0;
-    int iac_st = 0;
 
     for (;;) {
-        usb_osal_msleep(10);
-        now_ms += 10;
+        /* Sleep until the RX interrupt, received data (the watcher), the
+         * next coalescing deadline, the TX ring draining below the pacing
+         * limit, or the baud poll in command mode. */
+        uint64_t now_us = bflb_mtimer_get_time_us();
+        uint32_t wait_us = ssc_pump_wait_us(&s_pump, now_us);
+        if (!online && wait_us > CTL_POLL_US)
+            wait_us = CTL_POLL_US;
+        if (s_sock >= 0) {
+            uint32_t in_us = ssc_pump_in_wait_us(&s_pump, online);
+            if (in_us == 0)
+                watch_arm(s_sock);
+            else if (in_us < wait_us)
+                wait_us = in_us;
+        }
+        xSemaphoreTake(s_wake, wait_us == UINT32_MAX ? portMAX_DELAY
+                                                     : pdMS_TO_TICKS(wait_us / 1000u + 1));
+        now_us = bflb_mtimer_get_time_us();
+
+        if (s_stats_reset_req) {
+            s_stats_reset_req = false;
+            ssc_pump_stats_reset(&s_pump, now_us);
+            s_rx_overruns = 0;
+        }
 
-        /* Track the 6551's programmed baud (SPI reg 0x2F, new cores). */
-        if (++ctl_poll >= 25) {
-            ctl_poll = 0;
+        /* Track the 6551's programmed baud (SPI reg 0x2F, new cores) while
+         * in command mode; a call keeps the rate it was dialled at. */
+        if (!online && now_us - ctl_poll_us >= CTL_POLL_US) {
+            ctl_poll_us = now_us;
             uint8_t ctl = fpga_spi_reg_read(REG_SSC_CTL);
             if (ctl != last_ctl) {
                 last_ctl = ctl;
-                bflb_uart_deinit(s_uart);
-                uart_setup(k_baud[ctl & 0x0F]);
-                osd_log("SSC: BAUD %lu", (unsigned long)k_baud[ctl & 0x0F]);
+                uint32_t baud = k_baud[ctl & 0x0F];
+                bflb_uart_feature_control(s_uart, UART_CMD_SET_BAUD_RATE, baud);
+                ssc_pump_set_baud(&s_pump, baud);
+                osd_log("SSC: BAUD %lu", (unsigned long)baud);
             }
         }
 
         /* ---- Apple II -> bridge ---- */
+        uint8_t run[64];                  /* data-mode bytes for the pump */
+        int nrun = 0;
         int ch;
         while ((ch = uart_getc()) >= 0) {
             uint8_t c = (uint8_t)ch;
             if (online) {
                 /* +++ escape: 3 plusses framed by ~1 s guards */
-                if (c == '+' && (plus_run > 0 || now_ms - last_rx_ms > 1000))
+                if (c == '+' && (plus_run > 0 || now_us - last_rx_us > 1000000u))
                     plus_run++;
                 else
                     plus_run = 0;
-                last_rx_ms = now_ms;
+                last_rx_us = now_us;
                 if (plus_run == 3) {
                     plus_run = 0;
                     online = false;
+                    ssc_pump_out(&s_pump, run, (uint32_t)nrun, now_us);
+                    ssc_pump_flush(&s_pump, now_us);
+                    nrun = 0;
                     resp("OK");
                     continue;
                 }
-                if (s_sock >= 0) {
-                    if (s_telnet && c == 0xFF) {
-                        uint8_t esc[2] = { 0xFF, 0xFF };
-                        lwip_send(s_sock, esc, 2, 0);
-                    } else {
-                        lwip_send(s_sock, &c, 1, 0);
-                    }
+                run[nrun++] = c;
+                if (nrun == (int)sizeof(run)) {
+                    ssc_pump_out(&s_pump, run, (uint32_t)nrun, now_us);
+                    nrun = 0;
                 }
             } else {
                 /* command mode line editing */
@@ -312,7 +456,7 @@ void sscbridge_thread(void *arg)
                     if (s_line[0]) {
                         if (do_command(s_line)) {
                             online = true;
-                            last_rx_ms = now_ms;
+                            last_rx_us = now_us;
                             plus_run = 0;
                         }
                     }
@@ -324,49 +468,18 @@ void sscbridge_thread(void *arg)
                 }
             }
         }
+        if (nrun)
+            ssc_pump_out(&s_pump, run, (uint32_t)nrun, now_us);
 
-        /* ---- network -> Apple II ---- */
+        /* ---- network <-> Apple II: due flushes, paced inbound ---- */
         if (s_sock >= 0) {
-            uint8_t buf[256];
-            int r = lwip_recv(s_sock, buf, sizeof(buf), MSG_DONTWAIT);
-            if (r == 0 || (r < 0 && errno != EWOULDBLOCK && errno != EAGAIN)) {
+            if (!ssc_pump_poll(&s_pump, online, now_us)) {
                 hangup();
                 online = false;
                 resp("NO CARRIER");
                 osd_log("SSC: DISCONNECTED");
-            } else if (r > 0 && online) {
-                if (!s_telnet) {
-                    uart_put(buf, r);
-                } else {
-                    /* minimal telnet: refuse negotiations, unescape IAC */
-                    for (int i = 0; i < r; i++) {
-                        uint8_t c = buf[i];
-                        if (iac_st == 0) {
-                            if (c == 0xFF)
-                                iac_st = 1;
-                            else
-                                uart_put(&c, 1);
-                        } else if (iac_st == 1) {
-                            if (c == 0xFF) {
-                                uart_put(&c, 1);      /* escaped 0xFF */
-                                iac_st = 0;
-                            } else if (c >= 251 && c <= 254) {
-                                iac_st = (int)c;      /* verb, await opt */
-                            } else {
-                                iac_st = 0;           /* other cmd: drop */
-                            }
-                        } else {
-                            /* refuse: DO->WONT, WILL->DONT */
-                            uint8_t verb = (iac_st == 253) ? 252 :
-                                           (iac_st == 251) ? 254 : 0;
-                            if (verb && s_sock >= 0) {
-                                uint8_t rsp[3] = { 0xFF, verb, c };
-                                lwip_send(s_sock, rsp, 3, 0);
-                            }
-                            iac_st = 0;
-                        }
-                    }
-                }
+            } else if (ssc_ring_used(&s_tx)) {
+                uart_tx_kick();
             }
         }
     }
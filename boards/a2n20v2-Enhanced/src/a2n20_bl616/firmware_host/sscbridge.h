@@ -5,7 +5,13 @@
 #ifndef _SSCBRIDGE_H
 #define _SSCBRIDGE_H
 
+#include "ssc_pump.h"
+
 /* Spawn the bridge task (UART1 <-> AT command engine / TCP). */
 void sscbridge_init(void);
 
+/* Data-mode byte counts, TCP sends and latency (telnet console 'u'). */
+void sscbridge_get_stats(ssc_stats_t *out);
+void sscbridge_reset_stats(void);
+
 #endif
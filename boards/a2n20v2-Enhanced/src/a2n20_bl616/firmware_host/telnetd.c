@@ -33,6 +33,9 @@
 #include "telnetd.h"
 #include "fpga_spi.h"
 #include "boot_timeline.h"   /* 'b' = boot-milestone timeline */
+#include "disk.h"            /* 'i'/'h' = Disk II / HDD cache stats */
+#include "sscbridge.h"       /* 'u' = SSC modem bridge data-path stats */
+#include "bustrace.h"        /* FIFO has one reader: stand aside while streaming */
 
 #define TELNET_PORT     23
 #define TEE_LINES       32
@@ -91,7 +94,16 @@ static void tn_puts(int fd, const char *s)
  * any stale entries, arm a fresh window, freeze it, and print the recent fetch
  * addresses -- so we can see what the 6502 is actually doing when the machine
  * is hung: looping in $F8xx (autostart/monitor), parked at the reset vector,
- * or off in garbage. Snapshot on demand, not a continuous stream. */
+ * or off in garbage. Snapshot on demand, not a continuous stream (that is
+ * port 6502, bustrace.c; while it has a client these commands stand aside). */
+static bool fifo_busy(int fd)
+{
+    if (!bustrace_active())
+        return false;
+    tn_puts(fd, "\r\n-- bus FIFO is streaming to the port 6502 client --\r\n");
+    return true;
+}
+
 static uint16_t fifo_count_rd(void)
 {
     /* reg 0x70: [7]=empty [6]=full. When full the 9-bit count wraps to 0
@@ -258,7 +270,8 @@ static void bus_dump_full(int fd)
  * the FIFO holds and prints it live (addr rw data ctl-hex), so the console
  * acts as a rolling logic-analyzer trace. Sampled, not every-cycle: the FIFO
  * (512 deep) refills as we drain, so bursty CPUs may skip cycles between
- * dumps -- fine for watching where execution sits. */
+ * dumps -- fine for watching where execution sits. For a complete trace,
+ * capture the binary stream on port 6502 instead (bustrace.c). */
 static void scope_dump_batch(int fd)
 {
     static uint8_t buf[64 * 4];
@@ -353,7 +366,7 @@ static void session(int fd)
     static const uint8_t nego[] = { 255, 251, 1, 255, 251, 3, 255, 253, 3 };
     tn_send(fd, nego, sizeof(nego));
     tn_puts(fd, "\r\nA2FPGA a2n20v2-Enhanced remote console\r\n"
-                "keys: c=console m=menu d=snapshot D=full dump s=scope t=trigger o=oneshot b=boot-timeline q=quit\r\n"
+                "keys: c=console m=menu d=snapshot D=full dump s=scope t=trigger o=oneshot b=boot-timeline i=disk-stats (I=reset) h=hdd-stats (H=reset) k=hdd-bench u=ssc-stats (U=reset) q=quit\r\n"
                 "menu: up/down move, right/enter=ok, left/esc/b=back,\r\n"
                 "      y=view, s=select, [ ]=+/-16\r\n\r\n");
 
@@ -408,11 +421,13 @@ static void session(int fd)
             if (esc_st == 0 && ch == 'q')
                 return;
             if (esc_st == 0 && ch == 'd' && !menu_mode) {
-                bus_snapshot(fd);          /* diagnostic bus-address snapshot */
+                if (!fifo_busy(fd))
+                    bus_snapshot(fd);      /* diagnostic bus-address snapshot */
                 continue;
             }
             if (esc_st == 0 && ch == 'D' && !menu_mode) {
-                bus_dump_full(fd);         /* whole buffer, oldest first */
+                if (!fifo_busy(fd))
+                    bus_dump_full(fd);     /* whole buffer, oldest first */
                 continue;
             }
             if (esc_st == 0 && ch == 'b' && !menu_mode) {
@@ -421,7 +436,125 @@ static void session(int fd)
                 tn_puts(fd, tl);
                 continue;
             }
+            if (esc_st == 0 && (ch == 'i' || ch == 'I') && !menu_mode) {
+                /* Disk II track cache: hit/miss + request->ack latency */
+                if (ch == 'I') {
+                    disk_reset_track_stats();
+                    tn_puts(fd, "-- disk stats cleared --\r\n");
+                    continue;
+                }
+                for (int v = 0; v < 2; v++) {
+                    disk_track_stats_t st;
+                    char line[224];
+                    disk_get_track_stats(v, &st);
+                    uint32_t reqs = st.hits + st.misses;
+                    snprintf(line, sizeof(line),
+                             "D%d: %lu hit / %lu miss (%lu%%) prefetch=%lu wr=%lu cached=%u/%u\r\n"
+                             "    hit %lu us avg / %lu max  miss %lu us avg / %lu max\r\n"
+                             "    dirty=%u coalesced=%lu flush %lu x %lu us avg / %lu max\r\n",
+                             v + 1, (unsigned long)st.hits, (unsigned long)st.misses,
+                             (unsigned long)(reqs ? 100u * st.hits / reqs : 0),
+                             (unsigned long)st.prefetches, (unsigned long)st.writes,
+                             (unsigned)st.cached, (unsigned)st.slots,
+                             (unsigned long)st.hit_us_avg, (unsigned long)st.hit_us_max,
+                             (unsigned long)st.miss_us_avg, (unsigned long)st.miss_us_max,
+                             (unsigned)st.dirty, (unsigned long)st.coalesced,
+                             (unsigned long)st.flushes, (unsigned long)st.flush_us_avg,
+                             (unsigned long)st.flush_us_max);
+                    tn_puts(fd, line);
+                }
+                continue;
+            }
+            if (esc_st == 0 && (ch == 'h' || ch == 'H') && !menu_mode) {
+                /* ProDOS HDD: card runs + block cache */
+                if (ch == 'H') {
+                    disk_reset_hdd_stats();
+                    tn_puts(fd, "-- hdd stats cleared --\r\n");
+                    continue;
+                }
+                for (int u = 0; u < 2; u++) {
+                    disk_hdd_stats_t st;
+                    char line[256];
+                    disk_get_hdd_stats(u, &st);
+                    uint32_t blks = st.hits + st.misses;
+                    snprintf(line, sizeof(line),
+                             "HDD%d: %lu rd (%lu blk) %lu wr  %lu us avg / %lu max\r\n"
+                             "    %lu hit / %lu miss (%lu%%) in %lu image reads  ahead=%lu used=%lu\r\n"
+                             "    cached=%u/%u dirty=%u stores=%lu (%lu blk) err=%lu\r\n",
+                             u + 1, (unsigned long)st.reads, (unsigned long)st.blocks,
+                             (unsigned long)st.writes,
+                             (unsigned long)st.us_avg, (unsigned long)st.us_max,
+                             (unsigned long)st.hits, (unsigned long)st.misses,
+                             (unsigned long)(blks ? 100u * st.hits / blks : 0),
+                             (unsigned long)st.fills, (unsigned long)st.ahead,
+                             (unsigned long)st.ahead_used,
+                             (unsigned)st.cached, (unsigned)st.lines, (unsigned)st.dirty,
+                             (unsigned long)st.stores, (unsigned long)st.stored,
+                             (unsigned long)st.errors);
+                    tn_puts(fd, line);
+                }
+                continue;
+            }
+            if (esc_st == 0 && ch == 'k' && !menu_mode) {
+                /* HDD1 sequential 800 KB read: per-block vs cached runs */
+                disk_hdd_bench_t b;
+                tn_puts(fd, "-- hdd bench: unit 1, 800 KB sequential --\r\n");
+                disk_hdd_bench_begin(0);
+                while (!disk_hdd_bench_poll(&b))
+                    usb_osal_msleep(50);
+                char line[256];
+                if (!b.ok) {
+                    tn_puts(fd, "hdd bench: unit 1 not mounted or read failed\r\n");
+                    continue;
+                }
+                uint32_t blks = b.hits + b.misses;
+                snprintf(line, sizeof(line),
+                         "per block: %lu blk in %lu ms = %lu blk/s (%lu image reads)\r\n"
+                         "cached:    %lu blk in %lu ms = %lu blk/s (%lu image reads, "
+                         "%lu hit / %lu miss = %lu%%)\r\n",
+                         (unsigned long)b.blocks, (unsigned long)(b.base_us / 1000u),
+                         (unsigned long)(b.base_us ? (uint64_t)b.blocks * 1000000u / b.base_us : 0),
+                         (unsigned long)b.base_reads,
+                         (unsigned long)b.blocks, (unsigned long)(b.cache_us / 1000u),
+                         (unsigned long)(b.cache_us ? (uint64_t)b.blocks * 1000000u / b.cache_us : 0),
+                         (unsigned long)b.cache_reads,
+                         (unsigned long)b.hits, (unsigned long)b.misses,
+                         (unsigned long)(blks ? 100u * b.hits / blks : 0));
+                tn_puts(fd, line);
+                continue;
+            }
+            if (esc_st == 0 && (ch == 'u' || ch == 'U') && !menu_mode) {
+                /* SSC modem bridge: byte rates, TCP sends, latency */
+                if (ch == 'U') {
+                    sscbridge_reset_stats();
+                    tn_puts(fd, "-- SSC stats cleared --\r\n");
+                    continue;
+                }
+                ssc_stats_t st;
+                char line[256];
+                sscbridge_get_stats(&st);
+                uint32_t ms = st.elapsed_ms ? st.elapsed_ms : 1;
+                snprintf(line, sizeof(line),
+                         "SSC out: %lu B (%lu B/s) in %lu sends, %lu B/send, "
+                         "hold %lu us avg / %lu max\r\n"
+                         "SSC in:  %lu B (%lu B/s) in %lu recvs, "
+                         "to wire %lu us avg / %lu max  overruns=%lu\r\n",
+                         (unsigned long)st.out_bytes,
+                         (unsigned long)((uint64_t)st.out_bytes * 1000 / ms),
+                         (unsigned long)st.out_sends,
+                         (unsigned long)(st.out_sends ? st.out_bytes / st.out_sends : 0),
+                         (unsigned long)st.out_lat_us_avg, (unsigned long)st.out_lat_us_max,
+                         (unsigned long)st.in_bytes,
+                         (unsigned long)((uint64_t)st.in_bytes * 1000 / ms),
+                         (unsigned long)st.in_recvs,
+                         (unsigned long)st.in_lat_us_avg, (unsigned long)st.in_lat_us_max,
+                         (unsigned long)st.rx_overruns);
+                tn_puts(fd, line);
+                continue;
+            }
             if (esc_st == 0 && ch == 's' && !menu_mode) {
+                if (!scope_mode && fifo_busy(fd))
+                    continue;
                 scope_mode = !scope_mode;  /* continuous bus stream */
                 /* capture runs continuously (rolling); scope just toggles
                  * whether we stream it -- do not disable capture on exit. */
@@ -502,7 +635,8 @@ static void session(int fd)
         }
 
         if (scope_mode) {
-            scope_dump_batch(fd);          /* continuous bus stream */
+            if (!bustrace_active())
+                scope_dump_batch(fd);      /* continuous bus stream */
         } else if (menu_mode) {
             if (!menu_mcu_view_active()) {
                 /* B at the root menu (or SELECT) handed the display back
@@ -0,0 +1,16 @@
+/*
+ * Host stand-in for lwIP's <lwip/sockets.h>: the lwip_* calls made by the
+ * BL616 sources under test map onto the BSD socket calls they mirror.
+ */
+#ifndef HOST_LWIP_SOCKETS_H
+#define HOST_LWIP_SOCKETS_H
+
+#include <errno.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#define lwip_send   send
+#define lwip_recv   recv
+
+#endif
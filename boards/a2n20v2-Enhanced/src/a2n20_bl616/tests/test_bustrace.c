@@ -0,0 +1,238 @@
+/*
+ * test_bustrace.c — host-side check of the bus-trace stream format
+ * (BL616 firmware_host/bustrace.h) against its decoder
+ * (a2n20_bl616/tools/bustrace_decode.c).
+ *
+ * Builds streams the way the board's server lays them out (the same header
+ * structs, FIFO entries packed ctrl/data/addr_lo/addr_hi) and requires that
+ * the decoder:
+ *   - counts every cycle, read/write and asserted control line
+ *   - attributes OVERFLOW markers to their causes (wrap/held/link/frozen)
+ *   - follows capture-mode changes carried in the record headers
+ *   - scales record times by the header's ts_hz (the board's 54 MHz FPGA
+ *     sys_time, or microseconds from older firmware)
+ *   - ignores a truncated final record instead of failing
+ *   - rejects a stream without the magic
+ * then reports decode throughput over a long synthetic capture.
+ *
+ *   make bustrace           (from a2n20_bl616/tests)
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "check.h"
+
+#define BUSTRACE_DECODE_NO_MAIN
+#include "bustrace_decode.c"
+
+/* ---- stream builder ------------------------------------------------------ */
+
+#define US(x)  ((uint64_t)(x) * (BT_TS_HZ / 1000000u))   /* us -> ts ticks */
+
+static void put_stream_hdr(FILE *f, uint8_t mode, uint8_t flags, uint32_t ts_hz,
+                           uint64_t t0)
+{
+    bt_stream_hdr_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, BT_MAGIC, 4);
+    h.version = BT_VERSION;
+    h.hdr_len = sizeof(h);
+    h.rec_hdr_len = sizeof(bt_rec_hdr_t);
+    h.entry_len = BT_ENTRY_LEN;
+    h.fifo_depth = BT_FIFO_DEPTH;
+    h.capture_mode = mode;
+    h.flags = flags;
+    h.ts_hz = ts_hz;
+    h.t0 = t0;
+    fwrite(&h, sizeof(h), 1, f);
+}
+
+static void put_rec(FILE *f, uint8_t type, uint8_t flags, uint16_t count,
+                    uint8_t mode, uint64_t ts)
+{
+    bt_rec_hdr_t r;
+    memset(&r, 0, sizeof(r));
+    r.type = type;
+    r.flags = flags;
+    r.count = count;
+    r.capture_mode = mode;
+    r.ts = ts;
+    fwrite(&r, sizeof(r), 1, f);
+}
+
+/* One FIFO entry: idle control lines are high (negated). */
+static void put_entry(FILE *f, uint16_t addr, uint8_t data, bool rd, uint8_t asserted)
+{
+    uint8_t ctrl = (rd ? 0x80 : 0x00) | (0x7E & ~asserted);   /* m2sel_n = 0 */
+    uint8_t e[4] = { ctrl, data, (uint8_t)addr, (uint8_t)(addr >> 8) };
+    fwrite(e, 4, 1, f);
+}
+
+/* ---- tests --------------------------------------------------------------- */
+
+static void test_basic(void)
+{
+    printf("stream with overflow markers...\n");
+    FILE *f = tmpfile();
+    put_stream_hdr(f, 0, 0, BT_TS_HZ, US(1000));
+
+    /* 100 cycles of a loop in $F8xx: 3 reads per write */
+    put_rec(f, BT_REC_DATA, 0, 100, 0, US(2000));
+    for (int i = 0; i < 100; i++)
+        put_entry(f, 0xF800 + (i & 0x3F), (uint8_t)i, (i & 3) != 3, 0);
+
+    /* full FIFO in rolling mode, then a whole window with /IRQ asserted */
+    put_rec(f, BT_REC_OVERFLOW, BT_F_WRAP, 0, 0, US(3000));
+    put_rec(f, BT_REC_DATA, 0, BT_FIFO_DEPTH, 0, US(3000));
+    for (int i = 0; i < BT_FIFO_DEPTH; i++)
+        put_entry(f, 0x0300 + (i & 0xFF), 0xEA, true, 0x10);
+
+    /* link retry on a small batch, then the filter switched to I/O only */
+    put_rec(f, BT_REC_OVERFLOW, BT_F_LINK, 0, 0, US(4000));
+    put_rec(f, BT_REC_DATA, 0, 4, 0, US(4000));
+    for (int i = 0; i < 4; i++)
+        put_entry(f, 0x0400 + i, 0xA0, false, 0);
+    put_rec(f, BT_REC_DATA, 0, 8, 1, US(25000));
+    for (int i = 0; i < 8; i++)
+        put_entry(f, 0xC0E9, 0, true, 0x40);            /* /INH asserted */
+
+    /* oneshot hold, and the freeze trigger firing */
+    put_rec(f, BT_REC_OVERFLOW, BT_F_HELD, 0, 1, US(26000));
+    put_rec(f, BT_REC_OVERFLOW, BT_F_FROZEN, 0, 1, US(1001000));
+    rewind(f);
+
+    bt_summary_t s;
+    int rc = bt_decode(f, &s, NULL, 0);
+    fclose(f);
+    CHECK(rc == 0, "decode failed");
+    CHECK(s.records == 8, "records %llu != 8", (unsigned long long)s.records);
+    CHECK(s.data_records == 4, "data records %llu != 4",
+          (unsigned long long)s.data_records);
+    CHECK(s.entries == 100 + BT_FIFO_DEPTH + 4 + 8, "cycles %llu",
+          (unsigned long long)s.entries);
+    CHECK(s.writes == 25 + 4, "writes %llu != 29", (unsigned long long)s.writes);
+    CHECK(s.reads == 75 + BT_FIFO_DEPTH + 8, "reads %llu",
+          (unsigned long long)s.reads);
+    CHECK(s.overflows == 4 && s.wraps == 1 && s.link == 1 &&
+          s.held == 1 && s.frozen == 1,
+          "overflows %llu (wrap %llu link %llu held %llu frozen %llu)",
+          (unsigned long long)s.overflows, (unsigned long long)s.wraps,
+          (unsigned long long)s.link, (unsigned long long)s.held,
+          (unsigned long long)s.frozen);
+    CHECK(s.asserted[2] == BT_FIFO_DEPTH, "/IRQ asserted %llu",
+          (unsigned long long)s.asserted[2]);
+    CHECK(s.asserted[0] == 8, "/INH asserted %llu",
+          (unsigned long long)s.asserted[0]);
+    CHECK(s.asserted[1] == 0, "/RESET asserted %llu",
+          (unsigned long long)s.asserted[1]);
+    CHECK(s.mode_changes == 1, "mode changes %llu",
+          (unsigned long long)s.mode_changes);
+    CHECK(s.pages[0xF8] == 100 && s.pages[0x03] == BT_FIFO_DEPTH &&
+          s.pages[0xC0] == 8, "page histogram");
+    CHECK(s.ts_hz == BT_TS_HZ && s.t_last - s.t0 == US(1000000),
+          "duration %llu ticks at %u Hz", (unsigned long long)(s.t_last - s.t0),
+          (unsigned)s.ts_hz);
+    CHECK(s.truncated == 0, "truncated %llu", (unsigned long long)s.truncated);
+    bt_report(&s, stdout);
+}
+
+static void test_truncated(void)
+{
+    printf("truncated final record...\n");
+    FILE *f = tmpfile();
+    put_stream_hdr(f, 0, BT_F_HELD, BT_TS_HZ, 0);
+    put_rec(f, BT_REC_DATA, 0, 2, 0, 10);
+    put_entry(f, 0x1234, 0x56, true, 0);
+    put_entry(f, 0x1235, 0x57, true, 0);
+    put_rec(f, BT_REC_DATA, 0, 10, 0, 20);              /* cut mid-record */
+    for (int i = 0; i < 3; i++)
+        put_entry(f, 0x2000, 0, false, 0);
+    rewind(f);
+
+    bt_summary_t s;
+    int rc = bt_decode(f, &s, NULL, 0);
+    fclose(f);
+    CHECK(rc == 0, "decode failed");
+    CHECK(s.entries == 2, "cycles %llu != 2", (unsigned long long)s.entries);
+    CHECK(s.truncated == sizeof(bt_rec_hdr_t) + 3 * BT_ENTRY_LEN,
+          "truncated %llu", (unsigned long long)s.truncated);
+    CHECK(s.start_flags == BT_F_HELD, "start flags %u", (unsigned)s.start_flags);
+}
+
+static void test_us_stream(void)
+{
+    printf("microsecond timestamps (older firmware)...\n");
+    FILE *f = tmpfile();
+    put_stream_hdr(f, 0, 0, 1000000, 5000);
+    put_rec(f, BT_REC_DATA, 0, 1, 0, 5000);
+    put_entry(f, 0xC000, 0x80, true, 0);
+    put_rec(f, BT_REC_OVERFLOW, BT_F_FROZEN, 0, 0, 255000);
+    rewind(f);
+
+    bt_summary_t s;
+    int rc = bt_decode(f, &s, NULL, 0);
+    fclose(f);
+    CHECK(rc == 0, "decode failed");
+    CHECK((double)(s.t_last - s.t0) / s.ts_hz == 0.25, "duration %.6f s",
+          (double)(s.t_last - s.t0) / s.ts_hz);
+}
+
+static void test_bad_magic(void)
+{
+    printf("bad magic rejected...\n");
+    FILE *f = tmpfile();
+    fputs("A2BX not a trace, just forty bytes of text.", f);
+    rewind(f);
+    fflush(stdout);
+    bt_summary_t s;
+    int rc = bt_decode(f, &s, NULL, 0);                 /* prints the reason */
+    fclose(f);
+    CHECK(rc < 0, "garbage accepted");
+}
+
+static void bench(void)
+{
+    /* ~4 s of full-rate capture: 8000 full-FIFO records */
+    enum { RECS = 8000 };
+    FILE *f = tmpfile();
+    put_stream_hdr(f, 0, 0, BT_TS_HZ, 0);
+    for (int r = 0; r < RECS; r++) {
+        put_rec(f, BT_REC_DATA, 0, BT_FIFO_DEPTH, 0, US((uint64_t)r * 500));
+        for (int i = 0; i < BT_FIFO_DEPTH; i++)
+            put_entry(f, (uint16_t)(r * 7 + i), (uint8_t)i, i & 1, 0);
+    }
+    long bytes = ftell(f);
+    rewind(f);
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    bt_summary_t s;
+    bt_decode(f, &s, NULL, 0);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    fclose(f);
+    double secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    CHECK(s.entries == (uint64_t)RECS * BT_FIFO_DEPTH, "bench cycles %llu",
+          (unsigned long long)s.entries);
+    printf("decode: %.1f MB stream, %.1f Mcycles/s (%.0fx the bus rate)\n",
+           bytes / 1e6, s.entries / secs / 1e6, s.entries / secs / 1.023e6);
+}
+
+int main(void)
+{
+    printf("=== bus trace stream format ===\n");
+    test_basic();
+    test_truncated();
+    test_us_stream();
+    test_bad_magic();
+    bench();
+    if (s_fail) {
+        printf("=== FAILED: %d checks ===\n", s_fail);
+        return 1;
+    }
+    printf("=== PASSED ===\n");
+    return 0;
+}
@@ -0,0 +1,264 @@
+/*
+ * test_ssc_pump.c — host-side loopback test for the SSC modem bridge's data
+ * path (BL616 firmware_host/ssc_pump.c).
+ *
+ * The pump runs on the host's BSD sockets against an in-process TCP echo
+ * server. The test plays both UART interrupt roles on a simulated clock:
+ * Apple II bytes arrive one character time apart at the emulated baud rate,
+ * and the TX ring is drained onto the "wire" at the same rate. It requires
+ * that:
+ *   - the byte rings keep data intact across the wrap
+ *   - typing (one key every 100 ms at 19200 baud) goes out one send per
+ *     key, held no longer than the idle flush time
+ *   - a continuous stream at 115200 is coalesced (far fewer sends than
+ *     bytes, none held past SSC_HOLD_MAX_US) and echoes back intact
+ *   - inbound data never queues more than SSC_IN_AHEAD_US of wire time in
+ *     the TX ring, and while it is held off the pump reports how long the
+ *     wire needs to make room (the task waits on that, not the socket)
+ *   - telnet: DO is refused with WONT, IAC IAC unescapes, 0xFF is doubled
+ *   - a peer close ends the session
+ * then reports bytes per send and latency.
+ *
+ *   make ssc_pump           (from a2n20_bl616/tests)
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "check.h"
+#include "ssc_pump.h"
+
+#define STREAM_BYTES  (16u * 1024u)
+#define STEP_US       50u          /* simulated clock step */
+
+/* ---- in-process echo server ---- */
+static int s_listen = -1, s_conn = -1;
+static uint8_t s_echo[STREAM_BYTES * 2];
+static size_t s_echo_len;
+
+static void nonblock(int fd)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+static void echo_service(void)
+{
+    uint8_t buf[4096];
+    ssize_t r = recv(s_conn, buf, sizeof(buf), 0);
+    if (r > 0 && s_echo_len + (size_t)r <= sizeof(s_echo)) {
+        memcpy(s_echo + s_echo_len, buf, (size_t)r);
+        s_echo_len += (size_t)r;
+    }
+    if (s_echo_len) {
+        ssize_t w = send(s_conn, s_echo, s_echo_len, 0);
+        if (w > 0) {
+            memmove(s_echo, s_echo + w, s_echo_len - (size_t)w);
+            s_echo_len -= (size_t)w;
+        }
+    }
+}
+
+/* Connected pair: returns the pump's end, server end in s_conn. */
+static int connect_pair(void)
+{
+    struct sockaddr_in sa;
+    socklen_t l = sizeof(sa);
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (s_listen < 0) {
+        s_listen = socket(AF_INET, SOCK_STREAM, 0);
+        if (s_listen < 0 || bind(s_listen, (struct sockaddr *)&sa, sizeof(sa)) < 0 ||
+            listen(s_listen, 1) < 0) {
+            printf("FAIL: cannot listen on loopback (%s)\n", strerror(errno));
+            exit(1);
+        }
+    }
+    getsockname(s_listen, (struct sockaddr *)&sa, &l);
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&sa, sizeof(sa)) < 0) {
+        printf("FAIL: cannot connect to loopback (%s)\n", strerror(errno));
+        exit(1);
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    s_conn = accept(s_listen, NULL, NULL);
+    nonblock(s_conn);
+    s_echo_len = 0;
+    return fd;
+}
+
+/* ---- the UART side on a simulated clock ---- */
+static uint8_t    s_txbuf[2048];
+static ssc_ring_t s_tx = { s_txbuf, sizeof(s_txbuf) - 1, 0, 0 };
+static uint64_t   s_now;
+static uint64_t   s_wire_credit;     /* wire time owed, in us * baud */
+
+/* Drain the TX ring at the baud rate for one step; returns bytes moved. */
+static uint32_t wire_drain(uint32_t baud, uint8_t *out, uint32_t max)
+{
+    s_wire_credit += (uint64_t)STEP_US * baud;
+    uint32_t n = (uint32_t)(s_wire_credit / 10000000u);   /* 10 bits/char */
+    if (n > max)
+        n = max;
+    n = ssc_ring_read(&s_tx, out, n);
+    s_wire_credit -= (uint64_t)n * 10000000u;
+    if (!ssc_ring_used(&s_tx))
+        s_wire_credit = 0;           /* an idle wire banks no credit */
+    return n;
+}
+
+static uint8_t s_src[STREAM_BYTES], s_dst[STREAM_BYTES];
+
+int main(void)
+{
+    printf("=== SSC bridge data path: loopback ===\n");
+
+    /* ---- rings: bulk write/read across the wrap ---- */
+    uint8_t rb[16], tmp[16];
+    ssc_ring_t r = { rb, sizeof(rb) - 1, 0, 0 };
+    uint8_t seq = 0, chk = 0;
+    for (int i = 0; i < 100; i++) {
+        uint8_t in[11];
+        uint32_t n = (uint32_t)(i % 11);
+        for (uint32_t k = 0; k < n; k++)
+            in[k] = (uint8_t)(seq + k);
+        uint32_t w = ssc_ring_write(&r, in, n);
+        seq = (uint8_t)(seq + w);
+        uint32_t g = ssc_ring_read(&r, tmp, (uint32_t)(i % 7));
+        for (uint32_t k = 0; k < g; k++)
+            CHECK(tmp[k] == chk++, "ring: byte %u", k);
+    }
+    CHECK(ssc_ring_write(&r, rb, 64) <= 16, "ring: overfill");
+
+    ssc_pump_t p;
+    ssc_stats_t st;
+
+    /* ---- typing at 19200: one key per 100 ms ---- */
+    int fd = connect_pair();
+    ssc_pump_init(&p, &s_tx, 19200, s_now);
+    ssc_pump_attach(&p, fd, false);
+    for (int k = 0; k < 20; k++) {
+        uint8_t key = (uint8_t)('a' + k);
+        CHECK(ssc_pump_out(&p, &key, 1, s_now), "typing: out");
+        for (uint32_t t = 0; t < 100000; t += STEP_US) {
+            s_now += STEP_US;
+            CHECK(ssc_pump_poll(&p, true, s_now), "typing: poll");
+            echo_service();
+            uint8_t w[8];
+            wire_drain(19200, w, sizeof(w));
+        }
+    }
+    ssc_pump_stats(&p, s_now, &st);
+    CHECK(st.out_sends == 20 && st.out_bytes == 20, "typing: %u sends for %u bytes",
+          st.out_sends, st.out_bytes);
+    CHECK(st.out_lat_us_max <= 2 * 10000000u / 19200 + STEP_US,
+          "typing: held %u us", st.out_lat_us_max);
+    CHECK(st.in_bytes == 20, "typing: echoed %u", st.in_bytes);
+    printf("typing @19200: %u sends, key held %u us max, echo to wire %u us max\n",
+           st.out_sends, st.out_lat_us_max, st.in_lat_us_max);
+    close(fd);
+    close(s_conn);
+
+    /* ---- continuous stream at 115200, echoed back ---- */
+    const uint32_t baud = 115200;
+    fd = connect_pair();
+    ssc_pump_init(&p, &s_tx, baud, s_now);
+    ssc_pump_attach(&p, fd, false);
+    for (uint32_t i = 0; i < STREAM_BYTES; i++)
+        s_src[i] = (uint8_t)(i * 13 + (i >> 8));
+    uint32_t sent = 0, got = 0, peak = 0;
+    uint64_t credit_in = 0, end = s_now + 10u * STREAM_BYTES * 10000000ull / baud;
+    while (got < STREAM_BYTES && s_now < end) {
+        s_now += STEP_US;
+        credit_in += (uint64_t)STEP_US * baud;                /* Apple II types */
+        uint32_t n = (uint32_t)(credit_in / 10000000u);
+        if (n > STREAM_BYTES - sent)
+            n = STREAM_BYTES - sent;
+        credit_in -= (uint64_t)n * 10000000u;
+        CHECK(ssc_pump_out(&p, s_src + sent, n, s_now), "stream: out");
+        sent += n;
+        CHECK(ssc_pump_poll(&p, true, s_now), "stream: poll");
+        if (ssc_ring_used(&s_tx) > peak)
+            peak = ssc_ring_used(&s_tx);
+        echo_service();
+        got += wire_drain(baud, s_dst + got, STREAM_BYTES - got);
+    }
+    ssc_pump_stats(&p, s_now, &st);
+    CHECK(got == STREAM_BYTES, "stream: got %u of %u", got, STREAM_BYTES);
+    CHECK(memcmp(s_src, s_dst, got) == 0, "stream: data mismatch");
+    CHECK(st.out_sends * 16 < st.out_bytes, "stream: %u sends for %u bytes",
+          st.out_sends, st.out_bytes);
+    CHECK(st.out_lat_us_max <= SSC_HOLD_MAX_US + STEP_US, "stream: held %u us",
+          st.out_lat_us_max);
+    uint32_t ahead = (uint32_t)((uint64_t)baud / 10 * SSC_IN_AHEAD_US / 1000000u);
+    CHECK(peak <= ahead, "stream: %u bytes queued, limit %u", peak, ahead);
+
+    /* Held off: the wait covers the excess over the limit at the line rate,
+     * and command mode (which discards) never waits. */
+    s_tx.rd = s_tx.wr - (ahead + 9);
+    CHECK(ssc_pump_in_wait_us(&p, true) == 10 * (10000000u / baud),
+          "pacing wait: %u us", ssc_pump_in_wait_us(&p, true));
+    CHECK(ssc_pump_in_wait_us(&p, false) == 0, "pacing wait in command mode");
+    s_tx.rd = s_tx.wr - (ahead - 1);
+    CHECK(ssc_pump_in_wait_us(&p, true) == 0, "pacing wait below the limit");
+    s_tx.rd = s_tx.wr;
+    printf("stream @%u: %u B in %u sends (%u B/send), held %u us avg / %u max\n",
+           baud, st.out_bytes, st.out_sends, st.out_bytes / (st.out_sends ? st.out_sends : 1),
+           st.out_lat_us_avg, st.out_lat_us_max);
+    printf("  inbound %u B in %u recvs, TX ring peak %u B (limit %u), to wire %u us avg\n",
+           st.in_bytes, st.in_recvs, peak, ahead, st.in_lat_us_avg);
+
+    /* ---- peer close ends the session ---- */
+    close(s_conn);
+    bool up = true;
+    for (int i = 0; i < 1000 && up; i++) {
+        s_now += STEP_US;
+        up = ssc_pump_poll(&p, true, s_now);
+    }
+    CHECK(!up, "close: session still up");
+    close(fd);
+
+    /* ---- telnet handling ---- */
+    fd = connect_pair();
+    ssc_pump_init(&p, &s_tx, baud, s_now);
+    ssc_pump_attach(&p, fd, true);
+    s_tx.rd = s_tx.wr;
+    static const uint8_t neg[] = { 0xFF, 0xFD, 0x01, 'h', 'i', 0xFF, 0xFF, '!' };
+    send(s_conn, neg, sizeof(neg), 0);
+    uint8_t ff = 0xFF, wire[16], peer[16];
+    uint32_t wn = 0;
+    ssize_t pn = 0;
+    CHECK(ssc_pump_out(&p, &ff, 1, s_now), "telnet: out");
+    CHECK(ssc_pump_flush(&p, s_now), "telnet: flush");
+    for (int i = 0; i < 2000 && (wn < 4 || pn < 5); i++) {
+        s_now += STEP_US;
+        ssc_pump_poll(&p, true, s_now);
+        wn += ssc_ring_read(&s_tx, wire + wn, sizeof(wire) - wn);
+        ssize_t r2 = recv(s_conn, peer + pn, sizeof(peer) - (size_t)pn, 0);
+        if (r2 > 0)
+            pn += r2;
+    }
+    CHECK(wn == 4 && memcmp(wire, "hi\xFF!", 4) == 0, "telnet: wire got %u bytes", wn);
+    CHECK(pn == 5 && peer[0] == 0xFF && peer[1] == 0xFF &&
+          peer[2] == 0xFF && peer[3] == 0xFC && peer[4] == 0x01,
+          "telnet: peer got %d bytes", (int)pn);
+    close(fd);
+    close(s_conn);
+
+    if (s_fail) {
+        printf("=== FAILED: %d checks ===\n", s_fail);
+        return 1;
+    }
+    printf("=== PASSED ===\n");
+    return 0;
+}
@@ -0,0 +1,287 @@
+/*
+ * bustrace_decode — read a bus-event capture stream from the board's
+ * bustrace server (TCP port 6502; format in firmware_host/bustrace.h) and
+ * print statistics and, optionally, the cycle trace.
+ *
+ *   cc -O2 -I../firmware_host -o bustrace_decode bustrace_decode.c
+ *
+ *   nc <board-ip> 6502 > boot.a2bt         record (Ctrl-C to stop)
+ *   ./bustrace_decode boot.a2bt            summary
+ *   ./bustrace_decode -t boot.a2bt         summary + every cycle
+ *   nc <board-ip> 6502 | ./bustrace_decode -t -n 2000 -   live, first 2000
+ *
+ * A truncated final record (capture stopped mid-send) is counted and
+ * ignored. Fields are decoded byte by byte, so the tool does not depend on
+ * the host's struct layout or endianness.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bustrace.h"
+
+typedef struct {
+    uint32_t version;
+    uint32_t ts_hz;
+    uint64_t t0, t_last;
+    uint32_t start_mode, start_flags;
+    uint64_t records, data_records, entries;
+    uint64_t reads, writes;
+    uint64_t asserted[6];           /* /INH /RESET /IRQ /NMI /DMA /RDY */
+    uint64_t overflows;
+    uint64_t wraps, held, link, frozen;
+    uint64_t mode_changes;
+    uint64_t truncated;             /* bytes of an incomplete final record */
+    uint64_t pages[256];            /* accesses per 256-byte page */
+} bt_summary_t;
+
+static uint16_t rd16(const uint8_t *p) { return (uint16_t)(p[0] | p[1] << 8); }
+static uint32_t rd32(const uint8_t *p) { return rd16(p) | (uint32_t)rd16(p + 2) << 16; }
+static uint64_t rd64(const uint8_t *p) { return rd32(p) | (uint64_t)rd32(p + 4) << 32; }
+
+/* Read exactly n bytes; returns the count actually read. */
+static size_t rd_full(FILE *f, uint8_t *buf, size_t n)
+{
+    size_t got = 0;
+    while (got < n) {
+        size_t r = fread(buf + got, 1, n - got, f);
+        if (r == 0)
+            break;
+        got += r;
+    }
+    return got;
+}
+
+static void print_entry(FILE *out, const uint8_t *e)
+{
+    uint8_t  f = e[0];
+    uint16_t a = rd16(e + 2);
+    fprintf(out, "%04X %c %02X %02X  %c%c%c%c%c%c\n",
+            a, (f & 0x80) ? 'R' : 'W', e[1], f,
+            ((f >> 6) & 1) ? '-' : 'I',
+            ((f >> 5) & 1) ? '-' : 'R',
+            ((f >> 4) & 1) ? '-' : 'Q',
+            ((f >> 3) & 1) ? '-' : 'N',
+            ((f >> 2) & 1) ? '-' : 'D',
+            ((f >> 1) & 1) ? '-' : 'Y');
+}
+
+/* Decode a whole stream. trace (may be NULL) receives the cycle listing, up
+ * to limit entries (0 = all). Returns 0, or -1 with a message on stderr if
+ * the stream header is not a bustrace header. */
+static int bt_decode(FILE *f, bt_summary_t *s, FILE *trace, uint64_t limit)
+{
+    uint8_t hdr[sizeof(bt_stream_hdr_t)];
+    memset(s, 0, sizeof(*s));
+
+    if (rd_full(f, hdr, 8) != 8 || memcmp(hdr, BT_MAGIC, 4) != 0) {
+        fprintf(stderr, "not a bustrace stream (bad magic)\n");
+        return -1;
+    }
+    s->version = rd16(hdr + 4);
+    uint16_t hdr_len = rd16(hdr + 6);
+    if (s->version != BT_VERSION || hdr_len < sizeof(bt_stream_hdr_t)) {
+        fprintf(stderr, "unsupported bustrace version %u (header %u bytes)\n",
+                (unsigned)s->version, (unsigned)hdr_len);
+        return -1;
+    }
+    if (rd_full(f, hdr + 8, sizeof(hdr) - 8) != sizeof(hdr) - 8) {
+        fprintf(stderr, "truncated stream header\n");
+        return -1;
+    }
+    for (uint16_t skip = hdr_len - sizeof(hdr); skip; skip--)
+        fgetc(f);                           /* newer header fields */
+
+    uint16_t rec_len = rd16(hdr + 8);
+    uint16_t ent_len = rd16(hdr + 10);
+    if (rec_len < sizeof(bt_rec_hdr_t) || rec_len > 64 ||
+        ent_len < BT_ENTRY_LEN || ent_len > 64) {
+        fprintf(stderr, "unsupported record/entry size %u/%u\n",
+                (unsigned)rec_len, (unsigned)ent_len);
+        return -1;
+    }
+    s->start_mode = hdr[14];
+    s->start_flags = hdr[15];
+    s->ts_hz = rd32(hdr + 16);
+    if (!s->ts_hz)
+        s->ts_hz = 1000000;
+    s->t0 = s->t_last = rd64(hdr + 24);
+
+    uint8_t rec[64];
+    uint8_t *ent = malloc((size_t)ent_len * 65536u);
+    if (!ent)
+        return -1;
+    int mode = (int)s->start_mode;
+    uint64_t shown = 0;
+
+    for (;;) {
+        size_t got = rd_full(f, rec, rec_len);
+        if (got == 0)
+            break;
+        if (got < rec_len) {
+            s->truncated += got;
+            break;
+        }
+        uint8_t  type  = rec[0];
+        uint8_t  flags = rec[1];
+        uint16_t count = rd16(rec + 2);
+        uint64_t ts    = rd64(rec + 8);
+        size_t   n     = (size_t)count * ent_len;
+
+        if (type == BT_REC_DATA && n) {
+            got = rd_full(f, ent, n);
+            if (got < n) {
+                s->truncated += rec_len + got;
+                break;
+            }
+        }
+        s->records++;
+        s->t_last = ts;
+        if (rec[4] != mode) {
+            s->mode_changes++;
+            mode = rec[4];
+            if (trace)
+                fprintf(trace, "# +%.6f s capture mode %d\n",
+                        (double)(ts - s->t0) / s->ts_hz, mode);
+        }
+
+        if (type == BT_REC_OVERFLOW) {
+            s->overflows++;
+            if (flags & BT_F_WRAP)   s->wraps++;
+            if (flags & BT_F_HELD)   s->held++;
+            if (flags & BT_F_LINK)   s->link++;
+            if (flags & BT_F_FROZEN) s->frozen++;
+            if (trace)
+                fprintf(trace, "# +%.6f s OVERFLOW%s%s%s%s\n",
+                        (double)(ts - s->t0) / s->ts_hz,
+                        (flags & BT_F_WRAP)   ? " wrap"   : "",
+                        (flags & BT_F_HELD)   ? " held"   : "",
+                        (flags & BT_F_LINK)   ? " link"   : "",
+                        (flags & BT_F_FROZEN) ? " frozen" : "");
+            continue;
+        }
+        if (type != BT_REC_DATA)
+            continue;                       /* unknown record: skip (count 0) */
+
+        s->data_records++;
+        s->entries += count;
+        if (trace && (!limit || shown < limit))
+            fprintf(trace, "# +%.6f s %u cycles\n",
+                    (double)(ts - s->t0) / s->ts_hz, (unsigned)count);
+        for (uint16_t i = 0; i < count; i++) {
+            const uint8_t *e = ent + (size_t)i * ent_len;
+            uint8_t c = e[0];
+            if (c & 0x80) s->reads++; else s->writes++;
+            for (int b = 0; b < 6; b++)
+                if (!(c & (0x40 >> b)))
+                    s->asserted[b]++;
+            s->pages[e[3]]++;
+            if (trace && (!limit || shown < limit)) {
+                print_entry(trace, e);
+                shown++;
+            }
+        }
+    }
+    free(ent);
+    return 0;
+}
+
+static void bt_report(const bt_summary_t *s, FILE *out)
+{
+    static const char *const lines[6] = {
+        "/INH", "/RESET", "/IRQ", "/NMI", "/DMA", "/RDY"
+    };
+    double secs = (double)(s->t_last - s->t0) / s->ts_hz;
+
+    fprintf(out, "stream v%u, capture mode %u at start%s%s\n",
+            (unsigned)s->version, (unsigned)s->start_mode,
+            (s->start_flags & BT_F_HELD)   ? ", oneshot was on" : "",
+            (s->start_flags & BT_F_FROZEN) ? ", trigger had fired" : "");
+    fprintf(out, "duration %.3f s, %llu records (%llu data), %llu cycles",
+            secs, (unsigned long long)s->records,
+            (unsigned long long)s->data_records, (unsigned long long)s->entries);
+    if (secs > 0)
+        fprintf(out, ", %.0f cycles/s", s->entries / secs);
+    fprintf(out, "\n");
+    fprintf(out, "reads %llu, writes %llu\n",
+            (unsigned long long)s->reads, (unsigned long long)s->writes);
+    fprintf(out, "overflow markers %llu: wrap %llu, held %llu, link %llu, frozen %llu\n",
+            (unsigned long long)s->overflows, (unsigned long long)s->wraps,
+            (unsigned long long)s->held, (unsigned long long)s->link,
+            (unsigned long long)s->frozen);
+    if (s->mode_changes)
+        fprintf(out, "capture mode changed %llu times\n",
+                (unsigned long long)s->mode_changes);
+    if (s->truncated)
+        fprintf(out, "incomplete final record (%llu bytes) ignored\n",
+                (unsigned long long)s->truncated);
+
+    fprintf(out, "asserted:");
+    for (int b = 0; b < 6; b++)
+        if (s->asserted[b])
+            fprintf(out, " %s %llu", lines[b], (unsigned long long)s->asserted[b]);
+    fprintf(out, "\n");
+
+    /* busiest pages */
+    bool used[256] = { false };
+    fprintf(out, "top pages:");
+    for (int k = 0; k < 8; k++) {
+        int best = -1;
+        for (int pg = 0; pg < 256; pg++)
+            if (!used[pg] && s->pages[pg] &&
+                (best < 0 || s->pages[pg] > s->pages[best]))
+                best = pg;
+        if (best < 0)
+            break;
+        used[best] = true;
+        fprintf(out, " $%02Xxx %.1f%%", best,
+                100.0 * s->pages[best] / (double)s->entries);
+    }
+    fprintf(out, "\n");
+}
+
+#ifndef BUSTRACE_DECODE_NO_MAIN
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: bustrace_decode [-t] [-n cycles] [file | -]\n"
+            "  -t         print the cycle trace (addr rw data ctl, then the\n"
+            "             asserted lines I R Q N D Y) before the summary\n"
+            "  -n cycles  stop the trace after this many cycles\n");
+}
+
+int main(int argc, char **argv)
+{
+    bool trace = false;
+    uint64_t limit = 0;
+    const char *path = "-";
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-t")) {
+            trace = true;
+        } else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            limit = strtoull(argv[++i], NULL, 0);
+        } else if (argv[i][0] == '-' && argv[i][1]) {
+            usage();
+            return 2;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    FILE *f = strcmp(path, "-") ? fopen(path, "rb") : stdin;
+    if (!f) {
+        perror(path);
+        return 1;
+    }
+    bt_summary_t s;
+    if (bt_decode(f, &s, trace ? stdout : NULL, limit) < 0)
+        return 1;
+    if (f != stdin)
+        fclose(f);
+    bt_report(&s, stdout);
+    return 0;
+}
+#endif
@@ -0,0 +1,382 @@
+// Testbench for mem_port_arb_pipe (storage arbiter, top.sv configuration)
+//
+// Three clients as in the framebuffer build: MCU (posted writes, weight 4),
+// Disk II (single reads, weight 1, critical) and HDD (burst reads, weight
+// 2). The controller model has a single-entry request slot that it frees
+// when it starts a request, and returns beats in order after a fixed
+// latency. Checks:
+// - with MCU and HDD saturated, grants alternate in runs of 4 and 2;
+// - a Disk II request goes out ahead of the rotation, at most one grant
+//   after it is queued;
+// - never more than two requests in flight, never a pulse into a full
+//   controller slot, and the pipeline does reach two;
+// - every beat is routed to its owner with the right data;
+// - the request counter counts accepted requests only, and a pulse into a
+//   full queue counts as a drop and never reaches the controller.
+//
+// The arbiter takes interface-array ports, so this bench runs under
+// Verilator (--binary --timing), not Icarus.
+`timescale 1ns/1ps
+
+module test_mem_port_arb_pipe;
+  // 54 MHz core clock (~18.518 ns period)
+  localparam real CLK_PERIOD_NS = 18.518;
+  localparam      LAT           = 6;      // controller clks from start to the first beat
+  localparam      BURST_BEATS   = 2;
+  localparam      MCU = 0, DISK = 1, HDD = 2;
+  localparam [20:0] BASE [3] = '{21'h000000, 21'h040000, 21'h080000};
+
+  reg clk = 0;
+  reg rst_n = 0;
+
+  always #(CLK_PERIOD_NS/2.0) clk = ~clk;
+
+  mem_port_if #(.PORT_ADDR_WIDTH(21), .DATA_WIDTH(32), .DQM_WIDTH(4), .PORT_OUTPUT_WIDTH(32))
+      clients[2:0] ();
+  mem_port_if #(.PORT_ADDR_WIDTH(21), .DATA_WIDTH(32), .DQM_WIDTH(4), .PORT_OUTPUT_WIDTH(32))
+      ctl();
+
+  reg         snap = 1'b0;
+  reg         clear = 1'b0;
+  wire [31:0] st_req     [2:0];
+  wire [31:0] st_wait    [2:0];
+  wire [15:0] st_max_lat [2:0];
+  wire [15:0] st_drop    [2:0];
+
+  mem_port_arb_pipe #(
+    .NUM_CLIENTS(3),
+    .PORT_ADDR_WIDTH(21),
+    .DATA_WIDTH(32),
+    .DQM_WIDTH(4),
+    .PORT_OUTPUT_WIDTH(32),
+    .CLIENT_BASE_ADDR('{21'h000000, 21'h040000, 21'h080000}),
+    .QUEUE_LOG2(1),
+    .BURST_BEATS(BURST_BEATS),
+    .CLIENT_WEIGHT('{4'd4, 4'd1, 4'd2}),
+    .CLIENT_CRITICAL(3'b010)
+  ) dut (
+    .clk_i(clk),
+    .rst_n_i(rst_n),
+    .clients(clients),
+    .controller(ctl),
+    .dbg_snap_i(snap),
+    .dbg_clear_i(clear),
+    .dbg_req_o(st_req),
+    .dbg_wait_o(st_wait),
+    .dbg_max_lat_o(st_max_lat),
+    .dbg_drop_o(st_drop)
+  );
+
+  // Beat data for a controller address
+  function [31:0] beat_q(input [20:0] a, input [3:0] beat);
+    beat_q = {beat, 7'd0, a};
+  endfunction
+
+  // ---------------------------------------------------------------------
+  // Controller model
+  // ---------------------------------------------------------------------
+  reg        stall = 1'b0;          // hold requests in the slot
+  reg        slot_v = 1'b0;
+  reg        slot_wr, slot_burst;
+  reg [20:0] slot_addr;
+  reg        eng_busy = 1'b0;
+  reg        eng_wr;
+  reg [20:0] eng_addr;
+  reg [3:0]  eng_beats, eng_beat;
+  integer    eng_wait;
+  reg        take;
+
+  integer issued = 0, completed = 0, max_inflight = 0;
+  integer overruns = 0, inflight_bad = 0, wdata_bad = 0;
+  integer grant_log [0:1023];
+  integer gl_n = 0;
+
+  assign ctl.available = 1'b1;
+
+  always @(posedge clk) begin
+    ctl.ready <= 1'b0;
+    take = !eng_busy && slot_v && !stall;
+    if (take) begin
+      eng_busy  <= 1'b1;
+      eng_wr    <= slot_wr;
+      eng_addr  <= slot_addr;
+      eng_beats <= (slot_burst && !slot_wr) ? 4'(BURST_BEATS) : 4'd1;
+      eng_beat  <= 4'd0;
+      eng_wait  <= LAT;
+    end
+    if (ctl.rd || ctl.wr) begin
+      if (slot_v && !take)
+        overruns = overruns + 1;
+      if (issued - completed >= 2)
+        inflight_bad = inflight_bad + 1;
+      if (ctl.wr && ctl.data !== {11'd0, ctl.addr})
+        wdata_bad = wdata_bad + 1;
+      slot_v     <= 1'b1;
+      slot_wr    <= ctl.wr;
+      slot_burst <= ctl.burst;
+      slot_addr  <= ctl.addr;
+      issued = issued + 1;
+      if (issued - completed > max_inflight)
+        max_inflight = issued - completed;
+      if (gl_n < 1024)
+        grant_log[gl_n] = ctl.addr[19:18];
+      gl_n = gl_n + 1;
+    end else if (take) begin
+      slot_v <= 1'b0;
+    end
+    if (eng_busy) begin
+      if (eng_wait != 0) begin
+        eng_wait <= eng_wait - 1;
+      end else begin
+        ctl.ready <= 1'b1;
+        ctl.q     <= eng_wr ? 32'h0 : beat_q(eng_addr, eng_beat);
+        eng_beat  <= eng_beat + 4'd1;
+        if (eng_beat == eng_beats - 4'd1) begin
+          eng_busy  <= 1'b0;
+          completed = completed + 1;
+        end
+      end
+    end
+  end
+
+  // ---------------------------------------------------------------------
+  // Clients: MCU posts writes, Disk II single reads, HDD burst reads
+  // ---------------------------------------------------------------------
+  reg     post_en  [3] = '{1'b0, 1'b0, 1'b0};  // pulse whenever available
+  integer shot_req [3] = '{0, 0, 0};           // one pulse, ignoring available
+  integer shot_done[3] = '{0, 0, 0};
+  integer pulsed   [3] = '{0, 0, 0};
+  integer done     [3] = '{0, 0, 0};
+  integer data_bad [3] = '{0, 0, 0};
+  reg [20:0] post_addr[3] = '{21'd0, 21'd0, 21'd0};   // next client address
+  reg [20:0] exp_addr [3] = '{21'd0, 21'd0, 21'd0};   // next to complete
+  reg [3:0]  exp_beat [3] = '{4'd0, 4'd0, 4'd0};
+
+  generate
+    for (genvar gc = 0; gc < 3; gc++) begin : cl
+      localparam IS_WR    = (gc == MCU);
+      localparam IS_BURST = (gc == HDD);
+      reg        req_r = 1'b0;
+      reg [20:0] addr_r = 21'd0;
+
+      assign clients[gc].rd      = req_r && !IS_WR;
+      assign clients[gc].wr      = req_r && IS_WR;
+      assign clients[gc].burst   = IS_BURST;
+      assign clients[gc].addr    = addr_r;
+      assign clients[gc].data    = {11'd0, BASE[gc] + addr_r};
+      assign clients[gc].byte_en = 4'hF;
+
+      // At least one low cycle between pulses, so available is current
+      always @(posedge clk) begin
+        req_r <= 1'b0;
+        if (!req_r && shot_req[gc] != shot_done[gc]) begin
+          req_r  <= 1'b1;
+          addr_r <= post_addr[gc];
+          // A pulse into a full queue is lost: do not expect it back
+          if (clients[gc].available)
+            post_addr[gc] <= post_addr[gc] + 21'd1;
+          shot_done[gc] <= shot_done[gc] + 1;
+          pulsed[gc]    <= pulsed[gc] + 1;
+        end else if (!req_r && post_en[gc] && clients[gc].available) begin
+          req_r  <= 1'b1;
+          addr_r <= post_addr[gc];
+          post_addr[gc] <= post_addr[gc] + 21'd1;
+          pulsed[gc]    <= pulsed[gc] + 1;
+        end
+      end
+
+      // Completions arrive in this client's issue order
+      always @(posedge clk) begin
+        if (clients[gc].ready) begin
+          if (!IS_WR && clients[gc].q !== beat_q(BASE[gc] + exp_addr[gc], exp_beat[gc])) begin
+            $display("[FAIL] client %0d beat %0d: q=0x%08X exp=0x%08X @%0t", gc,
+                     exp_beat[gc], clients[gc].q,
+                     beat_q(BASE[gc] + exp_addr[gc], exp_beat[gc]), $time);
+            data_bad[gc] <= data_bad[gc] + 1;
+          end
+          if (exp_beat[gc] == (IS_BURST ? BURST_BEATS - 1 : 0)) begin
+            exp_beat[gc] <= 4'd0;
+            exp_addr[gc] <= exp_addr[gc] + 21'd1;
+            done[gc]     <= done[gc] + 1;
+          end else begin
+            exp_beat[gc] <= exp_beat[gc] + 4'd1;
+          end
+        end
+      end
+    end
+  endgenerate
+
+  // ---------------------------------------------------------------------
+  // Checks
+  // ---------------------------------------------------------------------
+  integer fails = 0;
+  integer drops_mcu = 0, drops_hdd = 0;   // pulses expected to be lost
+
+  task automatic check_eq(input [31:0] got, input [31:0] exp, input [255:0] what);
+    if (got !== exp) begin
+      $display("[FAIL] %0s: got=0x%0X exp=0x%0X @%0t", what, got, exp, $time);
+      fails = fails + 1;
+    end else begin
+      $display("[PASS] %0s: 0x%0X", what, got);
+    end
+  endtask
+
+  task automatic wait_idle;
+    integer n;
+    begin
+      n = 0;
+      while ((done[MCU] != pulsed[MCU] - drops_mcu ||
+              done[DISK] != pulsed[DISK] ||
+              done[HDD] != pulsed[HDD] - drops_hdd) && n < 10000) begin
+        @(posedge clk);
+        n = n + 1;
+      end
+      repeat (4) @(posedge clk);
+      #1;
+    end
+  endtask
+
+  // Take a snapshot of the live counters
+  task automatic take_snap;
+    begin
+      @(posedge clk); #1;
+      snap = 1'b1;
+      @(posedge clk); #1;
+      snap = 1'b0;
+    end
+  endtask
+
+  integer k, run_c, run_len, runs_bad, runs_seen, at_shot, pos, late;
+  integer base_hdd, done_hdd;
+
+  initial begin
+    $dumpfile("mem_port_arb_pipe.vcd");
+    $dumpvars(0, test_mem_port_arb_pipe);
+
+    $display("=== mem_port_arb_pipe: weighted RR, critical override, 2 in flight ===");
+    #(20*CLK_PERIOD_NS);
+    rst_n = 1;
+    #(10*CLK_PERIOD_NS);
+
+    // 1) MCU and HDD saturated: grants run 2,2,0,0,0,0,2,2,...
+    @(posedge clk); #1;
+    post_en[MCU] = 1'b1;
+    post_en[HDD] = 1'b1;
+    while (gl_n < 64) @(posedge clk);
+    #1;
+    post_en[MCU] = 1'b0;
+    post_en[HDD] = 1'b0;
+    wait_idle();
+
+    runs_bad  = 0;
+    runs_seen = 0;
+    run_c     = grant_log[4];
+    run_len   = 0;
+    for (k = 4; k < 60; k = k + 1) begin
+      if (grant_log[k] == run_c) begin
+        run_len = run_len + 1;
+      end else begin
+        // The first run may be cut short by the window
+        if (runs_seen != 0 && run_len != (run_c == MCU ? 4 : 2)) begin
+          $display("[FAIL] run of %0d grants to client %0d ending at grant %0d",
+                   run_len, run_c, k);
+          runs_bad = runs_bad + 1;
+        end
+        runs_seen = runs_seen + 1;
+        run_c     = grant_log[k];
+        run_len   = 1;
+      end
+    end
+    check_eq(runs_bad, 0, "weighted RR: runs of 4 MCU, 2 HDD");
+    check_eq(runs_seen >= 15, 1, "weighted RR: both clients kept alternating");
+    check_eq(max_inflight, 2, "pipeline: max requests in flight");
+
+    // 2) Disk II under the same load goes out ahead of the rotation
+    @(posedge clk); #1;
+    post_en[MCU] = 1'b1;
+    post_en[HDD] = 1'b1;
+    late = 0;
+    for (k = 0; k < 4; k = k + 1) begin
+      repeat (37 + 11 * k) @(posedge clk);
+      #1;
+      shot_req[DISK] = shot_req[DISK] + 1;
+      // Count from the cycle it is queued; the arbiter may already be
+      // issuing someone else on that edge
+      do begin
+        @(posedge clk); #1;
+      end while (!dut.q_nonempty_w[DISK]);
+      at_shot = gl_n;
+      while (done[DISK] != k + 1) @(posedge clk);
+      pos = at_shot;
+      while (pos < gl_n && grant_log[pos] != DISK) pos = pos + 1;
+      if (pos - at_shot > 1) begin
+        $display("[FAIL] Disk II request %0d waited behind %0d grants", k, pos - at_shot);
+        late = late + 1;
+      end
+    end
+    #1;
+    post_en[MCU] = 1'b0;
+    post_en[HDD] = 1'b0;
+    wait_idle();
+    check_eq(late, 0, "critical: Disk II granted next");
+    check_eq(done[DISK], 4, "critical: Disk II reads completed");
+
+    // 3) Counters: everything so far was accepted
+    take_snap();
+    for (k = 0; k < 3; k = k + 1) begin
+      check_eq(st_req[k], pulsed[k], "stats: requests accepted");
+      check_eq(st_drop[k], 0, "stats: requests dropped");
+    end
+
+    // 4) Controller stalled: HDD fills the slot and its queue (3 requests),
+    //    then one pulse ignores available and must be dropped
+    @(posedge clk); #1;
+    clear = 1'b1;
+    @(posedge clk); #1;
+    clear = 1'b0;
+    stall = 1'b1;
+    base_hdd = pulsed[HDD];
+    done_hdd = done[HDD];
+    post_en[HDD] = 1'b1;
+    repeat (40) @(posedge clk);
+    #1;
+    post_en[HDD] = 1'b0;
+    repeat (4) @(posedge clk);
+    #1;
+    check_eq(pulsed[HDD] - base_hdd, 3, "drop: requests taken while stalled");
+    check_eq(clients[HDD].available, 0, "drop: HDD queue full");
+    shot_req[HDD] = shot_req[HDD] + 1;
+    drops_hdd = 1;
+    repeat (4) @(posedge clk);
+    take_snap();
+    check_eq(st_req[HDD], 3, "drop: requests accepted");
+    check_eq(st_drop[HDD], 1, "drop: requests dropped");
+    check_eq(st_req[MCU] + st_req[DISK] + st_drop[MCU] + st_drop[DISK], 0,
+             "drop: other clients untouched");
+    @(posedge clk); #1;
+    stall = 1'b0;
+    wait_idle();
+    check_eq(done[HDD] - done_hdd, 3, "drop: HDD completions");
+    repeat (50) @(posedge clk);
+    check_eq(issued, completed, "drop: dropped request never issued");
+
+    for (k = 0; k < 3; k = k + 1)
+      check_eq(data_bad[k], 0, "routing: beats to the owner with its data");
+    check_eq(overruns, 0, "controller: no pulse into a full slot");
+    check_eq(inflight_bad, 0, "controller: never a third request in flight");
+    check_eq(wdata_bad, 0, "controller: write data matches address");
+
+    if (fails != 0) begin
+      $display("=== FAILED: %0d checks ===", fails);
+      $fatal(1);
+    end
+    $display("=== PASSED ===");
+    $finish;
+  end
+
+  initial begin
+    #(5_000_000);
+    $display("[FAIL] timeout");
+    $fatal(1);
+  end
+endmodule
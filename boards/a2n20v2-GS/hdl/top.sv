@@ -228,6 +228,8 @@ module top #(
         .init_complete(sdram_init_complete_raw),
 
         .ports(mem_ports_sdram),       // 108 MHz side
+        .wide_wr_data_hi('0),         // no WIDE_WR_PORT on this board
+        .wide_wr_word_en('0),
 
         .SDRAM_DQ(IO_sdram_dq),
         .SDRAM_A(O_sdram_addr),
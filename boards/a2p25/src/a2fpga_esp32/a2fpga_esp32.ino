@@ -29,7 +29,9 @@
 #include <ctype.h>
 #include <stdlib.h>
 #include "driver/i2s_std.h"
+#include "esp_timer.h"
 #include "es5503.h"
+#include "es_audio.h"
 
 // ---------- Build-time options ----------
 #define USE_GDMA_ISR         0   // keep 0 unless your core exposes a reliable GDMA IRQ
@@ -83,6 +85,7 @@ bool usb_was_connected = false;
 // ---------- ES5503 Sound Chip ----------
 static ES5503* g_es5503 = nullptr;
 static volatile bool s_es5503_run = false; // Simple flag to enable/disable ES5503
+static volatile bool s_es5503_stereo = true; // DOC channel bit 0 picks L/R; false = mono mix
 static const uint32_t ES5503_SAMPLE_RATE = 44100;
 static const uint32_t ES5503_CLOCK_RATE = 7159090; // Apple IIgs clock rate
 static const size_t AUDIO_BUFFER_FRAMES = 512;
@@ -117,184 +120,160 @@ uint8_t* es5503_get_wave_memory(ES5503* es) {
 // but this happens before ESP32/LCAM is ready. ES5503 defaults to 32 oscillators.
 static const uint32_t I2S_OUTPUT_RATE = 44100;  // FPGA I2S sample rate
 
-// ---------- Audio Prebuffer (Ring Buffer) ----------
-// Purpose: Delay audio output by ~15ms to absorb LCAM latency.
-// Without this, register writes from IIgs arrive AFTER we've already
-// output silence for that time period, causing ~10ms gaps at note starts.
+// ---------- DOC Register-Write Queue ----------
+// The LCAM packet task must never wait for audio generation, and the I2S
+// task must never wait for a bus burst. DOC register writes are therefore
+// timestamped on arrival and handed over through a lock-free SPSC queue
+// (producer: packet task, consumer: I2S task). The I2S task renders each
+// block in segments and applies every queued write at the DOC sample that
+// matches its bus time, so register timing is sample-accurate instead of
+// block-granular.
 //
-// Buffer size: 2048 stereo frames = ~42ms at 48kHz (plenty of headroom)
-// Prebuffer target: 720 stereo frames = 15ms (must fill before output starts)
+// Render time runs s_audio_prebuffer_frames (~15ms) behind the wall clock:
+// a write may take that long to arrive through LCAM and still land on its
+// sample. A later write is applied at the start of the next block and
+// counted as late.
 //
-static const size_t AUDIO_RING_SIZE = 2048;      // stereo frames (2048 * 2 = 4096 int16_t)
-static size_t s_audio_prebuffer_frames = 720;    // ~15ms at 48kHz (adjustable via CLI)
-#define AUDIO_PREBUFFER_FRAMES s_audio_prebuffer_frames
-static int16_t s_audio_ring[AUDIO_RING_SIZE * 2]; // stereo samples
-static volatile size_t s_ring_write_pos = 0;      // next write position (in stereo frames)
-static volatile size_t s_ring_read_pos = 0;       // next read position (in stereo frames)
-static volatile bool s_ring_prebuffered = false;  // true once prebuffer threshold reached
-static volatile size_t s_ring_underruns = 0;      // count of underrun events
-static volatile uint32_t s_audio_gap_count = 0;   // count of silence gaps detected
-
-// Ring buffer helpers (single producer, single consumer - no locks needed)
-static inline size_t ring_available() {
-  size_t w = s_ring_write_pos;
-  size_t r = s_ring_read_pos;
-  if (w >= r) return w - r;
-  return AUDIO_RING_SIZE - r + w;
-}
-
-static inline size_t ring_free() {
-  return AUDIO_RING_SIZE - 1 - ring_available();  // -1 to distinguish full from empty
-}
-
-static void ring_write_stereo(int16_t left, int16_t right) {
-  size_t pos = s_ring_write_pos;
-  s_audio_ring[pos * 2] = left;
-  s_audio_ring[pos * 2 + 1] = right;
-  s_ring_write_pos = (pos + 1) % AUDIO_RING_SIZE;
-}
-
-static bool ring_read_stereo(int16_t *left, int16_t *right) {
-  if (ring_available() == 0) return false;
-  size_t pos = s_ring_read_pos;
-  *left = s_audio_ring[pos * 2];
-  *right = s_audio_ring[pos * 2 + 1];
-  s_ring_read_pos = (pos + 1) % AUDIO_RING_SIZE;
+// Wave RAM writes stay direct: a byte store the renderer only reads.
+static size_t s_audio_prebuffer_frames = 720;    // ~15ms write-apply delay (adjustable via CLI)
+
+static const uint32_t ES_WQ_SIZE = 1024;          // entries (power of two)
+struct EsWrite {
+  uint32_t t_us;                                  // esp_timer time of arrival
+  uint8_t  reg;
+  uint8_t  data;
+};
+static EsWrite  s_es_wq[ES_WQ_SIZE];
+static uint32_t s_es_wq_wr = 0;                   // written by the packet task only
+static uint32_t s_es_wq_rd = 0;                   // written by the I2S task only
+static uint32_t s_es_wq_hwm = 0;                  // deepest backlog seen
+static uint32_t s_es_wq_drops = 0;                // queue full: write lost
+static uint32_t s_es_wq_late = 0;                 // applied after their sample time
+static uint32_t s_es_render_resyncs = 0;          // render clock re-anchored to wall time
+
+static void es5503_apply_write(uint8_t reg, uint8_t data);
+
+// Packet task: enqueue and return. Never blocks.
+static bool es_wq_push(uint8_t reg, uint8_t data) {
+  uint32_t wr = s_es_wq_wr;
+  uint32_t used = wr - __atomic_load_n(&s_es_wq_rd, __ATOMIC_ACQUIRE);
+  if (used >= ES_WQ_SIZE) {
+    s_es_wq_drops++;
+    return false;
+  }
+  if (used + 1 > s_es_wq_hwm) s_es_wq_hwm = used + 1;
+  EsWrite &e = s_es_wq[wr & (ES_WQ_SIZE - 1)];
+  e.t_us = (uint32_t)esp_timer_get_time();
+  e.reg = reg;
+  e.data = data;
+  __atomic_store_n(&s_es_wq_wr, wr + 1, __ATOMIC_RELEASE);
   return true;
 }
 
-static void ring_reset() {
-  s_ring_write_pos = 0;
-  s_ring_read_pos = 0;
-  s_ring_prebuffered = false;
-  memset(s_audio_ring, 0, sizeof(s_audio_ring));
+// I2S task side
+static inline const EsWrite *es_wq_peek() {
+  uint32_t rd = s_es_wq_rd;
+  if (rd == __atomic_load_n(&s_es_wq_wr, __ATOMIC_ACQUIRE)) return nullptr;
+  return &s_es_wq[rd & (ES_WQ_SIZE - 1)];
 }
 
-// ---------- Catmull-Rom Cubic Interpolation ----------
-// Produces C1-continuous curves through sample points (no angular "jags")
-// Linear interpolation connects samples with straight lines → corners at each sample point
-// Cubic interpolation fits smooth curves → no corners, much less high-frequency aliasing
-// ym1, y0, y1, y2: four consecutive samples; t: fractional position 0-255 between y0 and y1
-static inline int16_t catmull_rom_interp(int32_t ym1, int32_t y0, int32_t y1, int32_t y2, uint32_t t) {
-    // Catmull-Rom: 0.5*(2*y0 + (-ym1+y1)*t + (2*ym1-5*y0+4*y1-y2)*t² + (-ym1+3*y0-3*y1+y2)*t³)
-    // Horner's form with t in 0-255 (8.8 fixed point fractional part):
-    int32_t c0 = 2 * y0;
-    int32_t c1 = -ym1 + y1;
-    int32_t c2 = 2*ym1 - 5*y0 + 4*y1 - y2;
-    int32_t c3 = -ym1 + 3*y0 - 3*y1 + y2;
-    int32_t r = c3;
-    r = c2 + ((r * (int32_t)t) >> 8);
-    r = c1 + ((r * (int32_t)t) >> 8);
-    r = c0 + ((r * (int32_t)t) >> 8);
-    r >>= 1;  // divide by 2 (from the 0.5 factor)
-    if (r > 32767) r = 32767;
-    if (r < -32768) r = -32768;
-    return (int16_t)r;
+static inline void es_wq_pop() {
+  __atomic_store_n(&s_es_wq_rd, s_es_wq_rd + 1, __ATOMIC_RELEASE);
 }
 
-// ---------- ES5503 Stream Update (MAME-style) ----------
-// Two triggers call es5503_stream_update():
-// 1. Timer trigger: I2S task needs audio (periodic)
-// 2. Write trigger: Register write arrived (before applying write)
-// Both generate samples since last update into the ring buffer.
-// This ensures audio state is captured BEFORE register changes take effect.
+// CLI register writes (loop task) take a second small SPSC queue, so the
+// packet task stays the only producer of s_es_wq and the DOC is only ever
+// written by the I2S task while it renders. They carry no bus time: the
+// I2S task applies them at the start of its next block (es_cq_apply).
+static const uint32_t ES_CQ_SIZE = 64;            // entries (power of two)
+static EsWrite  s_es_cq[ES_CQ_SIZE];
+static uint32_t s_es_cq_wr = 0;                   // written by the loop task only
+static uint32_t s_es_cq_rd = 0;                   // written by the I2S task only
+
+// I2S task side
+static void es_cq_apply() {
+  uint32_t rd = s_es_cq_rd;
+  uint32_t wr = __atomic_load_n(&s_es_cq_wr, __ATOMIC_ACQUIRE);
+  for (; rd != wr; rd++) {
+    const EsWrite &e = s_es_cq[rd & (ES_CQ_SIZE - 1)];
+    if (g_es5503) g_es5503->write(e.reg, e.data);
+  }
+  __atomic_store_n(&s_es_cq_rd, rd, __ATOMIC_RELEASE);
+}
 
-#include "freertos/semphr.h"
-static SemaphoreHandle_t s_es5503_mutex = NULL;
-static volatile uint64_t s_last_update_us = 0;  // micros() of last stream update
+// ---------- ES5503 Timed Render ----------
+// Bus time of the next DOC sample: s_render_us + s_render_frac / ES5503_RATE.
+// It advances by exactly one DOC sample period per sample rendered, so the
+// I2S clock paces it; it is re-anchored to (now - write-apply delay) only
+// when it has drifted a whole delay away (start-up, or after the I2S task
+// spent time in another audio mode).
 static const uint32_t ES5503_RATE = 26320;      // 7159090 / 8 / 34 for 32 oscillators
-static uint32_t s_es5503_frac_acc = 0;          // Fractional sample accumulator (sub-sample remainder)
-
-// Generate audio from last update until now, push to ring buffer
-// Called with mutex held
-static void es5503_stream_update_locked() {
-  if (!g_es5503 || !s_es5503_run) return;
-
-  uint64_t now_us = micros();
-  uint64_t elapsed_us = now_us - s_last_update_us;
-
-  // Avoid generating too much at once (cap at 50ms = ~2400 samples at 48kHz)
-  if (elapsed_us > 50000) {
-    elapsed_us = 50000;
-    s_es5503_frac_acc = 0;  // Reset accumulator on overflow
-  }
+static int64_t  s_render_us = 0;
+static uint32_t s_render_frac = 0;
+static volatile bool s_render_synced = false;   // cleared to re-anchor
+
+// Audio timing (I2S task)
+static volatile uint32_t s_i2s_underruns = 0;   // DMA ran dry (I2S send-queue overflow)
+static uint32_t s_render_blocks = 0;
+static uint64_t s_render_us_sum = 0;            // block render time (generate+upsample+LPF)
+static uint32_t s_render_us_max = 0;
+
+static int64_t es_apply_delay_us() {
+  return (int64_t)s_audio_prebuffer_frames * 1000000 / I2S_OUTPUT_RATE;
+}
 
-  // Calculate samples to generate at ES5503 rate using fractional accumulator
-  // Without this, integer truncation loses ~2 samples per cycle, causing
-  // the ring buffer to slowly drain and underrun every ~2.7 seconds.
-  // Example: 10670us * 26320 = 280,830,400 / 1000000 = 280.83 → 280 (lost 0.83)
-  // With accumulator: remainder carries forward, no samples lost over time.
-  uint64_t total_frac = (uint64_t)elapsed_us * ES5503_RATE + s_es5503_frac_acc;
-  uint32_t es5503_samples = total_frac / 1000000;
-  uint32_t new_frac = total_frac % 1000000;
-  if (es5503_samples == 0) return;
-
-  // Cap to avoid overflow
-  if (es5503_samples > 512) es5503_samples = 512;
-
-  // Check ring buffer space (need ~1.82x for upsampling)
-  uint32_t output_samples = (es5503_samples * I2S_OUTPUT_RATE) / ES5503_RATE;
-  if (output_samples > ring_free()) {
-    output_samples = ring_free();
-    es5503_samples = (output_samples * ES5503_RATE) / I2S_OUTPUT_RATE;
-  }
-  if (es5503_samples == 0) return;
-
-  // Commit the fractional accumulator now that we know we'll generate
-  s_es5503_frac_acc = new_frac;
-
-  // Generate ES5503 samples
-  static int16_t es5503_temp[512];
-  g_es5503->generate_audio(es5503_temp, es5503_samples);
-
-  // Upsample with Catmull-Rom cubic interpolation for smooth curves through sample points
-  // Cubic interpolation eliminates the angular "jags" at ES5503 sample boundaries
-  // that linear interpolation creates (connects with straight lines → corners)
-  static int16_t s_ring_prev_sample = 0;  // Last ES5503 sample from previous chunk
-  for (uint32_t i = 0; i < output_samples; i++) {
-    uint32_t pos_fixed = (i * es5503_samples * 256) / output_samples;  // 8.8 fixed point
-    uint32_t es5503_idx = pos_fixed >> 8;
-    uint32_t frac = pos_fixed & 0xFF;
-    if (es5503_idx >= es5503_samples) es5503_idx = es5503_samples - 1;
-
-    // Four samples for cubic interpolation: ym1, y0, y1, y2
-    int32_t ym1 = (es5503_idx > 0) ? es5503_temp[es5503_idx - 1] : s_ring_prev_sample;
-    int32_t y0  = es5503_temp[es5503_idx];
-    int32_t y1  = (es5503_idx + 1 < es5503_samples) ? es5503_temp[es5503_idx + 1] : y0;
-    int32_t y2  = (es5503_idx + 2 < es5503_samples) ? es5503_temp[es5503_idx + 2] : y1;
-
-    int16_t sample = catmull_rom_interp(ym1, y0, y1, y2, frac);
-    ring_write_stereo(sample, sample);
+// Render n DOC sample frames (ch interleaved channels), applying queued
+// writes at their sample positions.
+static void es_render_block(int16_t *out, uint32_t n, int ch) {
+  es_cq_apply();
+  int64_t delay = es_apply_delay_us();
+  int64_t target = esp_timer_get_time() - delay;
+  int64_t err = target - s_render_us;
+  if (!s_render_synced || err > delay || err < -delay) {
+    if (s_render_synced) s_es_render_resyncs++;
+    s_render_us = target;
+    s_render_frac = 0;
+    s_render_synced = true;
   }
-  if (es5503_samples > 0) s_ring_prev_sample = es5503_temp[es5503_samples - 1];
 
-  // Check prebuffer threshold
-  if (!s_ring_prebuffered && ring_available() >= AUDIO_PREBUFFER_FRAMES) {
-    s_ring_prebuffered = true;
+  uint32_t pos = 0;
+  const EsWrite *e;
+  while ((e = es_wq_peek()) != nullptr) {
+    // first sample k with bus time >= the write's: k * 1e6 >= d * RATE - frac
+    int32_t d = (int32_t)(e->t_us - (uint32_t)s_render_us);
+    int64_t num = (int64_t)d * ES5503_RATE - s_render_frac;
+    uint32_t k = 0;
+    if (num > 0) {
+      int64_t kk = (num + 999999) / 1000000;
+      if (kk >= n) break;                       // belongs to a later block
+      k = (uint32_t)kk;
+    } else if (num < 0) {
+      s_es_wq_late++;
+    }
+    if (k > pos) {
+      g_es5503->generate_audio(out + pos * ch, k - pos);
+      pos = k;
+    }
+    es5503_apply_write(e->reg, e->data);
+    es_wq_pop();
   }
+  if (pos < n) g_es5503->generate_audio(out + pos * ch, n - pos);
 
-  s_last_update_us = now_us;
+  uint64_t total = (uint64_t)s_render_frac + (uint64_t)n * 1000000u;
+  s_render_us += total / ES5503_RATE;
+  s_render_frac = total % ES5503_RATE;
 }
 
-// Public function: generate audio up to now (acquires mutex)
-// Used by I2S task - waits for mutex since I2S needs audio
-static void es5503_stream_update() {
-  if (!s_es5503_mutex) return;
-  if (xSemaphoreTake(s_es5503_mutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-    es5503_stream_update_locked();
-    xSemaphoreGive(s_es5503_mutex);
+// Outside the ES5503 branch (tone/radio/test/silence) nothing renders: apply
+// whatever arrived so the DOC state keeps up, and re-anchor on return.
+static void es_wq_apply_all() {
+  es_cq_apply();
+  const EsWrite *e;
+  while ((e = es_wq_peek()) != nullptr) {
+    if (g_es5503) es5503_apply_write(e->reg, e->data);
+    es_wq_pop();
   }
-}
-
-// Non-blocking version for write trigger - skip if mutex busy
-// If I2S task has mutex, it will generate audio anyway
-static void es5503_stream_update_nonblocking() {
-  if (!s_es5503_mutex) return;
-  if (xSemaphoreTake(s_es5503_mutex, 0) == pdTRUE) {
-    es5503_stream_update_locked();
-    xSemaphoreGive(s_es5503_mutex);
-  }
-  // If mutex busy, skip - I2S task will handle generation
+  s_render_synced = false;
 }
 
 // ---------- I2S (slave TX for ES5503 audio, 16-bit stereo) ----------
@@ -306,9 +285,29 @@ bool i2s_tx_is_running() {
   return (s_i2s_tx != NULL && s_i2s_run);
 }
 
+// Loop task. Before the I2S task exists nothing renders, so write directly;
+// after, wait for room rather than drop a command's write.
+static void es_cli_write(uint8_t reg, uint8_t data) {
+  if (!g_es5503) return;
+  if (!s_i2s_task) {
+    g_es5503->write(reg, data);
+    return;
+  }
+  uint32_t wr = s_es_cq_wr;
+  while (wr - __atomic_load_n(&s_es_cq_rd, __ATOMIC_ACQUIRE) >= ES_CQ_SIZE)
+    vTaskDelay(1);
+  EsWrite &e = s_es_cq[wr & (ES_CQ_SIZE - 1)];
+  e.reg = reg;
+  e.data = data;
+  __atomic_store_n(&s_es_cq_wr, wr + 1, __ATOMIC_RELEASE);
+}
+
 static void i2s_tx_task(void *arg) {
   while (s_i2s_run) {
     size_t written = 0;
+    bool es_mode = !A2FPGATone::isActive() && !A2FPGARadio::isActive() &&
+                   !s_i2s_test_mode && g_es5503 && s_es5503_run && s_i2s_tx;
+    if (!es_mode) es_wq_apply_all();
     // Tone generator mode (highest priority for debugging)
     if (A2FPGATone::isActive()) {
       static int16_t mono_buffer[AUDIO_BUFFER_FRAMES];
@@ -353,108 +352,42 @@ static void i2s_tx_task(void *arg) {
         vTaskDelay(pdMS_TO_TICKS(5));
       }
     }
-    // ES5503 with direct I2S generation + MAME-style write trigger
-    // The I2S task generates exactly AUDIO_BUFFER_FRAMES output samples per iteration,
-    // eliminating clock drift between ESP32 micros() and FPGA I2S clock.
-    // Write trigger still pushes pre-write audio to ring buffer for MAME-style sync.
-    // I2S task drains ring buffer first (pre-write audio), then generates remainder directly.
+    // ES5503: the I2S task generates exactly AUDIO_BUFFER_FRAMES output
+    // samples per iteration (paced by the FPGA I2S clock, so no drift against
+    // micros()), rendering the DOC block with queued register writes applied
+    // at their sample positions (es_render_block). Left and right are
+    // resampled and filtered separately; in mono mode L is copied to R.
     else if (g_es5503 && s_es5503_run && s_i2s_tx) {
       static int16_t stereo_buffer[AUDIO_BUFFER_FRAMES * 2];
       static int debug_interval = 0;
       static uint32_t s_i2s_es_frac = 0;  // Fractional ES5503 sample accumulator for I2S
-      static size_t s_last_from_ring = 0;  // For debug logging
-
-      if (xSemaphoreTake(s_es5503_mutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-        // Step 1: Drain any write-trigger samples from ring buffer
-        // These are pre-write audio samples (MAME-style: captured before register change)
-        size_t from_ring = ring_available();
-        if (from_ring > AUDIO_BUFFER_FRAMES) from_ring = AUDIO_BUFFER_FRAMES;
-        for (size_t i = 0; i < from_ring; i++) {
-          int16_t left, right;
-          ring_read_stereo(&left, &right);
-          stereo_buffer[i * 2] = left;
-          stereo_buffer[i * 2 + 1] = right;
-        }
+      static EsUpsampler s_upsampler = {};
+      static EsBiquad s_lpf = {};
+      int64_t t_start = esp_timer_get_time();
 
-        // Step 2: Generate remaining samples directly (post-write audio)
-        size_t remaining = AUDIO_BUFFER_FRAMES - from_ring;
-        if (remaining > 0) {
-          // Calculate ES5503 samples with fractional accumulator (no truncation drift)
-          uint64_t total = (uint64_t)remaining * ES5503_RATE + s_i2s_es_frac;
-          uint32_t es5503_needed = total / I2S_OUTPUT_RATE;
-          s_i2s_es_frac = total % I2S_OUTPUT_RATE;
-
-          if (es5503_needed > 0 && es5503_needed <= 512) {
-            static int16_t es5503_temp[512];
-            g_es5503->generate_audio(es5503_temp, es5503_needed);
-
-            // Upsample with Catmull-Rom cubic interpolation
-            static int16_t s_direct_prev_sample = 0;
-            for (uint32_t i = 0; i < remaining; i++) {
-              uint32_t pos_fixed = (i * es5503_needed * 256) / remaining;
-              uint32_t idx = pos_fixed >> 8;
-              uint32_t frac = pos_fixed & 0xFF;
-              if (idx >= es5503_needed) idx = es5503_needed - 1;
-
-              int32_t ym1 = (idx > 0) ? es5503_temp[idx - 1] : s_direct_prev_sample;
-              int32_t y0  = es5503_temp[idx];
-              int32_t y1  = (idx + 1 < es5503_needed) ? es5503_temp[idx + 1] : y0;
-              int32_t y2  = (idx + 2 < es5503_needed) ? es5503_temp[idx + 2] : y1;
-
-              int16_t sample = catmull_rom_interp(ym1, y0, y1, y2, frac);
-              size_t buf_idx = (from_ring + i) * 2;
-              stereo_buffer[buf_idx] = sample;
-              stereo_buffer[buf_idx + 1] = sample;
-            }
-            s_direct_prev_sample = es5503_temp[es5503_needed - 1];
-          } else if (es5503_needed == 0) {
-            // Fractional accumulator hasn't reached a whole sample yet - fill with last value
-            int16_t fill = (from_ring > 0) ? stereo_buffer[(from_ring - 1) * 2] : 0;
-            for (size_t i = from_ring; i < AUDIO_BUFFER_FRAMES; i++) {
-              stereo_buffer[i * 2] = fill;
-              stereo_buffer[i * 2 + 1] = fill;
-            }
-          }
-        }
+      // Channel count only changes here, between renders
+      int ch = s_es5503_stereo ? 2 : 1;
+      if (g_es5503->get_channels() != ch) g_es5503->set_channels(ch);
 
-        // Update timestamp so write trigger knows "now"
-        s_last_update_us = micros();
-        s_es5503_frac_acc = 0;  // Reset time-based accumulator
-        s_last_from_ring = from_ring;
+      // ES5503 samples for this block, with fractional accumulator (no truncation drift)
+      uint64_t total = (uint64_t)AUDIO_BUFFER_FRAMES * ES5503_RATE + s_i2s_es_frac;
+      uint32_t es5503_needed = total / I2S_OUTPUT_RATE;
+      s_i2s_es_frac = total % I2S_OUTPUT_RATE;
 
-        xSemaphoreGive(s_es5503_mutex);
-      } else {
-        // Couldn't acquire mutex - output silence
-        memset(stereo_buffer, 0, sizeof(stereo_buffer));
-      }
+      static int16_t es5503_temp[512 * 2];
+      es_render_block(es5503_temp, es5503_needed, ch);
 
-      // Anti-aliasing 2-pole biquad LPF (Butterworth, fc=10kHz at 44.1kHz)
-      // 12dB/octave rolloff (vs 6dB for 1-pole) - much better alias rejection
-      // ES5503 Nyquist is 13.16kHz; this filter removes spectral images from upsampling
-      // while preserving all audible content below 10kHz
-      // Q14 fixed-point coefficients (precomputed from bilinear transform):
-      //   b = [0.25029, 0.50058, 0.25029], a = [1, -0.17595, 0.17709]
-      {
-        static const int32_t B0 = 4101, B1 = 8201, B2 = 4101;  // Q14
-        static const int32_t A1 = -2882, A2 = 2901;             // Q14
-        static int32_t bq_x1 = 0, bq_x2 = 0;  // input history
-        static int32_t bq_y1 = 0, bq_y2 = 0;  // output history
-
-        for (size_t i = 0; i < AUDIO_BUFFER_FRAMES; i++) {
-          int32_t x0 = stereo_buffer[i * 2];  // mono - both channels identical
-          // y[n] = (b0*x[n] + b1*x[n-1] + b2*x[n-2] - a1*y[n-1] - a2*y[n-2]) >> 14
-          int32_t y0 = (B0*x0 + B1*bq_x1 + B2*bq_x2 - A1*bq_y1 - A2*bq_y2) >> 14;
-          bq_x2 = bq_x1;
-          bq_x1 = x0;
-          bq_y2 = bq_y1;
-          bq_y1 = y0;
-          int16_t out = (y0 > 32767) ? 32767 : (y0 < -32768) ? -32768 : (int16_t)y0;
-          stereo_buffer[i * 2] = out;
-          stereo_buffer[i * 2 + 1] = out;
-        }
-      }
+      // Upsample with Catmull-Rom cubic interpolation, then the 10kHz
+      // anti-aliasing biquad (es_audio.h)
+      es_upsample(&s_upsampler, es5503_temp, es5503_needed, ch, stereo_buffer, AUDIO_BUFFER_FRAMES);
+      es_lpf(&s_lpf, stereo_buffer, AUDIO_BUFFER_FRAMES, ch);
+
+      uint32_t render_us = (uint32_t)(esp_timer_get_time() - t_start);
+      s_render_blocks++;
+      s_render_us_sum += render_us;
+      if (render_us > s_render_us_max) s_render_us_max = render_us;
 
-      // Always write to I2S (exactly AUDIO_BUFFER_FRAMES - no underruns possible)
+      // Always write to I2S (exactly AUDIO_BUFFER_FRAMES per block)
       esp_err_t err = i2s_channel_write(s_i2s_tx, stereo_buffer, sizeof(stereo_buffer), &written, pdMS_TO_TICKS(10));
       if (err != ESP_OK) {
         vTaskDelay(pdMS_TO_TICKS(5));
@@ -462,10 +395,11 @@ static void i2s_tx_task(void *arg) {
 
       // Debug logging
       if (++debug_interval >= 50) {
-        Serial.printf("ES5503: from_ring=%d direct=%d underruns=%lu\n",
-                      (int)s_last_from_ring,
-                      (int)(AUDIO_BUFFER_FRAMES - s_last_from_ring),
-                      (unsigned long)s_ring_underruns);
+        Serial.printf("ES5503: render=%luus queue=%lu late=%lu underruns=%lu\n",
+                      (unsigned long)render_us,
+                      (unsigned long)(s_es_wq_wr - s_es_wq_rd),
+                      (unsigned long)s_es_wq_late,
+                      (unsigned long)s_i2s_underruns);
         debug_interval = 0;
       }
     } else if (s_i2s_tx) {
@@ -488,6 +422,11 @@ static void i2s_tx_task(void *arg) {
   vTaskDelete(NULL);
 }
 
+static bool IRAM_ATTR i2s_on_send_q_ovf(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx) {
+  s_i2s_underruns++;
+  return false;
+}
+
 static esp_err_t i2s_tx_setup_once() {
   if (s_i2s_tx) return ESP_OK;
 
@@ -539,6 +478,10 @@ static esp_err_t i2s_tx_setup_once() {
     i2s_del_channel(tx);
     return err;
   }
+  // Count DMA underruns (the send queue ran dry and old data was replayed).
+  i2s_event_callbacks_t cbs = {};
+  cbs.on_send_q_ovf = i2s_on_send_q_ovf;
+  i2s_channel_register_event_callback(tx, &cbs, NULL);
   s_i2s_tx = tx;
   return ESP_OK;
 }
@@ -579,7 +522,7 @@ static esp_err_t es5503_init() {
     return ESP_ERR_NO_MEM;
   }
   
-  g_es5503->set_channels(1);  // Mono output (avoid stereo channel assignment issues)
+  g_es5503->set_channels(s_es5503_stereo ? 2 : 1);  // DOC channel bit 0: 0 = left, 1 = right
   g_es5503->set_output_sample_rate(ES5503_SAMPLE_RATE);  // Set I2S output rate for correct pitch
 
   // Show where memory was allocated
@@ -600,19 +543,8 @@ static esp_err_t es5503_start() {
   esp_err_t err = es5503_init();
   if (err != ESP_OK) return err;
 
-  // Initialize mutex for ES5503 thread safety (write handler + I2S task)
-  if (!s_es5503_mutex) {
-    s_es5503_mutex = xSemaphoreCreateMutex();
-    if (!s_es5503_mutex) {
-      Serial.println("Failed to create ES5503 mutex");
-      return ESP_ERR_NO_MEM;
-    }
-  }
-
-  // Reset the audio ring buffer and timing
-  ring_reset();
-  s_last_update_us = micros();
-  s_es5503_frac_acc = 0;
+  // Re-anchor the render clock on the next block
+  s_render_synced = false;
 
   s_es5503_run = true;
   // Ensure I2S is running to play ES5503 audio
@@ -686,8 +618,9 @@ static int s_read_packet_count = 0;
 static int s_es5503_packet_count = 0;      // Packets in ES5503 range
 static int s_corrupted_packet_count = 0;   // Packets outside ES5503 range (excluding heartbeat)
 static uint32_t s_glu_read_auto_inc = 0;   // GLU address auto-increments triggered by reads
-static uint32_t s_mutex_ok_count = 0;      // DOC writes that acquired mutex
-static uint32_t s_mutex_fail_count = 0;    // DOC writes that hit fallback (unprotected)
+static uint32_t s_es_write_calls = 0;      // ES5503 writes handled by the packet task
+static uint64_t s_es_write_us_sum = 0;     // ...time spent in them (packet-task stall)
+static uint32_t s_es_write_us_max = 0;
 
 // Control register write diagnostics (0xA0-0xBF)
 static uint32_t s_ctrl_write_count = 0;    // Total control register writes
@@ -756,6 +689,48 @@ static void es5503_print_monitor() {
   s_es5503_mon_last_ms = now;
 }
 
+// Apply one DOC register write (I2S task, between render segments). The
+// emulator state here is exact at the write's sample, so the transition
+// diagnostics and the ONESHOT/SWAP key-on fix see what the bus write meant.
+static void es5503_apply_write(uint8_t reg, uint8_t data) {
+  if (reg >= 0xA0 && reg <= 0xBF) {
+    int osc = reg & 0x1F;
+    uint8_t cur_ctrl = g_es5503->get_osc_control(osc);
+    bool cur_halt = (cur_ctrl & 1);
+    bool new_halt = (data & 1);
+    int cur_mode = (cur_ctrl >> 1) & 3;
+
+    s_ctrl_write_count++;
+    // Track transition type (using actual emulator state, not s_prev_control)
+    if (!cur_halt && !new_halt) s_ctrl_h0_to_h0++;
+    else if (!cur_halt && new_halt) s_ctrl_h0_to_h1++;
+    else if (cur_halt && !new_halt) s_ctrl_h1_to_h0++;
+    else s_ctrl_h1_to_h1++;
+    // Track mode of oscillator at time of write
+    switch (cur_mode) {
+      case 0: s_ctrl_mode_free++; break;
+      case 1: s_ctrl_mode_once++; break;
+      case 2: s_ctrl_mode_sync++; break;
+      case 3: s_ctrl_mode_swap++; break;
+    }
+
+    // Targeted force-halt for clock domain mismatch compensation.
+    // For ONESHOT/SWAP: if both shadow and new have halt=0, force halt
+    // so MAME key-on check (halt=1→halt=0) triggers correctly.
+    if (!new_halt && !cur_halt) {
+      if (cur_mode == 1 || cur_mode == 3) {  // ONESHOT or SWAP
+        g_es5503->force_osc_halt(osc);
+        s_force_halt_count++;
+        if (s_es5503_mon) {
+          Serial.printf("[KEY-FIX] Osc %d force-halt (mode=%s, shadow lagged)\n",
+                        osc, cur_mode == 1 ? "ONCE" : "SWAP");
+        }
+      }
+    }
+  }
+  g_es5503->write(reg, data);
+}
+
 // Handle Sound GLU and ES5503 writes from bus packet
 static void handle_es5503_write(uint16_t address, uint8_t data) {
   if (!g_es5503) return;
@@ -783,21 +758,7 @@ static void handle_es5503_write(uint16_t address, uint8_t data) {
       // Write to DOC register (low byte of address pointer is register number)
       uint8_t reg = s_glu.address_ptr & 0xFF;
 
-      // CRITICAL: All g_es5503->write() calls MUST be protected by the ES5503
-      // mutex. Without this, update_stream() in the I2S task can read
-      // pOsc->control into a local 'ctrl' variable, then we write a new value
-      // via g_es5503->write(), then update_stream() writes back its stale 'ctrl'
-      // — overwriting our change. This causes:
-      //   - Un-halts overwritten → sounds don't play
-      //   - Halts overwritten → tones don't stop
-      //
-      // For control registers (0xA0-0xBF) and E1, we also do the MAME-style
-      // stream update inside the same critical section so the audio state is
-      // captured BEFORE the register change, atomically.
-
-      bool needs_sync = (reg >= 0xA0 && reg <= 0xBF) || (reg == 0xE1);
-
-      // Track key-on events (outside mutex - just bookkeeping)
+      // Track key-on events (bus view - just bookkeeping)
       if (reg >= 0xA0 && reg <= 0xBF) {
         int osc = reg & 0x1F;
         uint8_t prev = s_prev_control[osc];
@@ -816,63 +777,8 @@ static void handle_es5503_write(uint16_t address, uint8_t data) {
         s_prev_control[osc] = data;
       }
 
-      // Acquire mutex: stream update (if needed) + write are atomic.
-      // Use generous timeout (50ms). The I2S task holds the mutex for ~1ms.
-      // If we can't get it in 50ms, something is very wrong, but we still
-      // apply the write rather than permanently desyncing the shadow.
-      if (s_es5503_mutex && xSemaphoreTake(s_es5503_mutex, pdMS_TO_TICKS(50)) == pdTRUE) {
-        if (needs_sync) {
-          es5503_stream_update_locked();
-        }
-
-        // Diagnostic: track control register write transitions and modes.
-        // This tells us what modes the IIgs uses and whether key-on
-        // detection works correctly.
-        if (reg >= 0xA0 && reg <= 0xBF) {
-          int osc = reg & 0x1F;
-          uint8_t cur_ctrl = g_es5503->get_osc_control(osc);
-          bool cur_halt = (cur_ctrl & 1);
-          bool new_halt = (data & 1);
-          int cur_mode = (cur_ctrl >> 1) & 3;
-
-          s_ctrl_write_count++;
-          // Track transition type (using actual emulator state, not s_prev_control)
-          if (!cur_halt && !new_halt) s_ctrl_h0_to_h0++;
-          else if (!cur_halt && new_halt) s_ctrl_h0_to_h1++;
-          else if (cur_halt && !new_halt) s_ctrl_h1_to_h0++;
-          else s_ctrl_h1_to_h1++;
-          // Track mode of oscillator at time of write
-          switch (cur_mode) {
-            case 0: s_ctrl_mode_free++; break;
-            case 1: s_ctrl_mode_once++; break;
-            case 2: s_ctrl_mode_sync++; break;
-            case 3: s_ctrl_mode_swap++; break;
-          }
-
-          // Targeted force-halt for clock domain mismatch compensation.
-          // For ONESHOT/SWAP: if both shadow and new have halt=0, force halt
-          // so MAME key-on check (halt=1→halt=0) triggers correctly.
-          if (!new_halt && !cur_halt) {
-            if (cur_mode == 1 || cur_mode == 3) {  // ONESHOT or SWAP
-              g_es5503->force_osc_halt(osc);
-              s_force_halt_count++;
-              if (s_es5503_mon) {
-                Serial.printf("[KEY-FIX] Osc %d force-halt (mode=%s, shadow lagged)\n",
-                              osc, cur_mode == 1 ? "ONCE" : "SWAP");
-              }
-            }
-          }
-        }
-
-        g_es5503->write(reg, data);
-        xSemaphoreGive(s_es5503_mutex);
-        s_mutex_ok_count++;
-      } else {
-        // Mutex unavailable after 50ms — still apply the write. A brief race
-        // is better than permanently losing a register write.
-        g_es5503->write(reg, data);
-        s_mutex_fail_count++;
-      }
+      // The I2S task applies it at its sample position (es5503_apply_write).
+      es_wq_push(reg, data);
 
       s_es5503_reg_writes++;
       s_es_last[s_es_last_idx % ES_LOG_N] = {address, data, true, reg};
@@ -1020,7 +926,12 @@ void process_bus_packet(uint32_t packet) {
       if (s_glu.doc_access) s_es_w_c03d_doc++; else s_es_w_c03d_ram++;
     } else if (address == 0xC03E) s_es_w_c03e++;
     else if (address == 0xC03F) s_es_w_c03f++;
+    int64_t t0 = esp_timer_get_time();
     handle_es5503_write(address, data);
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    s_es_write_calls++;
+    s_es_write_us_sum += us;
+    if (us > s_es_write_us_max) s_es_write_us_max = us;
   }
 }
 
@@ -1378,7 +1289,7 @@ static void cmd_process(String cmd) {
       // Halt all 32 oscillators by setting their control bit 0 to 1
       for (int osc = 0; osc < 32; osc++) {
         uint8_t current_control = g_es5503->read(0xA0 + osc);
-        g_es5503->write(0xA0 + osc, current_control | 0x01);  // Set halt bit
+        es_cli_write(0xA0 + osc, current_control | 0x01);  // Set halt bit
       }
       Serial.println("All ES5503 audio generation stopped (all oscillators halted)");
     }
@@ -1425,7 +1336,7 @@ static void cmd_process(String cmd) {
       if (num_oscs < 1 || num_oscs > 32) {
         Serial.println("Number of oscillators must be 1-32");
       } else {
-        g_es5503->write(0xE0, (uint8_t)(num_oscs - 1));  // E0 register: num_oscs - 1
+        es_cli_write(0xE0, (uint8_t)(num_oscs - 1));  // E0 register: num_oscs - 1
         Serial.printf("ES5503 audio enabled with %ld oscillators\n", num_oscs);
       }
     }
@@ -1478,14 +1389,15 @@ static void cmd_process(String cmd) {
       // Set up oscillator 0 for A440 (440 Hz)
       // ES5503 frequency calculation: freq_reg = (target_freq * 65536) / sample_rate
       // For 440 Hz at 44100 Hz sample rate: (440 * 65536) / 44100 = 654 = 0x028E
-      g_es5503->write(0x00, 0x8E);    // freq lo = 0x8E
-      g_es5503->write(0x20, 0x02);    // freq hi = 0x02 (0x028E = A440 @ 44.1kHz)
-      g_es5503->write(0x40, 0x80);    // volume = 0x80 (medium)
-      g_es5503->write(0x80, 0x00);    // wavetable pointer = 0x0000
-      g_es5503->write(0xC0, 0x20);    // wavetable size = 4096 (bits 5-3 = 100), resolution = 0
-      g_es5503->write(0xE1, 0x01);    // enable 1 oscillator (E1 = number of oscillators)
-      g_es5503->write(0xA0, 0x00);    // control = 0x00 (FREE mode, channel 0, running, explicit)
-      
+      es_cli_write(0x00, 0x8E);    // freq lo = 0x8E
+      es_cli_write(0x20, 0x02);    // freq hi = 0x02 (0x028E = A440 @ 44.1kHz)
+      es_cli_write(0x40, 0x80);    // volume = 0x80 (medium)
+      es_cli_write(0x80, 0x00);    // wavetable pointer = 0x0000
+      es_cli_write(0xC0, 0x20);    // wavetable size = 4096 (bits 5-3 = 100), resolution = 0
+      es_cli_write(0xE1, 0x01);    // enable 1 oscillator (E1 = number of oscillators)
+      es_cli_write(0xA0, 0x00);    // control = 0x00 (FREE mode, channel 0, running, explicit)
+      vTaskDelay(pdMS_TO_TICKS(20));  // let the I2S task apply them
+
       // Verify the oscillator configuration
       uint8_t control_readback = g_es5503->read(0xA0);
       uint8_t mode = control_readback & 0x03;
@@ -1531,16 +1443,19 @@ static void cmd_process(String cmd) {
       uint8_t num_osc = g_es5503->read(0xE1);
       Serial.printf("  ES5503: %d oscillators enabled\n", (num_osc/2) + 1);
     }
-    // Ring buffer status
-    Serial.println("  Audio Ring Buffer:");
-    Serial.printf("    Size: %d frames (%dms capacity)\n",
-                  (int)AUDIO_RING_SIZE, (int)(AUDIO_RING_SIZE * 1000 / I2S_OUTPUT_RATE));
-    Serial.printf("    Prebuffer: %d frames (%dms latency)\n",
-                  (int)AUDIO_PREBUFFER_FRAMES, (int)(AUDIO_PREBUFFER_FRAMES * 1000 / I2S_OUTPUT_RATE));
-    Serial.printf("    Available: %d frames\n", (int)ring_available());
-    Serial.printf("    Prebuffered: %s\n", s_ring_prebuffered ? "YES" : "NO");
-    Serial.printf("    Underruns: %d\n", (int)s_ring_underruns);
-    Serial.printf("    Gaps detected: %lu\n", (unsigned long)s_audio_gap_count);
+    // DOC write queue + render timing
+    Serial.println("  DOC Write Queue:");
+    Serial.printf("    Apply delay: %d frames (%dms)\n",
+                  (int)s_audio_prebuffer_frames, (int)(s_audio_prebuffer_frames * 1000 / I2S_OUTPUT_RATE));
+    Serial.printf("    Pending: %lu  HWM: %lu/%lu  Drops: %lu  Late: %lu  Resyncs: %lu\n",
+                  (unsigned long)(s_es_wq_wr - s_es_wq_rd), (unsigned long)s_es_wq_hwm,
+                  (unsigned long)ES_WQ_SIZE, (unsigned long)s_es_wq_drops,
+                  (unsigned long)s_es_wq_late, (unsigned long)s_es_render_resyncs);
+    Serial.printf("    Render: %lu us avg / %lu us max per %d-frame block (%lu us budget)\n",
+                  (unsigned long)(s_render_blocks ? s_render_us_sum / s_render_blocks : 0),
+                  (unsigned long)s_render_us_max, (int)AUDIO_BUFFER_FRAMES,
+                  (unsigned long)(AUDIO_BUFFER_FRAMES * 1000000ull / I2S_OUTPUT_RATE));
+    Serial.printf("    Underruns: %lu\n", (unsigned long)s_i2s_underruns);
   } else if (cmd.startsWith("prebuffer ")) {
     // Adjust audio prebuffer size: prebuffer <ms>
     String toks[8]; int nt = split_ws(cmd, toks, 8);
@@ -1555,13 +1470,9 @@ static void cmd_process(String cmd) {
         Serial.println("Prebuffer must be 5-40ms");
       } else {
         size_t frames = (ms * I2S_OUTPUT_RATE) / 1000;
-        if (frames >= AUDIO_RING_SIZE - 512) {
-          frames = AUDIO_RING_SIZE - 512;  // Leave room for generation
-        }
         s_audio_prebuffer_frames = frames;
-        ring_reset();  // Reset buffer to apply new setting
-        s_es5503_frac_acc = 0;
-        Serial.printf("Prebuffer set to %ldms (%d frames). Ring buffer reset.\n",
+        s_render_synced = false;  // Re-anchor the render clock to the new delay
+        Serial.printf("Prebuffer set to %ldms (%d frames). Render clock re-anchored.\n",
                       ms, (int)frames);
       }
     }
@@ -1595,11 +1506,68 @@ static void cmd_process(String cmd) {
         uint32_t v; String valS = normalize_hex(toks[2]); if (!parse_u32(valS, v) || v > 0xFF) {
           Serial.println("es5503reg: invalid <value> (0..255)");
         } else {
-          g_es5503->write((uint16_t)reg, (uint8_t)v);
+          es_cli_write((uint8_t)reg, (uint8_t)v);
           Serial.printf("ES5503[0x%02X] <= 0x%02X\n", (unsigned)reg, (unsigned)v);
         }
       }
     }
+  } else if (cmd == "es5503stereo" || cmd.startsWith("es5503stereo ")) {
+    // Stereo (DOC channel bit 0 selects L/R) or mono mix of all voices
+    String arg = cmd.length() > 13 ? cmd.substring(13) : String("");
+    arg.trim();
+    if (arg == "on") s_es5503_stereo = true;
+    else if (arg == "off") s_es5503_stereo = false;
+    else if (arg.length()) Serial.println("Usage: es5503stereo [on|off]");
+    Serial.printf("ES5503 output: %s\n", s_es5503_stereo ? "stereo (channel 0 = L, 1 = R)" : "mono");
+  } else if (cmd == "es5503bench") {
+    // Renderer cost per I2S block at 8/16/32 active voices, on a scratch
+    // DOC with its own wave RAM (the live one is not touched)
+    ES5503 *doc = ES5503::create_with_memory(ES5503_CLOCK_RATE);
+    if (!doc) {
+      Serial.println("es5503bench: out of memory");
+    } else {
+      uint8_t *wave = doc->get_wave_memory();
+      for (int i = 0; i < 65536; i++) {
+        wave[i] = (uint8_t)(128.0f + 100.0f * sinf((2.0f * 3.14159265359f * i) / 256.0f));  // never 0x00
+      }
+      const uint32_t frames = (uint32_t)((uint64_t)AUDIO_BUFFER_FRAMES * ES5503_RATE / I2S_OUTPUT_RATE);
+      const uint32_t budget = (uint32_t)((uint64_t)AUDIO_BUFFER_FRAMES * getCpuFrequencyMhz() * 1000000ull / I2S_OUTPUT_RATE);
+      static int16_t out[512 * 2];
+      Serial.printf("es5503bench: %lu DOC frames per %d-frame block, %lu cycles budget\n",
+                    (unsigned long)frames, (int)AUDIO_BUFFER_FRAMES, (unsigned long)budget);
+      const int counts[3] = {8, 16, 32};
+      for (int ch = 1; ch <= 2; ch++) {
+        doc->set_channels(ch);
+        for (int t = 0; t < 3; t++) {
+          int nv = counts[t];
+          doc->reset();
+          for (int o = 0; o < 32; o++) {
+            doc->write(0xA0 + o, 0x01);                       // halt all
+          }
+          for (int o = 0; o < nv; o++) {
+            doc->write(0x00 + o, (uint8_t)(0x40 + o * 13));   // freq lo
+            doc->write(0x20 + o, (uint8_t)(1 + o % 3));       // freq hi
+            doc->write(0x40 + o, 0x40);                       // volume
+            doc->write(0x80 + o, (uint8_t)(o * 8));           // wavetable page
+            doc->write(0xC0 + o, (uint8_t)((o & 3) << 3));    // 256..2048 bytes, res 0
+            doc->write(0xA0 + o, (uint8_t)((o & 1) << 4));    // free run, L/R alternate
+          }
+          const int blocks = 100;
+          uint32_t sum = 0, worst = 0;
+          for (int b = 0; b < blocks; b++) {
+            uint32_t c0 = ESP.getCycleCount();
+            doc->generate_audio(out, frames);
+            uint32_t c = ESP.getCycleCount() - c0;
+            sum += c;
+            if (c > worst) worst = c;
+          }
+          Serial.printf("  %s %2d voices: %lu cycles/block avg, %lu max (%.1f%% of budget)\n",
+                        ch == 2 ? "stereo" : "mono  ", nv, (unsigned long)(sum / blocks),
+                        (unsigned long)worst, 100.0f * (sum / blocks) / budget);
+        }
+      }
+      delete doc;
+    }
   } else if (cmd == "es5503debug") {
     // Toggle ES5503 register write debugging
     s_es5503_debug = !s_es5503_debug;
@@ -1660,9 +1628,12 @@ static void cmd_process(String cmd) {
     Serial.printf("  ES5503 packets: %d (correct)\n", s_es5503_packet_count);
     Serial.printf("  Corrupted packets: %d (wrong address)\n", s_corrupted_packet_count);
     Serial.printf("  GLU read auto-inc: %lu (addr ptr bumps from $C03D reads)\n", (unsigned long)s_glu_read_auto_inc);
-    Serial.printf("  DOC write mutex: %lu ok, %lu failed%s\n",
-                  (unsigned long)s_mutex_ok_count, (unsigned long)s_mutex_fail_count,
-                  s_mutex_fail_count > 0 ? " *** RACE RISK ***" : "");
+    Serial.printf("  ES5503 write handling: %lu us avg / %lu us max (packet task)\n",
+                  (unsigned long)(s_es_write_calls ? s_es_write_us_sum / s_es_write_calls : 0),
+                  (unsigned long)s_es_write_us_max);
+    Serial.printf("  DOC write queue: hwm %lu/%lu, drops %lu, late %lu\n",
+                  (unsigned long)s_es_wq_hwm, (unsigned long)ES_WQ_SIZE,
+                  (unsigned long)s_es_wq_drops, (unsigned long)s_es_wq_late);
     if (s_ctrl_write_count > 0) {
       Serial.printf("  Control reg writes: %lu (h0→h0:%lu h0→h1:%lu h1→h0:%lu h1→h1:%lu)\n",
                     (unsigned long)s_ctrl_write_count,
@@ -1715,8 +1686,17 @@ static void cmd_process(String cmd) {
     s_es5503_packet_count = 0;
     s_corrupted_packet_count = 0;
     s_glu_read_auto_inc = 0;
-    s_mutex_ok_count = 0;
-    s_mutex_fail_count = 0;
+    s_es_write_calls = 0;
+    s_es_write_us_sum = 0;
+    s_es_write_us_max = 0;
+    s_es_wq_hwm = 0;
+    s_es_wq_drops = 0;
+    s_es_wq_late = 0;
+    s_es_render_resyncs = 0;
+    s_render_blocks = 0;
+    s_render_us_sum = 0;
+    s_render_us_max = 0;
+    s_i2s_underruns = 0;
     s_ctrl_write_count = 0;
     s_ctrl_h0_to_h0 = 0;
     s_ctrl_h0_to_h1 = 0;
@@ -2062,13 +2042,13 @@ static void cmd_process(String cmd) {
     Serial.println("Writing ES5503 test configuration...");
     // Use frequency value that should produce ~440Hz
     // Original 0x1000 was high-pitched but audible, try 0x0800 (half that)
-    g_es5503->write(0x00, 0x00);    // freq lo = 0x00 (low byte)  
-    g_es5503->write(0x20, 0x08);    // freq hi = 0x08 (high byte) → 0x0800 total  
-    g_es5503->write(0x40, 0x80);    // volume = 0x80 (medium)
-    g_es5503->write(0x80, 0x00);    // wavetable pointer = 0x0000
-    g_es5503->write(0xC0, 0x20);    // wavetable size = 4096 samples, resolution = 0
-    g_es5503->write(0xA0, 0x00);    // control = 0x00 (start oscillator, channel 0)
-    g_es5503->write(0xE1, 0x00);    // enable 1 oscillator
+    es_cli_write(0x00, 0x00);    // freq lo = 0x00 (low byte)  
+    es_cli_write(0x20, 0x08);    // freq hi = 0x08 (high byte) → 0x0800 total  
+    es_cli_write(0x40, 0x80);    // volume = 0x80 (medium)
+    es_cli_write(0x80, 0x00);    // wavetable pointer = 0x0000
+    es_cli_write(0xC0, 0x20);    // wavetable size = 4096 samples, resolution = 0
+    es_cli_write(0xA0, 0x00);    // control = 0x00 (start oscillator, channel 0)
+    es_cli_write(0xE1, 0x00);    // enable 1 oscillator
     
     Serial.println("Full audio pipeline test complete. You should hear ES5503 audio if FPGA I2S clocks are present.");
     Serial.println("Use 'lcam' to start bus capture if not already running.");
@@ -2139,7 +2119,7 @@ static void cmd_process(String cmd) {
       if (g_es5503) {
         for (int osc = 0; osc < 32; osc++) {
           uint8_t ctrl = g_es5503->read(0xA0 + osc);
-          g_es5503->write(0xA0 + osc, ctrl | 0x01);  // Halt oscillator
+          es_cli_write(0xA0 + osc, ctrl | 0x01);  // Halt oscillator
         }
       }
       
@@ -2208,7 +2188,7 @@ static void cmd_process(String cmd) {
     Serial.println("Exiting CLI mode. Returning to serial forwarding mode.");
     Serial.println("Use '+++' to enter CLI mode again.");
   } else if (cmd == "help") {
-    Serial.println("Commands: lcam | stop | status | fpgastats | spitest | spireg | spir | spiw | i2sstart | i2sstop | i2stest | i2sstatus | prebuffer | es5503start | es5503stop | es5503wave | audiostop | audiostart | es5503test | es5503reg | es5503debug | es5503mon | es5503info | es5503mem | fulltest | meminfo | wifi | radio | exit | we N");
+    Serial.println("Commands: lcam | stop | status | fpgastats | spitest | spireg | spir | spiw | i2sstart | i2sstop | i2stest | i2sstatus | prebuffer | es5503start | es5503stop | es5503wave | audiostop | audiostart | es5503test | es5503reg | es5503stereo | es5503bench | es5503debug | es5503mon | es5503info | es5503mem | fulltest | meminfo | wifi | radio | exit | we N");
     Serial.println("  spireg <reg> [val]        - read/write 1-byte register (0..126)");
     Serial.println("  spir <space> <addr> <len> [inc=1] - read bytes");
     Serial.println("  spiw <space> <addr> <inc|len> <b0> [b1 ...] - write bytes");
@@ -2218,7 +2198,7 @@ static void cmd_process(String cmd) {
     Serial.println("  i2scheck                  - verify FPGA I2S reception via SPI readback");
     Serial.println("  i2sstatus                 - show I2S status and pin configuration");
     Serial.println("  fpgastats                 - read FPGA ES5503 serialization counters (detect packet loss)");
-    Serial.println("  prebuffer <ms>            - set audio prebuffer latency (5-40ms, default 15)");
+    Serial.println("  prebuffer <ms>            - set DOC write-apply delay (5-40ms, default 15)");
     Serial.println("  es5503start               - initialize and start ES5503 audio generation");
     Serial.println("  es5503stop                - stop ES5503 audio generation");
     Serial.println("  es5503wave                - load test sawtooth waveform into wave memory");
@@ -2226,6 +2206,8 @@ static void cmd_process(String cmd) {
     Serial.println("  audiostart <num>          - enable ES5503 audio with specified number of oscillators (1-32)");
     Serial.println("  es5503test                - write test registers to ES5503");
     Serial.println("  es5503reg <reg> [val]     - read/write ES5503 register");
+    Serial.println("  es5503stereo [on|off]     - stereo output by DOC channel (default) or mono mix");
+    Serial.println("  es5503bench               - DOC renderer cycles per block at 8/16/32 voices");
     Serial.println("  es5503debug               - toggle ES5503 register write debugging");
     Serial.println("  es5503mon                 - toggle compact oscillator monitor (auto-disables other debug)");
     Serial.println("  es5503mon <ms>            - set monitor update interval (10-10000 ms, default 100)");
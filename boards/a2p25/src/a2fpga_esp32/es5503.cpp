@@ -2,7 +2,6 @@
 #include <algorithm>
 #include <cstring>
 #include "esp_heap_caps.h"
-#include <Arduino.h>  // for millis()
 
 // ES5503 - Standalone DOC implementation based on MAME's ES5503 emulator
 // Adapted from MAME's ES5503 implementation by R. Belmont
@@ -19,8 +18,8 @@ ES5503::ES5503(uint32_t clock_rate, uint8_t *wave_memory, uint32_t memory_size)
     m_rege0(0xff),
     m_channel_strobe(0),
     m_output_channels(2),
-    m_clock_rate(clock_rate),
     m_target_sample_rate(44100),  // Default to 44.1kHz I2S output
+    m_clock_rate(clock_rate),
     m_irq_active(false),
     m_wave_memory(wave_memory),
     m_memory_size(memory_size),
@@ -108,8 +107,6 @@ void ES5503::reset()
         m_oscillators[i].resolution = 0;
         m_oscillators[i].accumulator = 0;
         m_oscillators[i].irqpend = 0;
-        m_oscillators[i].last_active_ms = 0;
-        m_oscillators[i].was_generating = false;
     }
 
     // Default to 32 oscillators (IIgs Sound Manager standard)
@@ -248,7 +245,7 @@ void ES5503::write(uint16_t offset, uint8_t data)
                 // MAME key-on detection: reset accumulator on halt=1 → halt=0 transition.
                 // This is cycle-accurate in MAME. For our shadow, the firmware applies
                 // a targeted force-halt for ONESHOT/SWAP modes before calling write()
-                // to compensate for clock domain mismatch (see handle_es5503_write).
+                // to compensate for clock domain mismatch (see es5503_apply_write).
                 if ((m_oscillators[osc].control & 1) && (!(data&1)))
                 {
                     m_oscillators[osc].accumulator = 0;
@@ -319,173 +316,172 @@ void ES5503::generate_audio(int16_t *buffer, int num_samples)
     update_stream(buffer, num_samples);
 }
 
-// Update audio stream
-void ES5503::update_stream(int16_t *buffer, int num_samples)
+// Render one oscillator from sample 'start' to the end of the block (or until
+// it halts) as a single fixed-point loop: one wave fetch, one accumulator step
+// and one multiply-add per sample. MIX=false steps a voice that contributes
+// nothing (zero volume, or the odd oscillator of a sync/AM pair) so its
+// halts, IRQs and swaps still happen on time.
+template <bool MIX>
+int ES5503::render_voice(int onum, int32_t *mix, int start, int num_samples)
 {
-    int32_t *mixp;
-    int osc, snum, i;
-    uint32_t ramptr;
-
-    // Grace period: continue generating from recently-active oscillators even if
-    // briefly halted. This avoids 10ms gaps caused by timing granularity - on a real
-    // ES5503, a brief halt would only cause ~100us of silence, but since we generate
-    // in ~10ms chunks, a halt during generation causes 10ms of silence.
-    const uint32_t GRACE_PERIOD_MS = 20;  // Continue generating for up to 20ms after halt
-    uint32_t now_ms = millis();
-
-    // Make sure we have a big enough buffer
-    if (num_samples * m_output_channels > (int)m_mix_buffer.size())
+    ES5503Osc *pOsc = &m_oscillators[onum];
+    uint8_t ctrl = pOsc->control;
+    const uint32_t wtptr = pOsc->wavetblpointer & wavemasks[pOsc->wavetblsize];
+    uint32_t acc = pOsc->accumulator;
+    const uint16_t wtsize = pOsc->wtsize - 1;
+    const uint16_t freq = pOsc->freq;
+    const int resshift = resshifts[pOsc->resolution] - pOsc->wavetblsize;
+    const uint32_t sizemask = accmasks[pOsc->wavetblsize];
+    const bool am_source = (((ctrl >> 1) & 3) == MODE_SYNCAM) && (onum & 1);
+
+    // Volume folded into one multiplier; the uppermost enabled oscillator
+    // gets triple gain (hardware quirk)
+    const int32_t gain = pOsc->vol * ((onum == m_oscsenabled - 1) ? 3 : 1);
+
+    // Tables are aligned to their size, so one check covers the whole voice
+    const bool in_range = wtptr + sizemask < m_memory_size;
+    const uint8_t *wave = m_wave_memory + wtptr;
+
+    const int chan = (ctrl >> 4) & (m_output_channels - 1);
+    int32_t *mixp = mix + chan * num_samples + start;
+
+    // channel strobe is always valid when reading; this allows potentially banking per voice
+    m_channel_strobe = (ctrl >> 4) & 0xf;
+
+    uint8_t byte = 0;
+    uint8_t am_byte = 0;
+    int snum;
+    for (snum = start; snum < num_samples; snum++)
     {
-        m_mix_buffer.resize(num_samples * m_output_channels);
-    }
-
-    // Clear mix buffer
-    std::fill(m_mix_buffer.begin(), m_mix_buffer.end(), 0);
+        uint32_t altram = acc >> resshift;
+        uint32_t ramptr = altram & sizemask;
+        acc += freq;
 
-    for (int chan = 0; chan < m_output_channels; chan++)
-    {
-        // Mix across all oscillators; some IIgs software may program voices
-        // before updating E1 (enabled count). This ensures we don't miss sound
-        // from higher-numbered oscillators that are already configured.
-        for (osc = 0; osc < 32; osc++)
+        byte = in_range ? wave[ramptr] : read_byte(wtptr + ramptr);
+        if (byte == 0x00)
         {
-            ES5503Osc *pOsc = &m_oscillators[osc];
-
-            // Check if oscillator should generate audio:
-            // 1. Not halted (control bit 0 clear), OR
-            // 2. Was recently generating (within grace period) - to smooth over brief halts
-            bool is_halted = (pOsc->control & 1);
-            bool in_grace_period = pOsc->was_generating &&
-                                   (now_ms - pOsc->last_active_ms) < GRACE_PERIOD_MS;
-            bool should_generate = (!is_halted || in_grace_period) &&
-                                   ((pOsc->control >> 4) & (m_output_channels - 1)) == chan;
+            halt_osc(onum, 1, &acc, resshift);
+        }
+        else
+        {
+            if (MIX)
+            {
+                *mixp += ((int32_t)byte - 128) * gain;
+            }
+            am_byte = byte;
+            mixp++;
 
-            if (should_generate)
+            if (altram < wtsize)
             {
-                uint32_t wtptr = pOsc->wavetblpointer & wavemasks[pOsc->wavetblsize], altram;
-                uint32_t acc = pOsc->accumulator;
-                const uint16_t wtsize = pOsc->wtsize - 1;
-                uint8_t ctrl = pOsc->control;
-                const uint16_t freq = pOsc->freq;
-                int16_t vol = pOsc->vol;
-                int8_t data = -128;
-                const int resshift = resshifts[pOsc->resolution] - pOsc->wavetblsize;
-                const uint32_t sizemask = accmasks[pOsc->wavetblsize];
-                const int mode = (pOsc->control>>1) & 3;
-
-                // Start from sample 0 (original MAME behavior)
-                mixp = &m_mix_buffer[0] + chan;
-
-                for (snum = 0; snum < num_samples; snum++)
-                {
-                    altram = acc >> resshift;
-                    ramptr = altram & sizemask;
+                continue;   // only halt_osc() can stop the voice
+            }
+            halt_osc(onum, 0, &acc, resshift);
+        }
 
-                    acc += freq;
+        // if oscillator halted, we've got no more samples to generate
+        if (pOsc->control & 1)
+        {
+            ctrl |= 1;
+            break;
+        }
+    }
 
-                    // channel strobe is always valid when reading; this allows potentially banking per voice
-                    m_channel_strobe = (ctrl>>4) & 0xf;
-                    data = (int32_t)read_byte(ramptr + wtptr) ^ 0x80;
+    pOsc->control = ctrl;
+    pOsc->accumulator = acc;
+    pOsc->data = byte;
 
-                    uint8_t byte_value = read_byte(ramptr + wtptr);
-                    if (byte_value == 0x00)
-                    {
-                        halt_osc(osc, 1, &acc, resshift);
-                    }
-                    else
-                    {
-                        if (mode != MODE_SYNCAM)
-                        {
-                            int value = data * vol;
-                            *mixp += value;
-                            // Uppermost enabled oscillator gets triple gain (hardware quirk)
-                            if (osc == (m_oscsenabled - 1))
-                            {
-                                *mixp += value;
-                                *mixp += value;
-                            }
-                        }
-                        else
-                        {
-                            // if we're odd, we play nothing ourselves
-                            if (osc & 1)
-                            {
-                                if (osc < 31)
-                                {
-                                    // if the next oscillator up is playing, it's volume becomes our control
-                                    if (!(m_oscillators[osc + 1].control & 1))
-                                    {
-                                        m_oscillators[osc + 1].vol = data ^ 0x80;
-                                    }
-                                }
-                            }
-                            else    // hard sync, both oscillators play?
-                            {
-                                *mixp += data * vol;
-                                // Uppermost enabled oscillator gets triple gain (hardware quirk)
-                                if (osc == (m_oscsenabled - 1))
-                                {
-                                    *mixp += data * vol;
-                                    *mixp += data * vol;
-                                }
-                            }
-                        }
-                        mixp += m_output_channels;
-
-                        if (altram >= wtsize)
-                        {
-                            halt_osc(osc, 0, &acc, resshift);
-                        }
-                    }
+    // Sync/AM: the odd oscillator's output is the volume of the one above it
+    // (read at that voice's next render, so only the last value matters)
+    if (am_source && am_byte && onum < 31 && !(m_oscillators[onum + 1].control & 1))
+    {
+        m_oscillators[onum + 1].vol = am_byte;
+    }
 
-                    // if oscillator halted, we've got no more samples to generate
-                    if (pOsc->control & 1)
-                    {
-                        ctrl |= 1;
-                        break;
-                    }
-                }
+    return snum;
+}
 
-                pOsc->control = ctrl;
-                pOsc->accumulator = acc;
-                pOsc->data = data ^ 0x80;
+// Update audio stream
+void ES5503::update_stream(int16_t *buffer, int num_samples)
+{
+    const int nch = m_output_channels;
+    int i;
+
+    if (num_samples <= 0)
+    {
+        return;
+    }
+
+    // Make sure we have a big enough buffer
+    if (num_samples * nch > (int)m_mix_buffer.size())
+    {
+        m_mix_buffer.resize(num_samples * nch);
+    }
 
-                // Update grace period tracking - this oscillator was generating
-                pOsc->last_active_ms = now_ms;
-                pOsc->was_generating = true;
+    // Clear the part of the mix buffer this call uses (callers render a block
+    // in several short segments, split at register writes)
+    std::fill(m_mix_buffer.begin(), m_mix_buffer.begin() + num_samples * nch, 0);
+    int32_t *mix = &m_mix_buffer[0];
+
+    // Active voices, in MAME's (channel, oscillator) order. Halted voices are
+    // never touched. Mix across all oscillators; some IIgs software may program
+    // voices before updating E1 (enabled count). This ensures we don't miss
+    // sound from higher-numbered oscillators that are already configured.
+    uint8_t voices[32];
+    int nvoices = 0;
+    for (int chan = 0; chan < nch; chan++)
+    {
+        for (int osc = 0; osc < 32; osc++)
+        {
+            uint8_t ctrl = m_oscillators[osc].control;
+            if (!(ctrl & 1) && ((ctrl >> 4) & (nch - 1)) == chan)
+            {
+                voices[nvoices++] = osc;
             }
-            else
+        }
+    }
+
+    for (int v = 0; v < nvoices; v++)
+    {
+        int osc = voices[v];
+        int start = 0;
+        for (;;)
+        {
+            ES5503Osc *pOsc = &m_oscillators[osc];
+            ES5503Osc *pPartner = &m_oscillators[osc ^ 1];
+            bool partner_idle = (pPartner->control & 1);
+            bool syncam_odd = (((pOsc->control >> 1) & 3) == MODE_SYNCAM) && (osc & 1);
+            int end = (pOsc->vol && !syncam_odd)
+                      ? render_voice<true>(osc, mix, start, num_samples)
+                      : render_voice<false>(osc, mix, start, num_samples);
+
+            // Swap mode handed over to a halted partner: it starts on the next
+            // sample rather than at the next block
+            if (end + 1 >= num_samples || !partner_idle || (pPartner->control & 1))
             {
-                // Oscillator not generating - clear grace period if expired
-                if (pOsc->was_generating && (now_ms - pOsc->last_active_ms) >= GRACE_PERIOD_MS)
-                {
-                    pOsc->was_generating = false;
-                }
+                break;
             }
+            start = end + 1;
+            osc ^= 1;
         }
     }
 
-    // Copy mix buffer to output buffer with appropriate scaling
-    for (int chan = 0; chan < m_output_channels; chan++)
+    // Interleave the channel accumulators into the output buffer
+    for (int chan = 0; chan < nch; chan++)
     {
-        mixp = &m_mix_buffer[0] + chan;
+        const int32_t *mixp = mix + chan * num_samples;
+        int16_t *out = buffer + chan;
         for (i = 0; i < num_samples; i++)
         {
             // Scale appropriately and convert to 16-bit output
             // Wave data is -128 to +127, volume is 0-255
             // Per-oscillator max: ~32640, with triple gain: ~97920
-            // Multiple oscillators can easily exceed 16-bit range
-            // Use larger divisor (>>3 = /8) and clamp to prevent overflow distortion
-            int32_t value = *mixp;
-            int32_t scaled = value >> 1;  // Divide by 8 to handle multiple oscillators
-
-            // Clamp to 16-bit range to prevent wrap-around distortion
+            // Multiple oscillators can easily exceed 16-bit range, so clamp
+            // to prevent wrap-around distortion
+            int32_t scaled = mixp[i] >> 1;
             if (scaled > 32767) scaled = 32767;
             else if (scaled < -32768) scaled = -32768;
 
-            buffer[i * m_output_channels + chan] = (int16_t)scaled;
-
-            mixp += m_output_channels;
+            out[i * nch] = (int16_t)scaled;
         }
     }
 }
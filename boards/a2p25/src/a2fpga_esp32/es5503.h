@@ -23,6 +23,9 @@ public:
     // Set number of output channels (must be a power of 2)
     void set_channels(int channels);
 
+    // Number of interleaved output channels generate_audio() writes
+    int get_channels() const { return m_output_channels; }
+
     // Set target output sample rate (for rate conversion)
     void set_output_sample_rate(uint32_t rate);
     
@@ -86,11 +89,6 @@ private:
 
         uint32_t accumulator;
         uint8_t  irqpend;
-
-        // Grace period tracking: continue generating from recently-active oscillators
-        // even if briefly halted, to avoid 10ms gaps from timing granularity
-        uint32_t last_active_ms;  // millis() when oscillator was last running
-        bool was_generating;      // was this oscillator generating audio last call?
     };
     
     // Halt an oscillator
@@ -101,6 +99,11 @@ private:
     
     // Update audio stream
     void update_stream(int16_t *buffer, int num_samples);
+
+    // Render one oscillator over [start, num_samples) into its channel's
+    // accumulator; returns the sample it halted on, or num_samples
+    template <bool MIX>
+    int render_voice(int onum, int32_t *mix, int start, int num_samples);
     
     // Member variables
     ES5503Osc m_oscillators[32];
@@ -116,7 +119,7 @@ private:
     
     uint32_t m_clock_rate;
     
-    std::vector<int32_t> m_mix_buffer;
+    std::vector<int32_t> m_mix_buffer;   // planar: one num_samples run per channel
     
     bool m_irq_active;
     std::function<void(bool)> m_irq_callback;
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ES5503 output chain: DOC rate (26,320 Hz) -> I2S rate (44,100 Hz).
+// Catmull-Rom upsampling followed by a 2-pole Butterworth LPF, per channel.
+// Header-only and free of Arduino/ESP-IDF so the host harness
+// (tools/es5503_render.cpp) runs the exact code the I2S task runs.
+
+// ---------- Catmull-Rom Cubic Interpolation ----------
+// Produces C1-continuous curves through sample points (no angular "jags")
+// Linear interpolation connects samples with straight lines → corners at each sample point
+// Cubic interpolation fits smooth curves → no corners, much less high-frequency aliasing
+// ym1, y0, y1, y2: four consecutive samples; t: fractional position 0-255 between y0 and y1
+static inline int16_t catmull_rom_interp(int32_t ym1, int32_t y0, int32_t y1, int32_t y2, uint32_t t) {
+    // Catmull-Rom: 0.5*(2*y0 + (-ym1+y1)*t + (2*ym1-5*y0+4*y1-y2)*t² + (-ym1+3*y0-3*y1+y2)*t³)
+    // Horner's form with t in 0-255 (8.8 fixed point fractional part):
+    int32_t c0 = 2 * y0;
+    int32_t c1 = -ym1 + y1;
+    int32_t c2 = 2*ym1 - 5*y0 + 4*y1 - y2;
+    int32_t c3 = -ym1 + 3*y0 - 3*y1 + y2;
+    int32_t r = c3;
+    r = c2 + ((r * (int32_t)t) >> 8);
+    r = c1 + ((r * (int32_t)t) >> 8);
+    r = c0 + ((r * (int32_t)t) >> 8);
+    r >>= 1;  // divide by 2 (from the 0.5 factor)
+    if (r > 32767) r = 32767;
+    if (r < -32768) r = -32768;
+    return (int16_t)r;
+}
+
+// Resampler state carried across blocks
+struct EsUpsampler {
+    int16_t prev[2];    // last DOC frame of the previous block (L, R)
+};
+
+// Stretch n_in DOC frames (ch interleaved channels, 1 or 2) over n_out
+// stereo output frames. In mono only the left slot is written.
+static inline void es_upsample(EsUpsampler *st, const int16_t *in, uint32_t n_in, int ch,
+                               int16_t *out, uint32_t n_out) {
+    for (uint32_t i = 0; i < n_out; i++) {
+        uint32_t pos_fixed = (i * n_in * 256) / n_out;
+        uint32_t idx = pos_fixed >> 8;
+        uint32_t frac = pos_fixed & 0xFF;
+        if (idx >= n_in) idx = n_in - 1;
+
+        for (int c = 0; c < ch; c++) {
+            const int16_t *src = in + c;
+            int32_t ym1 = (idx > 0) ? src[(idx - 1) * ch] : st->prev[c];
+            int32_t y0  = src[idx * ch];
+            int32_t y1  = (idx + 1 < n_in) ? src[(idx + 1) * ch] : y0;
+            int32_t y2  = (idx + 2 < n_in) ? src[(idx + 2) * ch] : y1;
+            out[i * 2 + c] = catmull_rom_interp(ym1, y0, y1, y2, frac);
+        }
+    }
+    for (int c = 0; c < ch; c++) {
+        st->prev[c] = in[(n_in - 1) * ch + c];
+    }
+}
+
+// Anti-aliasing 2-pole biquad LPF (Butterworth, fc=10kHz at 44.1kHz)
+// 12dB/octave rolloff (vs 6dB for 1-pole) - much better alias rejection
+// ES5503 Nyquist is 13.16kHz; this filter removes spectral images from upsampling
+// while preserving all audible content below 10kHz
+// Q14 fixed-point coefficients (precomputed from bilinear transform):
+//   b = [0.25029, 0.50058, 0.25029], a = [1, -0.17595, 0.17709]
+struct EsBiquad {
+    int32_t x1[2], x2[2];   // input history (L, R)
+    int32_t y1[2], y2[2];   // output history (L, R)
+};
+
+// Filter n stereo frames in place; in mono the filtered left is copied to right.
+static inline void es_lpf(EsBiquad *st, int16_t *buf, size_t n, int ch) {
+    static const int32_t B0 = 4101, B1 = 8201, B2 = 4101;  // Q14
+    static const int32_t A1 = -2882, A2 = 2901;             // Q14
+
+    for (int c = 0; c < ch; c++) {
+        int32_t x1 = st->x1[c], x2 = st->x2[c], y1 = st->y1[c], y2 = st->y2[c];
+        for (size_t i = 0; i < n; i++) {
+            int32_t x0 = buf[i * 2 + c];
+            // y[n] = (b0*x[n] + b1*x[n-1] + b2*x[n-2] - a1*y[n-1] - a2*y[n-2]) >> 14
+            int32_t y0 = (B0*x0 + B1*x1 + B2*x2 - A1*y1 - A2*y2) >> 14;
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = y0;
+            buf[i * 2 + c] = (y0 > 32767) ? 32767 : (y0 < -32768) ? -32768 : (int16_t)y0;
+        }
+        st->x1[c] = x1; st->x2[c] = x2; st->y1[c] = y1; st->y2[c] = y2;
+    }
+    if (ch == 1) {
+        for (size_t i = 0; i < n; i++) {
+            buf[i * 2 + 1] = buf[i * 2];
+        }
+    }
+}
@@ -0,0 +1,339 @@
+/*
+ * es5503_render — offline ES5503 (DOC) + output chain for Linux/macOS.
+ *
+ * Replays a DOC write log against a 64 KB wave RAM image through the same
+ * code the board's I2S task runs (es5503.cpp, es_audio.h), block for block:
+ * 512 output frames at 44.1 kHz, the DOC rendered at 26,320 Hz in segments
+ * with each write applied at the DOC sample matching its timestamp. Output
+ * is a 16-bit stereo WAV; the PCM hash printed at the end is the bit-exact
+ * regression check for DSP changes.
+ *
+ *   c++ -O2 -I.. -Ihost -o es5503_render es5503_render.cpp ../es5503.cpp
+ *
+ *   ./es5503_render wave.bin writes.log                 render to out.wav
+ *   ./es5503_render -m -s 30 -o a.wav wave.bin writes.log   mono, 30 s
+ *   ./es5503_render -r 20 wave.bin writes.log           benchmark 20 passes
+ *
+ * Log format, one write per line, numbers decimal or 0x hex, '#' comments:
+ *   <time_us> <reg> <value>            DOC register write ($00-$E2)
+ *   <time_us> ram <addr> <value>       wave RAM write
+ * Times are relative to the first entry and must not go backwards. The
+ * wave image may be shorter than 64 KB (zero-filled).
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include "es5503.h"
+#include "es_audio.h"
+
+// Board constants (a2fpga_esp32.ino)
+static const uint32_t ES_CLOCK_RATE   = 7159090;
+static const uint32_t ES_DOC_RATE     = 26320;
+static const uint32_t ES_I2S_RATE     = 44100;
+static const uint32_t ES_BLOCK_FRAMES = 512;
+
+struct EsLogEntry {
+    uint64_t t_us;
+    uint32_t addr;      // DOC register, or wave RAM address
+    uint8_t  data;
+    bool     ram;
+};
+
+struct EsRenderStats {
+    uint64_t doc_frames;
+    uint64_t out_frames;
+    uint64_t writes;
+    double   t_doc;     // DOC render incl. write apply
+    double   t_up;      // Catmull-Rom upsample
+    double   t_lpf;     // biquad
+    uint64_t hash;      // FNV-1a 64 over the little-endian PCM
+};
+
+static double es_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool parse_num(const char *s, uint64_t *v)
+{
+    char *end;
+    *v = strtoull(s, &end, 0);
+    return end != s && *end == '\0';
+}
+
+// Parse a write log. Returns 0, or -1 with the line number on stderr.
+static int es_log_load(FILE *f, std::vector<EsLogEntry> *log)
+{
+    char line[256];
+    int lineno = 0;
+    log->clear();
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash)
+            *hash = '\0';
+        char *tok[5];
+        int nt = 0;
+        for (char *p = strtok(line, " \t\r\n"); p && nt < 5; p = strtok(NULL, " \t\r\n"))
+            tok[nt++] = p;
+        if (nt == 0)
+            continue;
+
+        EsLogEntry e;
+        uint64_t t, a, v;
+        bool ok;
+        if (nt == 4 && !strcmp(tok[1], "ram")) {
+            ok = parse_num(tok[0], &t) && parse_num(tok[2], &a) && parse_num(tok[3], &v) &&
+                 a < 65536 && v < 256;
+            e.ram = true;
+        } else {
+            ok = nt == 3 && parse_num(tok[0], &t) && parse_num(tok[1], &a) &&
+                 parse_num(tok[2], &v) && a <= 0xE2 && v < 256;
+            e.ram = false;
+        }
+        if (!ok || (!log->empty() && t < log->back().t_us)) {
+            fprintf(stderr, "write log line %d: expected '<time_us> <reg> <value>' "
+                    "or '<time_us> ram <addr> <value>' in time order\n", lineno);
+            return -1;
+        }
+        e.t_us = t;
+        e.addr = (uint32_t)a;
+        e.data = (uint8_t)v;
+        log->push_back(e);
+    }
+    return 0;
+}
+
+// DOC sample index a write lands on: the first sample whose time is >= the
+// write's (as es_render_block() on the board, with no arrival jitter).
+static uint64_t es_write_sample(uint64_t dt_us)
+{
+    return (dt_us * ES_DOC_RATE + 999999) / 1000000;
+}
+
+static void es_apply(ES5503 *doc, const EsLogEntry &e)
+{
+    if (e.ram)
+        doc->get_wave_memory()[e.addr] = e.data;
+    else
+        doc->write((uint16_t)e.addr, e.data);
+}
+
+// Render out_frames stereo frames (rounded up to whole blocks) into pcm.
+static void es_render(ES5503 *doc, const std::vector<EsLogEntry> &log, uint64_t out_frames,
+                      int ch, std::vector<int16_t> *pcm, EsRenderStats *st)
+{
+    static int16_t doc_buf[ES_BLOCK_FRAMES * 2];
+    static int16_t out_buf[ES_BLOCK_FRAMES * 2];
+    EsUpsampler up = {};
+    EsBiquad lpf = {};
+    uint32_t frac = 0;
+    uint64_t doc_pos = 0;
+    size_t next = 0;
+    const uint64_t t0 = log.empty() ? 0 : log[0].t_us;
+
+    memset(st, 0, sizeof(*st));
+    st->hash = 0xcbf29ce484222325ull;
+    pcm->clear();
+    doc->set_channels(ch);
+
+    while (st->out_frames < out_frames) {
+        uint64_t total = (uint64_t)ES_BLOCK_FRAMES * ES_DOC_RATE + frac;
+        uint32_t n = (uint32_t)(total / ES_I2S_RATE);
+        frac = (uint32_t)(total % ES_I2S_RATE);
+
+        double a = es_now();
+        uint32_t pos = 0;
+        while (next < log.size()) {
+            uint64_t k = es_write_sample(log[next].t_us - t0);
+            if (k >= doc_pos + n)
+                break;                          // belongs to a later block
+            uint32_t rel = k > doc_pos ? (uint32_t)(k - doc_pos) : 0;
+            if (rel > pos) {
+                doc->generate_audio(doc_buf + pos * ch, rel - pos);
+                pos = rel;
+            }
+            es_apply(doc, log[next++]);
+            st->writes++;
+        }
+        if (pos < n)
+            doc->generate_audio(doc_buf + pos * ch, n - pos);
+        doc_pos += n;
+
+        double b = es_now();
+        es_upsample(&up, doc_buf, n, ch, out_buf, ES_BLOCK_FRAMES);
+        double c = es_now();
+        es_lpf(&lpf, out_buf, ES_BLOCK_FRAMES, ch);
+        double d = es_now();
+
+        st->t_doc += b - a;
+        st->t_up += c - b;
+        st->t_lpf += d - c;
+        st->doc_frames += n;
+        st->out_frames += ES_BLOCK_FRAMES;
+
+        for (uint32_t i = 0; i < ES_BLOCK_FRAMES * 2; i++) {
+            uint16_t v = (uint16_t)out_buf[i];
+            st->hash = (st->hash ^ (v & 0xFF)) * 0x100000001b3ull;
+            st->hash = (st->hash ^ (v >> 8)) * 0x100000001b3ull;
+        }
+        pcm->insert(pcm->end(), out_buf, out_buf + ES_BLOCK_FRAMES * 2);
+    }
+}
+
+// A DOC as es5503_init() sets it up, loaded with the wave image.
+static ES5503 *es_doc_create(const uint8_t *image, size_t len)
+{
+    ES5503 *doc = ES5503::create_with_memory(ES_CLOCK_RATE);
+    if (!doc)
+        return NULL;
+    doc->set_output_sample_rate(ES_I2S_RATE);
+    memcpy(doc->get_wave_memory(), image, len < 65536 ? len : 65536);
+    return doc;
+}
+
+static void es_report(const EsRenderStats *st, int passes, FILE *out)
+{
+    double secs = (double)st->out_frames / ES_I2S_RATE;
+    fprintf(out, "%.2f s audio, %llu DOC frames, %llu writes\n", secs,
+            (unsigned long long)st->doc_frames, (unsigned long long)st->writes);
+    double t_doc = st->t_doc / passes, t_up = st->t_up / passes, t_lpf = st->t_lpf / passes;
+    fprintf(out, "  doc render: %8.2f Msamples/s (%6.0fx realtime)\n",
+            st->doc_frames / t_doc / 1e6, secs / t_doc);
+    fprintf(out, "  upsample:   %8.2f Msamples/s (%6.0fx realtime)\n",
+            st->out_frames / t_up / 1e6, secs / t_up);
+    fprintf(out, "  lpf:        %8.2f Msamples/s (%6.0fx realtime)\n",
+            st->out_frames / t_lpf / 1e6, secs / t_lpf);
+    fprintf(out, "  chain:      %8.2f Msamples/s (%6.0fx realtime)\n",
+            st->out_frames / (t_doc + t_up + t_lpf) / 1e6, secs / (t_doc + t_up + t_lpf));
+    fprintf(out, "pcm fnv1a64 %016llx\n", (unsigned long long)st->hash);
+}
+
+#ifndef ES5503_RENDER_NO_MAIN
+static void put16(FILE *f, uint16_t v) { fputc(v & 0xFF, f); fputc(v >> 8, f); }
+static void put32(FILE *f, uint32_t v) { put16(f, v & 0xFFFF); put16(f, v >> 16); }
+
+static int es_wav_write(const char *path, const std::vector<int16_t> &pcm)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    uint32_t bytes = (uint32_t)(pcm.size() * 2);
+    fwrite("RIFF", 1, 4, f);
+    put32(f, 36 + bytes);
+    fwrite("WAVEfmt ", 1, 8, f);
+    put32(f, 16);
+    put16(f, 1);                    // PCM
+    put16(f, 2);                    // stereo, as the I2S link carries it
+    put32(f, ES_I2S_RATE);
+    put32(f, ES_I2S_RATE * 4);
+    put16(f, 4);
+    put16(f, 16);
+    fwrite("data", 1, 4, f);
+    put32(f, bytes);
+    for (size_t i = 0; i < pcm.size(); i++)
+        put16(f, (uint16_t)pcm[i]);
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+static void usage(void)
+{
+    fprintf(stderr,
+            "usage: es5503_render [-m] [-s secs] [-r passes] [-o out.wav] wave.bin writes.log\n"
+            "  -m         mono mix (es5503stereo off)\n"
+            "  -s secs    length (default: last write + 1 s)\n"
+            "  -r passes  render this many times and average the stage timings\n"
+            "  -o file    output WAV (default out.wav; '-' for none)\n");
+}
+
+int main(int argc, char **argv)
+{
+    int ch = 2, passes = 1;
+    double secs = 0;
+    const char *out = "out.wav";
+    const char *paths[2];
+    int np = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-m")) {
+            ch = 1;
+        } else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            secs = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+            passes = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+            out = argv[++i];
+        } else if (argv[i][0] == '-' || np == 2) {
+            usage();
+            return 2;
+        } else {
+            paths[np++] = argv[i];
+        }
+    }
+    if (np != 2 || passes < 1) {
+        usage();
+        return 2;
+    }
+
+    static uint8_t image[65536];
+    FILE *f = fopen(paths[0], "rb");
+    if (!f) {
+        perror(paths[0]);
+        return 1;
+    }
+    size_t len = fread(image, 1, sizeof(image), f);
+    fclose(f);
+
+    std::vector<EsLogEntry> log;
+    f = fopen(paths[1], "r");
+    if (!f) {
+        perror(paths[1]);
+        return 1;
+    }
+    int rc = es_log_load(f, &log);
+    fclose(f);
+    if (rc < 0)
+        return 1;
+
+    if (secs <= 0)
+        secs = (log.empty() ? 0 : (log.back().t_us - log[0].t_us) / 1e6) + 1.0;
+    uint64_t frames = (uint64_t)(secs * ES_I2S_RATE);
+
+    std::vector<int16_t> pcm;
+    EsRenderStats st, sum;
+    memset(&sum, 0, sizeof(sum));
+    for (int p = 0; p < passes; p++) {
+        ES5503 *doc = es_doc_create(image, len);
+        if (!doc) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+        es_render(doc, log, frames, ch, &pcm, &st);
+        delete doc;
+        if (p && st.hash != sum.hash) {
+            fprintf(stderr, "pass %d rendered different PCM\n", p + 1);
+            return 1;
+        }
+        sum.t_doc += st.t_doc;
+        sum.t_up += st.t_up;
+        sum.t_lpf += st.t_lpf;
+        sum.hash = st.hash;
+    }
+    st.t_doc = sum.t_doc;
+    st.t_up = sum.t_up;
+    st.t_lpf = sum.t_lpf;
+    es_report(&st, passes, stdout);
+
+    if (strcmp(out, "-") && es_wav_write(out, pcm) < 0)
+        return 1;
+    return 0;
+}
+#endif
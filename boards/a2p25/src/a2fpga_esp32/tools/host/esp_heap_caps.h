@@ -0,0 +1,11 @@
+#pragma once
+
+// Host stand-in for ESP-IDF's heap_caps API (es5503.cpp only allocates the
+// 64 KB wave RAM through it); capability bits are ignored.
+#include <stdlib.h>
+
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+static inline void *heap_caps_malloc(size_t size, unsigned caps) { (void)caps; return malloc(size); }
+static inline void heap_caps_free(void *p) { free(p); }
@@ -0,0 +1,225 @@
+/*
+ * test_es5503_render.cpp — host-side check of the a2p25 ES5503 audio path
+ * (es5503.cpp + es_audio.h) through the offline renderer
+ * (a2p25 tools/es5503_render.cpp).
+ *
+ * Renders synthetic write logs against a generated wave image and requires:
+ *   - identical PCM from two renders of the same log (bit-exact replay)
+ *   - the programmed pitch, from zero crossings
+ *   - channel 0 voices only in the left output, channel 1 only in the right,
+ *     and L == R in mono
+ *   - a halt landing on the output sample its timestamp maps to
+ *   - swap-mode pairs handing over without a gap
+ *   - log lines out of time order rejected
+ * then reports per-stage throughput at 8, 16 and 32 voices.
+ *
+ *   make es5503_render      (from boards/a2p25/tests)
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "check.h"
+
+#define ES5503_RENDER_NO_MAIN
+#include "es5503_render.cpp"
+
+static uint8_t s_image[65536];
+
+/* Page 0: square wave ($40/$C0, 256 bytes). Pages 1-2: sine. Pages 3-4:
+ * short constant ramps for the swap pair. Rest: sine (bench voices). */
+static void make_image(void)
+{
+    for (int i = 0; i < 65536; i++)
+        s_image[i] = (uint8_t)(128.0 + 100.0 * sin(2.0 * M_PI * i / 256.0));
+    for (int i = 0; i < 256; i++)
+        s_image[i] = (i < 128) ? 0xC0 : 0x40;
+    for (int i = 0; i < 256; i++) {
+        s_image[0x300 + i] = 0xE0;
+        s_image[0x400 + i] = 0x20;
+    }
+}
+
+static void w(std::vector<EsLogEntry> *log, uint64_t t, uint32_t reg, uint8_t v)
+{
+    EsLogEntry e = { t, reg, v, false };
+    log->push_back(e);
+}
+
+/* Program oscillator osc: 256-byte table at page, resolution 0, and start it
+ * in the given mode on the given channel. */
+static void voice(std::vector<EsLogEntry> *log, uint64_t t, int osc, uint16_t freq,
+                  uint8_t vol, uint8_t page, int mode, int chan)
+{
+    w(log, t, 0x00 + osc, freq & 0xFF);
+    w(log, t, 0x20 + osc, freq >> 8);
+    w(log, t, 0x40 + osc, vol);
+    w(log, t, 0x80 + osc, page);
+    w(log, t, 0xC0 + osc, 0x00);
+    w(log, t, 0xA0 + osc, (uint8_t)((chan << 4) | (mode << 1)));
+}
+
+static void halt_all(std::vector<EsLogEntry> *log, uint64_t t)
+{
+    for (int osc = 0; osc < 32; osc++)
+        w(log, t, 0xA0 + osc, 0x01);
+}
+
+static uint64_t render(const std::vector<EsLogEntry> &log, double secs, int ch,
+                       std::vector<int16_t> *pcm, EsRenderStats *st)
+{
+    ES5503 *doc = es_doc_create(s_image, sizeof(s_image));
+    es_render(doc, log, (uint64_t)(secs * ES_I2S_RATE), ch, pcm, st);
+    delete doc;
+    return st->hash;
+}
+
+static double rms(const std::vector<int16_t> &pcm, int c, double from, double to)
+{
+    size_t a = (size_t)(from * ES_I2S_RATE), b = (size_t)(to * ES_I2S_RATE);
+    double sum = 0;
+    for (size_t i = a; i < b; i++)
+        sum += (double)pcm[i * 2 + c] * pcm[i * 2 + c];
+    return sqrt(sum / (double)(b - a));
+}
+
+static void test_replay(void)
+{
+    printf("stereo replay, pitch, halt timing...\n");
+    std::vector<EsLogEntry> log;
+    halt_all(&log, 0);
+    /* freq $1000, res 0, 256-byte table: 32 DOC samples per cycle */
+    voice(&log, 0, 0, 0x1000, 0x80, 0x00, 0, 0);       /* square, left */
+    voice(&log, 100000, 2, 0x0800, 0x80, 0x01, 0, 1);  /* sine, right from 100 ms */
+    w(&log, 200000, 0xA0, 0x01);                        /* halt left at 200 ms */
+
+    std::vector<int16_t> pcm, pcm2;
+    EsRenderStats st;
+    uint64_t h1 = render(log, 0.3, 2, &pcm, &st);
+    uint64_t h2 = render(log, 0.3, 2, &pcm2, &st);
+    CHECK(h1 == h2 && pcm == pcm2, "replay not deterministic");
+    CHECK(st.writes == log.size(), "writes applied %llu of %zu",
+          (unsigned long long)st.writes, log.size());
+
+    /* pitch: 26320 / 32 = 822.5 Hz */
+    int cross = 0;
+    size_t a = (size_t)(0.02 * ES_I2S_RATE), b = (size_t)(0.09 * ES_I2S_RATE);
+    for (size_t i = a + 1; i < b; i++)
+        if ((pcm[(i - 1) * 2] < 0) != (pcm[i * 2] < 0))
+            cross++;
+    double hz = cross / 2.0 / ((b - a) / (double)ES_I2S_RATE);
+    CHECK(fabs(hz - 822.5) < 822.5 * 0.03, "pitch %.1f Hz, expected 822.5", hz);
+
+    double l1 = rms(pcm, 0, 0.02, 0.09), r1 = rms(pcm, 1, 0.02, 0.09);
+    double l3 = rms(pcm, 0, 0.22, 0.29), r3 = rms(pcm, 1, 0.12, 0.19);
+    CHECK(l1 > 3000 && r1 < 1, "left voice: L rms %.0f, R rms %.0f", l1, r1);
+    CHECK(r3 > 3000 && l3 < 1, "after halt/start: L rms %.0f, R rms %.0f", l3, r3);
+
+    /* the square is flat at +-(64*128)/2 (after the LPF); its last full-level
+     * sample must sit at the halt: 200 ms = output sample 8820 */
+    long last = -1;
+    for (size_t i = 8000; i < 9500; i++)
+        if (abs(pcm[i * 2]) > 2000)
+            last = (long)i;
+    CHECK(last >= 8820 - 4 && last <= 8820 + 4, "halt at output sample %ld, expected 8820", last);
+    printf("  pitch %.1f Hz, L %.0f / R %.0f rms, halt at sample %ld\n", hz, l1, r3, last);
+}
+
+static void test_mono(void)
+{
+    printf("mono mix...\n");
+    std::vector<EsLogEntry> log;
+    halt_all(&log, 0);
+    voice(&log, 0, 0, 0x1000, 0x80, 0x00, 0, 0);
+    voice(&log, 0, 1, 0x0700, 0x80, 0x01, 0, 1);
+    std::vector<int16_t> pcm;
+    EsRenderStats st;
+    render(log, 0.1, 1, &pcm, &st);
+    size_t diff = 0;
+    for (size_t i = 0; i < pcm.size(); i += 2)
+        diff += pcm[i] != pcm[i + 1];
+    CHECK(diff == 0, "%zu frames with L != R", diff);
+    CHECK(rms(pcm, 0, 0.02, 0.09) > 3000, "mono output silent");
+}
+
+static void test_swap(void)
+{
+    printf("swap-mode handover...\n");
+    std::vector<EsLogEntry> log;
+    halt_all(&log, 0);
+    /* osc 4/5: swap pair over short constant tables (+$60 then -$60), each
+     * ~64 DOC samples long; only osc 4 is started */
+    voice(&log, 0, 5, 0x0400, 0xFF, 0x04, 3, 0);
+    w(&log, 0, 0xA5, 0x07);                               /* halted, swap */
+    voice(&log, 0, 4, 0x0400, 0xFF, 0x03, 3, 0);
+    std::vector<int16_t> pcm;
+    EsRenderStats st;
+    render(log, 0.2, 1, &pcm, &st);
+    /* No DOC-level silence between the halves: after the LPF settles the
+     * output never passes near zero for more than a couple of samples. */
+    int run = 0, worst = 0;
+    for (size_t i = 2000; i < pcm.size() / 2; i++) {
+        run = abs(pcm[i * 2]) < 1000 ? run + 1 : 0;
+        if (run > worst)
+            worst = run;
+    }
+    CHECK(worst <= 3, "gap of %d samples between swap halves", worst);
+    CHECK(rms(pcm, 0, 0.05, 0.19) > 5000, "swap pair silent");
+}
+
+static void test_bad_log(void)
+{
+    printf("bad write log rejected...\n");
+    FILE *f = tmpfile();
+    fputs("# comment\n0 0xA0 1\n100 ram 0x1234 0x80\n50 0x40 0xFF\n", f);
+    rewind(f);
+    std::vector<EsLogEntry> log;
+    fflush(stdout);
+    int rc = es_log_load(f, &log);                       /* prints the line */
+    fclose(f);
+    CHECK(rc < 0, "out-of-order log accepted");
+
+    f = tmpfile();
+    fputs("0 0xA0 1   # halt\n\n100 ram 0x1234 0x80\n", f);
+    rewind(f);
+    rc = es_log_load(f, &log);
+    fclose(f);
+    CHECK(rc == 0 && log.size() == 2 && log[1].ram && log[1].addr == 0x1234,
+          "valid log not parsed");
+}
+
+static void bench(void)
+{
+    const int counts[3] = { 8, 16, 32 };
+    for (int t = 0; t < 3; t++) {
+        std::vector<EsLogEntry> log;
+        halt_all(&log, 0);
+        for (int osc = 0; osc < counts[t]; osc++)
+            voice(&log, 0, osc, (uint16_t)(0x140 + osc * 13), 0x40,
+                  (uint8_t)(0x10 + osc * 4), 0, osc & 1);
+        std::vector<int16_t> pcm;
+        EsRenderStats st;
+        render(log, 10.0, 2, &pcm, &st);
+        printf("%d voices, stereo: ", counts[t]);
+        es_report(&st, 1, stdout);
+    }
+}
+
+int main(void)
+{
+    printf("=== ES5503 offline render ===\n");
+    make_image();
+    test_replay();
+    test_mono();
+    test_swap();
+    test_bad_log();
+    bench();
+    if (s_fail) {
+        printf("=== FAILED: %d checks ===\n", s_fail);
+        return 1;
+    }
+    printf("=== PASSED ===\n");
+    return 0;
+}
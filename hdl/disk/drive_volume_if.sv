@@ -34,6 +34,7 @@ interface drive_volume_if();
     logic rd;
     logic wr;
     logic ack;
+    logic err;   // with ack: the request failed (HDD volumes)
 
     modport drive (
         input ready,
@@ -46,7 +47,8 @@ interface drive_volume_if();
         output blk_cnt,
         output rd,
         output wr,
-        input ack
+        input ack,
+        input err
 
     );
 
@@ -61,7 +63,8 @@ interface drive_volume_if();
         input blk_cnt,
         input rd,
         input wr,
-        output ack
+        output ack,
+        output err
 
     );
 
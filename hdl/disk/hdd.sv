@@ -16,8 +16,17 @@
 //     and the card drains it to SDRAM before raising the volume request.
 //   - Two ProDOS units (unit number bit 7 selects drive 1/2), each backed by
 //     a drive_volume_if served by the BL616 (raw 512-byte blocks, LBA 1:1
-//     into the image file). The SDRAM window for unit u is 512 bytes at
-//     HDD_WORD_BASE + u*128 words.
+//     into the image file).
+//   - Each unit's window is a ring of RING_BLOCKS = 2**RING_LOG2 blocks:
+//     block b lives in slot b mod RING_BLOCKS, at word
+//     (u*RING_BLOCKS + slot)*128 of the card's memory port. A READ that
+//     misses asks the MCU for a run of blocks (blk_cnt = run - 1) from the
+//     requested block to the end of its aligned RING_BLOCKS group (clamped
+//     to the volume size) in one request; later READs inside the run are
+//     filled from the ring without a volume request. A WRITE lands in its
+//     own slot, so the run stays coherent; a write that reuses a slot of
+//     the run for a different block drops the run. RING_LOG2 = 0 is the
+//     original one-block window.
 //
 // Registers (s = slot):
 //   $C0s0 (r)   EXECUTE: latch+run command; resets buffer pointer
@@ -36,7 +45,8 @@
 
 module HDD #(
     parameter bit [7:0] ID = 6,
-    parameter bit ENABLE = 1'b1
+    parameter bit ENABLE = 1'b1,
+    parameter int RING_LOG2 = 0         // block windows per unit = 2**RING_LOG2 (0..3)
 ) (
     a2bus_if.slave a2bus_if,
     slot_if.card slot_if,
@@ -117,11 +127,12 @@ module HDD #(
 
     reg vol_rd_r, vol_wr_r;          // request to the selected unit
     reg req_unit_r;                  // unit latched at EXECUTE time
+    reg [5:0] blk_cnt_r;             // blocks - 1 of the pending request
 
     assign volumes[0].lba     = {16'b0, block_h_r, block_l_r};
     assign volumes[1].lba     = {16'b0, block_h_r, block_l_r};
-    assign volumes[0].blk_cnt = 6'd0;   // always one 512-byte block
-    assign volumes[1].blk_cnt = 6'd0;
+    assign volumes[0].blk_cnt = blk_cnt_r;
+    assign volumes[1].blk_cnt = blk_cnt_r;
     assign volumes[0].rd      = vol_rd_r & ~req_unit_r;
     assign volumes[1].rd      = vol_rd_r & req_unit_r;
     assign volumes[0].wr      = vol_wr_r & ~req_unit_r;
@@ -130,6 +141,41 @@ module HDD #(
     assign volumes[1].active  = busy_r & req_unit_r;
 
     wire req_ack_w = req_unit_r ? volumes[1].ack : volumes[0].ack;
+    wire req_err_w = req_unit_r ? volumes[1].err : volumes[0].err;
+
+    // -------------------------------------------------------------------
+    // Block ring: the run of blocks each unit's windows currently hold
+    // -------------------------------------------------------------------
+    localparam int RING_BLOCKS = 1 << RING_LOG2;
+
+    reg        run_valid_r [0:1];
+    reg [15:0] run_lba_r   [0:1];    // first block of the run
+    reg [3:0]  run_len_r   [0:1];    // blocks in the run (1..RING_BLOCKS)
+    reg [3:0]  req_len_r;            // run length asked of the MCU
+
+    wire [15:0] lba_w      = {block_h_r, block_l_r};
+    wire [2:0]  lba_slot_w = 3'(lba_w & 16'(RING_BLOCKS - 1));
+
+    // Selected unit's run vs the requested block
+    wire        sel_run_valid_w = run_valid_r[unit_w];
+    wire [15:0] sel_run_off_w   = 16'(lba_w - run_lba_r[unit_w]);
+    wire [2:0]  sel_run_slot_w  = 3'(run_lba_r[unit_w] & 16'(RING_BLOCKS - 1));
+    wire [2:0]  slot_off_w      = 3'(lba_slot_w - sel_run_slot_w);
+    wire        run_hit_w  = sel_run_valid_w && (sel_run_off_w < {12'b0, run_len_r[unit_w]});
+    // The block's slot holds some other block of the run (same slot, other
+    // group): a WRITE there must drop the run
+    wire        run_alias_w = sel_run_valid_w && !run_hit_w &&
+                              (lba_slot_w >= sel_run_slot_w) &&
+                              ({1'b0, slot_off_w} < run_len_r[unit_w]);
+
+    // Run length for a miss: to the end of the aligned group, clamped to the
+    // volume size (at least one block, so an out-of-range LBA still gets the
+    // MCU's zero-filled answer)
+    wire [3:0]  group_left_w = 4'(RING_BLOCKS) - {1'b0, lba_slot_w};
+    wire [16:0] vol_left_w   = {1'b0, size16_w} - {1'b0, lba_w};
+    wire [3:0]  miss_len_w   = (vol_left_w[16] || vol_left_w == 17'd0) ? 4'd1 :
+                               (vol_left_w < {13'b0, group_left_w}) ? vol_left_w[3:0] :
+                               group_left_w;
 
     // -------------------------------------------------------------------
     // 512-byte dual-port sector buffer
@@ -270,12 +316,15 @@ module HDD #(
     state_t state_r;
 
     reg [6:0]  word_cnt_r;      // 128 words = 512 bytes
+    reg [2:0]  slot_r;          // ring slot of the block being moved
     reg [31:0] word_r;
     reg [1:0]  byte_cnt_r;
     reg [26:0] timeout_r;       // ~2.5s @ 54MHz: BL616 gone -> I/O error
 
-    // SDRAM window: 128 words per unit at HDD_WORD_BASE (added by the arbiter)
-    assign ram_hdd_if.addr    = {13'b0, req_unit_r, word_cnt_r};
+    // Window: RING_BLOCKS x 128 words per unit at HDD_WORD_BASE (added by the
+    // arbiter)
+    wire [9:0] ring_word_w = 10'({slot_r, word_cnt_r} & 10'((RING_BLOCKS << 7) - 1));
+    assign ram_hdd_if.addr    = 21'((21'(req_unit_r) << (RING_LOG2 + 7)) | 21'(ring_word_w));
     assign ram_hdd_if.data    = word_r;
     assign ram_hdd_if.byte_en = 4'b1111;
     assign ram_hdd_if.burst   = 1'b0;
@@ -297,16 +346,31 @@ module HDD #(
             ram_wr_r   <= 1'b0;
             fsm_we_r   <= 1'b0;
             word_cnt_r <= 7'd0;
+            slot_r     <= 3'd0;
             byte_cnt_r <= 2'd0;
             word_r     <= 32'b0;
             fsm_addr_r <= 9'd0;
             fsm_wdata_r <= 8'h00;
             timeout_r  <= 27'd0;
+            blk_cnt_r  <= 6'd0;
+            req_len_r  <= 4'd1;
+            for (int i = 0; i < 2; i++) begin
+                run_valid_r[i] <= 1'b0;
+                run_lba_r[i]   <= 16'd0;
+                run_len_r[i]   <= 4'd0;
+            end
         end else begin
             ram_rd_r <= 1'b0;
             ram_wr_r <= 1'b0;
             fsm_we_r <= 1'b0;
 
+            // A volume that goes away (eject / remount) takes its run with
+            // it: the MCU may reopen a different image behind the same unit
+            if (!(volumes[0].mounted && volumes[0].ready))
+                run_valid_r[0] <= 1'b0;
+            if (!(volumes[1].mounted && volumes[1].ready))
+                run_valid_r[1] <= 1'b0;
+
             case (state_r)
 
                 ST_IDLE: begin
@@ -315,6 +379,7 @@ module HDD #(
                         timeout_r  <= 27'd0;
                         word_cnt_r <= 7'd0;
                         byte_cnt_r <= 2'd0;
+                        slot_r     <= lba_slot_w;
                         case (command_r)
                             8'h00: begin   // STATUS: immediate
                                 err_r    <= ~(vol_mounted_w & vol_ready_w);
@@ -324,10 +389,18 @@ module HDD #(
                             8'h01: begin   // READ
                                 if (!(vol_mounted_w & vol_ready_w)) begin
                                     err_r <= 1'b1; result_r <= PRODOS_NO_DEVICE;
+                                end else if (run_hit_w) begin
+                                    // already in the ring: no volume request
+                                    busy_r  <= 1'b1;
+                                    state_r <= ST_FILL_ISSUE;
                                 end else begin
-                                    busy_r   <= 1'b1;
-                                    vol_rd_r <= 1'b1;
-                                    state_r  <= ST_RD_ACK;
+                                    // fetch a run; the ring is stale until ack
+                                    run_valid_r[unit_w] <= 1'b0;
+                                    req_len_r <= miss_len_w;
+                                    blk_cnt_r <= 6'(miss_len_w - 1'b1);
+                                    busy_r    <= 1'b1;
+                                    vol_rd_r  <= 1'b1;
+                                    state_r   <= ST_RD_ACK;
                                 end
                             end
                             8'h02: begin   // WRITE (buffer already CPU-filled)
@@ -336,6 +409,9 @@ module HDD #(
                                 end else if (vol_readonly_w) begin
                                     err_r <= 1'b1; result_r <= PRODOS_PROTECT;
                                 end else begin
+                                    if (run_alias_w)
+                                        run_valid_r[unit_w] <= 1'b0;
+                                    blk_cnt_r  <= 6'd0;
                                     busy_r     <= 1'b1;
                                     fsm_addr_r <= 9'd0;
                                     state_r    <= ST_DRAIN_PRIME;
@@ -357,12 +433,21 @@ module HDD #(
                     end
                 end
 
-                // ---- READ: wait for the BL616 to load the block ----
+                // ---- READ: wait for the BL616 to load the run ----
                 ST_RD_ACK: begin
                     timeout_r <= 27'(timeout_r + 1'b1);
-                    if (req_ack_w) begin
+                    if (req_ack_w && req_err_w) begin
+                        vol_rd_r <= 1'b0;
+                        busy_r   <= 1'b0;
+                        err_r    <= 1'b1;
+                        result_r <= PRODOS_IO_ERROR;
+                        state_r  <= ST_IDLE;
+                    end else if (req_ack_w) begin
                         vol_rd_r   <= 1'b0;
                         word_cnt_r <= 7'd0;
+                        run_valid_r[req_unit_r] <= 1'b1;
+                        run_lba_r[req_unit_r]   <= lba_w;
+                        run_len_r[req_unit_r]   <= req_len_r;
                         state_r    <= ST_FILL_ISSUE;
                     end else if (&timeout_r) begin
                         vol_rd_r <= 1'b0;
@@ -451,13 +536,15 @@ module HDD #(
                 // ---- WRITE: wait for the BL616 to flush the block ----
                 ST_WR_ACK: begin
                     timeout_r <= 27'(timeout_r + 1'b1);
-                    if (req_ack_w) begin
+                    if (req_ack_w && !req_err_w) begin
                         vol_wr_r <= 1'b0;
                         busy_r   <= 1'b0;
                         err_r    <= 1'b0;
                         result_r <= PRODOS_OK;
                         state_r  <= ST_IDLE;
-                    end else if (&timeout_r) begin
+                    end else if (req_ack_w || &timeout_r) begin
+                        // the slot now holds data the image never got
+                        run_valid_r[req_unit_r] <= 1'b0;
                         vol_wr_r <= 1'b0;
                         busy_r   <= 1'b0;
                         err_r    <= 1'b1;
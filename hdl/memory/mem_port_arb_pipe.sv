@@ -0,0 +1,382 @@
+//
+// Pipelined memory port arbiter — N queued clients share one controller port
+//
+// (c) 2026 Ed Anuff <ed@a2fpga.com>
+//
+// Permission to use, copy, modify, and/or distribute this software for any
+// purpose with or without fee is hereby granted, provided that the above
+// copyright notice and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+// WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+// ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+// WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+// ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+// OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+//
+// Description:
+//
+// Drop-in variant of mem_port_arb for clients that move data in bulk (MCU
+// XFER streams into the Disk II / HDD windows). mem_port_arb holds the
+// controller for one request at a time and spends a dead cycle between
+// grants, so every client serialises behind the others at single-word
+// granularity. This version:
+//
+// - Queues 2^QUEUE_LOG2 requests per client. A client's available is "its
+//   queue has room", so a posting client (the XFER write FIFO) can issue
+//   back-to-back without waiting for ready; pulse-and-wait clients (drive_ii,
+//   hdd) see no difference. The client base address is added on enqueue,
+//   off the issue path.
+//
+// - Keeps up to two requests in flight at the controller, tagged in an
+//   in-flight FIFO {owner, write, beats, enqueue time}. Completion beats
+//   return in issue order (the controller serves one port in order), so the
+//   head tag routes each ready/q beat to its owner. The controller's
+//   per-port request slot is a single entry that it frees when it starts
+//   the request, so the next request is issued as soon as the head has
+//   returned its first beat: the next address overlaps the rest of a burst
+//   and the return trip through mem_port_cdc.
+//
+// - Supports burst reads: burst=1 returns BURST_BEATS ready pulses (the
+//   controller's READ_BURST_WORDS), each routed to the owner with q; the
+//   owner's q latch ends up holding the last beat.
+//
+// - Grants by weighted round robin: the client holding the turn keeps it for
+//   up to CLIENT_WEIGHT[i] consecutive grants while it has work, then the
+//   turn passes to the next client with work. A client flagged in
+//   CLIENT_CRITICAL pre-empts the rotation whenever it has a request queued
+//   (lowest index first), for real-time consumers like drive_ii whose fetch
+//   must land within one nibble time.
+//
+// Requests go out as single-cycle rd/wr pulses with at least one low cycle
+// between them — the controller (and mem_port_cdc's 2x-wide registered
+// copy) edge-detects them. All selection state is registered, and the
+// per-cycle logic is a NUM_CLIENTS-wide priority pick plus queue pointer
+// updates — it stays in the same clk_logic budget as mem_port_arb, and the
+// controller still sees one port (the reason the arbiter exists:
+// sdram_ports' priority/mux cone fails 108 MHz timing above 7 ports).
+//
+// Statistics, per client: requests accepted, requests dropped (pulsed into
+// a full queue), wait cycles (cycles a queued request sat un-issued) and max
+// latency (enqueue to last beat, in clk_i cycles). dbg_snap_i copies the live counters to the dbg_* outputs so a
+// slow reader sees one consistent set; dbg_clear_i zeroes them (after the
+// snapshot if both pulse together). Counters saturate.
+//
+
+module mem_port_arb_pipe #(
+    parameter NUM_CLIENTS = 2,
+    parameter PORT_ADDR_WIDTH = 21,
+    parameter DATA_WIDTH = 32,
+    parameter DQM_WIDTH = 4,
+    parameter PORT_OUTPUT_WIDTH = 32,
+    parameter [PORT_ADDR_WIDTH-1:0] CLIENT_BASE_ADDR [NUM_CLIENTS] = '{NUM_CLIENTS{0}},
+    parameter QUEUE_LOG2 = 1,       // per-client request queue depth, log2 (>= 1)
+    parameter BURST_BEATS = 2,      // ready pulses per burst read
+    parameter [3:0] CLIENT_WEIGHT [NUM_CLIENTS] = '{NUM_CLIENTS{4'd1}},
+    parameter [NUM_CLIENTS-1:0] CLIENT_CRITICAL = '0
+) (
+    input clk_i,
+    input rst_n_i,
+
+    mem_port_if.controller clients[NUM_CLIENTS-1:0],
+    mem_port_if.client controller,
+
+    input             dbg_snap_i,
+    input             dbg_clear_i,
+    output reg [31:0] dbg_req_o     [NUM_CLIENTS-1:0],
+    output reg [31:0] dbg_wait_o    [NUM_CLIENTS-1:0],
+    output reg [15:0] dbg_max_lat_o [NUM_CLIENTS-1:0],
+    output reg [15:0] dbg_drop_o    [NUM_CLIENTS-1:0]
+);
+
+    localparam CW = (NUM_CLIENTS > 1) ? $clog2(NUM_CLIENTS) : 1;
+    localparam QD = 1 << QUEUE_LOG2;
+    localparam QN = NUM_CLIENTS * QD;
+
+    // Plain-array mirrors of the client interface signals (interface arrays
+    // cannot be indexed with a procedural variable)
+    wire req_rd_w[NUM_CLIENTS-1:0];
+    wire req_wr_w[NUM_CLIENTS-1:0];
+    wire cl_burst_w[NUM_CLIENTS-1:0];
+    wire [PORT_ADDR_WIDTH-1:0] cl_addr_w[NUM_CLIENTS-1:0];
+    wire [DATA_WIDTH-1:0]      cl_data_w[NUM_CLIENTS-1:0];
+    wire [DQM_WIDTH-1:0]       cl_be_w  [NUM_CLIENTS-1:0];
+
+    // =========================================================================
+    // Per-client request queues (flattened: entry = client * QD + slot)
+    // =========================================================================
+    reg                        q_wr_r   [QN-1:0];
+    reg                        q_burst_r[QN-1:0];
+    reg [PORT_ADDR_WIDTH-1:0]  q_addr_r [QN-1:0];
+    reg [DATA_WIDTH-1:0]       q_data_r [QN-1:0];
+    reg [DQM_WIDTH-1:0]        q_be_r   [QN-1:0];
+    reg [15:0]                 q_time_r [QN-1:0];
+    reg [QUEUE_LOG2:0]         q_wp_r   [NUM_CLIENTS-1:0];
+    reg [QUEUE_LOG2:0]         q_rp_r   [NUM_CLIENTS-1:0];
+
+    wire [NUM_CLIENTS-1:0] q_nonempty_w;
+    wire [NUM_CLIENTS-1:0] q_full_w;
+
+    reg [15:0] now_r;           // free-running cycle stamp for latency
+    reg        ctl_up_r;        // controller has reported available once
+
+    // =========================================================================
+    // In-flight tags (issue order == completion order)
+    // =========================================================================
+    reg          if_valid_r [1:0];
+    reg [CW-1:0] if_owner_r [1:0];
+    reg          if_wr_r    [1:0];
+    reg [3:0]    if_beats_r [1:0];
+    reg [15:0]   if_time_r  [1:0];
+    reg [3:0]    head_seen_r;       // beats the head has returned so far
+
+    wire         head_valid_w = if_valid_r[0];
+    wire [CW-1:0] head_owner_w = if_owner_r[0];
+    wire         beat_w       = controller.ready && head_valid_w;
+    wire         head_done_w  = beat_w && (head_seen_r + 4'd1 >= if_beats_r[0]);
+
+    // Controller request (single-cycle pulse, held address/data)
+    reg req_r, req_is_wr_r, burst_r;
+    reg [PORT_ADDR_WIDTH-1:0] addr_r;
+    reg [DATA_WIDTH-1:0] data_r;
+    reg [DQM_WIDTH-1:0] be_r;
+
+    generate
+        for (genvar gi = 0; gi < NUM_CLIENTS; gi++) begin : client_io
+            assign req_rd_w[gi] = clients[gi].rd;
+            assign req_wr_w[gi] = clients[gi].wr;
+            assign cl_burst_w[gi] = clients[gi].burst;
+            assign cl_addr_w[gi] = clients[gi].addr;
+            assign cl_data_w[gi] = clients[gi].data;
+            assign cl_be_w[gi] = clients[gi].byte_en;
+            assign q_nonempty_w[gi] = (q_wp_r[gi] != q_rp_r[gi]);
+            assign q_full_w[gi] = (q_wp_r[gi][QUEUE_LOG2-1:0] == q_rp_r[gi][QUEUE_LOG2-1:0]) &&
+                                  (q_wp_r[gi][QUEUE_LOG2] != q_rp_r[gi][QUEUE_LOG2]);
+            assign clients[gi].ready = beat_w && (head_owner_w == CW'(gi));
+            assign clients[gi].available = ctl_up_r && !q_full_w[gi];
+        end
+    endgenerate
+
+    // Per-client private read-data latch — same contract as mem_port_arb:
+    // clients consume q well after their ready pulse, so each client keeps
+    // its own last read beat; q passes through on the beat cycle itself.
+    // Write completions do not latch.
+    reg [DATA_WIDTH-1:0] client_q_r [NUM_CLIENTS-1:0];
+    generate
+        for (genvar gq = 0; gq < NUM_CLIENTS; gq++) begin : client_q
+            wire own_rd_beat_w = beat_w && !if_wr_r[0] && (head_owner_w == CW'(gq));
+            always @(posedge clk_i) begin
+                if (own_rd_beat_w) client_q_r[gq] <= controller.q;
+            end
+            assign clients[gq].q = own_rd_beat_w ? controller.q : client_q_r[gq];
+        end
+    endgenerate
+
+    // =========================================================================
+    // Grant selection (weighted round robin, critical override)
+    // =========================================================================
+    reg [CW-1:0] turn_r;        // client holding the round-robin turn
+    reg [3:0]    credit_r;      // grants left in the current turn
+
+    // The controller's request slot is free once nothing is in flight, or the
+    // only in-flight request has started returning beats. One low cycle
+    // between pulses keeps the edge detectors armed.
+    wire slot_free_w = !req_r && !if_valid_r[1] &&
+                       (!head_valid_w || head_seen_r != 4'd0 || beat_w);
+
+    reg          pick_valid_w;
+    reg [CW-1:0] pick_w;
+    reg          pick_crit_w;
+    integer k;
+    always @(*) begin
+        pick_valid_w = 1'b0;
+        pick_w       = turn_r;
+        pick_crit_w  = 1'b0;
+        // Critical clients first, lowest index wins
+        for (k = NUM_CLIENTS - 1; k >= 0; k = k - 1) begin
+            if (CLIENT_CRITICAL[k] && q_nonempty_w[k]) begin
+                pick_valid_w = 1'b1;
+                pick_w       = CW'(k);
+                pick_crit_w  = 1'b1;
+            end
+        end
+        if (!pick_crit_w) begin
+            if (q_nonempty_w[turn_r] && credit_r != 4'd0) begin
+                pick_valid_w = 1'b1;
+                pick_w       = turn_r;
+            end else begin
+                // Next client after the turn holder with work (wrapping)
+                for (k = 2 * NUM_CLIENTS - 1; k >= 1; k = k - 1) begin
+                    if (k > turn_r && k <= turn_r + NUM_CLIENTS &&
+                        q_nonempty_w[k % NUM_CLIENTS]) begin
+                        pick_valid_w = 1'b1;
+                        pick_w       = CW'(k % NUM_CLIENTS);
+                    end
+                end
+            end
+        end
+    end
+
+    wire issue_w = slot_free_w && pick_valid_w;
+
+    // =========================================================================
+    // Queue, issue and completion
+    // =========================================================================
+    integer i;
+    always @(posedge clk_i) begin
+        if (!rst_n_i) begin
+            for (i = 0; i < NUM_CLIENTS; i = i + 1) begin
+                q_wp_r[i] <= '0;
+                q_rp_r[i] <= '0;
+            end
+            if_valid_r[0] <= 1'b0;
+            if_valid_r[1] <= 1'b0;
+            head_seen_r   <= 4'd0;
+            req_r    <= 1'b0;
+            turn_r   <= '0;
+            credit_r <= 4'd0;
+            now_r    <= 16'd0;
+            ctl_up_r <= 1'b0;
+        end else begin
+            now_r <= now_r + 16'd1;
+            if (controller.available) ctl_up_r <= 1'b1;
+            req_r <= 1'b0;
+
+            // Enqueue request pulses. A client should never pulse into a full
+            // queue (available); one that does loses the request, which shows
+            // up in the drop counter. Pulse-and-wait clients hold at most one
+            // entry.
+            for (i = 0; i < NUM_CLIENTS; i = i + 1) begin
+                if ((req_rd_w[i] || req_wr_w[i]) && !q_full_w[i]) begin
+                    q_wr_r   [i * QD + q_wp_r[i][QUEUE_LOG2-1:0]] <= req_wr_w[i];
+                    q_burst_r[i * QD + q_wp_r[i][QUEUE_LOG2-1:0]] <= cl_burst_w[i] && !req_wr_w[i];
+                    q_addr_r [i * QD + q_wp_r[i][QUEUE_LOG2-1:0]] <= CLIENT_BASE_ADDR[i] + cl_addr_w[i];
+                    q_data_r [i * QD + q_wp_r[i][QUEUE_LOG2-1:0]] <= cl_data_w[i];
+                    q_be_r   [i * QD + q_wp_r[i][QUEUE_LOG2-1:0]] <= cl_be_w[i];
+                    q_time_r [i * QD + q_wp_r[i][QUEUE_LOG2-1:0]] <= now_r;
+                    q_wp_r[i] <= q_wp_r[i] + 1'b1;
+                end
+            end
+
+            // Completion beats retire the head tag; the second tag moves up
+            if (beat_w) begin
+                if (head_done_w) begin
+                    head_seen_r   <= 4'd0;
+                    if_valid_r[0] <= if_valid_r[1];
+                    if_owner_r[0] <= if_owner_r[1];
+                    if_wr_r[0]    <= if_wr_r[1];
+                    if_beats_r[0] <= if_beats_r[1];
+                    if_time_r[0]  <= if_time_r[1];
+                    if_valid_r[1] <= 1'b0;
+                end else begin
+                    head_seen_r <= head_seen_r + 4'd1;
+                end
+            end
+
+            // Issue the picked client's queue head
+            if (issue_w) begin
+                req_r       <= 1'b1;
+                req_is_wr_r <= q_wr_r   [pick_w * QD + q_rp_r[pick_w][QUEUE_LOG2-1:0]];
+                burst_r     <= q_burst_r[pick_w * QD + q_rp_r[pick_w][QUEUE_LOG2-1:0]];
+                addr_r      <= q_addr_r [pick_w * QD + q_rp_r[pick_w][QUEUE_LOG2-1:0]];
+                data_r      <= q_data_r [pick_w * QD + q_rp_r[pick_w][QUEUE_LOG2-1:0]];
+                be_r        <= q_be_r   [pick_w * QD + q_rp_r[pick_w][QUEUE_LOG2-1:0]];
+                q_rp_r[pick_w] <= q_rp_r[pick_w] + 1'b1;
+
+                // Tag it: the head slot if it is empty or retiring now,
+                // otherwise the second slot
+                if (!head_valid_w || head_done_w) begin
+                    if_valid_r[0] <= 1'b1;
+                    if_owner_r[0] <= pick_w;
+                    if_wr_r[0]    <= q_wr_r[pick_w * QD + q_rp_r[pick_w][QUEUE_LOG2-1:0]];
+                    if_beats_r[0] <= q_burst_r[pick_w * QD + q_rp_r[pick_w][QUEUE_LOG2-1:0]] ?
+                                     4'(BURST_BEATS) : 4'd1;
+                    if_time_r[0]  <= q_time_r[pick_w * QD + q_rp_r[pick_w][QUEUE_LOG2-1:0]];
+                end else begin
+                    if_valid_r[1] <= 1'b1;
+                    if_owner_r[1] <= pick_w;
+                    if_wr_r[1]    <= q_wr_r[pick_w * QD + q_rp_r[pick_w][QUEUE_LOG2-1:0]];
+                    if_beats_r[1] <= q_burst_r[pick_w * QD + q_rp_r[pick_w][QUEUE_LOG2-1:0]] ?
+                                     4'(BURST_BEATS) : 4'd1;
+                    if_time_r[1]  <= q_time_r[pick_w * QD + q_rp_r[pick_w][QUEUE_LOG2-1:0]];
+                end
+
+                // Round-robin bookkeeping (critical grants leave the turn alone)
+                if (!pick_crit_w) begin
+                    if (pick_w == turn_r && credit_r != 4'd0) begin
+                        credit_r <= credit_r - 4'd1;
+                    end else begin
+                        turn_r   <= pick_w;
+                        credit_r <= CLIENT_WEIGHT[pick_w] - 4'd1;
+                    end
+                end
+            end else if (!pick_crit_w && !q_nonempty_w[turn_r]) begin
+                // The turn holder ran dry: forfeit its remaining credit
+                credit_r <= 4'd0;
+            end
+        end
+    end
+
+    assign controller.rd = req_r && !req_is_wr_r;
+    assign controller.wr = req_r && req_is_wr_r;
+    assign controller.addr = addr_r;
+    assign controller.data = data_r;
+    assign controller.byte_en = be_r;
+    assign controller.burst = burst_r;
+
+    // =========================================================================
+    // Statistics
+    // =========================================================================
+    reg [31:0] st_req_r     [NUM_CLIENTS-1:0];
+    reg [31:0] st_wait_r    [NUM_CLIENTS-1:0];
+    reg [15:0] st_max_lat_r [NUM_CLIENTS-1:0];
+    reg [15:0] st_drop_r    [NUM_CLIENTS-1:0];
+
+    wire [15:0] head_lat_w = now_r - if_time_r[0];
+
+    always @(posedge clk_i) begin
+        if (!rst_n_i) begin
+            for (i = 0; i < NUM_CLIENTS; i = i + 1) begin
+                st_req_r[i]      <= 32'd0;
+                st_wait_r[i]     <= 32'd0;
+                st_max_lat_r[i]  <= 16'd0;
+                st_drop_r[i]     <= 16'd0;
+                dbg_req_o[i]     <= 32'd0;
+                dbg_wait_o[i]    <= 32'd0;
+                dbg_max_lat_o[i] <= 16'd0;
+                dbg_drop_o[i]    <= 16'd0;
+            end
+        end else begin
+            for (i = 0; i < NUM_CLIENTS; i = i + 1) begin
+                if (dbg_snap_i) begin
+                    dbg_req_o[i]     <= st_req_r[i];
+                    dbg_wait_o[i]    <= st_wait_r[i];
+                    dbg_max_lat_o[i] <= st_max_lat_r[i];
+                    dbg_drop_o[i]    <= st_drop_r[i];
+                end
+                if (dbg_clear_i) begin
+                    st_req_r[i]     <= 32'd0;
+                    st_wait_r[i]    <= 32'd0;
+                    st_max_lat_r[i] <= 16'd0;
+                    st_drop_r[i]    <= 16'd0;
+                end else begin
+                    // Same accept condition as the enqueue above
+                    if ((req_rd_w[i] || req_wr_w[i]) && !q_full_w[i] &&
+                        st_req_r[i] != 32'hFFFFFFFF)
+                        st_req_r[i] <= st_req_r[i] + 32'd1;
+                    if ((req_rd_w[i] || req_wr_w[i]) && q_full_w[i] &&
+                        st_drop_r[i] != 16'hFFFF)
+                        st_drop_r[i] <= st_drop_r[i] + 16'd1;
+                    if (q_nonempty_w[i] && !(issue_w && pick_w == CW'(i)) &&
+                        st_wait_r[i] != 32'hFFFFFFFF)
+                        st_wait_r[i] <= st_wait_r[i] + 32'd1;
+                    if (head_done_w && head_owner_w == CW'(i) &&
+                        head_lat_w > st_max_lat_r[i])
+                        st_max_lat_r[i] <= head_lat_w;
+                end
+            end
+        end
+    end
+
+endmodule
@@ -84,7 +84,18 @@ module sdram #(
 
     parameter PORT_ADDR_WIDTH = 25,
     parameter PORT_BURST_LENGTH = BURST_LENGTH,  // 1, 2, 4, 8 words per read
-    parameter PORT_OUTPUT_WIDTH = PORT_BURST_LENGTH * DATA_WIDTH
+    parameter PORT_OUTPUT_WIDTH = PORT_BURST_LENGTH * DATA_WIDTH,
+
+    // Port whose burst reads return 8 words (-1 = none). The extra words come
+    // from READ commands chained every BURST_LENGTH cycles in the open row, so
+    // the mode register is unchanged; the client must keep each burst inside
+    // one row (8-word aligned addresses always are).
+    parameter integer READ_BURST8_PORT = -1,
+    // Port whose burst writes store 8 words in one row activation (-1 = none).
+    // Word 0 comes from port_data, words 1-7 from wide_wr_data_hi, each gated
+    // by wide_wr_word_en. Issued as consecutive single-location WRITEs, so
+    // WRITE_BURST stays 0 for every other port. Same row rule as above.
+    parameter integer WIDE_WR_PORT = -1
 ) (
     input wire clk,
     input wire sdram_clk,
@@ -104,6 +115,10 @@ module sdram #(
     output wire port_available[NUM_PORTS-1:0],  // The port is able to be used
     output reg  port_ready     [NUM_PORTS-1:0],  // The port has finished its task. Will rise for a single cycle
 
+    // WIDE_WR_PORT sideband, sampled together with that port's wr
+    input wire [7*DATA_WIDTH-1:0] wide_wr_data_hi,  // Words 1-7 (word 1 in the low bits)
+    input wire [7:0]              wide_wr_word_en,  // Per-word write enable, bit 0 = port_data
+
     inout  wire [DATA_WIDTH-1:0] SDRAM_DQ,    // Bidirectional data bus
     output reg  [ ROW_WIDTH-1:0] SDRAM_A,     // Address bus
     output reg  [ DQM_WIDTH-1:0] SDRAM_DQM,   // High/low byte mask
@@ -202,7 +217,8 @@ module sdram #(
         DELAY,
         WRITE,
         READ,
-        READ_OUTPUT
+        READ_OUTPUT,
+        WRITE_CHAIN
     } state_fsm;
 
     state_fsm state;
@@ -249,6 +265,18 @@ module sdram #(
 
     reg [3:0] read_expected_words;
 
+    // READ_BURST8_PORT: READ commands still to chain after the first one
+    localparam integer READ_CHAIN_CMDS = (BURST_LENGTH >= 8) ? 1 : 8 / BURST_LENGTH;
+    reg [3:0]           read_chain_left;
+    reg [3:0]           read_chain_timer;
+    reg [COL_WIDTH-1:0] read_chain_col;
+
+    // WIDE_WR_PORT: queued sideband and the words still to write
+    reg [7*DATA_WIDTH-1:0] wide_data_queue;
+    reg [7:0]              wide_word_en_queue;
+    reg [2:0]              write_chain_left;
+    reg [COL_WIDTH-1:0]    write_chain_col;
+
     wire port_queue[NUM_PORTS-1:0];
 
     generate
@@ -349,6 +377,14 @@ module sdram #(
 
             dq_output <= 0;
 
+            read_chain_left <= 0;
+            read_chain_timer <= 0;
+            read_chain_col <= 0;
+            wide_data_queue <= 0;
+            wide_word_en_queue <= 0;
+            write_chain_left <= 0;
+            write_chain_col <= 0;
+
         end else begin
 
 
@@ -362,6 +398,12 @@ module sdram #(
                     port_byte_en_queue[i] <= port_byte_en[i];
                     port_addr_queue[i] <= port_addr[i];
                     port_data_queue[i] <= port_data[i];
+
+                    if (WIDE_WR_PORT >= 0 && i == WIDE_WR_PORT) begin
+                        port_burst_queue[i] <= port_burst[i];
+                        wide_data_queue <= wide_wr_data_hi;
+                        wide_word_en_queue <= wide_wr_word_en;
+                    end
                 end else if (port_rd_req[i]  /*&& current_io_operation != IO_READ*/) begin
                     port_rd_queue[i]   <= 1;
                     port_burst_queue[i] <= port_burst[i];
@@ -467,8 +509,11 @@ module sdram #(
                 WRITE: begin
                     // Write to the selected row
                     port_selection active_port_entries;
+                    logic wide_w;
+
+                    wide_w = (WIDE_WR_PORT >= 0) && (active_port == WIDE_WR_PORT) &&
+                             port_burst_queue[active_port];
 
-                    state <= DELAY;
                     // A write must wait for auto precharge (tWR) and precharge command period (tRP)
                     // Takes one cycle to get back to IDLE, and another to read command
                     delay_counter <= CYCLES_AFTER_WRITE_FOR_NEXT_COMMAND;
@@ -480,21 +525,55 @@ module sdram #(
                     // NOTE: Bank is still set from ACTIVE command assertion
                     // High bit enables auto precharge. I assume the top 2 bits are unused
                     SDRAM_A <= '0;
-                    SDRAM_A[PRECHARGE_BIT] <= 1'b1;
+                    SDRAM_A[PRECHARGE_BIT] <= !wide_w;
                     SDRAM_A[COL_WIDTH-1:0] <= active_port_entries.port_addr;
                     // Enable DQ output
                     dq_output <= 1;
                     sdram_data <= active_port_entries.port_data;
 
-                    // Use byte enable from port
-                    SDRAM_DQM <= ~active_port_entries.port_byte_en;
+                    if (wide_w) begin
+                        // Wide write: words 1-7 follow as one WRITE per cycle
+                        state <= WRITE_CHAIN;
+                        write_chain_left <= 3'd7;
+                        write_chain_col <= active_port_entries.port_addr + 1'd1;
+                        port_burst_queue[active_port] <= 0;
+                        SDRAM_DQM <= wide_word_en_queue[0] ? ~active_port_entries.port_byte_en : '1;
+                    end else begin
+                        state <= DELAY;
+                        // Use byte enable from port
+                        SDRAM_DQM <= ~active_port_entries.port_byte_en;
+                    end
+                end
+                WRITE_CHAIN: begin
+                    // Next word of a WIDE_WR_PORT write into the open row;
+                    // the last one auto precharges.
+                    sdram_command <= COMMAND_WRITE;
+
+                    SDRAM_A <= '0;
+                    SDRAM_A[PRECHARGE_BIT] <= (write_chain_left == 3'd1);
+                    SDRAM_A[COL_WIDTH-1:0] <= write_chain_col;
+                    sdram_data <= wide_data_queue[DATA_WIDTH-1:0];
+                    SDRAM_DQM <= wide_word_en_queue[1] ? ~port_byte_en_queue[active_port] : '1;
+
+                    wide_data_queue <= wide_data_queue >> DATA_WIDTH;
+                    wide_word_en_queue <= wide_word_en_queue >> 1;
+                    write_chain_col <= write_chain_col + 1'd1;
+                    write_chain_left <= write_chain_left - 3'd1;
+
+                    if (write_chain_left == 3'd1)
+                        state <= DELAY;
                 end
                 READ: begin
                     // Read to the selected row
                     port_selection active_port_entries;
                     logic [3:0] expected_words_w;
+                    logic chain_w;
 
-                    expected_words_w = port_burst_queue[active_port] ? 4'(READ_BURST_WORDS) : 4'd1;
+                    chain_w = (READ_BURST8_PORT >= 0) && (active_port == READ_BURST8_PORT) &&
+                              port_burst_queue[active_port] && (READ_CHAIN_CMDS > 1);
+                    expected_words_w = !port_burst_queue[active_port] ? 4'd1 :
+                                       ((READ_BURST8_PORT >= 0) && (active_port == READ_BURST8_PORT)) ?
+                                       4'd8 : 4'(READ_BURST_WORDS);
                     read_expected_words <= expected_words_w;
                     read_counter <= 0;
 
@@ -521,11 +600,20 @@ module sdram #(
                     // NOTE: Bank is still set from ACTIVE command assertion
                     // High bit enables auto precharge. I assume the top 2 bits are unused
                     SDRAM_A <= '0;
-                    SDRAM_A[PRECHARGE_BIT] <= 1'b1;
+                    SDRAM_A[PRECHARGE_BIT] <= !chain_w;
                     SDRAM_A[COL_WIDTH-1:0] <= active_port_entries.port_addr;
 
                     // Fetch all bytes
                     SDRAM_DQM <= 0;
+
+                    if (chain_w) begin
+                        // READ_BURST8_PORT: the remaining READs are issued
+                        // below, one per BURST_LENGTH cycles, so the data
+                        // beats run back to back.
+                        read_chain_left <= 4'(READ_CHAIN_CMDS - 1);
+                        read_chain_timer <= 4'(BURST_LENGTH - 1);
+                        read_chain_col <= active_port_entries.port_addr + COL_WIDTH'(BURST_LENGTH);
+                    end
                 end
                 READ_OUTPUT: begin
                     // Read data beat is available.
@@ -547,6 +635,23 @@ module sdram #(
 
                 end
             endcase
+
+            // Chained READs for READ_BURST8_PORT. They land while the FSM is
+            // in DELAY/READ_OUTPUT for the first READ, where no other command
+            // is issued (an 8-word request never needs BURST_TERMINATE).
+            if (read_chain_left != 0) begin
+                if (read_chain_timer != 0) begin
+                    read_chain_timer <= read_chain_timer - 4'd1;
+                end else begin
+                    sdram_command <= COMMAND_READ;
+                    SDRAM_A <= '0;
+                    SDRAM_A[PRECHARGE_BIT] <= (read_chain_left == 4'd1);
+                    SDRAM_A[COL_WIDTH-1:0] <= read_chain_col;
+                    read_chain_col <= read_chain_col + COL_WIDTH'(BURST_LENGTH);
+                    read_chain_left <= read_chain_left - 4'd1;
+                    read_chain_timer <= 4'(BURST_LENGTH - 1);
+                end
+            end
         end
     end
 
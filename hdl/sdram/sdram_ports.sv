@@ -86,7 +86,11 @@ module sdram_ports #(
     // Per-port base address in word-address space.
     // Clients address from 0; the wrapper adds this offset before
     // passing addresses to the SDRAM controller.
-    parameter [PORT_ADDR_WIDTH-1:0] PORT_BASE_ADDR [NUM_PORTS] = '{NUM_PORTS{0}}
+    parameter [PORT_ADDR_WIDTH-1:0] PORT_BASE_ADDR [NUM_PORTS] = '{NUM_PORTS{0}},
+
+    // 8-word burst read port and 8-word wide write port (-1 = none); see sdram.sv
+    parameter integer READ_BURST8_PORT = -1,
+    parameter integer WIDE_WR_PORT = -1
 ) (
     input wire clk,
     input wire sdram_clk,
@@ -96,6 +100,10 @@ module sdram_ports #(
     // Ports
     mem_port_if.controller ports[NUM_PORTS-1:0],
 
+    // WIDE_WR_PORT sideband (same clock and timing as that port's request)
+    input wire [7*DATA_WIDTH-1:0] wide_wr_data_hi,
+    input wire [7:0]              wide_wr_word_en,
+
     inout  wire [DATA_WIDTH-1:0] SDRAM_DQ,    // Bidirectional data bus
     output reg  [ ROW_WIDTH-1:0] SDRAM_A,     // Address bus
     output reg  [ DQM_WIDTH-1:0] SDRAM_DQM,   // High/low byte mask
@@ -192,7 +200,9 @@ module sdram_ports #(
 
         .PORT_ADDR_WIDTH  (PORT_ADDR_WIDTH),
         .PORT_BURST_LENGTH(PORT_BURST_LENGTH),
-        .PORT_OUTPUT_WIDTH(PORT_OUTPUT_WIDTH)
+        .PORT_OUTPUT_WIDTH(PORT_OUTPUT_WIDTH),
+        .READ_BURST8_PORT(READ_BURST8_PORT),
+        .WIDE_WR_PORT(WIDE_WR_PORT)
     ) sdram_inst (
         .clk(clk),
         .sdram_clk(sdram_clk),
@@ -210,6 +220,9 @@ module sdram_ports #(
         .port_available(port_available),
         .port_ready(port_ready),
 
+        .wide_wr_data_hi(wide_wr_data_hi),
+        .wide_wr_word_en(wide_wr_word_en),
+
         .SDRAM_DQ(SDRAM_DQ),
         .SDRAM_A(SDRAM_A),
         .SDRAM_DQM(SDRAM_DQM),
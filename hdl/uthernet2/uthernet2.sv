@@ -117,6 +117,54 @@ module Uthernet2 #(
     (* syn_ramstyle="block_ram" *) reg [7:0] reg_mem [0:2047];    // 0x0000-0x07FF
     (* syn_ramstyle="block_ram" *) reg [7:0] buf_mem [0:16383];   // 0x4000-0x7FFF
 
+    // -------------------------------------------------------
+    // Socket interrupt registers
+    //   Sn_IR lives at W5100 0x0402 / 0x0502 / 0x0602 / 0x0702. On the chip an
+    //   Apple II write clears the bits written as 1, so the four registers are
+    //   flops in front of the backing store rather than plain BSRAM. A host
+    //   write raises the bits it carries, or clears them with bit 7 set (bit 7
+    //   is reserved on the W5100). A raise wins over a clear in the same cycle,
+    //   like the doorbell below, so an engine event is never lost.
+    // -------------------------------------------------------
+    wire a_ir = (data_addr_r[15:10] == 6'b000001) && (data_addr_r[7:0] == 8'h02);
+    wire b_ir = (w5100_host_addr[15:10] == 6'b000001) && (w5100_host_addr[7:0] == 8'h02);
+    wire snir_a_wr = data_access && !a2bus_if.rw_n && a_ir;
+    wire snir_b_wr = w5100_host_wr && b_ir;
+
+    reg [7:0] sn_ir_r [0:3];
+    reg [7:0] ir_set, ir_clr;
+    integer   t;
+    always @(posedge a2bus_if.clk_logic) begin
+        if (!a2bus_if.system_reset_n) begin
+            for (t = 0; t < 4; t = t + 1)
+                sn_ir_r[t] <= 8'h00;
+        end else begin
+            for (t = 0; t < 4; t = t + 1) begin
+                ir_set = 8'h00;
+                ir_clr = 8'h00;
+                if (snir_a_wr && (data_addr_r[9:8] == t[1:0]))
+                    ir_clr = a2bus_if.data;
+                if (snir_b_wr && (w5100_host_addr[9:8] == t[1:0])) begin
+                    if (w5100_host_wdata[7])
+                        ir_clr = ir_clr | {3'b000, w5100_host_wdata[4:0]};
+                    else
+                        ir_set = {3'b000, w5100_host_wdata[4:0]};
+                end
+                sn_ir_r[t] <= (sn_ir_r[t] & ~ir_clr) | ir_set;   // set wins over clear
+            end
+        end
+    end
+
+    // Registered like the BSRAM read ports so both sides see the same latency
+    reg [7:0] a_ir_q, b_ir_q;
+    reg       a_ir_sel_q, b_ir_sel_q;
+    always @(posedge a2bus_if.clk_logic) begin
+        a_ir_q     <= sn_ir_r[data_addr_r[9:8]];
+        a_ir_sel_q <= a_ir;
+        b_ir_q     <= sn_ir_r[w5100_host_addr[9:8]];
+        b_ir_sel_q <= b_ir;
+    end
+
     // Port A (Apple II) region decode
     wire        a_reg  = (data_addr_r[15:11] == 5'd0);     // 0x0000-0x07FF
     wire        a_buf  = (data_addr_r[15:14] == 2'b01);    // 0x4000-0x7FFF
@@ -132,7 +180,8 @@ module Uthernet2 #(
         a_reg_sel_q <= a_reg;
         a_buf_sel_q <= a_buf;
     end
-    wire [7:0] a_q = a_reg_sel_q ? a_reg_q : a_buf_sel_q ? a_buf_q : 8'h00;
+    wire [7:0] a_q = a_ir_sel_q  ? a_ir_q  :
+                     a_reg_sel_q ? a_reg_q : a_buf_sel_q ? a_buf_q : 8'h00;
 
     // Port B (BL616 host, SPI SPACE 3) region decode -- W5100 addresses
     wire        b_reg  = (w5100_host_addr[15:11] == 5'd0);
@@ -148,7 +197,8 @@ module Uthernet2 #(
         b_reg_sel_q <= b_reg;
         b_buf_sel_q <= b_buf;
     end
-    assign w5100_host_rdata = b_reg_sel_q ? b_reg_q : b_buf_sel_q ? b_buf_q : 8'h00;
+    assign w5100_host_rdata = b_ir_sel_q  ? b_ir_q  :
+                              b_reg_sel_q ? b_reg_q : b_buf_sel_q ? b_buf_q : 8'h00;
 
     // DEBUG: count port-B writes and latch the last addr/data the card actually
     // received, independent of whether they land where expected.
@@ -56,7 +56,12 @@ module apple_video_gen #(
     output reg video_bank_o,
     output reg video_rd_o,
     input [31:0] video_data_i,
-    input wire video_ready_i       // VRAM data ready (active-high, tie 1 for BSRAM)
+    input wire video_ready_i,      // VRAM data ready (active-high, tie 1 for BSRAM)
+
+    // Diagnostic: chunk loads taken before the chunk's fetch/expand finished
+    // (each one shows a partially stale 28-pixel chunk), counted over the
+    // last complete frame. Latched at vsync; saturates at 16'hFFFF.
+    output reg [15:0] dbg_late_o
 );
 
     localparam FORCE_NIBBLE_COLORS = 1;
@@ -372,6 +377,8 @@ module apple_video_gen #(
     reg [3:0] fe_step_r;         // fetch/expand pipeline step
     reg       fe_done_r;         // fetch/expand complete for next chunk
     reg       primed_r;          // first chunk loaded, pixel output active
+    reg [15:0] late_cnt_r;       // late chunk loads this frame (dbg_late_o)
+    reg       vsync_prev_r;
 
     // Working registers for fetch/expand pipeline
     reg [PIX_BUFFER_SIZE-1:0] next_pix_buffer_r;
@@ -493,10 +500,19 @@ module apple_video_gen #(
             monochrome_mode_r <= 1'b0;
             monochrome_dhires_mode_r <= 1'b0;
             shrg_mode_r <= 1'b0;
+            late_cnt_r <= 16'd0;
+            vsync_prev_r <= 1'b0;
+            dbg_late_o <= 16'd0;
         end else begin
 
             video_rd_o <= 1'b0;
 
+            vsync_prev_r <= pixel_stream.vsync;
+            if (pixel_stream.vsync && !vsync_prev_r) begin
+                dbg_late_o <= late_cnt_r;
+                late_cnt_r <= 16'd0;
+            end
+
             // Vsync: latch mode registers
             if (pixel_stream.vsync) begin
                 video_bank_r             <= video_control_if.enable;
@@ -753,6 +769,8 @@ module apple_video_gen #(
                             pix_shift_r <= {next_pix_buffer_r[PIX_BUFFER_SIZE-1:1],
                                             next_pix_delay_r ? pix_shift_r[0] : next_pix_buffer_r[0]};
                             pix_delay_r <= next_pix_delay_r;
+                            if (!fe_done_r && late_cnt_r != 16'hFFFF)
+                                late_cnt_r <= late_cnt_r + 16'd1;
 
                             // Start fetching next chunk
                             if (fe_chunk_r < NUM_CHUNKS) begin
@@ -22,9 +22,13 @@
 // Architecture:
 //   Write path: accepts fb_we/fb_data from renderers (apple_video_fb, vgc_fb),
 //               converts RGB666 to RGB565, packs pixel pairs into 32-bit words,
-//               buffers in a 256-entry FIFO, and drains to SDRAM via FB_WRITE_PORT.
+//               combines them into FB_WRITE_BURST_WORDS-aligned groups,
+//               buffers in a 256-word FIFO, and drains to SDRAM via
+//               FB_WRITE_PORT (one write-back per group).
 //   Read path:  line fetch FSM prefetches scanlines from SDRAM into a dual-port
-//               BRAM line buffer, unpacking 2 pixels per SDRAM word.
+//               BRAM line buffer as a chain of aligned FB_READ_BURST_WORDS
+//               bursts, unpacking 2 pixels per SDRAM word. Lines the writer
+//               saw as a single colour are filled locally, skipping SDRAM.
 //               Yields to writes only when FIFO is near full (safety valve).
 //   CDC:        only needed for the line buffer (54 MHz write, 27 MHz read)
 //               using true dual-port BRAM with independent clocks.
@@ -52,7 +56,17 @@ module sdram_framebuffer #(
     parameter TEST_PATTERN = 0,
     // EXP 22: Binary threshold diagnostic — all non-zero pixels become white,
     // zero pixels become black. Makes ghost artifacts maximally visible.
-    parameter THRESHOLD_DIAG = 0
+    parameter THRESHOLD_DIAG = 0,
+    // Words per burst read — must match the controller: 2 for sdram_ports
+    // READ_BURST_LENGTH 8, 8 when fb_read_port is sdram_ports' READ_BURST8_PORT.
+    parameter FB_READ_BURST_WORDS = 2,
+    // Words per write-back: 1 = one write per pixel pair, 8 = aligned 8-word
+    // groups (fb_write_port must be sdram_ports' WIDE_WR_PORT, with the
+    // fb_wr_wide_* sideband connected).
+    parameter FB_WRITE_BURST_WORDS = 1,
+    // Fill single-colour lines from the per-line summary instead of fetching
+    // them. Forced off for the SDRAM round-trip test patterns.
+    parameter SOLID_LINE_SKIP = 1
 ) (
     // Clocks and reset
     input  logic        clk,             // 54 MHz logic clock
@@ -69,6 +83,8 @@ module sdram_framebuffer #(
     // SDRAM port interfaces
     mem_port_if.client  fb_write_port,   // For writing pixels to SDRAM
     mem_port_if.client  fb_read_port,    // For reading scanlines from SDRAM
+    output logic [223:0] fb_wr_wide_data_hi_o, // Write-back words 1-7 (FB_WRITE_BURST_WORDS > 1)
+    output logic [7:0]  fb_wr_wide_word_en_o,  // Write-back per-word enables
 
     // HDMI scan position (pixel clock domain, from HDMI encoder)
     input  logic [10:0] hdmi_cx,
@@ -86,8 +102,8 @@ module sdram_framebuffer #(
 
     // Debug counters/flags (clk domain)
     output logic [7:0]  dbg_fifo_level_o,      // Current FIFO fill level (clamped)
-    output logic [7:0]  dbg_fifo_highwater_o,  // Per-frame FIFO high-water mark
-    output logic [7:0]  dbg_fifo_overflow_o,   // Dropped packed writes per frame
+    output logic [7:0]  dbg_fifo_highwater_o,  // Per-frame FIFO high-water mark (entries)
+    output logic [7:0]  dbg_fifo_overflow_o,   // Dropped write groups per frame
     output logic [7:0]  dbg_fetch_start_o,     // Line fetch starts per frame
     output logic [7:0]  dbg_fetch_done_o,      // Line fetch completions per frame
     output logic [7:0]  dbg_read_blocked_o,    // FETCH_READ cycles blocked by port unavailable
@@ -99,7 +115,12 @@ module sdram_framebuffer #(
     output logic [7:0]  dbg_ready_phase_err_o, // Read ready pulses outside FETCH_WAIT
     output logic [7:0]  dbg_vsync_raw_o,       // Raw fb_vsync pulses seen in this frame
     output logic [7:0]  dbg_frame_start_accept_o, // Accepted frame starts in this frame
-    output logic [7:0]  dbg_frame_start_reject_o  // Rejected fb_vsync pulses in this frame
+    output logic [7:0]  dbg_frame_start_reject_o, // Rejected fb_vsync pulses in this frame
+    // Previous-frame finals (stable for a whole frame, for MCU readout)
+    output logic [15:0] dbg_rd_bursts_o,       // Burst reads issued
+    output logic [15:0] dbg_wr_bursts_o,       // Write-backs issued
+    output logic [7:0]  dbg_skip_lines_o,      // Line fetches replaced by a solid fill
+    output logic [7:0]  dbg_fifo_hwm_o         // Write FIFO high-water mark (entries)
 );
 
     // =========================================================================
@@ -183,28 +204,34 @@ module sdram_framebuffer #(
     end
 
     // =========================================================================
-    // Write FIFO — buffers packed pixel pairs for SDRAM
+    // Write FIFO — buffers combined pixel-pair groups for SDRAM
     // =========================================================================
     //
-    // Each entry: {21-bit addr, 32-bit data} = 53 bits
-    // Depth 256 absorbs full write bursts during uninterrupted line fetches.
-    // The fetcher only yields to writes as a safety valve when the FIFO is
-    // near full, allowing line fetches to complete as fast as possible.
-
-    localparam FIFO_DEPTH = 256;
-    localparam FIFO_ADDR_BITS = 8;  // log2(256)
-    // Yield reads only as a safety valve when write FIFO backs up.
-    localparam FIFO_YIELD_THRESHOLD = 64;
-
-    reg [52:0] wr_fifo [0:FIFO_DEPTH-1];
+    // Each entry: {21-bit group addr, WB word enables, WB x 32-bit data}, one
+    // FB_WRITE_BURST_WORDS-aligned group. WB=1 is one packed pair per entry;
+    // WB=8 drains each entry as a single 8-word write-back, one row
+    // activation and precharge instead of eight. Capacity is 256 words
+    // either way, which absorbs full write bursts during uninterrupted line
+    // fetches. The fetcher only yields to writes as a safety valve when the
+    // FIFO is near full, allowing line fetches to complete as fast as possible.
+
+    localparam integer WB = FB_WRITE_BURST_WORDS;
+    localparam FIFO_DEPTH = 256 / WB;
+    localparam FIFO_ADDR_BITS = $clog2(FIFO_DEPTH);
+    localparam FIFO_WIDTH = 21 + WB + WB * 32;
+    // Yield reads only as a safety valve when write FIFO backs up (64 words).
+    localparam FIFO_YIELD_THRESHOLD = 64 / WB;
+
+    reg [FIFO_WIDTH-1:0] wr_fifo [0:FIFO_DEPTH-1];
     reg [FIFO_ADDR_BITS:0] fifo_wr_ptr_r, fifo_rd_ptr_r;
 
     wire [FIFO_ADDR_BITS:0] fifo_count_w = fifo_wr_ptr_r - fifo_rd_ptr_r;
     wire fifo_empty_w = (fifo_wr_ptr_r == fifo_rd_ptr_r);
-    wire fifo_full_w  = fifo_count_w[FIFO_ADDR_BITS];  // MSB set when count >= 256
+    wire fifo_full_w  = fifo_count_w[FIFO_ADDR_BITS];  // MSB set when count >= FIFO_DEPTH
     // Start yielding reads earlier so write FIFO never reaches drop-on-full behavior.
     wire fifo_busy_w  = (fifo_count_w >= FIFO_YIELD_THRESHOLD);
-    wire [7:0] fifo_count_clamped_w = fifo_count_w[FIFO_ADDR_BITS] ? 8'hFF : fifo_count_w[7:0];
+    wire [7:0] fifo_count_clamped_w = fifo_count_w[FIFO_ADDR_BITS] ? 8'hFF :
+                                      8'(fifo_count_w[FIFO_ADDR_BITS-1:0]);
 
     // =========================================================================
     // Write path — pixel packing + FIFO (clk domain, 54 MHz)
@@ -245,13 +272,17 @@ module sdram_framebuffer #(
                                              (TEST_PATTERN == 4) ? test_pixel_mixed(wr_x_r[9:0]) :
                                              (TEST_PATTERN == 3) ? test_pixel(wr_x_r[9:0]) : fb_data_r;
 
+    // Packed pixel pair completed this cycle (odd pixel of a pair)
+    wire        wr_pair_w = fb_we_r && !(frame_pending_r || frame_start_w) && wr_x_r[0];
+    wire [20:0] wr_pair_addr_w = wr_line_base_r + {11'd0, wr_x_r[10:1]};
+    wire [31:0] wr_pair_data_w = {rgb666_to_565(wr_pixel_data_w), wr_pixel_even_r};
+
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
             wr_x_r <= 11'd0;
             wr_y_r <= 10'd0;
             wr_width_r <= 11'd560;
             wr_line_base_r <= 21'd0;
-            fifo_wr_ptr_r <= '0;
             wr_pixel_even_r <= 16'd0;
             frame_pending_r <= 1'b0;
             frame_parity_r <= 1'b0;
@@ -276,15 +307,8 @@ module sdram_framebuffer #(
                     if (wr_x_r[0] == 1'b0) begin
                         // Even pixel — buffer as RGB565
                         wr_pixel_even_r <= rgb666_to_565(wr_pixel_data_w);
-                    end else if (!fifo_full_w) begin
-                        // Odd pixel — pack with buffered even and push to FIFO
-                        wr_fifo[fifo_wr_ptr_r[FIFO_ADDR_BITS-1:0]] <= {
-                            wr_line_base_r + {11'd0, wr_x_r[10:1]},  // packed addr
-                            rgb666_to_565(wr_pixel_data_w),            // odd pixel [31:16]
-                            wr_pixel_even_r                            // even pixel [15:0]
-                        };
-                        fifo_wr_ptr_r <= fifo_wr_ptr_r + 1;
                     end
+                    // Odd pixel: wr_pair_w hands the packed pair to the combiner
 
                     // Advance position
                     if (wr_x_r == wr_width_r - 11'd1) begin
@@ -299,8 +323,127 @@ module sdram_framebuffer #(
         end
     end
 
-    // FIFO drain to SDRAM write port
-    wire [52:0] fifo_head_w = wr_fifo[fifo_rd_ptr_r[FIFO_ADDR_BITS-1:0]];
+    // Write combiner: collects pairs of one aligned group and pushes the
+    // group when it is complete, when a pair lands in another group (frame
+    // restart, widths that are not a multiple of 2*WB pixels), or after
+    // WR_FLUSH_IDLE cycles without a pair. With WB=1 every pair is a full
+    // group and is pushed on the cycle it is produced, as before.
+    localparam [7:0] WR_FLUSH_IDLE = 8'd64;
+
+    wire [20:0]      wr_pair_group_w = wr_pair_addr_w & ~21'(WB - 1);
+    wire [2:0]       wr_pair_slot_w  = 3'(wr_pair_addr_w & 21'(WB - 1));
+    reg  [20:0]      acc_group_r;
+    reg  [WB-1:0]    acc_en_r;
+    reg  [WB*32-1:0] acc_data_r;
+    reg  [7:0]       acc_idle_r;
+
+    reg  [WB-1:0]    acc_en_merged_w;
+    reg  [WB*32-1:0] acc_data_merged_w;
+    always @(*) begin
+        acc_en_merged_w = acc_en_r;
+        acc_data_merged_w = acc_data_r;
+        acc_en_merged_w[wr_pair_slot_w] = 1'b1;
+        acc_data_merged_w[wr_pair_slot_w*32 +: 32] = wr_pair_data_w;
+    end
+
+    wire acc_hit_w    = (acc_en_r != '0) && (wr_pair_group_w == acc_group_r) &&
+                        !acc_en_r[wr_pair_slot_w];
+    wire acc_fill_w   = wr_pair_w && (acc_hit_w || acc_en_r == '0);
+    wire push_full_w  = acc_fill_w && (&acc_en_merged_w);
+    wire push_old_w   = (wr_pair_w && !acc_fill_w) ||
+                        (!wr_pair_w && (acc_en_r != '0) && (acc_idle_r == WR_FLUSH_IDLE));
+    wire fifo_push_w  = push_full_w || push_old_w;
+    wire [FIFO_WIDTH-1:0] fifo_push_entry_w = push_full_w ?
+        {wr_pair_group_w, acc_en_merged_w, acc_data_merged_w} :
+        {acc_group_r, acc_en_r, acc_data_r};
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            fifo_wr_ptr_r <= '0;
+            acc_group_r <= 21'd0;
+            acc_en_r <= '0;
+            acc_data_r <= '0;
+            acc_idle_r <= 8'd0;
+        end else begin
+            if (fifo_push_w && !fifo_full_w) begin
+                wr_fifo[fifo_wr_ptr_r[FIFO_ADDR_BITS-1:0]] <= fifo_push_entry_w;
+                fifo_wr_ptr_r <= fifo_wr_ptr_r + 1;
+            end
+
+            if (wr_pair_w) begin
+                acc_idle_r <= 8'd0;
+                if (push_full_w) begin
+                    acc_en_r <= '0;
+                end else if (acc_fill_w) begin
+                    acc_group_r <= wr_pair_group_w;
+                    acc_en_r <= acc_en_merged_w;
+                    acc_data_r <= acc_data_merged_w;
+                end else begin
+                    // Pair opens a new group; the previous one was pushed above
+                    acc_group_r <= wr_pair_group_w;
+                    acc_en_r <= WB'(1) << wr_pair_slot_w;
+                    acc_data_r[wr_pair_slot_w*32 +: 32] <= wr_pair_data_w;
+                end
+            end else if (acc_en_r != '0) begin
+                if (push_old_w)
+                    acc_en_r <= '0;
+                else
+                    acc_idle_r <= acc_idle_r + 8'd1;
+            end
+        end
+    end
+
+    // Solid-line summary: {single colour, RGB565 colour} per line written,
+    // recorded when the line's last pair lands. The fetcher fills such lines
+    // locally instead of reading them back (fb_height <= 200, so 256 lines).
+    localparam SKIP_SOLID = (SOLID_LINE_SKIP != 0) && (TEST_PATTERN == 0);
+
+    reg [16:0] line_sum [0:255];
+    reg        wr_line_solid_r;
+    reg [15:0] wr_line_color_r;
+
+    wire wr_pair_uniform_w = (wr_pair_data_w[31:16] == wr_pair_data_w[15:0]);
+    wire wr_pair_first_w   = (wr_x_r == 11'd1);
+    wire wr_pair_last_w    = (wr_x_r == wr_width_r - 11'd1);
+    wire wr_line_solid_w   = wr_pair_uniform_w &&
+                             (wr_pair_first_w || (wr_line_solid_r &&
+                                                  wr_pair_data_w[15:0] == wr_line_color_r));
+
+    // line_sum is block RAM, so reset cannot clear it in one cycle: a sweep
+    // zeroes one entry per clk after reset (256 clks, well inside the first
+    // line) and no entry reads as solid until it is done. A summary the
+    // sweep overwrites only costs that line a normal fetch.
+    reg  [8:0] sum_clr_r;            // next entry to clear, bit 8 = done
+    wire       sum_clr_busy_w = !sum_clr_r[8];
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            sum_clr_r <= 9'd0;
+            wr_line_solid_r <= 1'b0;
+            wr_line_color_r <= 16'd0;
+        end else begin
+            if (sum_clr_busy_w)
+                sum_clr_r <= sum_clr_r + 9'd1;
+            if (wr_pair_w) begin
+                wr_line_solid_r <= wr_line_solid_w;
+                if (wr_pair_first_w)
+                    wr_line_color_r <= wr_pair_data_w[15:0];
+            end
+        end
+    end
+
+    always @(posedge clk) begin
+        if (sum_clr_busy_w)
+            line_sum[sum_clr_r[7:0]] <= 17'd0;
+        else if (wr_pair_w && wr_pair_last_w)
+            line_sum[wr_y_r[7:0]] <= {wr_line_solid_w,
+                                      wr_pair_first_w ? wr_pair_data_w[15:0] : wr_line_color_r};
+    end
+
+    // FIFO drain to SDRAM write port (one write-back per entry)
+    wire [FIFO_WIDTH-1:0] fifo_head_w = wr_fifo[fifo_rd_ptr_r[FIFO_ADDR_BITS-1:0]];
+    wire [WB*32-1:0] fifo_head_data_w = fifo_head_w[WB*32-1:0];
+    wire [WB-1:0]    fifo_head_en_w   = fifo_head_w[WB*32 +: WB];
     wire fifo_pop_w = !fifo_empty_w && fb_write_port.available;
 
     always @(posedge clk or negedge rst_n) begin
@@ -310,12 +453,14 @@ module sdram_framebuffer #(
             fifo_rd_ptr_r <= fifo_rd_ptr_r + 1;
     end
 
-    assign fb_write_port.addr    = fifo_head_w[52:32];
-    assign fb_write_port.data    = fifo_head_w[31:0];
+    assign fb_write_port.addr    = fifo_head_w[FIFO_WIDTH-1 -: 21];
+    assign fb_write_port.data    = fifo_head_data_w[31:0];
     assign fb_write_port.byte_en = 4'b1111;
     assign fb_write_port.wr      = fifo_pop_w;
     assign fb_write_port.rd      = 1'b0;
-    assign fb_write_port.burst   = 1'b0;
+    assign fb_write_port.burst   = (WB > 1);
+    assign fb_wr_wide_data_hi_o  = 224'(fifo_head_data_w >> 32);
+    assign fb_wr_wide_word_en_o  = 8'(fifo_head_en_w);
 
     // =========================================================================
     // CDC: HDMI cy → clk domain (gray-code)
@@ -386,21 +531,35 @@ module sdram_framebuffer #(
     always @(posedge clk) begin
         packed_width_r <= {1'b0, fb_width[10:1]};
     end
-    localparam integer FB_READ_BURST_WORDS = 2;  // Must match SDRAM controller's READ_BURST_WORDS
+    // FB_READ_BURST_WORDS is a module parameter (set from top.sv)
     localparam integer PREFETCH_LEAD_LINES = 12;
 
-    localparam FETCH_IDLE    = 2'd0;
-    localparam FETCH_READ    = 2'd1;
-    localparam FETCH_WAIT    = 2'd2;
-    localparam FETCH_GAP     = 2'd3;  // 1-cycle gap between bursts for port fairness
+    localparam FETCH_IDLE    = 3'd0;
+    localparam FETCH_READ    = 3'd1;
+    localparam FETCH_WAIT    = 3'd2;
+    localparam FETCH_GAP     = 3'd3;  // 1-cycle gap between bursts for port fairness
+    localparam FETCH_LOOKUP  = 3'd4;  // line_sum read for the line being started
+    localparam FETCH_FILL    = 3'd5;  // solid line: fill from line_sum, no SDRAM
+
+    // Read FIFO between SDRAM beats and pixel extraction (drained below).
+    // 16 deep: holds a full 8-word burst plus extraction backlog; the
+    // occupancy check in fetch_issue_w keeps beats from ever being dropped.
+    localparam RD_FIFO_DEPTH = 16;
+    localparam RD_FIFO_ADDR_BITS = 4;
+    reg [31:0] rd_fifo [0:RD_FIFO_DEPTH-1];
+    reg [RD_FIFO_ADDR_BITS:0] rd_fifo_wr_ptr, rd_fifo_rd_ptr;
+    wire [RD_FIFO_ADDR_BITS:0] rd_fifo_count = rd_fifo_wr_ptr - rd_fifo_rd_ptr;
+    wire rd_fifo_empty = (rd_fifo_wr_ptr == rd_fifo_rd_ptr);
 
-    reg [1:0]  fetch_state_r;
+    reg [2:0]  fetch_state_r;
     reg [8:0]  last_fetched_line_r;  // 9'h1FF = invalid sentinel
     reg [10:0] fetch_word_r;
     reg [20:0] fetch_addr_r;
     reg [20:0] fetch_line_base_r;   // Base SDRAM addr of current/last fetched line
     reg        fetch_bank_r;
     reg [3:0]  fetch_beats_left_r;
+    reg [15:0] fill_color_r;        // RGB565 colour of the solid line being filled
+    reg [16:0] line_sum_q_r;        // line_sum entry of the line being started
 
     // Debug counters (saturating, reset each frame at fb_vsync)
     reg [7:0] dbg_fifo_highwater_r;
@@ -417,6 +576,13 @@ module sdram_framebuffer #(
     reg [7:0] dbg_vsync_raw_r;
     reg [7:0] dbg_frame_start_accept_r;
     reg [7:0] dbg_frame_start_reject_r;
+    reg [15:0] dbg_rd_bursts_r;
+    reg [15:0] dbg_wr_bursts_r;
+    reg [7:0] dbg_skip_lines_r;
+    reg [15:0] dbg_rd_bursts_frame_r;
+    reg [15:0] dbg_wr_bursts_frame_r;
+    reg [7:0] dbg_skip_lines_frame_r;
+    reg [7:0] dbg_fifo_hwm_frame_r;
     reg [8:0] completed_line_even_r;
     reg [8:0] completed_line_odd_r;
     reg [8:0] display_line_prev_r;
@@ -436,8 +602,16 @@ module sdram_framebuffer #(
 
     wire [8:0] next_line_w = display_fb_line_w + 9'd1;
     wire [10:0] fetch_words_left_w = packed_width_r - fetch_word_r;
-    wire fetch_use_burst_w = (fetch_words_left_w >= FB_READ_BURST_WORDS[10:0]);
-    wire wr_drop_w = fb_we_r && wr_x_r[0] && fifo_full_w;
+    // Bursts start on a FB_READ_BURST_WORDS boundary, which keeps every burst
+    // inside one SDRAM row (line bases are multiples of 8 words for 560/640
+    // widths, so in practice a line is one unbroken chain of bursts).
+    wire fetch_use_burst_w = (fetch_words_left_w >= FB_READ_BURST_WORDS[10:0]) &&
+                             ((fetch_addr_r & 21'(FB_READ_BURST_WORDS - 1)) == 21'd0);
+    wire [4:0] fetch_beats_w = fetch_use_burst_w ? 5'(FB_READ_BURST_WORDS) : 5'd1;
+    wire fetch_issue_w = (fetch_state_r == FETCH_READ) && !fifo_busy_w &&
+                         ({1'b0, rd_fifo_count} + {1'b0, fetch_beats_w} <= 6'(RD_FIFO_DEPTH));
+    wire fill_push_w = (fetch_state_r == FETCH_FILL) && !rd_fifo_count[RD_FIFO_ADDR_BITS];
+    wire wr_drop_w = fifo_push_w && fifo_full_w;
     wire [8:0] completed_line_for_display_w = display_fb_line_w[0] ? completed_line_odd_r : completed_line_even_r;
     wire line_ready_w = (completed_line_for_display_w == display_fb_line_w);
     wire [8:0] line_lag_w = (completed_line_for_display_w == 9'h1FF ||
@@ -462,10 +636,18 @@ module sdram_framebuffer #(
                               (next_line_w != last_fetched_line_r) &&
                               px_empty;
     wire fetch_start_pulse_w = fetch_start_line0_w || fetch_start_next_w;
-    wire fetch_done_pulse_w = (fetch_state_r == FETCH_WAIT) &&
-                              fb_read_port.ready &&
+    wire fetch_done_pulse_w = ((fetch_state_r == FETCH_WAIT && fb_read_port.ready) || fill_push_w) &&
                               (fetch_word_r == packed_width_r - 11'd1);
 
+    // line_sum read, addressed with the line FETCH_IDLE is about to start so
+    // the entry is valid in FETCH_LOOKUP.
+    wire [8:0] lookup_line_w = (cy_approaching_active_w && last_fetched_line_r != 9'd0) ?
+                               9'd0 : next_line_w;
+    always @(posedge clk) begin
+        line_sum_q_r <= line_sum[lookup_line_w[7:0]];
+    end
+    wire fetch_solid_w = line_sum_q_r[16] && !sum_clr_busy_w;
+
     // Per-frame debug counters and live high-water tracking
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
@@ -483,11 +665,26 @@ module sdram_framebuffer #(
             dbg_vsync_raw_r <= 8'd0;
             dbg_frame_start_accept_r <= 8'd0;
             dbg_frame_start_reject_r <= 8'd0;
+            dbg_rd_bursts_r <= 16'd0;
+            dbg_wr_bursts_r <= 16'd0;
+            dbg_skip_lines_r <= 8'd0;
+            dbg_rd_bursts_frame_r <= 16'd0;
+            dbg_wr_bursts_frame_r <= 16'd0;
+            dbg_skip_lines_frame_r <= 8'd0;
+            dbg_fifo_hwm_frame_r <= 8'd0;
             completed_line_even_r <= 9'h1FF;
             completed_line_odd_r <= 9'h1FF;
             display_line_prev_r <= 9'd0;
             display_active_prev_r <= 1'b0;
         end else if (frame_start_w) begin
+            // Latch previous frame's finals before clearing the live counters
+            dbg_rd_bursts_frame_r <= dbg_rd_bursts_r;
+            dbg_wr_bursts_frame_r <= dbg_wr_bursts_r;
+            dbg_skip_lines_frame_r <= dbg_skip_lines_r;
+            dbg_fifo_hwm_frame_r <= dbg_fifo_highwater_r;
+            dbg_rd_bursts_r <= 16'd0;
+            dbg_wr_bursts_r <= 16'd0;
+            dbg_skip_lines_r <= 8'd0;
             dbg_fifo_highwater_r <= fifo_count_clamped_w;
             dbg_fifo_overflow_r <= 8'd0;
             dbg_fetch_start_r <= 8'd0;
@@ -526,6 +723,16 @@ module sdram_framebuffer #(
             if (fetch_done_pulse_w && dbg_fetch_done_r != 8'hFF)
                 dbg_fetch_done_r <= dbg_fetch_done_r + 8'd1;
 
+            if (fetch_issue_w && fetch_use_burst_w && dbg_rd_bursts_r != 16'hFFFF)
+                dbg_rd_bursts_r <= dbg_rd_bursts_r + 16'd1;
+
+            if (fifo_pop_w && dbg_wr_bursts_r != 16'hFFFF)
+                dbg_wr_bursts_r <= dbg_wr_bursts_r + 16'd1;
+
+            if ((fetch_state_r == FETCH_LOOKUP) && fetch_solid_w &&
+                dbg_skip_lines_r != 8'hFF)
+                dbg_skip_lines_r <= dbg_skip_lines_r + 8'd1;
+
             if ((fetch_state_r == FETCH_READ) && fifo_busy_w && dbg_yield_busy_r != 8'hFF)
                 dbg_yield_busy_r <= dbg_yield_busy_r + 8'd1;
 
@@ -569,6 +776,7 @@ module sdram_framebuffer #(
             fetch_line_base_r <= 21'd0;
             fetch_bank_r <= 1'b0;
             fetch_beats_left_r <= 4'd0;
+            fill_color_r <= 16'd0;
         end else begin
             case (fetch_state_r)
 
@@ -583,7 +791,7 @@ module sdram_framebuffer #(
                     fetch_beats_left_r <= 4'd0;
                     fetch_line_base_r <= 21'd0;
                     fetch_addr_r <= 21'd0;
-                    fetch_state_r <= FETCH_READ;
+                    fetch_state_r <= SKIP_SOLID ? FETCH_LOOKUP : FETCH_READ;
                 end else if (display_in_active_w &&
                              next_line_w < fb_height_r &&
                              next_line_w != last_fetched_line_r) begin
@@ -596,16 +804,37 @@ module sdram_framebuffer #(
                     fetch_beats_left_r <= 4'd0;
                     fetch_line_base_r <= fetch_line_base_r + {10'd0, packed_width_r};
                     fetch_addr_r <= fetch_line_base_r + {10'd0, packed_width_r};
+                    fetch_state_r <= SKIP_SOLID ? FETCH_LOOKUP : FETCH_READ;
+                end
+            end
+
+            FETCH_LOOKUP: begin
+                // The writer saw this line as one colour: fill it locally
+                // (same extraction path, no SDRAM reads).
+                if (fetch_solid_w) begin
+                    fill_color_r <= line_sum_q_r[15:0];
+                    fetch_state_r <= FETCH_FILL;
+                end else begin
                     fetch_state_r <= FETCH_READ;
                 end
             end
 
+            FETCH_FILL: begin
+                if (fill_push_w) begin
+                    if (fetch_word_r == packed_width_r - 11'd1)
+                        fetch_state_r <= FETCH_IDLE;
+                    else
+                        fetch_word_r <= fetch_word_r + 11'd1;
+                end
+            end
+
             FETCH_READ: begin
                 // SDRAM runs at 108 MHz via CDC (~49% utilization), no available
                 // gate needed — port 0 hardware priority keeps DOC latency well
-                // within budget. Only yield if write FIFO is near full.
-                if (!fifo_busy_w) begin
-                    fetch_beats_left_r <= fetch_use_burst_w ? 4'(FB_READ_BURST_WORDS) : 4'd1;
+                // within budget. Only yield if write FIFO is near full, or
+                // until the read FIFO has room for the whole burst.
+                if (fetch_issue_w) begin
+                    fetch_beats_left_r <= 4'(fetch_beats_w);
                     fetch_state_r <= FETCH_WAIT;
                 end
             end
@@ -641,7 +870,7 @@ module sdram_framebuffer #(
     assign fb_read_port.data    = 32'd0;
     assign fb_read_port.byte_en = 4'b1111;
     assign fb_read_port.wr      = 1'b0;
-    assign fb_read_port.rd      = (fetch_state_r == FETCH_READ) && !fifo_busy_w;
+    assign fb_read_port.rd      = fetch_issue_w;
     assign fb_read_port.burst   = fetch_use_burst_w;
 
     assign dbg_fifo_level_o = fifo_count_clamped_w;
@@ -658,6 +887,10 @@ module sdram_framebuffer #(
     assign dbg_vsync_raw_o = dbg_vsync_raw_r;
     assign dbg_frame_start_accept_o = dbg_frame_start_accept_r;
     assign dbg_frame_start_reject_o = dbg_frame_start_reject_r;
+    assign dbg_rd_bursts_o = dbg_rd_bursts_frame_r;
+    assign dbg_wr_bursts_o = dbg_wr_bursts_frame_r;
+    assign dbg_skip_lines_o = dbg_skip_lines_frame_r;
+    assign dbg_fifo_hwm_o = dbg_fifo_hwm_frame_r;
     assign dbg_flags_o = {
         fifo_full_w,                 // [7]
         fifo_busy_w,                 // [6]
@@ -697,19 +930,15 @@ module sdram_framebuffer #(
     // Replaces the 4-entry px_buf that used simultaneous 2-write push.
     // Gowin distributed RAM has a single write port; the old dual-write pattern
     // forced register duplication and caused pixel data corruption (ghosting).
-    localparam RD_FIFO_DEPTH = 8;
-    localparam RD_FIFO_ADDR_BITS = 3;
-    reg [31:0] rd_fifo [0:RD_FIFO_DEPTH-1];
-    reg [RD_FIFO_ADDR_BITS:0] rd_fifo_wr_ptr, rd_fifo_rd_ptr;
-    wire [RD_FIFO_ADDR_BITS:0] rd_fifo_count = rd_fifo_wr_ptr - rd_fifo_rd_ptr;
-    wire rd_fifo_empty = (rd_fifo_wr_ptr == rd_fifo_rd_ptr);
+    // Declared with the fetch FSM; solid-line fills push through it as well.
 
     // Response handler: pop 32-bit words and write 2 pixels sequentially.
     // Matches the DDR3 framebuffer's rd_pixel_active / rd_pixel_idx pattern.
     reg [31:0] rd_word_latched_r;
     reg        rd_pixel_idx_r;      // 0 = even pixel [15:0], 1 = odd pixel [31:16]
     reg        rd_pixel_active_r;
-    wire rd_fifo_push = lb_wr_w && !rd_fifo_count[RD_FIFO_ADDR_BITS];
+    wire rd_fifo_push = (lb_wr_w && !rd_fifo_count[RD_FIFO_ADDR_BITS]) || fill_push_w;
+    wire [31:0] rd_fifo_din_w = fill_push_w ? {fill_color_r, fill_color_r} : fb_read_port.q;
     wire px_empty = rd_fifo_empty && !rd_pixel_active_r;
     reg [10:0] lb_wr_pixel_x;
 
@@ -720,7 +949,7 @@ module sdram_framebuffer #(
         end else if (fetch_start_pulse_w) begin
             rd_fifo_wr_ptr <= '0;
         end else if (rd_fifo_push) begin
-            rd_fifo[rd_fifo_wr_ptr[RD_FIFO_ADDR_BITS-1:0]] <= fb_read_port.q;
+            rd_fifo[rd_fifo_wr_ptr[RD_FIFO_ADDR_BITS-1:0]] <= rd_fifo_din_w;
             rd_fifo_wr_ptr <= rd_fifo_wr_ptr + 1;
         end
     end
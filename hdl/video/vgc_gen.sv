@@ -55,7 +55,12 @@ module vgc_gen (
     // had NOT landed (next_word_rdy_r low) — each one repeats a stale word
     // AND phase-slips the rest of the line (the moving horizontal smear on
     // static SHR screens). Resets on vsync; saturates at 8'hFF.
-    output reg [7:0]  dbg_starved_o
+    output reg [7:0]  dbg_starved_o,
+
+    // Diagnostic: the same word stalls as a 16-bit count for the last
+    // complete frame (latched at vsync, so it reads stable between frames).
+    // Saturates at 16'hFFFF.
+    output reg [15:0] dbg_stalls_o
 );
 
     // =========================================================================
@@ -129,6 +134,8 @@ module vgc_gen (
     reg [1:0]  fe_step_r;        // fetch engine step
     reg        fe_busy_r;        // fetch engine running
     reg        word_stall_r;     // waiting at a word boundary for late data
+    reg [15:0] stall_cnt_r;      // word stalls this frame (dbg_stalls_o)
+    reg        vsync_prev_r;
 
     // =========================================================================
     // Pixel decode logic (from vgc_fb.sv)
@@ -190,6 +197,9 @@ module vgc_gen (
             pix_out_cnt_r <= 10'd0;
             dbg_missed_hsync_o <= 8'd0;
             dbg_starved_o <= 8'd0;
+            dbg_stalls_o <= 16'd0;
+            stall_cnt_r <= 16'd0;
+            vsync_prev_r <= 1'b0;
             render_primed_r <= 1'b0;
             next_word_r <= 32'd0;
             next_word_rdy_r <= 1'b0;
@@ -207,6 +217,11 @@ module vgc_gen (
                 dbg_missed_hsync_o <= 8'd0;
                 dbg_starved_o <= 8'd0;
             end
+            vsync_prev_r <= pixel_stream.vsync;
+            if (pixel_stream.vsync && !vsync_prev_r) begin
+                dbg_stalls_o <= stall_cnt_r;
+                stall_cnt_r <= 16'd0;
+            end
 
             // Diagnostic: detect hsync arriving while we are NOT in
             // ST_IDLE (i.e. still rendering the previous line). Such
@@ -374,6 +389,8 @@ module vgc_gen (
                             // data (counted for the debug register).
                             if (dbg_starved_o != 8'hFF)
                                 dbg_starved_o <= dbg_starved_o + 8'd1;
+                            if (stall_cnt_r != 16'hFFFF)
+                                stall_cnt_r <= stall_cnt_r + 16'd1;
                             word_stall_r <= 1'b1;
                         end else begin
                             // Swap in the prefetched word and prefetch the